@@ -19,6 +19,7 @@
 #define __itkAdvancedImageToImageMetric_h
 
 #include "itkImageToImageMetric.h"
+#include "itkBatchedCostFunctionInterface.h"
 
 #include "itkImageSamplerBase.h"
 #include "itkGradientImageFilter.h"
@@ -37,6 +38,8 @@
 #include "itkAdvancedCombinationTransform.h"
 
 #include "itkMultiThreader.h"
+#include "itkComponentProfiler.h"
+#include "itkPersistentThreadPool.h"
 
 namespace itk
 {
@@ -66,6 +69,10 @@ namespace itk
  *   unless you have a good reason for it...
  * \li Some convenience functions are provided, such as the IsInsideMovingMask
  *   and CheckNumberOfSamples.
+ * \li Batched evaluation: GetValues() computes the values of several parameter
+ *   vectors. Metrics that support it evaluate these concurrently, each on an
+ *   evaluation clone that has its own transform, but shares the images,
+ *   interpolator and image sampler with this metric.
  *
  * The parameters used in this class are:
  * \parameter MovingImageDerivativeScales: scale the moving image derivatives. Use\n
@@ -79,7 +86,8 @@ namespace itk
 
 template< class TFixedImage, class TMovingImage >
 class AdvancedImageToImageMetric :
-  public ImageToImageMetric< TFixedImage, TMovingImage >
+  public ImageToImageMetric< TFixedImage, TMovingImage >,
+  public BatchedCostFunctionInterface
 {
 public:
 
@@ -144,6 +152,8 @@ public:
   typedef typename ImageSamplerType::Pointer                      ImageSamplerPointer;
   typedef typename ImageSamplerType::OutputVectorContainerType    ImageSampleContainerType;
   typedef typename ImageSamplerType::OutputVectorContainerPointer ImageSampleContainerPointer;
+  typedef typename ImageSamplerType
+    ::ImageSampleStructureOfArraysType                            ImageSampleStructureOfArraysType;
 
   /** Typedefs for Limiter support. */
   typedef LimiterFunctionBase< RealType, FixedImageDimension >  FixedImageLimiterType;
@@ -176,6 +186,10 @@ public:
   typedef itk::MultiThreader                      ThreaderType;
   typedef typename ThreaderType::ThreadInfoStruct ThreadInfoType;
 
+  /** Typedefs for batched evaluation. */
+  typedef BatchedCostFunctionInterface::ParametersContainerType ParametersContainerType;
+  typedef BatchedCostFunctionInterface::MeasureContainerType    MeasureContainerType;
+
   /** Public methods ********************/
 
   /** Set the transform, of advanced type. */
@@ -283,6 +297,17 @@ public:
   itkGetConstReferenceMacro( UseMultiThread, bool );
   itkBooleanMacro( UseMultiThread );
 
+  /** Let the image sampler also store the samples in a structure-of-arrays
+   * layout, together with their continuous indices in the fixed image.
+   * The threaded loops then read the fixed coordinates and values of each
+   * block of samples from these contiguous arrays, see TransformSampleBlock(),
+   * and metrics can skip the physical point to index conversion.
+   * Default: false.
+   */
+  itkSetMacro( UseStructureOfArraysSamples, bool );
+  itkGetConstReferenceMacro( UseStructureOfArraysSamples, bool );
+  itkBooleanMacro( UseStructureOfArraysSamples );
+
   /** Contains calls from GetValueAndDerivative that are thread-unsafe,
    * together with preparation for multi-threading.
    * Note that the only reason why this function is not protected, is
@@ -291,6 +316,15 @@ public:
   virtual void BeforeThreadedGetValueAndDerivative(
     const TransformParametersType & parameters ) const;
 
+  /** Compute the values of several parameter vectors. The image sampler is
+   * updated once, so all vectors are evaluated on the same samples. When
+   * multi-threading is used and the metric supports evaluation clones, the
+   * vectors are distributed over the threads, each thread evaluating whole
+   * vectors on its own clone. Otherwise GetValue() is called for each vector.
+   */
+  virtual void GetValues( const ParametersContainerType & parameters,
+    MeasureContainerType & values ) const;
+
 protected:
 
   /** Constructor. */
@@ -406,6 +440,18 @@ protected:
   bool m_UseMultiThread;
   bool m_UseOpenMP;
 
+  /** Use the structure-of-arrays samples of the image sampler. */
+  bool m_UseStructureOfArraysSamples;
+
+  /** Accumulate only the blocks of the per-thread derivatives that the
+   * threads marked as touched. Set by Initialize() for metrics that support
+   * it, when the transform is a B-spline transform.
+   */
+  mutable bool m_UseSparseDerivativeAccumulation;
+
+  /** The number of parameters in a block of the sparse derivative accumulation. */
+  itkStaticConstMacro( DerivativeBlockSize, unsigned int, 64 );
+
   /** Helper structs that multi-threads the computation of
    * the metric derivative using ITK threads.
    */
@@ -447,6 +493,10 @@ protected:
     SizeValueType  st_NumberOfPixelsCounted;
     MeasureType    st_Value;
     DerivativeType st_Derivative;
+
+    /** One flag per DerivativeBlockSize parameters, set when the thread added
+     * to that block of st_Derivative. Only used for sparse accumulation. */
+    std::vector< unsigned char > st_TouchedDerivativeBlocks;
   };
   itkPadStruct( ITK_CACHE_LINE_ALIGNMENT, GetValueAndDerivativePerThreadStruct,
     PaddedGetValueAndDerivativePerThreadStruct );
@@ -455,9 +505,35 @@ protected:
   mutable AlignedGetValueAndDerivativePerThreadStruct * m_GetValueAndDerivativePerThreadVariables;
   mutable ThreadIdType                                  m_GetValueAndDerivativePerThreadVariablesSize;
 
+  /** Per-thread work buffers for the sparse Jacobian of a single sample.
+   * They are sized at the start of each resolution, so that the threads can
+   * reuse them in every iteration instead of allocating their own.
+   */
+  struct JacobianWorkPerThreadStruct
+  {
+    NonZeroJacobianIndicesType st_NonZeroJacobianIndices;
+    DerivativeType             st_ImageJacobian;
+  };
+  itkPadStruct( ITK_CACHE_LINE_ALIGNMENT, JacobianWorkPerThreadStruct,
+    PaddedJacobianWorkPerThreadStruct );
+  itkAlignedTypedef( ITK_CACHE_LINE_ALIGNMENT, PaddedJacobianWorkPerThreadStruct,
+    AlignedJacobianWorkPerThreadStruct );
+  mutable AlignedJacobianWorkPerThreadStruct * m_JacobianWorkPerThreadVariables;
+  mutable ThreadIdType                         m_JacobianWorkPerThreadVariablesSize;
+
   /** Initialize some multi-threading related parameters. */
   virtual void InitializeThreadingParameters( void ) const;
 
+  /** Size the per-thread Jacobian work buffers; called by Initialize. */
+  void InitializeJacobianWorkBuffers( void ) const;
+
+  /** Mark the derivative blocks that contain the indices \a nzji as touched
+   * by thread \a threadId. Metrics that support the sparse derivative
+   * accumulation call this for every sample they add to st_Derivative.
+   */
+  void MarkTouchedDerivativeBlocks( ThreadIdType threadId,
+    const NonZeroJacobianIndicesType & nzji ) const;
+
   /** Protected methods ************** */
 
   /** Methods for image sampler support **********/
@@ -521,6 +597,51 @@ protected:
     const FixedImagePointType & fixedImagePoint,
     MovingImagePointType & mappedPoint ) const;
 
+  /** Transform a contiguous block of points from FixedImage domain to
+   * MovingImage domain, using a single call to the transform. The
+   * threaded metric implementations gather their samples in blocks of
+   * at most TransformPointsBlockSize points and map them with this function.
+   */
+  virtual void TransformPoints(
+    const FixedImagePointType * fixedImagePoints,
+    MovingImagePointType * mappedPoints,
+    const SizeValueType numberOfPoints ) const;
+
+  /** The maximum number of samples that is transformed in one call to
+   * TransformPoints() by the threaded metric implementations. */
+  itkStaticConstMacro( TransformPointsBlockSize, unsigned int, 64 );
+
+  /** Gather the fixed image coordinates of at most TransformPointsBlockSize
+   * samples, starting at \a begin, and transform them with TransformPoints().
+   * When \a fixedImageValues is given, the fixed image values of the samples
+   * are gathered as well. The coordinates and values are copied from the
+   * contiguous arrays of the structure of arrays output of the image sampler
+   * when UseStructureOfArraysSamples is set, and from the sample container
+   * otherwise. All arrays need room for TransformPointsBlockSize elements.
+   * Returns the number of samples in the block.
+   */
+  SizeValueType TransformSampleBlock(
+    typename ImageSampleContainerType::ConstIterator begin,
+    const typename ImageSampleContainerType::ConstIterator & end,
+    FixedImagePointType * fixedImagePoints,
+    MovingImagePointType * mappedPoints,
+    RealType * fixedImageValues = 0 ) const;
+
+  /** Get the structure of arrays output of the image sampler, if it is in
+   * use and up to date with the sample container. Returns 0 otherwise.
+   */
+  const ImageSampleStructureOfArraysType * GetStructureOfArraysSamples( void ) const;
+
+  /** Get the continuous index in the fixed image of sample \a sampleNumber.
+   * The precomputed index of the image sampler is used when available,
+   * otherwise it is computed from \a fixedImagePoint.
+   */
+  template< class TContinuousIndex >
+  void ComputeFixedImageContinuousIndex(
+    const SizeValueType sampleNumber,
+    const FixedImagePointType & fixedImagePoint,
+    TContinuousIndex & cindex ) const;
+
   /** This function returns a reference to the transform Jacobians.
    * This is either a reference to the full TransformJacobian or
    * a reference to a sparse Jacobians.
@@ -547,6 +668,28 @@ protected:
   double m_FixedLimitRangeRatio;
   double m_MovingLimitRangeRatio;
 
+  /** Methods for batched evaluation support **********/
+
+  /** Inheriting classes that override CopyEvaluationState, such that a copy
+   * computes the same GetValue() as the original, return true here. Default: false. */
+  virtual bool SupportsEvaluationClones( void ) const { return false; }
+
+  /** Copy the settings and precomputed data that GetValue() needs from \a other,
+   * sharing the images, interpolator, limiters and image sampler. The copy
+   * computes its value single-threaded and does not update the image sampler,
+   * so that several copies can compute values concurrently. Inheriting classes
+   * that have their own state should call the superclass implementation first.
+   */
+  virtual void CopyEvaluationState( const Self & other );
+
+  /** Methods for sparse derivative accumulation support **********/
+
+  /** Inheriting classes that call MarkTouchedDerivativeBlocks() for every
+   * contribution to the per-thread derivatives, and accumulate them with
+   * AccumulateDerivativesThreaderCallback(), return true here. Default: false.
+   */
+  virtual bool SupportsSparseDerivativeAccumulation( void ) const { return false; }
+
 private:
 
   AdvancedImageToImageMetric( const Self & ); // purposely not implemented
@@ -562,6 +705,31 @@ private:
 
   MovingImageDerivativeScalesType m_MovingImageDerivativeScales;
 
+  /** Create the evaluation clones; returns false if that is not possible,
+   * for instance when the transform cannot be copied. */
+  bool CreateEvaluationClones( void ) const;
+
+  /** Create a copy of the transform of this metric, with its own parameters;
+   * returns null if the transform cannot be copied. */
+  typename AdvancedTransformType::Pointer CreateTransformCopy( void ) const;
+
+  /** GetValues threader callback function. */
+  static ITK_THREAD_RETURN_TYPE GetValuesThreaderCallback( void * arg );
+
+  struct GetValuesMultiThreaderParameterType
+  {
+    const Self *                    st_Metric;
+    const ParametersContainerType * st_Parameters;
+    MeasureContainerType *          st_Values;
+  };
+
+  /** The evaluation clones, one per thread, created by the first call to
+   * GetValues() after Initialize(). m_EvaluationClonesCreated is also set
+   * when creating them failed, to not try again.
+   */
+  mutable std::vector< Pointer > m_EvaluationClones;
+  mutable bool                   m_EvaluationClonesCreated;
+
 };
 
 } // end namespace itk
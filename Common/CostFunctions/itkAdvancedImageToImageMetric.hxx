@@ -29,6 +29,8 @@
 
 #include "itkTimeProbe.h"
 
+#include <algorithm>
+
 namespace itk
 {
 
@@ -48,9 +50,11 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
    */
   this->SetComputeGradient( false );
 
-  this->m_ImageSampler                = 0;
-  this->m_UseImageSampler             = false;
-  this->m_RequiredRatioOfValidSamples = 0.25;
+  this->m_ImageSampler                    = 0;
+  this->m_UseImageSampler                 = false;
+  this->m_UseStructureOfArraysSamples     = false;
+  this->m_UseSparseDerivativeAccumulation = false;
+  this->m_RequiredRatioOfValidSamples     = 0.25;
 
   this->m_LinearInterpolator              = 0;
   this->m_BSplineInterpolator             = 0;
@@ -87,8 +91,13 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
   /** Threading related variables. */
   this->m_UseMetricSingleThreaded = true;
   this->m_UseMultiThread = false;
-  this->m_Threader->SetUseThreadPool( false ); // setting to true makes elastix hang
-                                               // at a WaitForSingleMethodThread()
+
+  /** The threader callbacks are executed by the PersistentThreadPool; the
+   * threader only holds the number of threads. The itk::ThreadPool of the
+   * threader is not used, since it makes elastix hang at a
+   * WaitForSingleMethodThread().
+   */
+  this->m_Threader->SetUseThreadPool( false );
 
   /** OpenMP related. Switch to on when available */
 #ifdef ELASTIX_USE_OPENMP
@@ -108,6 +117,10 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
   this->m_GetValuePerThreadVariablesSize              = 0;
   this->m_GetValueAndDerivativePerThreadVariables     = NULL;
   this->m_GetValueAndDerivativePerThreadVariablesSize = 0;
+  this->m_JacobianWorkPerThreadVariables              = NULL;
+  this->m_JacobianWorkPerThreadVariablesSize          = 0;
+
+  this->m_EvaluationClonesCreated = false;
 
 } // end Constructor
 
@@ -122,6 +135,7 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
 {
   delete[] this->m_GetValuePerThreadVariables;
   delete[] this->m_GetValueAndDerivativePerThreadVariables;
+  delete[] this->m_JacobianWorkPerThreadVariables;
 } // end Destructor
 
 
@@ -170,12 +184,23 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
   /** Check if the transform is a B-spline transform. */
   this->CheckForBSplineTransform();
 
+  /** Only accumulate the touched derivative blocks when the Jacobian is
+   * sparse, and when the inheriting class marks these blocks.
+   */
+  this->m_UseSparseDerivativeAccumulation = this->m_UseMultiThread
+    && this->m_TransformIsBSpline && this->SupportsSparseDerivativeAccumulation();
+
   /** Initialize some threading related parameters. */
   if( this->m_UseMultiThread )
   {
     this->InitializeThreadingParameters();
+    this->InitializeJacobianWorkBuffers();
   }
 
+  /** The evaluation clones are recreated by the next GetValues(). */
+  this->m_EvaluationClones.clear();
+  this->m_EvaluationClonesCreated = false;
+
 } // end Initialize()
 
 
@@ -215,6 +240,8 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
   }
 
   /** Some initialization. */
+  const std::size_t numberOfDerivativeBlocks = this->m_UseSparseDerivativeAccumulation
+    ? ( this->GetNumberOfParameters() + Self::DerivativeBlockSize - 1 ) / Self::DerivativeBlockSize : 0;
   for( ThreadIdType i = 0; i < this->m_NumberOfThreads; ++i )
   {
     this->m_GetValuePerThreadVariables[ i ].st_NumberOfPixelsCounted = NumericTraits< SizeValueType >::Zero;
@@ -224,11 +251,68 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
     this->m_GetValueAndDerivativePerThreadVariables[ i ].st_Value                 = NumericTraits< MeasureType >::Zero;
     this->m_GetValueAndDerivativePerThreadVariables[ i ].st_Derivative.SetSize( this->GetNumberOfParameters() );
     this->m_GetValueAndDerivativePerThreadVariables[ i ].st_Derivative.Fill( NumericTraits< DerivativeValueType >::ZeroValue() );
+    this->m_GetValueAndDerivativePerThreadVariables[ i ].st_TouchedDerivativeBlocks.assign( numberOfDerivativeBlocks, 0 );
   }
 
 } // end InitializeThreadingParameters()
 
 
+/**
+ * ********************* MarkTouchedDerivativeBlocks ****************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+::MarkTouchedDerivativeBlocks( ThreadIdType threadId,
+  const NonZeroJacobianIndicesType & nzji ) const
+{
+  if( !this->m_UseSparseDerivativeAccumulation )
+  {
+    return;
+  }
+
+  /** The indices come in runs of consecutive parameters, so mostly the
+   * same flag is set again, which stays in the cache of this thread.
+   */
+  std::vector< unsigned char > & touched
+    = this->m_GetValueAndDerivativePerThreadVariables[ threadId ].st_TouchedDerivativeBlocks;
+  for( typename NonZeroJacobianIndicesType::const_iterator it = nzji.begin(); it != nzji.end(); ++it )
+  {
+    touched[ *it / Self::DerivativeBlockSize ] = 1;
+  }
+
+} // end MarkTouchedDerivativeBlocks()
+
+
+/**
+ * ********************* InitializeJacobianWorkBuffers ****************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+::InitializeJacobianWorkBuffers( void ) const
+{
+  /** Only resize the array of structs when needed. */
+  if( this->m_JacobianWorkPerThreadVariablesSize != this->m_NumberOfThreads )
+  {
+    delete[] this->m_JacobianWorkPerThreadVariables;
+    this->m_JacobianWorkPerThreadVariables     = new AlignedJacobianWorkPerThreadStruct[ this->m_NumberOfThreads ];
+    this->m_JacobianWorkPerThreadVariablesSize = this->m_NumberOfThreads;
+  }
+
+  /** The number of nonzero Jacobian indices is fixed during a resolution. */
+  const NumberOfParametersType nnzji = this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices();
+  for( ThreadIdType i = 0; i < this->m_NumberOfThreads; ++i )
+  {
+    this->m_JacobianWorkPerThreadVariables[ i ].st_NonZeroJacobianIndices.resize( nnzji );
+    this->m_JacobianWorkPerThreadVariables[ i ].st_ImageJacobian.SetSize( nnzji );
+  }
+
+} // end InitializeJacobianWorkBuffers()
+
+
 /**
  * ****************** InitializeLimiters *****************************
  */
@@ -371,6 +455,7 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
     this->m_ImageSampler->SetInput( this->m_FixedImage );
     this->m_ImageSampler->SetMask( this->m_FixedImageMask );
     this->m_ImageSampler->SetInputImageRegion( this->GetFixedImageRegion() );
+    this->m_ImageSampler->SetUseStructureOfArrays( this->m_UseStructureOfArraysSamples );
   }
 
 } // end InitializeImageSampler()
@@ -584,6 +669,8 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
   RealType & movingImageValue,
   MovingImageDerivativeType * gradient ) const
 {
+  ComponentProfiler::ScopedTimer profilerTimer( ComponentProfiler::InterpolatorEvaluation );
+
   /** Check if mapped point inside image buffer. */
   MovingImageContinuousIndexType cindex;
   this->m_Interpolator->ConvertPointToContinuousIndex( mappedPoint, cindex );
@@ -758,6 +845,8 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
   const FixedImagePointType & fixedImagePoint,
   MovingImagePointType & mappedPoint ) const
 {
+  ComponentProfiler::ScopedTimer profilerTimer( ComponentProfiler::TransformPoint );
+
   mappedPoint = this->m_Transform->TransformPoint( fixedImagePoint );
 
   /** For future use: return whether the sample is valid */
@@ -767,6 +856,145 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
 } // end TransformPoint()
 
 
+/**
+ * ********************** TransformPoints ************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+::TransformPoints(
+  const FixedImagePointType * fixedImagePoints,
+  MovingImagePointType * mappedPoints,
+  const SizeValueType numberOfPoints ) const
+{
+  ComponentProfiler::ScopedTimer profilerTimer( ComponentProfiler::TransformPoint );
+
+  this->m_AdvancedTransform->TransformPoints(
+    fixedImagePoints, mappedPoints, numberOfPoints );
+
+} // end TransformPoints()
+
+
+/**
+ * ********************** GetStructureOfArraysSamples ************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+const typename AdvancedImageToImageMetric< TFixedImage, TMovingImage >::ImageSampleStructureOfArraysType *
+AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+::GetStructureOfArraysSamples( void ) const
+{
+  if( !this->m_UseStructureOfArraysSamples || !this->m_UseImageSampler )
+  {
+    return 0;
+  }
+
+  /** The arrays are only valid if they were filled after the last
+   * modification of the sample container.
+   */
+  const ImageSampleStructureOfArraysType * samples
+    = this->m_ImageSampler->GetStructureOfArraysOutput();
+  if( samples == 0 || !samples->IsFilledFrom( this->m_ImageSampler->GetOutput() ) )
+  {
+    return 0;
+  }
+  return samples;
+
+} // end GetStructureOfArraysSamples()
+
+
+/**
+ * ********************** TransformSampleBlock ************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+SizeValueType
+AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+::TransformSampleBlock(
+  typename ImageSampleContainerType::ConstIterator begin,
+  const typename ImageSampleContainerType::ConstIterator & end,
+  FixedImagePointType * fixedImagePoints,
+  MovingImagePointType * mappedPoints,
+  RealType * fixedImageValues ) const
+{
+  SizeValueType                            blockSize = 0;
+  const ImageSampleStructureOfArraysType * samples   = this->GetStructureOfArraysSamples();
+  if( samples != 0 )
+  {
+    /** Copy the coordinates and values of this block from the contiguous
+     * arrays, one dimension at a time.
+     */
+    const SizeValueType first = begin.Index();
+    blockSize = std::min( static_cast< SizeValueType >( end.Index() - first ),
+      static_cast< SizeValueType >( Self::TransformPointsBlockSize ) );
+    for( unsigned int d = 0; d < FixedImageDimension; ++d )
+    {
+      const typename ImageSampleStructureOfArraysType::CoordinateValueType * coordinates
+        = samples->GetCoordinates( d ) + first;
+      for( SizeValueType i = 0; i < blockSize; ++i )
+      {
+        fixedImagePoints[ i ][ d ] = coordinates[ i ];
+      }
+    }
+    if( fixedImageValues != 0 )
+    {
+      const typename ImageSampleStructureOfArraysType::RealType * values
+        = samples->GetValues() + first;
+      for( SizeValueType i = 0; i < blockSize; ++i )
+      {
+        fixedImageValues[ i ] = static_cast< RealType >( values[ i ] );
+      }
+    }
+  }
+  else
+  {
+    /** Gather the fixed image coordinates and values of this block. */
+    for(; begin != end && blockSize < Self::TransformPointsBlockSize; ++begin, ++blockSize )
+    {
+      fixedImagePoints[ blockSize ] = ( *begin ).Value().m_ImageCoordinates;
+      if( fixedImageValues != 0 )
+      {
+        fixedImageValues[ blockSize ] = static_cast< RealType >( ( *begin ).Value().m_ImageValue );
+      }
+    }
+  }
+
+  /** Transform them in one go. */
+  this->TransformPoints( fixedImagePoints, mappedPoints, blockSize );
+
+  return blockSize;
+
+} // end TransformSampleBlock()
+
+
+/**
+ * ****************** ComputeFixedImageContinuousIndex *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+template< class TContinuousIndex >
+void
+AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+::ComputeFixedImageContinuousIndex(
+  const SizeValueType sampleNumber,
+  const FixedImagePointType & fixedImagePoint,
+  TContinuousIndex & cindex ) const
+{
+  const ImageSampleStructureOfArraysType * samples = this->GetStructureOfArraysSamples();
+  if( samples != 0 && sampleNumber < samples->Size() )
+  {
+    for( unsigned int d = 0; d < FixedImageDimension; ++d )
+    {
+      cindex[ d ] = samples->GetContinuousIndices( d )[ sampleNumber ];
+    }
+    return;
+  }
+  this->m_FixedImage->TransformPhysicalPointToContinuousIndex( fixedImagePoint, cindex );
+
+} // end ComputeFixedImageContinuousIndex()
+
+
 /**
  * *************** EvaluateTransformJacobian ****************
  */
@@ -779,6 +1007,8 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
   TransformJacobianType & jacobian,
   NonZeroJacobianIndicesType & nzji ) const
 {
+  ComponentProfiler::ScopedTimer profilerTimer( ComponentProfiler::TransformJacobian );
+
   /** Advanced transform: generic sparse Jacobian support */
   this->m_AdvancedTransform->GetJacobian(
     fixedImagePoint, jacobian, nzji );
@@ -856,6 +1086,14 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
     }
   }
 
+  /** Refresh the structure of arrays before the threads read it, in case
+   * the samples were changed outside the pipeline of the sampler.
+   */
+  if( this->m_UseStructureOfArraysSamples && this->m_UseImageSampler )
+  {
+    this->GetImageSampler()->UpdateStructureOfArraysOutput();
+  }
+
 } // end BeforeThreadedGetValueAndDerivative()
 
 
@@ -890,12 +1128,10 @@ void
 AdvancedImageToImageMetric< TFixedImage, TMovingImage >
 ::LaunchGetValueThreaderCallback( void ) const
 {
-  /** Setup threader. */
-  this->m_Threader->SetSingleMethod( this->GetValueThreaderCallback,
-    const_cast< void * >( static_cast< const void * >( &this->m_ThreaderMetricParameters ) ) );
-
-  /** Launch. */
-  this->m_Threader->SingleMethodExecute();
+  /** Launch the threads of the persistent thread pool. */
+  PersistentThreadPool::SingleMethodExecute( this->GetValueThreaderCallback,
+    const_cast< void * >( static_cast< const void * >( &this->m_ThreaderMetricParameters ) ),
+    this->m_Threader->GetNumberOfThreads() );
 
 } // end LaunchGetValueThreaderCallback()
 
@@ -931,12 +1167,10 @@ void
 AdvancedImageToImageMetric< TFixedImage, TMovingImage >
 ::LaunchGetValueAndDerivativeThreaderCallback( void ) const
 {
-  /** Setup threader. */
-  this->m_Threader->SetSingleMethod( this->GetValueAndDerivativeThreaderCallback,
-    const_cast< void * >( static_cast< const void * >( &this->m_ThreaderMetricParameters ) ) );
-
-  /** Launch. */
-  this->m_Threader->SingleMethodExecute();
+  /** Launch the threads of the persistent thread pool. */
+  PersistentThreadPool::SingleMethodExecute( this->GetValueAndDerivativeThreaderCallback,
+    const_cast< void * >( static_cast< const void * >( &this->m_ThreaderMetricParameters ) ),
+    this->m_Threader->GetNumberOfThreads() );
 
 } // end LaunchGetValueAndDerivativeThreaderCallback()
 
@@ -950,6 +1184,8 @@ ITK_THREAD_RETURN_TYPE
 AdvancedImageToImageMetric< TFixedImage, TMovingImage >
 ::AccumulateDerivativesThreaderCallback( void * arg )
 {
+  ComponentProfiler::ScopedTimer profilerTimer( ComponentProfiler::DerivativeAccumulation );
+
   ThreadInfoType * infoStruct  = static_cast< ThreadInfoType * >( arg );
   ThreadIdType     threadID    = infoStruct->ThreadID;
   ThreadIdType     nrOfThreads = infoStruct->NumberOfThreads;
@@ -957,7 +1193,60 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
   MultiThreaderParameterType * temp
     = static_cast< MultiThreaderParameterType * >( infoStruct->UserData );
 
-  const unsigned int numPar  = temp->st_Metric->GetNumberOfParameters();
+  const unsigned int        numPar        = temp->st_Metric->GetNumberOfParameters();
+  const DerivativeValueType zero          = NumericTraits< DerivativeValueType >::Zero;
+  const DerivativeValueType normalization = 1.0 / temp->st_NormalizationFactor;
+
+  /** In the sparse mode, each thread handles a range of derivative blocks.
+   * Only the sub-derivatives of the threads that touched a block are added
+   * and reset, so the work scales with the number of touched blocks instead
+   * of with the number of parameters times the number of threads. Adding the
+   * touched blocks in thread order gives the same result as the dense sum.
+   */
+  if( temp->st_Metric->m_UseSparseDerivativeAccumulation )
+  {
+    const unsigned int blockSize       = Self::DerivativeBlockSize;
+    const unsigned int numBlocks       = ( numPar + blockSize - 1 ) / blockSize;
+    const unsigned int blocksPerThread = ( numBlocks + nrOfThreads - 1 ) / nrOfThreads;
+    const unsigned int bmin            = std::min( threadID * blocksPerThread, numBlocks );
+    const unsigned int bmax            = std::min( bmin + blocksPerThread, numBlocks );
+
+    for( unsigned int b = bmin; b < bmax; ++b )
+    {
+      const unsigned int    jmin      = b * blockSize;
+      const unsigned int    jmax      = std::min( jmin + blockSize, numPar );
+      DerivativeValueType * blockSum  = temp->st_DerivativePointer;
+      bool                  isTouched = false;
+      for( ThreadIdType i = 0; i < nrOfThreads; ++i )
+      {
+        GetValueAndDerivativePerThreadStruct & threadVariables
+          = temp->st_Metric->m_GetValueAndDerivativePerThreadVariables[ i ];
+        if( !threadVariables.st_TouchedDerivativeBlocks[ b ] )
+        {
+          continue;
+        }
+        DerivativeValueType * sub = threadVariables.st_Derivative.data_block();
+        for( unsigned int j = jmin; j < jmax; ++j )
+        {
+          blockSum[ j ] = isTouched ? blockSum[ j ] + sub[ j ] : sub[ j ];
+
+          /** Reset this variable for the next iteration. */
+          sub[ j ] = zero;
+        }
+        threadVariables.st_TouchedDerivativeBlocks[ b ] = 0;
+        isTouched = true;
+      }
+
+      /** Scale the block, or clear it when no thread touched it. */
+      for( unsigned int j = jmin; j < jmax; ++j )
+      {
+        blockSum[ j ] = isTouched ? blockSum[ j ] * normalization : zero;
+      }
+    }
+
+    return ITK_THREAD_RETURN_VALUE;
+  }
+
   const unsigned int subSize = static_cast< unsigned int >(
     vcl_ceil( static_cast< double >( numPar )
     / static_cast< double >( nrOfThreads ) ) );
@@ -968,8 +1257,6 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
   /** This thread accumulates all sub-derivatives into a single one, for the
    * range [ jmin, jmax [. Additionally, the sub-derivatives are reset.
    */
-  const DerivativeValueType zero          = NumericTraits< DerivativeValueType >::Zero;
-  const DerivativeValueType normalization = 1.0 / temp->st_NormalizationFactor;
   for( unsigned int j = jmin; j < jmax; ++j )
   {
     DerivativeValueType tmp = zero;
@@ -988,6 +1275,265 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
 } // end AccumulateDerivativesThreaderCallback()
 
 
+/**
+ * *********************** GetValues ***********************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+::GetValues( const ParametersContainerType & parameters,
+  MeasureContainerType & values ) const
+{
+  const std::size_t numberOfVectors = parameters.size();
+  values.resize( numberOfVectors );
+
+  /** Evaluate the vectors one by one, when they cannot be distributed over
+   * the threads. The image sampler is then updated by the first GetValue().
+   */
+  if( numberOfVectors < 2 || !this->m_UseMultiThread || !this->CreateEvaluationClones() )
+  {
+    for( std::size_t i = 0; i < numberOfVectors; ++i )
+    {
+      values[ i ] = this->GetValue( parameters[ i ] );
+    }
+    return;
+  }
+
+  /** The clones share the image sampler, which is updated here once. */
+  if( this->m_UseImageSampler )
+  {
+    this->GetImageSampler()->Update();
+  }
+
+  /** Launch the threads of the persistent thread pool. */
+  GetValuesMultiThreaderParameterType temp;
+  temp.st_Metric     = this;
+  temp.st_Parameters = &parameters;
+  temp.st_Values     = &values;
+  const ThreadIdType numberOfThreads = static_cast< ThreadIdType >(
+    std::min< std::size_t >( this->m_EvaluationClones.size(), numberOfVectors ) );
+  PersistentThreadPool::SingleMethodExecute(
+    Self::GetValuesThreaderCallback, &temp, numberOfThreads );
+
+} // end GetValues()
+
+
+/**
+ * *********************** GetValuesThreaderCallback ***********************
+ */
+
+template< class TFixedImage, class TMovingImage >
+ITK_THREAD_RETURN_TYPE
+AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+::GetValuesThreaderCallback( void * arg )
+{
+  ThreadInfoType * infoStruct  = static_cast< ThreadInfoType * >( arg );
+  ThreadIdType     threadID    = infoStruct->ThreadID;
+  ThreadIdType     nrOfThreads = infoStruct->NumberOfThreads;
+
+  GetValuesMultiThreaderParameterType * temp
+    = static_cast< GetValuesMultiThreaderParameterType * >( infoStruct->UserData );
+  const Self *                    clone      = temp->st_Metric->m_EvaluationClones[ threadID ];
+  const ParametersContainerType & parameters = *temp->st_Parameters;
+  MeasureContainerType &          values     = *temp->st_Values;
+
+  /** Each thread evaluates every nrOfThreads-th parameter vector on its own clone. */
+  for( std::size_t i = threadID; i < parameters.size(); i += nrOfThreads )
+  {
+    clone->SetTransformParameters( parameters[ i ] );
+    values[ i ] = clone->GetValue( parameters[ i ] );
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end GetValuesThreaderCallback()
+
+
+/**
+ * *********************** CreateEvaluationClones ***********************
+ */
+
+template< class TFixedImage, class TMovingImage >
+bool
+AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+::CreateEvaluationClones( void ) const
+{
+  if( this->m_EvaluationClonesCreated )
+  {
+    return !this->m_EvaluationClones.empty();
+  }
+  this->m_EvaluationClonesCreated = true;
+
+  if( !this->SupportsEvaluationClones() || this->m_AdvancedTransform.IsNull() )
+  {
+    return false;
+  }
+
+  /** Create a clone for every thread, each with its own copy of the transform. */
+  const ThreadIdType     numberOfThreads = this->m_Threader->GetNumberOfThreads();
+  std::vector< Pointer > clones( numberOfThreads );
+  for( ThreadIdType i = 0; i < numberOfThreads; ++i )
+  {
+    typename AdvancedTransformType::Pointer transform = this->CreateTransformCopy();
+    LightObject::Pointer anotherMetric = this->CreateAnother();
+    clones[ i ] = dynamic_cast< Self * >( anotherMetric.GetPointer() );
+    if( transform.IsNull() || clones[ i ].IsNull() )
+    {
+      return false;
+    }
+
+    clones[ i ]->CopyEvaluationState( *this );
+    clones[ i ]->SetTransform( transform );
+    clones[ i ]->CheckForAdvancedTransform();
+    clones[ i ]->CheckForBSplineTransform();
+  }
+
+  this->m_EvaluationClones.swap( clones );
+  return true;
+
+} // end CreateEvaluationClones()
+
+
+/**
+ * *********************** CreateTransformCopy ***********************
+ */
+
+template< class TFixedImage, class TMovingImage >
+typename AdvancedImageToImageMetric< TFixedImage, TMovingImage >::AdvancedTransformType::Pointer
+AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+::CreateTransformCopy( void ) const
+{
+  typedef typename AdvancedTransformType::Pointer AdvancedTransformPointer;
+
+  /** Of a combination transform only the current transform is copied, since
+   * that holds the parameters; the initial transform is shared.
+   */
+  CombinationTransformType * combo
+    = dynamic_cast< CombinationTransformType * >( this->m_AdvancedTransform.GetPointer() );
+  AdvancedTransformType * source = this->m_AdvancedTransform.GetPointer();
+  if( combo )
+  {
+    source = combo->GetModifiableCurrentTransform();
+    if( !source )
+    {
+      return 0;
+    }
+  }
+
+  LightObject::Pointer     anotherTransform = source->CreateAnother();
+  AdvancedTransformPointer sourceCopy
+    = dynamic_cast< AdvancedTransformType * >( anotherTransform.GetPointer() );
+  if( sourceCopy.IsNull() )
+  {
+    return 0;
+  }
+  sourceCopy->SetFixedParameters( source->GetFixedParameters() );
+  sourceCopy->SetParametersByValue( source->GetParameters() );
+
+  AdvancedTransformPointer copy = sourceCopy;
+  if( combo )
+  {
+    typename CombinationTransformType::Pointer comboCopy = CombinationTransformType::New();
+    comboCopy->SetUseComposition( combo->GetUseComposition() );
+    comboCopy->SetInitialTransform( combo->GetModifiableInitialTransform() );
+    comboCopy->SetCurrentTransform( sourceCopy );
+    copy = comboCopy.GetPointer();
+  }
+
+  /** Not all state of a transform is in its (fixed) parameters. Check that
+   * the copy maps the corners of the fixed image region to the same points.
+   */
+  const FixedImageRegionType & region = this->GetFixedImageRegion();
+  for( unsigned int c = 0; c < ( 1u << FixedImageDimension ); ++c )
+  {
+    FixedImageIndexType corner = region.GetIndex();
+    for( unsigned int d = 0; d < FixedImageDimension; ++d )
+    {
+      if( c & ( 1u << d ) )
+      {
+        corner[ d ] += static_cast< FixedImageIndexValueType >( region.GetSize()[ d ] ) - 1;
+      }
+    }
+    FixedImagePointType point;
+    this->m_FixedImage->TransformIndexToPhysicalPoint( corner, point );
+    const MovingImagePointType mapped     = this->m_AdvancedTransform->TransformPoint( point );
+    const MovingImagePointType mappedCopy = copy->TransformPoint( point );
+    if( mapped.EuclideanDistanceTo( mappedCopy ) > 1e-6 )
+    {
+      return 0;
+    }
+  }
+
+  return copy;
+
+} // end CreateTransformCopy()
+
+
+/**
+ * *********************** CopyEvaluationState ***********************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+::CopyEvaluationState( const Self & other )
+{
+  /** Share the images, masks and interpolator. */
+  this->SetFixedImage( other.GetFixedImage() );
+  this->SetMovingImage( other.GetMovingImage() );
+  this->SetFixedImageRegion( other.GetFixedImageRegion() );
+  this->SetFixedImageMask( other.GetFixedImageMask() );
+  this->SetMovingImageMask( other.GetMovingImageMask() );
+  this->SetInterpolator( other.m_Interpolator );
+  this->m_InterpolatorIsLinear            = other.m_InterpolatorIsLinear;
+  this->m_InterpolatorIsBSpline           = other.m_InterpolatorIsBSpline;
+  this->m_InterpolatorIsBSplineFloat      = other.m_InterpolatorIsBSplineFloat;
+  this->m_InterpolatorIsReducedBSpline    = other.m_InterpolatorIsReducedBSpline;
+  this->m_LinearInterpolator              = other.m_LinearInterpolator;
+  this->m_BSplineInterpolator             = other.m_BSplineInterpolator;
+  this->m_BSplineInterpolatorFloat        = other.m_BSplineInterpolatorFloat;
+  this->m_ReducedBSplineInterpolator      = other.m_ReducedBSplineInterpolator;
+  this->m_CentralDifferenceGradientFilter = other.m_CentralDifferenceGradientFilter;
+  this->SetComputeGradient( other.GetComputeGradient() );
+  this->m_GradientImage = other.m_GradientImage;
+
+  /** Share the image sampler. */
+  this->m_ImageSampler                = other.m_ImageSampler;
+  this->m_UseImageSampler             = other.m_UseImageSampler;
+  this->m_UseStructureOfArraysSamples = other.m_UseStructureOfArraysSamples;
+  this->m_RequiredRatioOfValidSamples = other.m_RequiredRatioOfValidSamples;
+
+  /** Share the limiters and copy their bounds. */
+  this->m_FixedImageLimiter     = other.m_FixedImageLimiter;
+  this->m_MovingImageLimiter    = other.m_MovingImageLimiter;
+  this->m_UseFixedImageLimiter  = other.m_UseFixedImageLimiter;
+  this->m_UseMovingImageLimiter = other.m_UseMovingImageLimiter;
+  this->m_FixedLimitRangeRatio  = other.m_FixedLimitRangeRatio;
+  this->m_MovingLimitRangeRatio = other.m_MovingLimitRangeRatio;
+  this->m_FixedImageTrueMin     = other.m_FixedImageTrueMin;
+  this->m_FixedImageTrueMax     = other.m_FixedImageTrueMax;
+  this->m_MovingImageTrueMin    = other.m_MovingImageTrueMin;
+  this->m_MovingImageTrueMax    = other.m_MovingImageTrueMax;
+  this->m_FixedImageMinLimit    = other.m_FixedImageMinLimit;
+  this->m_FixedImageMaxLimit    = other.m_FixedImageMaxLimit;
+  this->m_MovingImageMinLimit   = other.m_MovingImageMinLimit;
+  this->m_MovingImageMaxLimit   = other.m_MovingImageMaxLimit;
+
+  /** Copy the moving image derivative settings. */
+  this->m_UseMovingImageDerivativeScales                   = other.m_UseMovingImageDerivativeScales;
+  this->m_ScaleGradientWithRespectToMovingImageOrientation = other.m_ScaleGradientWithRespectToMovingImageOrientation;
+  this->m_MovingImageDerivativeScales                      = other.m_MovingImageDerivativeScales;
+
+  /** The copy computes single-threaded, without setting the transform
+   * parameters or updating the image sampler itself.
+   */
+  this->m_UseMultiThread          = false;
+  this->m_UseMetricSingleThreaded = false;
+
+} // end CopyEvaluationState()
+
+
 /**
  * *********************** CheckNumberOfSamples ***********************
  */
@@ -1025,6 +1571,8 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
      << this->m_ImageSampler.GetPointer() << std::endl;
   os << indent.GetNextIndent() << "UseImageSampler: "
      << this->m_UseImageSampler << std::endl;
+  os << indent.GetNextIndent() << "UseStructureOfArraysSamples: "
+     << this->m_UseStructureOfArraysSamples << std::endl;
 
   /** Variables for the Limiters. */
   os << indent << "Variables related to the Limiters: " << std::endl;
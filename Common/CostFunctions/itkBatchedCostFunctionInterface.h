@@ -0,0 +1,68 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkBatchedCostFunctionInterface_h
+#define __itkBatchedCostFunctionInterface_h
+
+#include "itkSingleValuedCostFunction.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/**
+ * \class BatchedCostFunctionInterface
+ * \brief Interface of single valued cost functions that can compute the
+ * values of several parameter vectors in one call.
+ *
+ * Derivative-free optimizers evaluate a whole population, or a line of a
+ * search grid, before they use any of the values. Cost functions that
+ * implement this interface may evaluate these parameter vectors
+ * concurrently. Optimizers find out whether a cost function implements
+ * it with a dynamic_cast, and otherwise call GetValue() for every vector.
+ *
+ * \ingroup Numerics
+ */
+
+class BatchedCostFunctionInterface
+{
+public:
+
+  /** Typedefs. */
+  typedef std::vector< SingleValuedCostFunction::ParametersType > ParametersContainerType;
+  typedef std::vector< SingleValuedCostFunction::MeasureType >    MeasureContainerType;
+
+  /** Compute values[ i ] = GetValue( parameters[ i ] ) for all i. The values
+   * are the same as when GetValue() is called for each parameter vector
+   * in turn. When one of the evaluations throws an exception, an exception
+   * is thrown after all evaluations have finished, and the values are
+   * undefined.
+   */
+  virtual void GetValues( const ParametersContainerType & parameters,
+    MeasureContainerType & values ) const = 0;
+
+protected:
+
+  BatchedCostFunctionInterface() {}
+  virtual ~BatchedCostFunctionInterface() {}
+
+};
+
+} // end namespace itk
+
+#endif // end #ifndef __itkBatchedCostFunctionInterface_h
@@ -215,6 +215,17 @@ public:
   itkSetMacro( FiniteDifferencePerturbation, double );
   itkGetConstMacro( FiniteDifferencePerturbation, double );
 
+  /** Whether the joint histograms of the threads are summed in parallel.
+   * If true, each thread sums a block of histogram rows over all threads,
+   * and clears these rows in the per-thread histograms. Only the rows that
+   * were actually touched by a thread are visited. If false, the histograms
+   * are summed by a single thread, and each thread clears its complete
+   * histogram. Both give the same result. Default: false.
+   */
+  itkSetMacro( UseParallelJointPDFReduction, bool );
+  itkGetConstMacro( UseParallelJointPDFReduction, bool );
+  itkBooleanMacro( UseParallelJointPDFReduction );
+
 protected:
 
   /** The constructor. */
@@ -313,6 +324,9 @@ protected:
   {
     SizeValueType   st_NumberOfPixelsCounted;
     JointPDFPointer st_JointPDF;
+    /** The range [begin, end) of fixed histogram bins touched by this thread. */
+    OffsetValueType st_FixedBinBegin;
+    OffsetValueType st_FixedBinEnd;
   };
   itkPadStruct( ITK_CACHE_LINE_ALIGNMENT, ParzenWindowHistogramGetValueAndDerivativePerThreadStruct,
     PaddedParzenWindowHistogramGetValueAndDerivativePerThreadStruct );
@@ -336,6 +350,15 @@ protected:
   /** Helper function to launch the threads. */
   void LaunchComputePDFsThreaderCallback( void ) const;
 
+  /** Multi-threaded reduction of the per-thread joint PDFs into m_JointPDF. */
+  inline void ThreadedReduceJointPDFs( ThreadIdType threadId );
+
+  /** Helper function to launch the threads. */
+  static ITK_THREAD_RETURN_TYPE ReduceJointPDFsThreaderCallback( void * arg );
+
+  /** Helper function to launch the threads. */
+  void LaunchReduceJointPDFsThreaderCallback( void ) const;
+
   /** Compute the Parzen values given an image value and a starting histogram index
    * Compute the values at (parzenWindowIndex - parzenWindowTerm + k) for
    * k = 0 ... kernelsize-1
@@ -463,6 +486,13 @@ protected:
 
   virtual void InitializeKernels( void );
 
+  /** Copy the histogram settings, and set up histograms and kernels of our
+   * own, without the derivative histograms. Used for the evaluation clones;
+   * inheriting classes that compute their value from the joint PDF only may
+   * enable these with SupportsEvaluationClones().
+   */
+  virtual void CopyEvaluationState( const Superclass & other );
+
   /** Get the value and analytic derivatives for single valued optimizers.
    * Called by GetValueAndDerivative if UseFiniteDifferenceDerivative == false
    * Implement this method in subclasses.
@@ -497,6 +527,7 @@ private:
   bool          m_UseExplicitPDFDerivatives;
   bool          m_UseFiniteDifferenceDerivative;
   double        m_FiniteDifferencePerturbation;
+  bool          m_UseParallelJointPDFReduction;
 
 };
 
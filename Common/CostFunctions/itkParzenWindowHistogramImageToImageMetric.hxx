@@ -25,6 +25,7 @@
 #include "itkImageLinearIteratorWithIndex.h"
 #include "itkImageScanlineIterator.h"
 #include "vnl/vnl_math.h"
+#include <algorithm>
 
 namespace itk
 {
@@ -62,6 +63,7 @@ ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >
   this->m_UseDerivative                 = false;
   this->m_UseFiniteDifferenceDerivative = false;
   this->m_FiniteDifferencePerturbation  = 1.0;
+  this->m_UseParallelJointPDFReduction  = false;
 
   this->SetUseImageSampler( true );
   this->SetUseFixedImageLimiter( true );
@@ -441,6 +443,40 @@ ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >
 } // end InitializeKernels()
 
 
+/**
+ * ****************** CopyEvaluationState *****************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >
+::CopyEvaluationState( const Superclass & other )
+{
+  Superclass::CopyEvaluationState( other );
+
+  const Self * otherHistogram = dynamic_cast< const Self * >( &other );
+  if( !otherHistogram )
+  {
+    itkExceptionMacro( << "Can only copy the state of a ParzenWindowHistogramImageToImageMetric." );
+  }
+  this->m_NumberOfFixedHistogramBins   = otherHistogram->m_NumberOfFixedHistogramBins;
+  this->m_NumberOfMovingHistogramBins  = otherHistogram->m_NumberOfMovingHistogramBins;
+  this->m_FixedKernelBSplineOrder      = otherHistogram->m_FixedKernelBSplineOrder;
+  this->m_MovingKernelBSplineOrder     = otherHistogram->m_MovingKernelBSplineOrder;
+  this->m_UseExplicitPDFDerivatives    = otherHistogram->m_UseExplicitPDFDerivatives;
+  this->m_UseParallelJointPDFReduction = otherHistogram->m_UseParallelJointPDFReduction;
+
+  /** Only the value is computed, so no derivative histograms are needed. */
+  this->m_UseDerivative                 = false;
+  this->m_UseFiniteDifferenceDerivative = false;
+
+  /** The limits are copied already, so the bins are the same as in other. */
+  this->InitializeHistograms();
+  this->InitializeKernels();
+
+} // end CopyEvaluationState()
+
+
 /**
  * ********************* InitializeThreadingParameters ****************************
  */
@@ -493,6 +529,16 @@ ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >
       jointPDF->SetRegions( jointPDFRegion );
       jointPDF->Allocate();
     }
+
+    /** The parallel reduction clears the per-thread joint PDFs after use,
+     * so they only need to be cleared here, once per resolution.
+     */
+    if( this->m_UseParallelJointPDFReduction )
+    {
+      jointPDF->FillBuffer( NumericTraits< PDFValueType >::ZeroValue() );
+    }
+    this->m_ParzenWindowHistogramGetValueAndDerivativePerThreadVariables[ i ].st_FixedBinBegin = 0;
+    this->m_ParzenWindowHistogramGetValueAndDerivativePerThreadVariables[ i ].st_FixedBinEnd   = 0;
   }
 
 } // end InitializeThreadingParameters()
@@ -1159,7 +1205,10 @@ ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >
    * instead of sequentially in InitializeThreadingParameters().
    */
   JointPDFPointer & jointPDF = this->m_ParzenWindowHistogramGetValueAndDerivativePerThreadVariables[ threadId ].st_JointPDF;
-  jointPDF->FillBuffer( NumericTraits< PDFValueType >::ZeroValue() );
+  if( !this->m_UseParallelJointPDFReduction )
+  {
+    jointPDF->FillBuffer( NumericTraits< PDFValueType >::ZeroValue() );
+  }
 
   /** Get a handle to the sample container. */
   ImageSampleContainerPointer sampleContainer     = this->GetImageSampler()->GetOutput();
@@ -1183,18 +1232,33 @@ ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >
   fend                                                   += (int)pos_end;
 
   /** Create variables to store intermediate results. circumvent false sharing */
-  unsigned long numberOfPixelsCounted = 0;
+  unsigned long   numberOfPixelsCounted = 0;
+  OffsetValueType fixedBinBegin         = NumericTraits< OffsetValueType >::max();
+  OffsetValueType fixedBinEnd           = NumericTraits< OffsetValueType >::NonpositiveMin();
+
+  /** Blocks of fixed points, their values and their transformed counterparts. */
+  FixedImagePointType  fixedPoints[ Self::TransformPointsBlockSize ];
+  RealType             fixedValues[ Self::TransformPointsBlockSize ];
+  MovingImagePointType mappedPoints[ Self::TransformPointsBlockSize ];
+  SizeValueType        blockSize  = 0;
+  SizeValueType        blockIndex = 0;
 
   /** Loop over sample container and compute contribution of each sample to pdfs. */
-  for( fiter = fbegin; fiter != fend; ++fiter )
+  for( fiter = fbegin; fiter != fend; ++fiter, ++blockIndex )
   {
-    /** Read fixed coordinates and initialize some variables. */
-    const FixedImagePointType & fixedPoint = ( *fiter ).Value().m_ImageCoordinates;
-    RealType                    movingImageValue;
-    MovingImagePointType        mappedPoint;
+    /** Transform the next block of samples with a single call to the transform. */
+    if( blockIndex == blockSize )
+    {
+      blockSize  = this->TransformSampleBlock( fiter, fend, fixedPoints, mappedPoints, fixedValues );
+      blockIndex = 0;
+    }
 
-    /** Transform point and check if it is inside the B-spline support region. */
-    bool sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
+    /** Read the mapped point and initialize some variables. */
+    const MovingImagePointType & mappedPoint = mappedPoints[ blockIndex ];
+    RealType                     movingImageValue;
+
+    /** The mapped point is always valid for now; see TransformPoint(). */
+    bool sampleOk = true;
 
     /** Check if point is inside mask. */
     if( sampleOk )
@@ -1216,7 +1280,7 @@ ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >
       numberOfPixelsCounted++;
 
       /** Get the fixed image value. */
-      RealType fixedImageValue = static_cast< RealType >( ( *fiter ).Value().m_ImageValue );
+      RealType fixedImageValue = fixedValues[ blockIndex ];
 
       /** Make sure the values fall within the histogram range. */
       fixedImageValue  = this->GetFixedImageLimiter()->Evaluate( fixedImageValue );
@@ -1226,11 +1290,32 @@ ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >
       this->UpdateJointPDFAndDerivatives(
         fixedImageValue, movingImageValue, 0, 0,
         jointPDF.GetPointer() );
+
+      /** Keep track of the fixed histogram bins (rows) that were touched,
+       * using the same window position as UpdateJointPDFAndDerivatives().
+       */
+      const OffsetValueType fixedImageParzenWindowIndex
+        = static_cast< OffsetValueType >( vcl_floor(
+        fixedImageValue / this->m_FixedImageBinSize - this->m_FixedImageNormalizedMin
+        + this->m_FixedParzenTermToIndexOffset ) );
+      fixedBinBegin = std::min( fixedBinBegin, fixedImageParzenWindowIndex );
+      fixedBinEnd   = std::max( fixedBinEnd, static_cast< OffsetValueType >(
+        fixedImageParzenWindowIndex + this->m_JointPDFWindow.GetSize()[ 1 ] ) );
     }
   } // end iterating over fixed image spatial sample container for loop
 
   /** Only update these variables at the end to prevent unnecessary "false sharing". */
   this->m_ParzenWindowHistogramGetValueAndDerivativePerThreadVariables[ threadId ].st_NumberOfPixelsCounted = numberOfPixelsCounted;
+  if( numberOfPixelsCounted > 0 )
+  {
+    this->m_ParzenWindowHistogramGetValueAndDerivativePerThreadVariables[ threadId ].st_FixedBinBegin = fixedBinBegin;
+    this->m_ParzenWindowHistogramGetValueAndDerivativePerThreadVariables[ threadId ].st_FixedBinEnd   = fixedBinEnd;
+  }
+  else
+  {
+    this->m_ParzenWindowHistogramGetValueAndDerivativePerThreadVariables[ threadId ].st_FixedBinBegin = 0;
+    this->m_ParzenWindowHistogramGetValueAndDerivativePerThreadVariables[ threadId ].st_FixedBinEnd   = 0;
+  }
 
 } // end ThreadedComputePDFs()
 
@@ -1256,6 +1341,14 @@ ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >
     this->m_ParzenWindowHistogramGetValueAndDerivativePerThreadVariables[ i ].st_NumberOfPixelsCounted = 0;
   }
 
+  /** Accumulate joint histogram in parallel. This is done before checking the
+   * number of samples, so that the per-thread joint PDFs are always cleared.
+   */
+  if( this->m_UseParallelJointPDFReduction )
+  {
+    this->LaunchReduceJointPDFsThreaderCallback();
+  }
+
   /** Check if enough samples were valid. */
   ImageSampleContainerPointer sampleContainer = this->GetImageSampler()->GetOutput();
   this->CheckNumberOfSamples(
@@ -1264,8 +1357,12 @@ ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >
   /** Compute alpha. */
   this->m_Alpha = 1.0 / static_cast< double >( this->m_NumberOfPixelsCounted );
 
-  /** Accumulate joint histogram. */
-  // could be multi-threaded too, by each thread updating only a part of the JointPDF.
+  if( this->m_UseParallelJointPDFReduction )
+  {
+    return;
+  }
+
+  /** Accumulate joint histogram single-threadedly. */
   typedef ImageScanlineIterator< JointPDFType > JointPDFIteratorType;
   JointPDFIteratorType                it( this->m_JointPDF, this->m_JointPDF->GetBufferedRegion() );
   std::vector< JointPDFIteratorType > itT( this->m_NumberOfThreads );
@@ -1331,17 +1428,108 @@ void
 ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >
 ::LaunchComputePDFsThreaderCallback( void ) const
 {
-  /** Setup threader. */
-  this->m_Threader->SetSingleMethod( this->ComputePDFsThreaderCallback,
+  /** Launch the threads of the persistent thread pool. */
+  PersistentThreadPool::SingleMethodExecute( this->ComputePDFsThreaderCallback,
     const_cast< void * >( static_cast< const void * >(
-      &this->m_ParzenWindowHistogramThreaderParameters ) ) );
-
-  /** Launch. */
-  this->m_Threader->SingleMethodExecute();
+      &this->m_ParzenWindowHistogramThreaderParameters ) ),
+    this->m_Threader->GetNumberOfThreads() );
 
 } // end LaunchComputePDFsThreaderCallback()
 
 
+/**
+ * ******************* ThreadedReduceJointPDFs *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >
+::ThreadedReduceJointPDFs( ThreadIdType threadId )
+{
+  /** The joint PDF is stored row by row, with a row per fixed histogram bin. */
+  const OffsetValueType numberOfFixedBins  = static_cast< OffsetValueType >( this->m_NumberOfFixedHistogramBins );
+  const SizeValueType   numberOfMovingBins = this->m_NumberOfMovingHistogramBins;
+
+  /** Get the block of rows for this thread. */
+  const OffsetValueType nrOfRowsPerThread = static_cast< OffsetValueType >( vcl_ceil(
+    static_cast< double >( numberOfFixedBins ) / static_cast< double >( this->m_NumberOfThreads ) ) );
+  OffsetValueType row_begin = nrOfRowsPerThread * threadId;
+  OffsetValueType row_end   = nrOfRowsPerThread * ( threadId + 1 );
+  row_begin = ( row_begin > numberOfFixedBins ) ? numberOfFixedBins : row_begin;
+  row_end   = ( row_end > numberOfFixedBins ) ? numberOfFixedBins : row_end;
+  if( row_begin == row_end ) { return; }
+
+  /** Clear the rows of the joint PDF owned by this thread. */
+  PDFValueType * jointPDFPointer = this->m_JointPDF->GetBufferPointer();
+  std::fill( jointPDFPointer + row_begin * numberOfMovingBins,
+    jointPDFPointer + row_end * numberOfMovingBins,
+    NumericTraits< PDFValueType >::ZeroValue() );
+
+  /** Add the touched rows of each thread, in thread order, and clear them
+   * for the next iteration. No locks are needed, since the rows are disjoint.
+   */
+  for( ThreadIdType i = 0; i < this->m_NumberOfThreads; ++i )
+  {
+    const AlignedParzenWindowHistogramGetValueAndDerivativePerThreadStruct & threadVariables
+      = this->m_ParzenWindowHistogramGetValueAndDerivativePerThreadVariables[ i ];
+    const OffsetValueType begin = std::max( row_begin, threadVariables.st_FixedBinBegin );
+    const OffsetValueType end   = std::min( row_end, threadVariables.st_FixedBinEnd );
+    if( begin >= end ) { continue; }
+
+    PDFValueType *       threadPDFPointer = threadVariables.st_JointPDF->GetBufferPointer();
+    PDFValueType *       threadIt         = threadPDFPointer + begin * numberOfMovingBins;
+    PDFValueType * const threadEnd        = threadPDFPointer + end * numberOfMovingBins;
+    PDFValueType *       it               = jointPDFPointer + begin * numberOfMovingBins;
+    for(; threadIt != threadEnd; ++threadIt, ++it )
+    {
+      *it      += *threadIt;
+      *threadIt = NumericTraits< PDFValueType >::ZeroValue();
+    }
+  }
+
+} // end ThreadedReduceJointPDFs()
+
+
+/**
+ * **************** ReduceJointPDFsThreaderCallback *******
+ */
+
+template< class TFixedImage, class TMovingImage >
+ITK_THREAD_RETURN_TYPE
+ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >
+::ReduceJointPDFsThreaderCallback( void * arg )
+{
+  ThreadInfoType * infoStruct = static_cast< ThreadInfoType * >( arg );
+  ThreadIdType     threadId   = infoStruct->ThreadID;
+
+  ParzenWindowHistogramMultiThreaderParameterType * temp
+    = static_cast< ParzenWindowHistogramMultiThreaderParameterType * >( infoStruct->UserData );
+
+  temp->m_Metric->ThreadedReduceJointPDFs( threadId );
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end ReduceJointPDFsThreaderCallback()
+
+
+/**
+ * *********************** LaunchReduceJointPDFsThreaderCallback***************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >
+::LaunchReduceJointPDFsThreaderCallback( void ) const
+{
+  /** Launch the threads of the persistent thread pool. */
+  PersistentThreadPool::SingleMethodExecute( this->ReduceJointPDFsThreaderCallback,
+    const_cast< void * >( static_cast< const void * >(
+      &this->m_ParzenWindowHistogramThreaderParameters ) ),
+    this->m_Threader->GetNumberOfThreads() );
+
+} // end LaunchReduceJointPDFsThreaderCallback()
+
+
 /**
  * ************************ ComputePDFsAndPDFDerivatives *******************
  */
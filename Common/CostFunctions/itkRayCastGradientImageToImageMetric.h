@@ -0,0 +1,202 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkRayCastGradientImageToImageMetric_h
+#define __itkRayCastGradientImageToImageMetric_h
+
+#include "itkAdvancedImageToImageMetric.h"
+#include "itkAdvancedRayCastInterpolateImageFunction.h"
+#include "itkImageFullSampler.h"
+#include "itkCastImageFilter.h"
+#include "itkNeighborhoodOperatorImageFilter.h"
+#include "itkSobelOperator.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/**
+ * \class RayCastGradientImageToImageMetric
+ * \brief Base class for 2D-3D metrics that compare the Sobel gradients of the
+ * fixed image and of the projection of the moving image.
+ *
+ * The projection of the moving image is computed with an
+ * AdvancedRayCastInterpolateImageFunction. Instead of projecting the whole
+ * moving image onto the fixed image grid, ComputeSampleGradients() only casts
+ * the rays that are needed for the Sobel gradients at the samples of the image
+ * sampler: the voxel nearest to each sample, and its direct neighbours. Each
+ * ray is cast once per evaluation, also when it is shared by several samples.
+ * Both the ray casting and the gradient computation are multi-threaded.
+ *
+ * When no image sampler is used, the metric is evaluated at all voxels of the
+ * fixed image region (inside the fixed image mask).
+ *
+ * The fixed image gradients do not change during the registration, and are
+ * computed once, in Initialize().
+ *
+ * \ingroup Metrics
+ */
+
+template< class TFixedImage, class TMovingImage >
+class RayCastGradientImageToImageMetric :
+  public AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+{
+public:
+
+  /** Standard class typedefs. */
+  typedef RayCastGradientImageToImageMetric                       Self;
+  typedef AdvancedImageToImageMetric< TFixedImage, TMovingImage > Superclass;
+  typedef SmartPointer< Self >                                    Pointer;
+  typedef SmartPointer< const Self >                              ConstPointer;
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( RayCastGradientImageToImageMetric, AdvancedImageToImageMetric );
+
+  /** Typedefs from the superclass. */
+  typedef typename Superclass::RealType                    RealType;
+  typedef typename Superclass::TransformType               TransformType;
+  typedef typename TransformType::ScalarType               ScalarType;
+  typedef typename Superclass::TransformParametersType     TransformParametersType;
+  typedef typename Superclass::InterpolatorType            InterpolatorType;
+  typedef typename Superclass::MeasureType                 MeasureType;
+  typedef typename Superclass::DerivativeType              DerivativeType;
+  typedef typename Superclass::FixedImageType              FixedImageType;
+  typedef typename Superclass::FixedImagePixelType         FixedImagePixelType;
+  typedef typename Superclass::FixedImageRegionType        FixedImageRegionType;
+  typedef typename Superclass::MovingImageType             MovingImageType;
+  typedef typename Superclass::ImageSampleContainerType    ImageSampleContainerType;
+  typedef typename Superclass::ImageSampleContainerPointer ImageSampleContainerPointer;
+  typedef typename Superclass::ThreaderType                ThreaderType;
+  typedef typename Superclass::ThreadInfoType              ThreadInfoType;
+
+  itkStaticConstMacro( FixedImageDimension, unsigned int, TFixedImage::ImageDimension );
+
+  /** Typedefs for the projection of the moving image. */
+  typedef AdvancedRayCastInterpolateImageFunction<
+    MovingImageType, ScalarType >                        RayCastInterpolatorType;
+  typedef typename RayCastInterpolatorType::Pointer RayCastInterpolatorPointer;
+
+  /** Typedefs for the Sobel gradients. */
+  typedef Image< RealType,
+    itkGetStaticConstMacro( FixedImageDimension ) >      FixedGradientImageType;
+  typedef typename FixedGradientImageType::PixelType FixedGradientPixelType;
+  typedef SobelOperator< FixedGradientPixelType,
+    itkGetStaticConstMacro( FixedImageDimension ) >      SobelOperatorType;
+
+  /** Initialize the metric: check the interpolator, and compute the
+   * gradients of the fixed image.
+   */
+  virtual void Initialize( void ) throw ( ExceptionObject );
+
+protected:
+
+  RayCastGradientImageToImageMetric();
+  virtual ~RayCastGradientImageToImageMetric() {}
+  virtual void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** Protected typedefs. */
+  typedef typename Superclass::FixedImageIndexType FixedImageIndexType;
+  typedef typename Superclass::FixedImagePointType FixedImagePointType;
+  typedef ImageFullSampler< FixedImageType >       FullSamplerType;
+  typedef CastImageFilter<
+    FixedImageType, FixedGradientImageType >       CastFixedImageFilterType;
+  typedef NeighborhoodOperatorImageFilter<
+    FixedGradientImageType, FixedGradientImageType > FixedSobelFilterType;
+
+  /** Get the fixed image gradient image in direction d. */
+  const FixedGradientImageType * GetFixedGradientImage( const unsigned int d ) const
+  {
+    return this->m_FixedSobelFilters[ d ]->GetOutput();
+  }
+
+
+  /** Compute the Sobel gradients of the fixed image and of the projected
+   * moving image at the samples. The samples outside the fixed image are
+   * skipped. The gradients of the valid samples are stored, FixedImageDimension
+   * values per sample, in m_SampleFixedGradients and m_SampleMovedGradients,
+   * and their number in m_NumberOfPixelsCounted.
+   * Call BeforeThreadedGetValueAndDerivative() first.
+   */
+  void ComputeSampleGradients( void ) const;
+
+  /** The gradients at the valid samples. */
+  mutable std::vector< RealType > m_SampleFixedGradients;
+  mutable std::vector< RealType > m_SampleMovedGradients;
+
+private:
+
+  RayCastGradientImageToImageMetric( const Self & ); // purposely not implemented
+  void operator=( const Self & );                    // purposely not implemented
+
+  typedef typename FixedImageIndexType::OffsetType OffsetType;
+
+  /** Get the samples: those of the image sampler, or all voxels. */
+  ImageSampleContainerType * GetSamples( void ) const;
+
+  /** Threader callbacks, and the work they do for one thread. */
+  static ITK_THREAD_RETURN_TYPE ComputeRayValuesThreaderCallback( void * arg );
+
+  static ITK_THREAD_RETURN_TYPE ComputeMovedGradientsThreaderCallback( void * arg );
+
+  void ThreadedComputeRayValues( ThreadIdType threadId,
+    ThreadIdType numberOfThreads ) const;
+
+  void ThreadedComputeMovedGradients( ThreadIdType threadId,
+    ThreadIdType numberOfThreads ) const;
+
+  /** Launch one of the threader callbacks, or call it directly when
+   * multi-threading is switched off.
+   */
+  void LaunchThreaderCallback( ThreadFunctionType callback ) const;
+
+  RayCastInterpolatorPointer m_RayCastInterpolator;
+
+  /** Used when no image sampler is used. */
+  typename FullSamplerType::Pointer m_FullSampler;
+
+  /** The Sobel gradients of the fixed image. */
+  typename CastFixedImageFilterType::Pointer m_CastFixedImageFilter;
+  typename FixedSobelFilterType::Pointer m_FixedSobelFilters[ FixedImageDimension ];
+  SobelOperatorType m_SobelOperators[ FixedImageDimension ];
+  ZeroFluxNeumannBoundaryCondition< FixedGradientImageType > m_FixedBoundCond;
+
+  /** The offsets of the Sobel neighbourhood, in the order of the operator. */
+  std::vector< OffsetType > m_NeighborhoodOffsets;
+
+  /** The voxels through which a ray is cast, and the results. */
+  mutable std::vector< FixedImageIndexType > m_RayIndices;
+  mutable std::vector< RealType >            m_RayValues;
+
+  /** For each valid sample, the position in m_RayValues of its neighbours. */
+  mutable std::vector< SizeValueType > m_SampleRayIndices;
+
+  /** For each voxel of the fixed image buffer, the position in m_RayIndices,
+   * or the maximum SizeValueType when no ray is cast through it. Only used
+   * while collecting the rays, to share them between samples.
+   */
+  mutable std::vector< SizeValueType > m_VoxelToRay;
+
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkRayCastGradientImageToImageMetric.hxx"
+#endif
+
+#endif // end #ifndef __itkRayCastGradientImageToImageMetric_h
@@ -0,0 +1,386 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkRayCastGradientImageToImageMetric_hxx
+#define __itkRayCastGradientImageToImageMetric_hxx
+
+#include "itkRayCastGradientImageToImageMetric.h"
+
+#include <algorithm>
+
+namespace itk
+{
+
+/**
+ * ***************** Constructor *****************
+ */
+
+template< class TFixedImage, class TMovingImage >
+RayCastGradientImageToImageMetric< TFixedImage, TMovingImage >
+::RayCastGradientImageToImageMetric()
+{
+  this->m_CastFixedImageFilter = CastFixedImageFilterType::New();
+
+  /** The Sobel operators, and the offsets of their neighbourhood. */
+  for( unsigned int d = 0; d < FixedImageDimension; ++d )
+  {
+    this->m_SobelOperators[ d ].SetDirection( d );
+    this->m_SobelOperators[ d ].CreateDirectional();
+  }
+  for( unsigned int i = 0; i < this->m_SobelOperators[ 0 ].Size(); ++i )
+  {
+    this->m_NeighborhoodOffsets.push_back( this->m_SobelOperators[ 0 ].GetOffset( i ) );
+  }
+
+} // end Constructor
+
+
+/**
+ * ***************** Initialize *****************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+RayCastGradientImageToImageMetric< TFixedImage, TMovingImage >
+::Initialize( void ) throw ( ExceptionObject )
+{
+  /** Initialize the base class. */
+  Superclass::Initialize();
+
+  /** The moving image is projected by the interpolator. */
+  this->m_RayCastInterpolator = dynamic_cast< RayCastInterpolatorType * >(
+    const_cast< InterpolatorType * >( this->GetInterpolator() ) );
+  if( this->m_RayCastInterpolator.IsNull() )
+  {
+    itkExceptionMacro( << "ERROR: the " << this->GetNameOfClass() << " is currently "
+                       << "only suitable for 2D-3D registration.\n"
+                       << "  Therefore it expects an interpolator of type RayCastInterpolator." );
+  }
+
+  /** Compute the gradients of the fixed image. */
+  this->m_CastFixedImageFilter->SetInput( this->m_FixedImage );
+  this->m_CastFixedImageFilter->Update();
+
+  for( unsigned int d = 0; d < FixedImageDimension; ++d )
+  {
+    this->m_FixedSobelFilters[ d ] = FixedSobelFilterType::New();
+    this->m_FixedSobelFilters[ d ]->OverrideBoundaryCondition( &this->m_FixedBoundCond );
+    this->m_FixedSobelFilters[ d ]->SetOperator( this->m_SobelOperators[ d ] );
+    this->m_FixedSobelFilters[ d ]->SetInput( this->m_CastFixedImageFilter->GetOutput() );
+    this->m_FixedSobelFilters[ d ]->UpdateLargestPossibleRegion();
+  }
+
+  /** Without an image sampler, all voxels of the fixed image region are used. */
+  if( !this->m_UseImageSampler )
+  {
+    this->m_FullSampler = FullSamplerType::New();
+    this->m_FullSampler->SetInput( this->m_FixedImage );
+    this->m_FullSampler->SetInputImageRegion( this->GetFixedImageRegion() );
+    if( this->m_FixedImageMask.IsNotNull() )
+    {
+      this->m_FullSampler->SetMask( this->m_FixedImageMask );
+    }
+    this->m_FullSampler->Update();
+  }
+  else
+  {
+    this->m_FullSampler = 0;
+  }
+
+  /** No rays have been collected yet. */
+  this->m_VoxelToRay.assign(
+    this->m_FixedImage->GetBufferedRegion().GetNumberOfPixels(),
+    NumericTraits< SizeValueType >::max() );
+
+} // end Initialize()
+
+
+/**
+ * ***************** PrintSelf *****************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+RayCastGradientImageToImageMetric< TFixedImage, TMovingImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "RayCastInterpolator: "
+     << this->m_RayCastInterpolator.GetPointer() << std::endl;
+  os << indent << "FullSampler: "
+     << this->m_FullSampler.GetPointer() << std::endl;
+
+} // end PrintSelf()
+
+
+/**
+ * ***************** GetSamples *****************
+ */
+
+template< class TFixedImage, class TMovingImage >
+typename RayCastGradientImageToImageMetric< TFixedImage, TMovingImage >::ImageSampleContainerType *
+RayCastGradientImageToImageMetric< TFixedImage, TMovingImage >
+::GetSamples( void ) const
+{
+  if( this->m_FullSampler.IsNotNull() )
+  {
+    return this->m_FullSampler->GetOutput();
+  }
+  return this->GetImageSampler()->GetOutput();
+
+} // end GetSamples()
+
+
+/**
+ * ***************** ComputeSampleGradients *****************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+RayCastGradientImageToImageMetric< TFixedImage, TMovingImage >
+::ComputeSampleGradients( void ) const
+{
+  /** Collect the voxels through which a ray should be cast. This is cheap
+   * compared to the ray casting itself, and is done single-threaded.
+   */
+  const ImageSampleContainerType * samples = this->GetSamples();
+  const FixedImageRegionType &     region  = this->m_FixedImage->GetBufferedRegion();
+  const FixedImageIndexType        start   = region.GetIndex();
+  const SizeValueType              unused  = NumericTraits< SizeValueType >::max();
+
+  this->m_RayIndices.clear();
+  this->m_SampleRayIndices.clear();
+  this->m_SampleFixedGradients.clear();
+
+  typename ImageSampleContainerType::ConstIterator fiter;
+  for( fiter = samples->Begin(); fiter != samples->End(); ++fiter )
+  {
+    /** The gradients are computed at the voxel nearest to the sample. */
+    FixedImageIndexType index;
+    if( !this->m_FixedImage->TransformPhysicalPointToIndex(
+      ( *fiter ).Value().m_ImageCoordinates, index ) )
+    {
+      continue;
+    }
+
+    for( unsigned int d = 0; d < FixedImageDimension; ++d )
+    {
+      this->m_SampleFixedGradients.push_back(
+        this->m_FixedSobelFilters[ d ]->GetOutput()->GetPixel( index ) );
+    }
+
+    /** The neighbours, with a zero flux Neumann boundary condition. */
+    for( unsigned int i = 0; i < this->m_NeighborhoodOffsets.size(); ++i )
+    {
+      FixedImageIndexType neighbour = index + this->m_NeighborhoodOffsets[ i ];
+      for( unsigned int d = 0; d < FixedImageDimension; ++d )
+      {
+        const typename FixedImageIndexType::IndexValueType last
+          = start[ d ] + static_cast< typename FixedImageIndexType::IndexValueType >( region.GetSize( d ) ) - 1;
+        neighbour[ d ] = std::min( std::max( neighbour[ d ], start[ d ] ), last );
+      }
+
+      const OffsetValueType voxel = this->m_FixedImage->ComputeOffset( neighbour );
+      if( this->m_VoxelToRay[ voxel ] == unused )
+      {
+        this->m_VoxelToRay[ voxel ] = this->m_RayIndices.size();
+        this->m_RayIndices.push_back( neighbour );
+      }
+      this->m_SampleRayIndices.push_back( this->m_VoxelToRay[ voxel ] );
+    }
+  }
+
+  /** Reset the lookup table for the next evaluation. */
+  for( SizeValueType r = 0; r < this->m_RayIndices.size(); ++r )
+  {
+    this->m_VoxelToRay[ this->m_FixedImage->ComputeOffset( this->m_RayIndices[ r ] ) ] = unused;
+  }
+
+  this->m_NumberOfPixelsCounted = this->m_SampleFixedGradients.size() / FixedImageDimension;
+
+  /** Cast the rays, and compute the gradients of the projection. */
+  this->m_RayValues.resize( this->m_RayIndices.size() );
+  this->LaunchThreaderCallback( Self::ComputeRayValuesThreaderCallback );
+
+  this->m_SampleMovedGradients.resize( this->m_SampleFixedGradients.size() );
+  this->LaunchThreaderCallback( Self::ComputeMovedGradientsThreaderCallback );
+
+} // end ComputeSampleGradients()
+
+
+/**
+ * ***************** ThreadedComputeRayValues *****************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+RayCastGradientImageToImageMetric< TFixedImage, TMovingImage >
+::ThreadedComputeRayValues( ThreadIdType threadId, ThreadIdType numberOfThreads ) const
+{
+  typedef typename RayCastInterpolatorType::TransformType RayCastTransformType;
+  typedef typename RayCastInterpolatorType::PointType     RayCastPointType;
+  typedef typename RayCastInterpolatorType::OutputType    RayCastOutputType;
+
+  const RayCastInterpolatorType * rayCaster = this->m_RayCastInterpolator.GetPointer();
+  const RayCastTransformType *    transform = this->m_RayCastInterpolator->GetTransform();
+
+  /** The projection was formerly resampled on the fixed image grid, which
+   * clamps the values to the range of the fixed image pixel type.
+   */
+  const RealType minValue = static_cast< RealType >( NumericTraits< FixedImagePixelType >::NonpositiveMin() );
+  const RealType maxValue = static_cast< RealType >( NumericTraits< FixedImagePixelType >::max() );
+
+  /** The rays of this thread. */
+  const SizeValueType numberOfRays  = this->m_RayIndices.size();
+  const SizeValueType raysPerThread = ( numberOfRays + numberOfThreads - 1 ) / numberOfThreads;
+  const SizeValueType begin         = std::min( numberOfRays, raysPerThread * threadId );
+  const SizeValueType end           = std::min( numberOfRays, begin + raysPerThread );
+
+  /** Trace the rays in batches, which lets the ray caster share the setup
+   * of the rays. The ray caster has no buffer bounds, so all rays are cast.
+   */
+  const SizeValueType batchSize = 64;
+  RayCastPointType    points[ batchSize ];
+  RayCastOutputType   values[ batchSize ];
+  RayCastPointType    point;
+  for( SizeValueType first = begin; first < end; first += batchSize )
+  {
+    const SizeValueType numberOfRaysInBatch = std::min( batchSize, end - first );
+    for( SizeValueType r = 0; r < numberOfRaysInBatch; ++r )
+    {
+      this->m_FixedImage->TransformIndexToPhysicalPoint( this->m_RayIndices[ first + r ], point );
+      points[ r ] = transform->TransformPoint( point );
+    }
+
+    rayCaster->EvaluateRays( points, values, numberOfRaysInBatch );
+
+    for( SizeValueType r = 0; r < numberOfRaysInBatch; ++r )
+    {
+      RealType value = static_cast< RealType >( values[ r ] );
+      value = std::min( std::max( value, minValue ), maxValue );
+      this->m_RayValues[ first + r ] = static_cast< RealType >( static_cast< FixedImagePixelType >( value ) );
+    }
+  }
+
+} // end ThreadedComputeRayValues()
+
+
+/**
+ * ***************** ThreadedComputeMovedGradients *****************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+RayCastGradientImageToImageMetric< TFixedImage, TMovingImage >
+::ThreadedComputeMovedGradients( ThreadIdType threadId, ThreadIdType numberOfThreads ) const
+{
+  const SizeValueType neighbourhoodSize = this->m_NeighborhoodOffsets.size();
+
+  /** The samples of this thread. */
+  const SizeValueType numberOfSamples  = this->m_NumberOfPixelsCounted;
+  const SizeValueType samplesPerThread = ( numberOfSamples + numberOfThreads - 1 ) / numberOfThreads;
+  const SizeValueType begin            = std::min( numberOfSamples, samplesPerThread * threadId );
+  const SizeValueType end              = std::min( numberOfSamples, begin + samplesPerThread );
+
+  for( SizeValueType s = begin; s < end; ++s )
+  {
+    const SizeValueType * rays = &this->m_SampleRayIndices[ s * neighbourhoodSize ];
+    for( unsigned int d = 0; d < FixedImageDimension; ++d )
+    {
+      /** Apply the Sobel operator, like the NeighborhoodOperatorImageFilter. */
+      RealType gradient = NumericTraits< RealType >::Zero;
+      for( SizeValueType i = 0; i < neighbourhoodSize; ++i )
+      {
+        gradient += this->m_SobelOperators[ d ][ i ] * this->m_RayValues[ rays[ i ] ];
+      }
+      this->m_SampleMovedGradients[ s * FixedImageDimension + d ] = gradient;
+    }
+  }
+
+} // end ThreadedComputeMovedGradients()
+
+
+/**
+ * ***************** ComputeRayValuesThreaderCallback *****************
+ */
+
+template< class TFixedImage, class TMovingImage >
+ITK_THREAD_RETURN_TYPE
+RayCastGradientImageToImageMetric< TFixedImage, TMovingImage >
+::ComputeRayValuesThreaderCallback( void * arg )
+{
+  ThreadInfoType * infoStruct = static_cast< ThreadInfoType * >( arg );
+
+  const Self * metric = static_cast< const Self * >( infoStruct->UserData );
+  metric->ThreadedComputeRayValues( infoStruct->ThreadID, infoStruct->NumberOfThreads );
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end ComputeRayValuesThreaderCallback()
+
+
+/**
+ * ***************** ComputeMovedGradientsThreaderCallback *****************
+ */
+
+template< class TFixedImage, class TMovingImage >
+ITK_THREAD_RETURN_TYPE
+RayCastGradientImageToImageMetric< TFixedImage, TMovingImage >
+::ComputeMovedGradientsThreaderCallback( void * arg )
+{
+  ThreadInfoType * infoStruct = static_cast< ThreadInfoType * >( arg );
+
+  const Self * metric = static_cast< const Self * >( infoStruct->UserData );
+  metric->ThreadedComputeMovedGradients( infoStruct->ThreadID, infoStruct->NumberOfThreads );
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end ComputeMovedGradientsThreaderCallback()
+
+
+/**
+ * ***************** LaunchThreaderCallback *****************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+RayCastGradientImageToImageMetric< TFixedImage, TMovingImage >
+::LaunchThreaderCallback( ThreadFunctionType callback ) const
+{
+  void * userData = const_cast< void * >( static_cast< const void * >( this ) );
+
+  if( !this->m_UseMultiThread )
+  {
+    ThreadInfoType infoStruct;
+    infoStruct.ThreadID        = 0;
+    infoStruct.NumberOfThreads = 1;
+    infoStruct.UserData        = userData;
+    callback( &infoStruct );
+    return;
+  }
+
+  /** Launch the threads of the persistent thread pool. */
+  PersistentThreadPool::SingleMethodExecute( callback,
+    userData,
+    this->m_Threader->GetNumberOfThreads() );
+
+} // end LaunchThreaderCallback()
+
+
+} // end namespace itk
+
+#endif // end #ifndef __itkRayCastGradientImageToImageMetric_hxx
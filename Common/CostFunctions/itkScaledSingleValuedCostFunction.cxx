@@ -46,6 +46,8 @@ ScaledSingleValuedCostFunction::MeasureType
 ScaledSingleValuedCostFunction
 ::GetValue( const ParametersType & parameters ) const
 {
+  ComponentProfiler::ScopedTimer profilerTimer( ComponentProfiler::MetricGetValue );
+
   /** F(y)= f(y/s) */
 
   /** This function also checks if the UnscaledCostFunction has been set */
@@ -59,7 +61,8 @@ ScaledSingleValuedCostFunction
 
   if( this->m_UseScales )
   {
-    ParametersType scaledParameters = parameters;
+    ParametersType & scaledParameters = this->m_UnscaledParameters;
+    scaledParameters = parameters;
     this->ConvertScaledToUnscaledParameters( scaledParameters );
     returnvalue = this->m_UnscaledCostFunction->GetValue( scaledParameters );
   }
@@ -86,6 +89,8 @@ ScaledSingleValuedCostFunction
 ::GetDerivative( const ParametersType & parameters,
   DerivativeType & derivative ) const
 {
+  ComponentProfiler::ScopedTimer profilerTimer( ComponentProfiler::MetricGetValueAndDerivative );
+
   /** dF/dy(y)= 1/s * df/dx(y/s) */
 
   /** This function also checks if the UnscaledCostFunction has been set */
@@ -97,7 +102,8 @@ ScaledSingleValuedCostFunction
 
   if( this->m_UseScales )
   {
-    ParametersType scaledParameters = parameters;
+    ParametersType & scaledParameters = this->m_UnscaledParameters;
+    scaledParameters = parameters;
     this->ConvertScaledToUnscaledParameters( scaledParameters );
     this->m_UnscaledCostFunction->GetDerivative( scaledParameters, derivative );
 
@@ -114,7 +120,7 @@ ScaledSingleValuedCostFunction
 
   if( this->GetNegateCostFunction() )
   {
-    derivative = -derivative;
+    derivative *= -1.0;
   }
 
 } // end GetDerivative()
@@ -130,6 +136,8 @@ ScaledSingleValuedCostFunction
   MeasureType & value,
   DerivativeType & derivative ) const
 {
+  ComponentProfiler::ScopedTimer profilerTimer( ComponentProfiler::MetricGetValueAndDerivative );
+
   /** F(y)= f(y/s) */
   /** dF/dy(y)= 1/s * df/dx(y/s) */
 
@@ -142,8 +150,8 @@ ScaledSingleValuedCostFunction
 
   if( this->m_UseScales )
   {
-
-    ParametersType scaledParameters = parameters;
+    ParametersType & scaledParameters = this->m_UnscaledParameters;
+    scaledParameters = parameters;
     this->ConvertScaledToUnscaledParameters( scaledParameters );
     this->m_UnscaledCostFunction->GetValueAndDerivative( scaledParameters, value, derivative );
 
@@ -161,12 +169,78 @@ ScaledSingleValuedCostFunction
   if( this->GetNegateCostFunction() )
   {
     value      = -value;
-    derivative = -derivative;
+    derivative *= -1.0;
   }
 
 } // end GetValueAndDerivative()
 
 
+/**
+ * **************** GetValues ************************
+ */
+
+void
+ScaledSingleValuedCostFunction
+::GetValues( const ParametersContainerType & parameters,
+  MeasureContainerType & values ) const
+{
+  ComponentProfiler::ScopedTimer profilerTimer( ComponentProfiler::MetricGetValue );
+
+  /** F(y)= f(y/s) */
+
+  /** This function also checks if the UnscaledCostFunction has been set */
+  const unsigned int numberOfParameters = this->GetNumberOfParameters();
+  const std::size_t  numberOfVectors    = parameters.size();
+  for( std::size_t k = 0; k < numberOfVectors; ++k )
+  {
+    if( parameters[ k ].GetSize() != numberOfParameters )
+    {
+      itkExceptionMacro( << "Number of parameters is not like the unscaled cost function expects." );
+    }
+  }
+
+  /** Convert all parameter vectors first, since the unscaled cost function
+   * may evaluate them concurrently.
+   */
+  const ParametersContainerType * unscaledParameters = &parameters;
+  if( this->m_UseScales )
+  {
+    this->m_UnscaledParametersContainer.resize( numberOfVectors );
+    for( std::size_t k = 0; k < numberOfVectors; ++k )
+    {
+      this->m_UnscaledParametersContainer[ k ] = parameters[ k ];
+      this->ConvertScaledToUnscaledParameters( this->m_UnscaledParametersContainer[ k ] );
+    }
+    unscaledParameters = &this->m_UnscaledParametersContainer;
+  }
+
+  /** Evaluate the batch at once when possible, and otherwise one by one. */
+  const BatchedCostFunctionInterface * batchedCostFunction
+    = dynamic_cast< const BatchedCostFunctionInterface * >( this->m_UnscaledCostFunction.GetPointer() );
+  if( batchedCostFunction )
+  {
+    batchedCostFunction->GetValues( *unscaledParameters, values );
+  }
+  else
+  {
+    values.resize( numberOfVectors );
+    for( std::size_t k = 0; k < numberOfVectors; ++k )
+    {
+      values[ k ] = this->m_UnscaledCostFunction->GetValue( ( *unscaledParameters )[ k ] );
+    }
+  }
+
+  if( this->GetNegateCostFunction() )
+  {
+    for( std::size_t k = 0; k < numberOfVectors; ++k )
+    {
+      values[ k ] = -values[ k ];
+    }
+  }
+
+} // end GetValues()
+
+
 /**
  * **************** GetNumberOfParameters ************************
  */
@@ -20,7 +20,9 @@
 #define __itkScaledSingleValuedCostFunction_h
 
 #include "itkSingleValuedCostFunction.h"
+#include "itkBatchedCostFunctionInterface.h"
 #include "itkIntTypes.h" //temp, needed for IdentifierType
+#include "itkComponentProfiler.h"
 
 namespace itk
 {
@@ -33,10 +35,16 @@ namespace itk
  * By default it does not apply any scaling. Use the method SetUseScales(true)
  * to enable the use of scales.
  *
+ * GetValues() evaluates several parameter vectors in one call. It passes
+ * the whole batch on to the unscaled cost function when that implements
+ * the BatchedCostFunctionInterface.
+ *
  * \ingroup Numerics
  */
 
-class ScaledSingleValuedCostFunction : public SingleValuedCostFunction
+class ScaledSingleValuedCostFunction :
+  public SingleValuedCostFunction,
+  public BatchedCostFunctionInterface
 {
 public:
 
@@ -63,6 +71,9 @@ public:
 
   typedef Array< double > ScalesType;
 
+  typedef BatchedCostFunctionInterface::ParametersContainerType ParametersContainerType;
+  typedef BatchedCostFunctionInterface::MeasureContainerType    MeasureContainerType;
+
   /** Divide the parameters by the scales and call the GetValue routine
    * of the unscaled cost function.
    */
@@ -82,6 +93,11 @@ public:
     MeasureType & value,
     DerivativeType & derivative ) const;
 
+  /** Same procedure as in GetValue, for several parameter vectors. */
+  virtual void GetValues(
+    const ParametersContainerType & parameters,
+    MeasureContainerType & values ) const;
+
   /** Ask the UnscaledCostFunction how many parameters it has. */
   virtual NumberOfParametersType GetNumberOfParameters( void ) const;
 
@@ -150,6 +166,13 @@ private:
   bool                            m_UseScales;
   bool                            m_NegateCostFunction;
 
+  /** Buffer for the unscaled parameters. It is reused in every call, so that
+   * no memory is allocated as long as the number of parameters is unchanged. */
+  mutable ParametersType m_UnscaledParameters;
+
+  /** The same for GetValues(), with one buffer for every parameter vector. */
+  mutable ParametersContainerType m_UnscaledParametersContainer;
+
 };
 
 } //end namespace itk
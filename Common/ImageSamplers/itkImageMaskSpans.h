@@ -0,0 +1,150 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkImageMaskSpans_h
+#define __itkImageMaskSpans_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkSpatialObject.h"
+#include "itkMultiThreader.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/** \class ImageMaskSpans
+ *
+ * \brief A run-length representation of the voxels of an image region
+ * that are inside a mask.
+ *
+ * The voxels of the region are visited in scanline order, i.e. with the
+ * first index running fastest. Every run of consecutive voxels along a
+ * scanline whose physical points are inside the mask is stored as a span:
+ * the linear offset of its first voxel in the region, and the cumulative
+ * number of inside voxels before it. The k-th inside voxel is then found
+ * with a binary search over the spans, without testing the mask again.
+ * This allows samplers to draw voxels uniformly from the mask.
+ *
+ * The spans are computed multi-threaded, using the PersistentThreadPool.
+ * Compute() does nothing when the mask, the image and the region did not
+ * change since the previous call.
+ *
+ * \ingroup ImageSamplers
+ */
+
+template< class TImage >
+class ImageMaskSpans : public Object
+{
+public:
+
+  /** Standard class typedefs. */
+  typedef ImageMaskSpans             Self;
+  typedef Object                     Superclass;
+  typedef SmartPointer< Self >       Pointer;
+  typedef SmartPointer< const Self > ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( ImageMaskSpans, Object );
+
+  /** Typedef's. */
+  typedef TImage                          ImageType;
+  typedef typename ImageType::IndexType   IndexType;
+  typedef typename ImageType::SizeType    SizeType;
+  typedef typename ImageType::RegionType  RegionType;
+  typedef typename ImageType::PointType   PointType;
+
+  /** The image dimension. */
+  itkStaticConstMacro( ImageDimension, unsigned int, ImageType::ImageDimension );
+
+  typedef SpatialObject< itkGetStaticConstMacro( ImageDimension ) > MaskType;
+
+  /** Compute the spans of the voxels of \a region of \a image that are
+   * inside \a mask, using \a numberOfThreads threads.
+   */
+  void Compute( const MaskType * mask, const ImageType * image,
+    const RegionType & region, ThreadIdType numberOfThreads );
+
+  /** Get the number of voxels inside the mask. */
+  SizeValueType GetNumberOfInsideVoxels( void ) const
+  {
+    return this->m_CumulativeSizes.back();
+  }
+
+  /** Get the index of the k-th voxel inside the mask, in scanline order. */
+  void GetInsideVoxel( SizeValueType k, IndexType & index ) const;
+
+protected:
+
+  ImageMaskSpans();
+  virtual ~ImageMaskSpans() {}
+
+  /** PrintSelf. */
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+private:
+
+  ImageMaskSpans( const Self & ); // purposely not implemented
+  void operator=( const Self & ); // purposely not implemented
+
+  /** Convert a linear offset in the region to an index. */
+  void OffsetToIndex( SizeValueType offset, IndexType & index ) const;
+
+  /** The data for the threads. */
+  typedef MultiThreader::ThreadInfoStruct ThreadInfoType;
+  struct MultiThreaderParameterType
+  {
+    Self *            st_Self;
+    const MaskType *  st_Mask;
+    const ImageType * st_Image;
+  };
+
+  /** Compute the spans of the scanlines of one thread. */
+  static ITK_THREAD_RETURN_TYPE ComputeThreaderCallback( void * arg );
+
+  /** The spans: the offset of the first voxel in the region, and the number
+   * of inside voxels before the span. m_CumulativeSizes has one element more
+   * than m_SpanOffsets, holding the total number of inside voxels.
+   */
+  std::vector< SizeValueType > m_SpanOffsets;
+  std::vector< SizeValueType > m_CumulativeSizes;
+  RegionType                   m_Region;
+
+  /** The spans found by every thread, for a range of scanlines. These are
+   * kept, so that a recomputation does not need to allocate them again.
+   */
+  std::vector< std::vector< SizeValueType > > m_ThreaderSpanOffsets;
+  std::vector< std::vector< SizeValueType > > m_ThreaderSpanSizes;
+
+  /** The input of the previous Compute(). */
+  const MaskType *  m_Mask;
+  const ImageType * m_Image;
+  ModifiedTimeType  m_Time;
+
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkImageMaskSpans.hxx"
+#endif
+
+#endif // end #ifndef __itkImageMaskSpans_h
@@ -0,0 +1,227 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkImageMaskSpans_hxx
+#define __itkImageMaskSpans_hxx
+
+#include "itkImageMaskSpans.h"
+#include "itkPersistentThreadPool.h"
+
+#include <algorithm>
+
+namespace itk
+{
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template< class TImage >
+ImageMaskSpans< TImage >
+::ImageMaskSpans()
+{
+  this->m_CumulativeSizes.assign( 1, 0 );
+  this->m_Mask  = 0;
+  this->m_Image = 0;
+  this->m_Time  = 0;
+
+} // end Constructor
+
+
+/**
+ * ******************* Compute *******************
+ */
+
+template< class TImage >
+void
+ImageMaskSpans< TImage >
+::Compute( const MaskType * mask, const ImageType * image,
+  const RegionType & region, ThreadIdType numberOfThreads )
+{
+  /** Nothing to do when the input did not change. */
+  if( mask == this->m_Mask && image == this->m_Image && region == this->m_Region
+    && mask->GetMTime() <= this->m_Time && image->GetMTime() <= this->m_Time )
+  {
+    return;
+  }
+
+  /** Find the spans of every thread. */
+  this->m_Region = region;
+  this->m_ThreaderSpanOffsets.resize( numberOfThreads );
+  this->m_ThreaderSpanSizes.resize( numberOfThreads );
+
+  MultiThreaderParameterType temp;
+  temp.st_Self  = this;
+  temp.st_Mask  = mask;
+  temp.st_Image = image;
+  PersistentThreadPool::SingleMethodExecute(
+    Self::ComputeThreaderCallback, &temp, numberOfThreads );
+
+  /** Concatenate the spans of the threads, which are in scanline order. */
+  const std::vector< std::vector< SizeValueType > > & spanOffsets = this->m_ThreaderSpanOffsets;
+  const std::vector< std::vector< SizeValueType > > & spanSizes   = this->m_ThreaderSpanSizes;
+  SizeValueType                                      numberOfSpans = 0;
+  for( ThreadIdType i = 0; i < numberOfThreads; ++i )
+  {
+    numberOfSpans += spanOffsets[ i ].size();
+  }
+  this->m_SpanOffsets.clear();
+  this->m_SpanOffsets.reserve( numberOfSpans );
+  this->m_CumulativeSizes.clear();
+  this->m_CumulativeSizes.reserve( numberOfSpans + 1 );
+  this->m_CumulativeSizes.push_back( 0 );
+  for( ThreadIdType i = 0; i < numberOfThreads; ++i )
+  {
+    for( std::size_t j = 0; j < spanOffsets[ i ].size(); ++j )
+    {
+      this->m_SpanOffsets.push_back( spanOffsets[ i ][ j ] );
+      this->m_CumulativeSizes.push_back(
+        this->m_CumulativeSizes.back() + spanSizes[ i ][ j ] );
+    }
+  }
+
+  /** Remember the input. */
+  this->m_Mask  = mask;
+  this->m_Image = image;
+  this->m_Time  = std::max( mask->GetMTime(), image->GetMTime() );
+
+} // end Compute()
+
+
+/**
+ * ******************* ComputeThreaderCallback *******************
+ */
+
+template< class TImage >
+ITK_THREAD_RETURN_TYPE
+ImageMaskSpans< TImage >
+::ComputeThreaderCallback( void * arg )
+{
+  ThreadInfoType * infoStruct  = static_cast< ThreadInfoType * >( arg );
+  ThreadIdType     threadId    = infoStruct->ThreadID;
+  ThreadIdType     nrOfThreads = infoStruct->NumberOfThreads;
+
+  MultiThreaderParameterType * temp
+    = static_cast< MultiThreaderParameterType * >( infoStruct->UserData );
+  Self *                         self    = temp->st_Self;
+  std::vector< SizeValueType > & offsets = self->m_ThreaderSpanOffsets[ threadId ];
+  std::vector< SizeValueType > & sizes   = self->m_ThreaderSpanSizes[ threadId ];
+  offsets.clear();
+  sizes.clear();
+
+  /** Divide the scanlines over the threads. */
+  const SizeValueType lineLength    = self->m_Region.GetSize()[ 0 ];
+  const SizeValueType numberOfLines = lineLength > 0 ? self->m_Region.GetNumberOfPixels() / lineLength : 0;
+  const SizeValueType firstLine     = ( numberOfLines * threadId ) / nrOfThreads;
+  const SizeValueType endLine       = ( numberOfLines * ( threadId + 1 ) ) / nrOfThreads;
+
+  /** Run over the voxels of the scanlines, and store the runs of inside voxels. */
+  IndexType index;
+  PointType point;
+  for( SizeValueType line = firstLine; line < endLine; ++line )
+  {
+    const SizeValueType lineOffset = line * lineLength;
+    self->OffsetToIndex( lineOffset, index );
+    SizeValueType spanSize = 0;
+    for( SizeValueType x = 0; x < lineLength; ++x )
+    {
+      temp->st_Image->TransformIndexToPhysicalPoint( index, point );
+      if( temp->st_Mask->IsInside( point ) )
+      {
+        if( spanSize == 0 )
+        {
+          offsets.push_back( lineOffset + x );
+        }
+        ++spanSize;
+      }
+      else if( spanSize > 0 )
+      {
+        sizes.push_back( spanSize );
+        spanSize = 0;
+      }
+      ++index[ 0 ];
+    }
+    if( spanSize > 0 )
+    {
+      sizes.push_back( spanSize );
+    }
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end ComputeThreaderCallback()
+
+
+/**
+ * ******************* GetInsideVoxel *******************
+ */
+
+template< class TImage >
+void
+ImageMaskSpans< TImage >
+::GetInsideVoxel( SizeValueType k, IndexType & index ) const
+{
+  /** Find the last span that starts at or before k. */
+  const std::size_t span = std::upper_bound( this->m_CumulativeSizes.begin(),
+    this->m_CumulativeSizes.end(), k ) - this->m_CumulativeSizes.begin() - 1;
+  this->OffsetToIndex( this->m_SpanOffsets[ span ]
+    + ( k - this->m_CumulativeSizes[ span ] ), index );
+
+} // end GetInsideVoxel()
+
+
+/**
+ * ******************* OffsetToIndex *******************
+ */
+
+template< class TImage >
+void
+ImageMaskSpans< TImage >
+::OffsetToIndex( SizeValueType offset, IndexType & index ) const
+{
+  const IndexType & start = this->m_Region.GetIndex();
+  const SizeType &  size  = this->m_Region.GetSize();
+  for( unsigned int d = 0; d < ImageDimension; ++d )
+  {
+    index[ d ] = start[ d ] + static_cast< IndexValueType >( offset % size[ d ] );
+    offset    /= size[ d ];
+  }
+
+} // end OffsetToIndex()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template< class TImage >
+void
+ImageMaskSpans< TImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "Region: " << this->m_Region << std::endl;
+  os << indent << "NumberOfSpans: " << this->m_SpanOffsets.size() << std::endl;
+  os << indent << "NumberOfInsideVoxels: " << this->GetNumberOfInsideVoxels() << std::endl;
+
+} // end PrintSelf()
+
+
+} // end namespace itk
+
+#endif // end #ifndef __itkImageMaskSpans_hxx
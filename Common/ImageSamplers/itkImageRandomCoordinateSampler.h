@@ -21,7 +21,7 @@
 #include "itkImageRandomSamplerBase.h"
 #include "itkInterpolateImageFunction.h"
 #include "itkBSplineInterpolateImageFunction.h"
-#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkRandomVariateGeneratorInstance.h"
 
 namespace itk
 {
@@ -33,6 +33,11 @@ namespace itk
  * This image sampler generates not only samples that correspond with
  * pixel locations, but selects points in physical space.
  *
+ * When multi-threaded and a mask is given, the candidate points are drawn
+ * within the voxels that are inside the mask, so that only few candidates
+ * are rejected. The combination of a mask with UseRandomSampleRegion is
+ * always sampled single-threaded.
+ *
  * \ingroup ImageSamplers
  */
 
@@ -73,6 +78,7 @@ public:
   typedef typename Superclass::InputImagePointType          InputImagePointType;
   typedef typename Superclass::InputImagePointValueType     InputImagePointValueType;
   typedef typename Superclass::ImageSampleValueType         ImageSampleValueType;
+  typedef typename Superclass::MaskSpansType                MaskSpansType;
 
   /** The input image dimension. */
   itkStaticConstMacro( InputImageDimension, unsigned int,
@@ -127,6 +133,9 @@ protected:
     const InputImageRegionType & inputRegionForThread,
     ThreadIdType threadId );
 
+  /** Draw the samples of a thread within the mask, using the mask spans. */
+  void ThreadedGenerateDataWithinMask( ThreadIdType threadId );
+
   /** Generate a point randomly in a bounding box. */
   virtual void GenerateRandomCoordinate(
     const InputImageContinuousIndexType & smallestContIndex,
@@ -21,6 +21,8 @@
 #include "itkImageRandomCoordinateSampler.h"
 #include "vnl/vnl_math.h"
 
+#include <algorithm>
+
 namespace itk
 {
 
@@ -39,7 +41,7 @@ ImageRandomCoordinateSampler< TInputImage >
   this->m_Interpolator = bsplineInterpolator;
 
   /** Setup random generator. */
-  this->m_RandomGenerator = RandomGeneratorType::GetInstance();
+  this->m_RandomGenerator = RandomVariateGeneratorInstance::Get();
 
   this->m_UseRandomSampleRegion = false;
   this->m_SampleRegionSize.Fill( 1.0 );
@@ -56,9 +58,11 @@ void
 ImageRandomCoordinateSampler< TInputImage >
 ::GenerateData( void )
 {
-  /** Get a handle to the mask. If there was no mask supplied we exercise a multi-threaded version. */
+  /** Get a handle to the mask. The multi-threaded version also handles a mask,
+   * but not in combination with a random sample region.
+   */
   typename MaskType::ConstPointer mask = this->GetMask();
-  if( mask.IsNull() && this->m_UseMultiThread )
+  if( this->m_UseMultiThread && ( mask.IsNull() || !this->m_UseRandomSampleRegion ) )
   {
     /** Calls ThreadedGenerateData(). */
     return Superclass::GenerateData();
@@ -182,6 +186,15 @@ ImageRandomCoordinateSampler< TInputImage >
   typename InterpolatorType::Pointer interpolator = this->GetModifiableInterpolator();
   interpolator->SetInputImage( this->GetInput() ); // only once per resolution?
 
+  /** With a mask, the threads draw their own random numbers. */
+  if( this->GetMask() )
+  {
+    this->InitializeMaskSpans();
+    this->InitializeRandomStreams();
+    this->InitializeThreaderSampleContainers();
+    return;
+  }
+
   /** Clear the random number list. */
   this->m_RandomNumberList.resize( 0 );
   this->m_RandomNumberList.reserve( this->m_NumberOfSamples * InputImageDimension );
@@ -209,12 +222,7 @@ ImageRandomCoordinateSampler< TInputImage >
   }
 
   /** Initialize variables needed for threads. */
-  this->m_ThreaderSampleContainer.clear();
-  this->m_ThreaderSampleContainer.resize( this->GetNumberOfThreads() );
-  for( std::size_t i = 0; i < this->GetNumberOfThreads(); i++ )
-  {
-    this->m_ThreaderSampleContainer[ i ] = ImageSampleContainerType::New();
-  }
+  this->InitializeThreaderSampleContainers();
 
 } // end BeforeThreadedGenerateData()
 
@@ -228,11 +236,11 @@ void
 ImageRandomCoordinateSampler< TInputImage >
 ::ThreadedGenerateData( const InputImageRegionType &, ThreadIdType threadId )
 {
-  /** Sanity check. */
-  typename MaskType::ConstPointer mask = this->GetMask();
-  if( mask.IsNotNull() )
+  /** Sample within the mask. */
+  if( this->GetMask() )
   {
-    itkExceptionMacro( << "ERROR: do not call this function when a mask is supplied." );
+    this->ThreadedGenerateDataWithinMask( threadId );
+    return;
   }
 
   /** Get handle to the input image. */
@@ -283,6 +291,97 @@ ImageRandomCoordinateSampler< TInputImage >
 } // end ThreadedGenerateData()
 
 
+/**
+ * ******************* ThreadedGenerateDataWithinMask *******************
+ */
+
+template< class TInputImage >
+void
+ImageRandomCoordinateSampler< TInputImage >
+::ThreadedGenerateDataWithinMask( ThreadIdType threadId )
+{
+  /** Get handles to the input image, the mask and the interpolator. */
+  InputImageConstPointer          inputImage   = this->GetInput();
+  typename MaskType::ConstPointer mask         = this->GetMask();
+  const InterpolatorType *        interpolator = this->m_Interpolator.GetPointer();
+  const MaskSpansType *           maskSpans    = this->m_MaskSpans.GetPointer();
+
+  /** Get the samples of this thread. */
+  unsigned long sampleBegin = 0;
+  unsigned long sampleEnd   = 0;
+  this->GetThreadSampleRange( threadId, sampleBegin, sampleEnd );
+  ImageSampleContainerType * sampleContainerThisThread
+    = this->m_ThreaderSampleContainer[ threadId ];
+  if( sampleEnd == sampleBegin )
+  {
+    return;
+  }
+  sampleContainerThisThread->Reserve( sampleEnd - sampleBegin );
+
+  /** The candidates should be in between the centers of the outer voxels
+   * of the region, like in the single-threaded version.
+   */
+  const InputImageRegionType & region = this->GetCroppedInputImageRegion();
+  InputImageContinuousIndexType smallestContIndex, largestContIndex;
+  for( unsigned int d = 0; d < InputImageDimension; ++d )
+  {
+    smallestContIndex[ d ] = region.GetIndex()[ d ];
+    largestContIndex[ d ]  = region.GetIndex()[ d ] + region.GetSize()[ d ] - 1.0;
+  }
+
+  /** Draw an inside voxel, and a uniform position within it. The candidate
+   * is still checked against the mask, which may be smoother than the voxel
+   * grid of the input image, so that the samples are uniformly distributed
+   * over the mask. Mostly only a few candidates are rejected.
+   */
+  const double                  numberOfInsideVoxels        = maskSpans->GetNumberOfInsideVoxels();
+  const unsigned long           maximumNumberOfSamplesToTry = 10 * ( sampleEnd - sampleBegin );
+  unsigned long                 numberOfSamplesTried        = 0;
+  bool                          inRegion                    = false;
+  InputImageIndexType           voxelIndex;
+  InputImageContinuousIndexType sampleContIndex;
+  for( unsigned long sampleId = sampleBegin; sampleId < sampleEnd; ++sampleId )
+  {
+    RandomGeneratorType * generator   = this->GetRandomStream( threadId, sampleId );
+    ImageSampleType &     sample      = ( *sampleContainerThisThread )[ sampleId - sampleBegin ];
+    InputImagePointType & samplePoint = sample.m_ImageCoordinates;
+    do
+    {
+      /** Check if we are not trying eternally to find a valid point. */
+      ++numberOfSamplesTried;
+      if( numberOfSamplesTried > maximumNumberOfSamplesToTry )
+      {
+        itkExceptionMacro( << "Could not find enough image samples within "
+                           << "reasonable time. Probably the mask is too small" );
+      }
+
+      /** Generate a point in an inside voxel. */
+      const SizeValueType k = std::min( static_cast< SizeValueType >(
+        generator->GetVariateWithOpenUpperRange( numberOfInsideVoxels ) ),
+        maskSpans->GetNumberOfInsideVoxels() - 1 );
+      maskSpans->GetInsideVoxel( k, voxelIndex );
+      inRegion = true;
+      for( unsigned int d = 0; d < InputImageDimension; ++d )
+      {
+        sampleContIndex[ d ] = voxelIndex[ d ]
+          + generator->GetVariateWithOpenUpperRange( 1.0 ) - 0.5;
+        inRegion &= sampleContIndex[ d ] >= smallestContIndex[ d ]
+          && sampleContIndex[ d ] <= largestContIndex[ d ];
+      }
+      inputImage->TransformContinuousIndexToPhysicalPoint( sampleContIndex, samplePoint );
+    }
+    while( !inRegion || !interpolator->IsInsideBuffer( sampleContIndex )
+      || !mask->IsInside( samplePoint ) );
+
+    /** Compute the value at the point. */
+    sample.m_ImageValue = static_cast< ImageSampleValueType >(
+      interpolator->EvaluateAtContinuousIndex( sampleContIndex ) );
+
+  } // end for loop
+
+} // end ThreadedGenerateDataWithinMask()
+
+
 /**
  * ******************* GenerateRandomCoordinate *******************
  */
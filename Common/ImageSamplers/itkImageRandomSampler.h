@@ -30,7 +30,9 @@ namespace itk
  * the InputImageRegion. Voxels may be selected multiple times.
  * If a mask is given, the sampler tries to find samples within the
  * mask. If the mask is very sparse, this may take some time. In this case,
- * consider using the ImageRandomSamplerSparseMask.
+ * consider using the ImageRandomSamplerSparseMask. The multi-threaded
+ * version draws directly from the voxels inside the mask, and does not
+ * have this problem.
  *
  * \ingroup ImageSamplers
  */
@@ -68,6 +70,8 @@ public:
   typedef typename Superclass::ImageSampleContainerPointer  ImageSampleContainerPointer;
   typedef typename Superclass::MaskType                     MaskType;
   typedef typename Superclass::InputImageSizeType           InputImageSizeType;
+  typedef typename Superclass::MaskSpansType                MaskSpansType;
+  typedef typename Superclass::RandomGeneratorType          RandomGeneratorType;
 
   /** The input image dimension. */
   itkStaticConstMacro( InputImageDimension, unsigned int,
@@ -87,10 +91,15 @@ protected:
   /** Functions that do the work. */
   virtual void GenerateData( void );
 
+  virtual void BeforeThreadedGenerateData( void );
+
   virtual void ThreadedGenerateData(
     const InputImageRegionType & inputRegionForThread,
     ThreadIdType threadId );
 
+  /** Draw the samples of a thread within the mask, using the mask spans. */
+  void ThreadedGenerateDataWithinMask( ThreadIdType threadId );
+
 private:
 
   /** The private constructor. */
@@ -23,6 +23,8 @@
 #include "itkMersenneTwisterRandomVariateGenerator.h"
 #include "itkImageRandomConstIteratorWithIndex.h"
 
+#include <algorithm>
+
 namespace itk
 {
 
@@ -35,9 +37,9 @@ void
 ImageRandomSampler< TInputImage >
 ::GenerateData( void )
 {
-  /** Get a handle to the mask. If there was no mask supplied we exercise a multi-threaded version. */
+  /** Get a handle to the mask. */
   typename MaskType::ConstPointer mask = this->GetMask();
-  if( mask.IsNull() && this->m_UseMultiThread )
+  if( this->m_UseMultiThread )
   {
     /** Calls ThreadedGenerateData(). */
     return Superclass::GenerateData();
@@ -133,6 +135,29 @@ ImageRandomSampler< TInputImage >
 } // end GenerateData()
 
 
+/**
+ * ******************* BeforeThreadedGenerateData *******************
+ */
+
+template< class TInputImage >
+void
+ImageRandomSampler< TInputImage >
+::BeforeThreadedGenerateData( void )
+{
+  /** Without a mask, the random positions are drawn beforehand. */
+  if( !this->GetMask() )
+  {
+    return Superclass::BeforeThreadedGenerateData();
+  }
+
+  /** With a mask, the threads draw their own random numbers. */
+  this->InitializeMaskSpans();
+  this->InitializeRandomStreams();
+  this->InitializeThreaderSampleContainers();
+
+} // end BeforeThreadedGenerateData()
+
+
 /**
  * ******************* ThreadedGenerateData *******************
  */
@@ -142,11 +167,11 @@ void
 ImageRandomSampler< TInputImage >
 ::ThreadedGenerateData( const InputImageRegionType &, ThreadIdType threadId )
 {
-  /** Sanity check. */
-  typename MaskType::ConstPointer mask = this->GetMask();
-  if( mask.IsNotNull() )
+  /** Sample within the mask. */
+  if( this->GetMask() )
   {
-    itkExceptionMacro( << "ERROR: do not call this function when a mask is supplied." );
+    this->ThreadedGenerateDataWithinMask( threadId );
+    return;
   }
 
   /** Get handle to the input image. */
@@ -202,6 +227,58 @@ ImageRandomSampler< TInputImage >
 } // end ThreadedGenerateData()
 
 
+/**
+ * ******************* ThreadedGenerateDataWithinMask *******************
+ */
+
+template< class TInputImage >
+void
+ImageRandomSampler< TInputImage >
+::ThreadedGenerateDataWithinMask( ThreadIdType threadId )
+{
+  /** Get handles to the input image and the mask spans. */
+  InputImageConstPointer inputImage = this->GetInput();
+  const MaskSpansType *  maskSpans  = this->m_MaskSpans.GetPointer();
+
+  /** Get the samples of this thread. */
+  unsigned long sampleBegin = 0;
+  unsigned long sampleEnd   = 0;
+  this->GetThreadSampleRange( threadId, sampleBegin, sampleEnd );
+  ImageSampleContainerType * sampleContainerThisThread
+    = this->m_ThreaderSampleContainer[ threadId ];
+  if( sampleEnd == sampleBegin )
+  {
+    return;
+  }
+  sampleContainerThisThread->Reserve( sampleEnd - sampleBegin );
+
+  /** Draw the voxels uniformly from the voxels inside the mask. This gives
+   * the same distribution as drawing from the whole region and rejecting
+   * the voxels outside the mask, without testing the mask.
+   */
+  const SizeValueType numberOfInsideVoxels = maskSpans->GetNumberOfInsideVoxels();
+  InputImageIndexType index;
+  for( unsigned long sampleId = sampleBegin; sampleId < sampleEnd; ++sampleId )
+  {
+    RandomGeneratorType * generator = this->GetRandomStream( threadId, sampleId );
+    ImageSampleType &     sample    = ( *sampleContainerThisThread )[ sampleId - sampleBegin ];
+
+    const SizeValueType k = std::min( static_cast< SizeValueType >(
+      generator->GetVariateWithOpenUpperRange( static_cast< double >( numberOfInsideVoxels ) ) ),
+      numberOfInsideVoxels - 1 );
+    maskSpans->GetInsideVoxel( k, index );
+
+    /** Transform index to the physical coordinates and put it in the sample. */
+    inputImage->TransformIndexToPhysicalPoint( index, sample.m_ImageCoordinates );
+
+    /** Get the value and put it in the sample. */
+    sample.m_ImageValue = static_cast< ImageSampleValueType >( inputImage->GetPixel( index ) );
+
+  } // end for loop
+
+} // end ThreadedGenerateDataWithinMask()
+
+
 } // end namespace itk
 
 #endif // end #ifndef __ImageRandomSampler_hxx
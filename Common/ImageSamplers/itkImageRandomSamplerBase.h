@@ -19,6 +19,8 @@
 #define __ImageRandomSamplerBase_h
 
 #include "itkImageSamplerBase.h"
+#include "itkImageMaskSpans.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
 
 namespace itk
 {
@@ -29,6 +31,13 @@ namespace itk
  *
  * It adds the Set/GetNumberOfSamples function.
  *
+ * For the multi-threaded sampling within a mask, it provides the mask as
+ * spans of inside voxels, and a random number stream for every thread. The
+ * samples are divided in blocks of RandomStreamBlockSize samples. Every block
+ * draws from a stream that is seeded with a per-update seed plus the block
+ * number, and every thread processes a range of whole blocks. The samples
+ * therefore do not depend on the number of threads.
+ *
  * \ingroup ImageSamplers
  */
 
@@ -71,6 +80,13 @@ public:
   /** Set the number of samples. */
   itkSetClampMacro( NumberOfSamples, unsigned long, 1, NumericTraits< unsigned long >::max() );
 
+  /** Typedefs for the multi-threaded sampling within a mask. */
+  typedef ImageMaskSpans< InputImageType >                  MaskSpansType;
+  typedef Statistics::MersenneTwisterRandomVariateGenerator RandomGeneratorType;
+
+  /** The number of samples that are drawn from one random number stream. */
+  itkStaticConstMacro( RandomStreamBlockSize, unsigned long, 256 );
+
 protected:
 
   /** The constructor. */
@@ -85,9 +101,31 @@ protected:
   /** PrintSelf. */
   void PrintSelf( std::ostream & os, Indent indent ) const;
 
+  /** Compute the spans of the cropped input image region that are inside the mask. */
+  void InitializeMaskSpans( void );
+
+  /** Draw the seed of the random number streams of this update, and create
+   * the generators of the threads when needed.
+   */
+  void InitializeRandomStreams( void );
+
+  /** Get the range of samples [begin, end) of a thread, consisting of whole blocks. */
+  void GetThreadSampleRange( ThreadIdType threadId,
+    unsigned long & begin, unsigned long & end ) const;
+
+  /** Get the random number generator of a thread, for a sample. At the start
+   * of a block, the generator is seeded for that block.
+   */
+  RandomGeneratorType * GetRandomStream( ThreadIdType threadId, unsigned long sampleId );
+
   /** Member variable used when threading. */
   std::vector< double > m_RandomNumberList;
 
+  /** Member variables used for the multi-threaded sampling within a mask. */
+  typename MaskSpansType::Pointer                      m_MaskSpans;
+  std::vector< typename RandomGeneratorType::Pointer > m_ThreaderRandomGenerators;
+  typename RandomGeneratorType::IntegerType            m_RandomStreamSeed;
+
 private:
 
   /** The private constructor. */
@@ -20,9 +20,11 @@
 
 #include "itkImageRandomSamplerBase.h"
 
-#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkRandomVariateGeneratorInstance.h"
 #include "itkImageRandomConstIteratorWithIndex.h"
 
+#include <algorithm>
+
 namespace itk
 {
 
@@ -34,7 +36,9 @@ template< class TInputImage >
 ImageRandomSamplerBase< TInputImage >
 ::ImageRandomSamplerBase()
 {
-  this->m_NumberOfSamples = 1000;
+  this->m_NumberOfSamples  = 1000;
+  this->m_MaskSpans        = MaskSpansType::New();
+  this->m_RandomStreamSeed = 0;
 
 } // end Constructor
 
@@ -50,7 +54,7 @@ ImageRandomSamplerBase< TInputImage >
 {
   /** Create a random number generator. Also used in the ImageRandomConstIteratorWithIndex. */
   typedef typename Statistics::MersenneTwisterRandomVariateGenerator::Pointer GeneratorPointer;
-  GeneratorPointer localGenerator = Statistics::MersenneTwisterRandomVariateGenerator::GetInstance();
+  GeneratorPointer localGenerator = RandomVariateGeneratorInstance::Get();
   // \todo: should probably be global?
 
   /** Clear the random number list. */
@@ -74,6 +78,105 @@ ImageRandomSamplerBase< TInputImage >
 } // end BeforeThreadedGenerateData()
 
 
+/**
+ * ******************* InitializeMaskSpans *******************
+ */
+
+template< class TInputImage >
+void
+ImageRandomSamplerBase< TInputImage >
+::InitializeMaskSpans( void )
+{
+  /** Update the mask. */
+  typename MaskType::ConstPointer mask = this->GetMask();
+  if( mask->GetSource() )
+  {
+    mask->GetSource()->Update();
+  }
+
+  /** Only recomputed when the mask, the input or the region changed. */
+  this->m_MaskSpans->Compute( mask, this->GetInput(),
+    this->GetCroppedInputImageRegion(), this->GetNumberOfThreads() );
+
+  if( this->m_MaskSpans->GetNumberOfInsideVoxels() == 0 )
+  {
+    itkExceptionMacro( << "Could not find enough image samples within "
+                       << "reasonable time. Probably the mask is too small" );
+  }
+
+} // end InitializeMaskSpans()
+
+
+/**
+ * ******************* InitializeRandomStreams *******************
+ */
+
+template< class TInputImage >
+void
+ImageRandomSamplerBase< TInputImage >
+::InitializeRandomStreams( void )
+{
+  /** Draw the seed from the global generator, so that the samples of every
+   * update differ, and are reproducible given the global seed.
+   */
+  this->m_RandomStreamSeed = RandomVariateGeneratorInstance::Get()->GetIntegerVariate();
+
+  /** The generators are created once, and reseeded for every block. */
+  const ThreadIdType numberOfThreads = this->GetNumberOfThreads();
+  if( this->m_ThreaderRandomGenerators.size() != numberOfThreads )
+  {
+    this->m_ThreaderRandomGenerators.resize( numberOfThreads );
+    for( ThreadIdType i = 0; i < numberOfThreads; ++i )
+    {
+      this->m_ThreaderRandomGenerators[ i ] = RandomGeneratorType::New();
+    }
+  }
+
+} // end InitializeRandomStreams()
+
+
+/**
+ * ******************* GetThreadSampleRange *******************
+ */
+
+template< class TInputImage >
+void
+ImageRandomSamplerBase< TInputImage >
+::GetThreadSampleRange( ThreadIdType threadId,
+  unsigned long & begin, unsigned long & end ) const
+{
+  const unsigned long blockSize       = RandomStreamBlockSize;
+  const unsigned long numberOfBlocks  = ( this->m_NumberOfSamples + blockSize - 1 ) / blockSize;
+  const unsigned long numberOfThreads = this->GetNumberOfThreads();
+
+  begin = std::min( ( numberOfBlocks * threadId ) / numberOfThreads * blockSize,
+    this->m_NumberOfSamples );
+  end = std::min( ( numberOfBlocks * ( threadId + 1 ) ) / numberOfThreads * blockSize,
+    this->m_NumberOfSamples );
+
+} // end GetThreadSampleRange()
+
+
+/**
+ * ******************* GetRandomStream *******************
+ */
+
+template< class TInputImage >
+typename ImageRandomSamplerBase< TInputImage >::RandomGeneratorType
+* ImageRandomSamplerBase< TInputImage >
+::GetRandomStream( ThreadIdType threadId, unsigned long sampleId )
+{
+  RandomGeneratorType * generator = this->m_ThreaderRandomGenerators[ threadId ];
+  if( sampleId % RandomStreamBlockSize == 0 )
+  {
+    generator->Initialize( static_cast< typename RandomGeneratorType::IntegerType >(
+      this->m_RandomStreamSeed + sampleId / RandomStreamBlockSize ) );
+  }
+  return generator;
+
+} // end GetRandomStream()
+
+
 /**
  * ******************* PrintSelf *******************
  */
@@ -32,7 +32,7 @@ ImageRandomSamplerSparseMask< TInputImage >
 ::ImageRandomSamplerSparseMask()
 {
   /** Setup random generator. */
-  this->m_RandomGenerator = RandomGeneratorType::GetInstance();
+  this->m_RandomGenerator = RandomVariateGeneratorInstance::Get();
 
   this->m_InternalFullSampler = InternalFullSamplerType::New();
 
@@ -144,12 +144,7 @@ ImageRandomSamplerSparseMask< TInputImage >
   }
 
   /** Initialize variables needed for threads. */
-  this->m_ThreaderSampleContainer.clear();
-  this->m_ThreaderSampleContainer.resize( this->GetNumberOfThreads() );
-  for( std::size_t i = 0; i < this->GetNumberOfThreads(); i++ )
-  {
-    this->m_ThreaderSampleContainer[ i ] = ImageSampleContainerType::New();
-  }
+  this->InitializeThreaderSampleContainers();
 
 } // end BeforeThreadedGenerateData()
 
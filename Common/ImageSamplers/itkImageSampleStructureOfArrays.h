@@ -0,0 +1,167 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkImageSampleStructureOfArrays_h
+#define __itkImageSampleStructureOfArrays_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkContinuousIndex.h"
+#include "itkImageSample.h"
+#include "itkVectorDataContainer.h"
+
+namespace itk
+{
+
+/** \class ImageSampleStructureOfArrays
+ *
+ * \brief A structure-of-arrays representation of an image sample container.
+ *
+ * The ImageSampleContainer stores the samples as an array of ImageSample
+ * structs, i.e. the coordinates of a point followed by its value. For loops
+ * that only need one of these quantities, or that want to process several
+ * samples at once, a structure-of-arrays layout is more cache friendly.
+ * This class stores, for every dimension, a separate contiguous array of
+ * physical coordinates and of continuous indices in the sampled image, and
+ * a contiguous array of the sample values. All arrays are aligned at
+ * Alignment bytes, so that they can be loaded with aligned vector loads.
+ *
+ * The continuous indices are computed once, when the samples are generated,
+ * so that metrics do not need to compute them again every iteration.
+ *
+ * \ingroup ImageSamplers
+ */
+
+template< class TImage >
+class ImageSampleStructureOfArrays : public Object
+{
+public:
+
+  /** Standard class typedefs. */
+  typedef ImageSampleStructureOfArrays Self;
+  typedef Object                       Superclass;
+  typedef SmartPointer< Self >         Pointer;
+  typedef SmartPointer< const Self >   ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( ImageSampleStructureOfArrays, Object );
+
+  /** Typedef's. */
+  typedef TImage                                                ImageType;
+  typedef ImageSample< ImageType >                              ImageSampleType;
+  typedef VectorDataContainer< unsigned long, ImageSampleType > ImageSampleContainerType;
+  typedef typename ImageSampleType::PointType                   PointType;
+  typedef typename ImageSampleType::RealType                    RealType;
+  typedef typename PointType::ValueType                         CoordinateValueType;
+  typedef double                                                ContinuousIndexValueType;
+  typedef ContinuousIndex< ContinuousIndexValueType,
+    ImageType::ImageDimension >                                 ContinuousIndexType;
+
+  /** The image dimension. */
+  itkStaticConstMacro( ImageDimension, unsigned int, ImageType::ImageDimension );
+
+  /** The alignment in bytes of all arrays. */
+  itkStaticConstMacro( Alignment, unsigned int, 32 );
+
+  /** Convert an array-of-structs sample container to this layout.
+   * The continuous indices are computed with respect to \a image.
+   * Memory is only reallocated when the number of samples grows.
+   */
+  void Fill( const ImageSampleContainerType * samples, const ImageType * image );
+
+  /** Get the number of samples. */
+  SizeValueType Size( void ) const { return this->m_Size; }
+
+  /** Whether the arrays were filled from \a samples, after its last
+   * modification. This compares the modification time of the container.
+   */
+  bool IsFilledFrom( const ImageSampleContainerType * samples ) const
+  {
+    return samples != 0 && this->m_Size == samples->Size()
+           && this->m_SamplesMTime == samples->GetMTime();
+  }
+
+
+  /** Get the array of physical coordinates in dimension \a dim. */
+  const CoordinateValueType * GetCoordinates( unsigned int dim ) const
+  {
+    return this->m_Coordinates[ dim ];
+  }
+
+
+  /** Get the array of continuous indices in dimension \a dim. */
+  const ContinuousIndexValueType * GetContinuousIndices( unsigned int dim ) const
+  {
+    return this->m_ContinuousIndices[ dim ];
+  }
+
+
+  /** Get the array of sample values. */
+  const RealType * GetValues( void ) const
+  {
+    return this->m_Values;
+  }
+
+
+  /** Convenience functions to get a single point or continuous index. */
+  void GetPoint( SizeValueType i, PointType & point ) const;
+
+  void GetContinuousIndex( SizeValueType i, ContinuousIndexType & cindex ) const;
+
+protected:
+
+  ImageSampleStructureOfArrays();
+  virtual ~ImageSampleStructureOfArrays();
+
+  /** PrintSelf. */
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+private:
+
+  ImageSampleStructureOfArrays( const Self & ); // purposely not implemented
+  void operator=( const Self & );               // purposely not implemented
+
+  /** Make sure all arrays can hold \a size samples. */
+  void Reserve( SizeValueType size );
+
+  /** Round a pointer up to the next multiple of Alignment. */
+  static char * AlignPointer( char * p );
+
+  /** A single buffer holds all arrays. */
+  char *        m_Buffer;
+  SizeValueType m_Capacity;
+  SizeValueType m_Size;
+
+  /** The modification time of the container that the arrays were filled from. */
+  ModifiedTimeType m_SamplesMTime;
+
+  CoordinateValueType *      m_Coordinates[ ImageType::ImageDimension ];
+  ContinuousIndexValueType * m_ContinuousIndices[ ImageType::ImageDimension ];
+  RealType *                 m_Values;
+
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkImageSampleStructureOfArrays.hxx"
+#endif
+
+#endif // end #ifndef __itkImageSampleStructureOfArrays_h
@@ -0,0 +1,208 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkImageSampleStructureOfArrays_hxx
+#define __itkImageSampleStructureOfArrays_hxx
+
+#include "itkImageSampleStructureOfArrays.h"
+
+namespace itk
+{
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template< class TImage >
+ImageSampleStructureOfArrays< TImage >
+::ImageSampleStructureOfArrays()
+{
+  this->m_Buffer       = 0;
+  this->m_Capacity     = 0;
+  this->m_Size         = 0;
+  this->m_SamplesMTime = 0;
+  this->m_Values       = 0;
+  for( unsigned int d = 0; d < ImageDimension; ++d )
+  {
+    this->m_Coordinates[ d ]       = 0;
+    this->m_ContinuousIndices[ d ] = 0;
+  }
+
+} // end Constructor
+
+
+/**
+ * ******************* Destructor *******************
+ */
+
+template< class TImage >
+ImageSampleStructureOfArrays< TImage >
+::~ImageSampleStructureOfArrays()
+{
+  delete[] this->m_Buffer;
+
+} // end Destructor
+
+
+/**
+ * ******************* AlignPointer *******************
+ */
+
+template< class TImage >
+char *
+ImageSampleStructureOfArrays< TImage >
+::AlignPointer( char * p )
+{
+  const std::size_t address = reinterpret_cast< std::size_t >( p );
+  const std::size_t aligned = ( address + Alignment - 1 ) & ~static_cast< std::size_t >( Alignment - 1 );
+  return p + ( aligned - address );
+
+} // end AlignPointer()
+
+
+/**
+ * ******************* Reserve *******************
+ */
+
+template< class TImage >
+void
+ImageSampleStructureOfArrays< TImage >
+::Reserve( SizeValueType size )
+{
+  if( size <= this->m_Capacity && this->m_Buffer != 0 )
+  {
+    return;
+  }
+
+  /** Compute the padded size of each array, and allocate one buffer
+   * with enough slack to align every array.
+   */
+  const std::size_t coordinateBytes = size * sizeof( CoordinateValueType ) + Alignment;
+  const std::size_t cindexBytes     = size * sizeof( ContinuousIndexValueType ) + Alignment;
+  const std::size_t valueBytes      = size * sizeof( RealType ) + Alignment;
+  const std::size_t totalBytes
+    = ImageDimension * ( coordinateBytes + cindexBytes ) + valueBytes + Alignment;
+
+  delete[] this->m_Buffer;
+  this->m_Buffer   = new char[ totalBytes ];
+  this->m_Capacity = size;
+
+  char * p = this->m_Buffer;
+  for( unsigned int d = 0; d < ImageDimension; ++d )
+  {
+    p                        = AlignPointer( p );
+    this->m_Coordinates[ d ] = reinterpret_cast< CoordinateValueType * >( p );
+    p                       += coordinateBytes - Alignment;
+  }
+  for( unsigned int d = 0; d < ImageDimension; ++d )
+  {
+    p                              = AlignPointer( p );
+    this->m_ContinuousIndices[ d ] = reinterpret_cast< ContinuousIndexValueType * >( p );
+    p                             += cindexBytes - Alignment;
+  }
+  p              = AlignPointer( p );
+  this->m_Values = reinterpret_cast< RealType * >( p );
+
+} // end Reserve()
+
+
+/**
+ * ******************* Fill *******************
+ */
+
+template< class TImage >
+void
+ImageSampleStructureOfArrays< TImage >
+::Fill( const ImageSampleContainerType * samples, const ImageType * image )
+{
+  const SizeValueType size = samples->Size();
+  this->Reserve( size );
+  this->m_Size = size;
+
+  ContinuousIndexType cindex;
+  for( SizeValueType i = 0; i < size; ++i )
+  {
+    const ImageSampleType & sample = samples->ElementAt( i );
+    image->TransformPhysicalPointToContinuousIndex( sample.m_ImageCoordinates, cindex );
+    for( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+      this->m_Coordinates[ d ][ i ]       = sample.m_ImageCoordinates[ d ];
+      this->m_ContinuousIndices[ d ][ i ] = cindex[ d ];
+    }
+    this->m_Values[ i ] = sample.m_ImageValue;
+  }
+
+  this->m_SamplesMTime = samples->GetMTime();
+  this->Modified();
+
+} // end Fill()
+
+
+/**
+ * ******************* GetPoint *******************
+ */
+
+template< class TImage >
+void
+ImageSampleStructureOfArrays< TImage >
+::GetPoint( SizeValueType i, PointType & point ) const
+{
+  for( unsigned int d = 0; d < ImageDimension; ++d )
+  {
+    point[ d ] = this->m_Coordinates[ d ][ i ];
+  }
+
+} // end GetPoint()
+
+
+/**
+ * ******************* GetContinuousIndex *******************
+ */
+
+template< class TImage >
+void
+ImageSampleStructureOfArrays< TImage >
+::GetContinuousIndex( SizeValueType i, ContinuousIndexType & cindex ) const
+{
+  for( unsigned int d = 0; d < ImageDimension; ++d )
+  {
+    cindex[ d ] = this->m_ContinuousIndices[ d ][ i ];
+  }
+
+} // end GetContinuousIndex()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template< class TImage >
+void
+ImageSampleStructureOfArrays< TImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "Size: " << this->m_Size << std::endl;
+  os << indent << "Capacity: " << this->m_Capacity << std::endl;
+
+} // end PrintSelf()
+
+
+} // end namespace itk
+
+#endif // end #ifndef __itkImageSampleStructureOfArrays_hxx
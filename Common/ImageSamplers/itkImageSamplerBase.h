@@ -20,8 +20,10 @@
 
 #include "itkImageToVectorContainerFilter.h"
 #include "itkImageSample.h"
+#include "itkImageSampleStructureOfArrays.h"
 #include "itkVectorDataContainer.h"
 #include "itkSpatialObject.h"
+#include "itkComponentProfiler.h"
 
 namespace itk
 {
@@ -77,6 +79,8 @@ public:
   typedef ImageSample< InputImageType >                         ImageSampleType;
   typedef VectorDataContainer< unsigned long, ImageSampleType > ImageSampleContainerType;
   typedef typename ImageSampleContainerType::Pointer            ImageSampleContainerPointer;
+  typedef ImageSampleStructureOfArrays< InputImageType >        ImageSampleStructureOfArraysType;
+  typedef typename ImageSampleStructureOfArraysType::Pointer    ImageSampleStructureOfArraysPointer;
   typedef typename InputImageType::SizeType                     InputImageSizeType;
   typedef typename InputImageType::IndexType                    InputImageIndexType;
   typedef typename InputImageType::PointType                    InputImagePointType;
@@ -170,6 +174,36 @@ public:
   /** \todo: Temporary, should think about interface. */
   itkSetMacro( UseMultiThread, bool );
 
+  /** Whether to also produce the samples in a structure-of-arrays layout,
+   * including the continuous indices of the samples in the input image.
+   * When set, the structure of arrays is regenerated every time the
+   * samples are regenerated. Default: false.
+   */
+  itkSetMacro( UseStructureOfArrays, bool );
+  itkGetConstMacro( UseStructureOfArrays, bool );
+  itkBooleanMacro( UseStructureOfArrays );
+
+  /** Get the samples in structure-of-arrays layout. Only up-to-date
+   * if UseStructureOfArrays is set.
+   */
+  const ImageSampleStructureOfArraysType * GetStructureOfArraysOutput( void ) const
+  {
+    return this->m_StructureOfArraysOutput.GetPointer();
+  }
+
+
+  /** Overridden to generate the structure-of-arrays output after the
+   * samples are generated by the GenerateData() of the subclass.
+   */
+  virtual void UpdateOutputData( DataObject * output );
+
+  /** Refill the structure-of-arrays output if UseStructureOfArrays is set
+   * and the sample container was modified after the last fill. Code that
+   * changes the samples outside the pipeline should call Modified() on the
+   * container.
+   */
+  virtual void UpdateStructureOfArraysOutput( void );
+
 protected:
 
   /** The constructor. */
@@ -203,6 +237,10 @@ protected:
 
   virtual void AfterThreadedGenerateData( void );
 
+  /** Create the per-thread sample containers, or empty them while keeping
+   * their memory when they already exist. */
+  void InitializeThreaderSampleContainers( void );
+
   /***/
   unsigned long                              m_NumberOfSamples;
   std::vector< ImageSampleContainerPointer > m_ThreaderSampleContainer;
@@ -210,6 +248,10 @@ protected:
   //tmp?
   bool m_UseMultiThread;
 
+  /** The structure-of-arrays version of the output. */
+  bool                                m_UseStructureOfArrays;
+  ImageSampleStructureOfArraysPointer m_StructureOfArraysOutput;
+
 private:
 
   /** The private constructor. */
@@ -225,6 +267,13 @@ private:
   InputImageRegionVectorType m_InputImageRegionVector;
   unsigned int               m_NumberOfInputImageRegions;
 
+  /** The bounding box of the mask in input image indices, cached by
+   * CropInputImageRegion(). */
+  InputImageRegionType   m_MaskBoundingBoxRegion;
+  const MaskType *       m_MaskBoundingBoxMask;
+  const InputImageType * m_MaskBoundingBoxInputImage;
+  ModifiedTimeType       m_MaskBoundingBoxTime;
+
   InputImageRegionType m_CroppedInputImageRegion;
   InputImageRegionType m_DummyInputImageRegion;
 
@@ -20,6 +20,8 @@
 
 #include "itkImageSamplerBase.h"
 
+#include <algorithm>
+
 namespace itk
 {
 
@@ -39,6 +41,13 @@ ImageSamplerBase< TInputImage >
   //tmp?
   this->m_UseMultiThread = false;
 
+  this->m_UseStructureOfArrays    = false;
+  this->m_StructureOfArraysOutput = ImageSampleStructureOfArraysType::New();
+
+  this->m_MaskBoundingBoxMask       = 0;
+  this->m_MaskBoundingBoxInputImage = 0;
+  this->m_MaskBoundingBoxTime       = 0;
+
 } // end Constructor()
 
 
@@ -343,54 +352,69 @@ ImageSamplerBase< TInputImage >
 
     this->UpdateAllMasks();
 
-    /** Get the indices of the bounding box extremes, based on the first mask.
-     * Note that the bounding box is defined in terms of the mask
-     * spacing and origin, and that we need a region in terms
-     * of the inputImage indices.
+    /** The bounding box region only depends on the mask and on the geometry
+     * of the input image. Computing it allocates memory, so the previous
+     * result is reused when neither of them has been modified since.
      */
-
-    typedef typename MaskType::BoundingBoxType        BoundingBoxType;
-    typedef typename BoundingBoxType::PointsContainer PointsContainerType;
-    typename BoundingBoxType::Pointer bb      = this->m_Mask->GetBoundingBox();
-    typename BoundingBoxType::Pointer bbIndex = BoundingBoxType::New();
-    const PointsContainerType * cornersWorld = bb->GetPoints();
-    typename PointsContainerType::Pointer cornersIndex = PointsContainerType::New();
-    cornersIndex->Reserve( cornersWorld->Size() );
-    typename PointsContainerType::const_iterator itCW = cornersWorld->begin();
-    typename PointsContainerType::iterator itCI       = cornersIndex->begin();
-    typedef itk::ContinuousIndex<
-      InputImagePointValueType, InputImageDimension > CIndexType;
-    CIndexType cindex;
-    while( itCW != cornersWorld->end() )
+    const ModifiedTimeType maskTime  = this->m_Mask->GetMTime();
+    const ModifiedTimeType imageTime = inputImage->GetMTime();
+    if( this->m_Mask.GetPointer() != this->m_MaskBoundingBoxMask
+      || inputImage.GetPointer() != this->m_MaskBoundingBoxInputImage
+      || maskTime > this->m_MaskBoundingBoxTime
+      || imageTime > this->m_MaskBoundingBoxTime )
     {
-      inputImage->TransformPhysicalPointToContinuousIndex( *itCW, cindex );
-      *itCI = cindex;
-      itCI++;
-      itCW++;
+      /** Get the indices of the bounding box extremes, based on the first mask.
+       * Note that the bounding box is defined in terms of the mask
+       * spacing and origin, and that we need a region in terms
+       * of the inputImage indices.
+       */
+
+      typedef typename MaskType::BoundingBoxType        BoundingBoxType;
+      typedef typename BoundingBoxType::PointsContainer PointsContainerType;
+      typename BoundingBoxType::Pointer bb      = this->m_Mask->GetBoundingBox();
+      typename BoundingBoxType::Pointer bbIndex = BoundingBoxType::New();
+      const PointsContainerType * cornersWorld = bb->GetPoints();
+      typename PointsContainerType::Pointer cornersIndex = PointsContainerType::New();
+      cornersIndex->Reserve( cornersWorld->Size() );
+      typename PointsContainerType::const_iterator itCW = cornersWorld->begin();
+      typename PointsContainerType::iterator itCI       = cornersIndex->begin();
+      typedef itk::ContinuousIndex<
+        InputImagePointValueType, InputImageDimension > CIndexType;
+      CIndexType cindex;
+      while( itCW != cornersWorld->end() )
+      {
+        inputImage->TransformPhysicalPointToContinuousIndex( *itCW, cindex );
+        *itCI = cindex;
+        itCI++;
+        itCW++;
+      }
+      bbIndex->SetPoints( cornersIndex );
+      bbIndex->ComputeBoundingBox();
+
+      /** Create a bounding box region. */
+      InputImageIndexType minIndex, maxIndex;
+      typedef typename InputImageIndexType::IndexValueType IndexValueType;
+      InputImageSizeType size;
+      for( unsigned int i = 0; i < InputImageDimension; ++i )
+      {
+        /** apply ceil/floor for max/min resp. to be sure that
+        * the bounding box is not too small */
+        maxIndex[ i ] = static_cast< IndexValueType >(
+          vcl_ceil( bbIndex->GetMaximum()[ i ] ) );
+        minIndex[ i ] = static_cast< IndexValueType >(
+          vcl_floor( bbIndex->GetMinimum()[ i ] ) );
+        size[ i ] = maxIndex[ i ] - minIndex[ i ] + 1;
+      }
+      this->m_MaskBoundingBoxRegion.SetIndex( minIndex );
+      this->m_MaskBoundingBoxRegion.SetSize( size );
+
+      this->m_MaskBoundingBoxMask       = this->m_Mask.GetPointer();
+      this->m_MaskBoundingBoxInputImage = inputImage.GetPointer();
+      this->m_MaskBoundingBoxTime       = std::max( maskTime, imageTime );
     }
-    bbIndex->SetPoints( cornersIndex );
-    bbIndex->ComputeBoundingBox();
-
-    /** Create a bounding box region. */
-    InputImageIndexType minIndex, maxIndex;
-    typedef typename InputImageIndexType::IndexValueType IndexValueType;
-    InputImageSizeType   size;
-    InputImageRegionType boundingBoxRegion;
-    for( unsigned int i = 0; i < InputImageDimension; ++i )
-    {
-      /** apply ceil/floor for max/min resp. to be sure that
-      * the bounding box is not too small */
-      maxIndex[ i ] = static_cast< IndexValueType >(
-        vcl_ceil( bbIndex->GetMaximum()[ i ] ) );
-      minIndex[ i ] = static_cast< IndexValueType >(
-        vcl_floor( bbIndex->GetMinimum()[ i ] ) );
-      size[ i ] = maxIndex[ i ] - minIndex[ i ] + 1;
-    }
-    boundingBoxRegion.SetIndex( minIndex );
-    boundingBoxRegion.SetSize( size );
 
     /** Compute the intersection. */
-    bool cropped = this->m_CroppedInputImageRegion.Crop( boundingBoxRegion );
+    bool cropped = this->m_CroppedInputImageRegion.Crop( this->m_MaskBoundingBoxRegion );
 
     /** If the cropping return false, then the intersection is empty.
      * In this case m_CroppedInputImageRegion is unchanged,
@@ -416,14 +440,39 @@ ImageSamplerBase< TInputImage >
 ::BeforeThreadedGenerateData( void )
 {
   /** Initialize variables needed for threads. */
-  this->m_ThreaderSampleContainer.clear();
-  this->m_ThreaderSampleContainer.resize( this->GetNumberOfThreads() );
-  for( std::size_t i = 0; i < this->GetNumberOfThreads(); i++ )
+  this->InitializeThreaderSampleContainers();
+
+} // end BeforeThreadedGenerateData()
+
+
+/**
+ * ******************* InitializeThreaderSampleContainers *******************
+ */
+
+template< class TInputImage >
+void
+ImageSamplerBase< TInputImage >
+::InitializeThreaderSampleContainers( void )
+{
+  /** The per-thread containers are created once, and only emptied for
+   * the next update. Emptying keeps the capacity of the underlying vector,
+   * so that in the steady state the threads fill them without allocating.
+   */
+  const std::size_t numberOfThreads = this->GetNumberOfThreads();
+  this->m_ThreaderSampleContainer.resize( numberOfThreads );
+  for( std::size_t i = 0; i < numberOfThreads; i++ )
   {
-    this->m_ThreaderSampleContainer[ i ] = ImageSampleContainerType::New();
+    if( this->m_ThreaderSampleContainer[ i ].IsNull() )
+    {
+      this->m_ThreaderSampleContainer[ i ] = ImageSampleContainerType::New();
+    }
+    else
+    {
+      this->m_ThreaderSampleContainer[ i ]->Initialize();
+    }
   }
 
-} // end BeforeThreadedGenerateData()
+} // end InitializeThreaderSampleContainers()
 
 
 /**
@@ -458,6 +507,49 @@ ImageSamplerBase< TInputImage >
 } // end AfterThreadedGenerateData()
 
 
+/**
+ * ******************* UpdateOutputData *******************
+ */
+
+template< class TInputImage >
+void
+ImageSamplerBase< TInputImage >
+::UpdateOutputData( DataObject * output )
+{
+  ComponentProfiler::ScopedTimer profilerTimer( ComponentProfiler::ImageSamplerUpdate );
+
+  /** Let the subclass generate the samples. This function is only
+   * called by the pipeline when the samples need to be regenerated.
+   */
+  Superclass::UpdateOutputData( output );
+
+  /** The subclasses fill the container without modifying it, so mark the
+   * new samples here, and convert them when needed.
+   */
+  this->GetOutput()->Modified();
+  this->UpdateStructureOfArraysOutput();
+
+} // end UpdateOutputData()
+
+
+/**
+ * ******************* UpdateStructureOfArraysOutput *******************
+ */
+
+template< class TInputImage >
+void
+ImageSamplerBase< TInputImage >
+::UpdateStructureOfArraysOutput( void )
+{
+  if( this->m_UseStructureOfArrays
+    && !this->m_StructureOfArraysOutput->IsFilledFrom( this->GetOutput() ) )
+  {
+    this->m_StructureOfArraysOutput->Fill( this->GetOutput(), this->GetInput() );
+  }
+
+} // end UpdateStructureOfArraysOutput()
+
+
 /**
  * ******************* PrintSelf *******************
  */
@@ -485,6 +577,7 @@ ImageSamplerBase< TInputImage >
     os << indent.GetNextIndent() << this->m_InputImageRegionVector[ i ] << std::endl;
   }
   os << indent << "CroppedInputImageRegion" << this->m_CroppedInputImageRegion << std::endl;
+  os << indent << "UseStructureOfArrays: " << this->m_UseStructureOfArrays << std::endl;
 
 } // end PrintSelf()
 
@@ -19,6 +19,7 @@
 #define __itkImageToVectorContainerFilter_h
 
 #include "itkVectorContainerSource.h"
+#include "itkPersistentThreadPool.h"
 
 namespace itk
 {
@@ -227,11 +227,9 @@ ImageToVectorContainerFilter< TInputImage, TOutputVectorContainer >
   ThreadStruct str;
   str.Filter = this;
 
-  this->GetMultiThreader()->SetNumberOfThreads( this->GetNumberOfThreads() );
-  this->GetMultiThreader()->SetSingleMethod( this->ThreaderCallback, &str );
-
-  // multithread the execution
-  this->GetMultiThreader()->SingleMethodExecute();
+  // multithread the execution, using the persistent thread pool
+  PersistentThreadPool::SingleMethodExecute( this->ThreaderCallback, &str,
+    this->GetNumberOfThreads() );
 
   // Call a method that can be overridden by a subclass to perform
   // some calculations after all the threads have completed
@@ -21,7 +21,7 @@
 #include "itkImageRandomSamplerBase.h"
 #include "itkInterpolateImageFunction.h"
 #include "itkBSplineInterpolateImageFunction.h"
-#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkRandomVariateGeneratorInstance.h"
 
 namespace itk
 {
@@ -40,7 +40,7 @@ MultiInputImageRandomCoordinateSampler< TInputImage >
   this->m_Interpolator = bsplineInterpolator;
 
   /** Setup the random generator. */
-  this->m_RandomGenerator = RandomGeneratorType::GetInstance();
+  this->m_RandomGenerator = RandomVariateGeneratorInstance::Get();
 
   this->m_UseRandomSampleRegion = false;
   this->m_SampleRegionSize.Fill( 1.0 );
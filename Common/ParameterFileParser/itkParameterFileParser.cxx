@@ -22,7 +22,8 @@
 #include "itkParameterFileParser.h"
 
 #include <itksys/SystemTools.hxx>
-#include <itksys/RegularExpression.hxx>
+
+#include <algorithm>
 
 namespace itk
 {
@@ -185,24 +186,23 @@ ParameterFileParser
    * 2) Remove everything after comment sign //
    * 3) Remove leading spaces
    * 4) Remove trailing spaces
+   * This is done in a single pass over the characters, since lines with
+   * many parameter values (e.g. TransformParameters) can be very long.
    */
-  lineOut = lineIn;
-  itksys::SystemTools::ReplaceString( lineOut, "\t", " " );
-
-  itksys::RegularExpression commentPart( "//" );
-  if( commentPart.find( lineOut ) )
+  std::string::size_type end = lineIn.find( "//" );
+  if( end == std::string::npos )
   {
-    lineOut = lineOut.substr( 0, commentPart.start() );
+    end = lineIn.size();
   }
 
-  itksys::RegularExpression leadingSpaces( "^[ ]*(.*)" );
-  leadingSpaces.find( lineOut );
-  lineOut = leadingSpaces.match( 1 );
-
-  itksys::RegularExpression trailingSpaces( "[ \t]+$" );
-  if( trailingSpaces.find( lineOut ) )
+  std::string::size_type begin = 0;
+  while( begin < end && ( lineIn[ begin ] == ' ' || lineIn[ begin ] == '\t' ) )
   {
-    lineOut = lineOut.substr( 0, trailingSpaces.start() );
+    ++begin;
+  }
+  while( end > begin && ( lineIn[ end - 1 ] == ' ' || lineIn[ end - 1 ] == '\t' ) )
+  {
+    --end;
   }
 
   /**
@@ -215,37 +215,30 @@ ParameterFileParser
    * Otherwise return true.
    */
 
-  /** 1. Check for non-empty lines. */
-  itksys::RegularExpression reNonEmptyLine( "[^ ]+" );
-  bool                      match1 = reNonEmptyLine.find( lineOut );
-  if( !match1 )
-  {
-    return false;
-  }
-
-  /** 2. Check for comments. */
-  itksys::RegularExpression reComment( "^//" );
-  bool                      match2 = reComment.find( lineOut );
-  if( match2 )
+  /** 1. and 2. Check for empty lines. Comments have already been removed,
+   * so a line starting with a comment is empty at this point.
+   */
+  if( begin == end )
   {
+    lineOut = "";
     return false;
   }
 
   /** 3. Check if line is between brackets. */
-  if( !itksys::SystemTools::StringStartsWith( lineOut.c_str(), "(" )
-    || !itksys::SystemTools::StringEndsWith( lineOut.c_str(), ")" ) )
+  if( lineIn[ begin ] != '(' || lineIn[ end - 1 ] != ')' || end - begin < 2 )
   {
     std::string hint = "Line is not between brackets: \"(...)\".";
     this->ThrowException( lineIn, hint );
   }
 
-  /** Remove brackets. */
-  lineOut = lineOut.substr( 1, lineOut.size() - 2 );
+  /** Remove brackets, and replace the tabs. */
+  lineOut.assign( lineIn, begin + 1, end - begin - 2 );
+  std::replace( lineOut.begin(), lineOut.end(), '\t', ' ' );
 
   /** 4. Check: the line should contain at least two words. */
-  itksys::RegularExpression reTwoWords( "([ ]+)([^ ]+)" );
-  bool                      match4 = reTwoWords.find( lineOut );
-  if( !match4 )
+  const std::string::size_type firstSpace = lineOut.find( ' ' );
+  if( firstSpace == std::string::npos
+    || lineOut.find_first_not_of( ' ', firstSpace ) == std::string::npos )
   {
     std::string hint = "Line does not contain a parameter name and value.";
     this->ThrowException( lineIn, hint );
@@ -286,22 +279,32 @@ ParameterFileParser
   /** 2) Get the parameter name. */
   std::string parameterName = splittedLine[ 0 ];
   itksys::SystemTools::ReplaceString( parameterName, " ", "" );
-  splittedLine.erase( splittedLine.begin() );
 
-  /** 3) Get the parameter values. */
-  std::vector< std::string > parameterValues;
-  for( unsigned int i = 0; i < splittedLine.size(); ++i )
+  /** 3) Get the parameter values. The strings are swapped instead of
+   * copied, which matters for parameters with very many values.
+   */
+  std::size_t numberOfValues = 0;
+  for( std::size_t i = 1; i < splittedLine.size(); ++i )
   {
-    if( splittedLine[ i ] != "" )
+    if( !splittedLine[ i ].empty() )
     {
-      parameterValues.push_back( splittedLine[ i ] );
+      ++numberOfValues;
+    }
+  }
+  std::vector< std::string > parameterValues( numberOfValues );
+  numberOfValues = 0;
+  for( std::size_t i = 1; i < splittedLine.size(); ++i )
+  {
+    if( !splittedLine[ i ].empty() )
+    {
+      parameterValues[ numberOfValues++ ].swap( splittedLine[ i ] );
     }
   }
 
-  /** 4) Perform some checks on the parameter name. */
-  itksys::RegularExpression reInvalidCharacters1( "[.,:;!@#$%^&-+|<>?]" );
-  bool                      match = reInvalidCharacters1.find( parameterName );
-  if( match )
+  /** 4) Perform some checks on the parameter name.
+   * Note that the range "&-+" includes the characters '()*.
+   */
+  if( parameterName.find_first_of( ".,:;!@#$%^&'()*+|<>?" ) != std::string::npos )
   {
     std::string hint = "The parameter \""
       + parameterName
@@ -310,11 +313,10 @@ ParameterFileParser
   }
 
   /** 5) Perform checks on the parameter values. */
-  itksys::RegularExpression reInvalidCharacters2( "[,;!@#$%&|<>?]" );
-  for( unsigned int i = 0; i < parameterValues.size(); ++i )
+  for( std::size_t i = 0; i < parameterValues.size(); ++i )
   {
     /** For all entries some characters are not allowed. */
-    if( reInvalidCharacters2.find( parameterValues[ i ] ) )
+    if( parameterValues[ i ].find_first_of( ",;!@#$%&|<>?" ) != std::string::npos )
     {
       std::string hint = "The parameter value \""
         + parameterValues[ i ]
@@ -333,7 +335,7 @@ ParameterFileParser
   }
   else
   {
-    this->m_ParameterMap.insert( make_pair( parameterName, parameterValues ) );
+    this->m_ParameterMap[ parameterName ].swap( parameterValues );
   }
 
 } // end GetParameterFromLine()
@@ -349,14 +351,12 @@ ParameterFileParser
   std::vector< std::string > & splittedLine ) const
 {
   splittedLine.clear();
-  splittedLine.resize( 1 );
-  std::vector< itksys::String > splittedLine1;
 
   /** Count the number of quotes in the line. If it is an odd value, the
    * line contains an error; strings should start and end with a quote, so
    * the total number of quotes is even.
    */
-  std::size_t numQuotes = itksys::SystemTools::CountChar( line.c_str(), '"' );
+  std::size_t numQuotes = std::count( line.begin(), line.end(), '"' );
   if( numQuotes % 2 == 1 )
   {
     /** An invalid parameter line. */
@@ -364,40 +364,28 @@ ParameterFileParser
     this->ThrowException( fullLine, hint );
   }
 
-  /** Loop over the line. */
-  std::string::const_iterator it;
-  unsigned int                index = 0;
+  /** Loop over the line. A quote always starts a new element, a space only
+   * when it is not inside a quoted string. Each element is copied in one go.
+   */
+  splittedLine.reserve( std::count( line.begin(), line.end(), ' ' ) + numQuotes + 1 );
+  std::string::size_type start = 0;
   numQuotes = 0;
-  for( it = line.begin(); it < line.end(); ++it )
+  for( std::string::size_type i = 0; i < line.size(); ++i )
   {
-    if( *it == '"' )
+    const char c = line[ i ];
+    if( c == '"' || ( c == ' ' && numQuotes % 2 == 0 ) )
     {
-      /** Start a new element. */
-      splittedLine.push_back( "" );
-      index++;
-      numQuotes++;
-    }
-    else if( *it == ' ' )
-    {
-      /** Only start a new element if it is not a quote, otherwise just add
-       * the space to the string.
-       */
-      if( numQuotes % 2 == 0 )
-      {
-        splittedLine.push_back( "" );
-        index++;
-      }
-      else
+      splittedLine.push_back( std::string() );
+      splittedLine.back().assign( line, start, i - start );
+      start = i + 1;
+      if( c == '"' )
       {
-        splittedLine[ index ].push_back( *it );
+        ++numQuotes;
       }
     }
-    else
-    {
-      /** Add this character to the element. */
-      splittedLine[ index ].push_back( *it );
-    }
   }
+  splittedLine.push_back( std::string() );
+  splittedLine.back().assign( line, start, line.size() - start );
 
 } // end SplitLine()
 
@@ -18,6 +18,66 @@
 
 #include "itkParameterMapInterface.h"
 
+#include <cerrno>
+#include <cmath>
+#include <clocale>
+#include <cstdlib>
+#include <locale>
+#include <sstream>
+
+#if defined( _MSC_VER )
+#include <locale.h>
+#define ELX_HAVE_STRTOD_L
+#elif defined( __APPLE__ ) || defined( __FreeBSD__ )
+#include <xlocale.h>
+#define ELX_HAVE_STRTOD_L
+#elif defined( __GLIBC__ ) && defined( _GNU_SOURCE )
+#define ELX_HAVE_STRTOD_L
+#endif
+
+namespace
+{
+
+#ifdef ELX_HAVE_STRTOD_L
+
+/** The "C" locale, for converting strings to doubles independent of the
+ * global locale, which the application may have changed.
+ */
+class CLocale
+{
+public:
+
+#if defined( _MSC_VER )
+  typedef _locale_t LocaleType;
+  CLocale() : m_Locale( _create_locale( LC_NUMERIC, "C" ) ) {}
+  ~CLocale() { if( this->m_Locale ) { _free_locale( this->m_Locale ); } }
+  double StringToDouble( const char * begin, char ** end ) const
+  {
+    return _strtod_l( begin, end, this->m_Locale );
+  }
+#else
+  typedef locale_t LocaleType;
+  CLocale() : m_Locale( newlocale( LC_NUMERIC_MASK, "C", static_cast< locale_t >( 0 ) ) ) {}
+  ~CLocale() { if( this->m_Locale ) { freelocale( this->m_Locale ); } }
+  double StringToDouble( const char * begin, char ** end ) const
+  {
+    return strtod_l( begin, end, this->m_Locale );
+  }
+#endif
+
+  bool IsValid( void ) const { return this->m_Locale != 0; }
+
+private:
+
+  LocaleType m_Locale;
+};
+
+const CLocale cLocale;
+
+#endif
+
+} // end namespace
+
 namespace itk
 {
 
@@ -133,6 +193,91 @@ ParameterMapInterface
 } // end ReadParameter()
 
 
+/**
+ * **************** StringToFloatingPoint ***************
+ */
+
+bool
+ParameterMapInterface
+::StringToFloatingPoint( const char * begin, double & value )
+{
+#ifdef ELX_HAVE_STRTOD_L
+  if( cLocale.IsValid() )
+  {
+    char * end = 0;
+    errno = 0;
+    value = cLocale.StringToDouble( begin, &end );
+    if( end == begin || errno == ERANGE )
+    {
+      return false;
+    }
+
+    /** strtod also accepts hexadecimal numbers, "nan" and "inf", which a
+     * string stream, and therefore the parameter file syntax, does not.
+     */
+    for( const char * c = begin; c != end; ++c )
+    {
+      if( *c == 'x' || *c == 'X' )
+      {
+        return false;
+      }
+    }
+    return value == value && std::fabs( value ) <= NumericTraits< double >::max();
+  }
+#endif
+
+  /** Fall back to a stream with the classic locale. It fails when no number
+   * is found, and when the number is out of range.
+   */
+  std::istringstream stream( begin );
+  stream.imbue( std::locale::classic() );
+  stream >> value;
+  return !stream.fail() && value == value
+         && std::fabs( value ) <= NumericTraits< double >::max();
+
+} // end StringToFloatingPoint()
+
+
+/**
+ * **************** StringToSignedInteger ***************
+ */
+
+bool
+ParameterMapInterface
+::StringToSignedInteger( const char * begin, int64_t & value )
+{
+  char * end = 0;
+  errno = 0;
+#if defined( _MSC_VER )
+  value = static_cast< int64_t >( _strtoi64( begin, &end, 10 ) );
+#else
+  value = static_cast< int64_t >( strtoll( begin, &end, 10 ) );
+#endif
+  return end != begin && errno != ERANGE;
+
+} // end StringToSignedInteger()
+
+
+/**
+ * **************** StringToUnsignedInteger ***************
+ */
+
+bool
+ParameterMapInterface
+::StringToUnsignedInteger( const char * begin, uint64_t & value )
+{
+  char * end = 0;
+  errno = 0;
+#if defined( _MSC_VER )
+  value = static_cast< uint64_t >( _strtoui64( begin, &end, 10 ) );
+#else
+  value = static_cast< uint64_t >( strtoull( begin, &end, 10 ) );
+#endif
+  return end != begin && errno != ERANGE;
+
+} // end StringToUnsignedInteger()
+
+
 /**
  * **************** StringCast ***************
  */
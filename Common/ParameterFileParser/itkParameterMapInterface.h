@@ -23,6 +23,7 @@
 #include "itkObjectFactory.h"
 #include "itkMacro.h"
 #include "itkNumericTraits.h"
+#include "itkIntTypes.h"
 
 #include "itkParameterFileParser.h"
 
@@ -291,6 +292,40 @@ public:
     const unsigned int entry_nr_end,
     const bool printThisErrorMessage,
     std::string & errorMessage ) const
+  {
+    /** The vector is expected to be large enough; it is not resized.
+     * Only an existing parameter is copied, so only then check its size.
+     */
+    const std::size_t numberOfValues = entry_nr_end >= entry_nr_start
+      ? entry_nr_end - entry_nr_start + 1 : 0;
+    if( parameterValues.size() < numberOfValues
+      && this->CountNumberOfParameterEntries( parameterName ) > 0 )
+    {
+      itkExceptionMacro( << "ERROR: The vector of size " << parameterValues.size()
+                         << " cannot hold entries " << entry_nr_start << " to " << entry_nr_end
+                         << " of the parameter \"" << parameterName << "\"." );
+    }
+
+    /** Do not take the address of the first element of an empty vector. */
+    T * buffer = parameterValues.empty() ? 0 : &parameterValues[ 0 ];
+    return this->ReadParameter( buffer, parameterName,
+      entry_nr_start, entry_nr_end, printThisErrorMessage, errorMessage );
+  }
+
+
+  /** An extended version that reads all parameters in a range at once,
+   * directly into a buffer of at least entry_nr_end - entry_nr_start + 1
+   * elements. This avoids an intermediate copy for parameters with many
+   * values, such as the TransformParameters.
+   */
+  template< class T >
+  bool ReadParameter(
+    T * parameterValues,
+    const std::string & parameterName,
+    const unsigned int entry_nr_start,
+    const unsigned int entry_nr_end,
+    const bool printThisErrorMessage,
+    std::string & errorMessage ) const
   {
     /** Reset the error message. */
     errorMessage = "";
@@ -342,19 +377,12 @@ public:
     /** Get the vector of parameters. */
     const ParameterValuesType & vec = this->m_ParameterMap.find( parameterName )->second;
 
-    /** The default is filled with zero's.
-    parameterValues.clear();
-    parameterValues.resize( entry_nr_end - entry_nr_start + 1,
-      itk::NumericTraits<T>::ZeroValue() );
-    */
-
     /** Get all parameters at once. */
-    unsigned int j = 0;
-    for( unsigned int i = entry_nr_start; i < entry_nr_end + 1; ++i )
+    T * value = parameterValues;
+    for( unsigned int i = entry_nr_start; i < entry_nr_end + 1; ++i, ++value )
     {
       /** Cast the string to type T. */
-      bool castSuccesful = this->StringCast( vec[ i ], parameterValues[ j ] );
-      j++;
+      bool castSuccesful = this->StringCast( vec[ i ], *value );
 
       /** Check if the cast was successful. */
       if( !castSuccesful )
@@ -365,7 +393,7 @@ public:
            << "\" failed!\n"
            << "  You tried to cast \"" << vec[ i ]
            << "\" from std::string to "
-           << typeid( parameterValues[ 0 ] ).name() << std::endl;
+           << typeid( *value ).name() << std::endl;
 
         itkExceptionMacro( << ss.str() );
       }
@@ -401,29 +429,73 @@ private:
 
   /** A templated function to cast strings to a type T.
    * Returns true when casting was successful and false otherwise.
-   * We make use of the casting functionality of string streams.
+   * We use the C conversion functions instead of string streams, because
+   * constructing a stream for every value dominates the time to read
+   * parameters with many values. Like the stream operators, the leading
+   * part of the string that forms a number is used. Values that do not fit
+   * in T are rejected.
    */
   template< class T >
   bool StringCast( const std::string & parameterValue, T & casted ) const
   {
-    std::stringstream ss( parameterValue );
-
-    /** For (unsigned) char we need a workaround, because ">>" casts it wrongly.
-    * It takes the first digit and thinks it is a char. For example:
-    * 84 becomes '8', which is asci number 56. So, as a workaround, we use
-    * the accumulate type, and then cast back to T.*/
-    typename NumericTraits< T >::AccumulateType tempCasted;
-    ss >> tempCasted;
-    casted = static_cast< T >( tempCasted );
-    if( ss.bad() || ss.fail() )
+    const char * begin = parameterValue.c_str();
+
+    /** Integers are read as 64 bit numbers and then checked against the
+     * range of T. This also reads (unsigned) char as a number, not as a
+     * character. For example: 84 should not become '8', which is asci
+     * number 56.
+     */
+    if( !NumericTraits< T >::is_integer )
     {
-      return false;
+      double value = 0.0;
+      if( !StringToFloatingPoint( begin, value )
+        || value > static_cast< double >( NumericTraits< T >::max() )
+        || value < -static_cast< double >( NumericTraits< T >::max() ) )
+      {
+        return false;
+      }
+      casted = static_cast< T >( value );
+    }
+    else if( NumericTraits< T >::is_signed )
+    {
+      int64_t value = 0;
+      if( !StringToSignedInteger( begin, value )
+        || value < static_cast< int64_t >( NumericTraits< T >::NonpositiveMin() )
+        || value > static_cast< int64_t >( NumericTraits< T >::max() ) )
+      {
+        return false;
+      }
+      casted = static_cast< T >( value );
+    }
+    else
+    {
+      uint64_t value = 0;
+      if( !StringToUnsignedInteger( begin, value )
+        || value > static_cast< uint64_t >( NumericTraits< T >::max() ) )
+      {
+        return false;
+      }
+      casted = static_cast< T >( value );
     }
     return true;
 
   } // end StringCast()
 
 
+  /** Convert the leading part of \a begin to a number. The conversion does
+   * not depend on the locale of the process, so that a decimal point is
+   * always a '.', and the integers are 64 bit on all platforms.
+   * Returns false if no number was found or if it is out of range. NaN,
+   * infinity and hexadecimal floating point numbers are rejected, like a
+   * string stream does.
+   */
+  static bool StringToFloatingPoint( const char * begin, double & value );
+
+  static bool StringToSignedInteger( const char * begin, int64_t & value );
+
+  static bool StringToUnsignedInteger( const char * begin, uint64_t & value );
+
+
   /** Provide a specialization for std::string, since the general StringCast
    * (especially ss >> casted) will not work for strings containing spaces.
    */
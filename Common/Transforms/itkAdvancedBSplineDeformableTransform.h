@@ -206,6 +206,20 @@ public:
   /** Transform points by a B-spline deformable transformation. */
   OutputPointType TransformPoint( const InputPointType & point ) const;
 
+  /** Transform the equidistant points start + k * step of a line of a dense grid.
+   * When the line is parallel to an axis of the B-spline grid, the B-spline
+   * weights of the other axes are the same for all points. The coefficients
+   * are then first contracted with those weights, after which each point only
+   * needs the SplineOrder + 1 weights along the line, instead of the
+   * (SplineOrder + 1)^SpaceDimension weights of TransformPoint(). Other lines
+   * are transformed point by point.
+   */
+  virtual void TransformPointsOnLine(
+    const InputPointType & start,
+    const InputVectorType & step,
+    OutputPointType * outputPoints,
+    const SizeValueType numberOfPoints ) const;
+
   /** Interpolation weights function type. */
   typedef BSplineInterpolationWeightFunction2< ScalarType,
     itkGetStaticConstMacro( SpaceDimension ),
@@ -337,6 +337,183 @@ AdvancedBSplineDeformableTransform< TScalarType, NDimensions, VSplineOrder >
 }
 
 
+/**
+ * ********************* TransformPointsOnLine ****************************
+ */
+
+template< class TScalarType, unsigned int NDimensions, unsigned int VSplineOrder >
+void
+AdvancedBSplineDeformableTransform< TScalarType, NDimensions, VSplineOrder >
+::TransformPointsOnLine(
+  const InputPointType & start,
+  const InputVectorType & step,
+  OutputPointType * outputPoints,
+  const SizeValueType numberOfPoints ) const
+{
+  if( !this->m_CoefficientImages[ 0 ] || numberOfPoints == 0 )
+  {
+    Superclass::TransformPointsOnLine( start, step, outputPoints, numberOfPoints );
+    return;
+  }
+
+  /** The continuous grid index of the first point, and its increment per point. */
+  ContinuousIndexType cindex0, cindex1;
+  this->TransformPointToContinuousGridIndex( start, cindex0 );
+  this->TransformPointToContinuousGridIndex( start + step, cindex1 );
+
+  /** Find the grid axis along which the line runs. The line should be
+   * parallel to that axis, otherwise it is transformed point by point.
+   */
+  double       cstep[ SpaceDimension ];
+  unsigned int lineAxis = 0;
+  for( unsigned int j = 0; j < SpaceDimension; ++j )
+  {
+    cstep[ j ] = cindex1[ j ] - cindex0[ j ];
+    if( vcl_abs( cstep[ j ] ) > vcl_abs( cstep[ lineAxis ] ) )
+    {
+      lineAxis = j;
+    }
+  }
+  for( unsigned int j = 0; j < SpaceDimension; ++j )
+  {
+    if( j != lineAxis && vcl_abs( cstep[ j ] ) * numberOfPoints > 1e-8 )
+    {
+      Superclass::TransformPointsOnLine( start, step, outputPoints, numberOfPoints );
+      return;
+    }
+  }
+
+  /** Initialize the output with the input points, i.e. with zero displacement. */
+  for( SizeValueType k = 0; k < numberOfPoints; ++k )
+  {
+    for( unsigned int j = 0; j < SpaceDimension; ++j )
+    {
+      outputPoints[ k ][ j ] = start[ j ] + static_cast< ScalarType >( k ) * step[ j ];
+    }
+  }
+
+  /** If the line is outside the valid region in one of the other dimensions,
+   * the displacement is zero for all points.
+   */
+  for( unsigned int j = 0; j < SpaceDimension; ++j )
+  {
+    if( j != lineAxis
+      && ( cindex0[ j ] < this->m_ValidRegionBegin[ j ] || cindex0[ j ] >= this->m_ValidRegionEnd[ j ] ) )
+    {
+      return;
+    }
+  }
+
+  /** Compute the start index and the weights along the line axis for every
+   * point inside the valid region, and the range of control points they need.
+   */
+  const unsigned int            supportSize = SplineOrder + 1;
+  std::vector< double >         lineWeights( numberOfPoints * supportSize );
+  std::vector< IndexValueType > lineStartIndices( numberOfPoints );
+  std::vector< bool >           lineInside( numberOfPoints, false );
+  IndexValueType                minStartIndex = NumericTraits< IndexValueType >::max();
+  IndexValueType                maxStartIndex = NumericTraits< IndexValueType >::NonpositiveMin();
+  for( SizeValueType k = 0; k < numberOfPoints; ++k )
+  {
+    const double c = cindex0[ lineAxis ] + static_cast< double >( k ) * cstep[ lineAxis ];
+    if( c < this->m_ValidRegionBegin[ lineAxis ] || c >= this->m_ValidRegionEnd[ lineAxis ] )
+    {
+      continue;
+    }
+    lineInside[ k ]       = true;
+    lineStartIndices[ k ] = this->m_WeightsFunction->Evaluate1D( c, &lineWeights[ k * supportSize ] );
+    minStartIndex         = vnl_math_min( minStartIndex, lineStartIndices[ k ] );
+    maxStartIndex         = vnl_math_max( maxStartIndex, lineStartIndices[ k ] );
+  }
+  if( minStartIndex > maxStartIndex )
+  {
+    return;
+  }
+
+  /** The weights of the other dimensions, which are the same for all points. */
+  double    otherWeights[ SpaceDimension ][ VSplineOrder + 1 ];
+  IndexType supportIndex;
+  for( unsigned int j = 0; j < SpaceDimension; ++j )
+  {
+    if( j != lineAxis )
+    {
+      supportIndex[ j ] = this->m_WeightsFunction->Evaluate1D( cindex0[ j ], otherWeights[ j ] );
+    }
+  }
+  supportIndex[ lineAxis ] = minStartIndex;
+
+  /** Contract the coefficients with the weights of the other dimensions.
+   * This leaves one value per control point along the line axis,
+   * for each component of the displacement.
+   */
+  const SizeValueType     numberOfLineCoefficients = maxStartIndex - minStartIndex + supportSize;
+  std::vector< double >   lineCoefficients( SpaceDimension * numberOfLineCoefficients, 0.0 );
+  const IndexType         bufferIndex = this->m_CoefficientImages[ 0 ]->GetBufferedRegion().GetIndex();
+  const OffsetValueType * offsetTable = this->m_CoefficientImages[ 0 ]->GetOffsetTable();
+  const PixelType *       coefficientPointers[ SpaceDimension ];
+  for( unsigned int j = 0; j < SpaceDimension; ++j )
+  {
+    coefficientPointers[ j ] = this->m_CoefficientImages[ j ]->GetBufferPointer();
+  }
+
+  unsigned int numberOfOtherWeights = 1;
+  for( unsigned int j = 0; j < SpaceDimension - 1; ++j )
+  {
+    numberOfOtherWeights *= supportSize;
+  }
+  for( unsigned int m = 0; m < numberOfOtherWeights; ++m )
+  {
+    /** Decode the position in the support region of the other dimensions. */
+    double          weight = 1.0;
+    OffsetValueType offset = ( supportIndex[ lineAxis ] - bufferIndex[ lineAxis ] ) * offsetTable[ lineAxis ];
+    unsigned int    rest   = m;
+    for( unsigned int j = 0; j < SpaceDimension; ++j )
+    {
+      if( j == lineAxis )
+      {
+        continue;
+      }
+      const unsigned int digit = rest % supportSize;
+      rest   /= supportSize;
+      weight *= otherWeights[ j ][ digit ];
+      offset += ( supportIndex[ j ] + digit - bufferIndex[ j ] ) * offsetTable[ j ];
+    }
+
+    for( unsigned int d = 0; d < SpaceDimension; ++d )
+    {
+      const PixelType * coefficient     = coefficientPointers[ d ] + offset;
+      double *          lineCoefficient = &lineCoefficients[ d * numberOfLineCoefficients ];
+      for( SizeValueType i = 0; i < numberOfLineCoefficients; ++i )
+      {
+        lineCoefficient[ i ] += weight * coefficient[ i * offsetTable[ lineAxis ] ];
+      }
+    }
+  }
+
+  /** Each point now only needs the weights along the line axis. */
+  for( SizeValueType k = 0; k < numberOfPoints; ++k )
+  {
+    if( !lineInside[ k ] )
+    {
+      continue;
+    }
+    const double *      weights = &lineWeights[ k * supportSize ];
+    const SizeValueType first   = lineStartIndices[ k ] - minStartIndex;
+    for( unsigned int d = 0; d < SpaceDimension; ++d )
+    {
+      const double * lineCoefficient = &lineCoefficients[ d * numberOfLineCoefficients + first ];
+      double         displacement    = 0.0;
+      for( unsigned int i = 0; i < supportSize; ++i )
+      {
+        displacement += weights[ i ] * lineCoefficient[ i ];
+      }
+      outputPoints[ k ][ d ] += static_cast< ScalarType >( displacement );
+    }
+  }
+
+} // end TransformPointsOnLine()
+
+
 /**
  * ********************* GetNumberOfAffectedWeights ****************************
  */
@@ -160,6 +160,25 @@ public:
   /**  Method to transform a point. */
   virtual OutputPointType TransformPoint( const InputPointType  & point ) const;
 
+  /**  Method to transform a contiguous block of points.
+   * The combination method is selected once for the whole block, and the
+   * block is passed on to the TransformPoints() of the sub-transforms.
+   */
+  virtual void TransformPoints(
+    const InputPointType * inputPoints,
+    OutputPointType * outputPoints,
+    const SizeValueType numberOfPoints ) const;
+
+  /**  Method to transform the equidistant points of a line.
+   * The line is passed on to the TransformPointsOnLine() of the sub-transforms
+   * where possible, so that these can exploit the regular structure.
+   */
+  virtual void TransformPointsOnLine(
+    const InputPointType & start,
+    const InputVectorType & step,
+    OutputPointType * outputPoints,
+    const SizeValueType numberOfPoints ) const;
+
   /** ITK4 change:
    * The following pure virtual functions must be overloaded.
    * For now just throw an exception, since these are not used in elastix.
@@ -256,6 +275,15 @@ public:
     const InputPointType & ipp,
     SpatialJacobianType & sj ) const;
 
+  /** Compute the spatial Jacobian for a contiguous block of points.
+   * The combination method is selected once for the whole block, and the
+   * block is passed on to the GetSpatialJacobians() of the sub-transforms.
+   */
+  virtual void GetSpatialJacobians(
+    const InputPointType * inputPoints,
+    SpatialJacobianType * spatialJacobians,
+    const SizeValueType numberOfPoints ) const;
+
   /** Compute the spatial Hessian of the transformation. */
   virtual void GetSpatialHessian(
     const InputPointType & ipp,
@@ -293,6 +321,15 @@ public:
 
   /** Typedefs for function pointers. */
   typedef OutputPointType (Self::* TransformPointFunctionPointer)( const InputPointType & ) const;
+  typedef void (Self::*            TransformPointsFunctionPointer)(
+    const InputPointType *,
+    OutputPointType *,
+    const SizeValueType ) const;
+  typedef void (Self::*            TransformPointsOnLineFunctionPointer)(
+    const InputPointType &,
+    const InputVectorType &,
+    OutputPointType *,
+    const SizeValueType ) const;
   typedef void (Self::*            GetSparseJacobianFunctionPointer)(
     const InputPointType &,
     JacobianType &,
@@ -305,6 +342,10 @@ public:
   typedef void (Self::* GetSpatialJacobianFunctionPointer)(
     const InputPointType &,
     SpatialJacobianType & ) const;
+  typedef void (Self::* GetSpatialJacobiansFunctionPointer)(
+    const InputPointType *,
+    SpatialJacobianType *,
+    const SizeValueType ) const;
   typedef void (Self::* GetSpatialHessianFunctionPointer)(
     const InputPointType &,
     SpatialHessianType & ) const;
@@ -355,6 +396,22 @@ protected:
    */
   TransformPointFunctionPointer m_SelectedTransformPointFunction;
 
+  /**  A pointer to one of the following functions:
+   * - TransformPointsUseAddition,
+   * - TransformPointsUseComposition,
+   * - TransformPointsNoCurrentTransform
+   * - TransformPointsNoInitialTransform.
+   */
+  TransformPointsFunctionPointer m_SelectedTransformPointsFunction;
+
+  /**  A pointer to one of the following functions:
+   * - TransformPointsOnLineUseAddition,
+   * - TransformPointsOnLineUseComposition,
+   * - TransformPointsOnLineNoCurrentTransform
+   * - TransformPointsOnLineNoInitialTransform.
+   */
+  TransformPointsOnLineFunctionPointer m_SelectedTransformPointsOnLineFunction;
+
   /**  A pointer to one of the following functions:
    * - GetJacobianUseAddition,
    * - GetJacobianUseComposition,
@@ -367,6 +424,7 @@ protected:
   GetSparseJacobianFunctionPointer                        m_SelectedGetSparseJacobianFunction;
   EvaluateJacobianWithImageGradientProductFunctionPointer m_SelectedEvaluateJacobianWithImageGradientProductFunction;
   GetSpatialJacobianFunctionPointer                       m_SelectedGetSpatialJacobianFunction;
+  GetSpatialJacobiansFunctionPointer                      m_SelectedGetSpatialJacobiansFunction;
   GetSpatialHessianFunctionPointer                        m_SelectedGetSpatialHessianFunction;
   GetJacobianOfSpatialJacobianFunctionPointer             m_SelectedGetJacobianOfSpatialJacobianFunction;
   GetJacobianOfSpatialJacobianFunctionPointer2            m_SelectedGetJacobianOfSpatialJacobianFunction2;
@@ -395,6 +453,71 @@ protected:
   inline OutputPointType TransformPointNoCurrentTransform(
     const InputPointType & point ) const;
 
+  /** ************************************************
+   * Methods to transform a block of points.
+   */
+
+  /** ADDITION: \f$T(x) = T_0(x) + T_1(x) - x\f$ */
+  inline void TransformPointsUseAddition(
+    const InputPointType * inputPoints,
+    OutputPointType * outputPoints,
+    const SizeValueType numberOfPoints ) const;
+
+  /** COMPOSITION: \f$T(x) = T_1( T_0(x) )\f$
+   * \warning: assumes that input and output point type are the same.
+   */
+  inline void TransformPointsUseComposition(
+    const InputPointType * inputPoints,
+    OutputPointType * outputPoints,
+    const SizeValueType numberOfPoints ) const;
+
+  /** CURRENT ONLY: \f$T(x) = T_1(x)\f$ */
+  inline void TransformPointsNoInitialTransform(
+    const InputPointType * inputPoints,
+    OutputPointType * outputPoints,
+    const SizeValueType numberOfPoints ) const;
+
+  /** NO CURRENT TRANSFORM SET: throw an exception. */
+  inline void TransformPointsNoCurrentTransform(
+    const InputPointType * inputPoints,
+    OutputPointType * outputPoints,
+    const SizeValueType numberOfPoints ) const;
+
+  /** ************************************************
+   * Methods to transform the points of a line.
+   */
+
+  /** ADDITION: \f$T(x) = T_0(x) + T_1(x) - x\f$ */
+  inline void TransformPointsOnLineUseAddition(
+    const InputPointType & start,
+    const InputVectorType & step,
+    OutputPointType * outputPoints,
+    const SizeValueType numberOfPoints ) const;
+
+  /** COMPOSITION: \f$T(x) = T_1( T_0(x) )\f$
+   * The points are only passed on as a line if \f$T_0\f$ is linear.
+   * \warning: assumes that input and output point type are the same.
+   */
+  inline void TransformPointsOnLineUseComposition(
+    const InputPointType & start,
+    const InputVectorType & step,
+    OutputPointType * outputPoints,
+    const SizeValueType numberOfPoints ) const;
+
+  /** CURRENT ONLY: \f$T(x) = T_1(x)\f$ */
+  inline void TransformPointsOnLineNoInitialTransform(
+    const InputPointType & start,
+    const InputVectorType & step,
+    OutputPointType * outputPoints,
+    const SizeValueType numberOfPoints ) const;
+
+  /** NO CURRENT TRANSFORM SET: throw an exception. */
+  inline void TransformPointsOnLineNoCurrentTransform(
+    const InputPointType & start,
+    const InputVectorType & step,
+    OutputPointType * outputPoints,
+    const SizeValueType numberOfPoints ) const;
+
   /** ************************************************
    * Methods to compute the sparse Jacobian.
    */
@@ -485,6 +608,36 @@ protected:
     const InputPointType & ipp,
     SpatialJacobianType & sj ) const;
 
+  /** ************************************************
+   * Methods to compute the spatial Jacobian for a block of points.
+   */
+
+  /** ADDITION: \f$J(x) = J_0(x) + J_1(x) - I\f$ */
+  inline void GetSpatialJacobiansUseAddition(
+    const InputPointType * inputPoints,
+    SpatialJacobianType * spatialJacobians,
+    const SizeValueType numberOfPoints ) const;
+
+  /** COMPOSITION: \f$J(x) = J_1( T_0(x) ) J_0(x)\f$
+   * \warning: assumes that input and output point type are the same.
+   */
+  inline void GetSpatialJacobiansUseComposition(
+    const InputPointType * inputPoints,
+    SpatialJacobianType * spatialJacobians,
+    const SizeValueType numberOfPoints ) const;
+
+  /** CURRENT ONLY: \f$J(x) = J_1(x)\f$ */
+  inline void GetSpatialJacobiansNoInitialTransform(
+    const InputPointType * inputPoints,
+    SpatialJacobianType * spatialJacobians,
+    const SizeValueType numberOfPoints ) const;
+
+  /** NO CURRENT TRANSFORM SET: throw an exception. */
+  inline void GetSpatialJacobiansNoCurrentTransform(
+    const InputPointType * inputPoints,
+    SpatialJacobianType * spatialJacobians,
+    const SizeValueType numberOfPoints ) const;
+
   /** ************************************************
    * Methods to compute the spatial Hessian.
    */
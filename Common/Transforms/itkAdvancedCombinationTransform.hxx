@@ -42,6 +42,10 @@ AdvancedCombinationTransform< TScalarType, NDimensions >
   /** Set everything to have no current transform. */
   this->m_SelectedTransformPointFunction
     = &Self::TransformPointNoCurrentTransform;
+  this->m_SelectedTransformPointsFunction
+    = &Self::TransformPointsNoCurrentTransform;
+  this->m_SelectedTransformPointsOnLineFunction
+    = &Self::TransformPointsOnLineNoCurrentTransform;
 //   this->m_SelectedGetJacobianFunction
 //     = &Self::GetJacobianNoCurrentTransform;
   this->m_SelectedGetSparseJacobianFunction
@@ -50,6 +54,8 @@ AdvancedCombinationTransform< TScalarType, NDimensions >
     = &Self::EvaluateJacobianWithImageGradientProductNoInitialTransform;
   this->m_SelectedGetSpatialJacobianFunction
     = &Self::GetSpatialJacobianNoCurrentTransform;
+  this->m_SelectedGetSpatialJacobiansFunction
+    = &Self::GetSpatialJacobiansNoCurrentTransform;
   this->m_SelectedGetSpatialHessianFunction
     = &Self::GetSpatialHessianNoCurrentTransform;
   this->m_SelectedGetJacobianOfSpatialJacobianFunction
@@ -633,6 +639,10 @@ AdvancedCombinationTransform< TScalarType, NDimensions >
   {
     this->m_SelectedTransformPointFunction
       = &Self::TransformPointNoCurrentTransform;
+    this->m_SelectedTransformPointsFunction
+      = &Self::TransformPointsNoCurrentTransform;
+    this->m_SelectedTransformPointsOnLineFunction
+      = &Self::TransformPointsOnLineNoCurrentTransform;
 //     this->m_SelectedGetJacobianFunction
 //       = &Self::GetJacobianNoCurrentTransform;
     this->m_SelectedGetSparseJacobianFunction
@@ -641,6 +651,8 @@ AdvancedCombinationTransform< TScalarType, NDimensions >
       = &Self::EvaluateJacobianWithImageGradientProductNoCurrentTransform;
     this->m_SelectedGetSpatialJacobianFunction
       = &Self::GetSpatialJacobianNoCurrentTransform;
+    this->m_SelectedGetSpatialJacobiansFunction
+      = &Self::GetSpatialJacobiansNoCurrentTransform;
     this->m_SelectedGetSpatialHessianFunction
       = &Self::GetSpatialHessianNoCurrentTransform;
     this->m_SelectedGetJacobianOfSpatialJacobianFunction
@@ -656,6 +668,10 @@ AdvancedCombinationTransform< TScalarType, NDimensions >
   {
     this->m_SelectedTransformPointFunction
       = &Self::TransformPointNoInitialTransform;
+    this->m_SelectedTransformPointsFunction
+      = &Self::TransformPointsNoInitialTransform;
+    this->m_SelectedTransformPointsOnLineFunction
+      = &Self::TransformPointsOnLineNoInitialTransform;
 //     this->m_SelectedGetJacobianFunction
 //       = &Self::GetJacobianNoInitialTransform;
     this->m_SelectedGetSparseJacobianFunction
@@ -664,6 +680,8 @@ AdvancedCombinationTransform< TScalarType, NDimensions >
       = &Self::EvaluateJacobianWithImageGradientProductNoInitialTransform;
     this->m_SelectedGetSpatialJacobianFunction
       = &Self::GetSpatialJacobianNoInitialTransform;
+    this->m_SelectedGetSpatialJacobiansFunction
+      = &Self::GetSpatialJacobiansNoInitialTransform;
     this->m_SelectedGetSpatialHessianFunction
       = &Self::GetSpatialHessianNoInitialTransform;
     this->m_SelectedGetJacobianOfSpatialJacobianFunction
@@ -679,6 +697,10 @@ AdvancedCombinationTransform< TScalarType, NDimensions >
   {
     this->m_SelectedTransformPointFunction
       = &Self::TransformPointUseAddition;
+    this->m_SelectedTransformPointsFunction
+      = &Self::TransformPointsUseAddition;
+    this->m_SelectedTransformPointsOnLineFunction
+      = &Self::TransformPointsOnLineUseAddition;
 //     this->m_SelectedGetJacobianFunction
 //       = &Self::GetJacobianUseAddition;
     this->m_SelectedGetSparseJacobianFunction
@@ -687,6 +709,8 @@ AdvancedCombinationTransform< TScalarType, NDimensions >
       = &Self::EvaluateJacobianWithImageGradientProductUseAddition;
     this->m_SelectedGetSpatialJacobianFunction
       = &Self::GetSpatialJacobianUseAddition;
+    this->m_SelectedGetSpatialJacobiansFunction
+      = &Self::GetSpatialJacobiansUseAddition;
     this->m_SelectedGetSpatialHessianFunction
       = &Self::GetSpatialHessianUseAddition;
     this->m_SelectedGetJacobianOfSpatialJacobianFunction
@@ -702,6 +726,10 @@ AdvancedCombinationTransform< TScalarType, NDimensions >
   {
     this->m_SelectedTransformPointFunction
       = &Self::TransformPointUseComposition;
+    this->m_SelectedTransformPointsFunction
+      = &Self::TransformPointsUseComposition;
+    this->m_SelectedTransformPointsOnLineFunction
+      = &Self::TransformPointsOnLineUseComposition;
 //     this->m_SelectedGetJacobianFunction
 //       = &Self::GetJacobianUseComposition;
     this->m_SelectedGetSparseJacobianFunction
@@ -710,6 +738,8 @@ AdvancedCombinationTransform< TScalarType, NDimensions >
       = &Self::EvaluateJacobianWithImageGradientProductUseComposition;
     this->m_SelectedGetSpatialJacobianFunction
       = &Self::GetSpatialJacobianUseComposition;
+    this->m_SelectedGetSpatialJacobiansFunction
+      = &Self::GetSpatialJacobiansUseComposition;
     this->m_SelectedGetSpatialHessianFunction
       = &Self::GetSpatialHessianUseComposition;
     this->m_SelectedGetJacobianOfSpatialJacobianFunction
@@ -835,6 +865,202 @@ AdvancedCombinationTransform< TScalarType, NDimensions >
 } // end TransformPointNoCurrentTransform()
 
 
+/**
+ * ************* TransformPointsUseAddition **********************
+ */
+
+template< typename TScalarType, unsigned int NDimensions >
+void
+AdvancedCombinationTransform< TScalarType, NDimensions >
+::TransformPointsUseAddition(
+  const InputPointType * inputPoints,
+  OutputPointType * outputPoints,
+  const SizeValueType numberOfPoints ) const
+{
+  /** Both sub-transforms need the original input point,
+   * so combine them point by point.
+   */
+  for( SizeValueType p = 0; p < numberOfPoints; ++p )
+  {
+    OutputPointType out0 = this->m_InitialTransform->TransformPoint( inputPoints[ p ] );
+    OutputPointType out  = this->m_CurrentTransform->TransformPoint( inputPoints[ p ] );
+
+    /** Add them. */
+    for( unsigned int i = 0; i < SpaceDimension; i++ )
+    {
+      out[ i ] += ( out0[ i ] - inputPoints[ p ][ i ] );
+    }
+    outputPoints[ p ] = out;
+  }
+
+} // end TransformPointsUseAddition()
+
+
+/**
+ * **************** TransformPointsUseComposition *************
+ */
+
+template< typename TScalarType, unsigned int NDimensions >
+void
+AdvancedCombinationTransform< TScalarType, NDimensions >
+::TransformPointsUseComposition(
+  const InputPointType * inputPoints,
+  OutputPointType * outputPoints,
+  const SizeValueType numberOfPoints ) const
+{
+  /** First map the whole block through the initial transform,
+   * and then transform the intermediate result in-place.
+   */
+  this->m_InitialTransform->TransformPoints( inputPoints, outputPoints, numberOfPoints );
+  this->m_CurrentTransform->TransformPoints( outputPoints, outputPoints, numberOfPoints );
+
+} // end TransformPointsUseComposition()
+
+
+/**
+ * **************** TransformPointsNoInitialTransform ******************
+ */
+
+template< typename TScalarType, unsigned int NDimensions >
+void
+AdvancedCombinationTransform< TScalarType, NDimensions >
+::TransformPointsNoInitialTransform(
+  const InputPointType * inputPoints,
+  OutputPointType * outputPoints,
+  const SizeValueType numberOfPoints ) const
+{
+  this->m_CurrentTransform->TransformPoints( inputPoints, outputPoints, numberOfPoints );
+
+} // end TransformPointsNoInitialTransform()
+
+
+/**
+ * ******** TransformPointsNoCurrentTransform ******************
+ */
+
+template< typename TScalarType, unsigned int NDimensions >
+void
+AdvancedCombinationTransform< TScalarType, NDimensions >
+::TransformPointsNoCurrentTransform(
+  const InputPointType * itkNotUsed( inputPoints ),
+  OutputPointType * itkNotUsed( outputPoints ),
+  const SizeValueType itkNotUsed( numberOfPoints ) ) const
+{
+  /** Throw an exception. */
+  this->NoCurrentTransformSet();
+
+} // end TransformPointsNoCurrentTransform()
+
+
+/**
+ * ************* TransformPointsOnLineUseAddition **********************
+ */
+
+template< typename TScalarType, unsigned int NDimensions >
+void
+AdvancedCombinationTransform< TScalarType, NDimensions >
+::TransformPointsOnLineUseAddition(
+  const InputPointType & start,
+  const InputVectorType & step,
+  OutputPointType * outputPoints,
+  const SizeValueType numberOfPoints ) const
+{
+  /** Process the points in chunks, to keep the temporary storage on the stack. */
+  const unsigned int chunkSize = 64;
+  OutputPointType    initialPoints[ chunkSize ];
+
+  this->m_CurrentTransform->TransformPointsOnLine( start, step, outputPoints, numberOfPoints );
+  for( SizeValueType first = 0; first < numberOfPoints; first += chunkSize )
+  {
+    const SizeValueType n = numberOfPoints - first < chunkSize ? numberOfPoints - first : chunkSize;
+    InputPointType      chunkStart;
+    for( unsigned int i = 0; i < SpaceDimension; i++ )
+    {
+      chunkStart[ i ] = start[ i ] + static_cast< ScalarType >( first ) * step[ i ];
+    }
+    this->m_InitialTransform->TransformPointsOnLine( chunkStart, step, initialPoints, n );
+
+    /** Add them. */
+    for( SizeValueType p = 0; p < n; ++p )
+    {
+      for( unsigned int i = 0; i < SpaceDimension; i++ )
+      {
+        const ScalarType x = start[ i ] + static_cast< ScalarType >( first + p ) * step[ i ];
+        outputPoints[ first + p ][ i ] += ( initialPoints[ p ][ i ] - x );
+      }
+    }
+  }
+
+} // end TransformPointsOnLineUseAddition()
+
+
+/**
+ * **************** TransformPointsOnLineUseComposition *************
+ */
+
+template< typename TScalarType, unsigned int NDimensions >
+void
+AdvancedCombinationTransform< TScalarType, NDimensions >
+::TransformPointsOnLineUseComposition(
+  const InputPointType & start,
+  const InputVectorType & step,
+  OutputPointType * outputPoints,
+  const SizeValueType numberOfPoints ) const
+{
+  /** A linear initial transform maps the line onto another line. */
+  if( this->m_InitialTransform->IsLinear() )
+  {
+    this->m_CurrentTransform->TransformPointsOnLine(
+      this->m_InitialTransform->TransformPoint( start ),
+      this->m_InitialTransform->TransformVector( step ),
+      outputPoints, numberOfPoints );
+    return;
+  }
+
+  /** Otherwise the intermediate points are transformed as a block. */
+  this->m_InitialTransform->TransformPointsOnLine( start, step, outputPoints, numberOfPoints );
+  this->m_CurrentTransform->TransformPoints( outputPoints, outputPoints, numberOfPoints );
+
+} // end TransformPointsOnLineUseComposition()
+
+
+/**
+ * **************** TransformPointsOnLineNoInitialTransform ******************
+ */
+
+template< typename TScalarType, unsigned int NDimensions >
+void
+AdvancedCombinationTransform< TScalarType, NDimensions >
+::TransformPointsOnLineNoInitialTransform(
+  const InputPointType & start,
+  const InputVectorType & step,
+  OutputPointType * outputPoints,
+  const SizeValueType numberOfPoints ) const
+{
+  this->m_CurrentTransform->TransformPointsOnLine( start, step, outputPoints, numberOfPoints );
+
+} // end TransformPointsOnLineNoInitialTransform()
+
+
+/**
+ * ******** TransformPointsOnLineNoCurrentTransform ******************
+ */
+
+template< typename TScalarType, unsigned int NDimensions >
+void
+AdvancedCombinationTransform< TScalarType, NDimensions >
+::TransformPointsOnLineNoCurrentTransform(
+  const InputPointType & itkNotUsed( start ),
+  const InputVectorType & itkNotUsed( step ),
+  OutputPointType * itkNotUsed( outputPoints ),
+  const SizeValueType itkNotUsed( numberOfPoints ) ) const
+{
+  /** Throw an exception. */
+  this->NoCurrentTransformSet();
+
+} // end TransformPointsOnLineNoCurrentTransform()
+
+
 /**
  * ************* GetJacobianUseAddition ***************************
  */
@@ -1057,6 +1283,108 @@ AdvancedCombinationTransform< TScalarType, NDimensions >
 } // end GetSpatialJacobianNoCurrentTransform()
 
 
+/**
+ * ************* GetSpatialJacobiansUseAddition ***************************
+ */
+
+template< typename TScalarType, unsigned int NDimensions >
+void
+AdvancedCombinationTransform< TScalarType, NDimensions >
+::GetSpatialJacobiansUseAddition(
+  const InputPointType * inputPoints,
+  SpatialJacobianType * spatialJacobians,
+  const SizeValueType numberOfPoints ) const
+{
+  /** Process the points in chunks, to keep the temporary storage on the stack. */
+  const unsigned int  chunkSize = 64;
+  SpatialJacobianType sj0[ chunkSize ];
+
+  this->m_CurrentTransform->GetSpatialJacobians( inputPoints, spatialJacobians, numberOfPoints );
+  for( SizeValueType first = 0; first < numberOfPoints; first += chunkSize )
+  {
+    const SizeValueType n = numberOfPoints - first < chunkSize ? numberOfPoints - first : chunkSize;
+    this->m_InitialTransform->GetSpatialJacobians( inputPoints + first, sj0, n );
+    for( SizeValueType p = 0; p < n; ++p )
+    {
+      SpatialJacobianType & sj = spatialJacobians[ first + p ];
+      sj += sj0[ p ];
+      for( unsigned int i = 0; i < SpaceDimension; ++i )
+      {
+        sj( i, i ) -= 1.0;
+      }
+    }
+  }
+
+} // end GetSpatialJacobiansUseAddition()
+
+
+/**
+ * **************** GetSpatialJacobiansUseComposition *************
+ */
+
+template< typename TScalarType, unsigned int NDimensions >
+void
+AdvancedCombinationTransform< TScalarType, NDimensions >
+::GetSpatialJacobiansUseComposition(
+  const InputPointType * inputPoints,
+  SpatialJacobianType * spatialJacobians,
+  const SizeValueType numberOfPoints ) const
+{
+  /** Process the points in chunks, to keep the temporary storage on the stack. */
+  const unsigned int  chunkSize = 64;
+  SpatialJacobianType sj0[ chunkSize ];
+  OutputPointType     intermediatePoints[ chunkSize ];
+
+  for( SizeValueType first = 0; first < numberOfPoints; first += chunkSize )
+  {
+    const SizeValueType n = numberOfPoints - first < chunkSize ? numberOfPoints - first : chunkSize;
+    this->m_InitialTransform->TransformPoints( inputPoints + first, intermediatePoints, n );
+    this->m_InitialTransform->GetSpatialJacobians( inputPoints + first, sj0, n );
+    this->m_CurrentTransform->GetSpatialJacobians( intermediatePoints, spatialJacobians + first, n );
+    for( SizeValueType p = 0; p < n; ++p )
+    {
+      spatialJacobians[ first + p ] = spatialJacobians[ first + p ] * sj0[ p ];
+    }
+  }
+
+} // end GetSpatialJacobiansUseComposition()
+
+
+/**
+ * **************** GetSpatialJacobiansNoInitialTransform ******************
+ */
+
+template< typename TScalarType, unsigned int NDimensions >
+void
+AdvancedCombinationTransform< TScalarType, NDimensions >
+::GetSpatialJacobiansNoInitialTransform(
+  const InputPointType * inputPoints,
+  SpatialJacobianType * spatialJacobians,
+  const SizeValueType numberOfPoints ) const
+{
+  this->m_CurrentTransform->GetSpatialJacobians( inputPoints, spatialJacobians, numberOfPoints );
+
+} // end GetSpatialJacobiansNoInitialTransform()
+
+
+/**
+ * ******** GetSpatialJacobiansNoCurrentTransform ******************
+ */
+
+template< typename TScalarType, unsigned int NDimensions >
+void
+AdvancedCombinationTransform< TScalarType, NDimensions >
+::GetSpatialJacobiansNoCurrentTransform(
+  const InputPointType * itkNotUsed( inputPoints ),
+  SpatialJacobianType * itkNotUsed( spatialJacobians ),
+  const SizeValueType itkNotUsed( numberOfPoints ) ) const
+{
+  /** Throw an exception. */
+  this->NoCurrentTransformSet();
+
+} // end GetSpatialJacobiansNoCurrentTransform()
+
+
 /**
  * ******** GetSpatialHessianUseAddition ******************
  */
@@ -1613,6 +1941,43 @@ AdvancedCombinationTransform< TScalarType, NDimensions >
 } // end TransformPoint()
 
 
+/**
+ * **************** TransformPoints **********************************
+ */
+
+template< typename TScalarType, unsigned int NDimensions >
+void
+AdvancedCombinationTransform< TScalarType, NDimensions >
+::TransformPoints(
+  const InputPointType * inputPoints,
+  OutputPointType * outputPoints,
+  const SizeValueType numberOfPoints ) const
+{
+  /** Call the selected TransformPoints. */
+  ( ( *this ).*m_SelectedTransformPointsFunction )( inputPoints, outputPoints, numberOfPoints );
+
+} // end TransformPoints()
+
+
+/**
+ * **************** TransformPointsOnLine ****************************
+ */
+
+template< typename TScalarType, unsigned int NDimensions >
+void
+AdvancedCombinationTransform< TScalarType, NDimensions >
+::TransformPointsOnLine(
+  const InputPointType & start,
+  const InputVectorType & step,
+  OutputPointType * outputPoints,
+  const SizeValueType numberOfPoints ) const
+{
+  /** Call the selected TransformPointsOnLine. */
+  ( ( *this ).*m_SelectedTransformPointsOnLineFunction )( start, step, outputPoints, numberOfPoints );
+
+} // end TransformPointsOnLine()
+
+
 /**
  * ****************** GetJacobian ****************************
  */
@@ -1670,6 +2035,24 @@ AdvancedCombinationTransform< TScalarType, NDimensions >
 } // end GetSpatialJacobian()
 
 
+/**
+ * ****************** GetSpatialJacobians ****************************
+ */
+
+template< typename TScalarType, unsigned int NDimensions >
+void
+AdvancedCombinationTransform< TScalarType, NDimensions >
+::GetSpatialJacobians(
+  const InputPointType * inputPoints,
+  SpatialJacobianType * spatialJacobians,
+  const SizeValueType numberOfPoints ) const
+{
+  /** Call the selected GetSpatialJacobians. */
+  ( ( *this ).*m_SelectedGetSpatialJacobiansFunction )( inputPoints, spatialJacobians, numberOfPoints );
+
+} // end GetSpatialJacobians()
+
+
 /**
  * ****************** GetSpatialHessian ****************************
  */
@@ -31,6 +31,7 @@
 #include "vnl/vnl_diag_matrix.h"
 
 #include "itkMultiThreader.h"
+#include "itkPersistentThreadPool.h"
 
 namespace itk
 {
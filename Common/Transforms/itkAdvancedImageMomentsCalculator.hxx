@@ -334,12 +334,10 @@ void
 AdvancedImageMomentsCalculator< TImage >
 ::LaunchComputeThreaderCallback(void) const
 {
-  /** Setup threader. */
-  this->m_Threader->SetSingleMethod(this->ComputeThreaderCallback,
-    const_cast< void * >(static_cast< const void * >(&this->m_ThreaderParameters)));
-
-  /** Launch. */
-  this->m_Threader->SingleMethodExecute();
+  /** Launch the threads of the persistent thread pool. */
+  PersistentThreadPool::SingleMethodExecute(this->ComputeThreaderCallback,
+    const_cast< void * >(static_cast< const void * >(&this->m_ThreaderParameters)),
+    this->m_Threader->GetNumberOfThreads());
 
 } // end LaunchComputeThreaderCallback()
 
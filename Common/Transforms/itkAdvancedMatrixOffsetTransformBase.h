@@ -343,6 +343,12 @@ public:
    */
   OutputPointType     TransformPoint( const InputPointType & point ) const;
 
+  /** Transform a contiguous block of points with the same matrix and offset. */
+  virtual void TransformPoints(
+    const InputPointType * inputPoints,
+    OutputPointType * outputPoints,
+    const SizeValueType numberOfPoints ) const;
+
   OutputVectorType    TransformVector( const InputVectorType & vector ) const;
 
   OutputVnlVectorType TransformVector( const InputVnlVectorType & vector ) const;
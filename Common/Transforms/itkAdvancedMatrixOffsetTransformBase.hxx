@@ -264,6 +264,55 @@ AdvancedMatrixOffsetTransformBase< TScalarType, NInputDimensions, NOutputDimensi
 }
 
 
+// Transform a block of points
+template< class TScalarType, unsigned int NInputDimensions,
+unsigned int NOutputDimensions >
+void
+AdvancedMatrixOffsetTransformBase< TScalarType, NInputDimensions, NOutputDimensions >
+::TransformPoints(
+  const InputPointType * inputPoints,
+  OutputPointType * outputPoints,
+  const SizeValueType numberOfPoints ) const
+{
+  /** Copy the matrix and offset to the stack once, instead of
+   * going through the Matrix and Point operators for every point.
+   */
+  ScalarType matrix[ NOutputDimensions ][ NInputDimensions ];
+  ScalarType offset[ NOutputDimensions ];
+  for( unsigned int i = 0; i < NOutputDimensions; ++i )
+  {
+    for( unsigned int j = 0; j < NInputDimensions; ++j )
+    {
+      matrix[ i ][ j ] = this->m_Matrix[ i ][ j ];
+    }
+    offset[ i ] = this->m_Offset[ i ];
+  }
+
+  for( SizeValueType p = 0; p < numberOfPoints; ++p )
+  {
+    /** Copy the input first, so that in-place transformation is allowed. */
+    ScalarType in[ NInputDimensions ];
+    for( unsigned int j = 0; j < NInputDimensions; ++j )
+    {
+      in[ j ] = inputPoints[ p ][ j ];
+    }
+
+    OutputPointType & out = outputPoints[ p ];
+    for( unsigned int i = 0; i < NOutputDimensions; ++i )
+    {
+      ScalarType value = offset[ i ];
+      for( unsigned int j = 0; j < NInputDimensions; ++j )
+      {
+        value += matrix[ i ][ j ] * in[ j ];
+      }
+      out[ i ] = value;
+    }
+  }
+
+} // end TransformPoints()
+
+
+
 // Transform a vector
 template< class TScalarType, unsigned int NInputDimensions,
 unsigned int NOutputDimensions >
@@ -158,6 +158,30 @@ public:
   typedef OutputCovariantVectorType                   MovingImageGradientType;
   typedef typename MovingImageGradientType::ValueType MovingImageGradientValueType;
 
+  /** Transform a contiguous block of points in a single call.
+   * This avoids a virtual function call per point, and allows derived
+   * classes to hoist per-call setup out of the loop over the points.
+   * The default implementation simply calls TransformPoint() for each point.
+   * The output array may be the same as the input array, if the input and
+   * output point types are equal.
+   */
+  virtual void TransformPoints(
+    const InputPointType * inputPoints,
+    OutputPointType * outputPoints,
+    const SizeValueType numberOfPoints ) const;
+
+  /** Transform the equidistant points start + k * step, k = 0, ..., numberOfPoints - 1,
+   * for example the voxel positions on a line of a dense image grid. Derived
+   * classes can exploit the regular structure, see for example
+   * AdvancedBSplineDeformableTransform. The default implementation simply calls
+   * TransformPoint() for each point.
+   */
+  virtual void TransformPointsOnLine(
+    const InputPointType & start,
+    const InputVectorType & step,
+    OutputPointType * outputPoints,
+    const SizeValueType numberOfPoints ) const;
+
   /** Get the number of nonzero Jacobian indices. By default all. */
   virtual NumberOfParametersType GetNumberOfNonZeroJacobianIndices( void ) const;
 
@@ -235,6 +259,16 @@ public:
     const InputPointType & ipp,
     SpatialJacobianType & sj ) const = 0;
 
+  /** Compute the spatial Jacobian for a contiguous block of points in a
+   * single call, for example for a scanline of an image grid. Derived
+   * classes may reuse intermediate results between neighbouring points.
+   * The default implementation simply calls GetSpatialJacobian() for each point.
+   */
+  virtual void GetSpatialJacobians(
+    const InputPointType * inputPoints,
+    SpatialJacobianType * spatialJacobians,
+    const SizeValueType numberOfPoints ) const;
+
   /** Override some pure virtual ITK4 functions. */
   virtual void ComputeJacobianWithRespectToParameters(
     const InputPointType & itkNotUsed( p ), JacobianType & itkNotUsed( j ) ) const
@@ -67,6 +67,72 @@ AdvancedTransform< TScalarType, NInputDimensions, NOutputDimensions >
 } // end Constructor
 
 
+/**
+ * ********************* TransformPoints ****************************
+ */
+
+template< class TScalarType, unsigned int NInputDimensions, unsigned int NOutputDimensions >
+void
+AdvancedTransform< TScalarType, NInputDimensions, NOutputDimensions >
+::TransformPoints(
+  const InputPointType * inputPoints,
+  OutputPointType * outputPoints,
+  const SizeValueType numberOfPoints ) const
+{
+  for( SizeValueType i = 0; i < numberOfPoints; ++i )
+  {
+    outputPoints[ i ] = this->TransformPoint( inputPoints[ i ] );
+  }
+
+} // end TransformPoints()
+
+
+/**
+ * ********************* TransformPointsOnLine ****************************
+ */
+
+template< class TScalarType, unsigned int NInputDimensions, unsigned int NOutputDimensions >
+void
+AdvancedTransform< TScalarType, NInputDimensions, NOutputDimensions >
+::TransformPointsOnLine(
+  const InputPointType & start,
+  const InputVectorType & step,
+  OutputPointType * outputPoints,
+  const SizeValueType numberOfPoints ) const
+{
+  InputPointType point;
+  for( SizeValueType k = 0; k < numberOfPoints; ++k )
+  {
+    for( unsigned int i = 0; i < NInputDimensions; ++i )
+    {
+      point[ i ] = start[ i ] + static_cast< TScalarType >( k ) * step[ i ];
+    }
+    outputPoints[ k ] = this->TransformPoint( point );
+  }
+
+} // end TransformPointsOnLine()
+
+
+/**
+ * ********************* GetSpatialJacobians ****************************
+ */
+
+template< class TScalarType, unsigned int NInputDimensions, unsigned int NOutputDimensions >
+void
+AdvancedTransform< TScalarType, NInputDimensions, NOutputDimensions >
+::GetSpatialJacobians(
+  const InputPointType * inputPoints,
+  SpatialJacobianType * spatialJacobians,
+  const SizeValueType numberOfPoints ) const
+{
+  for( SizeValueType i = 0; i < numberOfPoints; ++i )
+  {
+    this->GetSpatialJacobian( inputPoints[ i ], spatialJacobians[ i ] );
+  }
+
+} // end GetSpatialJacobians()
+
+
 /**
  * ********************* EvaluateJacobianWithImageGradientProduct ****************************
  */
@@ -74,6 +74,14 @@ public:
   typedef typename Superclass::SizeType            SizeType;
   typedef typename Superclass::ContinuousIndexType ContinuousIndexType;
 
+  /** Compute the start index and the 1D weights of the support region in a
+   * single dimension, at continuous index position cindex in that dimension.
+   * The weights array should hold SplineOrder + 1 elements. Since the
+   * B-spline weights are separable, this allows to compute the weights of a
+   * regular grid per axis.
+   */
+  IndexValueType Evaluate1D( const double cindex, double * weights ) const;
+
 protected:
 
   BSplineInterpolationWeightFunction2();
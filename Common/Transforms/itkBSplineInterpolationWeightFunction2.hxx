@@ -67,6 +67,25 @@ BSplineInterpolationWeightFunction2< TCoordRep, VSpaceDimension, VSplineOrder >
 } // end Compute1DWeights()
 
 
+/**
+ * ******************* Evaluate1D *******************
+ */
+
+template< class TCoordRep, unsigned int VSpaceDimension, unsigned int VSplineOrder >
+IndexValueType
+BSplineInterpolationWeightFunction2< TCoordRep, VSpaceDimension, VSplineOrder >
+::Evaluate1D( const double cindex, double * weights ) const
+{
+  /** Same as ComputeStartIndex() and Compute1DWeights(), for one dimension. */
+  const IndexValueType startIndex = static_cast< IndexValueType >(
+    vcl_floor( cindex - static_cast< double >( SplineOrder - 1.0 ) / 2.0 ) );
+  this->m_Kernel->Evaluate( cindex - static_cast< double >( startIndex ), weights );
+
+  return startIndex;
+
+} // end Evaluate1D()
+
+
 } // end namespace itk
 
 #endif
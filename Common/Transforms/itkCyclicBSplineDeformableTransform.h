@@ -94,6 +94,7 @@ public:
   typedef typename RegionType::IndexType       GridOffsetType;
   typedef typename Superclass::InputPointType  InputPointType;
   typedef typename Superclass::OutputPointType OutputPointType;
+  typedef typename Superclass::InputVectorType InputVectorType;
   typedef typename Superclass::WeightsType     WeightsType;
   typedef typename Superclass::
     ParameterIndexArrayType ParameterIndexArrayType;
@@ -129,6 +130,15 @@ public:
     ParameterIndexArrayType & indices,
     bool & inside ) const;
 
+  /** Transform the points of a line one by one. The separable evaluation
+   * of the superclass does not take the cyclic last dimension into account.
+   */
+  virtual void TransformPointsOnLine(
+    const InputPointType & start,
+    const InputVectorType & step,
+    OutputPointType * outputPoints,
+    const SizeValueType numberOfPoints ) const;
+
   /** Compute the Jacobian of the transformation. */
   virtual void GetJacobian(
     const InputPointType & ipp,
@@ -245,6 +245,28 @@ CyclicBSplineDeformableTransform< TScalarType, NDimensions, VSplineOrder >
 }
 
 
+/** Transform the points of a line. */
+template< class TScalarType, unsigned int NDimensions, unsigned int VSplineOrder >
+void
+CyclicBSplineDeformableTransform< TScalarType, NDimensions, VSplineOrder >
+::TransformPointsOnLine(
+  const InputPointType & start,
+  const InputVectorType & step,
+  OutputPointType * outputPoints,
+  const SizeValueType numberOfPoints ) const
+{
+  InputPointType point;
+  for( SizeValueType k = 0; k < numberOfPoints; ++k )
+  {
+    for( unsigned int j = 0; j < SpaceDimension; j++ )
+    {
+      point[ j ] = start[ j ] + static_cast< ScalarType >( k ) * step[ j ];
+    }
+    outputPoints[ k ] = this->Superclass::TransformPoint( point );
+  }
+}
+
+
 /** Compute the Jacobian in one position. */
 template< class TScalarType, unsigned int NDimensions, unsigned int VSplineOrder >
 void
@@ -133,6 +133,15 @@ public:
    */
   virtual OutputPointType TransformPoint( const InputPointType & point ) const;
 
+  /** Compute the point transformation for a contiguous block of points.
+   * The coefficient buffer pointers and the offset table are looked up
+   * only once, instead of once per point.
+   */
+  virtual void TransformPoints(
+    const InputPointType * inputPoints,
+    OutputPointType * outputPoints,
+    const SizeValueType numberOfPoints ) const;
+
   /** Compute the Jacobian of the transformation. */
   virtual void GetJacobian(
     const InputPointType & ipp,
@@ -153,6 +162,17 @@ public:
     const InputPointType & ipp,
     SpatialJacobianType & sj ) const;
 
+  /** Compute the spatial Jacobian for a contiguous block of points.
+   * The 1-D weights of a dimension are only recomputed when the continuous
+   * grid index in that dimension changes, so along a scanline of an image
+   * grid that is aligned with the B-spline grid only the weights of a single
+   * dimension are evaluated per point.
+   */
+  virtual void GetSpatialJacobians(
+    const InputPointType * inputPoints,
+    SpatialJacobianType * spatialJacobians,
+    const SizeValueType numberOfPoints ) const;
+
   /** Compute the spatial Hessian of the transformation. */
   virtual void GetSpatialHessian(
     const InputPointType & ipp,
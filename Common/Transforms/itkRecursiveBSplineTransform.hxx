@@ -20,7 +20,7 @@
 
 #include "itkRecursiveBSplineTransform.h"
 
-#include "itkRecursiveBSplineTransformImplementation.h"
+#include "itkRecursiveBSplineTransformImplementationSIMD.h"
 
 
 namespace itk
@@ -102,7 +102,7 @@ RecursiveBSplineTransform< TScalar, NDimensions, VSplineOrder >
 
   /** Call the recursive TransformPoint function. */
   ScalarType displacement[ SpaceDimension ];
-  RecursiveBSplineTransformImplementation< SpaceDimension, SpaceDimension, SplineOrder, TScalar >
+  RecursiveBSplineTransformImplementationSIMD< SpaceDimension, SpaceDimension, SplineOrder, TScalar >
     ::TransformPoint( displacement, mu, bsplineOffsetTable, weightsArray1D );
 
   // The output point is the start point + displacement.
@@ -115,6 +115,93 @@ RecursiveBSplineTransform< TScalar, NDimensions, VSplineOrder >
 } // end TransformPoint()
 
 
+/**
+ * ********************* TransformPoints ****************************
+ */
+
+template< typename TScalar, unsigned int NDimensions, unsigned int VSplineOrder >
+void
+RecursiveBSplineTransform< TScalar, NDimensions, VSplineOrder >
+::TransformPoints(
+  const InputPointType * inputPoints,
+  OutputPointType * outputPoints,
+  const SizeValueType numberOfPoints ) const
+{
+  /** Define some constants. */
+  const unsigned int numberOfWeights = RecursiveBSplineWeightFunctionType::NumberOfWeights;
+
+  /** Check if the coefficient image has been set. */
+  if( !this->m_CoefficientImages[ 0 ] )
+  {
+    itkWarningMacro( << "B-spline coefficients have not been set" );
+    for( SizeValueType p = 0; p < numberOfPoints; ++p )
+    {
+      outputPoints[ p ] = inputPoints[ p ];
+    }
+    return;
+  }
+
+  /** Allocate weights on the stack: */
+  typename WeightsType::ValueType weightsArray1D[ numberOfWeights ];
+  WeightsType weights1D( weightsArray1D, numberOfWeights, false );
+
+  /** Initialize (helper) variables that are the same for all points. */
+  const OffsetValueType * bsplineOffsetTable = this->m_CoefficientImages[ 0 ]->GetOffsetTable();
+  ScalarType *            bufferPointers[ SpaceDimension ];
+  for( unsigned int j = 0; j < SpaceDimension; ++j )
+  {
+    bufferPointers[ j ] = this->m_CoefficientImages[ j ]->GetBufferPointer();
+  }
+
+  ContinuousIndexType cindex;
+  IndexType           supportIndex;
+  ScalarType *        mu[ SpaceDimension ];
+  ScalarType          displacement[ SpaceDimension ];
+
+  for( SizeValueType p = 0; p < numberOfPoints; ++p )
+  {
+    /** Copy the input point, so that in-place transformation is allowed. */
+    const InputPointType point = inputPoints[ p ];
+    OutputPointType &    outputPoint = outputPoints[ p ];
+
+    /** Convert to continuous index. */
+    this->TransformPointToContinuousGridIndex( point, cindex );
+
+    // NOTE: if the support region does not lie totally within the grid
+    // we assume zero displacement and return the input point
+    if( !this->InsideValidRegion( cindex ) )
+    {
+      outputPoint = point;
+      continue;
+    }
+
+    // Compute interpolation weighs and store them in weights1D
+    this->m_RecursiveBSplineWeightFunction->Evaluate( cindex, weights1D, supportIndex );
+
+    OffsetValueType totalOffsetToSupportIndex = 0;
+    for( unsigned int j = 0; j < SpaceDimension; ++j )
+    {
+      totalOffsetToSupportIndex += supportIndex[ j ] * bsplineOffsetTable[ j ];
+    }
+    for( unsigned int j = 0; j < SpaceDimension; ++j )
+    {
+      mu[ j ] = bufferPointers[ j ] + totalOffsetToSupportIndex;
+    }
+
+    /** Call the recursive TransformPoint function. */
+    RecursiveBSplineTransformImplementationSIMD< SpaceDimension, SpaceDimension, SplineOrder, TScalar >
+      ::TransformPoint( displacement, mu, bsplineOffsetTable, weightsArray1D );
+
+    // The output point is the start point + displacement.
+    for( unsigned int j = 0; j < SpaceDimension; ++j )
+    {
+      outputPoint[ j ] = displacement[ j ] + point[ j ];
+    }
+  }
+
+} // end TransformPoints()
+
+
 /**
  * ********************* GetJacobian ****************************
  */
@@ -167,7 +254,7 @@ RecursiveBSplineTransform< TScalar, NDimensions, VSplineOrder >
    * The pointer has changed after this function call.
    */
   ParametersValueType * jacobianPointer = jacobian.data_block();
-  RecursiveBSplineTransformImplementation< SpaceDimension, SpaceDimension, SplineOrder, TScalar >
+  RecursiveBSplineTransformImplementationSIMD< SpaceDimension, SpaceDimension, SplineOrder, TScalar >
     ::GetJacobian( jacobianPointer, weightsArray1D, 1.0 );
 
   /** Compute the nonzero Jacobian indices.
@@ -234,7 +321,7 @@ RecursiveBSplineTransform< TScalar, NDimensions, VSplineOrder >
     migArray[ j ] = movingImageGradient[ j ];
   }
   ParametersValueType * imageJacobianPointer = imageJacobian.data_block();
-  RecursiveBSplineTransformImplementation< SpaceDimension, SpaceDimension, SplineOrder, TScalar >
+  RecursiveBSplineTransformImplementationSIMD< SpaceDimension, SpaceDimension, SplineOrder, TScalar >
     ::EvaluateJacobianWithImageGradientProduct( imageJacobianPointer, migArray, weightsArray1D, 1.0 );
 
   /** Setup support region needed for the nonZeroJacobianIndices. */
@@ -337,6 +424,114 @@ RecursiveBSplineTransform< TScalar, NDimensions, VSplineOrder >
 } // end GetSpatialJacobian()
 
 
+/**
+ * ********************* GetSpatialJacobians ****************************
+ */
+
+template< class TScalar, unsigned int NDimensions, unsigned int VSplineOrder >
+void
+RecursiveBSplineTransform< TScalar, NDimensions, VSplineOrder >
+::GetSpatialJacobians(
+  const InputPointType * inputPoints,
+  SpatialJacobianType * spatialJacobians,
+  const SizeValueType numberOfPoints ) const
+{
+  /** Define some constants. */
+  const unsigned int numberOfWeights       = RecursiveBSplineWeightFunctionType::NumberOfWeights;
+  const unsigned int numberOfWeightsPerDim = SplineOrder + 1;
+
+  /** Create storage for the B-spline interpolation weights. They are kept
+   * between points, together with the continuous index they belong to.
+   */
+  double              weightsArray1D[ numberOfWeights ];
+  double              derivativeWeightsArray1D[ numberOfWeights ];
+  IndexType           supportIndex;
+  ContinuousIndexType cindex;
+  ContinuousIndexType cachedCIndex;
+  bool                cached[ SpaceDimension ];
+  for( unsigned int j = 0; j < SpaceDimension; ++j )
+  {
+    cached[ j ] = false;
+  }
+
+  /** Initialize (helper) variables that are the same for all points. */
+  const OffsetValueType * bsplineOffsetTable = this->m_CoefficientImages[ 0 ]->GetOffsetTable();
+  ScalarType *            bufferPointers[ SpaceDimension ];
+  for( unsigned int j = 0; j < SpaceDimension; ++j )
+  {
+    bufferPointers[ j ] = this->m_CoefficientImages[ j ]->GetBufferPointer();
+  }
+
+  ScalarType * mu[ SpaceDimension ];
+  double       spatialJacobian[ SpaceDimension * ( SpaceDimension + 1 ) ];
+
+  for( SizeValueType p = 0; p < numberOfPoints; ++p )
+  {
+    SpatialJacobianType & sj = spatialJacobians[ p ];
+
+    /** Convert the physical point to a continuous index. */
+    this->TransformPointToContinuousGridIndex( inputPoints[ p ], cindex );
+
+    // NOTE: if the support region does not lie totally within the grid
+    // we assume zero displacement and identity spatial Jacobian
+    if( !this->InsideValidRegion( cindex ) )
+    {
+      sj.SetIdentity();
+      continue;
+    }
+
+    /** Only recompute the weights of the dimensions that changed. */
+    for( unsigned int j = 0; j < SpaceDimension; ++j )
+    {
+      if( !cached[ j ] || cindex[ j ] != cachedCIndex[ j ] )
+      {
+        supportIndex[ j ] = this->m_RecursiveBSplineWeightFunction->EvaluateWeightsAndDerivative1D(
+          cindex[ j ],
+          weightsArray1D + j * numberOfWeightsPerDim,
+          derivativeWeightsArray1D + j * numberOfWeightsPerDim );
+        cachedCIndex[ j ] = cindex[ j ];
+        cached[ j ]       = true;
+      }
+    }
+
+    /** Get handles to the mu's. */
+    OffsetValueType totalOffsetToSupportIndex = 0;
+    for( unsigned int j = 0; j < SpaceDimension; ++j )
+    {
+      totalOffsetToSupportIndex += supportIndex[ j ] * bsplineOffsetTable[ j ];
+    }
+    for( unsigned int j = 0; j < SpaceDimension; ++j )
+    {
+      mu[ j ] = bufferPointers[ j ] + totalOffsetToSupportIndex;
+    }
+
+    /** Recursively compute the spatial Jacobian. */
+    RecursiveBSplineTransformImplementation< SpaceDimension, SpaceDimension, SplineOrder, TScalar >
+      ::GetSpatialJacobian( spatialJacobian, mu, bsplineOffsetTable,
+      weightsArray1D, derivativeWeightsArray1D );
+
+    /** Copy the correct elements to the spatial Jacobian, see GetSpatialJacobian(). */
+    for( unsigned int i = 0; i < SpaceDimension; ++i )
+    {
+      for( unsigned int j = 0; j < SpaceDimension; ++j )
+      {
+        sj( i, j ) = spatialJacobian[ i + ( j + 1 ) * SpaceDimension ];
+      }
+    }
+
+    /** Take into account grid spacing and direction cosines. */
+    sj = sj * this->m_PointToIndexMatrix2;
+
+    /** Add the identity matrix, as this is a transformation, not displacement. */
+    for( unsigned int j = 0; j < SpaceDimension; ++j )
+    {
+      sj( j, j ) += 1.0;
+    }
+  }
+
+} // end GetSpatialJacobians()
+
+
 /**
  * ********************* GetSpatialHessian ****************************
  */
@@ -0,0 +1,404 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkRecursiveBSplineTransformImplementationSIMD_h
+#define __itkRecursiveBSplineTransformImplementationSIMD_h
+
+#include "itkRecursiveBSplineTransformImplementation.h"
+
+/** Select the instruction set at compile time. The define
+ * ELASTIX_NO_SIMD can be used to force the portable code path.
+ */
+#if !defined( ELASTIX_NO_SIMD )
+#if defined( __AVX__ )
+#define ELASTIX_RECURSIVEBSPLINE_USE_AVX
+#include <immintrin.h>
+#elif defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define ELASTIX_RECURSIVEBSPLINE_USE_SSE2
+#include <emmintrin.h>
+#endif
+#endif
+
+namespace itk
+{
+
+/** \class RecursiveBSplineTransformImplementationSIMD
+ *
+ * \brief Explicitly vectorised versions of some of the functions of
+ * RecursiveBSplineTransformImplementation.
+ *
+ * This generic class simply forwards to RecursiveBSplineTransformImplementation.
+ * A specialisation for third order B-splines in double precision, where
+ * OutputDimension equals SpaceDimension, is given below. It is used by the
+ * RecursiveBSplineTransform for the functions TransformPoint, GetJacobian
+ * and EvaluateJacobianWithImageGradientProduct.
+ *
+ * \ingroup ITKTransform
+ */
+
+template< unsigned int OutputDimension, unsigned int SpaceDimension, unsigned int SplineOrder, class TScalar >
+class RecursiveBSplineTransformImplementationSIMD
+{
+public:
+
+  typedef RecursiveBSplineTransformImplementation<
+    OutputDimension, SpaceDimension, SplineOrder, TScalar >   ScalarImplementationType;
+  typedef typename ScalarImplementationType::ScalarType                   ScalarType;
+  typedef typename ScalarImplementationType::InternalFloatType            InternalFloatType;
+  typedef typename ScalarImplementationType::OutputPointType              OutputPointType;
+  typedef typename ScalarImplementationType::CoefficientPointerVectorType CoefficientPointerVectorType;
+
+  /** TransformPoint implementation. */
+  static inline void TransformPoint(
+    OutputPointType opp, const CoefficientPointerVectorType mu,
+    const OffsetValueType * gridOffsetTable,
+    const double * weights1D )
+  {
+    ScalarImplementationType::TransformPoint( opp, mu, gridOffsetTable, weights1D );
+  } // end TransformPoint()
+
+
+  /** GetJacobian implementation. */
+  static inline void GetJacobian(
+    ScalarType * & jacobians, const double * weights1D, double value )
+  {
+    ScalarImplementationType::GetJacobian( jacobians, weights1D, value );
+  } // end GetJacobian()
+
+
+  /** EvaluateJacobianWithImageGradientProduct implementation. */
+  static inline void EvaluateJacobianWithImageGradientProduct(
+    ScalarType * & imageJacobian, const InternalFloatType * movingImageGradient,
+    const double * weights1D, double value )
+  {
+    ScalarImplementationType::EvaluateJacobianWithImageGradientProduct(
+      imageJacobian, movingImageGradient, weights1D, value );
+  } // end EvaluateJacobianWithImageGradientProduct()
+
+
+};
+
+
+/** \class RecursiveBSplineTransformKernelsSIMD
+ *
+ * \brief Vectorised kernels for cubic B-splines in double precision.
+ *
+ * The support of a cubic B-spline is 4 control points wide in every
+ * dimension. Along the first dimension these 4 coefficients are contiguous
+ * in memory, so that they fit in one AVX register or two SSE2 registers.
+ * The support is therefore split in rows along the first dimension: for
+ * every row the weights of the other dimensions are multiplied once, after
+ * which the 4 taps of all output dimensions are accumulated with vector
+ * instructions. Only at the end the weights of the first dimension are
+ * applied. In 2D and 3D this gives 4 and 16 rows, respectively.
+ * Without SSE2 or AVX the same row-wise scheme is used with plain scalar
+ * code, which compilers can often auto-vectorise.
+ *
+ * Note that the order of summation differs from the recursive scalar
+ * implementation, so results may differ in the last bits.
+ */
+
+template< unsigned int OutputDimension, unsigned int SpaceDimension >
+class RecursiveBSplineTransformKernelsSIMD
+{
+public:
+
+  /** Helper constant variables. */
+  itkStaticConstMacro( SupportWidth, unsigned int, 4 );
+  itkStaticConstMacro( NumberOfRows, unsigned int,
+    ( GetConstNumberOfIndicesHack< 3, SpaceDimension - 1 >::Value ) );
+  itkStaticConstMacro( NumberOfIndices, unsigned int, NumberOfRows * SupportWidth );
+
+  /** Compute for every row of the support region the product of \a value and
+   * the weights of dimensions 1 .. SpaceDimension - 1. The ordering is the
+   * same as in the recursive implementation, i.e. the last dimension varies
+   * slowest. The rows are expanded back to front, so that it can be done in-place.
+   */
+  static inline void ComputeRowWeights( const double * weights1D,
+    double value, double * rowWeights )
+  {
+    rowWeights[ 0 ] = value;
+    unsigned int numberOfRows = 1;
+    for( unsigned int d = SpaceDimension - 1; d > 0; --d )
+    {
+      const double * w = weights1D + d * SupportWidth;
+      for( unsigned int r = numberOfRows; r-- > 0; )
+      {
+        const double rw = rowWeights[ r ];
+        for( unsigned int k = 0; k < SupportWidth; ++k )
+        {
+          rowWeights[ r * SupportWidth + k ] = rw * w[ k ];
+        }
+      }
+      numberOfRows *= SupportWidth;
+    }
+  } // end ComputeRowWeights()
+
+
+  /** Compute for every row of the support region the offset of its start. */
+  static inline void ComputeRowOffsets( const OffsetValueType * gridOffsetTable,
+    OffsetValueType * rowOffsets )
+  {
+    rowOffsets[ 0 ] = 0;
+    unsigned int numberOfRows = 1;
+    for( unsigned int d = SpaceDimension - 1; d > 0; --d )
+    {
+      const OffsetValueType bot = gridOffsetTable[ d ];
+      for( unsigned int r = numberOfRows; r-- > 0; )
+      {
+        const OffsetValueType ro = rowOffsets[ r ];
+        for( unsigned int k = 0; k < SupportWidth; ++k )
+        {
+          rowOffsets[ r * SupportWidth + k ] = ro + k * bot;
+        }
+      }
+      numberOfRows *= SupportWidth;
+    }
+  } // end ComputeRowOffsets()
+
+
+#if defined( ELASTIX_RECURSIVEBSPLINE_USE_AVX )
+  /** Sum the 4 elements of an AVX register. */
+  static inline double HorizontalSum( __m256d v )
+  {
+    __m128d sum = _mm_add_pd( _mm256_castpd256_pd128( v ), _mm256_extractf128_pd( v, 1 ) );
+    sum = _mm_add_sd( sum, _mm_unpackhi_pd( sum, sum ) );
+    return _mm_cvtsd_f64( sum );
+  } // end HorizontalSum()
+
+
+#elif defined( ELASTIX_RECURSIVEBSPLINE_USE_SSE2 )
+  /** Sum the 2 elements of an SSE2 register. */
+  static inline double HorizontalSum( __m128d v )
+  {
+    return _mm_cvtsd_f64( _mm_add_sd( v, _mm_unpackhi_pd( v, v ) ) );
+  } // end HorizontalSum()
+
+
+#endif
+
+  /** TransformPoint implementation. */
+  static inline void TransformPoint(
+    double * opp, double * const * mu,
+    const OffsetValueType * gridOffsetTable,
+    const double * weights1D )
+  {
+    double          rowWeights[ NumberOfRows ];
+    OffsetValueType rowOffsets[ NumberOfRows ];
+    ComputeRowWeights( weights1D, 1.0, rowWeights );
+    ComputeRowOffsets( gridOffsetTable, rowOffsets );
+
+#if defined( ELASTIX_RECURSIVEBSPLINE_USE_AVX )
+    __m256d acc[ OutputDimension ];
+    for( unsigned int j = 0; j < OutputDimension; ++j )
+    {
+      acc[ j ] = _mm256_setzero_pd();
+    }
+    for( unsigned int r = 0; r < NumberOfRows; ++r )
+    {
+      const __m256d w = _mm256_set1_pd( rowWeights[ r ] );
+      for( unsigned int j = 0; j < OutputDimension; ++j )
+      {
+        acc[ j ] = _mm256_add_pd( acc[ j ],
+          _mm256_mul_pd( w, _mm256_loadu_pd( mu[ j ] + rowOffsets[ r ] ) ) );
+      }
+    }
+    const __m256d wx = _mm256_loadu_pd( weights1D );
+    for( unsigned int j = 0; j < OutputDimension; ++j )
+    {
+      opp[ j ] = HorizontalSum( _mm256_mul_pd( acc[ j ], wx ) );
+    }
+#elif defined( ELASTIX_RECURSIVEBSPLINE_USE_SSE2 )
+    __m128d acc01[ OutputDimension ];
+    __m128d acc23[ OutputDimension ];
+    for( unsigned int j = 0; j < OutputDimension; ++j )
+    {
+      acc01[ j ] = _mm_setzero_pd();
+      acc23[ j ] = _mm_setzero_pd();
+    }
+    for( unsigned int r = 0; r < NumberOfRows; ++r )
+    {
+      const __m128d w = _mm_set1_pd( rowWeights[ r ] );
+      for( unsigned int j = 0; j < OutputDimension; ++j )
+      {
+        const double * row = mu[ j ] + rowOffsets[ r ];
+        acc01[ j ] = _mm_add_pd( acc01[ j ], _mm_mul_pd( w, _mm_loadu_pd( row ) ) );
+        acc23[ j ] = _mm_add_pd( acc23[ j ], _mm_mul_pd( w, _mm_loadu_pd( row + 2 ) ) );
+      }
+    }
+    const __m128d wx01 = _mm_loadu_pd( weights1D );
+    const __m128d wx23 = _mm_loadu_pd( weights1D + 2 );
+    for( unsigned int j = 0; j < OutputDimension; ++j )
+    {
+      opp[ j ] = HorizontalSum( _mm_add_pd(
+        _mm_mul_pd( acc01[ j ], wx01 ), _mm_mul_pd( acc23[ j ], wx23 ) ) );
+    }
+#else
+    double acc[ OutputDimension ][ SupportWidth ];
+    for( unsigned int j = 0; j < OutputDimension; ++j )
+    {
+      for( unsigned int k = 0; k < SupportWidth; ++k )
+      {
+        acc[ j ][ k ] = 0.0;
+      }
+    }
+    for( unsigned int r = 0; r < NumberOfRows; ++r )
+    {
+      const double w = rowWeights[ r ];
+      for( unsigned int j = 0; j < OutputDimension; ++j )
+      {
+        const double * row = mu[ j ] + rowOffsets[ r ];
+        for( unsigned int k = 0; k < SupportWidth; ++k )
+        {
+          acc[ j ][ k ] += w * row[ k ];
+        }
+      }
+    }
+    for( unsigned int j = 0; j < OutputDimension; ++j )
+    {
+      opp[ j ] = acc[ j ][ 0 ] * weights1D[ 0 ] + acc[ j ][ 1 ] * weights1D[ 1 ]
+        + acc[ j ][ 2 ] * weights1D[ 2 ] + acc[ j ][ 3 ] * weights1D[ 3 ];
+    }
+#endif
+  } // end TransformPoint()
+
+
+  /** Store the B-spline weights of the support region, multiplied by
+   * \a value and by factors[ j ], at out + j * stride, for every output
+   * dimension j. Used by GetJacobian and EvaluateJacobianWithImageGradientProduct.
+   */
+  static inline void StoreWeights(
+    double * out, const unsigned long stride, const double * factors,
+    const double * weights1D, double value )
+  {
+    double rowWeights[ NumberOfRows ];
+    ComputeRowWeights( weights1D, value, rowWeights );
+
+#if defined( ELASTIX_RECURSIVEBSPLINE_USE_AVX )
+    const __m256d wx = _mm256_loadu_pd( weights1D );
+    for( unsigned int r = 0; r < NumberOfRows; ++r )
+    {
+      const __m256d w = _mm256_mul_pd( _mm256_set1_pd( rowWeights[ r ] ), wx );
+      for( unsigned int j = 0; j < OutputDimension; ++j )
+      {
+        _mm256_storeu_pd( out + j * stride + r * SupportWidth,
+          _mm256_mul_pd( w, _mm256_set1_pd( factors[ j ] ) ) );
+      }
+    }
+#elif defined( ELASTIX_RECURSIVEBSPLINE_USE_SSE2 )
+    const __m128d wx01 = _mm_loadu_pd( weights1D );
+    const __m128d wx23 = _mm_loadu_pd( weights1D + 2 );
+    for( unsigned int r = 0; r < NumberOfRows; ++r )
+    {
+      const __m128d rw  = _mm_set1_pd( rowWeights[ r ] );
+      const __m128d w01 = _mm_mul_pd( rw, wx01 );
+      const __m128d w23 = _mm_mul_pd( rw, wx23 );
+      for( unsigned int j = 0; j < OutputDimension; ++j )
+      {
+        const __m128d f   = _mm_set1_pd( factors[ j ] );
+        double *      dst = out + j * stride + r * SupportWidth;
+        _mm_storeu_pd( dst, _mm_mul_pd( w01, f ) );
+        _mm_storeu_pd( dst + 2, _mm_mul_pd( w23, f ) );
+      }
+    }
+#else
+    for( unsigned int r = 0; r < NumberOfRows; ++r )
+    {
+      for( unsigned int k = 0; k < SupportWidth; ++k )
+      {
+        const double w = rowWeights[ r ] * weights1D[ k ];
+        for( unsigned int j = 0; j < OutputDimension; ++j )
+        {
+          out[ j * stride + r * SupportWidth + k ] = w * factors[ j ];
+        }
+      }
+    }
+#endif
+  } // end StoreWeights()
+
+
+};
+
+
+/** \class RecursiveBSplineTransformImplementationSIMD
+ *
+ * \brief Specialisation for cubic B-splines in double precision.
+ *
+ * Uses the RecursiveBSplineTransformKernelsSIMD. The coefficients must be
+ * contiguous along the first dimension, i.e. gridOffsetTable[ 0 ] == 1,
+ * as is the case for the coefficient images of the B-spline transform.
+ */
+
+template< unsigned int Dimension >
+class RecursiveBSplineTransformImplementationSIMD< Dimension, Dimension, 3, double >
+{
+public:
+
+  typedef RecursiveBSplineTransformImplementation<
+    Dimension, Dimension, 3, double >                                     ScalarImplementationType;
+  typedef RecursiveBSplineTransformKernelsSIMD< Dimension, Dimension >    KernelsType;
+  typedef typename ScalarImplementationType::ScalarType                   ScalarType;
+  typedef typename ScalarImplementationType::InternalFloatType            InternalFloatType;
+  typedef typename ScalarImplementationType::OutputPointType              OutputPointType;
+  typedef typename ScalarImplementationType::CoefficientPointerVectorType CoefficientPointerVectorType;
+
+  /** TransformPoint implementation. */
+  static inline void TransformPoint(
+    OutputPointType opp, const CoefficientPointerVectorType mu,
+    const OffsetValueType * gridOffsetTable,
+    const double * weights1D )
+  {
+    KernelsType::TransformPoint( opp, mu, gridOffsetTable, weights1D );
+  } // end TransformPoint()
+
+
+  /** GetJacobian implementation.
+   * The Jacobian is block diagonal: output dimension j only depends on
+   * the parameters of dimension j.
+   */
+  static inline void GetJacobian(
+    ScalarType * & jacobians, const double * weights1D, double value )
+  {
+    double ones[ Dimension ];
+    for( unsigned int j = 0; j < Dimension; ++j )
+    {
+      ones[ j ] = 1.0;
+    }
+
+    KernelsType::StoreWeights( jacobians,
+      KernelsType::NumberOfIndices * ( Dimension + 1 ), ones, weights1D, value );
+    jacobians += KernelsType::NumberOfIndices;
+  } // end GetJacobian()
+
+
+  /** EvaluateJacobianWithImageGradientProduct implementation. */
+  static inline void EvaluateJacobianWithImageGradientProduct(
+    ScalarType * & imageJacobian, const InternalFloatType * movingImageGradient,
+    const double * weights1D, double value )
+  {
+    KernelsType::StoreWeights( imageJacobian,
+      KernelsType::NumberOfIndices, movingImageGradient, weights1D, value );
+    imageJacobian += KernelsType::NumberOfIndices;
+  } // end EvaluateJacobianWithImageGradientProduct()
+
+
+};
+
+
+} // end namespace itk
+
+#endif /* __itkRecursiveBSplineTransformImplementationSIMD_h */
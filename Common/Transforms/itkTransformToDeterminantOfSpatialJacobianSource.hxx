@@ -38,9 +38,11 @@
 
 #include "itkAdvancedIdentityTransform.h"
 #include "itkProgressReporter.h"
-#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageLinearIteratorWithIndex.h"
 #include "vnl/vnl_det.h"
 
+#include <vector>
+
 namespace itk
 {
 
@@ -244,33 +246,53 @@ TransformToDeterminantOfSpatialJacobianSource< TOutputImage, TTransformPrecision
   // Get the output pointer
   OutputImagePointer outputPtr = this->GetOutput();
 
+  // The region is processed line by line, along the first dimension.
+  // The spatial Jacobians of a whole line are computed with a single call
+  // to the transform, which allows B-spline transforms to reuse the weights
+  // of the other dimensions along the line.
+  const SizeValueType lineLength = outputRegionForThread.GetSize( 0 );
+  if( lineLength == 0 )
+  {
+    return;
+  }
+
   // Create an iterator that will walk the output region for this thread.
-  typedef ImageRegionIteratorWithIndex< TOutputImage > OutputIteratorType;
+  typedef ImageLinearIteratorWithIndex< TOutputImage > OutputIteratorType;
   OutputIteratorType it( outputPtr, outputRegionForThread );
+  it.SetDirection( 0 );
   it.GoToBegin();
 
-  // pixel coordinates
-  PointType point;
+  // The coordinates and spatial Jacobians of one line
+  std::vector< PointType >           points( lineLength );
+  std::vector< SpatialJacobianType > spatialJacobians( lineLength );
 
   // Support for progress methods/callbacks
-  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() );
+  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() / lineLength );
 
   // Walk the output region
   while( !it.IsAtEnd() )
   {
-    // Determine the coordinates of the current voxel
-    outputPtr->TransformIndexToPhysicalPoint( it.GetIndex(), point );
+    // Determine the coordinates of the voxels on this line
+    IndexType index = it.GetIndex();
+    for( SizeValueType i = 0; i < lineLength; ++i )
+    {
+      outputPtr->TransformIndexToPhysicalPoint( index, points[ i ] );
+      ++index[ 0 ];
+    }
 
-    SpatialJacobianType sj;
-    this->m_Transform->GetSpatialJacobian( point, sj );
-    const PixelType detjac = static_cast< PixelType >( vnl_det( sj.GetVnlMatrix() ) );
+    // Compute the spatial Jacobians of the whole line
+    this->m_Transform->GetSpatialJacobians( &points[ 0 ], &spatialJacobians[ 0 ], lineLength );
 
-    // Set it
-    it.Set( detjac );
+    // Set them
+    for( SizeValueType i = 0; i < lineLength; ++i )
+    {
+      it.Set( static_cast< PixelType >( vnl_det( spatialJacobians[ i ].GetVnlMatrix() ) ) );
+      ++it;
+    }
 
     // Update progress and iterator
     progress.CompletedPixel();
-    ++it;
+    it.NextLine();
   }
 
 } // end NonlinearThreadedGenerateData()
@@ -323,7 +345,6 @@ TransformToDeterminantOfSpatialJacobianSource< TOutputImage, TTransformPrecision
   outputPtr->SetSpacing( m_OutputSpacing );
   outputPtr->SetOrigin( m_OutputOrigin );
   outputPtr->SetDirection( m_OutputDirection );
-  outputPtr->Allocate();
 
 } // end GenerateOutputInformation()
 
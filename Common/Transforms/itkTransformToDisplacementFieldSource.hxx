@@ -0,0 +1,316 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkTransformToDisplacementFieldSource_hxx
+#define __itkTransformToDisplacementFieldSource_hxx
+
+#include "itkTransformToDisplacementFieldSource.h"
+
+#include "itkAdvancedIdentityTransform.h"
+#include "itkProgressReporter.h"
+#include "itkImageLinearIteratorWithIndex.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/**
+ * Constructor
+ */
+template< class TOutputImage, class TTransformPrecisionType >
+TransformToDisplacementFieldSource< TOutputImage, TTransformPrecisionType >
+::TransformToDisplacementFieldSource()
+{
+  this->m_OutputSpacing.Fill( 1.0 );
+  this->m_OutputOrigin.Fill( 0.0 );
+  this->m_OutputDirection.SetIdentity();
+
+  SizeType size;
+  size.Fill( 0 );
+  this->m_OutputRegion.SetSize( size );
+
+  IndexType index;
+  index.Fill( 0 );
+  this->m_OutputRegion.SetIndex( index );
+
+  this->m_Transform = AdvancedIdentityTransform< TTransformPrecisionType, ImageDimension >::New();
+
+} // end Constructor
+
+
+/**
+ * Print out a description of self
+ *
+ * \todo Add details about this class
+ */
+template< class TOutputImage, class TTransformPrecisionType >
+void
+TransformToDisplacementFieldSource< TOutputImage, TTransformPrecisionType >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "OutputRegion: " << this->m_OutputRegion << std::endl;
+  os << indent << "OutputSpacing: " << this->m_OutputSpacing << std::endl;
+  os << indent << "OutputOrigin: " << this->m_OutputOrigin << std::endl;
+  os << indent << "OutputDirection: " << this->m_OutputDirection << std::endl;
+  os << indent << "Transform: " << this->m_Transform.GetPointer() << std::endl;
+
+} // end PrintSelf()
+
+
+/**
+ * Set the output image size.
+ */
+template< class TOutputImage, class TTransformPrecisionType >
+void
+TransformToDisplacementFieldSource< TOutputImage, TTransformPrecisionType >
+::SetOutputSize( const SizeType & size )
+{
+  this->m_OutputRegion.SetSize( size );
+}
+
+
+/**
+ * Get the output image size.
+ */
+template< class TOutputImage, class TTransformPrecisionType >
+const typename TransformToDisplacementFieldSource< TOutputImage, TTransformPrecisionType >
+::SizeType
+& TransformToDisplacementFieldSource< TOutputImage, TTransformPrecisionType >
+::GetOutputSize()
+{
+  return this->m_OutputRegion.GetSize();
+}
+
+/**
+ * Set the output image index.
+ */
+template< class TOutputImage, class TTransformPrecisionType >
+void
+TransformToDisplacementFieldSource< TOutputImage, TTransformPrecisionType >
+::SetOutputIndex( const IndexType & index )
+{
+  this->m_OutputRegion.SetIndex( index );
+}
+
+
+/**
+ * Get the output image index.
+ */
+template< class TOutputImage, class TTransformPrecisionType >
+const typename TransformToDisplacementFieldSource< TOutputImage, TTransformPrecisionType >
+::IndexType
+& TransformToDisplacementFieldSource< TOutputImage, TTransformPrecisionType >
+::GetOutputIndex()
+{
+  return this->m_OutputRegion.GetIndex();
+}
+
+/**
+ * Set the output image spacing.
+ */
+template< class TOutputImage, class TTransformPrecisionType >
+void
+TransformToDisplacementFieldSource< TOutputImage, TTransformPrecisionType >
+::SetOutputSpacing( const double * spacing )
+{
+  SpacingType s( spacing );
+  this->SetOutputSpacing( s );
+
+} // end SetOutputSpacing()
+
+
+/**
+ * Set the output image origin.
+ */
+template< class TOutputImage, class TTransformPrecisionType >
+void
+TransformToDisplacementFieldSource< TOutputImage, TTransformPrecisionType >
+::SetOutputOrigin( const double * origin )
+{
+  OriginType p( origin );
+  this->SetOutputOrigin( p );
+
+}
+
+
+/** Helper method to set the output parameters based on this image */
+template< class TOutputImage, class TTransformPrecisionType >
+void
+TransformToDisplacementFieldSource< TOutputImage, TTransformPrecisionType >
+::SetOutputParametersFromImage( const ImageBaseType * image )
+{
+  if( !image )
+  {
+    itkExceptionMacro( << "Cannot use a null image reference" );
+  }
+
+  this->SetOutputOrigin( image->GetOrigin() );
+  this->SetOutputSpacing( image->GetSpacing() );
+  this->SetOutputDirection( image->GetDirection() );
+  this->SetOutputRegion( image->GetLargestPossibleRegion() );
+
+} // end SetOutputParametersFromImage()
+
+
+/**
+ * Set up state of filter before multi-threading.
+ */
+template< class TOutputImage, class TTransformPrecisionType >
+void
+TransformToDisplacementFieldSource< TOutputImage, TTransformPrecisionType >
+::BeforeThreadedGenerateData( void )
+{
+  if( !this->m_Transform )
+  {
+    itkExceptionMacro( << "Transform not set" );
+  }
+
+} // end BeforeThreadedGenerateData()
+
+
+/**
+ * ThreadedGenerateData
+ */
+template< class TOutputImage, class TTransformPrecisionType >
+void
+TransformToDisplacementFieldSource< TOutputImage, TTransformPrecisionType >
+::ThreadedGenerateData(
+  const OutputImageRegionType & outputRegionForThread,
+  ThreadIdType threadId )
+{
+  // Get the output pointer
+  OutputImagePointer outputPtr = this->GetOutput();
+
+  // The region is processed line by line, along the first dimension.
+  const SizeValueType lineLength = outputRegionForThread.GetSize( 0 );
+  if( lineLength == 0 )
+  {
+    return;
+  }
+
+  // Create an iterator that will walk the output region for this thread.
+  typedef ImageLinearIteratorWithIndex< TOutputImage > OutputIteratorType;
+  OutputIteratorType it( outputPtr, outputRegionForThread );
+  it.SetDirection( 0 );
+  it.GoToBegin();
+
+  // The step between two voxels of a line, in physical coordinates
+  IndexType index = outputRegionForThread.GetIndex();
+  PointType point0, point1;
+  outputPtr->TransformIndexToPhysicalPoint( index, point0 );
+  ++index[ 0 ];
+  outputPtr->TransformIndexToPhysicalPoint( index, point1 );
+  InputVectorType step;
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    step[ i ] = static_cast< TTransformPrecisionType >( point1[ i ] - point0[ i ] );
+  }
+
+  // The transformed points of one line
+  std::vector< OutputPointType > outputPoints( lineLength );
+
+  // Support for progress methods/callbacks
+  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() / lineLength );
+
+  // Walk the output region
+  PixelType      displacement;
+  PointType      point;
+  InputPointType start;
+  while( !it.IsAtEnd() )
+  {
+    // Transform all voxels on this line
+    outputPtr->TransformIndexToPhysicalPoint( it.GetIndex(), point );
+    for( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+      start[ i ] = static_cast< TTransformPrecisionType >( point[ i ] );
+    }
+    this->m_Transform->TransformPointsOnLine( start, step, &outputPoints[ 0 ], lineLength );
+
+    // Set the displacements
+    for( SizeValueType k = 0; k < lineLength; ++k )
+    {
+      for( unsigned int i = 0; i < ImageDimension; ++i )
+      {
+        const TTransformPrecisionType x = start[ i ] + static_cast< TTransformPrecisionType >( k ) * step[ i ];
+        displacement[ i ] = static_cast< PixelValueType >( outputPoints[ k ][ i ] - x );
+      }
+      it.Set( displacement );
+      ++it;
+    }
+
+    // Update progress and iterator
+    progress.CompletedPixel();
+    it.NextLine();
+  }
+
+} // end ThreadedGenerateData()
+
+
+/**
+ * Inform pipeline of required output region
+ */
+template< class TOutputImage, class TTransformPrecisionType >
+void
+TransformToDisplacementFieldSource< TOutputImage, TTransformPrecisionType >
+::GenerateOutputInformation( void )
+{
+  // call the superclass' implementation of this method
+  Superclass::GenerateOutputInformation();
+
+  // get pointer to the output
+  OutputImagePointer outputPtr = this->GetOutput();
+  if( !outputPtr )
+  {
+    return;
+  }
+
+  outputPtr->SetLargestPossibleRegion( m_OutputRegion );
+  outputPtr->SetSpacing( m_OutputSpacing );
+  outputPtr->SetOrigin( m_OutputOrigin );
+  outputPtr->SetDirection( m_OutputDirection );
+
+} // end GenerateOutputInformation()
+
+
+/**
+ * Verify if any of the components has been modified.
+ */
+template< class TOutputImage, class TTransformPrecisionType >
+unsigned long
+TransformToDisplacementFieldSource< TOutputImage, TTransformPrecisionType >
+::GetMTime( void ) const
+{
+  unsigned long latestTime = Object::GetMTime();
+
+  if( this->m_Transform )
+  {
+    if( latestTime < this->m_Transform->GetMTime() )
+    {
+      latestTime = this->m_Transform->GetMTime();
+    }
+  }
+
+  return latestTime;
+} // end GetMTime()
+
+
+} // end namespace itk
+
+#endif // end #ifndef _itkTransformToDisplacementFieldSource_hxx
@@ -52,7 +52,11 @@ namespace itk
  * ProcessObject::GenerateOutputInformation().
  *
  * This filter is implemented as a multithreaded filter.  It provides a
- * ThreadedGenerateData() method for its implementation.
+ * ThreadedGenerateData() method for its implementation. Each thread processes
+ * its region line by line, and obtains the spatial Jacobians of a whole line
+ * with a single call to AdvancedTransform::GetSpatialJacobians(). The output
+ * is only allocated for the requested region, so that the filter supports
+ * streaming, for example by an ImageFileWriter with several stream divisions.
  *
  * \author Stefan Klein, Erasmus MC, The Netherlands.
  *
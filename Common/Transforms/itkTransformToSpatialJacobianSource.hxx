@@ -22,9 +22,11 @@
 
 #include "itkAdvancedIdentityTransform.h"
 #include "itkProgressReporter.h"
-#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageLinearIteratorWithIndex.h"
 #include "vnl/vnl_copy.h"
 
+#include <vector>
+
 namespace itk
 {
 
@@ -239,39 +241,59 @@ TransformToSpatialJacobianSource< TOutputImage, TTransformPrecisionType >
   // Get the output pointer
   OutputImagePointer outputPtr = this->GetOutput();
 
+  // The region is processed line by line, along the first dimension.
+  // The spatial Jacobians of a whole line are computed with a single call
+  // to the transform, which allows B-spline transforms to reuse the weights
+  // of the other dimensions along the line.
+  const SizeValueType lineLength = outputRegionForThread.GetSize( 0 );
+  if( lineLength == 0 )
+  {
+    return;
+  }
+
   // Create an iterator that will walk the output region for this thread.
-  typedef ImageRegionIteratorWithIndex< TOutputImage > OutputIteratorType;
+  typedef ImageLinearIteratorWithIndex< TOutputImage > OutputIteratorType;
   OutputIteratorType it( outputPtr, outputRegionForThread );
+  it.SetDirection( 0 );
   it.GoToBegin();
 
-  // pixel coordinates
-  PointType point;
+  // The coordinates and spatial Jacobians of one line
+  std::vector< PointType >           points( lineLength );
+  std::vector< SpatialJacobianType > spatialJacobians( lineLength );
 
-  // Support for progress methods/callbacks
-  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() );
+  PixelType          sjOut;
+  const unsigned int nrElements = spatialJacobians[ 0 ].GetVnlMatrix().size();
 
-  SpatialJacobianType sj;
-  PixelType           sjOut;
-  const unsigned int  nrElements = sj.GetVnlMatrix().size();
+  // Support for progress methods/callbacks
+  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() / lineLength );
 
   // Walk the output region
   while( !it.IsAtEnd() )
   {
-    // Determine the coordinates of the current voxel
-    outputPtr->TransformIndexToPhysicalPoint( it.GetIndex(), point );
-
-    this->m_Transform->GetSpatialJacobian( point, sj );
+    // Determine the coordinates of the voxels on this line
+    IndexType index = it.GetIndex();
+    for( SizeValueType i = 0; i < lineLength; ++i )
+    {
+      outputPtr->TransformIndexToPhysicalPoint( index, points[ i ] );
+      ++index[ 0 ];
+    }
 
-    // cast spatial jacobian to output pixel type
-    vnl_copy( sj.GetVnlMatrix().begin(), sjOut.GetVnlMatrix().begin(),
-      nrElements );
+    // Compute the spatial Jacobians of the whole line
+    this->m_Transform->GetSpatialJacobians( &points[ 0 ], &spatialJacobians[ 0 ], lineLength );
 
-    // Set it
-    it.Set( sjOut );
+    // Set them
+    for( SizeValueType i = 0; i < lineLength; ++i )
+    {
+      // cast spatial jacobian to output pixel type
+      vnl_copy( spatialJacobians[ i ].GetVnlMatrix().begin(), sjOut.GetVnlMatrix().begin(),
+        nrElements );
+      it.Set( sjOut );
+      ++it;
+    }
 
     // Update progress and iterator
     progress.CompletedPixel();
-    ++it;
+    it.NextLine();
   }
 
 } // end NonlinearThreadedGenerateData()
@@ -330,7 +352,6 @@ TransformToSpatialJacobianSource< TOutputImage, TTransformPrecisionType >
   outputPtr->SetSpacing( m_OutputSpacing );
   outputPtr->SetOrigin( m_OutputOrigin );
   outputPtr->SetDirection( m_OutputDirection );
-  outputPtr->Allocate();
 
 } // end GenerateOutputInformation()
 
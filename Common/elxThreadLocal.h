@@ -0,0 +1,31 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __elxThreadLocal_h
+#define __elxThreadLocal_h
+
+/** ELASTIX_THREAD_LOCAL declares a variable with thread storage duration.
+ * Only use it for plain old data, such as pointers, at namespace scope or
+ * as static class members.
+ */
+#if defined( _MSC_VER )
+#define ELASTIX_THREAD_LOCAL __declspec( thread )
+#else
+#define ELASTIX_THREAD_LOCAL __thread
+#endif
+
+#endif // end #ifndef __elxThreadLocal_h
@@ -130,6 +130,21 @@ public:
    */
   virtual OutputType Evaluate( const PointType & point ) const;
 
+  /** Interpolate the image at a batch of point positions.
+   *
+   * This gives the same results as calling Evaluate() for each point, but
+   * is faster: the transformed focal point, the volume dimensions and the
+   * bounding planes of the volume are computed once for the whole batch.
+   * Per ray, only the intercepts with the volume and the voxel increments
+   * are computed, and the rays are traced in small packets that are
+   * traversed together.
+   *
+   * Like Evaluate(), this method is thread-safe, so that a large batch can
+   * be split over multiple threads by the caller.
+   */
+  virtual void EvaluateRays( const PointType * points, OutputType * values,
+    const SizeValueType numberOfRays ) const;
+
   /** Interpolate the image at a continuous index position
    *
    * Returns the interpolated image intensity at a
@@ -129,6 +129,26 @@ public:
    */
   bool IntegrateAboveThreshold( double & integral, double threshold );
 
+  /** \brief
+   * Integrate the interpolated intensities above a given threshold,
+   * along a packet of rays that have been set with SetRay().
+   *
+   * The rays are traversed in lockstep, one plane of voxels per step,
+   * so that the interpolations of the different rays are independent
+   * and can be overlapped by the processor. The results are identical
+   * to those of IntegrateAboveThreshold().
+   *
+   * \param rays          The packet of rays.
+   * \param numberOfRays  The number of rays, at most PacketSize.
+   * \param threshold     The integration threshold.
+   * \param integrals     The integrated intensities along each ray.
+   */
+  static void IntegratePacketAboveThreshold( const RayCastHelper * rays,
+    const unsigned int numberOfRays, const double threshold, double * integrals );
+
+  /** The maximum number of rays in a packet. */
+  itkStaticConstMacro( PacketSize, unsigned int, 4 );
+
   /** \brief
    * Increment each of the intensities of the 4 planar voxels
    * surrounding the current ray point.
@@ -728,19 +748,11 @@ RayCastHelper< TInputImage, TCoordRep >
 ::SetRay( OutputPointType RayPosn, DirectionType RayDirn )
 {
 
-  // Store the position and direction of the ray
-  typename TInputImage::SpacingType spacing = this->m_Image->GetSpacing();
-  SizeType dim = this->m_Image->GetLargestPossibleRegion().GetSize();
+  // Store the position and direction of the ray. The volume dimensions
+  // have been recorded by Initialise(), so that a helper can be reused
+  // for many rays through the same volume.
 
   // we need to translate the _center_ of the volume to the origin
-  m_NumberOfVoxelsInX = dim[ 0 ];
-  m_NumberOfVoxelsInY = dim[ 1 ];
-  m_NumberOfVoxelsInZ = dim[ 2 ];
-
-  m_VoxelDimensionInX = spacing[ 0 ];
-  m_VoxelDimensionInY = spacing[ 1 ];
-  m_VoxelDimensionInZ = spacing[ 2 ];
-
   m_CurrentRayPositionInMM[ 0 ]
     = RayPosn[ 0 ] + 0.5 * m_VoxelDimensionInX * (double)m_NumberOfVoxelsInX;
 
@@ -1440,6 +1452,129 @@ RayCastHelper< TInputImage, TCoordRep >
 }
 
 
+/* -----------------------------------------------------------------------
+   IntegratePacketAboveThreshold() - Integrate a packet of rays.
+   ----------------------------------------------------------------------- */
+
+template< class TInputImage, class TCoordRep >
+void
+RayCastHelper< TInputImage, TCoordRep >
+::IntegratePacketAboveThreshold( const RayCastHelper * rays,
+  const unsigned int numberOfRays, const double threshold, double * integrals )
+{
+  /** Copy the state of each ray to local arrays. The in-plane coordinates
+   * of the traversal direction are selected once, instead of in every step.
+   */
+  const PixelType * voxels[ PacketSize ][ 4 ];
+  double            position[ PacketSize ][ 3 ];
+  double            increment[ PacketSize ][ 3 ];
+  unsigned int      inPlane[ PacketSize ][ 2 ];
+  int               numberOfPlanes[ PacketSize ];
+  int               maximumNumberOfPlanes = 0;
+
+  for( unsigned int r = 0; r < numberOfRays; ++r )
+  {
+    const RayCastHelper & ray = rays[ r ];
+    integrals[ r ]      = 0.0;
+    numberOfPlanes[ r ] = 0;
+    if( !ray.m_ValidRay )
+    {
+      continue;
+    }
+
+    switch( ray.m_TraversalDirection )
+    {
+      case TRANSVERSE_IN_X:
+        inPlane[ r ][ 0 ] = 1; inPlane[ r ][ 1 ] = 2;
+        break;
+      case TRANSVERSE_IN_Y:
+        inPlane[ r ][ 0 ] = 0; inPlane[ r ][ 1 ] = 2;
+        break;
+      case TRANSVERSE_IN_Z:
+        inPlane[ r ][ 0 ] = 0; inPlane[ r ][ 1 ] = 1;
+        break;
+      default:
+      {
+        itk::ExceptionObject err( __FILE__, __LINE__ );
+        err.SetLocation( ITK_LOCATION );
+        err.SetDescription( "The ray traversal direction is unset "
+          "- IntegratePacketAboveThreshold()." );
+        throw err;
+      }
+    }
+
+    for( unsigned int i = 0; i < 4; ++i )
+    {
+      voxels[ r ][ i ] = ray.m_RayIntersectionVoxels[ i ];
+    }
+    for( unsigned int i = 0; i < 3; ++i )
+    {
+      position[ r ][ i ]  = ray.m_Position3Dvox[ i ];
+      increment[ r ][ i ] = ray.m_VoxelIncrement[ i ];
+    }
+    numberOfPlanes[ r ]   = ray.m_TotalRayVoxelPlanes;
+    maximumNumberOfPlanes = vnl_math_max( maximumNumberOfPlanes, numberOfPlanes[ r ] );
+  }
+
+  /** The image dimensions are the same for all rays. */
+  const int strideY = rays[ 0 ].m_NumberOfVoxelsInX;
+  const int strideZ = rays[ 0 ].m_NumberOfVoxelsInX * rays[ 0 ].m_NumberOfVoxelsInY;
+
+  /** Step along the rays, integrating the bilinearly interpolated
+   * intensities, exactly as GetCurrentIntensity() and
+   * IncrementVoxelPointers() do.
+   */
+  for( int plane = 0; plane < maximumNumberOfPlanes; ++plane )
+  {
+    for( unsigned int r = 0; r < numberOfRays; ++r )
+    {
+      if( plane >= numberOfPlanes[ r ] )
+      {
+        continue;
+      }
+
+      const PixelType * const * v = voxels[ r ];
+      double *                  x = position[ r ];
+
+      const double a = static_cast< double >( *v[ 0 ] );
+      const double b = static_cast< double >( *v[ 1 ] - a );
+      const double c = static_cast< double >( *v[ 2 ] - a );
+      const double d = static_cast< double >( *v[ 3 ] - a - b - c );
+      const double y = x[ inPlane[ r ][ 0 ] ] - vcl_floor( x[ inPlane[ r ][ 0 ] ] );
+      const double z = x[ inPlane[ r ][ 1 ] ] - vcl_floor( x[ inPlane[ r ][ 1 ] ] );
+
+      const double intensity = a + b * y + c * z + d * y * z;
+      if( intensity > threshold )
+      {
+        integrals[ r ] += intensity - threshold;
+      }
+
+      const int xBefore = static_cast< int >( x[ 0 ] );
+      const int yBefore = static_cast< int >( x[ 1 ] );
+      const int zBefore = static_cast< int >( x[ 2 ] );
+      x[ 0 ] += increment[ r ][ 0 ];
+      x[ 1 ] += increment[ r ][ 1 ];
+      x[ 2 ] += increment[ r ][ 2 ];
+
+      const int offset = ( static_cast< int >( x[ 0 ] ) - xBefore )
+        + ( static_cast< int >( x[ 1 ] ) - yBefore ) * strideY
+        + ( static_cast< int >( x[ 2 ] ) - zBefore ) * strideZ;
+      voxels[ r ][ 0 ] += offset;
+      voxels[ r ][ 1 ] += offset;
+      voxels[ r ][ 2 ] += offset;
+      voxels[ r ][ 3 ] += offset;
+    }
+  }
+
+  /** Account for the distance between the ray points. */
+  for( unsigned int r = 0; r < numberOfRays; ++r )
+  {
+    integrals[ r ] *= rays[ r ].GetRayPointSpacing();
+  }
+
+} // end IntegratePacketAboveThreshold()
+
+
 /* -----------------------------------------------------------------------
    ZeroState() - Set the default (zero) state of the object
    ----------------------------------------------------------------------- */
@@ -1569,12 +1704,73 @@ AdvancedRayCastInterpolateImageFunction< TInputImage, TCoordRep >
   ray.Initialise();
 
   ray.SetRay( point, direction );
-  ray.IntegrateAboveThreshold( integral, m_Threshold );
+  RayCastHelper< TInputImage, TCoordRep >::IntegratePacketAboveThreshold(
+    &ray, 1, m_Threshold, &integral );
 
   return ( static_cast< OutputType >( integral ) );
 }
 
 
+/* -----------------------------------------------------------------------
+   Evaluate a batch of rays
+   ----------------------------------------------------------------------- */
+
+template< class TInputImage, class TCoordRep >
+void
+AdvancedRayCastInterpolateImageFunction< TInputImage, TCoordRep >
+::EvaluateRays( const PointType * points, OutputType * values,
+  const SizeValueType numberOfRays ) const
+{
+  typedef RayCastHelper< TInputImage, TCoordRep > RayCastHelperType;
+  const unsigned int packetSize = RayCastHelperType::PacketSize;
+
+  if( numberOfRays == 0 )
+  {
+    return;
+  }
+
+  /** The focal point and the volume geometry are the same for all rays:
+   * Initialise() is called once, and SetRay() only computes the intercepts
+   * of each ray with the volume.
+   */
+  const OutputPointType transformedFocalPoint
+    = m_Transform->TransformPoint( m_FocalPoint );
+
+  RayCastHelperType rays[ RayCastHelperType::PacketSize ];
+  rays[ 0 ].SetImage( this->m_Image );
+  rays[ 0 ].ZeroState();
+  rays[ 0 ].Initialise();
+  for( unsigned int r = 1; r < packetSize; ++r )
+  {
+    rays[ r ] = rays[ 0 ];
+  }
+
+  /** Trace the rays in packets. */
+  double integrals[ RayCastHelperType::PacketSize ];
+  for( SizeValueType first = 0; first < numberOfRays; first += packetSize )
+  {
+    const unsigned int numberOfRaysInPacket = static_cast< unsigned int >(
+      vnl_math_min( static_cast< SizeValueType >( packetSize ), numberOfRays - first ) );
+
+    for( unsigned int r = 0; r < numberOfRaysInPacket; ++r )
+    {
+      const PointType &   point     = points[ first + r ];
+      const DirectionType direction = transformedFocalPoint - point;
+      rays[ r ].SetRay( point, direction );
+    }
+
+    RayCastHelperType::IntegratePacketAboveThreshold(
+      rays, numberOfRaysInPacket, m_Threshold, integrals );
+
+    for( unsigned int r = 0; r < numberOfRaysInPacket; ++r )
+    {
+      values[ first + r ] = static_cast< OutputType >( integrals[ r ] );
+    }
+  }
+
+}
+
+
 template< class TInputImage, class TCoordRep >
 typename AdvancedRayCastInterpolateImageFunction< TInputImage, TCoordRep >
 ::OutputType
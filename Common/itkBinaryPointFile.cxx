@@ -0,0 +1,150 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkBinaryPointFile_cxx
+#define __itkBinaryPointFile_cxx
+
+#include "itkBinaryPointFile.h"
+
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <string>
+
+namespace itk
+{
+
+namespace
+{
+
+const char     BinaryPointFileMagic[ 8 ] = { 'E', 'L', 'X', 'P', 'N', 'T', 'S', '\0' };
+const uint32_t BinaryPointFileVersion    = 1;
+
+} // end namespace
+
+/**
+ * ******************* IsBinaryPointFileName *******************
+ */
+
+bool
+BinaryPointFile
+::IsBinaryPointFileName( const std::string & fileName )
+{
+  const std::string extension = GetFileNameExtension();
+  const std::string upperCase = ".BIN";
+  if( fileName.size() < extension.size() )
+  {
+    return false;
+  }
+  const std::string fileNameExtension = fileName.substr( fileName.size() - extension.size() );
+  return fileNameExtension == extension || fileNameExtension == upperCase;
+
+} // end IsBinaryPointFileName()
+
+
+/**
+ * ******************* ReadHeader *******************
+ */
+
+bool
+BinaryPointFile
+::ReadHeader( std::istream & stream, HeaderType & header )
+{
+  char     magic[ 8 ];
+  uint32_t version, dimension, flags, reserved;
+  uint64_t numberOfPoints;
+
+  stream.read( magic, sizeof( magic ) );
+  stream.read( reinterpret_cast< char * >( &version ), sizeof( version ) );
+  stream.read( reinterpret_cast< char * >( &dimension ), sizeof( dimension ) );
+  stream.read( reinterpret_cast< char * >( &flags ), sizeof( flags ) );
+  stream.read( reinterpret_cast< char * >( &reserved ), sizeof( reserved ) );
+  stream.read( reinterpret_cast< char * >( &numberOfPoints ), sizeof( numberOfPoints ) );
+
+  if( !stream
+    || std::memcmp( magic, BinaryPointFileMagic, sizeof( magic ) ) != 0
+    || version != BinaryPointFileVersion )
+  {
+    return false;
+  }
+
+  header.Dimension        = dimension;
+  header.PointsAreIndices = ( flags & 1u ) != 0;
+  header.NumberOfPoints   = numberOfPoints;
+  return true;
+
+} // end ReadHeader()
+
+
+/**
+ * ******************* WriteHeader *******************
+ */
+
+void
+BinaryPointFile
+::WriteHeader( std::ostream & stream, const HeaderType & header )
+{
+  const uint32_t version        = BinaryPointFileVersion;
+  const uint32_t dimension      = header.Dimension;
+  const uint32_t flags          = header.PointsAreIndices ? 1u : 0u;
+  const uint32_t reserved       = 0;
+  const uint64_t numberOfPoints = header.NumberOfPoints;
+
+  stream.write( BinaryPointFileMagic, sizeof( BinaryPointFileMagic ) );
+  stream.write( reinterpret_cast< const char * >( &version ), sizeof( version ) );
+  stream.write( reinterpret_cast< const char * >( &dimension ), sizeof( dimension ) );
+  stream.write( reinterpret_cast< const char * >( &flags ), sizeof( flags ) );
+  stream.write( reinterpret_cast< const char * >( &reserved ), sizeof( reserved ) );
+  stream.write( reinterpret_cast< const char * >( &numberOfPoints ), sizeof( numberOfPoints ) );
+
+} // end WriteHeader()
+
+
+/**
+ * ******************* ReadPoints *******************
+ */
+
+SizeValueType
+BinaryPointFile
+::ReadPoints( std::istream & stream, const unsigned int dimension,
+  const SizeValueType numberOfPoints, double * coordinates )
+{
+  const std::streamsize pointSize = dimension * sizeof( double );
+  stream.read( reinterpret_cast< char * >( coordinates ), numberOfPoints * pointSize );
+  return static_cast< SizeValueType >( stream.gcount() / pointSize );
+
+} // end ReadPoints()
+
+
+/**
+ * ******************* WritePoints *******************
+ */
+
+void
+BinaryPointFile
+::WritePoints( std::ostream & stream, const unsigned int dimension,
+  const SizeValueType numberOfPoints, const double * coordinates )
+{
+  stream.write( reinterpret_cast< const char * >( coordinates ),
+    numberOfPoints * dimension * sizeof( double ) );
+
+} // end WritePoints()
+
+
+} // end namespace itk
+
+#endif // end #ifndef __itkBinaryPointFile_cxx
@@ -0,0 +1,100 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkBinaryPointFile_h
+#define __itkBinaryPointFile_h
+
+#include "itkIntTypes.h"
+#include <iosfwd>
+#include <string>
+
+namespace itk
+{
+
+/**
+ * \class BinaryPointFile
+ * \brief Reads and writes the header of a binary point file.
+ *
+ * A binary point file stores a list of points without any text formatting,
+ * which makes it suited for large point sets, like the vertices of a mesh.
+ * The file consists of a header of 32 bytes:
+ *
+ * \li 8 bytes: the characters "ELXPNTS" followed by a null character;
+ * \li 4 bytes: the version of the format, currently 1;
+ * \li 4 bytes: the dimension D of the points;
+ * \li 4 bytes: flags; bit 0 is set when the points are image indices
+ *   instead of world coordinates;
+ * \li 4 bytes: reserved, 0;
+ * \li 8 bytes: the number of points N;
+ *
+ * followed by N x D coordinates, stored as doubles, point after point. All
+ * numbers are stored in the native byte order of the machine.
+ *
+ * Files with the extension ".bin" are recognised as binary point files.
+ *
+ * \ingroup Common
+ */
+
+class BinaryPointFile
+{
+public:
+
+  /** The information in the header. */
+  struct HeaderType
+  {
+    uint32_t Dimension;
+    bool     PointsAreIndices;
+    uint64_t NumberOfPoints;
+
+    HeaderType() : Dimension( 0 ), PointsAreIndices( false ), NumberOfPoints( 0 ) {}
+  };
+
+  /** The file name extension of binary point files. */
+  static const char * GetFileNameExtension( void ) { return ".bin"; }
+
+  /** Check if a file name has the extension of a binary point file. */
+  static bool IsBinaryPointFileName( const std::string & fileName );
+
+  /** Read the header. Returns false if the stream does not contain a valid
+   * header of a supported version.
+   */
+  static bool ReadHeader( std::istream & stream, HeaderType & header );
+
+  /** Write the header. */
+  static void WriteHeader( std::ostream & stream, const HeaderType & header );
+
+  /** Read numberOfPoints x dimension coordinates. Returns the number of
+   * points that could be read completely.
+   */
+  static SizeValueType ReadPoints( std::istream & stream, const unsigned int dimension,
+    const SizeValueType numberOfPoints, double * coordinates );
+
+  /** Write numberOfPoints x dimension coordinates. */
+  static void WritePoints( std::ostream & stream, const unsigned int dimension,
+    const SizeValueType numberOfPoints, const double * coordinates );
+
+private:
+
+  BinaryPointFile();                            // purposely not implemented
+  BinaryPointFile( const BinaryPointFile & );   // purposely not implemented
+  void operator=( const BinaryPointFile & );    // purposely not implemented
+
+};
+
+} // end namespace itk
+
+#endif // end #ifndef __itkBinaryPointFile_h
@@ -0,0 +1,269 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkComponentProfiler_cxx
+#define __itkComponentProfiler_cxx
+
+#include "itkComponentProfiler.h"
+#include "itkSimpleFastMutexLock.h"
+#include "elxThreadLocal.h"
+
+#include <vector>
+
+#if defined( _WIN32 )
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace itk
+{
+
+bool ComponentProfiler::m_Enabled = false;
+
+namespace
+{
+
+/** The measurements of one thread. */
+struct ComponentProfilerBuffer
+{
+  double        m_Times[ ComponentProfiler::NumberOfCategories ];
+  SizeValueType m_Counts[ ComponentProfiler::NumberOfCategories ];
+
+  ComponentProfilerBuffer() { this->Clear(); }
+
+  void Clear( void )
+  {
+    for( unsigned int i = 0; i < ComponentProfiler::NumberOfCategories; ++i )
+    {
+      this->m_Times[ i ]  = 0.0;
+      this->m_Counts[ i ] = 0;
+    }
+  }
+
+
+  void AddTo( ComponentProfilerBuffer & other ) const
+  {
+    for( unsigned int i = 0; i < ComponentProfiler::NumberOfCategories; ++i )
+    {
+      other.m_Times[ i ]  += this->m_Times[ i ];
+      other.m_Counts[ i ] += this->m_Counts[ i ];
+    }
+  }
+
+
+};
+
+/** The buffer of the calling thread, and the generation of the registry in
+ * which it was handed out. The buffer is only valid in that generation.
+ */
+ELASTIX_THREAD_LOCAL ComponentProfilerBuffer * componentProfilerThreadBuffer = 0;
+ELASTIX_THREAD_LOCAL SizeValueType componentProfilerThreadGeneration = 0;
+
+/** Owns the buffers of all threads. A thread takes a buffer the first time
+ * it measures after a Collect(). Collect() merges the buffers of all threads
+ * and starts a new generation, after which the buffers are reused. Buffers
+ * of threads that have terminated are therefore not lost, and their number
+ * is bounded by the number of threads that measured between two collects.
+ */
+class ComponentProfilerRegistry
+{
+public:
+
+  typedef std::vector< ComponentProfilerBuffer * > BufferContainerType;
+
+  ComponentProfilerRegistry()
+  {
+    this->m_Generation = 1;
+  }
+
+
+  ~ComponentProfilerRegistry()
+  {
+    for( std::size_t i = 0; i < this->m_Live.size(); ++i )
+    {
+      delete this->m_Live[ i ];
+    }
+    for( std::size_t i = 0; i < this->m_Free.size(); ++i )
+    {
+      delete this->m_Free[ i ];
+    }
+  }
+
+
+  /** Get the buffer of the calling thread, taking one the first time in
+   * this generation.
+   */
+  ComponentProfilerBuffer * GetThreadBuffer( void )
+  {
+    if( componentProfilerThreadGeneration != this->m_Generation )
+    {
+      this->m_Mutex.Lock();
+      ComponentProfilerBuffer * buffer = 0;
+      if( this->m_Free.empty() )
+      {
+        buffer = new ComponentProfilerBuffer;
+      }
+      else
+      {
+        buffer = this->m_Free.back();
+        this->m_Free.pop_back();
+      }
+      this->m_Live.push_back( buffer );
+      componentProfilerThreadBuffer     = buffer;
+      componentProfilerThreadGeneration = this->m_Generation;
+      this->m_Mutex.Unlock();
+    }
+    return componentProfilerThreadBuffer;
+  }
+
+
+  /** Merge all buffers into total, clear them, and start a new generation.
+   * No thread should be measuring while this is called.
+   */
+  void Collect( ComponentProfilerBuffer & total )
+  {
+    this->m_Mutex.Lock();
+    for( std::size_t i = 0; i < this->m_Live.size(); ++i )
+    {
+      this->m_Live[ i ]->AddTo( total );
+      this->m_Live[ i ]->Clear();
+      this->m_Free.push_back( this->m_Live[ i ] );
+    }
+    this->m_Live.clear();
+    ++this->m_Generation;
+    this->m_Mutex.Unlock();
+  }
+
+
+private:
+
+  SimpleFastMutexLock m_Mutex;
+  BufferContainerType m_Live;
+  BufferContainerType m_Free;
+  SizeValueType       m_Generation;
+};
+
+ComponentProfilerRegistry componentProfilerRegistry;
+
+} // end namespace
+
+/**
+ * ******************* GetCategoryName *******************
+ */
+
+const char *
+ComponentProfiler
+::GetCategoryName( const CategoryType category )
+{
+  switch( category )
+  {
+    case MetricGetValue:
+      return "Metric.GetValue";
+    case MetricGetValueAndDerivative:
+      return "Metric.GetValueAndDerivative";
+    case ImageSamplerUpdate:
+      return "Metric.ImageSamplerUpdate";
+    case TransformPoint:
+      return "Metric.TransformPoint";
+    case TransformJacobian:
+      return "Metric.TransformJacobian";
+    case InterpolatorEvaluation:
+      return "Metric.InterpolatorEvaluation";
+    case DerivativeAccumulation:
+      return "Metric.DerivativeAccumulation";
+    case OptimizerStep:
+      return "Optimizer.Step";
+    default:
+      return "Unknown";
+  }
+
+} // end GetCategoryName()
+
+
+/**
+ * ******************* GetTimeInSeconds *******************
+ */
+
+double
+ComponentProfiler
+::GetTimeInSeconds( void )
+{
+#if defined( _WIN32 )
+  LARGE_INTEGER frequency, counter;
+  QueryPerformanceFrequency( &frequency );
+  QueryPerformanceCounter( &counter );
+  return static_cast< double >( counter.QuadPart )
+         / static_cast< double >( frequency.QuadPart );
+#else
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return static_cast< double >( ts.tv_sec ) + 1.0e-9 * static_cast< double >( ts.tv_nsec );
+#endif
+
+} // end GetTimeInSeconds()
+
+
+/**
+ * ******************* AddMeasurement *******************
+ */
+
+void
+ComponentProfiler
+::AddMeasurement( const CategoryType category, const double seconds )
+{
+  ComponentProfilerBuffer * buffer = componentProfilerRegistry.GetThreadBuffer();
+  buffer->m_Times[ category ] += seconds;
+  ++buffer->m_Counts[ category ];
+
+} // end AddMeasurement()
+
+
+/**
+ * ******************* Collect *******************
+ */
+
+void
+ComponentProfiler
+::Collect( TimeContainerType & times, CountContainerType & counts )
+{
+  ComponentProfilerBuffer total;
+  componentProfilerRegistry.Collect( total );
+
+  times.assign( total.m_Times, total.m_Times + NumberOfCategories );
+  counts.assign( total.m_Counts, total.m_Counts + NumberOfCategories );
+
+} // end Collect()
+
+
+/**
+ * ******************* Reset *******************
+ */
+
+void
+ComponentProfiler
+::Reset( void )
+{
+  ComponentProfilerBuffer total;
+  componentProfilerRegistry.Collect( total );
+
+} // end Reset()
+
+
+} // end namespace itk
+
+#endif // end #ifndef __itkComponentProfiler_cxx
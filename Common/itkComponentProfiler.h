@@ -0,0 +1,152 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkComponentProfiler_h
+#define __itkComponentProfiler_h
+
+#include "itkIntTypes.h"
+#include <vector>
+
+namespace itk
+{
+
+/**
+ * \class ComponentProfiler
+ * \brief Low-overhead accumulation of the time spent in the registration components.
+ *
+ * The profiler keeps, for a fixed set of categories, the accumulated wall
+ * clock time and the number of calls. Measurements are made with the
+ * ScopedTimer helper class:
+ *
+ * \code
+ *   ComponentProfiler::ScopedTimer timer( ComponentProfiler::TransformJacobian );
+ * \endcode
+ *
+ * When the profiler is disabled (the default) the cost of a ScopedTimer is a
+ * single test of a static flag. When enabled, every thread accumulates into
+ * its own buffer, so that timers in multi-threaded code do not contend.
+ * These buffers are merged by Collect(), which should be called when no
+ * multi-threaded work is in progress, e.g. at the end of an iteration.
+ * After a Collect() the buffers are handed out again, so that the buffers
+ * of threads that have terminated in the meantime are reused.
+ *
+ * The categories are hierarchical, which is reflected by their names: the
+ * "Metric.*" categories are all (partly) contained in the time of
+ * MetricGetValue and MetricGetValueAndDerivative. Note that the time of
+ * categories that are measured inside threads is summed over all threads,
+ * and may therefore exceed the wall clock time of the enclosing category.
+ *
+ * The flag and the buffers are global to the process: Collect() returns what
+ * all threads measured. Profiling is therefore only meaningful when a single
+ * registration runs at a time; elastix does not enable it for batch jobs.
+ *
+ * \ingroup Common
+ */
+
+class ComponentProfiler
+{
+public:
+
+  /** The categories that are profiled. */
+  typedef enum {
+    MetricGetValue = 0,
+    MetricGetValueAndDerivative,
+    ImageSamplerUpdate,
+    TransformPoint,
+    TransformJacobian,
+    InterpolatorEvaluation,
+    DerivativeAccumulation,
+    OptimizerStep,
+    NumberOfCategories
+  } CategoryType;
+
+  typedef std::vector< double >        TimeContainerType;
+  typedef std::vector< SizeValueType > CountContainerType;
+
+  /** Enable or disable profiling. Disabling does not clear the
+   * measurements that have not yet been collected.
+   */
+  static void SetEnabled( const bool arg ) { m_Enabled = arg; }
+  static bool GetEnabled( void ) { return m_Enabled; }
+
+  /** Get the hierarchical name of a category, e.g. "Metric.TransformJacobian". */
+  static const char * GetCategoryName( const CategoryType category );
+
+  /** Get the current time in seconds, from a monotonic high-resolution clock. */
+  static double GetTimeInSeconds( void );
+
+  /** Add a measurement of one call to the buffer of the calling thread. */
+  static void AddMeasurement( const CategoryType category, const double seconds );
+
+  /** Get the times (in seconds) and counts accumulated over all threads
+   * since the last call to Collect() or Reset(), and reset them.
+   */
+  static void Collect( TimeContainerType & times, CountContainerType & counts );
+
+  /** Discard all measurements. */
+  static void Reset( void );
+
+  /** \class ScopedTimer
+   * \brief Measures the time between its construction and destruction.
+   */
+  class ScopedTimer
+  {
+public:
+
+    ScopedTimer( const CategoryType category ) :
+      m_Category( category ), m_Enabled( ComponentProfiler::GetEnabled() ), m_Start( 0.0 )
+    {
+      if( this->m_Enabled )
+      {
+        this->m_Start = ComponentProfiler::GetTimeInSeconds();
+      }
+    }
+
+
+    ~ScopedTimer()
+    {
+      if( this->m_Enabled )
+      {
+        ComponentProfiler::AddMeasurement( this->m_Category,
+          ComponentProfiler::GetTimeInSeconds() - this->m_Start );
+      }
+    }
+
+
+private:
+
+    ScopedTimer( const ScopedTimer & ); // purposely not implemented
+    void operator=( const ScopedTimer & ); // purposely not implemented
+
+    const CategoryType m_Category;
+    const bool         m_Enabled;
+    double             m_Start;
+  };
+
+private:
+
+  ComponentProfiler();                       // purposely not implemented
+  ComponentProfiler( const ComponentProfiler & ); // purposely not implemented
+  void operator=( const ComponentProfiler & );    // purposely not implemented
+
+  static bool m_Enabled;
+
+};
+
+} // end namespace itk
+
+#endif // end #ifndef __itkComponentProfiler_h
@@ -25,6 +25,10 @@
 #include "itkImageRandomCoordinateSampler.h"
 #include "itkImageFullSampler.h"
 #include "itkMultiThreader.h"
+#include "itkPersistentThreadPool.h"
+
+#include <string>
+#include <vector>
 
 namespace itk
 {
@@ -219,6 +223,12 @@ protected:
   bool                        m_UseMultiThread;
   ImageSampleContainerPointer m_SampleContainer;
 
+  /** The method passed to Compute(), and for the "95percentile" method the
+   * displacement of each sample.
+   */
+  std::string           m_Method;
+  std::vector< double > m_Displacements;
+
 private:
 
   ComputeDisplacementDistribution( const Self & ); // purposely not implemented
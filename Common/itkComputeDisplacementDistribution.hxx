@@ -21,6 +21,7 @@
 #include "itkComputeDisplacementDistribution.h"
 
 #include <string>
+#include <algorithm>
 #include "vnl/vnl_math.h"
 #include "vnl/vnl_fastops.h"
 #include "vnl/vnl_diag_matrix.h"
@@ -52,6 +53,7 @@ ComputeDisplacementDistribution< TFixedImage, TTransform >
 
   /** Threading related variables. */
   this->m_UseMultiThread = true;
+  this->m_Method         = "2sigma";
   this->m_Threader       = ThreaderType::New();
   this->m_Threader->SetUseThreadPool( false );
 
@@ -265,7 +267,7 @@ ComputeDisplacementDistribution< TFixedImage, TTransform >
   {
     return this->ComputeSingleThreaded( mu, jacg, maxJJ, methods );
   }
-  // The multi-threaded route only supports methods == 2sigma for now
+  this->m_Method = methods;
 
   /** Initialize multi-threading. */
   this->InitializeThreadingParameters();
@@ -307,6 +309,14 @@ ComputeDisplacementDistribution< TFixedImage, TTransform >
   /** Get samples. */
   this->SampleFixedImageForJacobianTerms( this->m_SampleContainer );
 
+  /** The percentile needs the displacement of each sample. The threads
+   * write them into their own part of this vector.
+   */
+  if( this->m_Method == "95percentile" )
+  {
+    this->m_Displacements.resize( this->m_SampleContainer->Size() );
+  }
+
 } // end BeforeThreadedCompute()
 
 
@@ -319,12 +329,10 @@ void
 ComputeDisplacementDistribution< TFixedImage, TTransform >
 ::LaunchComputeThreaderCallback( void ) const
 {
-  /** Setup threader. */
-  this->m_Threader->SetSingleMethod( this->ComputeThreaderCallback,
-    const_cast< void * >( static_cast< const void * >( &this->m_ThreaderParameters ) ) );
-
-  /** Launch. */
-  this->m_Threader->SingleMethodExecute();
+  /** Launch the threads of the persistent thread pool. */
+  PersistentThreadPool::SingleMethodExecute( this->ComputeThreaderCallback,
+    const_cast< void * >( static_cast< const void * >( &this->m_ThreaderParameters ) ),
+    this->m_Threader->GetNumberOfThreads() );
 
 } // end LaunchComputeThreaderCallback()
 
@@ -389,7 +397,7 @@ ComputeDisplacementDistribution< TFixedImage, TTransform >
   if( sizejacind > 1 ) { jacind[ 1 ] = 0; }
 
   /** Temporaries. */
-  //std::vector< double > JGG_k; not here so only mean + 2 sigma is supported
+  const bool     storeDisplacements = !this->m_Displacements.empty();
   DerivativeType Jgg( outdim ); Jgg.Fill( 0.0 );
   const double   sqrt2 = vcl_sqrt( static_cast< double >( 2.0 ) );
   JacobianType   jacjjacj( outdim, outdim );
@@ -450,6 +458,10 @@ ComputeDisplacementDistribution< TFixedImage, TTransform >
     jggMagnitude         = Jgg.magnitude();
     displacement        += jggMagnitude;
     displacementSquared += vnl_math_sqr( jggMagnitude );
+    if( storeDisplacements )
+    {
+      this->m_Displacements[ pos_begin + numberOfPixelsCounted ] = jggMagnitude;
+    }
     numberOfPixelsCounted++;
   }
 
@@ -494,11 +506,29 @@ ComputeDisplacementDistribution< TFixedImage, TTransform >
     this->m_ComputePerThreadVariables[ i ].st_NumberOfPixelsCounted = 0;
   }
 
-  /** Compute the sigma of the distribution of the displacements. */
-  const double meanDisplacement = displacement / this->m_NumberOfPixelsCounted;
-  const double sigma            = displacementSquared / this->m_NumberOfPixelsCounted - vnl_math_sqr( meanDisplacement );
+  if( this->m_Method == "95percentile" )
+  {
+    /** Compute the 95% percentile of the distribution of the displacements.
+     * Only the elements around it have to be in sorted order.
+     */
+    std::vector< double > & displacements = this->m_Displacements;
+    const SizeValueType     d             = static_cast< SizeValueType >( displacements.size() * 0.95 );
+    std::nth_element( displacements.begin(), displacements.begin() + d, displacements.end() );
+    const double jggd0 = *std::max_element( displacements.begin(), displacements.begin() + d );
+    const double jggd1 = *std::min_element( displacements.begin() + d + 1, displacements.end() );
+    jacg = ( jggd0 + displacements[ d ] + jggd1 ) / 3.0;
+
+    /** Release the memory. */
+    std::vector< double >().swap( this->m_Displacements );
+  }
+  else
+  {
+    /** Compute the sigma of the distribution of the displacements. */
+    const double meanDisplacement = displacement / this->m_NumberOfPixelsCounted;
+    const double sigma            = displacementSquared / this->m_NumberOfPixelsCounted - vnl_math_sqr( meanDisplacement );
 
-  jacg = meanDisplacement + 2.0 * vcl_sqrt( sigma );
+    jacg = meanDisplacement + 2.0 * vcl_sqrt( sigma );
+  }
 
 } // end AfterThreadedCompute()
 
@@ -22,6 +22,13 @@
 #include "itkImageRandomSamplerBase.h"
 #include "itkImageRandomCoordinateSampler.h"
 #include "itkScaledSingleValuedNonLinearOptimizer.h"
+#include "itkMultiThreader.h"
+#include "itkPersistentThreadPool.h"
+#include "itkArray2D.h"
+
+#include "vnl/vnl_sparse_matrix.h"
+
+#include <vector>
 
 namespace itk
 {
@@ -31,6 +38,15 @@ namespace itk
  * More specifically this class computes the Jacobian terms related to the automatic
  * parameter estimation for the adaptive stochastic gradient descent optimizer.
  * Details can be found in the paper.
+ *
+ * The computation is multi-threaded. The covariance matrix \f$C\f$ is stored
+ * as a band matrix, for the differences in parameter number that occur most,
+ * plus a sparse matrix for the remaining elements. The samples are divided
+ * over the threads: each thread accumulates \f$J^T J\f$ of its samples into
+ * a partial covariance matrix, so every Jacobian is computed only once. The
+ * partial matrices are then added, with the rows of \f$C\f$ divided over the
+ * threads. Note that this takes a band matrix per thread. The maxima over
+ * the samples are computed with per-thread accumulators.
  */
 
 template< class TFixedImage, class TTransform >
@@ -107,10 +123,21 @@ public:
   virtual void Compute( double & TrC, double & TrCC,
     double & maxJJ, double & maxJCJ );
 
+  /** Set the number of threads. */
+  void SetNumberOfThreads( ThreadIdType numberOfThreads )
+  {
+    this->m_Threader->SetNumberOfThreads( numberOfThreads );
+  }
+
+
 protected:
 
   ComputeJacobianTerms();
-  virtual ~ComputeJacobianTerms() {}
+  virtual ~ComputeJacobianTerms();
+
+  /** Typedefs for multi-threading. */
+  typedef itk::MultiThreader             ThreaderType;
+  typedef ThreaderType::ThreadInfoStruct ThreadInfoType;
 
   typename FixedImageType::ConstPointer m_FixedImage;
   FixedImageRegionType       m_FixedImageRegion;
@@ -119,9 +146,10 @@ protected:
   ScalesType                 m_Scales;
   bool                       m_UseScales;
 
-  unsigned int  m_MaxBandCovSize;
-  unsigned int  m_NumberOfBandStructureSamples;
-  SizeValueType m_NumberOfJacobianMeasurements;
+  unsigned int          m_MaxBandCovSize;
+  unsigned int          m_NumberOfBandStructureSamples;
+  SizeValueType         m_NumberOfJacobianMeasurements;
+  ThreaderType::Pointer m_Threader;
 
   typedef typename  FixedImageType::IndexType   FixedImageIndexType;
   typedef typename  FixedImageType::PointType   FixedImagePointType;
@@ -151,11 +179,89 @@ protected:
   virtual void SampleFixedImageForJacobianTerms(
     ImageSampleContainerPointer & sampleContainer );
 
+  /** Typedefs for the covariance matrix. */
+  typedef double                                   CovarianceValueType;
+  typedef itk::Array2D< CovarianceValueType >      CovarianceMatrixType;
+  typedef vnl_sparse_matrix< CovarianceValueType > SparseCovarianceMatrixType;
+  typedef typename SparseCovarianceMatrixType::row SparseRowType;
+
 private:
 
   ComputeJacobianTerms( const Self & ); // purposely not implemented
   void operator=( const Self & );       // purposely not implemented
 
+  /** Threader callbacks, and the work they do for one thread. The first
+   * computes the partial C of a part of the samples. The second adds the
+   * partial matrices for a part of the rows of C, and computes TrC and TrCC
+   * for these rows. The third computes maxJJ and maxJCJ for a part of the
+   * samples.
+   */
+  static ITK_THREAD_RETURN_TYPE ComputeCovarianceThreaderCallback( void * arg );
+
+  static ITK_THREAD_RETURN_TYPE ReduceCovarianceThreaderCallback( void * arg );
+
+  static ITK_THREAD_RETURN_TYPE ComputeMaximaThreaderCallback( void * arg );
+
+  void ThreadedComputeCovariance( ThreadIdType threadId );
+
+  void ThreadedReduceCovariance( ThreadIdType threadId );
+
+  void ThreadedComputeMaxima( ThreadIdType threadId );
+
+  /** Get the range of samples of a thread. */
+  void GetThreadSampleRange( const ThreadIdType threadId,
+    SizeValueType & pos_begin, SizeValueType & pos_end ) const;
+
+  /** Launch one of the threader callbacks. */
+  void LaunchThreaderCallback( ThreadFunctionType callback ) const;
+
+  /** Add the sum of J_j^T J_j over samples with the same nonzero Jacobian
+   * indices to a (partial) covariance matrix.
+   */
+  void AccumulateCovariance( const NonZeroJacobianIndicesType & jacind,
+    const CovarianceMatrixType & jactjac, const double n,
+    CovarianceMatrixType & bandcov, SparseCovarianceMatrixType & cov ) const;
+
+  /** To give the threads access to all member variables and functions. */
+  struct MultiThreaderParameterType
+  {
+    Self * st_Self;
+  };
+  mutable MultiThreaderParameterType m_ThreaderParameters;
+
+  struct ComputePerThreadStruct
+  {
+    double st_TrC;
+    double st_TrCC;
+    double st_MaxJJ;
+    double st_MaxJCJ;
+  };
+  itkPadStruct( ITK_CACHE_LINE_ALIGNMENT, ComputePerThreadStruct,
+    PaddedComputePerThreadStruct );
+  itkAlignedTypedef( ITK_CACHE_LINE_ALIGNMENT, PaddedComputePerThreadStruct,
+    AlignedComputePerThreadStruct );
+  AlignedComputePerThreadStruct * m_ComputePerThreadVariables;
+  ThreadIdType                    m_ComputePerThreadVariablesSize;
+
+  /** The samples, and the covariance matrix: the band part, the maps between
+   * band column and parameter number difference (q-p), the other elements,
+   * and the diagonal. Only the upper triangular part is stored.
+   */
+  ImageSampleContainerPointer        m_SampleContainer;
+  CovarianceMatrixType               m_BandCov;
+  std::vector< unsigned int >        m_BandCovMap;
+  std::vector< unsigned int >        m_BandCovMap2;
+  SparseCovarianceMatrixType         m_Cov;
+  std::vector< CovarianceValueType > m_DiagCov;
+
+  /** The partial covariance matrices of the threads other than the first. */
+  struct ThreadCovarianceType
+  {
+    CovarianceMatrixType       st_BandCov;
+    SparseCovarianceMatrixType st_Cov;
+  };
+  std::vector< ThreadCovarianceType > m_ThreadCovariances;
+
 };
 
 } // end namespace itk
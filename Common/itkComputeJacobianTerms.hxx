@@ -23,7 +23,6 @@
 #include "vnl/vnl_math.h"
 #include "vnl/vnl_fastops.h"
 #include "vnl/vnl_diag_matrix.h"
-#include "vnl/vnl_sparse_matrix.h"
 
 namespace itk
 {
@@ -45,9 +44,28 @@ ComputeJacobianTerms< TFixedImage, TTransform >
   this->m_NumberOfBandStructureSamples = 0;
   this->m_NumberOfJacobianMeasurements = 0;
 
+  /** Threading related variables. */
+  this->m_Threader = ThreaderType::New();
+  this->m_Threader->SetUseThreadPool( false );
+  this->m_ThreaderParameters.st_Self    = this;
+  this->m_ComputePerThreadVariables     = NULL;
+  this->m_ComputePerThreadVariablesSize = 0;
+
 } // end Constructor
 
 
+/**
+ * ************************* Destructor ************************
+ */
+
+template< class TFixedImage, class TTransform >
+ComputeJacobianTerms< TFixedImage, TTransform >
+::~ComputeJacobianTerms()
+{
+  delete[] this->m_ComputePerThreadVariables;
+} // end Destructor
+
+
 /**
  * ************************* Compute ************************
  */
@@ -73,41 +91,19 @@ ComputeJacobianTerms< TFixedImage, TTransform >
    * Term 4: maxJCJ, see (54)
    */
 
-  typedef double                                   CovarianceValueType;
-  typedef itk::Array2D< CovarianceValueType >      CovarianceMatrixType;
-  typedef vnl_sparse_matrix< CovarianceValueType > SparseCovarianceMatrixType;
-  typedef SparseCovarianceMatrixType::row          SparseRowType;
-  typedef itk::Array< SizeValueType >              NonZeroJacobianIndicesExpandedType;
-  typedef vnl_diag_matrix< CovarianceValueType >   DiagCovarianceMatrixType;
-
   /** Initialize. */
   TrC = TrCC = maxJJ = maxJCJ = 0.0;
 
   /** Get samples. */
-  ImageSampleContainerPointer sampleContainer = 0;
-  SampleFixedImageForJacobianTerms( sampleContainer );
-  const SizeValueType nrofsamples = sampleContainer->Size();
-  const double        n           = static_cast< double >( nrofsamples );
+  this->SampleFixedImageForJacobianTerms( this->m_SampleContainer );
+  const SizeValueType nrofsamples = this->m_SampleContainer->Size();
 
   /** Get the number of parameters. */
   const unsigned int P = static_cast< unsigned int >(
     this->m_Transform->GetNumberOfParameters() );
 
-  /** Get transform and set current position. */
-  typename TransformType::Pointer transform
-    = this->m_Transform;
-  const unsigned int outdim = this->m_Transform->GetOutputSpaceDimension();
-
-  /** Get scales vector */
-  const ScalesType & scales = this->m_Scales;
-
-  /** Create iterator over the sample container. */
-  typename ImageSampleContainerType::ConstIterator iter;
-  typename ImageSampleContainerType::ConstIterator begin = sampleContainer->Begin();
-  typename ImageSampleContainerType::ConstIterator end   = sampleContainer->End();
-  unsigned int samplenr = 0;
-
   /** Variables for nonzerojacobian indices and the Jacobian. */
+  const unsigned int     outdim = this->m_Transform->GetOutputSpaceDimension();
   NumberOfParametersType sizejacind
     = this->m_Transform->GetNumberOfNonZeroJacobianIndices();
   JacobianType jacj( outdim, sizejacind );
@@ -115,16 +111,6 @@ ComputeJacobianTerms< TFixedImage, TTransform >
   NonZeroJacobianIndicesType jacind( sizejacind );
   jacind[ 0 ] = 0;
   if( sizejacind > 1 ) { jacind[ 1 ] = 0; }
-  NonZeroJacobianIndicesType prevjacind = jacind;
-
-  /** Initialize covariance matrix. Sparse, diagonal, and band form. */
-  SparseCovarianceMatrixType cov( P, P );
-  DiagCovarianceMatrixType   diagcov( P, 0.0 );
-  CovarianceMatrixType       bandcov;
-
-  /** For temporary storage of J'J. */
-  CovarianceMatrixType jactjac( sizejacind, sizejacind );
-  jactjac.Fill( 0.0 );
 
   typedef std::vector< unsigned int >             DifHistType;
   typedef std::pair< unsigned int, unsigned int > FreqPairType;
@@ -147,11 +133,9 @@ ComputeJacobianTerms< TFixedImage, TTransform >
    * The histogram is then sorted and the most occurring bands
    * are determined. The covariance elements in these bands will not
    * be stored in the sparse matrix structure 'cov', but in the band
-   * matrix 'bandcov', which is much faster.
-   * Only after the bandcov and cov have been filled (by looping over
-   * all Jacobian measurements in the sample container, the bandcov
-   * matrix is injected in the cov matrix, for easy further calculations,
-   * and the bandcov matrix is deleted.
+   * matrix 'bandcov', which is much faster. The band matrix is used
+   * throughout the computation; the sparse matrix only holds the
+   * remaining elements.
    */
   unsigned int onezero = 0;
   for( unsigned int s = 0; s < this->m_NumberOfBandStructureSamples; ++s )
@@ -163,7 +147,7 @@ ComputeJacobianTerms< TFixedImage, TTransform >
 
     /** Read fixed coordinates and get Jacobian J_j. */
     const FixedImagePointType & point
-      = sampleContainer->GetElement( samplenr ).m_ImageCoordinates;
+      = this->m_SampleContainer->GetElement( samplenr ).m_ImageCoordinates;
     this->m_Transform->GetJacobian( point, jacj, jacind );
 
     /** Skip invalid Jacobians in the beginning, if any. */
@@ -200,9 +184,9 @@ ComputeJacobianTerms< TFixedImage, TTransform >
     static_cast< unsigned int >( difHist2.size() ) );
 
   /** Maps parameterNrDifference (q-p) to colnr in bandcov. */
-  std::vector< unsigned int > bandcovMap( P, bandcovsize );
+  this->m_BandCovMap.assign( P, bandcovsize );
   /** Maps colnr in bandcov to parameterNrDifference (q-p). */
-  std::vector< unsigned int > bandcovMap2( bandcovsize, P );
+  this->m_BandCovMap2.assign( bandcovsize, P );
 
   /** Sort the difHist2 based on the frequencies. */
   std::sort( difHist2.begin(), difHist2.end() );
@@ -212,32 +196,151 @@ ComputeJacobianTerms< TFixedImage, TTransform >
   for( unsigned int b = 0; b < bandcovsize; ++b )
   {
     --difHist2It;
-    bandcovMap[ difHist2It->second ] = b;
-    bandcovMap2[ b ]                 = difHist2It->second;
+    this->m_BandCovMap[ difHist2It->second ] = b;
+    this->m_BandCovMap2[ b ]                 = difHist2It->second;
   }
 
-  /** Initialize band matrix. */
-  bandcov = CovarianceMatrixType( P, bandcovsize );
-  bandcov.Fill( 0.0 );
+  /** Initialize the covariance matrix: band, sparse and diagonal part. */
+  this->m_BandCov = CovarianceMatrixType( P, bandcovsize );
+  this->m_BandCov.Fill( 0.0 );
+  this->m_Cov = SparseCovarianceMatrixType( P, P );
+  this->m_DiagCov.assign( P, 0.0 );
+
+  /** Initialize the per-thread accumulators. */
+  const ThreadIdType numberOfThreads = this->m_Threader->GetNumberOfThreads();
+  if( this->m_ComputePerThreadVariablesSize != numberOfThreads )
+  {
+    delete[] this->m_ComputePerThreadVariables;
+    this->m_ComputePerThreadVariables     = new AlignedComputePerThreadStruct[ numberOfThreads ];
+    this->m_ComputePerThreadVariablesSize = numberOfThreads;
+  }
+
+  /**
+   *    TERM 1 and 2
+   *
+   * Compute C = 1/n \sum_i J_i^T J_i, possibly apply scaling,
+   * and compute TrC = trace(C) and TrCC = ||C||_F^2.
+   * Each thread first sums the samples of its own range into a partial C;
+   * the partial matrices are then added row by row.
+   */
+  this->m_ThreadCovariances.resize( numberOfThreads - 1 );
+  this->LaunchThreaderCallback( this->ComputeCovarianceThreaderCallback );
+  this->LaunchThreaderCallback( this->ReduceCovarianceThreaderCallback );
+  std::vector< ThreadCovarianceType >().swap( this->m_ThreadCovariances );
+  for( ThreadIdType i = 0; i < numberOfThreads; ++i )
+  {
+    TrC  += this->m_ComputePerThreadVariables[ i ].st_TrC;
+    TrCC += this->m_ComputePerThreadVariables[ i ].st_TrCC;
+  }
 
   /**
-   *    TERM 1
+   *    TERM 3 and 4
    *
-   * Loop over image and compute Jacobian.
-   * Compute C = 1/n \sum_i J_i^T J_i
-   * Possibly apply scaling afterwards.
+   * Compute maxJJ and maxJCJ
+   * \li maxJJ = max_j [ ||J_j||_F^2 + 2\sqrt{2} || J_j J_j^T ||_F ]
+   * \li maxJCJ = max_j [ Tr( J_j C J_j^T ) + 2\sqrt{2} || J_j C J_j^T ||_F ]
    */
+  this->LaunchThreaderCallback( this->ComputeMaximaThreaderCallback );
+  for( ThreadIdType i = 0; i < numberOfThreads; ++i )
+  {
+    maxJJ  = vnl_math_max( maxJJ, this->m_ComputePerThreadVariables[ i ].st_MaxJJ );
+    maxJCJ = vnl_math_max( maxJCJ, this->m_ComputePerThreadVariables[ i ].st_MaxJCJ );
+  }
+
+  /** Release the memory of the covariance matrix and the samples. */
+  this->m_BandCov.SetSize( 0, 0 );
+  this->m_Cov = SparseCovarianceMatrixType();
+  std::vector< CovarianceValueType >().swap( this->m_DiagCov );
+  std::vector< unsigned int >().swap( this->m_BandCovMap );
+  std::vector< unsigned int >().swap( this->m_BandCovMap2 );
+  this->m_SampleContainer = 0;
+
+} // end Compute()
+
+
+/**
+ * ************************* GetThreadSampleRange ************************
+ */
+
+template< class TFixedImage, class TTransform >
+void
+ComputeJacobianTerms< TFixedImage, TTransform >
+::GetThreadSampleRange( const ThreadIdType threadId,
+  SizeValueType & pos_begin, SizeValueType & pos_end ) const
+{
+  const SizeValueType sampleContainerSize = this->m_SampleContainer->Size();
+  const ThreadIdType  numberOfThreads     = this->m_Threader->GetNumberOfThreads();
+  const SizeValueType nrOfSamplesPerThreads
+    = static_cast< SizeValueType >( vcl_ceil( static_cast< double >( sampleContainerSize )
+    / static_cast< double >( numberOfThreads ) ) );
+  pos_begin = nrOfSamplesPerThreads * threadId;
+  pos_end   = nrOfSamplesPerThreads * ( threadId + 1 );
+  pos_begin = ( pos_begin > sampleContainerSize ) ? sampleContainerSize : pos_begin;
+  pos_end   = ( pos_end > sampleContainerSize ) ? sampleContainerSize : pos_end;
+
+} // end GetThreadSampleRange()
+
+
+/**
+ * ************************* ThreadedComputeCovariance ************************
+ */
+
+template< class TFixedImage, class TTransform >
+void
+ComputeJacobianTerms< TFixedImage, TTransform >
+::ThreadedComputeCovariance( ThreadIdType threadId )
+{
+  /** Get the samples for this thread. */
+  SizeValueType pos_begin, pos_end;
+  this->GetThreadSampleRange( threadId, pos_begin, pos_end );
+  const double n = static_cast< double >( this->m_SampleContainer->Size() );
+
+  /** The first thread accumulates into the covariance matrix itself, the
+   * others into a partial covariance matrix of their own.
+   */
+  CovarianceMatrixType *       bandcov = &this->m_BandCov;
+  SparseCovarianceMatrixType * cov     = &this->m_Cov;
+  if( threadId > 0 )
+  {
+    ThreadCovarianceType & threadCovariance = this->m_ThreadCovariances[ threadId - 1 ];
+    threadCovariance.st_BandCov = CovarianceMatrixType( this->m_BandCov.rows(), this->m_BandCov.cols() );
+    threadCovariance.st_BandCov.Fill( 0.0 );
+    threadCovariance.st_Cov = SparseCovarianceMatrixType( this->m_Cov.rows(), this->m_Cov.cols() );
+    bandcov = &threadCovariance.st_BandCov;
+    cov     = &threadCovariance.st_Cov;
+  }
+
+  /** Variables for nonzerojacobian indices and the Jacobian. */
+  const unsigned int     outdim = this->m_Transform->GetOutputSpaceDimension();
+  NumberOfParametersType sizejacind
+    = this->m_Transform->GetNumberOfNonZeroJacobianIndices();
+  JacobianType jacj( outdim, sizejacind );
+  jacj.Fill( 0.0 );
+  NonZeroJacobianIndicesType jacind( sizejacind );
   jacind[ 0 ] = 0;
   if( sizejacind > 1 ) { jacind[ 1 ] = 0; }
+  NonZeroJacobianIndicesType prevjacind = jacind;
+
+  /** For temporary storage of J'J. */
+  CovarianceMatrixType jactjac( sizejacind, sizejacind );
+  jactjac.Fill( 0.0 );
+
+  /** Loop over the samples of this thread, and add J_j^T J_j to C.
+   * Consecutive samples with the same nonzero Jacobian indices are summed
+   * first, and added to C in one go.
+   */
+  typename ImageSampleContainerType::ConstIterator iter;
+  typename ImageSampleContainerType::ConstIterator begin = this->m_SampleContainer->Begin();
+  typename ImageSampleContainerType::ConstIterator end   = this->m_SampleContainer->Begin();
+  begin += (int)pos_begin;
+  end   += (int)pos_end;
+
+  bool first = true;
   for( iter = begin; iter != end; ++iter )
   {
-    /** Print progress 0-50%.
-     *progressObserver->UpdateAndPrintProgress( samplenr );*/
-    ++samplenr;
-
     /** Read fixed coordinates and get Jacobian J_j. */
     const FixedImagePointType & point = ( *iter ).Value().m_ImageCoordinates;
-    this->m_Transform->GetJacobian( point, jacj, jacind  );
+    this->m_Transform->GetJacobian( point, jacj, jacind );
 
     /** Skip invalid Jacobians in the beginning, if any. */
     if( sizejacind > 1 )
@@ -245,70 +348,66 @@ ComputeJacobianTerms< TFixedImage, TTransform >
       if( jacind[ 0 ] == jacind[ 1 ] ) { continue; }
     }
 
-    if( jacind == prevjacind )
+    if( !first && jacind == prevjacind )
     {
       /** Update sum of J_j^T J_j. */
       vnl_fastops::inc_X_by_AtA( jactjac, jacj );
     }
     else
     {
-      /** The following should only be done after the first sample. */
-      if( iter != begin )
+      /** Update covariance matrix with the sum of the previous samples. */
+      if( !first )
       {
-        /** Update covariance matrix. */
-        for( unsigned int pi = 0; pi < sizejacind; ++pi )
-        {
-          const unsigned int p = prevjacind[ pi ];
-          for( unsigned int qi = 0; qi < sizejacind; ++qi )
-          {
-            const unsigned int q = prevjacind[ qi ];
-            if( q >= p )
-            {
-              const double tempval = jactjac( pi, qi ) / n;
-              if( vcl_abs( tempval ) > 1e-14 )
-              {
-                const unsigned int bandindex = bandcovMap[ q - p ];
-                if( bandindex < bandcovsize )
-                {
-                  bandcov( p, bandindex ) += tempval;
-                }
-                else
-                {
-                  cov( p, q ) += tempval;
-                }
-              }
-            }
-          } // qi
-        }   // pi
-      }     // end if
+        this->AccumulateCovariance( prevjacind, jactjac, n, *bandcov, *cov );
+      }
+      first = false;
 
       /** Initialize jactjac by J_j^T J_j. */
       vnl_fastops::AtA( jactjac, jacj );
 
       /** Remember nonzerojacobian indices. */
       prevjacind = jacind;
-    } // end else
+    }
 
   } // end iter loop: end computation of covariance matrix
 
-  /** Update covariance matrix once again to include last jactjac updates
-   * \todo: a bit ugly that this loop is copied from above.
-   */
+  /** Update covariance matrix once again to include last jactjac updates. */
+  if( !first )
+  {
+    this->AccumulateCovariance( prevjacind, jactjac, n, *bandcov, *cov );
+  }
+
+} // end ThreadedComputeCovariance()
+
+
+/**
+ * ************************* AccumulateCovariance ************************
+ */
+
+template< class TFixedImage, class TTransform >
+void
+ComputeJacobianTerms< TFixedImage, TTransform >
+::AccumulateCovariance( const NonZeroJacobianIndicesType & jacind,
+  const CovarianceMatrixType & jactjac, const double n,
+  CovarianceMatrixType & bandcov, SparseCovarianceMatrixType & cov ) const
+{
+  const unsigned int bandcovsize = bandcov.cols();
+  const unsigned int sizejacind  = jacind.size();
   for( unsigned int pi = 0; pi < sizejacind; ++pi )
   {
-    const unsigned int p = prevjacind[ pi ];
+    const unsigned int p = jacind[ pi ];
     for( unsigned int qi = 0; qi < sizejacind; ++qi )
     {
-      const unsigned int q = prevjacind[ qi ];
+      const unsigned int q = jacind[ qi ];
       if( q >= p )
       {
-        const double tempval = jactjac( pi, qi ) / n;
+        const double tempval = jactjac[ pi ][ qi ] / n;
         if( vcl_abs( tempval ) > 1e-14 )
         {
-          const unsigned int bandindex = bandcovMap[ q - p ];
+          const unsigned int bandindex = this->m_BandCovMap[ q - p ];
           if( bandindex < bandcovsize )
           {
-            bandcov( p, bandindex ) += tempval;
+            bandcov[ p ][ bandindex ] += tempval;
           }
           else
           {
@@ -319,80 +418,138 @@ ComputeJacobianTerms< TFixedImage, TTransform >
     } // qi
   }   // pi
 
-  /** Copy the bandmatrix into the sparse matrix and empty the bandcov matrix.
-   * \todo: perhaps work further with this bandmatrix instead.
-   */
-  for( unsigned int p = 0; p < P; ++p )
+} // end AccumulateCovariance()
+
+
+/**
+ * ************************* ThreadedReduceCovariance ************************
+ */
+
+template< class TFixedImage, class TTransform >
+void
+ComputeJacobianTerms< TFixedImage, TTransform >
+::ThreadedReduceCovariance( ThreadIdType threadId )
+{
+  /** The rows of C that are reduced by this thread. */
+  const ThreadIdType  numberOfThreads = this->m_Threader->GetNumberOfThreads();
+  const SizeValueType P               = this->m_Transform->GetNumberOfParameters();
+  const unsigned int  pBegin          = static_cast< unsigned int >( P * threadId / numberOfThreads );
+  const unsigned int  pEnd            = static_cast< unsigned int >( P * ( threadId + 1 ) / numberOfThreads );
+  const unsigned int  bandcovsize     = this->m_BandCov.cols();
+
+  /** Add the partial covariance matrices of the other threads to these rows. */
+  for( unsigned int t = 0; t < this->m_ThreadCovariances.size(); ++t )
   {
-    for( unsigned int b = 0; b < bandcovsize; ++b )
+    ThreadCovarianceType & threadCovariance = this->m_ThreadCovariances[ t ];
+    for( unsigned int p = pBegin; p < pEnd; ++p )
     {
-      const double tempval = bandcov( p, b );
-      if( vcl_abs( tempval ) > 1e-14 )
+      const CovarianceValueType * threadbandrow = threadCovariance.st_BandCov[ p ];
+      CovarianceValueType *       bandrow       = this->m_BandCov[ p ];
+      for( unsigned int b = 0; b < bandcovsize; ++b )
+      {
+        bandrow[ b ] += threadbandrow[ b ];
+      }
+
+      if( !threadCovariance.st_Cov.empty_row( p ) )
       {
-        const unsigned int q = p + bandcovMap2[ b ];
-        cov( p, q ) = tempval;
+        const SparseRowType & threadrow = threadCovariance.st_Cov.get_row( p );
+        for( typename SparseRowType::const_iterator it = threadrow.begin(); it != threadrow.end(); ++it )
+        {
+          this->m_Cov( p, ( *it ).first ) += ( *it ).second;
+        }
       }
     }
   }
-  bandcov.set_size( 0, 0 );
 
-  /** Apply scales. the use of m_Scales maybe something wrong. */
-  if( this->m_UseScales )
+  /** Apply scales, compute the diagonal, and the contributions of these
+   * rows to TrC and TrCC. Small band elements are discarded, as they would
+   * not have been stored in a sparse matrix.
+   */
+  const ScalesType &  scales       = this->m_Scales;
+  const unsigned int  diagBand     = this->m_BandCovMap[ 0 ];
+  CovarianceValueType trC          = 0.0;
+  CovarianceValueType sumOfSquares = 0.0;
+  CovarianceValueType diagSquared  = 0.0;
+  for( unsigned int p = pBegin; p < pEnd; ++p )
   {
-    for( unsigned int p = 0; p < P; ++p )
+    CovarianceValueType * bandrow = this->m_BandCov[ p ];
+    for( unsigned int b = 0; b < bandcovsize; ++b )
     {
-      cov.scale_row( p, 1.0 / this->m_Scales[ p ] );
+      if( vcl_abs( bandrow[ b ] ) <= 1e-14 )
+      {
+        bandrow[ b ] = 0.0;
+        continue;
+      }
+      if( this->m_UseScales )
+      {
+        bandrow[ b ] /= scales[ p ] * scales[ p + this->m_BandCovMap2[ b ] ];
+      }
+      sumOfSquares += vnl_math_sqr( bandrow[ b ] );
     }
-    /**  \todo: this might be faster with get_row instead of the iterator */
-    cov.reset();
-    bool notfinished = cov.next();
-    while( notfinished )
+
+    CovarianceValueType covpp = 0.0;
+    if( !this->m_Cov.empty_row( p ) )
     {
-      const int col = cov.getcolumn();
-      cov( cov.getrow(), col ) /= scales[ col ];
-      notfinished               = cov.next();
+      SparseRowType & covrowp = this->m_Cov.get_row( p );
+      for( typename SparseRowType::iterator it = covrowp.begin(); it != covrowp.end(); ++it )
+      {
+        if( this->m_UseScales )
+        {
+          ( *it ).second /= scales[ p ] * scales[ ( *it ).first ];
+        }
+        sumOfSquares += vnl_math_sqr( ( *it ).second );
+        if( ( *it ).first == p ) { covpp = ( *it ).second; }
+      }
     }
-  }
-
-  /** Compute TrC = trace(C), and diagcov. */
-  for( unsigned int p = 0; p < P; ++p )
-  {
-    if( !cov.empty_row( p ) )
+    if( diagBand < bandcovsize )
     {
-      //avoid creation of element if the row is empty
-      CovarianceValueType & covpp = cov( p, p );
-      TrC         += covpp;
-      diagcov[ p ] = covpp;
+      covpp = bandrow[ diagBand ];
     }
-  }
 
-  /**
-   *    TERM 2
-   *
-   * Compute TrCC = ||C||_F^2.
-   */
-  cov.reset();
-  bool notfinished2 = cov.next();
-  while( notfinished2 )
-  {
-    TrCC        += vnl_math_sqr( cov.value() );
-    notfinished2 = cov.next();
+    this->m_DiagCov[ p ] = covpp;
+    trC                 += covpp;
+    diagSquared         += vnl_math_sqr( covpp );
   }
 
   /** Symmetry: multiply by 2 and subtract sumsqr(diagcov). */
-  TrCC *= 2.0;
-  TrCC -= diagcov.diagonal().squared_magnitude();
+  this->m_ComputePerThreadVariables[ threadId ].st_TrC  = trC;
+  this->m_ComputePerThreadVariables[ threadId ].st_TrCC = 2.0 * sumOfSquares - diagSquared;
 
-  /**
-   *    TERM 3 and 4
-   *
-   * Compute maxJJ and maxJCJ
-   * \li maxJJ = max_j [ ||J_j||_F^2 + 2\sqrt{2} || J_j J_j^T ||_F ]
-   * \li maxJCJ = max_j [ Tr( J_j C J_j^T ) + 2\sqrt{2} || J_j C J_j^T ||_F ]
-   */
-  maxJJ  = 0.0;
-  maxJCJ = 0.0;
-  const double sqrt2 = vcl_sqrt( static_cast< double >( 2.0 ) );
+} // end ThreadedReduceCovariance()
+
+
+/**
+ * ************************* ThreadedComputeMaxima ************************
+ */
+
+template< class TFixedImage, class TTransform >
+void
+ComputeJacobianTerms< TFixedImage, TTransform >
+::ThreadedComputeMaxima( ThreadIdType threadId )
+{
+  typedef itk::Array< SizeValueType >            NonZeroJacobianIndicesExpandedType;
+  typedef vnl_diag_matrix< CovarianceValueType > DiagCovarianceMatrixType;
+
+  /** Get the samples for this thread. */
+  SizeValueType pos_begin, pos_end;
+  this->GetThreadSampleRange( threadId, pos_begin, pos_end );
+
+  /** Variables for nonzerojacobian indices and the Jacobian. */
+  const unsigned int     P           = this->m_DiagCov.size();
+  const unsigned int     bandcovsize = this->m_BandCov.cols();
+  const unsigned int     outdim      = this->m_Transform->GetOutputSpaceDimension();
+  NumberOfParametersType sizejacind
+    = this->m_Transform->GetNumberOfNonZeroJacobianIndices();
+  JacobianType jacj( outdim, sizejacind );
+  jacj.Fill( 0.0 );
+  NonZeroJacobianIndicesType jacind( sizejacind );
+  jacind[ 0 ] = 0;
+  if( sizejacind > 1 ) { jacind[ 1 ] = 0; }
+
+  const ScalesType & scales = this->m_Scales;
+  const double       sqrt2  = vcl_sqrt( static_cast< double >( 2.0 ) );
+  double             maxJJ  = 0.0;
+  double             maxJCJ = 0.0;
 
   JacobianType                       jacjjacj( outdim, outdim );
   JacobianType                       jacjcov( outdim, sizejacind );
@@ -401,8 +558,15 @@ ComputeJacobianTerms< TFixedImage, TTransform >
   JacobianType                       jacjdiagcovjacj( outdim, outdim );
   JacobianType                       jacjcovjacj( outdim, outdim );
   NonZeroJacobianIndicesExpandedType jacindExpanded( P );
+  jacindExpanded.Fill( sizejacind );
+
+  /** Create iterator over the sample container. */
+  typename ImageSampleContainerType::ConstIterator iter;
+  typename ImageSampleContainerType::ConstIterator begin = this->m_SampleContainer->Begin();
+  typename ImageSampleContainerType::ConstIterator end   = this->m_SampleContainer->Begin();
+  begin += (int)pos_begin;
+  end   += (int)pos_end;
 
-  samplenr = 0;
   for( iter = begin; iter != end; ++iter )
   {
     /** Read fixed coordinates and get Jacobian. */
@@ -438,12 +602,11 @@ ComputeJacobianTerms< TFixedImage, TTransform >
     /** Store the nonzero Jacobian indices in a different format
      * and create the sparse diagcov.
      */
-    jacindExpanded.Fill( sizejacind );
     for( unsigned int pi = 0; pi < sizejacind; ++pi )
     {
       const unsigned int p = jacind[ pi ];
       jacindExpanded[ p ] = pi;
-      diagcovsparse[ pi ] = diagcov[ p ];
+      diagcovsparse[ pi ] = this->m_DiagCov[ p ];
     }
 
     /** We below calculate jacjC = J_j cov^T, but later we will correct
@@ -454,12 +617,30 @@ ComputeJacobianTerms< TFixedImage, TTransform >
     for( unsigned int pi = 0; pi < sizejacind; ++pi )
     {
       const unsigned int p = jacind[ pi ];
-      if( !cov.empty_row( p ) )
+
+      /** Loop over the bands of row p. */
+      const CovarianceValueType * bandrow = this->m_BandCov[ p ];
+      for( unsigned int b = 0; b < bandcovsize; ++b )
       {
-        SparseRowType & covrowp = cov.get_row( p );
-        typename SparseRowType::iterator covrowpit;
+        const CovarianceValueType covElement = bandrow[ b ];
+        if( covElement != 0.0 )
+        {
+          const unsigned int qi = jacindExpanded[ p + this->m_BandCovMap2[ b ] ];
+          if( qi < sizejacind )
+          {
+            for( unsigned int dx = 0; dx < outdim; ++dx )
+            {
+              jacjcov[ dx ][ pi ] += jacj[ dx ][ qi ] * covElement;
+            }
+          }
+        }
+      }
 
-        /** Loop over row p of the sparse cov matrix. */
+      /** Loop over the other elements of row p. */
+      if( !this->m_Cov.empty_row( p ) )
+      {
+        const SparseRowType & covrowp = this->m_Cov.get_row( p );
+        typename SparseRowType::const_iterator covrowpit;
         for( covrowpit = covrowp.begin(); covrowpit != covrowp.end(); ++covrowpit )
         {
           const unsigned int q  = ( *covrowpit ).first;
@@ -479,6 +660,12 @@ ComputeJacobianTerms< TFixedImage, TTransform >
       } // if not empty row
     }   // pi
 
+    /** Reset the expanded nonzero Jacobian indices. */
+    for( unsigned int pi = 0; pi < sizejacind; ++pi )
+    {
+      jacindExpanded[ jacind[ pi ] ] = sizejacind;
+    }
+
     /** J_j C J_j^T  = jacjCjacj.
      * But note that we actually compute J_j cov' J_j^T
      */
@@ -502,16 +689,99 @@ ComputeJacobianTerms< TFixedImage, TTransform >
     /** Max_j [JCJ_j]. */
     maxJCJ = vnl_math_max( maxJCJ, JCJ_j );
 
-    /** Show progress 50-100%. */
-    //progressObserver->UpdateAndPrintProgress( samplenr + nrofsamples );
-    ++samplenr;
-
   } // end loop over sample container
 
-  /** Finalize progress information. */
-  //progressObserver->PrintProgress( 1.0 );
+  /** Update the thread struct once. */
+  this->m_ComputePerThreadVariables[ threadId ].st_MaxJJ  = maxJJ;
+  this->m_ComputePerThreadVariables[ threadId ].st_MaxJCJ = maxJCJ;
 
-} // end Compute()
+} // end ThreadedComputeMaxima()
+
+
+/**
+ * ************ ComputeCovarianceThreaderCallback ****************************
+ */
+
+template< class TFixedImage, class TTransform >
+ITK_THREAD_RETURN_TYPE
+ComputeJacobianTerms< TFixedImage, TTransform >
+::ComputeCovarianceThreaderCallback( void * arg )
+{
+  /** Get the current thread id and user data. */
+  ThreadInfoType *             infoStruct = static_cast< ThreadInfoType * >( arg );
+  ThreadIdType                 threadID   = infoStruct->ThreadID;
+  MultiThreaderParameterType * temp
+    = static_cast< MultiThreaderParameterType * >( infoStruct->UserData );
+
+  /** Call the real implementation. */
+  temp->st_Self->ThreadedComputeCovariance( threadID );
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end ComputeCovarianceThreaderCallback()
+
+
+/**
+ * ************ ReduceCovarianceThreaderCallback ****************************
+ */
+
+template< class TFixedImage, class TTransform >
+ITK_THREAD_RETURN_TYPE
+ComputeJacobianTerms< TFixedImage, TTransform >
+::ReduceCovarianceThreaderCallback( void * arg )
+{
+  /** Get the current thread id and user data. */
+  ThreadInfoType *             infoStruct = static_cast< ThreadInfoType * >( arg );
+  ThreadIdType                 threadID   = infoStruct->ThreadID;
+  MultiThreaderParameterType * temp
+    = static_cast< MultiThreaderParameterType * >( infoStruct->UserData );
+
+  /** Call the real implementation. */
+  temp->st_Self->ThreadedReduceCovariance( threadID );
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end ReduceCovarianceThreaderCallback()
+
+
+/**
+ * ************ ComputeMaximaThreaderCallback ****************************
+ */
+
+template< class TFixedImage, class TTransform >
+ITK_THREAD_RETURN_TYPE
+ComputeJacobianTerms< TFixedImage, TTransform >
+::ComputeMaximaThreaderCallback( void * arg )
+{
+  /** Get the current thread id and user data. */
+  ThreadInfoType *             infoStruct = static_cast< ThreadInfoType * >( arg );
+  ThreadIdType                 threadID   = infoStruct->ThreadID;
+  MultiThreaderParameterType * temp
+    = static_cast< MultiThreaderParameterType * >( infoStruct->UserData );
+
+  /** Call the real implementation. */
+  temp->st_Self->ThreadedComputeMaxima( threadID );
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end ComputeMaximaThreaderCallback()
+
+
+/**
+ * *********************** LaunchThreaderCallback ***************
+ */
+
+template< class TFixedImage, class TTransform >
+void
+ComputeJacobianTerms< TFixedImage, TTransform >
+::LaunchThreaderCallback( ThreadFunctionType callback ) const
+{
+  /** Launch the threads of the persistent thread pool. */
+  PersistentThreadPool::SingleMethodExecute( callback,
+    const_cast< void * >( static_cast< const void * >( &this->m_ThreaderParameters ) ),
+    this->m_Threader->GetNumberOfThreads() );
+
+} // end LaunchThreaderCallback()
 
 
 /**
@@ -106,7 +106,10 @@ protected:
     localInputImage->Graft( inputImage );
 #endif
 
+    /** Only cast the buffered region, which is a piece of the image
+     * when the writer streams. */
     caster->SetInput( localInputImage );
+    caster->GetOutput()->SetRequestedRegion( localInputImage->GetBufferedRegion() );
     caster->Update();
 
     /** return the pixel buffer of the casted image */
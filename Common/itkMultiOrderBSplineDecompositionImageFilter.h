@@ -40,6 +40,8 @@
 #include <vector>
 
 #include "itkImageLinearIteratorWithIndex.h"
+#include "itkImageLinearConstIteratorWithIndex.h"
+#include "itkMultiThreader.h"
 #include "vnl/vnl_matrix.h"
 
 #include "itkImageToImageFilter.h"
@@ -71,11 +73,16 @@ namespace itk
  *               Uses mirror boundary conditions.
  *               Can only process LargestPossibleRegion
  *
+ * The recursive filter is separable, so the image is processed one dimension
+ * at a time. Within a dimension, the 1-D lines are independent, and these are
+ * distributed over the threads. The first dimension reads its lines directly
+ * from the input image, so no separate copy of the input is needed.
+ *
  * \sa itkBSplineInterpolateImageFunction
  *
  *  ***TODO: Is this an ImageFilter?  or does it belong to another group?
  * \ingroup ImageFilters
- * \ingroup SingleThreaded
+ * \ingroup MultiThreaded
  * \ingroup CannotBeStreamed
  */
 template< class TInputImage, class TOutputImage >
@@ -101,6 +108,7 @@ public:
   typedef typename Superclass::InputImagePointer      InputImagePointer;
   typedef typename Superclass::InputImageConstPointer InputImageConstPointer;
   typedef typename Superclass::OutputImagePointer     OutputImagePointer;
+  typedef typename Superclass::OutputImageRegionType  OutputImageRegionType;
 
   typedef typename itk::NumericTraits< typename TOutputImage::PixelType >::RealType CoeffType;
 
@@ -110,7 +118,8 @@ public:
     TOutputImage::ImageDimension );
 
   /** Iterator typedef support */
-  typedef ImageLinearIteratorWithIndex< TOutputImage > OutputLinearIterator;
+  typedef ImageLinearConstIteratorWithIndex< TInputImage > InputLinearIterator;
+  typedef ImageLinearIteratorWithIndex< TOutputImage >     OutputLinearIterator;
 
   /** Get/Sets the Spline Order, supports 0th - 5th order splines. The default
    *  is a 3rd order spline. */
@@ -118,7 +127,7 @@ public:
 
   void SetSplineOrder( unsigned int dimension, unsigned int order );
 
-  void GetSplineOrder( unsigned int dimension )
+  unsigned int GetSplineOrder( unsigned int dimension ) const
   {
     return m_SplineOrder[ dimension ];
   }
@@ -153,44 +162,59 @@ protected:
   void EnlargeOutputRequestedRegion( DataObject * output );
 
   /** These are needed by the smoothing spline routine. */
-  std::vector< CoeffType > m_Scratch;             // temp storage for processing of Coefficients
   typename TInputImage::SizeType m_DataLength;    // Image size
 
   unsigned int m_SplineOrder[ ImageDimension ];            // User specified spline order per dimension (3rd or cubic is the default)
   double       m_SplinePoles[ 3 ];                         // Poles calculated for a given spline order
   int          m_NumberOfPoles;                            // number of poles
   double       m_Tolerance;                                // Tolerance used for determining initial causal coefficient
-  unsigned int m_IteratorDirection;                        // Direction for iterator incrementing
 
 private:
 
   MultiOrderBSplineDecompositionImageFilter( const Self & ); //purposely not implemented
   void operator=( const Self & );                            //purposely not implemented
 
+  /** The data shared by the threads that filter the lines of one dimension. */
+  struct MultiThreaderParameterType
+  {
+    Self *       st_Self;
+    unsigned int st_Direction;
+    unsigned int st_SplitDimension;
+  };
+
   /** Determines the poles for dimension given the Spline Order. */
   virtual void SetPoles( unsigned int dimension );
 
   /** Converts a vector of data to a vector of Spline coefficients. */
-  virtual bool DataToCoefficients1D();
+  bool DataToCoefficients1D( CoeffType * scratch, const unsigned long length ) const;
 
   /** Converts an N-dimension image of data to an equivalent sized image
    *    of spline coefficients. */
   void DataToCoefficientsND();
 
+  /** Filters all lines in the given direction that start in the given
+   * region. Called by each thread for its own part of the image.
+   */
+  void ThreadedDataToCoefficients( const OutputImageRegionType & region,
+    const unsigned int direction );
+
+  /** Callback for DataToCoefficientsND(). */
+  static ITK_THREAD_RETURN_TYPE DataToCoefficientsThreaderCallback( void * arg );
+
   /** Determines the first coefficient for the causal filtering of the data. */
-  virtual void SetInitialCausalCoefficient( double z );
+  void SetInitialCausalCoefficient( double z, CoeffType * scratch, const unsigned long length ) const;
 
   /** Determines the first coefficient for the anti-causal filtering of the data. */
-  virtual void SetInitialAntiCausalCoefficient( double z );
+  void SetInitialAntiCausalCoefficient( double z, CoeffType * scratch, const unsigned long length ) const;
 
-  /** Used to initialize the Coefficients image before calculation. */
-  void CopyImageToImage();
+  /** Copies a line of the input image to the scratch vector. */
+  void CopyImageToScratch( InputLinearIterator &, CoeffType * scratch ) const;
 
-  /** Copies a vector of data from the Coefficients image to the m_Scratch vector. */
-  void CopyCoefficientsToScratch( OutputLinearIterator & );
+  /** Copies a vector of data from the Coefficients image to the scratch vector. */
+  void CopyCoefficientsToScratch( OutputLinearIterator &, CoeffType * scratch ) const;
 
-  /** Copies a vector of data from m_Scratch to the Coefficients image. */
-  void CopyScratchToCoefficients( OutputLinearIterator & );
+  /** Copies a vector of data from the scratch vector to the Coefficients image. */
+  void CopyScratchToCoefficients( OutputLinearIterator &, const CoeffType * scratch ) const;
 
 };
 
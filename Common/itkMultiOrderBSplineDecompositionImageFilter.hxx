@@ -38,10 +38,8 @@
 #define __itkMultiOrderBSplineDecompositionImageFilter_hxx
 
 #include "itkMultiOrderBSplineDecompositionImageFilter.h"
-#include "itkImageRegionConstIteratorWithIndex.h"
-#include "itkImageRegionIterator.h"
-#include "itkProgressReporter.h"
 #include "itkVector.h"
+#include <algorithm>
 
 namespace itk
 {
@@ -54,8 +52,11 @@ MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
 ::MultiOrderBSplineDecompositionImageFilter()
 {
   int splineOrder = 3;
-  m_Tolerance         = 1e-10; // Need some guidance on this one...what is reasonable?
-  m_IteratorDirection = 0;
+  m_Tolerance = 1e-10; // Need some guidance on this one...what is reasonable?
+  for( unsigned int d = 0; d < ImageDimension; ++d )
+  {
+    m_SplineOrder[ d ] = 0;
+  }
   this->SetSplineOrder( splineOrder );
 }
 
@@ -87,7 +88,7 @@ MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
 template< class TInputImage, class TOutputImage >
 bool
 MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
-::DataToCoefficients1D()
+::DataToCoefficients1D( CoeffType * scratch, const unsigned long length ) const
 {
 
   // See Unser, 1993, Part II, Equation 2.5,
@@ -95,7 +96,7 @@ MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
 
   double c0 = 1.0;
 
-  if( m_DataLength[ m_IteratorDirection ] == 1 ) //Required by mirror boundaries
+  if( length == 1 ) //Required by mirror boundaries
   {
     return false;
   }
@@ -108,28 +109,28 @@ MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
   }
 
   // apply the gain
-  for( unsigned int n = 0; n < m_DataLength[ m_IteratorDirection ]; n++ )
+  for( unsigned long n = 0; n < length; n++ )
   {
-    m_Scratch[ n ] *= c0;
+    scratch[ n ] *= c0;
   }
 
   // loop over all poles
   for( int k = 0; k < m_NumberOfPoles; k++ )
   {
     // causal initialization
-    this->SetInitialCausalCoefficient( m_SplinePoles[ k ] );
+    this->SetInitialCausalCoefficient( m_SplinePoles[ k ], scratch, length );
     // causal recursion
-    for( unsigned int n = 1; n < m_DataLength[ m_IteratorDirection ]; n++ )
+    for( unsigned long n = 1; n < length; n++ )
     {
-      m_Scratch[ n ] += m_SplinePoles[ k ] * m_Scratch[ n - 1 ];
+      scratch[ n ] += m_SplinePoles[ k ] * scratch[ n - 1 ];
     }
 
     // anticausal initialization
-    this->SetInitialAntiCausalCoefficient( m_SplinePoles[ k ] );
+    this->SetInitialAntiCausalCoefficient( m_SplinePoles[ k ], scratch, length );
     // anticausal recursion
-    for( int n = m_DataLength[ m_IteratorDirection ] - 2; 0 <= n; n-- )
+    for( long n = static_cast< long >( length ) - 2; 0 <= n; n-- )
     {
-      m_Scratch[ n ] = m_SplinePoles[ k ] * ( m_Scratch[ n + 1 ] - m_Scratch[ n ] );
+      scratch[ n ] = m_SplinePoles[ k ] * ( scratch[ n + 1 ] - scratch[ n ] );
     }
   }
   return true;
@@ -225,7 +226,7 @@ MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
 template< class TInputImage, class TOutputImage >
 void
 MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
-::SetInitialCausalCoefficient( double z )
+::SetInitialCausalCoefficient( double z, CoeffType * scratch, const unsigned long length ) const
 {
   /* begining InitialCausalCoefficient */
   /* See Unser, 1999, Box 2 for explaination */
@@ -234,37 +235,37 @@ MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
   unsigned long horizon;
 
   /* this initialization corresponds to mirror boundaries */
-  horizon = m_DataLength[ m_IteratorDirection ];
+  horizon = length;
   zn      = z;
   if( m_Tolerance > 0.0 )
   {
     horizon = (long)vcl_ceil( vcl_log( m_Tolerance ) / vcl_log( vcl_fabs( z ) ) );
   }
-  if( horizon < m_DataLength[ m_IteratorDirection ] )
+  if( horizon < length )
   {
     /* accelerated loop */
-    sum = m_Scratch[ 0 ];   // verify this
-    for( unsigned int n = 1; n < horizon; n++ )
+    sum = scratch[ 0 ];   // verify this
+    for( unsigned long n = 1; n < horizon; n++ )
     {
-      sum += zn * m_Scratch[ n ];
+      sum += zn * scratch[ n ];
       zn  *= z;
     }
-    m_Scratch[ 0 ] = sum;
+    scratch[ 0 ] = sum;
   }
   else
   {
     /* full loop */
     iz   = 1.0 / z;
-    z2n  = vcl_pow( z, (double)( m_DataLength[ m_IteratorDirection ] - 1L ) );
-    sum  = m_Scratch[ 0 ] + z2n * m_Scratch[ m_DataLength[ m_IteratorDirection ] - 1L ];
+    z2n  = vcl_pow( z, (double)( length - 1L ) );
+    sum  = scratch[ 0 ] + z2n * scratch[ length - 1L ];
     z2n *= z2n * iz;
-    for( unsigned int n = 1; n <= ( m_DataLength[ m_IteratorDirection ] - 2 ); n++ )
+    for( unsigned long n = 1; n <= ( length - 2 ); n++ )
     {
-      sum += ( zn + z2n ) * m_Scratch[ n ];
+      sum += ( zn + z2n ) * scratch[ n ];
       zn  *= z;
       z2n *= iz;
     }
-    m_Scratch[ 0 ] = sum / ( 1.0 - zn * zn );
+    scratch[ 0 ] = sum / ( 1.0 - zn * zn );
   }
 }
 
@@ -272,14 +273,14 @@ MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
 template< class TInputImage, class TOutputImage >
 void
 MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
-::SetInitialAntiCausalCoefficient( double z )
+::SetInitialAntiCausalCoefficient( double z, CoeffType * scratch, const unsigned long length ) const
 {
   // this initialization corresponds to mirror boundaries
   /* See Unser, 1999, Box 2 for explaination */
   //  Also see erratum at http://bigwww.epfl.ch/publications/unser9902.html
-  m_Scratch[ m_DataLength[ m_IteratorDirection ] - 1 ]
+  scratch[ length - 1 ]
     = ( z / ( z * z - 1.0 ) )
-    * ( z * m_Scratch[ m_DataLength[ m_IteratorDirection ] - 2 ] + m_Scratch[ m_DataLength[ m_IteratorDirection ] - 1 ] );
+    * ( z * scratch[ length - 2 ] + scratch[ length - 1 ] );
 }
 
 
@@ -292,66 +293,141 @@ MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
 
   Size< ImageDimension > size = output->GetBufferedRegion().GetSize();
 
-  unsigned int count = output->GetBufferedRegion().GetNumberOfPixels() / size[ 0 ] * ImageDimension;
-
-  ProgressReporter progress( this, 0, count, 10 );
+  MultiThreaderParameterType userData;
+  userData.st_Self = this;
 
-  // Initialize coeffient array
-  this->CopyImageToImage();   // Coefficients are initialized to the input data
+  /** A 1-D image consists of a single line, which can not be split. */
+  MultiThreader::Pointer threader = MultiThreader::New();
+  threader->SetNumberOfThreads( ImageDimension > 1 ? this->GetNumberOfThreads() : 1 );
+  threader->SetSingleMethod( DataToCoefficientsThreaderCallback, &userData );
 
   for( unsigned int n = 0; n < ImageDimension; n++ )
   {
-    m_IteratorDirection = n;
     // Loop through each dimension
 
     // Compute poles for this dimension
     this->SetPoles( n );
 
-    // Initialize iterators
-    OutputLinearIterator CIterator( output, output->GetBufferedRegion() );
-    CIterator.SetDirection( m_IteratorDirection );
-    // For each data vector
-    while( !CIterator.IsAtEnd() )
+    // The lines in direction n are distributed over the threads by splitting
+    // the image along the largest other dimension.
+    unsigned int splitDimension = ( n == 0 && ImageDimension > 1 ) ? 1 : 0;
+    for( unsigned int d = 0; d < ImageDimension; d++ )
     {
-      // Copy coefficients to scratch
-      this->CopyCoefficientsToScratch( CIterator );
+      if( d != n && size[ d ] > size[ splitDimension ] )
+      {
+        splitDimension = d;
+      }
+    }
 
-      // Perform 1D BSpline calculations
-      this->DataToCoefficients1D();
+    userData.st_Direction      = n;
+    userData.st_SplitDimension = splitDimension;
+    threader->SingleMethodExecute();
 
-      // Copy scratch back to coefficients.
-      // Brings us back to the end of the line we were working on.
-      CIterator.GoToBeginOfLine();
-      this->CopyScratchToCoefficients( CIterator ); // m_Scratch = m_Image;
-      CIterator.NextLine();
-      progress.CompletedPixel();
-    }
+    this->UpdateProgress( static_cast< float >( n + 1 ) / static_cast< float >( ImageDimension ) );
   }
 }
 
 
 /**
- * Copy the input image into the output image
+ * Multi-threaded callback of DataToCoefficientsND
+ */
+template< class TInputImage, class TOutputImage >
+ITK_THREAD_RETURN_TYPE
+MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
+::DataToCoefficientsThreaderCallback( void * arg )
+{
+  typedef MultiThreader::ThreadInfoStruct ThreadInfoType;
+  ThreadInfoType *   infoStruct  = static_cast< ThreadInfoType * >( arg );
+  const ThreadIdType threadId    = infoStruct->ThreadID;
+  const ThreadIdType nrOfThreads = infoStruct->NumberOfThreads;
+
+  MultiThreaderParameterType * temp
+    = static_cast< MultiThreaderParameterType * >( infoStruct->UserData );
+
+  /** Each thread filters the lines in a contiguous slab of the image. */
+  OutputImageRegionType region     = temp->st_Self->GetOutput()->GetBufferedRegion();
+  const unsigned int    split      = temp->st_SplitDimension;
+  const unsigned long   splitSize  = region.GetSize( split );
+  const unsigned long   chunkSize  = ( splitSize + nrOfThreads - 1 ) / nrOfThreads;
+  const unsigned long   begin      = std::min( threadId * chunkSize, splitSize );
+  const unsigned long   end        = std::min( begin + chunkSize, splitSize );
+  if( begin == end )
+  {
+    return ITK_THREAD_RETURN_VALUE;
+  }
+
+  region.SetIndex( split, region.GetIndex( split ) + static_cast< IndexValueType >( begin ) );
+  region.SetSize( split, end - begin );
+
+  temp->st_Self->ThreadedDataToCoefficients( region, temp->st_Direction );
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+/**
+ * Filter all lines in one direction in a part of the image
  */
 template< class TInputImage, class TOutputImage >
 void
 MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
-::CopyImageToImage()
+::ThreadedDataToCoefficients( const OutputImageRegionType & region,
+  const unsigned int direction )
 {
-  typedef ImageRegionConstIteratorWithIndex< TInputImage > InputIterator;
-  typedef ImageRegionIterator< TOutputImage >              OutputIterator;
-  typedef typename TOutputImage::PixelType                 OutputPixelType;
+  const unsigned long length = m_DataLength[ direction ];
+  std::vector< CoeffType > scratch( length );
 
-  InputIterator  inIt( this->GetInput(), this->GetInput()->GetBufferedRegion() );
-  OutputIterator outIt( this->GetOutput(), this->GetOutput()->GetBufferedRegion() );
+  OutputLinearIterator CIterator( this->GetOutput(), region );
+  CIterator.SetDirection( direction );
 
-  inIt.GoToBegin();
-  outIt.GoToBegin();
-  while( !outIt.IsAtEnd() )
+  // The first direction is read from the input, the others are filtered in place
+  if( direction == 0 )
   {
-    outIt.Set( static_cast< OutputPixelType >( inIt.Get() ) );
-    ++inIt;
-    ++outIt;
+    InputLinearIterator IIterator( this->GetInput(), region );
+    IIterator.SetDirection( direction );
+    while( !CIterator.IsAtEnd() )
+    {
+      this->CopyImageToScratch( IIterator, &scratch[ 0 ] );
+      this->DataToCoefficients1D( &scratch[ 0 ], length );
+      this->CopyScratchToCoefficients( CIterator, &scratch[ 0 ] );
+      IIterator.NextLine();
+      CIterator.NextLine();
+    }
+    return;
+  }
+
+  // For each data vector
+  while( !CIterator.IsAtEnd() )
+  {
+    // Copy coefficients to scratch
+    this->CopyCoefficientsToScratch( CIterator, &scratch[ 0 ] );
+
+    // Perform 1D BSpline calculations
+    this->DataToCoefficients1D( &scratch[ 0 ], length );
+
+    // Copy scratch back to coefficients.
+    // Brings us back to the end of the line we were working on.
+    CIterator.GoToBeginOfLine();
+    this->CopyScratchToCoefficients( CIterator, &scratch[ 0 ] );
+    CIterator.NextLine();
+  }
+}
+
+
+/**
+ * Copy one line of the input image to the scratch
+ */
+template< class TInputImage, class TOutputImage >
+void
+MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
+::CopyImageToScratch( InputLinearIterator & Iter, CoeffType * scratch ) const
+{
+  unsigned long j = 0;
+  while( !Iter.IsAtEndOfLine() )
+  {
+    scratch[ j ] = static_cast< CoeffType >( Iter.Get() );
+    ++Iter;
+    ++j;
   }
 }
 
@@ -362,13 +438,13 @@ MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
 template< class TInputImage, class TOutputImage >
 void
 MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
-::CopyScratchToCoefficients( OutputLinearIterator & Iter )
+::CopyScratchToCoefficients( OutputLinearIterator & Iter, const CoeffType * scratch ) const
 {
   typedef typename TOutputImage::PixelType OutputPixelType;
   unsigned long j = 0;
   while( !Iter.IsAtEndOfLine() )
   {
-    Iter.Set( static_cast< OutputPixelType >( m_Scratch[ j ] ) );
+    Iter.Set( static_cast< OutputPixelType >( scratch[ j ] ) );
     ++Iter;
     ++j;
   }
@@ -382,12 +458,12 @@ MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
 template< class TInputImage, class TOutputImage >
 void
 MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
-::CopyCoefficientsToScratch( OutputLinearIterator & Iter )
+::CopyCoefficientsToScratch( OutputLinearIterator & Iter, CoeffType * scratch ) const
 {
   unsigned long j = 0;
   while( !Iter.IsAtEndOfLine() )
   {
-    m_Scratch[ j ] = static_cast< CoeffType >( Iter.Get() );
+    scratch[ j ] = static_cast< CoeffType >( Iter.Get() );
     ++Iter;
     ++j;
   }
@@ -443,20 +519,10 @@ MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
 ::GenerateData()
 {
 
-  // Allocate scratch memory
+  // The line lengths; the scratch memory is allocated per thread
   InputImageConstPointer inputPtr = this->GetInput();
   m_DataLength = inputPtr->GetBufferedRegion().GetSize();
 
-  unsigned long maxLength = 0;
-  for( unsigned int n = 0; n < ImageDimension; n++ )
-  {
-    if( m_DataLength[ n ] > maxLength )
-    {
-      maxLength = m_DataLength[ n ];
-    }
-  }
-  m_Scratch.resize( maxLength );
-
   // Allocate memory for output image
   OutputImagePointer outputPtr = this->GetOutput();
   outputPtr->SetBufferedRegion( outputPtr->GetRequestedRegion() );
@@ -465,9 +531,6 @@ MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
   // Calculate actual output
   this->DataToCoefficientsND();
 
-  // Clean up
-  m_Scratch.clear();
-
 }
 
 
@@ -0,0 +1,110 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkMultiThreadedBSplineInterpolateImageFunction_h
+#define __itkMultiThreadedBSplineInterpolateImageFunction_h
+
+#include "itkBSplineInterpolateImageFunction.h"
+#include "itkMultiOrderBSplineDecompositionImageFilter.h"
+
+namespace itk
+{
+/** \class MultiThreadedBSplineInterpolateImageFunction
+ * \brief B-spline interpolation of an image, with a multi-threaded computation
+ * of the B-spline coefficients.
+ *
+ * This class is a drop-in replacement of the BSplineInterpolateImageFunction.
+ * The interpolation itself is identical, but the B-spline coefficients are
+ * computed in SetInputImage() by the MultiOrderBSplineDecompositionImageFilter,
+ * which distributes the 1-D lines of each dimension over the threads. The
+ * BSplineDecompositionImageFilter used by the superclass is single-threaded,
+ * which makes the prefiltering of large images a bottleneck.
+ *
+ * The coefficients are identical to those of the superclass, up to rounding.
+ *
+ * \sa BSplineInterpolateImageFunction, MultiOrderBSplineDecompositionImageFilter
+ *
+ * \ingroup ImageFunctions ImageInterpolators
+ */
+
+template< class TImageType, class TCoordRep = double, class TCoefficientType = double >
+class MultiThreadedBSplineInterpolateImageFunction :
+  public BSplineInterpolateImageFunction< TImageType, TCoordRep, TCoefficientType >
+{
+public:
+
+  /** Standard class typedefs. */
+  typedef MultiThreadedBSplineInterpolateImageFunction Self;
+  typedef BSplineInterpolateImageFunction<
+    TImageType, TCoordRep, TCoefficientType >          Superclass;
+  typedef SmartPointer< Self >                         Pointer;
+  typedef SmartPointer< const Self >                   ConstPointer;
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( MultiThreadedBSplineInterpolateImageFunction, BSplineInterpolateImageFunction );
+
+  /** New macro for creation of through a Smart Pointer. */
+  itkNewMacro( Self );
+
+  /** Typedefs inherited from the superclass. */
+  typedef typename Superclass::InputImageType       InputImageType;
+  typedef typename Superclass::CoefficientImageType CoefficientImageType;
+
+  /** The multi-threaded filter that computes the B-spline coefficients. */
+  typedef MultiOrderBSplineDecompositionImageFilter<
+    TImageType, CoefficientImageType >              DecompositionFilterType;
+
+  /** Set the input image, and compute its B-spline coefficients. This
+   * method should be called after SetSplineOrder().
+   *
+   * This override depends on the internals of the ITK 4 version of
+   * BSplineInterpolateImageFunction::SetInputImage(), and should be
+   * checked when ITK is upgraded:
+   * \li it calls ImageFunction::SetInputImage() directly, through
+   *   Superclass::Superclass, to skip the serial prefiltering. Any other
+   *   state that the superclass sets in SetInputImage() is therefore not set;
+   *   in ITK 4 that state consists of m_Coefficients and m_DataLength only;
+   * \li it writes m_Coefficients and m_DataLength, which are protected
+   *   members of the superclass;
+   * \li the private coefficient filter of the superclass is not used. It
+   *   keeps a reference to the input of an earlier call of the superclass
+   *   implementation, if any, so that image is not released.
+   *
+   * The MultiThreadedBSplineInterpolateImageFunctionTest compares this class
+   * with the ITK implementation.
+   */
+  virtual void SetInputImage( const TImageType * inputData );
+
+protected:
+
+  MultiThreadedBSplineInterpolateImageFunction() {}
+  virtual ~MultiThreadedBSplineInterpolateImageFunction() {}
+
+private:
+
+  MultiThreadedBSplineInterpolateImageFunction( const Self & ); // purposely not implemented
+  void operator=( const Self & );                               // purposely not implemented
+
+};
+
+} // namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkMultiThreadedBSplineInterpolateImageFunction.hxx"
+#endif
+
+#endif // end #ifndef __itkMultiThreadedBSplineInterpolateImageFunction_h
@@ -0,0 +1,63 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkMultiThreadedBSplineInterpolateImageFunction_hxx
+#define __itkMultiThreadedBSplineInterpolateImageFunction_hxx
+
+#include "itkMultiThreadedBSplineInterpolateImageFunction.h"
+
+namespace itk
+{
+
+/**
+ * ******************* SetInputImage ***********************
+ */
+
+template< class TImageType, class TCoordRep, class TCoefficientType >
+void
+MultiThreadedBSplineInterpolateImageFunction< TImageType, TCoordRep, TCoefficientType >
+::SetInputImage( const TImageType * inputData )
+{
+  if( !inputData )
+  {
+    this->m_Coefficients = 0;
+    this->Superclass::Superclass::SetInputImage( inputData );
+    return;
+  }
+
+  /** Compute the coefficients, multi-threaded. The filter is not kept,
+   * so only the coefficient image stays in memory.
+   */
+  typename DecompositionFilterType::Pointer decompositionFilter = DecompositionFilterType::New();
+  decompositionFilter->SetSplineOrder( this->GetSplineOrder() );
+  decompositionFilter->SetInput( inputData );
+  decompositionFilter->Update();
+  this->m_Coefficients = decompositionFilter->GetOutput();
+
+  /** Skip the superclass implementation, which would compute
+   * the coefficients again, single-threaded. This sets the same state as
+   * the ITK 4 implementation does; see the documentation in the header.
+   */
+  this->Superclass::Superclass::SetInputImage( inputData );
+  this->m_DataLength = inputData->GetBufferedRegion().GetSize();
+
+} // end SetInputImage()
+
+
+} // end namespace itk
+
+#endif // end #ifndef __itkMultiThreadedBSplineInterpolateImageFunction_hxx
@@ -0,0 +1,564 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkPersistentThreadPool_cxx
+#define __itkPersistentThreadPool_cxx
+
+#include "itkPersistentThreadPool.h"
+#include "itkConditionVariable.h"
+#include "itkMutexLock.h"
+#include "itkSimpleFastMutexLock.h"
+
+#include <exception>
+#include <string>
+
+#if defined( _WIN32 )
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#ifdef ELASTIX_USE_OPENMP
+#include <omp.h>
+#endif
+
+namespace itk
+{
+
+namespace
+{
+
+typedef PersistentThreadPool::ThreadInfoType ThreadInfoType;
+
+/** The registered thread-local pointers, see RegisterThreadContext(). */
+const unsigned int MaximumNumberOfThreadContexts = PersistentThreadPool::MaximumNumberOfThreadContexts;
+
+struct ThreadContextRegistry
+{
+  PersistentThreadPool::GetThreadContextFunctionType m_Get[ MaximumNumberOfThreadContexts ];
+  PersistentThreadPool::SetThreadContextFunctionType m_Set[ MaximumNumberOfThreadContexts ];
+  unsigned int                                       m_Size;
+};
+
+SimpleFastMutexLock   threadContextMutex;
+ThreadContextRegistry threadContexts = { { 0 }, { 0 }, 0 };
+
+/** The calls of one SingleMethodExecute(). The job lives on the stack of
+ * the calling thread; the counter and the error are guarded by the mutex
+ * of the pool.
+ */
+struct ThreadPoolJob
+{
+  ThreadFunctionType    m_Callback;
+  ThreadInfoType        m_ThreadInfo[ ITK_MAX_THREADS ];
+  ThreadIdType          m_NumberOfUnfinishedTasks;
+  bool                  m_Failed;
+  std::string           m_ErrorDescription;
+  ThreadContextRegistry m_Contexts;
+  void *                m_ContextValues[ MaximumNumberOfThreadContexts ];
+};
+
+/** A task is one call of a job. */
+struct ThreadPoolTask
+{
+  ThreadPoolJob * m_Job;
+  ThreadIdType    m_ThreadId;
+};
+
+/** A fixed-size double-ended queue of tasks. The owner takes tasks from the
+ * back, thieves take them from the front. Being fixed-size, the queue never
+ * allocates memory.
+ */
+class ThreadPoolQueue
+{
+public:
+
+  ThreadPoolQueue() : m_Begin( 0 ), m_Size( 0 ) {}
+
+  bool Push( const ThreadPoolTask & task )
+  {
+    this->m_Mutex.Lock();
+    const bool full = this->m_Size == Capacity;
+    if( !full )
+    {
+      this->m_Tasks[ ( this->m_Begin + this->m_Size ) % Capacity ] = task;
+      ++this->m_Size;
+    }
+    this->m_Mutex.Unlock();
+    return !full;
+  }
+
+
+  bool PopBack( ThreadPoolTask & task )
+  {
+    this->m_Mutex.Lock();
+    const bool empty = this->m_Size == 0;
+    if( !empty )
+    {
+      --this->m_Size;
+      task = this->m_Tasks[ ( this->m_Begin + this->m_Size ) % Capacity ];
+    }
+    this->m_Mutex.Unlock();
+    return !empty;
+  }
+
+
+  bool PopFront( ThreadPoolTask & task )
+  {
+    this->m_Mutex.Lock();
+    const bool empty = this->m_Size == 0;
+    if( !empty )
+    {
+      task           = this->m_Tasks[ this->m_Begin ];
+      this->m_Begin  = ( this->m_Begin + 1 ) % Capacity;
+      --this->m_Size;
+    }
+    this->m_Mutex.Unlock();
+    return !empty;
+  }
+
+
+private:
+
+  enum { Capacity = 4 * ITK_MAX_THREADS };
+
+  ThreadPoolTask      m_Tasks[ Capacity ];
+  unsigned int        m_Begin;
+  unsigned int        m_Size;
+  SimpleFastMutexLock m_Mutex;
+};
+
+class ThreadPoolImplementation;
+
+/** What a worker thread needs to know about itself. */
+struct ThreadPoolWorker
+{
+  ThreadPoolImplementation * m_Pool;
+  ThreadIdType               m_WorkerId;
+  ThreadPoolQueue            m_Queue;
+};
+
+#if defined( _WIN32 )
+DWORD WINAPI ThreadPoolWorkerEntry( LPVOID arg );
+#else
+void * ThreadPoolWorkerEntry( void * arg );
+#endif
+
+/** The pool itself. It is created at the first use and never destroyed:
+ * the workers may still be waiting on its condition variable when the
+ * static objects are destroyed at process exit.
+ */
+class ThreadPoolImplementation
+{
+public:
+
+  ThreadPoolImplementation() : m_NumberOfQueuedTasks( 0 ), m_NextQueue( 0 )
+  {
+    this->m_WorkAvailable = ConditionVariable::New();
+    this->m_TaskFinished  = ConditionVariable::New();
+
+    /** Size the pool from the hardware, not from the global default number
+     * of threads, which may be limited temporarily, e.g. while the jobs of a
+     * concurrent batch run. How many threads a job uses is determined by its
+     * own numberOfThreads argument.
+     */
+    ThreadIdType numberOfThreads = MultiThreader::GetGlobalDefaultNumberOfThreadsByPlatform();
+    numberOfThreads = numberOfThreads < ITK_MAX_THREADS ? numberOfThreads : ITK_MAX_THREADS;
+    this->m_NumberOfWorkers = numberOfThreads > 1 ? numberOfThreads - 1 : 0;
+    this->m_Workers         = new ThreadPoolWorker[ this->m_NumberOfWorkers + 1 ];
+    for( ThreadIdType i = 0; i < this->m_NumberOfWorkers; ++i )
+    {
+      this->m_Workers[ i ].m_Pool     = this;
+      this->m_Workers[ i ].m_WorkerId = i;
+#if defined( _WIN32 )
+      HANDLE handle = CreateThread( NULL, 0, ThreadPoolWorkerEntry, &this->m_Workers[ i ], 0, NULL );
+      CloseHandle( handle );
+#else
+      pthread_t thread;
+      pthread_create( &thread, NULL, ThreadPoolWorkerEntry, &this->m_Workers[ i ] );
+      pthread_detach( thread );
+#endif
+    }
+  }
+
+
+  ThreadIdType GetNumberOfWorkers( void ) const { return this->m_NumberOfWorkers; }
+
+  /** Execute all calls of a job, see PersistentThreadPool::SingleMethodExecute(). */
+  void Execute( ThreadFunctionType callback, void * data, const ThreadIdType numberOfThreads )
+  {
+    ThreadPoolJob job;
+    job.m_Callback                = callback;
+    job.m_NumberOfUnfinishedTasks = numberOfThreads - 1;
+    job.m_Failed                  = false;
+    /** Take over the thread-local context of the calling thread. */
+    threadContextMutex.Lock();
+    job.m_Contexts = threadContexts;
+    threadContextMutex.Unlock();
+    for( unsigned int c = 0; c < job.m_Contexts.m_Size; ++c )
+    {
+      job.m_ContextValues[ c ] = job.m_Contexts.m_Get[ c ]();
+    }
+
+    for( ThreadIdType i = 0; i < numberOfThreads; ++i )
+    {
+      job.m_ThreadInfo[ i ].ThreadID        = i;
+      job.m_ThreadInfo[ i ].NumberOfThreads = numberOfThreads;
+      job.m_ThreadInfo[ i ].UserData        = data;
+      job.m_ThreadInfo[ i ].ActiveFlag      = NULL;
+    }
+
+    /** Distribute the calls 1 .. n-1 over the queues of the workers. When no
+     * worker is available, or all queues are full, the calling thread
+     * executes them below.
+     */
+    ThreadIdType numberOfQueuedTasks = 0;
+    ThreadIdType firstLocalTask      = numberOfThreads;
+    if( this->m_NumberOfWorkers > 0 )
+    {
+      /** Count the tasks before they are queued, since a worker may take and
+       * uncount a task as soon as it is pushed.
+       */
+      this->m_Mutex.Lock();
+      ThreadIdType queue = this->m_NextQueue;
+      this->m_NextQueue = ( this->m_NextQueue + numberOfThreads - 1 ) % this->m_NumberOfWorkers;
+      this->m_NumberOfQueuedTasks += numberOfThreads - 1;
+      this->m_Mutex.Unlock();
+
+      for( ThreadIdType i = 1; i < numberOfThreads; ++i )
+      {
+        ThreadPoolTask task;
+        task.m_Job      = &job;
+        task.m_ThreadId = i;
+        unsigned int attempt = 0;
+        while( attempt < this->m_NumberOfWorkers
+               && !this->m_Workers[ ( queue + attempt ) % this->m_NumberOfWorkers ].m_Queue.Push( task ) )
+        {
+          ++attempt;
+        }
+        if( attempt == this->m_NumberOfWorkers )
+        {
+          firstLocalTask = i;
+          break;
+        }
+        queue = ( queue + 1 ) % this->m_NumberOfWorkers;
+        ++numberOfQueuedTasks;
+      }
+
+      /** Uncount the tasks that could not be queued, and wake up as many
+       * workers as there are queued tasks.
+       */
+      this->m_Mutex.Lock();
+      this->m_NumberOfQueuedTasks -= ( numberOfThreads - 1 ) - numberOfQueuedTasks;
+      for( ThreadIdType i = 0; i < numberOfQueuedTasks; ++i )
+      {
+        this->m_WorkAvailable->Signal();
+      }
+      this->m_Mutex.Unlock();
+    }
+    else
+    {
+      firstLocalTask = 1;
+    }
+
+    /** Execute thread id 0, and the calls that could not be queued. */
+    ThreadPoolTask task;
+    task.m_Job      = &job;
+    task.m_ThreadId = 0;
+    this->RunTask( task, false );
+    for( ThreadIdType i = firstLocalTask; i < numberOfThreads; ++i )
+    {
+      task.m_ThreadId = i;
+      this->RunTask( task, true );
+    }
+
+    /** Help executing queued tasks until the job has finished. When no task
+     * is queued anymore, all calls of this job are executing, and we wait.
+     */
+    for(;; )
+    {
+      this->m_Mutex.Lock();
+      const bool finished = job.m_NumberOfUnfinishedTasks == 0;
+      this->m_Mutex.Unlock();
+      if( finished ) { break; }
+
+      if( this->StealTask( this->m_NumberOfWorkers, task ) )
+      {
+        this->RunTask( task, true );
+        continue;
+      }
+
+      this->m_Mutex.Lock();
+      while( job.m_NumberOfUnfinishedTasks > 0 )
+      {
+        this->m_TaskFinished->Wait( &this->m_Mutex );
+      }
+      this->m_Mutex.Unlock();
+    }
+
+    if( job.m_Failed )
+    {
+      itkGenericExceptionMacro( << "A thread of the persistent thread pool failed:\n"
+                                << job.m_ErrorDescription );
+    }
+
+  }
+
+
+  /** The loop of the worker threads. */
+  void WorkerLoop( const ThreadIdType workerId )
+  {
+#ifdef ELASTIX_USE_OPENMP
+    omp_set_num_threads( 1 );
+#endif
+    ThreadPoolTask task;
+    for(;; )
+    {
+      if( this->m_Workers[ workerId ].m_Queue.PopBack( task ) )
+      {
+        this->DecreaseNumberOfQueuedTasks();
+        this->RunTask( task, true );
+        continue;
+      }
+      if( this->StealTask( workerId, task ) )
+      {
+        this->RunTask( task, true );
+        continue;
+      }
+
+      /** Sleep until new tasks are queued. */
+      this->m_Mutex.Lock();
+      while( this->m_NumberOfQueuedTasks == 0 )
+      {
+        this->m_WorkAvailable->Wait( &this->m_Mutex );
+      }
+      this->m_Mutex.Unlock();
+    }
+  }
+
+
+private:
+
+  /** Take a task from the front of the queue of another worker. */
+  bool StealTask( const ThreadIdType thiefId, ThreadPoolTask & task )
+  {
+    for( ThreadIdType i = 1; i <= this->m_NumberOfWorkers; ++i )
+    {
+      const ThreadIdType victim = ( thiefId + i ) % this->m_NumberOfWorkers;
+      if( victim != thiefId && this->m_Workers[ victim ].m_Queue.PopFront( task ) )
+      {
+        this->DecreaseNumberOfQueuedTasks();
+        return true;
+      }
+    }
+    return false;
+  }
+
+
+  void DecreaseNumberOfQueuedTasks( void )
+  {
+    this->m_Mutex.Lock();
+    --this->m_NumberOfQueuedTasks;
+    this->m_Mutex.Unlock();
+  }
+
+
+  /** Execute a task, store a possible error in its job, and report a queued
+   * task as finished.
+   */
+  void RunTask( const ThreadPoolTask & task, const bool countAsFinished )
+  {
+    ThreadPoolJob & job = *task.m_Job;
+    std::string     errorDescription;
+    bool            failed = false;
+
+    /** Execute the call in the context of the thread that started the job. */
+    void * ownContextValues[ MaximumNumberOfThreadContexts ];
+    for( unsigned int c = 0; c < job.m_Contexts.m_Size; ++c )
+    {
+      ownContextValues[ c ] = job.m_Contexts.m_Get[ c ]();
+      job.m_Contexts.m_Set[ c ]( job.m_ContextValues[ c ] );
+    }
+
+    try
+    {
+      job.m_Callback( &job.m_ThreadInfo[ task.m_ThreadId ] );
+    }
+    catch( ExceptionObject & excp )
+    {
+      failed           = true;
+      errorDescription = excp.GetDescription();
+    }
+    catch( std::exception & excp )
+    {
+      failed           = true;
+      errorDescription = excp.what();
+    }
+    catch( ... )
+    {
+      failed           = true;
+      errorDescription = "Unknown exception";
+    }
+
+    for( unsigned int c = 0; c < job.m_Contexts.m_Size; ++c )
+    {
+      job.m_Contexts.m_Set[ c ]( ownContextValues[ c ] );
+    }
+
+    if( !countAsFinished && !failed ) { return; }
+
+    this->m_Mutex.Lock();
+    if( failed && !job.m_Failed )
+    {
+      job.m_Failed           = true;
+      job.m_ErrorDescription = errorDescription;
+    }
+    if( countAsFinished && --job.m_NumberOfUnfinishedTasks == 0 )
+    {
+      this->m_TaskFinished->Broadcast();
+    }
+    this->m_Mutex.Unlock();
+  }
+
+
+  ThreadIdType       m_NumberOfWorkers;
+  ThreadPoolWorker * m_Workers;
+
+  /** Guards the counters of the pool and of the jobs. */
+  SimpleMutexLock            m_Mutex;
+  ConditionVariable::Pointer m_WorkAvailable;
+  ConditionVariable::Pointer m_TaskFinished;
+  ThreadIdType               m_NumberOfQueuedTasks;
+  ThreadIdType               m_NextQueue;
+};
+
+#if defined( _WIN32 )
+DWORD WINAPI
+ThreadPoolWorkerEntry( LPVOID arg )
+#else
+void *
+ThreadPoolWorkerEntry( void * arg )
+#endif
+{
+  ThreadPoolWorker * worker = static_cast< ThreadPoolWorker * >( arg );
+  worker->m_Pool->WorkerLoop( worker->m_WorkerId );
+  return 0;
+}
+
+
+SimpleFastMutexLock        threadPoolCreationMutex;
+ThreadPoolImplementation * threadPool = 0;
+
+ThreadPoolImplementation *
+GetThreadPool( void )
+{
+  threadPoolCreationMutex.Lock();
+  if( threadPool == 0 )
+  {
+    threadPool = new ThreadPoolImplementation;
+  }
+  threadPoolCreationMutex.Unlock();
+  return threadPool;
+}
+
+
+} // end namespace
+
+/**
+ * ******************* SingleMethodExecute *******************
+ */
+
+void
+PersistentThreadPool
+::SingleMethodExecute( ThreadFunctionType callback, void * data,
+  const ThreadIdType numberOfThreads )
+{
+  if( numberOfThreads > ITK_MAX_THREADS )
+  {
+    itkGenericExceptionMacro( << "The number of threads (" << numberOfThreads
+                              << ") exceeds ITK_MAX_THREADS (" << ITK_MAX_THREADS << ")." );
+  }
+
+  /** A single thread is executed directly, without locking. */
+  if( numberOfThreads <= 1 )
+  {
+    ThreadInfoType threadInfo;
+    threadInfo.ThreadID        = 0;
+    threadInfo.NumberOfThreads = 1;
+    threadInfo.UserData        = data;
+    threadInfo.ActiveFlag      = NULL;
+    callback( &threadInfo );
+    return;
+  }
+
+  GetThreadPool()->Execute( callback, data, numberOfThreads );
+
+} // end SingleMethodExecute()
+
+
+/**
+ * ******************* RegisterThreadContext *******************
+ */
+
+void
+PersistentThreadPool
+::RegisterThreadContext( GetThreadContextFunctionType getFunction,
+  SetThreadContextFunctionType setFunction )
+{
+  threadContextMutex.Lock();
+  for( unsigned int c = 0; c < threadContexts.m_Size; ++c )
+  {
+    if( threadContexts.m_Get[ c ] == getFunction && threadContexts.m_Set[ c ] == setFunction )
+    {
+      threadContextMutex.Unlock();
+      return;
+    }
+  }
+  const bool full = threadContexts.m_Size == MaximumNumberOfThreadContexts;
+  if( !full )
+  {
+    threadContexts.m_Get[ threadContexts.m_Size ] = getFunction;
+    threadContexts.m_Set[ threadContexts.m_Size ] = setFunction;
+    ++threadContexts.m_Size;
+  }
+  threadContextMutex.Unlock();
+
+  if( full )
+  {
+    itkGenericExceptionMacro( << "No more than " << MaximumNumberOfThreadContexts
+                              << " thread contexts can be registered." );
+  }
+
+} // end RegisterThreadContext()
+
+
+/**
+ * ******************* GetNumberOfWorkerThreads *******************
+ */
+
+ThreadIdType
+PersistentThreadPool
+::GetNumberOfWorkerThreads( void )
+{
+  return GetThreadPool()->GetNumberOfWorkers();
+
+} // end GetNumberOfWorkerThreads()
+
+
+} // end namespace itk
+
+#endif // end #ifndef __itkPersistentThreadPool_cxx
@@ -0,0 +1,112 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkPersistentThreadPool_h
+#define __itkPersistentThreadPool_h
+
+#include "itkMultiThreader.h"
+
+namespace itk
+{
+
+/**
+ * \class PersistentThreadPool
+ * \brief A process-wide pool of persistent worker threads, shared by the
+ * multi-threaded parts of the registration.
+ *
+ * SingleMethodExecute() has the semantics of MultiThreader::SingleMethodExecute():
+ * the callback is called once for every thread id, with a ThreadInfoStruct
+ * containing the thread id, the number of threads and the user data, and the
+ * function returns when all calls have finished. Instead of creating and
+ * joining new threads on every call, the calls are executed by worker threads
+ * that are created once, at the first use, and live until the process exits.
+ *
+ * Every worker has its own task queue. The calls of a job are distributed
+ * over these queues, and a worker that runs out of work steals tasks from the
+ * queues of the other workers. The calling thread executes thread id 0
+ * itself, and then helps executing the tasks that are still queued, until its
+ * job has finished. Since a thread never blocks while there is queued work,
+ * jobs that are started concurrently by several threads, or from within a
+ * callback, cannot deadlock. This is the reason why the itk::ThreadPool of
+ * the MultiThreader is not used: its threads block while waiting for work
+ * that only they could execute, which made elastix hang.
+ *
+ * The number of workers is the number of processors of the platform minus
+ * one, so that together with the calling thread the pool never occupies more
+ * cores than there are. It does not depend on the global default number of
+ * threads at the time of the first use, so that a temporary limit does not
+ * stick. A job runs on at most as many threads as it asks for. It may ask
+ * for more threads than there are; these calls are then executed one after
+ * the other by the available threads. The callbacks should therefore not
+ * wait for each other.
+ *
+ * Idle workers sleep on a condition variable instead of spinning, so that
+ * OpenMP regions that run between two jobs get all cores. Inside the workers
+ * the OpenMP number of threads is set to one, so that an OpenMP region that is
+ * entered from within a callback does not oversubscribe the machine.
+ *
+ * Some state is kept per thread, such as the xout and the random number
+ * generator of a registration that runs concurrently with others. Such a
+ * thread-local pointer can be registered with RegisterThreadContext(). A job
+ * then takes over the value of the thread that started it: a worker sets it
+ * while it executes a call of that job, and restores its own value afterwards.
+ *
+ * \ingroup Common
+ */
+
+class PersistentThreadPool
+{
+public:
+
+  typedef MultiThreader::ThreadInfoStruct ThreadInfoType;
+
+  /** Call callback( info ) for the thread ids 0 .. numberOfThreads - 1,
+   * and wait until all calls have finished. When a call throws an exception,
+   * the first one is rethrown as an ExceptionObject after all calls have
+   * finished.
+   */
+  static void SingleMethodExecute( ThreadFunctionType callback, void * data,
+    const ThreadIdType numberOfThreads );
+
+  /** Functions that get and set a thread-local pointer of the calling thread. */
+  typedef void * ( *GetThreadContextFunctionType )( void );
+  typedef void ( *SetThreadContextFunctionType )( void * );
+
+  /** Register a thread-local pointer that the calls of a job see with the
+   * value of the thread that started the job. Registering the same pair
+   * again has no effect. At most MaximumNumberOfThreadContexts pairs can be
+   * registered; an exception is thrown when there is no room left.
+   */
+  static void RegisterThreadContext( GetThreadContextFunctionType getFunction,
+    SetThreadContextFunctionType setFunction );
+
+  itkStaticConstMacro( MaximumNumberOfThreadContexts, unsigned int, 8 );
+
+  /** Get the number of worker threads. Creates the pool when needed. */
+  static ThreadIdType GetNumberOfWorkerThreads( void );
+
+private:
+
+  PersistentThreadPool();                           // purposely not implemented
+  PersistentThreadPool( const PersistentThreadPool & ); // purposely not implemented
+  void operator=( const PersistentThreadPool & );       // purposely not implemented
+
+};
+
+} // end namespace itk
+
+#endif // end #ifndef __itkPersistentThreadPool_h
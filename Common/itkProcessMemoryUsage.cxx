@@ -0,0 +1,137 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkProcessMemoryUsage_cxx
+#define __itkProcessMemoryUsage_cxx
+
+#include "itkProcessMemoryUsage.h"
+
+#if defined( _WIN32 )
+#include <windows.h>
+#include <psapi.h>
+#if defined( _MSC_VER )
+#pragma comment( lib, "psapi.lib" )
+#endif
+#else
+#include <sys/resource.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#endif
+
+#if defined( __APPLE__ )
+#include <mach/mach.h>
+#endif
+
+namespace itk
+{
+
+#if defined( __linux__ )
+namespace
+{
+
+/** Read a field, e.g. "VmRSS:", from /proc/self/status. The value is in kB. */
+SizeValueType
+ReadProcStatusField( const std::string & field )
+{
+  std::ifstream status( "/proc/self/status" );
+  std::string   line;
+  while( std::getline( status, line ) )
+  {
+    if( line.compare( 0, field.size(), field ) == 0 )
+    {
+      std::istringstream value( line.substr( field.size() ) );
+      SizeValueType      kiloBytes = 0;
+      value >> kiloBytes;
+      return kiloBytes;
+    }
+  }
+  return 0;
+}
+
+
+} // end namespace
+#endif
+
+/**
+ * ******************* GetCurrentMemoryUsage *******************
+ */
+
+SizeValueType
+ProcessMemoryUsage
+::GetCurrentMemoryUsage( void )
+{
+#if defined( _WIN32 )
+  PROCESS_MEMORY_COUNTERS counters;
+  if( GetProcessMemoryInfo( GetCurrentProcess(), &counters, sizeof( counters ) ) )
+  {
+    return static_cast< SizeValueType >( counters.WorkingSetSize / 1024 );
+  }
+  return 0;
+#elif defined( __linux__ )
+  return ReadProcStatusField( "VmRSS:" );
+#elif defined( __APPLE__ )
+  mach_task_basic_info_data_t info;
+  mach_msg_type_number_t      count = MACH_TASK_BASIC_INFO_COUNT;
+  if( task_info( mach_task_self(), MACH_TASK_BASIC_INFO,
+    reinterpret_cast< task_info_t >( &info ), &count ) == KERN_SUCCESS )
+  {
+    return static_cast< SizeValueType >( info.resident_size / 1024 );
+  }
+  return 0;
+#else
+  return 0;
+#endif
+
+} // end GetCurrentMemoryUsage()
+
+
+/**
+ * ******************* GetPeakMemoryUsage *******************
+ */
+
+SizeValueType
+ProcessMemoryUsage
+::GetPeakMemoryUsage( void )
+{
+#if defined( _WIN32 )
+  PROCESS_MEMORY_COUNTERS counters;
+  if( GetProcessMemoryInfo( GetCurrentProcess(), &counters, sizeof( counters ) ) )
+  {
+    return static_cast< SizeValueType >( counters.PeakWorkingSetSize / 1024 );
+  }
+  return 0;
+#else
+  struct rusage usage;
+  if( getrusage( RUSAGE_SELF, &usage ) != 0 )
+  {
+    return 0;
+  }
+#if defined( __APPLE__ )
+  /** On Mac OS X, ru_maxrss is in bytes. */
+  return static_cast< SizeValueType >( usage.ru_maxrss / 1024 );
+#else
+  return static_cast< SizeValueType >( usage.ru_maxrss );
+#endif
+#endif
+
+} // end GetPeakMemoryUsage()
+
+
+} // end namespace itk
+
+#endif // end #ifndef __itkProcessMemoryUsage_cxx
@@ -0,0 +1,58 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkProcessMemoryUsage_h
+#define __itkProcessMemoryUsage_h
+
+#include "itkIntTypes.h"
+
+namespace itk
+{
+
+/**
+ * \class ProcessMemoryUsage
+ * \brief Reports the current and the peak memory usage of the process.
+ *
+ * The memory usage is the resident set size (working set on Windows) of the
+ * whole process, in kilobytes. The peak is the largest resident set size
+ * since the start of the process. Both return 0 if the platform does not
+ * provide the information.
+ *
+ * \ingroup Common
+ */
+
+class ProcessMemoryUsage
+{
+public:
+
+  /** Get the current memory usage of the process, in kB. */
+  static SizeValueType GetCurrentMemoryUsage( void );
+
+  /** Get the peak memory usage of the process, in kB. */
+  static SizeValueType GetPeakMemoryUsage( void );
+
+private:
+
+  ProcessMemoryUsage();                               // purposely not implemented
+  ProcessMemoryUsage( const ProcessMemoryUsage & );   // purposely not implemented
+  void operator=( const ProcessMemoryUsage & );       // purposely not implemented
+
+};
+
+} // end namespace itk
+
+#endif // end #ifndef __itkProcessMemoryUsage_h
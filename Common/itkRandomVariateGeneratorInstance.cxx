@@ -0,0 +1,77 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkRandomVariateGeneratorInstance_cxx
+#define __itkRandomVariateGeneratorInstance_cxx
+
+#include "itkRandomVariateGeneratorInstance.h"
+#include "elxThreadLocal.h"
+
+namespace itk
+{
+
+namespace
+{
+ELASTIX_THREAD_LOCAL RandomVariateGeneratorInstance::GeneratorType * threadGenerator = 0;
+}
+
+/**
+ * ******************* Get *******************
+ */
+
+RandomVariateGeneratorInstance::GeneratorPointer
+RandomVariateGeneratorInstance
+::Get( void )
+{
+  if( threadGenerator != 0 )
+  {
+    return threadGenerator;
+  }
+  return GeneratorType::GetInstance();
+
+} // end Get()
+
+
+/**
+ * ******************* SetThreadInstance *******************
+ */
+
+void
+RandomVariateGeneratorInstance
+::SetThreadInstance( GeneratorType * generator )
+{
+  threadGenerator = generator;
+
+} // end SetThreadInstance()
+
+
+/**
+ * ******************* GetThreadInstance *******************
+ */
+
+RandomVariateGeneratorInstance::GeneratorType *
+RandomVariateGeneratorInstance
+::GetThreadInstance( void )
+{
+  return threadGenerator;
+
+} // end GetThreadInstance()
+
+
+} // end namespace itk
+
+#endif // end #ifndef __itkRandomVariateGeneratorInstance_cxx
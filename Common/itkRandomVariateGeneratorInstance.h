@@ -0,0 +1,71 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkRandomVariateGeneratorInstance_h
+#define __itkRandomVariateGeneratorInstance_h
+
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+
+namespace itk
+{
+
+/**
+ * \class RandomVariateGeneratorInstance
+ * \brief Gives access to the random number generator used by elastix.
+ *
+ * By default, Get() returns the global instance of the
+ * MersenneTwisterRandomVariateGenerator. A thread that runs a registration
+ * concurrently with registrations in other threads can set its own generator
+ * with SetThreadInstance(). The generator state is then not shared between
+ * the registrations, which keeps each of them reproducible for a given seed.
+ *
+ * \ingroup Common
+ */
+
+class RandomVariateGeneratorInstance
+{
+public:
+
+  typedef Statistics::MersenneTwisterRandomVariateGenerator GeneratorType;
+  typedef GeneratorType::Pointer                            GeneratorPointer;
+
+  /** Get the generator of the calling thread, which is the global
+   * instance, unless another one was set with SetThreadInstance().
+   */
+  static GeneratorPointer Get( void );
+
+  /** Set the generator that Get() returns in the calling thread. The caller
+   * keeps ownership. Pass 0 to use the global instance again.
+   */
+  static void SetThreadInstance( GeneratorType * generator );
+
+  /** Get the generator set with SetThreadInstance() for the calling
+   * thread, or 0 when it uses the global instance.
+   */
+  static GeneratorType * GetThreadInstance( void );
+
+private:
+
+  RandomVariateGeneratorInstance();                                         // purposely not implemented
+  RandomVariateGeneratorInstance( const RandomVariateGeneratorInstance & ); // purposely not implemented
+  void operator=( const RandomVariateGeneratorInstance & );                 // purposely not implemented
+
+};
+
+} // end namespace itk
+
+#endif // end #ifndef __itkRandomVariateGeneratorInstance_h
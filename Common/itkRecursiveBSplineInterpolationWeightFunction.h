@@ -142,6 +142,15 @@ public:
   void EvaluateSecondOrderDerivative( const ContinuousIndexType & index,
     WeightsType & weights, const IndexType & startIndex ) const;
 
+  /** Evaluate the weights and the derivative weights of a single dimension,
+   * at continuous index position cindex in that dimension. Both arrays should
+   * hold SplineOrder + 1 elements. This allows callers to reuse the weights of
+   * the dimensions in which the position does not change, for example along
+   * a scanline. Returns the start index of the support region in that dimension.
+   */
+  IndexValueType EvaluateWeightsAndDerivative1D( const double cindex,
+    double * weights, double * derivativeWeights ) const;
+
 protected:
 
   RecursiveBSplineInterpolationWeightFunction();
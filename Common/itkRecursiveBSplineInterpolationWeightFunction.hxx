@@ -151,6 +151,29 @@ RecursiveBSplineInterpolationWeightFunction< TCoordRep, VSpaceDimension, VSpline
 } // end EvaluateSecondOrderDerivative()
 
 
+/**
+ * ********************* EvaluateWeightsAndDerivative1D ****************************
+ */
+
+template< typename TCoordRep, unsigned int VSpaceDimension, unsigned int VSplineOrder >
+IndexValueType
+RecursiveBSplineInterpolationWeightFunction< TCoordRep, VSpaceDimension, VSplineOrder >
+::EvaluateWeightsAndDerivative1D(
+  const double cindex,
+  double * weights,
+  double * derivativeWeights ) const
+{
+  /** Same computation as Evaluate() and EvaluateDerivative() for one dimension. */
+  const IndexValueType startIndex = Math::Floor< IndexValueType >( cindex + 0.5 - SplineOrder / 2.0 );
+  const double         x          = cindex - static_cast< double >( startIndex );
+  this->m_Kernel->Evaluate( x, weights );
+  this->m_DerivativeKernel->Evaluate( x, derivativeWeights );
+
+  return startIndex;
+
+} // end EvaluateWeightsAndDerivative1D()
+
+
 } // end namespace itk
 
 #endif
@@ -107,6 +107,21 @@ ScaledSingleValuedNonLinearOptimizer
 } // end GetScaledValue()
 
 
+/**
+ * ********************* GetScaledValues *****************************
+ */
+
+void
+ScaledSingleValuedNonLinearOptimizer
+::GetScaledValues(
+  const ParametersContainerType & parameters,
+  MeasureContainerType & values ) const
+{
+  this->m_ScaledCostFunction->GetValues( parameters, values );
+
+} // end GetScaledValues()
+
+
 /**
  * ********************* GetScaledDerivative *****************************
  */
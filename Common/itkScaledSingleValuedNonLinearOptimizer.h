@@ -87,6 +87,9 @@ public:
   typedef ScaledSingleValuedCostFunction  ScaledCostFunctionType;
   typedef ScaledCostFunctionType::Pointer ScaledCostFunctionPointer;
 
+  typedef ScaledCostFunctionType::ParametersContainerType ParametersContainerType;
+  typedef ScaledCostFunctionType::MeasureContainerType    MeasureContainerType;
+
   /** Configure the scaled cost function. This function
    * sets the current scales in the ScaledCostFunction.
    * NB: it assumes that the scales entered by the user
@@ -162,6 +165,13 @@ protected:
   virtual MeasureType GetScaledValue(
     const ParametersType & parameters ) const;
 
+  /** Same procedure as in GetScaledValue, for several parameter vectors,
+   * which may be evaluated concurrently.
+   */
+  virtual void GetScaledValues(
+    const ParametersContainerType & parameters,
+    MeasureContainerType & values ) const;
+
   /** Divide the (scaled) parameters by the scales, call the GetDerivative routine
    * of the unscaled cost function and divide the resulting derivative by
    * the scales.
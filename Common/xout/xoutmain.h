@@ -41,6 +41,16 @@ xoutbase_type & get_xout( void );
 
 void set_xout( xoutbase_type * arg );
 
+/** Set an xout that is used instead of the one set by set_xout(),
+ * but only by the calling thread. This allows registrations that run
+ * concurrently in different threads to each log to their own outputs.
+ * Pass 0 to use the shared xout again.
+ */
+void set_thread_xout( xoutbase_type * arg );
+
+/** Get the xout set by set_thread_xout() for the calling thread, or 0. */
+xoutbase_type * get_thread_xout( void );
+
 bool xout_valid();
 
 } // end namespace xoutlibrary
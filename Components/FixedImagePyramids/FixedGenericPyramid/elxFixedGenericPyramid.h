@@ -58,7 +58,8 @@ namespace elastix
  *    If ImagePyramidSmoothingSchedule is specified, that schedule is used for both fixed and moving image pyramid.
  * \parameter ImagePyramidSmoothingSchedule: smoothing schedule for both pyramids
  * \parameter ComputePyramidImagesPerResolution: Flag to specify if all resolution levels are computed
- *    at once, or per resolution. Latter saves memory.\n
+ *    at once, or per resolution. Latter saves memory: each level is computed when its
+ *    resolution starts, and released when it ends.\n
  *    example: <tt>(ComputePyramidImagesPerResolution "true")</tt>\n
  *    Default false.
  * \parameter ImagePyramidUseShrinkImageFilter: Flag to specify if the ShrinkingImageFilter is used
@@ -19,7 +19,7 @@
 #define __elxBSplineInterpolator_h
 
 #include "elxIncludes.h" // include first to avoid MSVS warning
-#include "itkBSplineInterpolateImageFunction.h"
+#include "itkMultiThreadedBSplineInterpolateImageFunction.h"
 
 namespace elastix
 {
@@ -49,7 +49,7 @@ namespace elastix
 template< class TElastix >
 class BSplineInterpolator :
   public
-  itk::BSplineInterpolateImageFunction<
+  itk::MultiThreadedBSplineInterpolateImageFunction<
   typename InterpolatorBase< TElastix >::InputImageType,
   typename InterpolatorBase< TElastix >::CoordRepType,
   double >,        //CoefficientType
@@ -60,7 +60,7 @@ public:
 
   /** Standard ITK-stuff. */
   typedef BSplineInterpolator Self;
-  typedef itk::BSplineInterpolateImageFunction<
+  typedef itk::MultiThreadedBSplineInterpolateImageFunction<
     typename InterpolatorBase< TElastix >::InputImageType,
     typename InterpolatorBase< TElastix >::CoordRepType,
     double >                                  Superclass1;
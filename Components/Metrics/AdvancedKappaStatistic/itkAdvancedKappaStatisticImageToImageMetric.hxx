@@ -460,10 +460,11 @@ void
 AdvancedKappaStatisticImageToImageMetric< TFixedImage, TMovingImage >
 ::ThreadedGetValueAndDerivative( ThreadIdType threadId )
 {
-  /** Initialize array that stores dM(x)/dmu, and the sparse Jacobian + indices. */
-  const NumberOfParametersType nnzji = this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices();
-  NonZeroJacobianIndicesType   nzji  = NonZeroJacobianIndicesType( nnzji );
-  DerivativeType               imageJacobian( nzji.size() );
+  /** Get handles to the pre-allocated arrays that store dM(x)/dmu and the
+   * sparse Jacobian indices. They are sized in InitializeJacobianWorkBuffers().
+   */
+  NonZeroJacobianIndicesType & nzji          = this->m_JacobianWorkPerThreadVariables[ threadId ].st_NonZeroJacobianIndices;
+  DerivativeType &             imageJacobian = this->m_JacobianWorkPerThreadVariables[ threadId ].st_ImageJacobian;
 
   /** Get handles to the pre-allocated derivatives for the current thread.
    * The initialization is performed at the beginning of each resolution in
@@ -489,7 +490,6 @@ AdvancedKappaStatisticImageToImageMetric< TFixedImage, TMovingImage >
 
   /** Some variables. */
   RealType             movingImageValue;
-  MovingImagePointType mappedPoint;
   std::size_t          fixedForegroundArea   = 0; // or unsigned long
   std::size_t          movingForegroundArea  = 0;
   std::size_t          intersection          = 0;
@@ -502,14 +502,28 @@ AdvancedKappaStatisticImageToImageMetric< TFixedImage, TMovingImage >
   fbegin                                                 += (int)pos_begin;
   fend                                                   += (int)pos_end;
 
+  /** Blocks of fixed points and their transformed counterparts. */
+  FixedImagePointType  fixedPoints[ Self::TransformPointsBlockSize ];
+  MovingImagePointType mappedPoints[ Self::TransformPointsBlockSize ];
+  SizeValueType        blockSize  = 0;
+  SizeValueType        blockIndex = 0;
+
   /** Loop over the fixed image to calculate the kappa statistic. */
-  for( fiter = fbegin; fiter != fend; ++fiter )
+  for( fiter = fbegin; fiter != fend; ++fiter, ++blockIndex )
   {
+    /** Transform the next block of samples with a single call to the transform. */
+    if( blockIndex == blockSize )
+    {
+      blockSize  = this->TransformSampleBlock( fiter, fend, fixedPoints, mappedPoints );
+      blockIndex = 0;
+    }
+
     /** Read fixed coordinates. */
-    const FixedImagePointType & fixedPoint = ( *fiter ).Value().m_ImageCoordinates;
+    const FixedImagePointType &  fixedPoint  = fixedPoints[ blockIndex ];
+    const MovingImagePointType & mappedPoint = mappedPoints[ blockIndex ];
 
-    /** Transform point and check if it is inside the B-spline support region. */
-    bool sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
+    /** The mapped point is always valid for now; see TransformPoint(). */
+    bool sampleOk = true;
 
     /** Check if point is inside moving mask. */
     if( sampleOk )
@@ -643,8 +657,10 @@ AdvancedKappaStatisticImageToImageMetric< TFixedImage, TMovingImage >
     temp->st_Coefficient2      = tmp2;
     temp->st_DerivativePointer = derivative.begin();
 
-    this->m_Threader->SetSingleMethod( AccumulateDerivativesThreaderCallback, temp );
-    this->m_Threader->SingleMethodExecute();
+    /** Launch the threads of the persistent thread pool. */
+    PersistentThreadPool::SingleMethodExecute( AccumulateDerivativesThreaderCallback,
+      temp,
+      this->m_Threader->GetNumberOfThreads() );
 
     delete temp;
   }
@@ -91,6 +91,15 @@ namespace elastix
  *    B-spline grids.
  *    example: <tt>(UseFastAndLowMemoryVersion "false")</tt> \n
  *    The default is "true".
+ * \parameter UseParallelJointPDFReduction: Whether the joint histograms of
+ *    the threads are summed in parallel, by blocks of histogram bins, or by
+ *    a single thread. The parallel reduction only visits the histogram bins
+ *    that were touched by a thread, and is faster for many threads and large
+ *    histograms. Both give the same result. Only used when
+ *    UseMultiThreadingForMetrics is true.
+ *    example: <tt>(UseParallelJointPDFReduction "true")</tt> \n
+ *    The default is "false". Can be given for each resolution, or for
+ *    all resolutions at once.
  *
  * \sa ParzenWindowMutualInformationImageToImageMetric
  * \ingroup Metrics
@@ -131,6 +131,12 @@ AdvancedMattesMutualInformationMetric< TElastix >
     "UseJacobianPreconditioning", this->GetComponentLabel(), level, 0 );
   this->SetUseJacobianPreconditioning( useJacobianPreconditioning );
 
+  /** Set whether the per-thread joint histograms should be summed in parallel. */
+  bool useParallelJointPDFReduction = false;
+  this->GetModifiableConfiguration()->ReadParameter( useParallelJointPDFReduction,
+    "UseParallelJointPDFReduction", this->GetComponentLabel(), level, 0 );
+  this->SetUseParallelJointPDFReduction( useParallelJointPDFReduction );
+
   /** Set whether a finite difference derivative should be used. */
   bool useFiniteDifferenceDerivative = false;
   this->GetModifiableConfiguration()->ReadParameter( useFiniteDifferenceDerivative,
@@ -236,6 +236,10 @@ protected:
   /** Some initialization functions, called by Initialize. */
   virtual void InitializeHistograms( void );
 
+  /** The mutual information is computed from the joint PDF only, so
+   * GetValues() may evaluate on copies of this metric. */
+  virtual bool SupportsEvaluationClones( void ) const { return true; }
+
   /** Threading related parameters. */
   struct ParzenWindowMutualInformationMultiThreaderParameterType
   {
@@ -443,10 +443,11 @@ void
 ParzenWindowMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
 ::ThreadedComputeDerivativeLowMemory( ThreadIdType threadId )
 {
-  /** Initialize array that stores dM(x)/dmu, and the sparse Jacobian + indices. */
-  const NumberOfParametersType nnzji = this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices();
-  NonZeroJacobianIndicesType   nzji  = NonZeroJacobianIndicesType( nnzji );
-  DerivativeType               imageJacobian( nzji.size() );
+  /** Get handles to the pre-allocated arrays that store dM(x)/dmu and the
+   * sparse Jacobian indices. They are sized in InitializeJacobianWorkBuffers().
+   */
+  NonZeroJacobianIndicesType & nzji          = this->m_JacobianWorkPerThreadVariables[ threadId ].st_NonZeroJacobianIndices;
+  DerivativeType &             imageJacobian = this->m_JacobianWorkPerThreadVariables[ threadId ].st_ImageJacobian;
 
   /** Get a handle to the pre-allocated derivative for the current thread.
    * The initialization is performed at the beginning of each resolution in
@@ -485,17 +486,31 @@ ParzenWindowMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
   fbegin                                                 += (int)pos_begin;
   fend                                                   += (int)pos_end;
 
+  /** Blocks of fixed points, their values and their transformed counterparts. */
+  FixedImagePointType  fixedPoints[ Self::TransformPointsBlockSize ];
+  RealType             fixedValues[ Self::TransformPointsBlockSize ];
+  MovingImagePointType mappedPoints[ Self::TransformPointsBlockSize ];
+  SizeValueType        blockSize  = 0;
+  SizeValueType        blockIndex = 0;
+
   /** Loop over sample container and compute contribution of each sample to pdfs. */
-  for( fiter = fbegin; fiter != fend; ++fiter )
+  for( fiter = fbegin; fiter != fend; ++fiter, ++blockIndex )
   {
+    /** Transform the next block of samples with a single call to the transform. */
+    if( blockIndex == blockSize )
+    {
+      blockSize  = this->TransformSampleBlock( fiter, fend, fixedPoints, mappedPoints, fixedValues );
+      blockIndex = 0;
+    }
+
     /** Read fixed coordinates and create some variables. */
-    const FixedImagePointType & fixedPoint = ( *fiter ).Value().m_ImageCoordinates;
-    RealType                    movingImageValue;
-    MovingImageDerivativeType   movingImageDerivative;
-    MovingImagePointType        mappedPoint;
+    const FixedImagePointType &  fixedPoint  = fixedPoints[ blockIndex ];
+    const MovingImagePointType & mappedPoint = mappedPoints[ blockIndex ];
+    RealType                     movingImageValue;
+    MovingImageDerivativeType    movingImageDerivative;
 
-    /** Transform point and check if it is inside the B-spline support region. */
-    bool sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
+    /** The mapped point is always valid for now; see TransformPoint(). */
+    bool sampleOk = true;
 
     /** Check if the point is inside the moving mask. */
     if( sampleOk )
@@ -515,7 +530,7 @@ ParzenWindowMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
     if( sampleOk )
     {
       /** Get the fixed image value. */
-      RealType fixedImageValue = static_cast< RealType >( ( *fiter ).Value().m_ImageValue );
+      RealType fixedImageValue = fixedValues[ blockIndex ];
 
       /** Make sure the values fall within the histogram range. */
       fixedImageValue  = this->GetFixedImageLimiter()->Evaluate( fixedImageValue );
@@ -628,9 +643,10 @@ ParzenWindowMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
     this->m_ThreaderMetricParameters.st_DerivativePointer   = derivative.begin();
     this->m_ThreaderMetricParameters.st_NormalizationFactor = 1.0;
 
-    this->m_Threader->SetSingleMethod( this->AccumulateDerivativesThreaderCallback,
-      const_cast< void * >( static_cast< const void * >( &this->m_ThreaderMetricParameters ) ) );
-    this->m_Threader->SingleMethodExecute();
+    /** Launch the threads of the persistent thread pool. */
+    PersistentThreadPool::SingleMethodExecute( this->AccumulateDerivativesThreaderCallback,
+      const_cast< void * >( static_cast< const void * >( &this->m_ThreaderMetricParameters ) ),
+      this->m_Threader->GetNumberOfThreads() );
   }
 
 } // end AfterThreadedComputeDerivativeLowMemory()
@@ -667,13 +683,11 @@ void
 ParzenWindowMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
 ::LaunchComputeDerivativeLowMemoryThreaderCallback( void ) const
 {
-  /** Setup threader. */
-  this->m_Threader->SetSingleMethod( this->ComputeDerivativeLowMemoryThreaderCallback,
+  /** Launch the threads of the persistent thread pool. */
+  PersistentThreadPool::SingleMethodExecute( this->ComputeDerivativeLowMemoryThreaderCallback,
     const_cast< void * >( static_cast< const void * >(
-      &this->m_ParzenWindowMutualInformationThreaderParameters ) ) );
-
-  /** Launch. */
-  this->m_Threader->SingleMethodExecute();
+      &this->m_ParzenWindowMutualInformationThreaderParameters ) ),
+    this->m_Threader->GetNumberOfThreads() );
 
 } // end LaunchComputeDerivativeLowMemoryThreaderCallback()
 
@@ -220,6 +220,15 @@ protected:
 
   double m_NormalizationFactor;
 
+  /** GetValues() may evaluate on copies of this metric. */
+  virtual bool SupportsEvaluationClones( void ) const { return true; }
+
+  /** Also copy the normalization of the mean squares. */
+  virtual void CopyEvaluationState( const Superclass & other );
+
+  /** The threads mark the parameters they add to, see ThreadedGetValueAndDerivative(). */
+  virtual bool SupportsSparseDerivativeAccumulation( void ) const { return true; }
+
   /** Compute a pixel's contribution to the measure and derivatives;
    * Called by GetValueAndDerivative(). */
   void UpdateValueAndDerivativeTerms(
@@ -20,7 +20,7 @@
 
 #include "itkAdvancedMeanSquaresImageToImageMetric.h"
 #include "vnl/algo/vnl_matrix_update.h"
-#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkRandomVariateGeneratorInstance.h"
 #include "itkComputeImageExtremaFilter.h"
 
 #ifdef ELASTIX_USE_OPENMP
@@ -152,6 +152,28 @@ AdvancedMeanSquaresImageToImageMetric< TFixedImage, TMovingImage >
 } // end Initialize()
 
 
+/**
+ * ******************* CopyEvaluationState *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+AdvancedMeanSquaresImageToImageMetric< TFixedImage, TMovingImage >
+::CopyEvaluationState( const Superclass & other )
+{
+  Superclass::CopyEvaluationState( other );
+
+  const Self * otherMeanSquares = dynamic_cast< const Self * >( &other );
+  if( !otherMeanSquares )
+  {
+    itkExceptionMacro( << "Can only copy the state of an AdvancedMeanSquaresImageToImageMetric." );
+  }
+  this->m_UseNormalization    = otherMeanSquares->m_UseNormalization;
+  this->m_NormalizationFactor = otherMeanSquares->m_NormalizationFactor;
+
+} // end CopyEvaluationState()
+
+
 /**
  * ******************* PrintSelf *******************
  */
@@ -345,16 +367,29 @@ AdvancedMeanSquaresImageToImageMetric< TFixedImage, TMovingImage >
   unsigned long numberOfPixelsCounted = 0;
   MeasureType   measure               = NumericTraits< MeasureType >::Zero;
 
+  /** Blocks of fixed points, their values and their transformed counterparts. */
+  FixedImagePointType  fixedPoints[ Self::TransformPointsBlockSize ];
+  RealType             fixedValues[ Self::TransformPointsBlockSize ];
+  MovingImagePointType mappedPoints[ Self::TransformPointsBlockSize ];
+  SizeValueType        blockSize  = 0;
+  SizeValueType        blockIndex = 0;
+
   /** Loop over the fixed image to calculate the mean squares. */
-  for( threader_fiter = threader_fbegin; threader_fiter != threader_fend; ++threader_fiter )
+  for( threader_fiter = threader_fbegin; threader_fiter != threader_fend; ++threader_fiter, ++blockIndex )
   {
-    /** Read fixed coordinates and initialize some variables. */
-    const FixedImagePointType & fixedPoint = ( *threader_fiter ).Value().m_ImageCoordinates;
-    RealType                    movingImageValue;
-    MovingImagePointType        mappedPoint;
+    /** Transform the next block of samples with a single call to the transform. */
+    if( blockIndex == blockSize )
+    {
+      blockSize  = this->TransformSampleBlock( threader_fiter, threader_fend, fixedPoints, mappedPoints, fixedValues );
+      blockIndex = 0;
+    }
 
-    /** Transform point and check if it is inside the B-spline support region. */
-    bool sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
+    /** Read the mapped point and initialize some variables. */
+    const MovingImagePointType & mappedPoint = mappedPoints[ blockIndex ];
+    RealType                     movingImageValue;
+
+    /** The mapped point is always valid for now; see TransformPoint(). */
+    bool sampleOk = true;
 
     /** Check if point is inside mask. */
     if( sampleOk )
@@ -376,8 +411,7 @@ AdvancedMeanSquaresImageToImageMetric< TFixedImage, TMovingImage >
       numberOfPixelsCounted++;
 
       /** Get the fixed image value. */
-      const RealType & fixedImageValue
-        = static_cast< RealType >( ( *threader_fiter ).Value().m_ImageValue );
+      const RealType & fixedImageValue = fixedValues[ blockIndex ];
 
       /** The difference squared. */
       const RealType diff = movingImageValue - fixedImageValue;
@@ -636,10 +670,11 @@ void
 AdvancedMeanSquaresImageToImageMetric< TFixedImage, TMovingImage >
 ::ThreadedGetValueAndDerivative( ThreadIdType threadId )
 {
-  /** Initialize array that stores dM(x)/dmu, and the sparse Jacobian + indices. */
-  const NumberOfParametersType nnzji = this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices();
-  NonZeroJacobianIndicesType   nzji  = NonZeroJacobianIndicesType( nnzji );
-  DerivativeType               imageJacobian( nnzji );
+  /** Get handles to the pre-allocated arrays that store dM(x)/dmu and the
+   * sparse Jacobian indices. They are sized in InitializeJacobianWorkBuffers().
+   */
+  NonZeroJacobianIndicesType & nzji          = this->m_JacobianWorkPerThreadVariables[ threadId ].st_NonZeroJacobianIndices;
+  DerivativeType &             imageJacobian = this->m_JacobianWorkPerThreadVariables[ threadId ].st_ImageJacobian;
 
   /** Get a handle to the pre-allocated derivative for the current thread.
    * The initialization is performed at the beginning of each resolution in
@@ -674,17 +709,31 @@ AdvancedMeanSquaresImageToImageMetric< TFixedImage, TMovingImage >
   unsigned long numberOfPixelsCounted = 0;
   MeasureType   measure               = NumericTraits< MeasureType >::Zero;
 
+  /** Blocks of fixed points, their values and their transformed counterparts. */
+  FixedImagePointType  fixedPoints[ Self::TransformPointsBlockSize ];
+  RealType             fixedValues[ Self::TransformPointsBlockSize ];
+  MovingImagePointType mappedPoints[ Self::TransformPointsBlockSize ];
+  SizeValueType        blockSize  = 0;
+  SizeValueType        blockIndex = 0;
+
   /** Loop over the fixed image to calculate the mean squares. */
-  for( threader_fiter = threader_fbegin; threader_fiter != threader_fend; ++threader_fiter )
+  for( threader_fiter = threader_fbegin; threader_fiter != threader_fend; ++threader_fiter, ++blockIndex )
   {
+    /** Transform the next block of samples with a single call to the transform. */
+    if( blockIndex == blockSize )
+    {
+      blockSize  = this->TransformSampleBlock( threader_fiter, threader_fend, fixedPoints, mappedPoints, fixedValues );
+      blockIndex = 0;
+    }
+
     /** Read fixed coordinates and initialize some variables. */
-    const FixedImagePointType & fixedPoint = ( *threader_fiter ).Value().m_ImageCoordinates;
-    RealType                    movingImageValue;
-    MovingImagePointType        mappedPoint;
-    MovingImageDerivativeType   movingImageDerivative;
+    const FixedImagePointType &  fixedPoint  = fixedPoints[ blockIndex ];
+    const MovingImagePointType & mappedPoint = mappedPoints[ blockIndex ];
+    RealType                     movingImageValue;
+    MovingImageDerivativeType    movingImageDerivative;
 
-    /** Transform point and check if it is inside the B-spline support region. */
-    bool sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
+    /** The mapped point is always valid for now; see TransformPoint(). */
+    bool sampleOk = true;
 
     /** Check if point is inside mask. */
     if( sampleOk )
@@ -706,8 +755,7 @@ AdvancedMeanSquaresImageToImageMetric< TFixedImage, TMovingImage >
       numberOfPixelsCounted++;
 
       /** Get the fixed image value. */
-      const RealType & fixedImageValue
-        = static_cast< RealType >( ( *threader_fiter ).Value().m_ImageValue );
+      const RealType & fixedImageValue = fixedValues[ blockIndex ];
 
 #if 0
       /** Get the TransformJacobian dT/dmu. */
@@ -727,6 +775,7 @@ AdvancedMeanSquaresImageToImageMetric< TFixedImage, TMovingImage >
         fixedImageValue, movingImageValue,
         imageJacobian, nzji,
         measure, derivative );
+      this->MarkTouchedDerivativeBlocks( threadId, nzji );
 
     } // end if sampleOk
 
@@ -795,9 +844,10 @@ AdvancedMeanSquaresImageToImageMetric< TFixedImage, TMovingImage >
     this->m_ThreaderMetricParameters.st_DerivativePointer   = derivative.begin();
     this->m_ThreaderMetricParameters.st_NormalizationFactor = 1.0 / normal_sum;
 
-    this->m_Threader->SetSingleMethod( this->AccumulateDerivativesThreaderCallback,
-      const_cast< void * >( static_cast< const void * >( &this->m_ThreaderMetricParameters ) ) );
-    this->m_Threader->SingleMethodExecute();
+    /** Launch the threads of the persistent thread pool. */
+    PersistentThreadPool::SingleMethodExecute( this->AccumulateDerivativesThreaderCallback,
+      const_cast< void * >( static_cast< const void * >( &this->m_ThreaderMetricParameters ) ),
+      this->m_Threader->GetNumberOfThreads() );
   }
 #ifdef ELASTIX_USE_OPENMP
   // compute multi-threadedly with openmp
@@ -881,7 +931,7 @@ AdvancedMeanSquaresImageToImageMetric< TFixedImage, TMovingImage >
 
   /** Initialize some variables. */
   this->m_NumberOfPixelsCounted = 0;
-  RandomGeneratorType::Pointer randomGenerator = RandomGeneratorType::GetInstance();
+  RandomGeneratorType::Pointer randomGenerator = RandomVariateGeneratorInstance::Get();
   randomGenerator->Initialize();
 
   /** Array that stores dM(x)/dmu, and the sparse jacobian+indices. */
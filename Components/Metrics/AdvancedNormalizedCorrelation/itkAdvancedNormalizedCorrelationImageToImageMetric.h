@@ -228,6 +228,12 @@ protected:
    */
   virtual void InitializeThreadingParameters( void ) const;
 
+  /** GetValues() may evaluate on copies of this metric. */
+  virtual bool SupportsEvaluationClones( void ) const { return true; }
+
+  /** Also copy the SubtractMean setting. */
+  virtual void CopyEvaluationState( const Superclass & other );
+
   /** Get value and derivatives for each thread. */
   inline void ThreadedGetValueAndDerivative( ThreadIdType threadID );
 
@@ -108,6 +108,27 @@ AdvancedNormalizedCorrelationImageToImageMetric< TFixedImage, TMovingImage >
 } // end InitializeThreadingParameters()
 
 
+/**
+ * ******************* CopyEvaluationState *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+AdvancedNormalizedCorrelationImageToImageMetric< TFixedImage, TMovingImage >
+::CopyEvaluationState( const Superclass & other )
+{
+  Superclass::CopyEvaluationState( other );
+
+  const Self * otherCorrelation = dynamic_cast< const Self * >( &other );
+  if( !otherCorrelation )
+  {
+    itkExceptionMacro( << "Can only copy the state of an AdvancedNormalizedCorrelationImageToImageMetric." );
+  }
+  this->m_SubtractMean = otherCorrelation->m_SubtractMean;
+
+} // end CopyEvaluationState()
+
+
 /**
  * ******************* PrintSelf *******************
  */
@@ -530,10 +551,11 @@ void
 AdvancedNormalizedCorrelationImageToImageMetric< TFixedImage, TMovingImage >
 ::ThreadedGetValueAndDerivative( ThreadIdType threadId )
 {
-  /** Initialize array that stores dM(x)/dmu, and the sparse Jacobian + indices. */
-  const NumberOfParametersType nnzji = this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices();
-  NonZeroJacobianIndicesType   nzji  = NonZeroJacobianIndicesType( nnzji );
-  DerivativeType               imageJacobian( nzji.size() );
+  /** Get handles to the pre-allocated arrays that store dM(x)/dmu and the
+   * sparse Jacobian indices. They are sized in InitializeJacobianWorkBuffers().
+   */
+  NonZeroJacobianIndicesType & nzji          = this->m_JacobianWorkPerThreadVariables[ threadId ].st_NonZeroJacobianIndices;
+  DerivativeType &             imageJacobian = this->m_JacobianWorkPerThreadVariables[ threadId ].st_ImageJacobian;
 
   /** Get handles to the pre-allocated derivatives for the current thread.
    * The initialization is performed at the beginning of each resolution in
@@ -574,17 +596,31 @@ AdvancedNormalizedCorrelationImageToImageMetric< TFixedImage, TMovingImage >
   AccumulateType sm                    = NumericTraits< AccumulateType >::Zero;
   unsigned long  numberOfPixelsCounted = 0;
 
+  /** Blocks of fixed points, their values and their transformed counterparts. */
+  FixedImagePointType  fixedPoints[ Self::TransformPointsBlockSize ];
+  RealType             fixedValues[ Self::TransformPointsBlockSize ];
+  MovingImagePointType mappedPoints[ Self::TransformPointsBlockSize ];
+  SizeValueType        blockSize  = 0;
+  SizeValueType        blockIndex = 0;
+
   /** Loop over the fixed image to calculate the mean squares. */
-  for( threader_fiter = threader_fbegin; threader_fiter != threader_fend; ++threader_fiter )
+  for( threader_fiter = threader_fbegin; threader_fiter != threader_fend; ++threader_fiter, ++blockIndex )
   {
+    /** Transform the next block of samples with a single call to the transform. */
+    if( blockIndex == blockSize )
+    {
+      blockSize  = this->TransformSampleBlock( threader_fiter, threader_fend, fixedPoints, mappedPoints, fixedValues );
+      blockIndex = 0;
+    }
+
     /** Read fixed coordinates and initialize some variables. */
-    const FixedImagePointType & fixedPoint = ( *threader_fiter ).Value().m_ImageCoordinates;
-    RealType                    movingImageValue;
-    MovingImagePointType        mappedPoint;
-    MovingImageDerivativeType   movingImageDerivative;
+    const FixedImagePointType &  fixedPoint  = fixedPoints[ blockIndex ];
+    const MovingImagePointType & mappedPoint = mappedPoints[ blockIndex ];
+    RealType                     movingImageValue;
+    MovingImageDerivativeType    movingImageDerivative;
 
-    /** Transform point and check if it is inside the B-spline support region. */
-    bool sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
+    /** The mapped point is always valid for now; see TransformPoint(). */
+    bool sampleOk = true;
 
     /** Check if point is inside mask. */
     if( sampleOk )
@@ -606,8 +642,7 @@ AdvancedNormalizedCorrelationImageToImageMetric< TFixedImage, TMovingImage >
       numberOfPixelsCounted++;
 
       /** Get the fixed image value. */
-      const RealType & fixedImageValue
-        = static_cast< RealType >( ( *threader_fiter ).Value().m_ImageValue );
+      const RealType & fixedImageValue = fixedValues[ blockIndex ];
 
 #if 0
       /** Get the TransformJacobian dT/dmu. */
@@ -768,8 +803,10 @@ AdvancedNormalizedCorrelationImageToImageMetric< TFixedImage, TMovingImage >
     temp->st_InvertedDenominator = 1.0 / denom;
     temp->st_DerivativePointer   = derivative.begin();
 
-    this->m_Threader->SetSingleMethod( AccumulateDerivativesThreaderCallback, temp );
-    this->m_Threader->SingleMethodExecute();
+    /** Launch the threads of the persistent thread pool. */
+    PersistentThreadPool::SingleMethodExecute( AccumulateDerivativesThreaderCallback,
+      temp,
+      this->m_Threader->GetNumberOfThreads() );
 
     delete temp;
   }
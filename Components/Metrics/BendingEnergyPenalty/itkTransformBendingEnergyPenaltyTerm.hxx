@@ -638,9 +638,10 @@ TransformBendingEnergyPenaltyTerm< TFixedImage, TScalarType >
     this->m_ThreaderMetricParameters.st_NormalizationFactor
       = static_cast< DerivativeValueType >( this->m_NumberOfPixelsCounted );
 
-    this->m_Threader->SetSingleMethod( this->AccumulateDerivativesThreaderCallback,
-      const_cast< void * >( static_cast< const void * >( &this->m_ThreaderMetricParameters ) ) );
-    this->m_Threader->SingleMethodExecute();
+    /** Launch the threads of the persistent thread pool. */
+    PersistentThreadPool::SingleMethodExecute( this->AccumulateDerivativesThreaderCallback,
+      const_cast< void * >( static_cast< const void * >( &this->m_ThreaderMetricParameters ) ),
+      this->m_Threader->GetNumberOfThreads() );
   }
 #ifdef ELASTIX_USE_OPENMP
   // compute multi-threadedly with openmp
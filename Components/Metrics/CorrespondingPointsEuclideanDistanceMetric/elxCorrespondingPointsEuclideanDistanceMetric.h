@@ -32,6 +32,10 @@ namespace elastix
  * \parameter Metric: Select this metric as follows:\n
  *    <tt>(Metric "CorrespondingPointsEuclideanDistanceMetric")</tt>
  *
+ * The corresponding points are read from the files given by the -fp and -mp
+ * command line arguments, or, when using the ElastixFilter, taken from the
+ * point sets that were given in memory.
+ *
  * \ingroup Metrics
  *
  */
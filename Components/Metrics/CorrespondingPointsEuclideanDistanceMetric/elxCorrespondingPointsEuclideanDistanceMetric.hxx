@@ -72,7 +72,11 @@ CorrespondingPointsEuclideanDistanceMetric< TElastix >
 
   /** Check for appearance of "-fp". */
   check = this->m_Configuration->GetCommandLineArgument( "-fp" );
-  if( check.empty() )
+  if( this->GetModifiableElastix()->GetNumberOfFixedPointSets() > 0 )
+  {
+    elxout << "-fp       given in memory" << std::endl;
+  }
+  else if( check.empty() )
   {
     elxout << "-fp       unspecified" << std::endl;
   }
@@ -83,7 +87,11 @@ CorrespondingPointsEuclideanDistanceMetric< TElastix >
 
   /** Check for appearance of "-mp". */
   check = this->m_Configuration->GetCommandLineArgument( "-mp" );
-  if( check.empty() )
+  if( this->GetModifiableElastix()->GetNumberOfMovingPointSets() > 0 )
+  {
+    elxout << "-mp       given in memory" << std::endl;
+  }
+  else if( check.empty() )
   {
     elxout << "-mp       unspecified" << std::endl;
   }
@@ -107,20 +115,38 @@ void
 CorrespondingPointsEuclideanDistanceMetric< TElastix >
 ::BeforeRegistration( void )
 {
-  /** Read and set the fixed pointset. */
-  std::string fixedName = this->GetModifiableConfiguration()->GetCommandLineArgument( "-fp" );
-  typename PointSetType::Pointer fixedPointSet      = 0;
-  const typename ImageType::ConstPointer fixedImage = this->GetModifiableElastix()->GetFixedImage();
-  const unsigned int nrOfFixedPoints = this->ReadLandmarks(
-    fixedName, fixedPointSet, fixedImage );
+  /** Read and set the fixed pointset. Point sets that are given in
+   * memory are used directly; they are in world coordinates.
+   */
+  typename PointSetType::Pointer fixedPointSet = this->GetModifiableElastix()->GetFixedPointSet();
+  unsigned int nrOfFixedPoints = 0;
+  if( fixedPointSet.IsNotNull() )
+  {
+    nrOfFixedPoints = fixedPointSet->GetNumberOfPoints();
+    elxout << "  Number of fixed points given in memory: " << nrOfFixedPoints << std::endl;
+  }
+  else
+  {
+    std::string fixedName = this->GetModifiableConfiguration()->GetCommandLineArgument( "-fp" );
+    const typename ImageType::ConstPointer fixedImage = this->GetModifiableElastix()->GetFixedImage();
+    nrOfFixedPoints = this->ReadLandmarks( fixedName, fixedPointSet, fixedImage );
+  }
   this->SetFixedPointSet( fixedPointSet );
 
   /** Read and set the moving pointset. */
-  std::string movingName = this->GetModifiableConfiguration()->GetCommandLineArgument( "-mp" );
-  typename PointSetType::Pointer movingPointSet      = 0;
-  const typename ImageType::ConstPointer movingImage = this->GetModifiableElastix()->GetMovingImage();
-  const unsigned int nrOfMovingPoints = this->ReadLandmarks(
-    movingName, movingPointSet, movingImage );
+  typename PointSetType::Pointer movingPointSet = this->GetModifiableElastix()->GetMovingPointSet();
+  unsigned int nrOfMovingPoints = 0;
+  if( movingPointSet.IsNotNull() )
+  {
+    nrOfMovingPoints = movingPointSet->GetNumberOfPoints();
+    elxout << "  Number of moving points given in memory: " << nrOfMovingPoints << std::endl;
+  }
+  else
+  {
+    std::string movingName = this->GetModifiableConfiguration()->GetCommandLineArgument( "-mp" );
+    const typename ImageType::ConstPointer movingImage = this->GetModifiableElastix()->GetMovingImage();
+    nrOfMovingPoints = this->ReadLandmarks( movingName, movingPointSet, movingImage );
+  }
   this->SetMovingPointSet( movingPointSet );
 
   /** Check. */
@@ -28,6 +28,8 @@ namespace elastix
  * \class GradientDifferenceMetric
  * \brief An metric based on the itk::GradientDifferenceImageToImageMetric.
  *
+ * Specify an ImageSampler to compute the metric at a subset of the fixed
+ * image voxels; otherwise all voxels are used.
  *
  * \ingroup Metrics
  *
@@ -126,6 +128,11 @@ public:
   typedef typename Superclass2::RegistrationPointer  RegistrationPointer;
   typedef typename Superclass2::ITKBaseType          ITKBaseType;
 
+  /** Use the image sampler, if one is specified in the parameter file.
+   * Otherwise the metric is computed at all voxels of the fixed image.
+   */
+  virtual int BeforeAll( void );
+
   /** Sets up a timer to measure the initialization time and
    * calls the Superclass' implementation.
    */
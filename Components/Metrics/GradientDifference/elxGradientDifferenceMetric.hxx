@@ -24,6 +24,22 @@
 namespace elastix
 {
 
+/**
+ * ******************* BeforeAll ***********************
+ */
+
+template< class TElastix >
+int
+GradientDifferenceMetric< TElastix >
+::BeforeAll( void )
+{
+  /** Without an image sampler the metric falls back to all voxels. */
+  this->SetUseImageSampler( this->m_Elastix->GetElxImageSamplerBase() != 0 );
+  return 0;
+
+} // end BeforeAll()
+
+
 /**
  * ******************* Initialize ***********************
  */
@@ -34,16 +34,8 @@
 #ifndef __itkGradientDifferenceImageToImageMetric2_h
 #define __itkGradientDifferenceImageToImageMetric2_h
 
-#include "itkAdvancedImageToImageMetric.h"
-
-#include "itkSobelOperator.h"
-#include "itkNeighborhoodOperatorImageFilter.h"
-#include "itkPoint.h"
-#include "itkCastImageFilter.h"
-#include "itkResampleImageFilter.h"
+#include "itkRayCastGradientImageToImageMetric.h"
 #include "itkOptimizer.h"
-#include "itkAdvancedCombinationTransform.h"
-#include "itkAdvancedRayCastInterpolateImageFunction.h"
 
 namespace itk
 {
@@ -64,6 +56,9 @@ namespace itk
  * on it. Values at these non-grid position of the Fixed image are
  * interpolated using a user-selected Interpolator.
  *
+ * The gradients are only computed at the samples of the image sampler,
+ * see RayCastGradientImageToImageMetric.
+ *
  * Implementation of this class is based on:
  * Hipwell, J. H., et. al. (2003), "Intensity-Based 2-D-3D Registration of
  * Cerebral Angiograms,", IEEE Transactions on Medical Imaging,
@@ -73,13 +68,13 @@ namespace itk
  */
 template< class TFixedImage, class TMovingImage >
 class GradientDifferenceImageToImageMetric :
-  public AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+  public RayCastGradientImageToImageMetric< TFixedImage, TMovingImage >
 {
 public:
 
   /** Standard class typedefs. */
-  typedef GradientDifferenceImageToImageMetric                    Self;
-  typedef AdvancedImageToImageMetric< TFixedImage, TMovingImage > Superclass;
+  typedef GradientDifferenceImageToImageMetric                           Self;
+  typedef RayCastGradientImageToImageMetric< TFixedImage, TMovingImage > Superclass;
 
   typedef SmartPointer< Self >       Pointer;
   typedef SmartPointer< const Self > ConstPointer;
@@ -88,7 +83,7 @@ public:
   itkNewMacro( Self );
 
   /** Run-time type information (and related methods). */
-  itkTypeMacro( GradientDifferenceImageToImageMetric, ImageToImageMetric );
+  itkTypeMacro( GradientDifferenceImageToImageMetric, RayCastGradientImageToImageMetric );
 
   /** Types transferred from the base class */
   /** Work around a Visual Studio .NET bug */
@@ -119,31 +114,9 @@ public:
 
   itkStaticConstMacro( FixedImageDimension, unsigned int,
     FixedImageType::ImageDimension );
-  itkStaticConstMacro( MovedImageDimension, unsigned int,
-    MovingImageType::ImageDimension );
-
-  typedef typename itk::AdvancedCombinationTransform< ScalarType, FixedImageDimension >
-    CombinationTransformType;
-  typedef typename CombinationTransformType::Pointer CombinationTransformPointer;
-  typedef itk::Image< FixedImagePixelType, itkGetStaticConstMacro( FixedImageDimension ) >
-    TransformedMovingImageType;
-  typedef itk::ResampleImageFilter< MovingImageType, TransformedMovingImageType >
-    TransformMovingImageFilterType;
-  typedef typename itk::AdvancedRayCastInterpolateImageFunction<
-    MovingImageType, ScalarType >             RayCastInterpolatorType;
-  typedef typename RayCastInterpolatorType::Pointer RayCastInterpolatorPointer;
-  typedef itk::Image< RealType, itkGetStaticConstMacro( FixedImageDimension ) >
-    FixedGradientImageType;
-  typedef itk::CastImageFilter< FixedImageType, FixedGradientImageType >
-    CastFixedImageFilterType;
-  typedef typename CastFixedImageFilterType::Pointer CastFixedImageFilterPointer;
-  typedef typename FixedGradientImageType::PixelType FixedGradientPixelType;
-  typedef itk::Image< RealType, itkGetStaticConstMacro( MovedImageDimension ) >
-    MovedGradientImageType;
-  typedef itk::CastImageFilter< TransformedMovingImageType, MovedGradientImageType >
-    CastMovedImageFilterType;
-  typedef typename CastMovedImageFilterType::Pointer CastMovedImageFilterPointer;
-  typedef typename MovedGradientImageType::PixelType MovedGradientPixelType;
+
+  typedef typename Superclass::FixedGradientImageType FixedGradientImageType;
+  typedef typename Superclass::FixedGradientPixelType FixedGradientPixelType;
 
   /** Get the derivatives of the match measure. */
   void GetDerivative( const TransformParametersType & parameters,
@@ -158,9 +131,6 @@ public:
 
   virtual void Initialize( void ) throw ( ExceptionObject );
 
-  /** Write gradient images to a files for debugging purposes. */
-  void WriteGradientImagesToFiles( void ) const;
-
   /** Set/Get Scales  */
   itkSetMacro( Scales, ScalesType );
   itkGetConstReferenceMacro( Scales, ScalesType );
@@ -176,68 +146,34 @@ protected:
   virtual ~GradientDifferenceImageToImageMetric() {}
   void PrintSelf( std::ostream & os, Indent indent ) const;
 
-  /** Compute the range of the moved image gradients. */
+  /** Compute the range of the moved image gradients at the samples. */
   void ComputeMovedGradientRange( void ) const;
 
-  /** Compute the variance and range of the moving image gradients. */
+  /** Compute the variance and range of the fixed image gradients. */
   void ComputeVariance( void ) const;
 
   /** Compute the similarity measure using a specified subtraction factor. */
-  MeasureType ComputeMeasure( const TransformParametersType & parameters,
-    const double * subtractionFactor ) const;
-
-  typedef NeighborhoodOperatorImageFilter<
-    FixedGradientImageType, FixedGradientImageType > FixedSobelFilter;
-
-  typedef NeighborhoodOperatorImageFilter<
-    MovedGradientImageType, MovedGradientImageType > MovedSobelFilter;
+  MeasureType ComputeMeasure( const RealType * subtractionFactor ) const;
 
 private:
 
   GradientDifferenceImageToImageMetric( const Self & ); // purposely not implemented
   void operator=( const Self & );                       // purposely not implemented
 
-  /** The variance of the moving image gradients. */
-  mutable MovedGradientPixelType m_Variance[ FixedImageDimension ];
+  /** The variance of the fixed image gradients. */
+  mutable RealType m_Variance[ FixedImageDimension ];
 
   /** The range of the moving image gradients. */
-  mutable MovedGradientPixelType m_MinMovedGradient[ MovedImageDimension ];
-  mutable MovedGradientPixelType m_MaxMovedGradient[ MovedImageDimension ];
+  mutable RealType m_MinMovedGradient[ FixedImageDimension ];
+  mutable RealType m_MaxMovedGradient[ FixedImageDimension ];
 
   /** The range of the fixed image gradients. */
-  mutable FixedGradientPixelType m_MinFixedGradient[ FixedImageDimension ];
-  mutable FixedGradientPixelType m_MaxFixedGradient[ FixedImageDimension ];
-
-  /** The filter for transforming the moving image. */
-  typename TransformMovingImageFilterType::Pointer m_TransformMovingImageFilter;
-
-  /** The Sobel gradients of the fixed image */
-  CastFixedImageFilterPointer m_CastFixedImageFilter;
-
-  SobelOperator< FixedGradientPixelType,
-  itkGetStaticConstMacro( FixedImageDimension ) >
-  m_FixedSobelOperators[ FixedImageDimension ];
-
-  typename FixedSobelFilter::Pointer m_FixedSobelFilters[ itkGetStaticConstMacro
-    ( FixedImageDimension ) ];
-
-  ZeroFluxNeumannBoundaryCondition< MovedGradientImageType > m_MovedBoundCond;
-  ZeroFluxNeumannBoundaryCondition< FixedGradientImageType > m_FixedBoundCond;
-
-  /** The Sobel gradients of the moving image */
-  CastMovedImageFilterPointer m_CastMovedImageFilter;
-
-  SobelOperator< MovedGradientPixelType,
-  itkGetStaticConstMacro( MovedImageDimension ) >
-  m_MovedSobelOperators[ MovedImageDimension ];
-
-  typename MovedSobelFilter::Pointer m_MovedSobelFilters[ itkGetStaticConstMacro
-    ( MovedImageDimension ) ];
+  mutable RealType m_MinFixedGradient[ FixedImageDimension ];
+  mutable RealType m_MaxFixedGradient[ FixedImageDimension ];
 
-  ScalesType                  m_Scales;
-  double                      m_DerivativeDelta;
-  double                      m_Rescalingfactor;
-  CombinationTransformPointer m_CombinationTransform;
+  ScalesType m_Scales;
+  double     m_DerivativeDelta;
+  double     m_Rescalingfactor;
 
 };
 
@@ -37,14 +37,6 @@
 #include "itkGradientDifferenceImageToImageMetric2.h"
 #include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkNumericTraits.h"
-#include "itkRescaleIntensityImageFilter.h"
-#include "itkImageFileWriter.h"
-
-#include <iostream>
-#include <iomanip>
-#include <stdio.h>
-
-#include "itkSimpleFilterWatcher.h"
 
 namespace itk
 {
@@ -57,23 +49,13 @@ template< class TFixedImage, class TMovingImage >
 GradientDifferenceImageToImageMetric< TFixedImage, TMovingImage >
 ::GradientDifferenceImageToImageMetric()
 {
-  unsigned int iDimension;
-  this->m_CastMovedImageFilter       = CastMovedImageFilterType::New();
-  this->m_CastFixedImageFilter       = CastFixedImageFilterType::New();
-  this->m_CombinationTransform       = CombinationTransformType::New();
-  this->m_TransformMovingImageFilter = TransformMovingImageFilterType::New();
-
-  for( iDimension = 0; iDimension < FixedImageDimension; iDimension++ )
+  for( unsigned int iDimension = 0; iDimension < FixedImageDimension; iDimension++ )
   {
     this->m_MinFixedGradient[ iDimension ] = 0;
     this->m_MaxFixedGradient[ iDimension ] = 0;
-    this->m_Variance[ iDimension ]         = 0;
-  }
-
-  for( iDimension = 0; iDimension < MovedImageDimension; iDimension++ )
-  {
     this->m_MinMovedGradient[ iDimension ] = 0;
     this->m_MaxMovedGradient[ iDimension ] = 0;
+    this->m_Variance[ iDimension ]         = 0;
   }
 
   this->m_DerivativeDelta = 0.001;
@@ -90,64 +72,11 @@ void
 GradientDifferenceImageToImageMetric< TFixedImage, TMovingImage >
 ::Initialize( void ) throw ( ExceptionObject )
 {
-  /** Initialise the base class */
+  /** Initialise the base class, which also computes the fixed image gradients. */
   Superclass::Initialize();
 
-  unsigned int iFilter;
-
-  /** Compute the gradient of the fixed images */
-  this->m_CastFixedImageFilter->SetInput( this->m_FixedImage );
-  this->m_CastFixedImageFilter->Update();
-
-  for( iFilter = 0; iFilter < FixedImageDimension; iFilter++ )
-  {
-    this->m_FixedSobelOperators[ iFilter ].SetDirection( iFilter );
-    this->m_FixedSobelOperators[ iFilter ].CreateDirectional();
-    this->m_FixedSobelFilters[ iFilter ] = FixedSobelFilter::New();
-    this->m_FixedSobelFilters[ iFilter ]->OverrideBoundaryCondition( &this->m_FixedBoundCond );
-    this->m_FixedSobelFilters[ iFilter ]->SetOperator( this->m_FixedSobelOperators[ iFilter ] );
-    this->m_FixedSobelFilters[ iFilter ]->SetInput( this->m_CastFixedImageFilter->GetOutput() );
-    this->m_FixedSobelFilters[ iFilter ]->UpdateLargestPossibleRegion();
-  }
-
-  /** Resampling for 3D->2D */
-  RayCastInterpolatorType * rayCaster = dynamic_cast< RayCastInterpolatorType * >(
-    const_cast< InterpolatorType * >( this->GetInterpolator() ) );
-  if( rayCaster != 0 )
-  {
-    this->m_TransformMovingImageFilter->SetTransform( rayCaster->GetTransform() );
-  }
-  else
-  {
-    itkExceptionMacro( << "ERROR: the NormalizedGradientCorrelationImageToImageMetric is currently "
-                       << "only suitable for 2D-3D registration.\n"
-                       << "  Therefore it expects an interpolator of type RayCastInterpolator." );
-  }
-  this->m_TransformMovingImageFilter->SetInterpolator( this->m_Interpolator );
-  this->m_TransformMovingImageFilter->SetInput( this->m_MovingImage );
-  this->m_TransformMovingImageFilter->SetDefaultPixelValue( 0 );
-  this->m_TransformMovingImageFilter->SetSize( this->m_FixedImage->GetLargestPossibleRegion().GetSize() );
-  this->m_TransformMovingImageFilter->SetOutputOrigin( this->m_FixedImage->GetOrigin() );
-  this->m_TransformMovingImageFilter->SetOutputSpacing( this->m_FixedImage->GetSpacing() );
-  this->m_TransformMovingImageFilter->SetOutputDirection( this->m_FixedImage->GetDirection() );
-  this->m_TransformMovingImageFilter->Update();
-
-  this->m_CastMovedImageFilter->SetInput(
-    this->m_TransformMovingImageFilter->GetOutput() );
-
-  for( iFilter = 0; iFilter < MovedImageDimension; iFilter++ )
-  {
-    this->m_MovedSobelOperators[ iFilter ].SetDirection( iFilter );
-    this->m_MovedSobelOperators[ iFilter ].CreateDirectional();
-    this->m_MovedSobelFilters[ iFilter ] = MovedSobelFilter::New();
-    this->m_MovedSobelFilters[ iFilter ]->OverrideBoundaryCondition( &this->m_MovedBoundCond );
-    this->m_MovedSobelFilters[ iFilter ]->SetOperator( this->m_MovedSobelOperators[ iFilter ] );
-    this->m_MovedSobelFilters[ iFilter ]->SetInput( this->m_CastMovedImageFilter->GetOutput() );
-    this->m_MovedSobelFilters[ iFilter ]->UpdateLargestPossibleRegion();
-  }
-
   /** Compute the variance */
-  ComputeVariance();
+  this->ComputeVariance();
 
   /* Rescale the similarity measure between 0-1; */
   MeasureType tmpmeasure = this->GetValue( this->m_Transform->GetParameters() );
@@ -184,40 +113,37 @@ void
 GradientDifferenceImageToImageMetric< TFixedImage, TMovingImage >
 ::ComputeMovedGradientRange( void ) const
 {
-  unsigned int           iDimension;
-  MovedGradientPixelType gradient;
-
-  for( iDimension = 0; iDimension < FixedImageDimension; iDimension++ )
+  const SizeValueType numberOfSamples = this->m_NumberOfPixelsCounted;
+  if( numberOfSamples == 0 )
   {
-    typedef itk::ImageRegionConstIteratorWithIndex<
-      MovedGradientImageType > IteratorType;
-
-    IteratorType iterate( m_MovedSobelFilters[ iDimension ]->GetOutput(),
-    this->GetFixedImageRegion() );
-
-    gradient = iterate.Get();
+    itkExceptionMacro( << "All the samples are outside the fixed image." );
+  }
 
-    m_MinMovedGradient[ iDimension ] = gradient;
-    m_MaxMovedGradient[ iDimension ] = gradient;
+  const RealType * movedGradient = &this->m_SampleMovedGradients[ 0 ];
+  for( unsigned int iDimension = 0; iDimension < FixedImageDimension; iDimension++ )
+  {
+    this->m_MinMovedGradient[ iDimension ] = movedGradient[ iDimension ];
+    this->m_MaxMovedGradient[ iDimension ] = movedGradient[ iDimension ];
+  }
 
-    while( !iterate.IsAtEnd() )
+  for( SizeValueType i = 0; i < numberOfSamples; ++i )
+  {
+    for( unsigned int iDimension = 0; iDimension < FixedImageDimension; iDimension++ )
     {
-      gradient = iterate.Get();
-
-      if( gradient > m_MaxMovedGradient[ iDimension ] )
+      const RealType gradient = *movedGradient++;
+      if( gradient > this->m_MaxMovedGradient[ iDimension ] )
       {
-        m_MaxMovedGradient[ iDimension ] = gradient;
+        this->m_MaxMovedGradient[ iDimension ] = gradient;
       }
 
-      if( gradient < m_MinMovedGradient[ iDimension ] )
+      if( gradient < this->m_MinMovedGradient[ iDimension ] )
       {
-        m_MinMovedGradient[ iDimension ] = gradient;
+        this->m_MinMovedGradient[ iDimension ] = gradient;
       }
-
-      ++iterate;
     }
   }
-}
+
+} // end ComputeMovedGradientRange()
 
 
 /**
@@ -238,17 +164,13 @@ GradientDifferenceImageToImageMetric< TFixedImage, TMovingImage >
     typedef itk::ImageRegionConstIteratorWithIndex<
       FixedGradientImageType > IteratorType;
 
-    IteratorType iterate( this->m_FixedSobelFilters[ iDimension ]->GetOutput(),
+    IteratorType iterate( this->GetFixedGradientImage( iDimension ),
     this->GetFixedImageRegion() );
 
     /** Calculate the mean gradients */
     nPixels            =  0;
-    gradient           = iterate.Get();
     mean[ iDimension ] = 0;
 
-    this->m_MinMovedGradient[ iDimension ] = gradient;
-    this->m_MaxMovedGradient[ iDimension ] = gradient;
-
     typename FixedImageType::IndexType currentIndex;
     typename FixedImageType::PointType point;
     bool sampleOK = false;
@@ -350,105 +272,28 @@ GradientDifferenceImageToImageMetric< TFixedImage, TMovingImage >
 template< class TFixedImage, class TMovingImage >
 typename GradientDifferenceImageToImageMetric< TFixedImage, TMovingImage >::MeasureType
 GradientDifferenceImageToImageMetric< TFixedImage, TMovingImage >
-::ComputeMeasure( const TransformParametersType & parameters,
-  const double * subtractionFactor ) const
+::ComputeMeasure( const RealType * subtractionFactor ) const
 {
-  /** Call non-thread-safe stuff, such as:
-   *   this->SetTransformParameters( parameters );
-   *   this->GetImageSampler()->Update();
-   * Because of these calls GetValueAndDerivative itself is not thread-safe,
-   * so cannot be called multiple times simultaneously.
-   * This is however needed in the CombinationImageToImageMetric.
-   * In that case, you need to:
-   * - switch the use of this function to on, using m_UseMetricSingleThreaded = true
-   * - call BeforeThreadedGetValueAndDerivative once (single-threaded) before
-   *   calling GetValueAndDerivative
-   * - switch the use of this function to off, using m_UseMetricSingleThreaded = false
-   * - Now you can call GetValueAndDerivative multi-threaded.
-   */
-  this->BeforeThreadedGetValueAndDerivative( parameters );
-  //this->SetTransformParameters( parameters );
-
-  unsigned int iDimension;
-  this->m_TransformMovingImageFilter->Modified();
-  this->m_TransformMovingImageFilter->UpdateLargestPossibleRegion();
   MeasureType measure = NumericTraits< MeasureType >::Zero;
 
-  typename FixedImageType::IndexType currentIndex;
-  typename FixedImageType::PointType point;
-
-  for( iDimension = 0; iDimension < FixedImageDimension; iDimension++ )
+  /** Loop over the gradients at the samples, computed in GetValue(). */
+  const SizeValueType numberOfSamples = this->m_NumberOfPixelsCounted;
+  const RealType *    fixedGradient   = &this->m_SampleFixedGradients[ 0 ];
+  const RealType *    movedGradient   = &this->m_SampleMovedGradients[ 0 ];
+  for( SizeValueType i = 0; i < numberOfSamples; ++i )
   {
-
-    if( this->m_Variance[ iDimension ] == NumericTraits< MovedGradientPixelType >::ZeroValue() )
-    {
-      continue;
-    }
-
-    /** Iterate over the fixed and moving gradient images
-     *  calculating the similarity measure
-     */
-
-    MovedGradientPixelType movedGradient;
-    FixedGradientPixelType fixedGradient;
-    MovedGradientPixelType diff;
-
-    typedef  itk::ImageRegionConstIteratorWithIndex< FixedGradientImageType >
-      FixedIteratorType;
-
-    FixedIteratorType fixedIterator( this->m_FixedSobelFilters[ iDimension ]->GetOutput(),
-    this->GetFixedImageRegion() );
-
-    typedef  itk::ImageRegionConstIteratorWithIndex< MovedGradientImageType >
-      MovedIteratorType;
-
-    MovedIteratorType movedIterator( this->m_MovedSobelFilters[ iDimension ]->GetOutput(),
-    this->GetFixedImageRegion() );
-
-    this->m_FixedSobelFilters[ iDimension ]->UpdateLargestPossibleRegion();
-    this->m_MovedSobelFilters[ iDimension ]->UpdateLargestPossibleRegion();
-
-    bool sampleOK = false;
-
-    if( this->m_FixedImageMask.IsNull() )
-    {
-      sampleOK = true;
-    }
-
-    while( !fixedIterator.IsAtEnd() )
+    for( unsigned int iDimension = 0; iDimension < FixedImageDimension; iDimension++ )
     {
-      /** Get current index */
-      currentIndex = fixedIterator.GetIndex();
-      this->m_FixedImage->TransformIndexToPhysicalPoint( currentIndex, point );
-
-      /** if fixedMask is given */
-      if( !this->m_FixedImageMask.IsNull() )
+      const RealType diff = fixedGradient[ iDimension ]
+        - subtractionFactor[ iDimension ] * movedGradient[ iDimension ];
+      if( this->m_Variance[ iDimension ] != NumericTraits< RealType >::ZeroValue() )
       {
-
-        if( this->m_FixedImageMask->IsInside( point ) )   // sample is good
-        {
-          sampleOK = true;
-        }
-        else  // sample no good
-        {
-          sampleOK = false;
-        }
+        measure += this->m_Variance[ iDimension ] / ( this->m_Variance[ iDimension ] + diff * diff );
       }
-
-      if( sampleOK )
-      {
-        movedGradient = movedIterator.Get();
-        fixedGradient = fixedIterator.Get();
-        diff          = fixedGradient - subtractionFactor[ iDimension ] * movedGradient;
-        measure      += this->m_Variance[ iDimension ] / ( this->m_Variance[ iDimension ] + diff * diff );
-
-      } // end if sampleOK
-
-      ++fixedIterator;
-      ++movedIterator;
-    } // end while fixedIterator
-
-  } // end for iDimension
+    }
+    fixedGradient += FixedImageDimension;
+    movedGradient += FixedImageDimension;
+  }
 
   return measure /= -this->m_Rescalingfactor; //negative for minimization
 
@@ -464,33 +309,35 @@ typename GradientDifferenceImageToImageMetric< TFixedImage, TMovingImage >::Meas
 GradientDifferenceImageToImageMetric< TFixedImage, TMovingImage >
 ::GetValue( const TransformParametersType & parameters ) const
 {
-  unsigned int iFilter;
-  unsigned int iDimension;
-  this->SetTransformParameters( parameters );
-  this->m_TransformMovingImageFilter->Modified();
-  this->m_TransformMovingImageFilter->UpdateLargestPossibleRegion();
-
-  /** Update the gradient images */
-  for( iFilter = 0; iFilter < MovedImageDimension; iFilter++ )
-  {
-    this->m_MovedSobelFilters[ iFilter ]->UpdateLargestPossibleRegion();
-  }
+  /** Call non-thread-safe stuff, such as:
+   *   this->SetTransformParameters( parameters );
+   *   this->GetImageSampler()->Update();
+   * Because of these calls GetValueAndDerivative itself is not thread-safe,
+   * so cannot be called multiple times simultaneously.
+   * This is however needed in the CombinationImageToImageMetric.
+   * In that case, you need to:
+   * - switch the use of this function to on, using m_UseMetricSingleThreaded = true
+   * - call BeforeThreadedGetValueAndDerivative once (single-threaded) before
+   *   calling GetValueAndDerivative
+   * - switch the use of this function to off, using m_UseMetricSingleThreaded = false
+   * - Now you can call GetValueAndDerivative multi-threaded.
+   */
+  this->BeforeThreadedGetValueAndDerivative( parameters );
+
+  /** Compute the gradients at the samples only. */
+  this->ComputeSampleGradients();
 
   /** Compute the range of the moved image gradients */
   this->ComputeMovedGradientRange();
 
-  MovedGradientPixelType subtractionFactor[ FixedImageDimension ];
-  MeasureType            currentMeasure;
-
-  for( iDimension = 0; iDimension < FixedImageDimension; iDimension++ )
+  RealType subtractionFactor[ FixedImageDimension ];
+  for( unsigned int iDimension = 0; iDimension < FixedImageDimension; iDimension++ )
   {
     subtractionFactor[ iDimension ] = this->m_MaxFixedGradient[ iDimension ]
       / this->m_MaxMovedGradient[ iDimension ];
   }
 
-  currentMeasure = this->ComputeMeasure( parameters, subtractionFactor );
-
-  return currentMeasure;
+  return this->ComputeMeasure( subtractionFactor );
 
 } // end GetValue()
 
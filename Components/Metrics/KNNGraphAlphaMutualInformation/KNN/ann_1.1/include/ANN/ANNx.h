@@ -48,6 +48,15 @@ enum  {ANN_IN=0, ANN_OUT=1};  // shrinking indices
                 // what to do in case of error
 enum ANNerr {ANNwarn = 0, ANNabort = 1};
 
+//----------------------------------------------------------------------
+//  Thread-local storage
+//    The search routines keep their state in global variables. These
+//    are declared ELASTIX_THREAD_LOCAL, so that multiple threads can
+//    search (the same or different) trees concurrently.
+//----------------------------------------------------------------------
+
+#include "elxThreadLocal.h"
+
 //----------------------------------------------------------------------
 //  Maximum number of points to visit
 //  We have an option for terminating the search early if the
@@ -57,7 +66,7 @@ enum ANNerr {ANNwarn = 0, ANNabort = 1};
 //----------------------------------------------------------------------
 
 extern int    ANNmaxPtsVisited; // maximum number of pts visited
-extern int    ANNptsVisited;    // number of pts visited in search
+extern ELASTIX_THREAD_LOCAL int ANNptsVisited; // number of pts visited in search
 
 //----------------------------------------------------------------------
 //  Global function declarations
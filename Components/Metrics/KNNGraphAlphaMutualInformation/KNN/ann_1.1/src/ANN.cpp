@@ -187,7 +187,7 @@ void annError( const std::string & msg, ANNerr level )
 //----------------------------------------------------------------------
 
 int ANNmaxPtsVisited = 0; // maximum number of pts visited
-int ANNptsVisited;      // number of pts visited in search
+ELASTIX_THREAD_LOCAL int ANNptsVisited; // number of pts visited in search
 
 //----------------------------------------------------------------------
 //  Global function declarations
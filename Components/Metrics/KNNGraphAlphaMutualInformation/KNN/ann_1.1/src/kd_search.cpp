@@ -76,11 +76,11 @@
 //    These are given below.
 //----------------------------------------------------------------------
 
-int       ANNkdDim;       // dimension of space
-ANNpoint    ANNkdQ;         // query point
-double      ANNkdMaxErr;      // max tolerable squared error
-ANNpointArray ANNkdPts;       // the points
-ANNmin_k    *ANNkdPointMK;      // set of k closest points
+ELASTIX_THREAD_LOCAL int       ANNkdDim;       // dimension of space
+ELASTIX_THREAD_LOCAL ANNpoint    ANNkdQ;         // query point
+ELASTIX_THREAD_LOCAL double      ANNkdMaxErr;      // max tolerable squared error
+ELASTIX_THREAD_LOCAL ANNpointArray ANNkdPts;       // the points
+ELASTIX_THREAD_LOCAL ANNmin_k    *ANNkdPointMK;      // set of k closest points
 
 //----------------------------------------------------------------------
 //  annkSearch - search for the k nearest neighbors
@@ -24,7 +24,8 @@
 namespace itk
 {
 
-unsigned int ANNBinaryTreeCreator::m_NumberOfANNBinaryTrees = 0;
+unsigned int        ANNBinaryTreeCreator::m_NumberOfANNBinaryTrees = 0;
+SimpleFastMutexLock ANNBinaryTreeCreator::m_ReferenceCountMutex;
 
 /**
  * ************************ CreateANNkDTree *************************
@@ -106,7 +107,18 @@ ANNBinaryTreeCreator::DeleteANNBruteForceTree( ANNBruteForceTreeType * & tree )
 void
 ANNBinaryTreeCreator::IncreaseReferenceCount( void )
 {
+  m_ReferenceCountMutex.Lock();
+  if( m_NumberOfANNBinaryTrees == 0 )
+  {
+    /** ANN lazily allocates a global trivial leaf node when the first
+     * kd-tree is constructed. Force that allocation here, under the lock,
+     * so that several trees can be constructed concurrently afterwards.
+     */
+    ANNkDTreeType * skeleton = new ANNkd_tree( 0, 1, 1 );
+    delete skeleton;
+  }
   m_NumberOfANNBinaryTrees++;
+  m_ReferenceCountMutex.Unlock();
 } // end IncreaseReferenceCount
 
 
@@ -117,11 +129,13 @@ ANNBinaryTreeCreator::IncreaseReferenceCount( void )
 void
 ANNBinaryTreeCreator::DecreaseReferenceCount( void )
 {
+  m_ReferenceCountMutex.Lock();
   m_NumberOfANNBinaryTrees--;
   if( m_NumberOfANNBinaryTrees == 0 )
   {
     annClose();
   }
+  m_ReferenceCountMutex.Unlock();
 } // end DecreaseReferenceCount
 
 
@@ -70,6 +70,11 @@ namespace elastix
  * \parameter AvoidDivisionBy: a small number to avoid division by zero in the implentation. \n
  *    <tt>(AvoidDivisionBy 0.000000001)</tt> \n
  *    The default is 1e-5.
+ * \parameter ParallelKNNTreeBuild: build the fixed, moving and joint kNN trees
+ *    concurrently. This pays off for large numbers of samples, and is only used
+ *    when multi-threading is enabled. \n
+ *    <tt>(ParallelKNNTreeBuild "false" "true" "true")</tt> \n
+ *    The default is "false" for all resolutions.
  *
  * \warning Note that we assume the FixedFeatureImageType to have the same
  * pixeltype as the FixedImageType
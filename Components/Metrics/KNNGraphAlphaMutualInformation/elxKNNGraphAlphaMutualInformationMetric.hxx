@@ -237,6 +237,12 @@ KNNGraphAlphaMutualInformationMetric< TElastix >
                        << treeSearchType << "\" implemented." );
   }
 
+  /** Check if the kNN trees should be built concurrently. */
+  bool parallelTreeBuild = false;
+  this->m_Configuration->ReadParameter( parallelTreeBuild,
+    "ParallelKNNTreeBuild", this->GetComponentLabel(), level, 0 );
+  this->SetUseParallelTreeBuild( parallelTreeBuild );
+
 } // end BeforeEachResolution()
 
 
@@ -247,6 +247,14 @@ public:
   /** Avoid division by a small number. */
   itkGetConstReferenceMacro( AvoidDivisionBy, double );
 
+  /** Build the fixed, moving and joint kNN trees concurrently, each in its
+   * own thread. This pays off for large numbers of samples. Only used when
+   * multi-threading is switched on. Default: false.
+   */
+  itkSetMacro( UseParallelTreeBuild, bool );
+  itkGetConstReferenceMacro( UseParallelTreeBuild, bool );
+  itkBooleanMacro( UseParallelTreeBuild );
+
 protected:
 
   /** Constructor. */
@@ -258,6 +266,39 @@ protected:
   /** PrintSelf. */
   virtual void PrintSelf( std::ostream & os, Indent indent ) const;
 
+  /** Typedefs for multi-threading. */
+  typedef typename Superclass::ThreadInfoType             ThreadInfoType;
+  typedef typename Superclass::MultiThreaderParameterType MultiThreaderParameterType;
+
+  /** Get value single-threaded. */
+  MeasureType GetValueSingleThreaded( const TransformParametersType & parameters ) const;
+
+  /** Get value and derivatives single-threaded. */
+  void GetValueAndDerivativeSingleThreaded( const TransformParametersType & parameters,
+    MeasureType & value, DerivativeType & derivative ) const;
+
+  /** Get value for each thread: search the neighbours of a part of the query points. */
+  inline void ThreadedGetValue( ThreadIdType threadID );
+
+  /** Gather the values from all threads. */
+  inline void AfterThreadedGetValue( MeasureType & value ) const;
+
+  /** Get value and derivatives for each thread. */
+  inline void ThreadedGetValueAndDerivative( ThreadIdType threadID );
+
+  /** Gather the values and derivatives from all threads. */
+  inline void AfterThreadedGetValueAndDerivative(
+    MeasureType & value, DerivativeType & derivative ) const;
+
+  /** Generate the three kNN trees from the list samples, and connect
+   * them to the searchers. The trees are generated concurrently when
+   * m_UseParallelTreeBuild is true and multi-threading is switched on.
+   */
+  void GenerateTreesAndConnectSearchers( void ) const;
+
+  /** Threader callback that generates one or more of the three trees. */
+  static ITK_THREAD_RETURN_TYPE GenerateTreesThreaderCallback( void * arg );
+
   /** Member variables. */
   BinaryKNNTreePointer m_BinaryKNNTreeFixed;
   BinaryKNNTreePointer m_BinaryKNNTreeMoving;
@@ -269,6 +310,7 @@ protected:
 
   double m_Alpha;
   double m_AvoidDivisionBy;
+  bool   m_UseParallelTreeBuild;
 
 private:
 
@@ -286,6 +328,16 @@ private:
   typedef Array2D< double >                         SpatialDerivativeType;
   typedef std::vector< SpatialDerivativeType >      SpatialDerivativeContainerType;
 
+  /** The list samples and derivative information of the current iteration.
+   * They are members so that they can be shared by the threads.
+   */
+  mutable ListSamplePointer                     m_ListSampleFixed;
+  mutable ListSamplePointer                     m_ListSampleMoving;
+  mutable ListSamplePointer                     m_ListSampleJoint;
+  mutable TransformJacobianContainerType        m_JacobianContainer;
+  mutable TransformJacobianIndicesContainerType m_JacobianIndicesContainer;
+  mutable SpatialDerivativeContainerType        m_SpatialDerivativesContainer;
+
   /** This function takes the fixed image samples from the ImageSampler
    * and puts them in the listSampleFixed, together with the fixed feature
    * image samples. Also the corresponding moving image values and moving
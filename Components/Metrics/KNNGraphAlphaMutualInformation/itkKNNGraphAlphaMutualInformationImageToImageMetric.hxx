@@ -36,6 +36,8 @@ KNNGraphAlphaMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
   this->m_Alpha           = 0.99;
   this->m_AvoidDivisionBy = 1e-10;
 
+  this->m_UseParallelTreeBuild = false;
+
   this->m_BinaryKNNTreeFixed  = 0;
   this->m_BinaryKNNTreeMoving = 0;
   this->m_BinaryKNNTreeJoint  = 0;
@@ -293,13 +295,13 @@ KNNGraphAlphaMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
 
 
 /**
- * ************************ GetValue *************************
+ * ************************ GetValueSingleThreaded *************************
  */
 
 template< class TFixedImage, class TMovingImage >
 typename KNNGraphAlphaMutualInformationImageToImageMetric< TFixedImage, TMovingImage >::MeasureType
 KNNGraphAlphaMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
-::GetValue( const TransformParametersType & parameters ) const
+::GetValueSingleThreaded( const TransformParametersType & parameters ) const
 {
   /** Initialize some variables. */
   MeasureType measure = NumericTraits< MeasureType >::Zero;
@@ -477,9 +479,169 @@ KNNGraphAlphaMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
   /** Return the negative alpha - mutual information. */
   return -measure;
 
+} // end GetValueSingleThreaded()
+
+
+/**
+ * ************************ GetValue *************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+typename KNNGraphAlphaMutualInformationImageToImageMetric< TFixedImage, TMovingImage >::MeasureType
+KNNGraphAlphaMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
+::GetValue( const TransformParametersType & parameters ) const
+{
+  /** Option for now to still use the single threaded code. */
+  if( !this->m_UseMultiThread )
+  {
+    return this->GetValueSingleThreaded( parameters );
+  }
+
+  /** Make sure the transform parameters are up to date. */
+  this->SetTransformParameters( parameters );
+
+  /** Compute the three list samples. This is done single-threaded, since
+   * all queries need the complete list samples.
+   */
+  this->m_ListSampleFixed  = ListSampleType::New();
+  this->m_ListSampleMoving = ListSampleType::New();
+  this->m_ListSampleJoint  = ListSampleType::New();
+  this->ComputeListSampleValuesAndDerivativePlusJacobian(
+    this->m_ListSampleFixed, this->m_ListSampleMoving, this->m_ListSampleJoint,
+    false, this->m_JacobianContainer, this->m_JacobianIndicesContainer,
+    this->m_SpatialDerivativesContainer );
+
+  /** Check if enough samples were valid. */
+  unsigned long size = this->GetImageSampler()->GetOutput()->Size();
+  this->CheckNumberOfSamples( size, this->m_NumberOfPixelsCounted );
+
+  /** Generate the three trees and connect them to the searchers. */
+  this->GenerateTreesAndConnectSearchers();
+
+  /** Launch multi-threading metric: each thread handles a part of the query points. */
+  this->LaunchGetValueThreaderCallback();
+
+  /** Gather the metric values from all threads. */
+  MeasureType value = NumericTraits< MeasureType >::Zero;
+  this->AfterThreadedGetValue( value );
+
+  return value;
+
 } // end GetValue()
 
 
+/**
+ * ******************* ThreadedGetValue *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+KNNGraphAlphaMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
+::ThreadedGetValue( ThreadIdType threadId )
+{
+  /** Get the query points for this thread. */
+  const unsigned long numberOfQueryPoints = this->m_NumberOfPixelsCounted;
+  const unsigned long nrOfQueryPointsPerThread
+    = static_cast< unsigned long >( vcl_ceil( static_cast< double >( numberOfQueryPoints )
+    / static_cast< double >( this->m_NumberOfThreads ) ) );
+
+  unsigned long pos_begin = nrOfQueryPointsPerThread * threadId;
+  unsigned long pos_end   = nrOfQueryPointsPerThread * ( threadId + 1 );
+  pos_begin = ( pos_begin > numberOfQueryPoints ) ? numberOfQueryPoints : pos_begin;
+  pos_end   = ( pos_end > numberOfQueryPoints ) ? numberOfQueryPoints : pos_end;
+
+  /** Temporary variables. */
+  typedef typename NumericTraits< MeasureType >::AccumulateType AccumulateType;
+  MeasurementVectorType z_F, z_M, z_J;
+  IndexArrayType        indices_F, indices_M, indices_J;
+  DistanceArrayType     distances_F, distances_M, distances_J;
+
+  MeasureType    H, G;
+  AccumulateType sumG = NumericTraits< AccumulateType >::Zero;
+
+  /** Get the size of the feature vectors. */
+  const unsigned int fixedSize  = this->GetNumberOfFixedImages();
+  const unsigned int movingSize = this->GetNumberOfMovingImages();
+  const unsigned int jointSize  = fixedSize + movingSize;
+
+  /** Get the number of neighbours and \gamma. */
+  const unsigned int k        = this->m_BinaryKNNTreeSearcherFixed->GetKNearestNeighbors();
+  const double       twoGamma = jointSize * ( 1.0 - this->m_Alpha );
+
+  /** Loop over the query points of this thread. See GetValueSingleThreaded(). */
+  for( unsigned long i = pos_begin; i < pos_end; ++i )
+  {
+    /** Get the i-th query point. */
+    this->m_ListSampleFixed->GetMeasurementVector(  i, z_F );
+    this->m_ListSampleMoving->GetMeasurementVector( i, z_M );
+    this->m_ListSampleJoint->GetMeasurementVector(  i, z_J );
+
+    /** Search for the K nearest neighbours of the current query point. */
+    this->m_BinaryKNNTreeSearcherFixed->Search(  z_F, indices_F, distances_F );
+    this->m_BinaryKNNTreeSearcherMoving->Search( z_M, indices_M, distances_M );
+    this->m_BinaryKNNTreeSearcherJoint->Search(  z_J, indices_J, distances_J );
+
+    /** Add the distances of all neighbours of the query point. */
+    AccumulateType Gamma_F = NumericTraits< AccumulateType >::Zero;
+    AccumulateType Gamma_M = NumericTraits< AccumulateType >::Zero;
+    AccumulateType Gamma_J = NumericTraits< AccumulateType >::Zero;
+    for( unsigned int p = 0; p < k; p++ )
+    {
+      Gamma_F += vcl_sqrt( distances_F[ p ] );
+      Gamma_M += vcl_sqrt( distances_M[ p ] );
+      Gamma_J += vcl_sqrt( distances_J[ p ] );
+    }
+
+    /** Calculate the contribution of this query point. */
+    H = vcl_sqrt( Gamma_F * Gamma_M );
+    if( H > this->m_AvoidDivisionBy )
+    {
+      G     = Gamma_J / H;
+      sumG += vcl_pow( G, twoGamma );
+    }
+  } // end looping over the query points
+
+  /** Only update these variables at the end to prevent unnecessary "false sharing". */
+  this->m_GetValuePerThreadVariables[ threadId ].st_Value = sumG;
+
+} // end ThreadedGetValue()
+
+
+/**
+ * ******************* AfterThreadedGetValue *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+KNNGraphAlphaMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
+::AfterThreadedGetValue( MeasureType & value ) const
+{
+  /** Accumulate the sums of all threads. */
+  typedef typename NumericTraits< MeasureType >::AccumulateType AccumulateType;
+  AccumulateType sumG = NumericTraits< AccumulateType >::Zero;
+  for( ThreadIdType i = 0; i < this->m_NumberOfThreads; ++i )
+  {
+    sumG += this->m_GetValuePerThreadVariables[ i ].st_Value;
+
+    /** Reset this variable for the next iteration. */
+    this->m_GetValuePerThreadVariables[ i ].st_Value = NumericTraits< MeasureType >::Zero;
+  }
+
+  /** Calculate the metric value \alpha MI. */
+  MeasureType measure = NumericTraits< MeasureType >::Zero;
+  if( sumG > this->m_AvoidDivisionBy )
+  {
+    const double n      = static_cast< double >( this->m_NumberOfPixelsCounted );
+    const double number = vcl_pow( n, this->m_Alpha );
+    measure = vcl_log( sumG / number ) / ( this->m_Alpha - 1.0 );
+  }
+
+  /** Return the negative alpha - mutual information. */
+  value = -measure;
+
+} // end AfterThreadedGetValue()
+
+
 /**
  * ************************ GetDerivative *************************
  */
@@ -503,13 +665,13 @@ KNNGraphAlphaMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
 
 
 /**
- * ************************ GetValueAndDerivative *************************
+ * ************************ GetValueAndDerivativeSingleThreaded *************************
  */
 
 template< class TFixedImage, class TMovingImage >
 void
 KNNGraphAlphaMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
-::GetValueAndDerivative(
+::GetValueAndDerivativeSingleThreaded(
   const TransformParametersType & parameters,
   MeasureType & value,
   DerivativeType & derivative ) const
@@ -734,9 +896,327 @@ KNNGraphAlphaMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
   }
   value = -measure;
 
+} // end GetValueAndDerivativeSingleThreaded()
+
+
+/**
+ * ************************ GetValueAndDerivative *************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+KNNGraphAlphaMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
+::GetValueAndDerivative(
+  const TransformParametersType & parameters,
+  MeasureType & value,
+  DerivativeType & derivative ) const
+{
+  /** Option for now to still use the single threaded code. */
+  if( !this->m_UseMultiThread )
+  {
+    return this->GetValueAndDerivativeSingleThreaded(
+      parameters, value, derivative );
+  }
+
+  /** Call non-thread-safe stuff, such as:
+   *   this->SetTransformParameters( parameters );
+   *   this->GetImageSampler()->Update();
+   * See GetValueAndDerivativeSingleThreaded().
+   */
+  this->BeforeThreadedGetValueAndDerivative( parameters );
+
+  /** Compute the three list samples and the derivatives. This is done
+   * single-threaded, since all queries need the complete list samples.
+   */
+  this->m_ListSampleFixed  = ListSampleType::New();
+  this->m_ListSampleMoving = ListSampleType::New();
+  this->m_ListSampleJoint  = ListSampleType::New();
+  this->ComputeListSampleValuesAndDerivativePlusJacobian(
+    this->m_ListSampleFixed, this->m_ListSampleMoving, this->m_ListSampleJoint,
+    true, this->m_JacobianContainer, this->m_JacobianIndicesContainer,
+    this->m_SpatialDerivativesContainer );
+
+  /** Check if enough samples were valid. */
+  unsigned long size = this->GetImageSampler()->GetOutput()->Size();
+  this->CheckNumberOfSamples( size, this->m_NumberOfPixelsCounted );
+
+  /** Generate the three trees and connect them to the searchers. */
+  this->GenerateTreesAndConnectSearchers();
+
+  /** Launch multi-threading metric: each thread handles a part of the query points. */
+  this->LaunchGetValueAndDerivativeThreaderCallback();
+
+  /** Gather the metric values and derivatives from all threads. */
+  this->AfterThreadedGetValueAndDerivative( value, derivative );
+
 } // end GetValueAndDerivative()
 
 
+/**
+ * ******************* ThreadedGetValueAndDerivative *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+KNNGraphAlphaMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
+::ThreadedGetValueAndDerivative( ThreadIdType threadId )
+{
+  /** Get a handle to the pre-allocated derivative for the current thread.
+   * It accumulates the unnormalized contributions of the query points
+   * of this thread, and is reset in AccumulateDerivativesThreaderCallback().
+   */
+  DerivativeType & contribution = this->m_GetValueAndDerivativePerThreadVariables[ threadId ].st_Derivative;
+
+  /** Get the query points for this thread. */
+  const unsigned long numberOfQueryPoints = this->m_NumberOfPixelsCounted;
+  const unsigned long nrOfQueryPointsPerThread
+    = static_cast< unsigned long >( vcl_ceil( static_cast< double >( numberOfQueryPoints )
+    / static_cast< double >( this->m_NumberOfThreads ) ) );
+
+  unsigned long pos_begin = nrOfQueryPointsPerThread * threadId;
+  unsigned long pos_end   = nrOfQueryPointsPerThread * ( threadId + 1 );
+  pos_begin = ( pos_begin > numberOfQueryPoints ) ? numberOfQueryPoints : pos_begin;
+  pos_end   = ( pos_end > numberOfQueryPoints ) ? numberOfQueryPoints : pos_end;
+
+  /** Temporary variables. */
+  typedef typename NumericTraits< MeasureType >::AccumulateType AccumulateType;
+  MeasurementVectorType z_F, z_M, z_J, z_M_ip, z_J_ip, diff_M, diff_J;
+  IndexArrayType        indices_F,   indices_M,   indices_J;
+  DistanceArrayType     distances_F, distances_M, distances_J;
+  MeasureType           distance_F,  distance_M,  distance_J;
+
+  MeasureType    H, G, Gpow;
+  AccumulateType sumG = NumericTraits< AccumulateType >::Zero;
+
+  DerivativeType dGamma_M( this->GetNumberOfParameters() );
+  DerivativeType dGamma_J( this->GetNumberOfParameters() );
+
+  /** Get the size of the feature vectors. */
+  const unsigned int fixedSize  = this->GetNumberOfFixedImages();
+  const unsigned int movingSize = this->GetNumberOfMovingImages();
+  const unsigned int jointSize  = fixedSize + movingSize;
+
+  /** Get the number of neighbours and \gamma. */
+  const unsigned int k        = this->m_BinaryKNNTreeSearcherFixed->GetKNearestNeighbors();
+  const double       twoGamma = jointSize * ( 1.0 - this->m_Alpha );
+
+  /** Loop over the query points of this thread. See GetValueAndDerivativeSingleThreaded(). */
+  for( unsigned long i = pos_begin; i < pos_end; ++i )
+  {
+    /** Get the i-th query point. */
+    this->m_ListSampleFixed->GetMeasurementVector(  i, z_F );
+    this->m_ListSampleMoving->GetMeasurementVector( i, z_M );
+    this->m_ListSampleJoint->GetMeasurementVector(  i, z_J );
+
+    /** Search for the k nearest neighbours of the current query point. */
+    this->m_BinaryKNNTreeSearcherFixed->Search(  z_F, indices_F, distances_F );
+    this->m_BinaryKNNTreeSearcherMoving->Search( z_M, indices_M, distances_M );
+    this->m_BinaryKNNTreeSearcherJoint->Search(  z_J, indices_J, distances_J );
+
+    /** Variables to compute the measure and its derivative. */
+    AccumulateType Gamma_F = NumericTraits< AccumulateType >::Zero;
+    AccumulateType Gamma_M = NumericTraits< AccumulateType >::Zero;
+    AccumulateType Gamma_J = NumericTraits< AccumulateType >::Zero;
+
+    SpatialDerivativeType D1sparse, D2sparse_M, D2sparse_J;
+    D1sparse = this->m_SpatialDerivativesContainer[ i ] * this->m_JacobianContainer[ i ];
+
+    dGamma_M.Fill( NumericTraits< DerivativeValueType >::ZeroValue() );
+    dGamma_J.Fill( NumericTraits< DerivativeValueType >::ZeroValue() );
+
+    /** Loop over the neighbours. */
+    for( unsigned int p = 0; p < k; p++ )
+    {
+      /** Get the neighbour point z_ip^M. */
+      this->m_ListSampleMoving->GetMeasurementVector( indices_M[ p ], z_M_ip );
+      this->m_ListSampleMoving->GetMeasurementVector( indices_J[ p ], z_J_ip );
+
+      /** Get the distances. */
+      distance_F = vcl_sqrt( distances_F[ p ] );
+      distance_M = vcl_sqrt( distances_M[ p ] );
+      distance_J = vcl_sqrt( distances_J[ p ] );
+
+      /** Compute Gamma's. */
+      Gamma_F += distance_F;
+      Gamma_M += distance_M;
+      Gamma_J += distance_J;
+
+      /** Get the difference of z_ip^M with z_i^M. */
+      diff_M = z_M - z_M_ip;
+      diff_J = z_M - z_J_ip;
+
+      /** Compute derivatives. */
+      D2sparse_M = this->m_SpatialDerivativesContainer[ indices_M[ p ] ]
+        * this->m_JacobianContainer[ indices_M[ p ] ];
+      D2sparse_J = this->m_SpatialDerivativesContainer[ indices_J[ p ] ]
+        * this->m_JacobianContainer[ indices_J[ p ] ];
+
+      /** Update the dGamma's. */
+      this->UpdateDerivativeOfGammas(
+        D1sparse, D2sparse_M, D2sparse_J,
+        this->m_JacobianIndicesContainer[ i ],
+        this->m_JacobianIndicesContainer[ indices_M[ p ] ],
+        this->m_JacobianIndicesContainer[ indices_J[ p ] ],
+        diff_M, diff_J,
+        distance_M, distance_J,
+        dGamma_M, dGamma_J );
+
+    } // end loop over the k neighbours
+
+    /** Compute contributions. */
+    H = vcl_sqrt( Gamma_F * Gamma_M );
+    if( H > this->m_AvoidDivisionBy )
+    {
+      /** Compute some sums. */
+      G     = Gamma_J / H;
+      sumG += vcl_pow( G, twoGamma );
+
+      /** Compute the contribution to the derivative. */
+      Gpow          = vcl_pow( G, twoGamma - 1.0 );
+      contribution += ( Gpow / H ) * ( dGamma_J - ( 0.5 * Gamma_J / Gamma_M ) * dGamma_M );
+    }
+
+  } // end looping over the query points
+
+  /** Only update these variables at the end to prevent unnecessary "false sharing". */
+  this->m_GetValueAndDerivativePerThreadVariables[ threadId ].st_Value = sumG;
+
+} // end ThreadedGetValueAndDerivative()
+
+
+/**
+ * ******************* AfterThreadedGetValueAndDerivative *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+KNNGraphAlphaMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
+::AfterThreadedGetValueAndDerivative(
+  MeasureType & value, DerivativeType & derivative ) const
+{
+  /** Accumulate the sums of all threads. */
+  typedef typename NumericTraits< MeasureType >::AccumulateType AccumulateType;
+  AccumulateType sumG = NumericTraits< AccumulateType >::Zero;
+  for( ThreadIdType i = 0; i < this->m_NumberOfThreads; ++i )
+  {
+    sumG += this->m_GetValueAndDerivativePerThreadVariables[ i ].st_Value;
+
+    /** Reset this variable for the next iteration. */
+    this->m_GetValueAndDerivativePerThreadVariables[ i ].st_Value = NumericTraits< MeasureType >::Zero;
+  }
+
+  /** The derivative is ( jointSize / sumG ) * contribution, where the
+   * contribution is summed over all threads.
+   */
+  const unsigned int jointSize
+    = this->GetNumberOfFixedImages() + this->GetNumberOfMovingImages();
+  const bool sumIsValid = sumG > this->m_AvoidDivisionBy;
+
+  /** Accumulate the contributions multi-threadedly. This also resets the
+   * per-thread derivatives, so it is done even if sumG is too small.
+   */
+  derivative = DerivativeType( this->GetNumberOfParameters() );
+  this->m_ThreaderMetricParameters.st_DerivativePointer   = derivative.begin();
+  this->m_ThreaderMetricParameters.st_NormalizationFactor
+    = sumIsValid ? sumG / static_cast< AccumulateType >( jointSize ) : 1.0;
+
+  /** Launch the threads of the persistent thread pool. */
+  PersistentThreadPool::SingleMethodExecute( this->AccumulateDerivativesThreaderCallback,
+    const_cast< void * >( static_cast< const void * >( &this->m_ThreaderMetricParameters ) ),
+    this->m_Threader->GetNumberOfThreads() );
+
+  /** Compute the value. */
+  MeasureType measure = NumericTraits< MeasureType >::Zero;
+  if( sumIsValid )
+  {
+    const double n      = static_cast< double >( this->m_NumberOfPixelsCounted );
+    const double number = vcl_pow( n, this->m_Alpha );
+    measure = vcl_log( sumG / number ) / ( this->m_Alpha - 1.0 );
+  }
+  else
+  {
+    derivative.Fill( NumericTraits< DerivativeValueType >::ZeroValue() );
+  }
+  value = -measure;
+
+} // end AfterThreadedGetValueAndDerivative()
+
+
+/**
+ * ************************ GenerateTreesAndConnectSearchers *************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+KNNGraphAlphaMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
+::GenerateTreesAndConnectSearchers( void ) const
+{
+  /** Set the samples of the three trees. */
+  this->m_BinaryKNNTreeFixed->SetSample( this->m_ListSampleFixed );
+  this->m_BinaryKNNTreeMoving->SetSample( this->m_ListSampleMoving );
+  this->m_BinaryKNNTreeJoint->SetSample( this->m_ListSampleJoint );
+
+  /** Generate the trees, possibly concurrently. The ANN trees are independent,
+   * and the reference counting in ANNBinaryTreeCreator is thread-safe.
+   */
+  if( this->m_UseMultiThread && this->m_UseParallelTreeBuild )
+  {
+    /** Launch the threads of the persistent thread pool. */
+    PersistentThreadPool::SingleMethodExecute( this->GenerateTreesThreaderCallback,
+      const_cast< void * >( static_cast< const void * >( &this->m_ThreaderMetricParameters ) ),
+      this->m_Threader->GetNumberOfThreads() );
+  }
+  else
+  {
+    this->m_BinaryKNNTreeFixed->GenerateTree();
+    this->m_BinaryKNNTreeMoving->GenerateTree();
+    this->m_BinaryKNNTreeJoint->GenerateTree();
+  }
+
+  /** Initialize tree searchers. */
+  this->m_BinaryKNNTreeSearcherFixed
+  ->SetBinaryTree( this->m_BinaryKNNTreeFixed );
+  this->m_BinaryKNNTreeSearcherMoving
+  ->SetBinaryTree( this->m_BinaryKNNTreeMoving );
+  this->m_BinaryKNNTreeSearcherJoint
+  ->SetBinaryTree( this->m_BinaryKNNTreeJoint );
+
+} // end GenerateTreesAndConnectSearchers()
+
+
+/**
+ * **************** GenerateTreesThreaderCallback *******
+ */
+
+template< class TFixedImage, class TMovingImage >
+ITK_THREAD_RETURN_TYPE
+KNNGraphAlphaMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
+::GenerateTreesThreaderCallback( void * arg )
+{
+  ThreadInfoType * infoStruct  = static_cast< ThreadInfoType * >( arg );
+  ThreadIdType     threadID    = infoStruct->ThreadID;
+  ThreadIdType     nrOfThreads = infoStruct->NumberOfThreads;
+
+  MultiThreaderParameterType * temp
+    = static_cast< MultiThreaderParameterType * >( infoStruct->UserData );
+  Self * metric = static_cast< Self * >( temp->st_Metric );
+
+  /** Distribute the three trees over the available threads. */
+  BinaryKNNTreeType * trees[ 3 ] = {
+    metric->m_BinaryKNNTreeFixed.GetPointer(),
+    metric->m_BinaryKNNTreeMoving.GetPointer(),
+    metric->m_BinaryKNNTreeJoint.GetPointer()
+  };
+  for( ThreadIdType i = threadID; i < 3; i += nrOfThreads )
+  {
+    trees[ i ]->GenerateTree();
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end GenerateTreesThreaderCallback()
+
+
 /**
  * ************************ ComputeListSampleValuesAndDerivativePlusJacobian *************************
  */
@@ -1089,6 +1569,7 @@ KNNGraphAlphaMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
 
   os << indent << "Alpha: " << this->m_Alpha << std::endl;
   os << indent << "AvoidDivisionBy: " << this->m_AvoidDivisionBy << std::endl;
+  os << indent << "UseParallelTreeBuild: " << this->m_UseParallelTreeBuild << std::endl;
 
   os << indent << "BinaryKNNTreeFixed: "
      << this->m_BinaryKNNTreeFixed.GetPointer() << std::endl;
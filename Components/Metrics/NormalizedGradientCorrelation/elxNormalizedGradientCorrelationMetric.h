@@ -28,6 +28,8 @@ namespace elastix
  * \class NormalizedGradientCorrelationMetric
  * \brief An metric based on the itk::NormalizedGradientCorrelationImageToImageMetric.
  *
+ * The metric is computed at the samples of the ImageSampler. When no
+ * ImageSampler is specified, all voxels of the fixed image are used.
  *
  * \ingroup Metrics
  *
@@ -127,6 +129,11 @@ public:
   typedef typename Superclass2::RegistrationPointer  RegistrationPointer;
   typedef typename Superclass2::ITKBaseType          ITKBaseType;
 
+  /** Use the image sampler, if one is specified in the parameter file.
+   * Otherwise the metric is computed at all voxels of the fixed image.
+   */
+  virtual int BeforeAll( void );
+
   /** Sets up a timer to measure the initialization time and
    * calls the Superclass' implementation.
    */
@@ -18,15 +18,8 @@
 #ifndef __itkNormalizedGradientCorrelationImageToImageMetric_h
 #define __itkNormalizedGradientCorrelationImageToImageMetric_h
 
-#include "itkAdvancedImageToImageMetric.h"
-#include "itkSobelOperator.h"
-#include "itkNeighborhoodOperatorImageFilter.h"
-#include "itkPoint.h"
-#include "itkCastImageFilter.h"
-#include "itkResampleImageFilter.h"
+#include "itkRayCastGradientImageToImageMetric.h"
 #include "itkOptimizer.h"
-#include "itkAdvancedCombinationTransform.h"
-#include "itkAdvancedRayCastInterpolateImageFunction.h"
 
 namespace itk
 {
@@ -35,6 +28,10 @@ namespace itk
  * \class NormalizedGradientCorrelationImageToImageMetric
  * \brief An metric based on the itk::NormalizedGradientCorrelationImageToImageMetric.
  *
+ * The metric is the normalized cross correlation of the Sobel gradients of
+ * the fixed image and of the projection of the moving image. The gradients
+ * are only computed at the samples of the image sampler, see
+ * RayCastGradientImageToImageMetric.
  *
  * \ingroup Metrics
  *
@@ -42,21 +39,21 @@ namespace itk
 
 template< class TFixedImage, class TMovingImage >
 class NormalizedGradientCorrelationImageToImageMetric :
-  public AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+  public RayCastGradientImageToImageMetric< TFixedImage, TMovingImage >
 {
 public:
 
   /** Standard class typedefs. */
-  typedef NormalizedGradientCorrelationImageToImageMetric         Self;
-  typedef AdvancedImageToImageMetric< TFixedImage, TMovingImage > Superclass;
-  typedef SmartPointer< Self >                                    Pointer;
-  typedef SmartPointer< const Self >                              ConstPointer;
+  typedef NormalizedGradientCorrelationImageToImageMetric                Self;
+  typedef RayCastGradientImageToImageMetric< TFixedImage, TMovingImage > Superclass;
+  typedef SmartPointer< Self >                                           Pointer;
+  typedef SmartPointer< const Self >                                     ConstPointer;
 
   /** Method for creation through the object factory. */
   itkNewMacro( Self );
 
   /** Run-time type information (and related methods). */
-  itkTypeMacro( NormalizedGradientCorrelationImageToImageMetric, AdvancedImageToImageMetric );
+  itkTypeMacro( NormalizedGradientCorrelationImageToImageMetric, RayCastGradientImageToImageMetric );
 
   /** Types transferred from the base class */
   /** Work around a Visual Studio .NET bug */
@@ -68,21 +65,13 @@ public:
 
   typedef typename Superclass::TransformType           TransformType;
   typedef typename TransformType::ScalarType           ScalarType;
-  typedef typename Superclass::TransformPointer        TransformPointer;
-  typedef typename TransformType::ConstPointer         TransformConstPointer;
   typedef typename Superclass::TransformParametersType TransformParametersType;
-  typedef typename Superclass::TransformJacobianType   TransformJacobianType;
   typedef typename Superclass::InterpolatorType        InterpolatorType;
-  typedef typename InterpolatorType::Pointer           InterpolatorPointer;
   typedef typename Superclass::MeasureType             MeasureType;
   typedef typename Superclass::DerivativeType          DerivativeType;
   typedef typename Superclass::FixedImageType          FixedImageType;
   typedef typename Superclass::FixedImageRegionType    FixedImageRegionType;
   typedef typename Superclass::MovingImageType         MovingImageType;
-  typedef typename Superclass::MovingImageRegionType   MovingImageRegionType;
-  typedef typename Superclass::FixedImageConstPointer  FixedImageConstPointer;
-  typedef typename Superclass::MovingImageConstPointer MovingImageConstPointer;
-  typedef typename Superclass::MovingImagePointer      MovingImagePointer;
   typedef typename TFixedImage::PixelType              FixedImagePixelType;
   typedef typename TMovingImage::PixelType             MovedImagePixelType;
   typedef typename itk::Optimizer                      OptimizerType;
@@ -90,39 +79,6 @@ public:
 
   itkStaticConstMacro( FixedImageDimension, unsigned int, TFixedImage::ImageDimension );
 
-  /** Types for transforming the moving image */
-  typedef typename itk::AdvancedCombinationTransform<
-    ScalarType, FixedImageDimension >                    CombinationTransformType;
-  typedef typename CombinationTransformType::Pointer CombinationTransformPointer;
-  typedef itk::Image< FixedImagePixelType,
-    itkGetStaticConstMacro( FixedImageDimension ) >   TransformedMovingImageType;
-  typedef itk::Image< unsigned char,
-    itkGetStaticConstMacro( FixedImageDimension ) >   MaskImageType;
-  typedef typename MaskImageType::Pointer MaskImageTypePointer;
-  typedef itk::ResampleImageFilter<
-    MovingImageType, TransformedMovingImageType >       TransformMovingImageFilterType;
-  typedef typename TransformMovingImageFilterType::Pointer TransformMovingImageFilterPointer;
-  typedef typename itk::AdvancedRayCastInterpolateImageFunction
-    < MovingImageType, ScalarType >                     RayCastInterpolatorType;
-  typedef typename RayCastInterpolatorType::Pointer RayCastInterpolatorPointer;
-
-  /** Sobel filters to compute the gradients of the Fixed Image */
-  typedef itk::Image< RealType,
-    itkGetStaticConstMacro( FixedImageDimension ) >       FixedGradientImageType;
-  typedef itk::CastImageFilter< FixedImageType,
-    FixedGradientImageType >                              CastFixedImageFilterType;
-  typedef typename CastFixedImageFilterType::Pointer CastFixedImageFilterPointer;
-  typedef typename FixedGradientImageType::PixelType FixedGradientPixelType;
-
-  /** Sobel filters to compute the gradients of the Moved Image */
-  itkStaticConstMacro( MovedImageDimension, unsigned int, MovingImageType::ImageDimension );
-  typedef itk::Image< RealType,
-    itkGetStaticConstMacro( MovedImageDimension ) >       MovedGradientImageType;
-  typedef itk::CastImageFilter< TransformedMovingImageType,
-    MovedGradientImageType >                              CastMovedImageFilterType;
-  typedef typename CastMovedImageFilterType::Pointer CastMovedImageFilterPointer;
-  typedef typename MovedGradientImageType::PixelType MovedGradientPixelType;
-
   /** Get the derivatives of the match measure. */
   virtual void GetDerivative( const TransformParametersType & parameters,
     DerivativeType  & derivative ) const;
@@ -134,14 +90,6 @@ public:
   virtual void GetValueAndDerivative( const TransformParametersType & parameters,
     MeasureType & Value, DerivativeType & derivative ) const;
 
-  /** Initialize the Metric by making sure that all the components
-   *  are present and plugged together correctly.
-   */
-  virtual void Initialize( void ) throw ( ExceptionObject );
-
-  /** Write gradient images to a files for debugging purposes. */
-  void WriteGradientImagesToFiles( void ) const;
-
   /** Set/Get Scales  */
   itkSetMacro( Scales, ScalesType );
   itkGetConstReferenceMacro( Scales, ScalesType );
@@ -161,58 +109,16 @@ protected:
   virtual ~NormalizedGradientCorrelationImageToImageMetric() {}
   virtual void PrintSelf( std::ostream & os, Indent indent ) const;
 
-  /** Compute the mean of the fixed and moved image gradients. */
-  void ComputeMeanMovedGradient( void ) const;
-
-  void ComputeMeanFixedGradient( void ) const;
-
-  /** Compute the similarity measure  */
-  MeasureType ComputeMeasure( const TransformParametersType & parameters ) const;
-
-  typedef NeighborhoodOperatorImageFilter<
-    FixedGradientImageType, FixedGradientImageType >        FixedSobelFilter;
-  typedef NeighborhoodOperatorImageFilter<
-    MovedGradientImageType, MovedGradientImageType >        MovedSobelFilter;
+  /** Compute the similarity measure from the gradients at the samples. */
+  MeasureType ComputeMeasure( void ) const;
 
 private:
 
   NormalizedGradientCorrelationImageToImageMetric( const Self & ); // purposely not implemented
   void operator=( const Self & );                                  // purposely not implemented
 
-  ScalesType                  m_Scales;
-  double                      m_DerivativeDelta;
-  CombinationTransformPointer m_CombinationTransform;
-
-  /** The mean of the moving image gradients. */
-  mutable MovedGradientPixelType m_MeanMovedGradient[ MovedImageDimension ];
-
-  /** The mean of the fixed image gradients. */
-  mutable FixedGradientPixelType m_MeanFixedGradient[ FixedImageDimension ];
-
-  /** The filter for transforming the moving images. */
-  TransformMovingImageFilterPointer m_TransformMovingImageFilter;
-
-  /** The Sobel gradients of the fixed image */
-  CastFixedImageFilterPointer m_CastFixedImageFilter;
-
-  SobelOperator< FixedGradientPixelType,
-  itkGetStaticConstMacro( FixedImageDimension ) >
-  m_FixedSobelOperators[ FixedImageDimension ];
-
-  typename FixedSobelFilter::Pointer m_FixedSobelFilters
-  [ itkGetStaticConstMacro( FixedImageDimension ) ];
-
-  ZeroFluxNeumannBoundaryCondition< MovedGradientImageType > m_MovedBoundCond;
-  ZeroFluxNeumannBoundaryCondition< FixedGradientImageType > m_FixedBoundCond;
-
-  /** The Sobel gradients of the moving image */
-  CastMovedImageFilterPointer m_CastMovedImageFilter;
-  SobelOperator< MovedGradientPixelType,
-  itkGetStaticConstMacro( MovedImageDimension ) >
-  m_MovedSobelOperators[ MovedImageDimension ];
-
-  typename MovedSobelFilter::Pointer m_MovedSobelFilters[
-    itkGetStaticConstMacro( MovedImageDimension ) ];
+  ScalesType m_Scales;
+  double     m_DerivativeDelta;
 
 };
 
@@ -19,13 +19,7 @@
 #define __itkNormalizedGradientCorrelationImageToImageMetric_hxx
 
 #include "itkNormalizedGradientCorrelationImageToImageMetric.h"
-#include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkNumericTraits.h"
-#include "itkSimpleFilterWatcher.h"
-
-#include <iostream>
-#include <iomanip>
-#include <stdio.h>
 
 namespace itk
 {
@@ -38,91 +32,11 @@ template< class TFixedImage, class TMovingImage >
 NormalizedGradientCorrelationImageToImageMetric< TFixedImage, TMovingImage >
 ::NormalizedGradientCorrelationImageToImageMetric()
 {
-  this->m_CastFixedImageFilter       = CastFixedImageFilterType::New();
-  this->m_CastMovedImageFilter       = CastMovedImageFilterType::New();
-  this->m_CombinationTransform       = CombinationTransformType::New();
-  this->m_TransformMovingImageFilter = TransformMovingImageFilterType::New();
-  this->m_DerivativeDelta            = 0.001;
-
-  for( unsigned int iDimension = 0; iDimension < MovedImageDimension; iDimension++ )
-  {
-    this->m_MeanFixedGradient[ iDimension ] = 0;
-    this->m_MeanMovedGradient[ iDimension ] = 0;
-  }
+  this->m_DerivativeDelta = 0.001;
 
 } // end Constructor
 
 
-/**
- * ***************** Initialize *****************
- */
-
-template< class TFixedImage, class TMovingImage >
-void
-NormalizedGradientCorrelationImageToImageMetric< TFixedImage, TMovingImage >
-::Initialize( void ) throw ( ExceptionObject )
-{
-  /** Initialize the base class */
-  Superclass::Initialize();
-
-  unsigned int iFilter;
-
-  /** Compute the gradient of the fixed images */
-  this->m_CastFixedImageFilter->SetInput( this->m_FixedImage );
-  this->m_CastFixedImageFilter->Update();
-
-  for( iFilter = 0; iFilter < FixedImageDimension; iFilter++ )
-  {
-    this->m_FixedSobelOperators[ iFilter ].SetDirection( iFilter );
-    this->m_FixedSobelOperators[ iFilter ].CreateDirectional();
-    this->m_FixedSobelFilters[ iFilter ] = FixedSobelFilter::New();
-    this->m_FixedSobelFilters[ iFilter ]->OverrideBoundaryCondition( &this->m_FixedBoundCond );
-    this->m_FixedSobelFilters[ iFilter ]->SetOperator( this->m_FixedSobelOperators[ iFilter ] );
-    this->m_FixedSobelFilters[ iFilter ]->SetInput( this->m_CastFixedImageFilter->GetOutput() );
-    this->m_FixedSobelFilters[ iFilter ]->UpdateLargestPossibleRegion();
-  }
-
-  this->ComputeMeanFixedGradient();
-
-  /** Resampling for 3D->2D */
-  RayCastInterpolatorType * rayCaster = dynamic_cast< RayCastInterpolatorType * >(
-    const_cast< InterpolatorType * >( this->GetInterpolator() ) );
-  if( rayCaster != 0 )
-  {
-    this->m_TransformMovingImageFilter->SetTransform( rayCaster->GetTransform() );
-  }
-  else
-  {
-    itkExceptionMacro( << "ERROR: the NormalizedGradientCorrelationImageToImageMetric is currently "
-                       << "only suitable for 2D-3D registration.\n"
-                       << "  Therefore it expects an interpolator of type RayCastInterpolator." );
-  }
-  this->m_TransformMovingImageFilter->SetInterpolator( this->m_Interpolator );
-  this->m_TransformMovingImageFilter->SetInput( this->m_MovingImage );
-  this->m_TransformMovingImageFilter->SetDefaultPixelValue( 0 );
-  this->m_TransformMovingImageFilter->SetSize( this->m_FixedImage->GetLargestPossibleRegion().GetSize() );
-  this->m_TransformMovingImageFilter->SetOutputOrigin( this->m_FixedImage->GetOrigin() );
-  this->m_TransformMovingImageFilter->SetOutputSpacing( this->m_FixedImage->GetSpacing() );
-  this->m_TransformMovingImageFilter->SetOutputDirection( this->m_FixedImage->GetDirection() );
-  this->m_TransformMovingImageFilter->Update();
-
-  this->m_CastMovedImageFilter->SetInput(
-    this->m_TransformMovingImageFilter->GetOutput() );
-
-  for( iFilter = 0; iFilter < MovedImageDimension; iFilter++ )
-  {
-    this->m_MovedSobelOperators[ iFilter ].SetDirection( iFilter );
-    this->m_MovedSobelOperators[ iFilter ].CreateDirectional();
-    this->m_MovedSobelFilters[ iFilter ] = MovedSobelFilter::New();
-    this->m_MovedSobelFilters[ iFilter ]->OverrideBoundaryCondition( &this->m_MovedBoundCond );
-    this->m_MovedSobelFilters[ iFilter ]->SetOperator( this->m_MovedSobelOperators[ iFilter ] );
-    this->m_MovedSobelFilters[ iFilter ]->SetInput( this->m_CastMovedImageFilter->GetOutput() );
-    this->m_MovedSobelFilters[ iFilter ]->UpdateLargestPossibleRegion();
-  }
-
-} // end Initialize()
-
-
 /**
  * ***************** PrintSelf *****************
  */
@@ -138,262 +52,66 @@ NormalizedGradientCorrelationImageToImageMetric< TFixedImage, TMovingImage >
 
 
 /**
- * ***************** ComputeMeanFixedGradient *****************
- */
-
-template< class TFixedImage, class TMovingImage >
-void
-NormalizedGradientCorrelationImageToImageMetric< TFixedImage, TMovingImage >
-::ComputeMeanFixedGradient( void ) const
-{
-  typename FixedGradientImageType::IndexType currentIndex;
-  typename FixedGradientImageType::PointType point;
-
-  for( int iDimension = 0; iDimension < FixedImageDimension; iDimension++ )
-  {
-    this->m_FixedSobelFilters[ iDimension ]->UpdateLargestPossibleRegion();
-  }
-
-  typedef  itk::ImageRegionConstIteratorWithIndex< FixedGradientImageType >
-    FixedIteratorType;
-  FixedIteratorType fixedIteratorx( this->m_FixedSobelFilters[ 0 ]->GetOutput(),
-  this->GetFixedImageRegion() );
-  FixedIteratorType fixedIteratory( this->m_FixedSobelFilters[ 1 ]->GetOutput(),
-  this->GetFixedImageRegion() );
-
-  fixedIteratorx.GoToBegin();
-  fixedIteratory.GoToBegin();
-
-  bool                   sampleOK = false;
-  FixedGradientPixelType fixedGradient[ FixedImageDimension ];
-  for( int i = 0; i < FixedImageDimension; i++ )
-  {
-    fixedGradient[ i ] = 0.0;
-  }
-
-  unsigned long nPixels = 0;
-
-  if( this->m_FixedImageMask.IsNull() )
-  {
-    sampleOK = true;
-  }
-
-  while( !fixedIteratorx.IsAtEnd() )
-  {
-    /** Get current index */
-    currentIndex = fixedIteratorx.GetIndex();
-    this->m_FixedImage->TransformIndexToPhysicalPoint( currentIndex, point );
-
-    /** if fixedMask is given */
-    if( !this->m_FixedImageMask.IsNull() )
-    {
-      if( this->m_FixedImageMask->IsInside( point ) )
-      {
-        sampleOK = true;
-      }
-      else
-      {
-        sampleOK = false;
-      }
-    }
-
-    if( sampleOK )
-    {
-      fixedGradient[ 0 ] += fixedIteratorx.Get();
-      fixedGradient[ 1 ] += fixedIteratory.Get();
-      nPixels++;
-    }
-
-    ++fixedIteratorx;
-    ++fixedIteratory;
-  } // end while
-
-  this->m_MeanFixedGradient[ 0 ] = fixedGradient[ 0 ] / nPixels;
-  this->m_MeanFixedGradient[ 1 ] = fixedGradient[ 1 ] / nPixels;
-
-} // end ComputeMeanFixedGradient()
-
-
-/**
- * ***************** ComputeMeanMovedGradient *****************
+ * ***************** ComputeMeasure *****************
  */
 
 template< class TFixedImage, class TMovingImage >
-void
+typename NormalizedGradientCorrelationImageToImageMetric< TFixedImage, TMovingImage >::MeasureType
 NormalizedGradientCorrelationImageToImageMetric< TFixedImage, TMovingImage >
-::ComputeMeanMovedGradient( void ) const
+::ComputeMeasure( void ) const
 {
-  typename MovedGradientImageType::IndexType currentIndex;
-  typename MovedGradientImageType::PointType point;
-
-  for( int iDimension = 0; iDimension < MovedImageDimension; iDimension++ )
+  const SizeValueType numberOfSamples = this->m_NumberOfPixelsCounted;
+  if( numberOfSamples == 0 )
   {
-    this->m_MovedSobelFilters[ iDimension ]->UpdateLargestPossibleRegion();
+    itkExceptionMacro( << "All the samples are outside the fixed image." );
   }
 
-  typedef  itk::ImageRegionConstIteratorWithIndex< MovedGradientImageType >
-    MovedIteratorType;
-
-  MovedIteratorType movedIteratorx( this->m_MovedSobelFilters[ 0 ]->GetOutput(),
-  this->GetFixedImageRegion() );
-  MovedIteratorType movedIteratory( this->m_MovedSobelFilters[ 1 ]->GetOutput(),
-  this->GetFixedImageRegion() );
-
-  movedIteratorx.GoToBegin();
-  movedIteratory.GoToBegin();
-
-  bool sampleOK = false;
-
-  if( this->m_FixedImageMask.IsNull() )
-  {
-    sampleOK = true;
-  }
-
-  MovedGradientPixelType movedGradient[ MovedImageDimension ];
-
-  for( int i = 0; i < MovedImageDimension; i++ )
+  /** Accumulate the sums that are needed for the means and the (cross)
+   * correlations of the gradients, in a single pass over the samples.
+   */
+  RealType sumFixed[ FixedImageDimension ];
+  RealType sumMoved[ FixedImageDimension ];
+  RealType sumFixedMoved[ FixedImageDimension ];
+  RealType sumFixedFixed[ FixedImageDimension ];
+  RealType sumMovedMoved[ FixedImageDimension ];
+  for( unsigned int d = 0; d < FixedImageDimension; ++d )
   {
-    movedGradient[ i ] = 0.0;
+    sumFixed[ d ]      = NumericTraits< RealType >::Zero;
+    sumMoved[ d ]      = NumericTraits< RealType >::Zero;
+    sumFixedMoved[ d ] = NumericTraits< RealType >::Zero;
+    sumFixedFixed[ d ] = NumericTraits< RealType >::Zero;
+    sumMovedMoved[ d ] = NumericTraits< RealType >::Zero;
   }
 
-  unsigned long nPixels = 0;
-
-  while( !movedIteratorx.IsAtEnd() )
+  const RealType * fixedGradient = &this->m_SampleFixedGradients[ 0 ];
+  const RealType * movedGradient = &this->m_SampleMovedGradients[ 0 ];
+  for( SizeValueType i = 0; i < numberOfSamples; ++i )
   {
-    /** Get current index */
-    currentIndex = movedIteratorx.GetIndex();
-    this->m_FixedImage->TransformIndexToPhysicalPoint( currentIndex, point );
-
-    /** if fixedMask is given */
-    if( !this->m_FixedImageMask.IsNull() )
+    for( unsigned int d = 0; d < FixedImageDimension; ++d )
     {
-      if( this->m_FixedImageMask->IsInside( point ) )
-      {
-        sampleOK = true;
-      }
-      else
-      {
-        sampleOK = false;
-      }
+      const RealType fixedValue = *fixedGradient++;
+      const RealType movedValue = *movedGradient++;
+      sumFixed[ d ]      += fixedValue;
+      sumMoved[ d ]      += movedValue;
+      sumFixedMoved[ d ] += fixedValue * movedValue;
+      sumFixedFixed[ d ] += fixedValue * fixedValue;
+      sumMovedMoved[ d ] += movedValue * movedValue;
     }
-
-    if( sampleOK )
-    {
-      movedGradient[ 0 ] += movedIteratorx.Get();
-      movedGradient[ 1 ] += movedIteratory.Get();
-      nPixels++;
-    } // end if sampleOK
-
-    ++movedIteratorx;
-    ++movedIteratory;
-  } // end while
-
-  this->m_MeanMovedGradient[ 0 ] = movedGradient[ 0 ] / nPixels;
-  this->m_MeanMovedGradient[ 1 ] = movedGradient[ 1 ] / nPixels;
-
-} // end ComputeMeanMovedGradient()
-
-
-/**
- * ***************** ComputeMeasure *****************
- */
-
-template< class TFixedImage, class TMovingImage >
-typename NormalizedGradientCorrelationImageToImageMetric< TFixedImage, TMovingImage >::MeasureType
-NormalizedGradientCorrelationImageToImageMetric< TFixedImage, TMovingImage >
-::ComputeMeasure( const TransformParametersType & parameters ) const
-{
-  this->SetTransformParameters( parameters );
-  this->m_TransformMovingImageFilter->Modified();
-  this->m_TransformMovingImageFilter->UpdateLargestPossibleRegion();
-
-  typename FixedImageType::IndexType currentIndex;
-  typename FixedImageType::PointType point;
-
-  MeasureType measure = NumericTraits< MeasureType >::Zero;
-
-  MovedGradientPixelType NmovedGradient[ FixedImageDimension ];
-  FixedGradientPixelType NfixedGradient[ FixedImageDimension ];
-
-  MeasureType NGcrosscorrelation      = NumericTraits< MeasureType >::Zero;
-  MeasureType NGautocorrelationfixed  = NumericTraits< MeasureType >::Zero;
-  MeasureType NGautocorrelationmoving = NumericTraits< MeasureType >::Zero;
-
-  /** Make sure all is updated */
-  for( int iDimension = 0; iDimension < FixedImageDimension; iDimension++ )
-  {
-    this->m_FixedSobelFilters[ iDimension ]->UpdateLargestPossibleRegion();
-    this->m_MovedSobelFilters[ iDimension ]->UpdateLargestPossibleRegion();
   }
 
-  typedef  itk::ImageRegionConstIteratorWithIndex< FixedGradientImageType >
-    FixedIteratorType;
-
-  FixedIteratorType fixedIteratorx( this->m_FixedSobelFilters[ 0 ]->GetOutput(),
-  this->GetFixedImageRegion() );
-  FixedIteratorType fixedIteratory( this->m_FixedSobelFilters[ 1 ]->GetOutput(),
-  this->GetFixedImageRegion() );
-
-  fixedIteratorx.GoToBegin();
-  fixedIteratory.GoToBegin();
-
-  typedef  itk::ImageRegionConstIteratorWithIndex< MovedGradientImageType >
-    MovedIteratorType;
-
-  MovedIteratorType movedIteratorx( this->m_MovedSobelFilters[ 0 ]->GetOutput(),
-  this->GetFixedImageRegion() );
-  MovedIteratorType movedIteratory( this->m_MovedSobelFilters[ 1 ]->GetOutput(),
-  this->GetFixedImageRegion() );
-
-  movedIteratorx.GoToBegin();
-  movedIteratory.GoToBegin();
-
-  this->m_NumberOfPixelsCounted = 0;
-  bool sampleOK = false;
-
-  if( this->m_FixedImageMask.IsNull() )
+  /** Subtract the means: sum (f-mf)(m-mm) = sum fm - sum f * sum m / N. */
+  const RealType N                       = static_cast< RealType >( numberOfSamples );
+  MeasureType    NGcrosscorrelation      = NumericTraits< MeasureType >::Zero;
+  MeasureType    NGautocorrelationfixed  = NumericTraits< MeasureType >::Zero;
+  MeasureType    NGautocorrelationmoving = NumericTraits< MeasureType >::Zero;
+  for( unsigned int d = 0; d < FixedImageDimension; ++d )
   {
-    sampleOK = true;
+    NGcrosscorrelation      += sumFixedMoved[ d ] - sumFixed[ d ] * sumMoved[ d ] / N;
+    NGautocorrelationfixed  += sumFixedFixed[ d ] - sumFixed[ d ] * sumFixed[ d ] / N;
+    NGautocorrelationmoving += sumMovedMoved[ d ] - sumMoved[ d ] * sumMoved[ d ] / N;
   }
 
-  while( !fixedIteratorx.IsAtEnd() )
-  {
-    currentIndex = fixedIteratorx.GetIndex();
-    this->m_FixedImage->TransformIndexToPhysicalPoint( currentIndex, point );
-
-    /** if fixedMask is given */
-    if( !this->m_FixedImageMask.IsNull() )
-    {
-      if( this->m_FixedImageMask->IsInside( point ) )
-      {
-        sampleOK = true;
-      }
-      else
-      {
-        sampleOK = false;
-      }
-    }
-
-    if( sampleOK )
-    {
-      NmovedGradient[ 0 ]      = movedIteratorx.Get() - this->m_MeanMovedGradient[ 0 ];
-      NfixedGradient[ 0 ]      = fixedIteratorx.Get() - this->m_MeanFixedGradient[ 0 ];
-      NmovedGradient[ 1 ]      = movedIteratory.Get() - this->m_MeanMovedGradient[ 1 ];
-      NfixedGradient[ 1 ]      = fixedIteratory.Get() - this->m_MeanFixedGradient[ 1 ];
-      NGcrosscorrelation      += NmovedGradient[ 0 ] * NfixedGradient[ 0 ] + NmovedGradient[ 1 ] * NfixedGradient[ 1 ];
-      NGautocorrelationmoving += NmovedGradient[ 0 ] * NmovedGradient[ 0 ] + NmovedGradient[ 1 ] * NmovedGradient[ 1 ];
-      NGautocorrelationfixed  += NfixedGradient[ 0 ] * NfixedGradient[ 0 ] + NfixedGradient[ 1 ] * NfixedGradient[ 1 ];
-
-    } // end if sampleOK
-
-    ++fixedIteratorx;
-    ++fixedIteratory;
-    ++movedIteratorx;
-    ++movedIteratory;
-
-  } // end while
-
-  measure = -1.0 * ( NGcrosscorrelation
+  const MeasureType measure = -1.0 * ( NGcrosscorrelation
     / ( vcl_sqrt( NGautocorrelationfixed ) * vcl_sqrt( NGautocorrelationmoving ) ) );
   return measure;
 
@@ -423,21 +141,11 @@ NormalizedGradientCorrelationImageToImageMetric< TFixedImage, TMovingImage >
    * - Now you can call GetValueAndDerivative multi-threaded.
    */
   this->BeforeThreadedGetValueAndDerivative( parameters );
-  //this->SetTransformParameters( parameters );
-
-  unsigned int iFilter;
-  this->m_TransformMovingImageFilter->Modified();
-  this->m_TransformMovingImageFilter->UpdateLargestPossibleRegion();
-
-  for( iFilter = 0; iFilter < MovedImageDimension; iFilter++ )
-  {
-    this->m_MovedSobelFilters[ iFilter ]->UpdateLargestPossibleRegion();
-  }
 
-  this->ComputeMeanMovedGradient();
-  MeasureType currentMeasure = this->ComputeMeasure( parameters );
+  /** Compute the gradients at the samples only. */
+  this->ComputeSampleGradients();
 
-  return currentMeasure;
+  return this->ComputeMeasure();
 
 } // end GetValue()
 
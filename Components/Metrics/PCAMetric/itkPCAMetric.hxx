@@ -20,7 +20,7 @@
 
 #include "itkPCAMetric.h"
 
-#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkRandomVariateGeneratorInstance.h"
 #include "vnl/algo/vnl_matrix_update.h"
 #include "itkImage.h"
 #include "vnl/algo/vnl_svd.h"
@@ -107,7 +107,7 @@ PCAMetric< TFixedImage, TMovingImage >
   numbers.clear();
 
   /** Initialize random number generator. */
-  Statistics::MersenneTwisterRandomVariateGenerator::Pointer randomGenerator = Statistics::MersenneTwisterRandomVariateGenerator::GetInstance();
+  Statistics::MersenneTwisterRandomVariateGenerator::Pointer randomGenerator = RandomVariateGeneratorInstance::Get();
 
   /** Sample additional at fixed timepoint. */
   for( unsigned int i = 0; i < m_NumAdditionalSamplesFixed; ++i )
@@ -245,7 +245,7 @@ PCAMetric< TFixedImage, TMovingImage >
 
     /** Transform sampled point to voxel coordinates. */
     FixedImageContinuousIndexType voxelCoord;
-    this->GetFixedImage()->TransformPhysicalPointToContinuousIndex( fixedPoint, voxelCoord );
+    this->ComputeFixedImageContinuousIndex( ( *fiter ).Index(), fixedPoint, voxelCoord );
 
     unsigned int numSamplesOk = 0;
 
@@ -494,7 +494,7 @@ PCAMetric< TFixedImage, TMovingImage >
 
     /** Transform sampled point to voxel coordinates. */
     FixedImageContinuousIndexType voxelCoord;
-    this->GetFixedImage()->TransformPhysicalPointToContinuousIndex( fixedPoint, voxelCoord );
+    this->ComputeFixedImageContinuousIndex( ( *fiter ).Index(), fixedPoint, voxelCoord );
 
     const unsigned int G            = lastDimPositions.size();
     unsigned int       numSamplesOk = 0;
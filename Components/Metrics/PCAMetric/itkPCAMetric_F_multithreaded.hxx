@@ -233,7 +233,7 @@ PCAMetric< TFixedImage, TMovingImage >
 
     /** Transform sampled point to voxel coordinates. */
     FixedImageContinuousIndexType voxelCoord;
-    this->GetFixedImage()->TransformPhysicalPointToContinuousIndex( fixedPoint, voxelCoord );
+    this->ComputeFixedImageContinuousIndex( ( *fiter ).Index(), fixedPoint, voxelCoord );
 
     unsigned int numSamplesOk = 0;
 
@@ -419,7 +419,7 @@ PCAMetric< TFixedImage, TMovingImage >
 
     /** Transform sampled point to voxel coordinates. */
     FixedImageContinuousIndexType voxelCoord;
-    this->GetFixedImage()->TransformPhysicalPointToContinuousIndex( fixedPoint, voxelCoord );
+    this->ComputeFixedImageContinuousIndex( ( *fiter ).Index(), fixedPoint, voxelCoord );
 
     unsigned int numSamplesOk = 0;
 
@@ -769,7 +769,7 @@ PCAMetric< TFixedImage, TMovingImage >
 
     /** Transform sampled point to voxel coordinates. */
     FixedImageContinuousIndexType voxelCoord;
-    this->GetFixedImage()->TransformPhysicalPointToContinuousIndex( fixedPoint, voxelCoord );
+    this->ComputeFixedImageContinuousIndex( ( *threader_fiter ).Index(), fixedPoint, voxelCoord );
 
     unsigned int numSamplesOk = 0;
 
@@ -955,16 +955,11 @@ void
 PCAMetric< TFixedImage, TMovingImage >
 ::LaunchGetSamplesThreaderCallback( void ) const
 {
-  /** Setup local threader. */
-  // \todo: is a global threader better performance-wise? check
-  typename ThreaderType::Pointer local_threader = ThreaderType::New();
-  local_threader->SetNumberOfThreads( this->m_NumberOfThreads );
-  local_threader->SetSingleMethod( this->GetSamplesThreaderCallback,
+  /** Launch the threads of the persistent thread pool. */
+  PersistentThreadPool::SingleMethodExecute( this->GetSamplesThreaderCallback,
     const_cast< void * >( static_cast< const void * >(
-      &this->m_PCAMetricThreaderParameters ) ) );
-
-  /** Launch. */
-  local_threader->SingleMethodExecute();
+      &this->m_PCAMetricThreaderParameters ) ),
+    this->m_NumberOfThreads );
 
 } // end LaunchGetSamplesThreaderCallback()
 
@@ -1163,16 +1158,11 @@ void
 PCAMetric< TFixedImage, TMovingImage >
 ::LaunchComputeDerivativeThreaderCallback( void ) const
 {
-  /** Setup local threader. */
-  // \todo: is a global threader better performance-wise? check
-  typename ThreaderType::Pointer local_threader = ThreaderType::New();
-  local_threader->SetNumberOfThreads( this->m_NumberOfThreads );
-  local_threader->SetSingleMethod( this->ComputeDerivativeThreaderCallback,
+  /** Launch the threads of the persistent thread pool. */
+  PersistentThreadPool::SingleMethodExecute( this->ComputeDerivativeThreaderCallback,
     const_cast< void * >( static_cast< const void * >(
-      &this->m_PCAMetricThreaderParameters ) ) );
-
-  /** Launch. */
-  local_threader->SingleMethodExecute();
+      &this->m_PCAMetricThreaderParameters ) ),
+    this->m_NumberOfThreads );
 
 } // end LaunchComputeDerivativeThreaderCallback()
 
@@ -20,7 +20,7 @@
 
 #include "itkPCAMetric2.h"
 
-#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkRandomVariateGeneratorInstance.h"
 #include "vnl/algo/vnl_matrix_update.h"
 #include "itkImage.h"
 #include "vnl/algo/vnl_svd.h"
@@ -44,9 +44,25 @@ PCAMetric2< TFixedImage, TMovingImage >
   this->SetUseImageSampler( true );
   this->SetUseFixedImageLimiter( false );
   this->SetUseMovingImageLimiter( false );
+
+  // Multi-threading structs
+  this->m_PCAMetric2GetSamplesPerThreadVariables     = NULL;
+  this->m_PCAMetric2GetSamplesPerThreadVariablesSize = 0;
 } // end constructor
 
 
+/**
+ * ******************* Destructor *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+PCAMetric2< TFixedImage, TMovingImage >
+::~PCAMetric2()
+{
+  delete[] this->m_PCAMetric2GetSamplesPerThreadVariables;
+} // end Destructor
+
+
 /**
  * ******************* Initialize *******************
  */
@@ -93,7 +109,7 @@ PCAMetric2< TFixedImage, TMovingImage >
 
   /** Initialize random number generator. */
   Statistics::MersenneTwisterRandomVariateGenerator::Pointer randomGenerator
-    = Statistics::MersenneTwisterRandomVariateGenerator::GetInstance();
+    = RandomVariateGeneratorInstance::Get();
 
   /** Sample additional at fixed timepoint. */
   for( unsigned int i = 0; i < m_NumAdditionalSamplesFixed; ++i )
@@ -218,7 +234,7 @@ PCAMetric2< TFixedImage, TMovingImage >
 
     /** Transform sampled point to voxel coordinates. */
     FixedImageContinuousIndexType voxelCoord;
-    this->GetFixedImage()->TransformPhysicalPointToContinuousIndex( fixedPoint, voxelCoord );
+    this->ComputeFixedImageContinuousIndex( ( *fiter ).Index(), fixedPoint, voxelCoord );
 
     unsigned int numSamplesOk = 0;
 
@@ -360,13 +376,13 @@ PCAMetric2< TFixedImage, TMovingImage >
 
 
 /**
- * ******************* GetValueAndDerivative *******************
+ * ******************* GetValueAndDerivativeSingleThreaded *******************
  */
 
 template< class TFixedImage, class TMovingImage >
 void
 PCAMetric2< TFixedImage, TMovingImage >
-::GetValueAndDerivative( const TransformParametersType & parameters,
+::GetValueAndDerivativeSingleThreaded( const TransformParametersType & parameters,
   MeasureType & value, DerivativeType & derivative ) const
 {
   itkDebugMacro( "GetValueAndDerivative( " << parameters << " ) " );
@@ -429,7 +445,7 @@ PCAMetric2< TFixedImage, TMovingImage >
 
     /** Transform sampled point to voxel coordinates. */
     FixedImageContinuousIndexType voxelCoord;
-    this->GetFixedImage()->TransformPhysicalPointToContinuousIndex( fixedPoint, voxelCoord );
+    this->ComputeFixedImageContinuousIndex( ( *fiter ).Index(), fixedPoint, voxelCoord );
 
     unsigned int numSamplesOk = 0;
 
@@ -621,78 +637,539 @@ PCAMetric2< TFixedImage, TMovingImage >
   measure     = sumWeightedEigenValues;
 
   /** Subtract mean from derivative elements. */
-  if( this->m_SubtractMean )
+  this->SubtractMeanFromDerivative( derivative );
+
+  /** Return the measure value. */
+  value = measure;
+
+} // end GetValueAndDerivativeSingleThreaded()
+
+
+/**
+ * ******************* SubtractMeanFromDerivative *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+PCAMetric2< TFixedImage, TMovingImage >
+::SubtractMeanFromDerivative( DerivativeType & derivative ) const
+{
+  if( !this->m_SubtractMean )
+  {
+    return;
+  }
+
+  /** Retrieve slowest varying dimension and its size. */
+  const unsigned int lastDim = this->GetFixedImage()->GetImageDimension() - 1;
+  const unsigned int G       = this->GetFixedImage()->GetLargestPossibleRegion().GetSize( lastDim );
+
+  if( !this->m_TransformIsStackTransform )
   {
-    if( !this->m_TransformIsStackTransform )
+    /** Update derivative per dimension.
+     * Parameters are ordered xxxxxxx yyyyyyy zzzzzzz ttttttt and
+     * per dimension xyz.
+     */
+    const unsigned int lastDimGridSize = this->m_GridSize[ lastDim ];
+    const unsigned int numParametersPerDimension
+      = this->GetNumberOfParameters() / this->GetMovingImage()->GetImageDimension();
+    const unsigned int numControlPointsPerDimension = numParametersPerDimension / lastDimGridSize;
+    DerivativeType     mean( numControlPointsPerDimension );
+    for( unsigned int d = 0; d < this->GetMovingImage()->GetImageDimension(); ++d )
     {
-      /** Update derivative per dimension.
-   * Parameters are ordered xxxxxxx yyyyyyy zzzzzzz ttttttt and
-   * per dimension xyz.
-   */
-      const unsigned int lastDimGridSize = this->m_GridSize[ lastDim ];
-      const unsigned int numParametersPerDimension
-        = this->GetNumberOfParameters() / this->GetMovingImage()->GetImageDimension();
-      const unsigned int numControlPointsPerDimension = numParametersPerDimension / lastDimGridSize;
-      DerivativeType     mean( numControlPointsPerDimension );
-      for( unsigned int d = 0; d < this->GetMovingImage()->GetImageDimension(); ++d )
+      /** Compute mean per dimension. */
+      mean.Fill( 0.0 );
+      const unsigned int starti = numParametersPerDimension * d;
+      for( unsigned int i = starti; i < starti + numParametersPerDimension; ++i )
       {
-        /** Compute mean per dimension. */
-        mean.Fill( 0.0 );
-        const unsigned int starti = numParametersPerDimension * d;
-        for( unsigned int i = starti; i < starti + numParametersPerDimension; ++i )
-        {
-          const unsigned int index = i % numControlPointsPerDimension;
-          mean[ index ] += derivative[ i ];
-        }
-        mean /= static_cast< RealType >( lastDimGridSize );
+        const unsigned int index = i % numControlPointsPerDimension;
+        mean[ index ] += derivative[ i ];
+      }
+      mean /= static_cast< RealType >( lastDimGridSize );
 
-        /** Update derivative for every control point per dimension. */
-        for( unsigned int i = starti; i < starti + numParametersPerDimension; ++i )
-        {
-          const unsigned int index = i % numControlPointsPerDimension;
-          derivative[ i ] -= mean[ index ];
-        }
+      /** Update derivative for every control point per dimension. */
+      for( unsigned int i = starti; i < starti + numParametersPerDimension; ++i )
+      {
+        const unsigned int index = i % numControlPointsPerDimension;
+        derivative[ i ] -= mean[ index ];
+      }
+    }
+  }
+  else
+  {
+    /** Update derivative per dimension.
+     * Parameters are ordered x0x0x0y0y0y0z0z0z0x1x1x1y1y1y1z1z1z1 with
+     * the number the time point index.
+     */
+    const unsigned int numParametersPerLastDimension = this->GetNumberOfParameters() / G;
+    DerivativeType     mean( numParametersPerLastDimension );
+    mean.Fill( 0.0 );
+
+    /** Compute mean per control point. */
+    for( unsigned int t = 0; t < G; ++t )
+    {
+      const unsigned int startc = numParametersPerLastDimension * t;
+      for( unsigned int c = startc; c < startc + numParametersPerLastDimension; ++c )
+      {
+        const unsigned int index = c % numParametersPerLastDimension;
+        mean[ index ] += derivative[ c ];
       }
     }
-    else
+    mean /= static_cast< RealType >( G );
+
+    /** Update derivative per control point. */
+    for( unsigned int t = 0; t < G; ++t )
     {
-      /** Update derivative per dimension.
-   * Parameters are ordered x0x0x0y0y0y0z0z0z0x1x1x1y1y1y1z1z1z1 with
-   * the number the time point index.
+      const unsigned int startc = numParametersPerLastDimension * t;
+      for( unsigned int c = startc; c < startc + numParametersPerLastDimension; ++c )
+      {
+        const unsigned int index = c % numParametersPerLastDimension;
+        derivative[ c ] -= mean[ index ];
+      }
+    }
+  }
+
+} // end SubtractMeanFromDerivative()
+
+
+/**
+ * ********************* InitializeThreadingParameters ****************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+PCAMetric2< TFixedImage, TMovingImage >
+::InitializeThreadingParameters( void ) const
+{
+  /** Initialize the derivative accumulation structs of the superclass. */
+  Superclass::InitializeThreadingParameters();
+
+  /** Only resize the array of structs when needed. */
+  if( this->m_PCAMetric2GetSamplesPerThreadVariablesSize != this->m_NumberOfThreads )
+  {
+    delete[] this->m_PCAMetric2GetSamplesPerThreadVariables;
+    this->m_PCAMetric2GetSamplesPerThreadVariables
+      = new AlignedPCAMetric2GetSamplesPerThreadStruct[ this->m_NumberOfThreads ];
+    this->m_PCAMetric2GetSamplesPerThreadVariablesSize = this->m_NumberOfThreads;
+  }
+
+  /** Some initialization. */
+  for( ThreadIdType i = 0; i < this->m_NumberOfThreads; ++i )
+  {
+    this->m_PCAMetric2GetSamplesPerThreadVariables[ i ].st_NumberOfPixelsCounted = NumericTraits< SizeValueType >::Zero;
+  }
+
+  this->m_PixelStartIndex.resize( this->m_NumberOfThreads );
+
+} // end InitializeThreadingParameters()
+
+
+/**
+ * ******************* GetValueAndDerivative *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+PCAMetric2< TFixedImage, TMovingImage >
+::GetValueAndDerivative(
+  const TransformParametersType & parameters,
+  MeasureType & value, DerivativeType & derivative ) const
+{
+  /** Option for now to still use the single threaded code. */
+  if( !this->m_UseMultiThread )
+  {
+    return this->GetValueAndDerivativeSingleThreaded(
+      parameters, value, derivative );
+  }
+
+  /** Call non-thread-safe stuff, such as:
+   *   this->SetTransformParameters( parameters );
+   *   this->GetImageSampler()->Update();
+   * Because of these calls GetValueAndDerivative itself is not thread-safe,
+   * so cannot be called multiple times simultaneously.
+   * This is however needed in the CombinationImageToImageMetric.
+   * In that case, you need to:
+   * - switch the use of this function to on, using m_UseMetricSingleThreaded = true
+   * - call BeforeThreadedGetValueAndDerivative once (single-threaded) before
+   *   calling GetValueAndDerivative
+   * - switch the use of this function to off, using m_UseMetricSingleThreaded = false
+   * - Now you can call GetValueAndDerivative multi-threaded.
    */
-      const unsigned int numParametersPerLastDimension = this->GetNumberOfParameters() / G;
-      DerivativeType     mean( numParametersPerLastDimension );
-      mean.Fill( 0.0 );
+  this->BeforeThreadedGetValueAndDerivative( parameters );
 
-      /** Compute mean per control point. */
-      for( unsigned int t = 0; t < G; ++t )
+  /** Launch multi-threading GetSamples. */
+  this->LaunchGetSamplesThreaderCallback();
+
+  /** Compute the metric value and the eigen decomposition from the samples of all threads. */
+  this->AfterThreadedGetSamples( value );
+
+  /** Launch multi-threading derivative computation. */
+  this->LaunchGetValueAndDerivativeThreaderCallback();
+
+  /** Sum the derivative contributions from all threads. */
+  this->AfterThreadedGetValueAndDerivative( value, derivative );
+
+} // end GetValueAndDerivative()
+
+
+/**
+ * ******************* ThreadedGetSamples *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+PCAMetric2< TFixedImage, TMovingImage >
+::ThreadedGetSamples( ThreadIdType threadId )
+{
+  /** Get a handle to the sample container. */
+  ImageSampleContainerPointer sampleContainer     = this->GetImageSampler()->GetOutput();
+  const unsigned long         sampleContainerSize = sampleContainer->Size();
+
+  /** Get the samples for this thread. */
+  const unsigned long nrOfSamplesPerThreads
+    = static_cast< unsigned long >( vcl_ceil( static_cast< double >( sampleContainerSize )
+    / static_cast< double >( this->m_NumberOfThreads ) ) );
+  unsigned long pos_begin = nrOfSamplesPerThreads * threadId;
+  unsigned long pos_end   = nrOfSamplesPerThreads * ( threadId + 1 );
+  pos_begin = ( pos_begin > sampleContainerSize ) ? sampleContainerSize : pos_begin;
+  pos_end   = ( pos_end > sampleContainerSize ) ? sampleContainerSize : pos_end;
+
+  /** Create iterator over the sample container. */
+  typename ImageSampleContainerType::ConstIterator threader_fiter;
+  typename ImageSampleContainerType::ConstIterator threader_fbegin = sampleContainer->Begin();
+  typename ImageSampleContainerType::ConstIterator threader_fend   = sampleContainer->Begin();
+  threader_fbegin                                                 += (int)pos_begin;
+  threader_fend                                                   += (int)pos_end;
+
+  /** Retrieve slowest varying dimension and its size. */
+  const unsigned int lastDim = this->GetFixedImage()->GetImageDimension() - 1;
+  const unsigned int G       = this->GetFixedImage()->GetLargestPossibleRegion().GetSize( lastDim );
+
+  std::vector< FixedImagePointType > SamplesOK;
+  MatrixType                         datablock( pos_end - pos_begin, G );
+
+  unsigned int pixelIndex = 0;
+  for( threader_fiter = threader_fbegin; threader_fiter != threader_fend; ++threader_fiter )
+  {
+    /** Read fixed coordinates. */
+    FixedImagePointType fixedPoint = ( *threader_fiter ).Value().m_ImageCoordinates;
+
+    /** Transform sampled point to voxel coordinates. */
+    FixedImageContinuousIndexType voxelCoord;
+    this->ComputeFixedImageContinuousIndex( ( *threader_fiter ).Index(), fixedPoint, voxelCoord );
+
+    unsigned int numSamplesOk = 0;
+
+    /** Loop over t */
+    for( unsigned int d = 0; d < G; ++d )
+    {
+      /** Initialize some variables. */
+      RealType             movingImageValue;
+      MovingImagePointType mappedPoint;
+
+      /** Set fixed point's last dimension to lastDimPosition. */
+      voxelCoord[ lastDim ] = d;
+
+      /** Transform sampled point back to world coordinates. */
+      this->GetFixedImage()->TransformContinuousIndexToPhysicalPoint( voxelCoord, fixedPoint );
+
+      /** Transform point and check if it is inside the B-spline support region. */
+      bool sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
+
+      /** Check if point is inside mask. */
+      if( sampleOk )
       {
-        const unsigned int startc = numParametersPerLastDimension * t;
-        for( unsigned int c = startc; c < startc + numParametersPerLastDimension; ++c )
-        {
-          const unsigned int index = c % numParametersPerLastDimension;
-          mean[ index ] += derivative[ c ];
-        }
+        sampleOk = this->IsInsideMovingMask( mappedPoint );
       }
-      mean /= static_cast< RealType >( G );
 
-      /** Update derivative per control point. */
-      for( unsigned int t = 0; t < G; ++t )
+      if( sampleOk )
       {
-        const unsigned int startc = numParametersPerLastDimension * t;
-        for( unsigned int c = startc; c < startc + numParametersPerLastDimension; ++c )
-        {
-          const unsigned int index = c % numParametersPerLastDimension;
-          derivative[ c ] -= mean[ index ];
-        }
+        sampleOk = this->EvaluateMovingImageValueAndDerivative(
+          mappedPoint, movingImageValue, 0 );
       }
+
+      if( sampleOk )
+      {
+        numSamplesOk++;
+        datablock( pixelIndex, d ) = movingImageValue;
+      } // end if sampleOk
+
+    } // end loop over t
+
+    if( numSamplesOk == G )
+    {
+      SamplesOK.push_back( fixedPoint );
+      pixelIndex++;
     }
+
+  } // end loop over the sample container of this thread
+
+  /** Only update these variables at the end to prevent unnecessary "false sharing". */
+  this->m_PCAMetric2GetSamplesPerThreadVariables[ threadId ].st_NumberOfPixelsCounted = pixelIndex;
+  this->m_PCAMetric2GetSamplesPerThreadVariables[ threadId ].st_DataBlock             = datablock.extract( pixelIndex, G );
+  this->m_PCAMetric2GetSamplesPerThreadVariables[ threadId ].st_ApprovedSamples       = SamplesOK;
+
+} // end ThreadedGetSamples()
+
+
+/**
+ * ******************* AfterThreadedGetSamples *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+PCAMetric2< TFixedImage, TMovingImage >
+::AfterThreadedGetSamples( MeasureType & value ) const
+{
+  /** Accumulate the number of pixels. */
+  this->m_NumberOfPixelsCounted = this->m_PCAMetric2GetSamplesPerThreadVariables[ 0 ].st_NumberOfPixelsCounted;
+  for( ThreadIdType i = 1; i < this->m_NumberOfThreads; ++i )
+  {
+    this->m_NumberOfPixelsCounted += this->m_PCAMetric2GetSamplesPerThreadVariables[ i ].st_NumberOfPixelsCounted;
   }
 
-  /** Return the measure value. */
-  value = measure;
+  /** Check if enough samples were valid. */
+  ImageSampleContainerPointer sampleContainer = this->GetImageSampler()->GetOutput();
+  this->CheckNumberOfSamples( sampleContainer->Size(), this->m_NumberOfPixelsCounted );
+  const unsigned int N = this->m_NumberOfPixelsCounted;
 
-} // end GetValueAndDerivative()
+  /** Retrieve slowest varying dimension and its size. */
+  const unsigned int lastDim = this->GetFixedImage()->GetImageDimension() - 1;
+  const unsigned int G       = this->GetFixedImage()->GetLargestPossibleRegion().GetSize( lastDim );
+
+  /** Stack the data blocks of all threads, in thread order. */
+  MatrixType   A( N, G );
+  unsigned int row_start = 0;
+  for( ThreadIdType i = 0; i < this->m_NumberOfThreads; ++i )
+  {
+    A.update( this->m_PCAMetric2GetSamplesPerThreadVariables[ i ].st_DataBlock, row_start, 0 );
+    this->m_PixelStartIndex[ i ] = row_start;
+    row_start                   += this->m_PCAMetric2GetSamplesPerThreadVariables[ i ].st_DataBlock.rows();
+  }
+
+  /** Calculate mean of columns */
+  vnl_vector< RealType > mean( G );
+  mean.fill( NumericTraits< RealType >::Zero );
+  for( unsigned int i = 0; i < N; i++ )
+  {
+    for( unsigned int j = 0; j < G; j++ )
+    {
+      mean( j ) += A( i, j );
+    }
+  }
+  mean /= RealType( N );
+
+  /** Calculate standard deviation of columns */
+  MatrixType Amm( N, G );
+  Amm.fill( NumericTraits< RealType >::Zero );
+  for( unsigned int i = 0; i < N; i++ )
+  {
+    for( unsigned int j = 0; j < G; j++ )
+    {
+      Amm( i, j ) = A( i, j ) - mean( j );
+    }
+  }
+
+  /** Compute covariance matrix C */
+  this->m_Atmm = Amm.transpose();
+  MatrixType C( this->m_Atmm * Amm );
+  C /= static_cast< RealType >( RealType( N ) - 1.0 );
+
+  vnl_diag_matrix< RealType > S( G );
+  S.fill( NumericTraits< RealType >::Zero );
+  for( unsigned int j = 0; j < G; j++ )
+  {
+    S( j, j ) = 1.0 / sqrt( C( j, j ) );
+  }
+
+  /** Compute correlation matrix K */
+  MatrixType K( S * C * S );
+
+  /** Compute first eigenvalue and eigenvector of K */
+  vnl_symmetric_eigensystem< RealType > eig( K );
+
+  RealType sumWeightedEigenValues = itk::NumericTraits< RealType >::Zero;
+  for( unsigned int i = 0; i < G; i++ )
+  {
+    sumWeightedEigenValues += ( i + 1 ) * eig.get_eigenvalue( G - i - 1 );
+  }
+
+  MatrixType eigenVectorMatrix( G, G );
+  for( unsigned int i = 0; i < G; i++ )
+  {
+    eigenVectorMatrix.set_column( i, ( eig.get_eigenvector( G - i - 1 ) ).normalize() );
+  }
+
+  MatrixType eigenVectorMatrixTranspose( eigenVectorMatrix.transpose() );
+
+  /** Sub components of metric derivative */
+  vnl_diag_matrix< DerivativeValueType > dSdmu_part1( G );
+  for( unsigned int d = 0; d < G; d++ )
+  {
+    double S_sqr = S( d, d ) * S( d, d );
+    double S_qub = S_sqr * S( d, d );
+    dSdmu_part1( d, d ) = -S_qub;
+  }
+
+  this->m_vSAtmm       = eigenVectorMatrixTranspose * S * this->m_Atmm;
+  this->m_CSv          = C * S * eigenVectorMatrix;
+  this->m_Sv           = S * eigenVectorMatrix;
+  this->m_vdSdmu_part1 = eigenVectorMatrixTranspose * dSdmu_part1;
+
+  value = sumWeightedEigenValues;
+
+} // end AfterThreadedGetSamples()
+
+
+/**
+ * **************** GetSamplesThreaderCallback *******
+ */
+
+template< class TFixedImage, class TMovingImage >
+ITK_THREAD_RETURN_TYPE
+PCAMetric2< TFixedImage, TMovingImage >
+::GetSamplesThreaderCallback( void * arg )
+{
+  ThreadInfoType * infoStruct = static_cast< ThreadInfoType * >( arg );
+  ThreadIdType     threadId   = infoStruct->ThreadID;
+
+  MultiThreaderParameterType * temp
+    = static_cast< MultiThreaderParameterType * >( infoStruct->UserData );
+
+  static_cast< Self * >( temp->st_Metric )->ThreadedGetSamples( threadId );
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end GetSamplesThreaderCallback()
+
+
+/**
+ * *********************** LaunchGetSamplesThreaderCallback***************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+PCAMetric2< TFixedImage, TMovingImage >
+::LaunchGetSamplesThreaderCallback( void ) const
+{
+  /** Launch the threads of the persistent thread pool. */
+  PersistentThreadPool::SingleMethodExecute( this->GetSamplesThreaderCallback,
+    const_cast< void * >( static_cast< const void * >( &this->m_ThreaderMetricParameters ) ),
+    this->m_Threader->GetNumberOfThreads() );
+
+} // end LaunchGetSamplesThreaderCallback()
+
+
+/**
+ * ******************* ThreadedGetValueAndDerivative *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+PCAMetric2< TFixedImage, TMovingImage >
+::ThreadedGetValueAndDerivative( ThreadIdType threadId )
+{
+  /** Get a handle to the pre-allocated derivative for the current thread.
+   * The initialization is performed at the beginning of each resolution in
+   * InitializeThreadingParameters(), and at the end of each iteration in
+   * AccumulateDerivativesThreaderCallback().
+   */
+  DerivativeType & derivative = this->m_GetValueAndDerivativePerThreadVariables[ threadId ].st_Derivative;
+
+  /** Retrieve slowest varying dimension and its size. */
+  const unsigned int lastDim = this->GetFixedImage()->GetImageDimension() - 1;
+  const unsigned int G       = this->GetFixedImage()->GetLargestPossibleRegion().GetSize( lastDim );
+
+  /** Create variables to store intermediate results in. */
+  RealType                   movingImageValue;
+  MovingImagePointType       mappedPoint;
+  MovingImageDerivativeType  movingImageDerivative;
+  TransformJacobianType      jacobian;
+  DerivativeType             imageJacobian( this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices() );
+  NonZeroJacobianIndicesType nzji( this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices() );
+
+  /** The valid samples of this thread are located at the rows
+   * [ m_PixelStartIndex[ threadId ], m_PixelStartIndex[ threadId ] + #approved samples [
+   * of the sample matrix.
+   */
+  const std::vector< FixedImagePointType > & approvedSamples
+    = this->m_PCAMetric2GetSamplesPerThreadVariables[ threadId ].st_ApprovedSamples;
+  const unsigned int pixelStartIndex = this->m_PixelStartIndex[ threadId ];
+
+  /** Second loop over fixed image samples. */
+  for( unsigned int i = 0; i < approvedSamples.size(); ++i )
+  {
+    const unsigned int pixelIndex = pixelStartIndex + i;
+
+    /** Read fixed coordinates. */
+    FixedImagePointType fixedPoint = approvedSamples[ i ];
+
+    /** Transform sampled point to voxel coordinates. */
+    FixedImageContinuousIndexType voxelCoord;
+    this->GetFixedImage()->TransformPhysicalPointToContinuousIndex( fixedPoint, voxelCoord );
+
+    for( unsigned int d = 0; d < G; ++d )
+    {
+      /** Set fixed point's last dimension to lastDimPosition. */
+      voxelCoord[ lastDim ] = d;
+
+      /** Transform sampled point back to world coordinates. */
+      this->GetFixedImage()->TransformContinuousIndexToPhysicalPoint( voxelCoord, fixedPoint );
+      this->TransformPoint( fixedPoint, mappedPoint );
+
+      this->EvaluateMovingImageValueAndDerivative(
+        mappedPoint, movingImageValue, &movingImageDerivative );
+
+      /** Get the TransformJacobian dT/dmu */
+      this->EvaluateTransformJacobian( fixedPoint, jacobian, nzji );
+
+      /** Compute the innerproduct (dM/dx)^T (dT/dmu). */
+      this->EvaluateTransformJacobianInnerProduct(
+        jacobian, movingImageDerivative, imageJacobian );
+
+      /** build metric derivative components */
+      for( unsigned int p = 0; p < nzji.size(); ++p )
+      {
+        DerivativeValueType tmp = NumericTraits< DerivativeValueType >::Zero;
+        for( unsigned int z = 0; z < G; z++ )
+        {
+          tmp += z * ( this->m_vSAtmm[ z ][ pixelIndex ] * imageJacobian[ p ] * this->m_Sv[ d ][ z ]
+            + this->m_vdSdmu_part1[ z ][ d ] * this->m_Atmm[ d ][ pixelIndex ] * imageJacobian[ p ] * this->m_CSv[ d ][ z ] );
+        } // end loop over eigenvalues
+        derivative[ nzji[ p ] ] += tmp;
+      } // end loop over non-zero jacobian indices
+
+    } // end loop over last dimension
+
+  } // end second for loop over sample container
+
+} // end ThreadedGetValueAndDerivative()
+
+
+/**
+ * ******************* AfterThreadedGetValueAndDerivative *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+PCAMetric2< TFixedImage, TMovingImage >
+::AfterThreadedGetValueAndDerivative(
+  MeasureType & value, DerivativeType & derivative ) const
+{
+  /** Accumulate the derivatives of all threads, and normalize with 2 / ( N - 1 ). */
+  derivative = DerivativeType( this->GetNumberOfParameters() );
+  this->m_ThreaderMetricParameters.st_DerivativePointer   = derivative.begin();
+  this->m_ThreaderMetricParameters.st_NormalizationFactor
+    = ( DerivativeValueType( this->m_NumberOfPixelsCounted ) - 1.0 ) / 2.0;
+
+  /** Launch the threads of the persistent thread pool. */
+  PersistentThreadPool::SingleMethodExecute( this->AccumulateDerivativesThreaderCallback,
+    const_cast< void * >( static_cast< const void * >( &this->m_ThreaderMetricParameters ) ),
+    this->m_Threader->GetNumberOfThreads() );
+
+  /** Subtract mean from derivative elements. */
+  this->SubtractMeanFromDerivative( derivative );
+
+} // end AfterThreadedGetValueAndDerivative()
 
 
 } // end namespace itk
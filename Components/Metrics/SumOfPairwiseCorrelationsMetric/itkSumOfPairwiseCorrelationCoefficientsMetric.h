@@ -122,6 +122,10 @@ public:
   virtual void GetValueAndDerivative( const TransformParametersType & parameters,
     MeasureType & Value, DerivativeType & Derivative ) const;
 
+  /** Get value and derivatives single-threaded. */
+  void GetValueAndDerivativeSingleThreaded( const TransformParametersType & parameters,
+    MeasureType & Value, DerivativeType & Derivative ) const;
+
   /** Initialize the Metric by making sure that all the components
    *  are present and plugged together correctly.
    * \li Call the superclass' implementation.   */
@@ -131,7 +135,7 @@ public:
 protected:
 
   SumOfPairwiseCorrelationCoefficientsMetric();
-  virtual ~SumOfPairwiseCorrelationCoefficientsMetric() {}
+  virtual ~SumOfPairwiseCorrelationCoefficientsMetric();
   void PrintSelf( std::ostream & os, Indent indent ) const;
 
   /** Protected Typedefs ******************/
@@ -149,6 +153,12 @@ protected:
   typedef typename Superclass::CentralDifferenceGradientFilterType CentralDifferenceGradientFilterType;
   typedef typename Superclass::MovingImageDerivativeType           MovingImageDerivativeType;
   typedef typename Superclass::NonZeroJacobianIndicesType          NonZeroJacobianIndicesType;
+  typedef typename Superclass::ThreaderType                        ThreaderType;
+  typedef typename Superclass::ThreadInfoType                      ThreadInfoType;
+  typedef typename Superclass::MultiThreaderParameterType          MultiThreaderParameterType;
+  typedef typename DerivativeType::ValueType                       DerivativeValueType;
+  typedef vnl_matrix< RealType >                                   MatrixType;
+  typedef vnl_matrix< DerivativeValueType >                        DerivativeMatrixType;
 
   /** Computes the innerproduct of transform Jacobian with moving image gradient.
    * The results are stored in imageJacobian, which is supposed
@@ -158,6 +168,52 @@ protected:
     const MovingImageDerivativeType & movingImageDerivative,
     DerivativeType & imageJacobian ) const;
 
+  /** Subtract the mean from the derivative elements, see m_SubtractMean. */
+  void SubtractMeanFromDerivative( DerivativeType & derivative ) const;
+
+  /** Per-thread storage of the samples that are valid for all time points. */
+  struct SumOfPairwiseCorrelationCoefficientsGetSamplesPerThreadStruct
+  {
+    SizeValueType                      st_NumberOfPixelsCounted;
+    MatrixType                         st_DataBlock;
+    std::vector< FixedImagePointType > st_ApprovedSamples;
+  };
+
+  itkPadStruct( ITK_CACHE_LINE_ALIGNMENT, SumOfPairwiseCorrelationCoefficientsGetSamplesPerThreadStruct,
+    PaddedSumOfPairwiseCorrelationCoefficientsGetSamplesPerThreadStruct );
+
+  itkAlignedTypedef( ITK_CACHE_LINE_ALIGNMENT,
+    PaddedSumOfPairwiseCorrelationCoefficientsGetSamplesPerThreadStruct,
+    AlignedSumOfPairwiseCorrelationCoefficientsGetSamplesPerThreadStruct );
+
+  mutable AlignedSumOfPairwiseCorrelationCoefficientsGetSamplesPerThreadStruct * m_GetSamplesPerThreadVariables;
+  mutable ThreadIdType                                                           m_GetSamplesPerThreadVariablesSize;
+
+  /** Initialize some multi-threading related parameters. */
+  virtual void InitializeThreadingParameters( void ) const;
+
+  /** Collect the valid samples of a part of the sample container, for each thread. */
+  inline void ThreadedGetSamples( ThreadIdType threadID );
+
+  /** Combine the samples of all threads, compute the value and the
+   * matrices that are needed by ThreadedGetValueAndDerivative().
+   */
+  inline void AfterThreadedGetSamples( MeasureType & value ) const;
+
+  /** Helper functions to launch the ThreadedGetSamples() threads. */
+  static ITK_THREAD_RETURN_TYPE GetSamplesThreaderCallback( void * arg );
+
+  void LaunchGetSamplesThreaderCallback( void ) const;
+
+  /** Compute the derivative contributions of the samples of each thread. */
+  inline void ThreadedGetValueAndDerivative( ThreadIdType threadID );
+
+  /** Gather the derivatives from all threads. The value has already been
+   * computed by AfterThreadedGetSamples().
+   */
+  inline void AfterThreadedGetValueAndDerivative(
+    MeasureType & value, DerivativeType & derivative ) const;
+
 private:
 
   SumOfPairwiseCorrelationCoefficientsMetric( const Self & ); // purposely not implemented
@@ -179,6 +235,15 @@ private:
   /** Bool to indicate if the transform used is a stacktransform. Set by elx files. */
   bool m_TransformIsStackTransform;
 
+  /** Matrices, needed for the multi-threaded derivative calculation. */
+  mutable std::vector< unsigned int >            m_PixelStartIndex;
+  mutable MatrixType                             m_Atmm;
+  mutable DerivativeMatrixType                   m_KAtZscore;
+  mutable DerivativeMatrixType                   m_KAtZscoreAmm;
+  mutable vnl_diag_matrix< RealType >            m_S;
+  mutable vnl_diag_matrix< DerivativeValueType > m_dSdmu_part1;
+  mutable RealType                               m_NormK;
+
 };
 
 } // end namespace itk
@@ -20,7 +20,7 @@
 
 #include "itkSumOfPairwiseCorrelationCoefficientsMetric.h"
 
-#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkRandomVariateGeneratorInstance.h"
 #include "vnl/algo/vnl_matrix_update.h"
 #include "itkImage.h"
 #include <numeric>
@@ -40,9 +40,25 @@ SumOfPairwiseCorrelationCoefficientsMetric< TFixedImage, TMovingImage >
   this->SetUseImageSampler( true );
   this->SetUseFixedImageLimiter( false );
   this->SetUseMovingImageLimiter( false );
+
+  /** Initialize the m_GetSamplesPerThreadVariables. */
+  this->m_GetSamplesPerThreadVariables     = NULL;
+  this->m_GetSamplesPerThreadVariablesSize = 0;
 } // end constructor
 
 
+/**
+ * ******************* Destructor *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+SumOfPairwiseCorrelationCoefficientsMetric< TFixedImage, TMovingImage >
+::~SumOfPairwiseCorrelationCoefficientsMetric()
+{
+  delete[] this->m_GetSamplesPerThreadVariables;
+} // end Destructor
+
+
 /**
  * ******************* Initialize *******************
  */
@@ -83,7 +99,7 @@ SumOfPairwiseCorrelationCoefficientsMetric< TFixedImage, TMovingImage >
   numbers.clear();
 
   /** Initialize random number generator. */
-  Statistics::MersenneTwisterRandomVariateGenerator::Pointer randomGenerator = Statistics::MersenneTwisterRandomVariateGenerator::GetInstance();
+  Statistics::MersenneTwisterRandomVariateGenerator::Pointer randomGenerator = RandomVariateGeneratorInstance::Get();
 
   /** Sample additional at fixed timepoint. */
   for( unsigned int i = 0; i < m_NumAdditionalSamplesFixed; ++i )
@@ -169,8 +185,6 @@ SumOfPairwiseCorrelationCoefficientsMetric< TFixedImage, TMovingImage >
   const unsigned int lastDim = this->GetFixedImage()->GetImageDimension() - 1;
   const unsigned int G       = this->GetFixedImage()->GetLargestPossibleRegion().GetSize( lastDim );
 
-  typedef vnl_matrix< RealType > MatrixType;
-
   /** The rows of the ImageSampleMatrix contain the samples of the images of the stack */
   unsigned int NumberOfSamples = sampleContainer->Size();
   MatrixType   datablock( NumberOfSamples, G );
@@ -188,7 +202,7 @@ SumOfPairwiseCorrelationCoefficientsMetric< TFixedImage, TMovingImage >
 
     /** Transform sampled point to voxel coordinates. */
     FixedImageContinuousIndexType voxelCoord;
-    this->GetFixedImage()->TransformPhysicalPointToContinuousIndex( fixedPoint, voxelCoord );
+    this->ComputeFixedImageContinuousIndex( ( *fiter ).Index(), fixedPoint, voxelCoord );
 
     unsigned int numSamplesOk = 0;
 
@@ -310,21 +324,17 @@ SumOfPairwiseCorrelationCoefficientsMetric< TFixedImage, TMovingImage >
 
 
 /**
- * ******************* GetValueAndDerivative *******************
+ * ******************* GetValueAndDerivativeSingleThreaded *******************
  */
 
 template< class TFixedImage, class TMovingImage >
 void
 SumOfPairwiseCorrelationCoefficientsMetric< TFixedImage, TMovingImage >
-::GetValueAndDerivative( const TransformParametersType & parameters,
+::GetValueAndDerivativeSingleThreaded( const TransformParametersType & parameters,
   MeasureType & value, DerivativeType & derivative ) const
 {
   itkDebugMacro( "GetValueAndDerivative( " << parameters << " ) " );
 
-  /** Define derivative and Jacobian types. */
-  typedef typename DerivativeType::ValueType DerivativeValueType;
-  //typedef typename TransformJacobianType::ValueType TransformJacobianValueType;
-
   /** Initialize some variables */
   const unsigned int P = this->GetNumberOfParameters();
   this->m_NumberOfPixelsCounted = 0;
@@ -348,9 +358,6 @@ SumOfPairwiseCorrelationCoefficientsMetric< TFixedImage, TMovingImage >
   const unsigned int lastDim = this->GetFixedImage()->GetImageDimension() - 1;
   const unsigned int G       = this->GetFixedImage()->GetLargestPossibleRegion().GetSize( lastDim );
 
-  typedef vnl_matrix< RealType >            MatrixType;
-  typedef vnl_matrix< DerivativeValueType > DerivativeMatrixType;
-
   std::vector< FixedImagePointType > SamplesOK;
 
   /** The rows of the ImageSampleMatrix contain the samples of the images of the stack */
@@ -370,7 +377,7 @@ SumOfPairwiseCorrelationCoefficientsMetric< TFixedImage, TMovingImage >
 
     /** Transform sampled point to voxel coordinates. */
     FixedImageContinuousIndexType voxelCoord;
-    this->GetFixedImage()->TransformPhysicalPointToContinuousIndex( fixedPoint, voxelCoord );
+    this->ComputeFixedImageContinuousIndex( ( *fiter ).Index(), fixedPoint, voxelCoord );
 
     unsigned int numSamplesOk = 0;
 
@@ -541,80 +548,526 @@ SumOfPairwiseCorrelationCoefficientsMetric< TFixedImage, TMovingImage >
   measure = RealType( 1.0 - ( K.fro_norm() / RealType( G ) ) );
 
   /** Subtract mean from derivative elements. */
-  if( this->m_SubtractMean )
+  this->SubtractMeanFromDerivative( derivative );
+
+  /** Return the measure value. */
+  value = measure;
+
+} // end GetValueAndDerivativeSingleThreaded()
+
+
+/**
+ * ******************* SubtractMeanFromDerivative *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+SumOfPairwiseCorrelationCoefficientsMetric< TFixedImage, TMovingImage >
+::SubtractMeanFromDerivative( DerivativeType & derivative ) const
+{
+  if( !this->m_SubtractMean )
   {
-    if( !this->m_TransformIsStackTransform )
+    return;
+  }
+
+  /** Retrieve slowest varying dimension and its size. */
+  const unsigned int lastDim = this->GetFixedImage()->GetImageDimension() - 1;
+  const unsigned int G       = this->GetFixedImage()->GetLargestPossibleRegion().GetSize( lastDim );
+
+  if( !this->m_TransformIsStackTransform )
+  {
+    /** Update derivative per dimension.
+     * Parameters are ordered xxxxxxx yyyyyyy zzzzzzz ttttttt and
+     * per dimension xyz.
+     */
+    const unsigned int lastDimGridSize = this->m_GridSize[ lastDim ];
+    const unsigned int numParametersPerDimension
+      = this->GetNumberOfParameters() / this->GetMovingImage()->GetImageDimension();
+    const unsigned int numControlPointsPerDimension = numParametersPerDimension / lastDimGridSize;
+    DerivativeType     mean( numControlPointsPerDimension );
+    for( unsigned int d = 0; d < this->GetMovingImage()->GetImageDimension(); ++d )
     {
-      /** Update derivative per dimension.
-       * Parameters are ordered xxxxxxx yyyyyyy zzzzzzz ttttttt and
-       * per dimension xyz.
-       */
-      const unsigned int lastDimGridSize = this->m_GridSize[ lastDim ];
-      const unsigned int numParametersPerDimension
-        = this->GetNumberOfParameters() / this->GetMovingImage()->GetImageDimension();
-      const unsigned int numControlPointsPerDimension = numParametersPerDimension / lastDimGridSize;
-      DerivativeType     mean( numControlPointsPerDimension );
-      for( unsigned int d = 0; d < this->GetMovingImage()->GetImageDimension(); ++d )
+      /** Compute mean per dimension. */
+      mean.Fill( 0.0 );
+      const unsigned int starti = numParametersPerDimension * d;
+      for( unsigned int i = starti; i < starti + numParametersPerDimension; ++i )
+      {
+        const unsigned int index = i % numControlPointsPerDimension;
+        mean[ index ] += derivative[ i ];
+      }
+      mean /= static_cast< RealType >( lastDimGridSize );
+
+      /** Update derivative for every control point per dimension. */
+      for( unsigned int i = starti; i < starti + numParametersPerDimension; ++i )
       {
-        /** Compute mean per dimension. */
-        mean.Fill( 0.0 );
-        const unsigned int starti = numParametersPerDimension * d;
-        for( unsigned int i = starti; i < starti + numParametersPerDimension; ++i )
-        {
-          const unsigned int index = i % numControlPointsPerDimension;
-          mean[ index ] += derivative[ i ];
-        }
-        mean /= static_cast< double >( lastDimGridSize );
-
-        /** Update derivative for every control point per dimension. */
-        for( unsigned int i = starti; i < starti + numParametersPerDimension; ++i )
-        {
-          const unsigned int index = i % numControlPointsPerDimension;
-          derivative[ i ] -= mean[ index ];
-        }
+        const unsigned int index = i % numControlPointsPerDimension;
+        derivative[ i ] -= mean[ index ];
       }
     }
-    else
+  }
+  else
+  {
+    /** Update derivative per dimension.
+     * Parameters are ordered x0x0x0y0y0y0z0z0z0x1x1x1y1y1y1z1z1z1 with
+     * the number the time point index.
+     */
+    const unsigned int numParametersPerLastDimension = this->GetNumberOfParameters() / G;
+    DerivativeType     mean( numParametersPerLastDimension );
+    mean.Fill( 0.0 );
+
+    /** Compute mean per control point. */
+    for( unsigned int t = 0; t < G; ++t )
     {
-      /** Update derivative per dimension.
-       * Parameters are ordered x0x0x0y0y0y0z0z0z0x1x1x1y1y1y1z1z1z1 with
-       * the number the time point index.
-       */
-      const unsigned int numParametersPerLastDimension = this->GetNumberOfParameters() / G;
-      DerivativeType     mean( numParametersPerLastDimension );
-      mean.Fill( 0.0 );
-
-      /** Compute mean per control point. */
-      for( unsigned int t = 0; t < G; ++t )
+      const unsigned int startc = numParametersPerLastDimension * t;
+      for( unsigned int c = startc; c < startc + numParametersPerLastDimension; ++c )
       {
-        const unsigned int startc = numParametersPerLastDimension * t;
-        for( unsigned int c = startc; c < startc + numParametersPerLastDimension; ++c )
-        {
-          const unsigned int index = c % numParametersPerLastDimension;
-          mean[ index ] += derivative[ c ];
-        }
+        const unsigned int index = c % numParametersPerLastDimension;
+        mean[ index ] += derivative[ c ];
       }
-      mean /= static_cast< double >( G );
+    }
+    mean /= static_cast< RealType >( G );
 
-      /** Update derivative per control point. */
-      for( unsigned int t = 0; t < G; ++t )
+    /** Update derivative per control point. */
+    for( unsigned int t = 0; t < G; ++t )
+    {
+      const unsigned int startc = numParametersPerLastDimension * t;
+      for( unsigned int c = startc; c < startc + numParametersPerLastDimension; ++c )
       {
-        const unsigned int startc = numParametersPerLastDimension * t;
-        for( unsigned int c = startc; c < startc + numParametersPerLastDimension; ++c )
-        {
-          const unsigned int index = c % numParametersPerLastDimension;
-          derivative[ c ] -= mean[ index ];
-        }
+        const unsigned int index = c % numParametersPerLastDimension;
+        derivative[ c ] -= mean[ index ];
       }
     }
   }
 
-  /** Return the measure value. */
-  value = measure;
+} // end SubtractMeanFromDerivative()
+
+
+/**
+ * ********************* InitializeThreadingParameters ****************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+SumOfPairwiseCorrelationCoefficientsMetric< TFixedImage, TMovingImage >
+::InitializeThreadingParameters( void ) const
+{
+  /** Initialize the derivative accumulation structs of the superclass. */
+  Superclass::InitializeThreadingParameters();
+
+  /** Only resize the array of structs when needed. */
+  if( this->m_GetSamplesPerThreadVariablesSize != this->m_NumberOfThreads )
+  {
+    delete[] this->m_GetSamplesPerThreadVariables;
+    this->m_GetSamplesPerThreadVariables
+      = new AlignedSumOfPairwiseCorrelationCoefficientsGetSamplesPerThreadStruct[ this->m_NumberOfThreads ];
+    this->m_GetSamplesPerThreadVariablesSize = this->m_NumberOfThreads;
+  }
+
+  /** Some initialization. */
+  for( ThreadIdType i = 0; i < this->m_NumberOfThreads; ++i )
+  {
+    this->m_GetSamplesPerThreadVariables[ i ].st_NumberOfPixelsCounted = NumericTraits< SizeValueType >::Zero;
+  }
+
+  this->m_PixelStartIndex.resize( this->m_NumberOfThreads );
+
+} // end InitializeThreadingParameters()
+
+
+/**
+ * ******************* GetValueAndDerivative *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+SumOfPairwiseCorrelationCoefficientsMetric< TFixedImage, TMovingImage >
+::GetValueAndDerivative(
+  const TransformParametersType & parameters,
+  MeasureType & value, DerivativeType & derivative ) const
+{
+  /** Option for now to still use the single threaded code. */
+  if( !this->m_UseMultiThread )
+  {
+    return this->GetValueAndDerivativeSingleThreaded(
+      parameters, value, derivative );
+  }
+
+  /** Call non-thread-safe stuff, such as:
+   *   this->SetTransformParameters( parameters );
+   *   this->GetImageSampler()->Update();
+   * Because of these calls GetValueAndDerivative itself is not thread-safe,
+   * so cannot be called multiple times simultaneously.
+   * This is however needed in the CombinationImageToImageMetric.
+   * In that case, you need to:
+   * - switch the use of this function to on, using m_UseMetricSingleThreaded = true
+   * - call BeforeThreadedGetValueAndDerivative once (single-threaded) before
+   *   calling GetValueAndDerivative
+   * - switch the use of this function to off, using m_UseMetricSingleThreaded = false
+   * - Now you can call GetValueAndDerivative multi-threaded.
+   */
+  this->BeforeThreadedGetValueAndDerivative( parameters );
+
+  /** Launch multi-threading GetSamples. */
+  this->LaunchGetSamplesThreaderCallback();
+
+  /** Compute the metric value and the correlation matrices from the samples of all threads. */
+  this->AfterThreadedGetSamples( value );
+
+  /** Launch multi-threading derivative computation. */
+  this->LaunchGetValueAndDerivativeThreaderCallback();
+
+  /** Sum the derivative contributions from all threads. */
+  this->AfterThreadedGetValueAndDerivative( value, derivative );
 
 } // end GetValueAndDerivative()
 
 
+/**
+ * ******************* ThreadedGetSamples *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+SumOfPairwiseCorrelationCoefficientsMetric< TFixedImage, TMovingImage >
+::ThreadedGetSamples( ThreadIdType threadId )
+{
+  /** Get a handle to the sample container. */
+  ImageSampleContainerPointer sampleContainer     = this->GetImageSampler()->GetOutput();
+  const unsigned long         sampleContainerSize = sampleContainer->Size();
+
+  /** Get the samples for this thread. */
+  const unsigned long nrOfSamplesPerThreads
+    = static_cast< unsigned long >( vcl_ceil( static_cast< double >( sampleContainerSize )
+    / static_cast< double >( this->m_NumberOfThreads ) ) );
+  unsigned long pos_begin = nrOfSamplesPerThreads * threadId;
+  unsigned long pos_end   = nrOfSamplesPerThreads * ( threadId + 1 );
+  pos_begin = ( pos_begin > sampleContainerSize ) ? sampleContainerSize : pos_begin;
+  pos_end   = ( pos_end > sampleContainerSize ) ? sampleContainerSize : pos_end;
+
+  /** Create iterator over the sample container. */
+  typename ImageSampleContainerType::ConstIterator threader_fiter;
+  typename ImageSampleContainerType::ConstIterator threader_fbegin = sampleContainer->Begin();
+  typename ImageSampleContainerType::ConstIterator threader_fend   = sampleContainer->Begin();
+  threader_fbegin                                                 += (int)pos_begin;
+  threader_fend                                                   += (int)pos_end;
+
+  /** Retrieve slowest varying dimension and its size. */
+  const unsigned int lastDim = this->GetFixedImage()->GetImageDimension() - 1;
+  const unsigned int G       = this->GetFixedImage()->GetLargestPossibleRegion().GetSize( lastDim );
+
+  std::vector< FixedImagePointType > SamplesOK;
+  MatrixType                         datablock( pos_end - pos_begin, G );
+
+  unsigned int pixelIndex = 0;
+  for( threader_fiter = threader_fbegin; threader_fiter != threader_fend; ++threader_fiter )
+  {
+    /** Read fixed coordinates. */
+    FixedImagePointType fixedPoint = ( *threader_fiter ).Value().m_ImageCoordinates;
+
+    /** Transform sampled point to voxel coordinates. */
+    FixedImageContinuousIndexType voxelCoord;
+    this->ComputeFixedImageContinuousIndex( ( *threader_fiter ).Index(), fixedPoint, voxelCoord );
+
+    unsigned int numSamplesOk = 0;
+
+    /** Loop over t */
+    for( unsigned int d = 0; d < G; ++d )
+    {
+      /** Initialize some variables. */
+      RealType             movingImageValue;
+      MovingImagePointType mappedPoint;
+
+      /** Set fixed point's last dimension to lastDimPosition. */
+      voxelCoord[ lastDim ] = d;
+
+      /** Transform sampled point back to world coordinates. */
+      this->GetFixedImage()->TransformContinuousIndexToPhysicalPoint( voxelCoord, fixedPoint );
+
+      /** Transform point and check if it is inside the B-spline support region. */
+      bool sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
+
+      /** Check if point is inside mask. */
+      if( sampleOk )
+      {
+        sampleOk = this->IsInsideMovingMask( mappedPoint );
+      }
+
+      if( sampleOk )
+      {
+        sampleOk = this->EvaluateMovingImageValueAndDerivative(
+          mappedPoint, movingImageValue, 0 );
+      }
+
+      if( sampleOk )
+      {
+        numSamplesOk++;
+        datablock( pixelIndex, d ) = movingImageValue;
+      } // end if sampleOk
+
+    } // end loop over t
+
+    if( numSamplesOk == G )
+    {
+      SamplesOK.push_back( fixedPoint );
+      pixelIndex++;
+    }
+
+  } // end loop over the sample container of this thread
+
+  /** Only update these variables at the end to prevent unnecessary "false sharing". */
+  this->m_GetSamplesPerThreadVariables[ threadId ].st_NumberOfPixelsCounted = pixelIndex;
+  this->m_GetSamplesPerThreadVariables[ threadId ].st_DataBlock             = datablock.extract( pixelIndex, G );
+  this->m_GetSamplesPerThreadVariables[ threadId ].st_ApprovedSamples       = SamplesOK;
+
+} // end ThreadedGetSamples()
+
+
+/**
+ * ******************* AfterThreadedGetSamples *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+SumOfPairwiseCorrelationCoefficientsMetric< TFixedImage, TMovingImage >
+::AfterThreadedGetSamples( MeasureType & value ) const
+{
+  /** Accumulate the number of pixels. */
+  this->m_NumberOfPixelsCounted = this->m_GetSamplesPerThreadVariables[ 0 ].st_NumberOfPixelsCounted;
+  for( ThreadIdType i = 1; i < this->m_NumberOfThreads; ++i )
+  {
+    this->m_NumberOfPixelsCounted += this->m_GetSamplesPerThreadVariables[ i ].st_NumberOfPixelsCounted;
+  }
+
+  /** Check if enough samples were valid. */
+  ImageSampleContainerPointer sampleContainer = this->GetImageSampler()->GetOutput();
+  this->CheckNumberOfSamples( sampleContainer->Size(), this->m_NumberOfPixelsCounted );
+  const unsigned int N = this->m_NumberOfPixelsCounted;
+
+  /** Retrieve slowest varying dimension and its size. */
+  const unsigned int lastDim = this->GetFixedImage()->GetImageDimension() - 1;
+  const unsigned int G       = this->GetFixedImage()->GetLargestPossibleRegion().GetSize( lastDim );
+
+  /** Stack the data blocks of all threads, in thread order. */
+  MatrixType   A( N, G );
+  unsigned int row_start = 0;
+  for( ThreadIdType i = 0; i < this->m_NumberOfThreads; ++i )
+  {
+    A.update( this->m_GetSamplesPerThreadVariables[ i ].st_DataBlock, row_start, 0 );
+    this->m_PixelStartIndex[ i ] = row_start;
+    row_start                   += this->m_GetSamplesPerThreadVariables[ i ].st_DataBlock.rows();
+  }
+
+  /** Calculate mean of columns */
+  vnl_vector< RealType > mean( G );
+  mean.fill( NumericTraits< RealType >::Zero );
+  for( unsigned int i = 0; i < N; i++ )
+  {
+    for( unsigned int j = 0; j < G; j++ )
+    {
+      mean( j ) += A( i, j );
+    }
+  }
+  mean /= RealType( N );
+
+  /** Calculate standard deviation of columns */
+  MatrixType Amm( N, G );
+  Amm.fill( NumericTraits< RealType >::Zero );
+  for( unsigned int i = 0; i < N; i++ )
+  {
+    for( unsigned int j = 0; j < G; j++ )
+    {
+      Amm( i, j ) = A( i, j ) - mean( j );
+    }
+  }
+
+  /** Compute covariance matrix C */
+  this->m_Atmm = Amm.transpose();
+  MatrixType C( this->m_Atmm * Amm );
+  C /= static_cast< RealType >( RealType( N ) - 1.0 );
+
+  vnl_diag_matrix< RealType > S( G );
+  S.fill( NumericTraits< RealType >::Zero );
+  for( unsigned int j = 0; j < G; j++ )
+  {
+    S( j, j ) = 1.0 / sqrt( C( j, j ) );
+  }
+
+  this->m_S = S;
+
+  /** Compute correlation matrix K */
+  DerivativeMatrixType K( S * C * S );
+  this->m_NormK = K.fro_norm();
+
+  /** Sub components of metric derivative */
+  this->m_dSdmu_part1.set_size( G );
+  for( unsigned int d = 0; d < G; d++ )
+  {
+    double S_sqr = S( d, d ) * S( d, d );
+    double S_qub = S_sqr * S( d, d );
+    this->m_dSdmu_part1( d, d ) = -S_qub / ( DerivativeValueType( N ) - 1.0 );
+  }
+
+  this->m_KAtZscore    = K * ( Amm * S ).transpose();
+  this->m_KAtZscoreAmm = this->m_KAtZscore * Amm;
+
+  value = RealType( 1.0 - ( this->m_NormK / RealType( G ) ) );
+
+} // end AfterThreadedGetSamples()
+
+
+/**
+ * **************** GetSamplesThreaderCallback *******
+ */
+
+template< class TFixedImage, class TMovingImage >
+ITK_THREAD_RETURN_TYPE
+SumOfPairwiseCorrelationCoefficientsMetric< TFixedImage, TMovingImage >
+::GetSamplesThreaderCallback( void * arg )
+{
+  ThreadInfoType * infoStruct = static_cast< ThreadInfoType * >( arg );
+  ThreadIdType     threadId   = infoStruct->ThreadID;
+
+  MultiThreaderParameterType * temp
+    = static_cast< MultiThreaderParameterType * >( infoStruct->UserData );
+
+  static_cast< Self * >( temp->st_Metric )->ThreadedGetSamples( threadId );
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end GetSamplesThreaderCallback()
+
+
+/**
+ * *********************** LaunchGetSamplesThreaderCallback***************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+SumOfPairwiseCorrelationCoefficientsMetric< TFixedImage, TMovingImage >
+::LaunchGetSamplesThreaderCallback( void ) const
+{
+  /** Launch the threads of the persistent thread pool. */
+  PersistentThreadPool::SingleMethodExecute( this->GetSamplesThreaderCallback,
+    const_cast< void * >( static_cast< const void * >( &this->m_ThreaderMetricParameters ) ),
+    this->m_Threader->GetNumberOfThreads() );
+
+} // end LaunchGetSamplesThreaderCallback()
+
+
+/**
+ * ******************* ThreadedGetValueAndDerivative *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+SumOfPairwiseCorrelationCoefficientsMetric< TFixedImage, TMovingImage >
+::ThreadedGetValueAndDerivative( ThreadIdType threadId )
+{
+  /** Get a handle to the pre-allocated derivative for the current thread.
+   * The initialization is performed at the beginning of each resolution in
+   * InitializeThreadingParameters(), and at the end of each iteration in
+   * AccumulateDerivativesThreaderCallback().
+   */
+  DerivativeType & derivative = this->m_GetValueAndDerivativePerThreadVariables[ threadId ].st_Derivative;
+
+  /** Retrieve slowest varying dimension and its size. */
+  const unsigned int lastDim = this->GetFixedImage()->GetImageDimension() - 1;
+  const unsigned int G       = this->GetFixedImage()->GetLargestPossibleRegion().GetSize( lastDim );
+
+  /** Create variables to store intermediate results in. */
+  RealType                   movingImageValue;
+  MovingImagePointType       mappedPoint;
+  MovingImageDerivativeType  movingImageDerivative;
+  TransformJacobianType      jacobian;
+  DerivativeType             imageJacobian( this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices() );
+  NonZeroJacobianIndicesType nzji( this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices() );
+
+  /** The valid samples of this thread are located at the rows
+   * [ m_PixelStartIndex[ threadId ], m_PixelStartIndex[ threadId ] + #approved samples [
+   * of the sample matrix.
+   */
+  const std::vector< FixedImagePointType > & approvedSamples
+    = this->m_GetSamplesPerThreadVariables[ threadId ].st_ApprovedSamples;
+  const unsigned int pixelStartIndex = this->m_PixelStartIndex[ threadId ];
+
+  /** Second loop over fixed image samples. */
+  for( unsigned int i = 0; i < approvedSamples.size(); ++i )
+  {
+    const unsigned int pixelIndex = pixelStartIndex + i;
+
+    /** Read fixed coordinates. */
+    FixedImagePointType fixedPoint = approvedSamples[ i ];
+
+    /** Transform sampled point to voxel coordinates. */
+    FixedImageContinuousIndexType voxelCoord;
+    this->GetFixedImage()->TransformPhysicalPointToContinuousIndex( fixedPoint, voxelCoord );
+
+    for( unsigned int d = 0; d < G; ++d )
+    {
+      /** Set fixed point's last dimension to lastDimPosition. */
+      voxelCoord[ lastDim ] = d;
+
+      /** Transform sampled point back to world coordinates. */
+      this->GetFixedImage()->TransformContinuousIndexToPhysicalPoint( voxelCoord, fixedPoint );
+      this->TransformPoint( fixedPoint, mappedPoint );
+
+      this->EvaluateMovingImageValueAndDerivative(
+        mappedPoint, movingImageValue, &movingImageDerivative );
+
+      /** Get the TransformJacobian dT/dmu */
+      this->EvaluateTransformJacobian( fixedPoint, jacobian, nzji );
+
+      /** Compute the innerproduct (dM/dx)^T (dT/dmu). */
+      this->EvaluateTransformJacobianInnerProduct(
+        jacobian, movingImageDerivative, imageJacobian );
+
+      /** build metric derivative components */
+      for( unsigned int p = 0; p < nzji.size(); ++p )
+      {
+        derivative[ nzji[ p ] ] += this->m_KAtZscore[ d ][ pixelIndex ] * imageJacobian[ p ] * this->m_S( d, d );
+        derivative[ nzji[ p ] ] += this->m_dSdmu_part1( d, d ) * this->m_Atmm[ d ][ pixelIndex ]
+          * imageJacobian[ p ] * this->m_KAtZscoreAmm[ d ][ d ];
+      } // end loop over non-zero jacobian indices
+
+    } // end loop over last dimension
+
+  } // end second for loop over sample container
+
+} // end ThreadedGetValueAndDerivative()
+
+
+/**
+ * ******************* AfterThreadedGetValueAndDerivative *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+SumOfPairwiseCorrelationCoefficientsMetric< TFixedImage, TMovingImage >
+::AfterThreadedGetValueAndDerivative(
+  MeasureType & value, DerivativeType & derivative ) const
+{
+  /** Retrieve slowest varying dimension and its size. */
+  const unsigned int lastDim = this->GetFixedImage()->GetImageDimension() - 1;
+  const unsigned int G       = this->GetFixedImage()->GetLargestPossibleRegion().GetSize( lastDim );
+
+  /** Accumulate the derivatives of all threads, and normalize with -2 / ( ( N - 1 ) * |K| * G ). */
+  derivative = DerivativeType( this->GetNumberOfParameters() );
+  this->m_ThreaderMetricParameters.st_DerivativePointer   = derivative.begin();
+  this->m_ThreaderMetricParameters.st_NormalizationFactor
+    = -( DerivativeValueType( this->m_NumberOfPixelsCounted ) - 1.0 )
+    * this->m_NormK * RealType( G ) / 2.0;
+
+  /** Launch the threads of the persistent thread pool. */
+  PersistentThreadPool::SingleMethodExecute( this->AccumulateDerivativesThreaderCallback,
+    const_cast< void * >( static_cast< const void * >( &this->m_ThreaderMetricParameters ) ),
+    this->m_Threader->GetNumberOfThreads() );
+
+  /** Subtract mean from derivative elements. */
+  this->SubtractMeanFromDerivative( derivative );
+
+} // end AfterThreadedGetValueAndDerivative()
+
+
 } // end namespace itk
 
 #endif // __itkSumOfPairwiseCorrelationCoefficientsMetric_HXX__
@@ -233,16 +233,29 @@ void SumSquaredTissueVolumeDifferenceImageToImageMetric<TFixedImage,TMovingImage
   threader_fbegin += (int)pos_begin;
   threader_fend += (int)pos_end;
 
+  /** Blocks of fixed points and their transformed counterparts. */
+  FixedImagePointType  fixedPoints[ Self::TransformPointsBlockSize ];
+  MovingImagePointType mappedPoints[ Self::TransformPointsBlockSize ];
+  SizeValueType        blockSize  = 0;
+  SizeValueType        blockIndex = 0;
+
   /** Loop over the fixed image to calculate the mean squares. */
-  for( threader_fiter = threader_fbegin; threader_fiter != threader_fend; ++threader_fiter )
+  for( threader_fiter = threader_fbegin; threader_fiter != threader_fend; ++threader_fiter, ++blockIndex )
   {
+    /** Transform the next block of samples with a single call to the transform. */
+    if( blockIndex == blockSize )
+    {
+      blockSize  = this->TransformSampleBlock( threader_fiter, threader_fend, fixedPoints, mappedPoints );
+      blockIndex = 0;
+    }
+
     /** Read fixed coordinates and initialize some variables. */
-    const FixedImagePointType & fixedPoint = (*threader_fiter).Value().m_ImageCoordinates;
+    const FixedImagePointType &  fixedPoint  = fixedPoints[ blockIndex ];
+    const MovingImagePointType & mappedPoint = mappedPoints[ blockIndex ];
     RealType movingImageValue;
-    MovingImagePointType mappedPoint;
 
-    /** Transform point and check if it is inside the B-spline support region. */
-    bool sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
+    /** The mapped point is always valid for now; see TransformPoint(). */
+    bool sampleOk = true;
 
     /** Check if point is inside mask. */
     if( sampleOk )
@@ -559,17 +572,30 @@ SumSquaredTissueVolumeDifferenceImageToImageMetric<TFixedImage, TMovingImage>
   threader_fbegin += (int)pos_begin;
   threader_fend += (int)pos_end;
 
+  /** Blocks of fixed points and their transformed counterparts. */
+  FixedImagePointType  fixedPoints[ Self::TransformPointsBlockSize ];
+  MovingImagePointType mappedPoints[ Self::TransformPointsBlockSize ];
+  SizeValueType        blockSize  = 0;
+  SizeValueType        blockIndex = 0;
+
   /** Loop over the fixed image to calculate the mean squares. */
-  for( threader_fiter = threader_fbegin; threader_fiter != threader_fend; ++threader_fiter )
+  for( threader_fiter = threader_fbegin; threader_fiter != threader_fend; ++threader_fiter, ++blockIndex )
   {
+    /** Transform the next block of samples with a single call to the transform. */
+    if( blockIndex == blockSize )
+    {
+      blockSize  = this->TransformSampleBlock( threader_fiter, threader_fend, fixedPoints, mappedPoints );
+      blockIndex = 0;
+    }
+
     /** Read fixed coordinates and initialize some variables. */
-    const FixedImagePointType & fixedPoint = (*threader_fiter).Value().m_ImageCoordinates;
+    const FixedImagePointType &  fixedPoint  = fixedPoints[ blockIndex ];
+    const MovingImagePointType & mappedPoint = mappedPoints[ blockIndex ];
     RealType movingImageValue;
-    MovingImagePointType mappedPoint;
     MovingImageDerivativeType movingImageDerivative;
 
-    /** Transform point and check if it is inside the B-spline support region. */
-    bool sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
+    /** The mapped point is always valid for now; see TransformPoint(). */
+    bool sampleOk = true;
 
     /** Check if point is inside mask. */
     if( sampleOk )
@@ -693,9 +719,10 @@ SumSquaredTissueVolumeDifferenceImageToImageMetric<TFixedImage, TMovingImage>
     this->m_ThreaderMetricParameters.st_NormalizationFactor =
       static_cast<DerivativeValueType>(this->m_NumberOfPixelsCounted);
 
-    this->m_Threader->SetSingleMethod(this->AccumulateDerivativesThreaderCallback,
-      const_cast<void *>(static_cast<const void *>(&this->m_ThreaderMetricParameters)));
-    this->m_Threader->SingleMethodExecute();
+    /** Launch the threads of the persistent thread pool. */
+    PersistentThreadPool::SingleMethodExecute(this->AccumulateDerivativesThreaderCallback,
+      const_cast<void *>(static_cast<const void *>(&this->m_ThreaderMetricParameters)),
+      this->m_Threader->GetNumberOfThreads());
   }
 
 #ifdef ELASTIX_USE_OPENMP
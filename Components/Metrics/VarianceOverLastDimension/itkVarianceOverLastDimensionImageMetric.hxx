@@ -19,7 +19,7 @@
 #define __itkVarianceOverLastDimensionImageMetric_hxx
 
 #include "itkVarianceOverLastDimensionImageMetric.h"
-#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkRandomVariateGeneratorInstance.h"
 #include "vnl/algo/vnl_matrix_update.h"
 #include <numeric>
 
@@ -138,7 +138,7 @@ VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
 
   /** Initialize random number generator. */
   Statistics::MersenneTwisterRandomVariateGenerator::Pointer randomGenerator
-    = Statistics::MersenneTwisterRandomVariateGenerator::GetInstance();
+    = RandomVariateGeneratorInstance::Get();
 
   /** Sample additional at fixed timepoint. */
   for( unsigned int i = 0; i < m_NumAdditionalSamplesFixed; ++i )
@@ -261,7 +261,7 @@ VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
 
     /** Transform sampled point to voxel coordinates. */
     FixedImageContinuousIndexType voxelCoord;
-    this->GetFixedImage()->TransformPhysicalPointToContinuousIndex( fixedPoint, voxelCoord );
+    this->ComputeFixedImageContinuousIndex( ( *fiter ).Index(), fixedPoint, voxelCoord );
 
     /** Loop over the slowest varying dimension. */
     float              sumValues               = 0.0;
@@ -355,20 +355,17 @@ VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
 
 
 /**
- * ******************* GetValueAndDerivative *******************
+ * ******************* GetValueAndDerivativeSingleThreaded *******************
  */
 
 template< class TFixedImage, class TMovingImage >
 void
 VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
-::GetValueAndDerivative( const TransformParametersType & parameters,
+::GetValueAndDerivativeSingleThreaded( const TransformParametersType & parameters,
   MeasureType & value, DerivativeType & derivative ) const
 {
   itkDebugMacro( "GetValueAndDerivative( " << parameters << " ) " );
 
-  /** Define derivative and Jacobian types. */
-  typedef typename DerivativeType::ValueType DerivativeValueType;
-
   /** Initialize some variables */
   this->m_NumberOfPixelsCounted = 0;
   MeasureType measure = NumericTraits< MeasureType >::Zero;
@@ -449,7 +446,7 @@ VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
 
     /** Transform sampled point to voxel coordinates. */
     FixedImageContinuousIndexType voxelCoord;
-    this->GetFixedImage()->TransformPhysicalPointToContinuousIndex( fixedPoint, voxelCoord );
+    this->ComputeFixedImageContinuousIndex( ( *fiter ).Index(), fixedPoint, voxelCoord );
 
     /** Loop over the slowest varying dimension. */
     float        sumValues        = 0.0;
@@ -543,77 +540,393 @@ VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
   derivative /= static_cast< float >( this->m_NumberOfPixelsCounted * this->m_InitialVariance );
 
   /** Subtract mean from derivative elements. */
-  if( this->m_SubtractMean )
+  this->SubtractMeanFromDerivative( derivative );
+
+  /** Return the measure value. */
+  value = measure;
+
+} // end GetValueAndDerivativeSingleThreaded()
+
+
+/**
+ * ******************* SubtractMeanFromDerivative *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
+::SubtractMeanFromDerivative( DerivativeType & derivative ) const
+{
+  if( !this->m_SubtractMean )
   {
-    if( !this->m_TransformIsStackTransform )
+    return;
+  }
+
+  /** Retrieve slowest varying dimension and its size. */
+  const unsigned int lastDim = this->GetFixedImage()->GetImageDimension() - 1;
+  const unsigned int lastDimSize
+    = this->GetFixedImage()->GetLargestPossibleRegion().GetSize( lastDim );
+
+  if( !this->m_TransformIsStackTransform )
+  {
+    /** Update derivative per dimension.
+    * Parameters are ordered xxxxxxx yyyyyyy zzzzzzz ttttttt and
+    * per dimension xyz.
+    */
+    const unsigned int lastDimGridSize              = this->m_GridSize[ lastDim ];
+    const unsigned int numParametersPerDimension    = this->GetNumberOfParameters() / this->GetMovingImage()->GetImageDimension();
+    const unsigned int numControlPointsPerDimension = numParametersPerDimension / lastDimGridSize;
+    DerivativeType     mean( numControlPointsPerDimension );
+    for( unsigned int d = 0; d < this->GetMovingImage()->GetImageDimension(); ++d )
     {
-      /** Update derivative per dimension.
-      * Parameters are ordered xxxxxxx yyyyyyy zzzzzzz ttttttt and
-      * per dimension xyz.
-      */
-      const unsigned int lastDimGridSize              = this->m_GridSize[ lastDim ];
-      const unsigned int numParametersPerDimension    = this->GetNumberOfParameters() / this->GetMovingImage()->GetImageDimension();
-      const unsigned int numControlPointsPerDimension = numParametersPerDimension / lastDimGridSize;
-      DerivativeType     mean( numControlPointsPerDimension );
-      for( unsigned int d = 0; d < this->GetMovingImage()->GetImageDimension(); ++d )
+      /** Compute mean per dimension. */
+      mean.Fill( 0.0 );
+      const unsigned int starti = numParametersPerDimension * d;
+      for( unsigned int i = starti; i < starti + numParametersPerDimension; ++i )
       {
-        /** Compute mean per dimension. */
-        mean.Fill( 0.0 );
-        const unsigned int starti = numParametersPerDimension * d;
-        for( unsigned int i = starti; i < starti + numParametersPerDimension; ++i )
-        {
-          const unsigned int index = i % numControlPointsPerDimension;
-          mean[ index ] += derivative[ i ];
-        }
-        mean /= static_cast< double >( lastDimGridSize );
+        const unsigned int index = i % numControlPointsPerDimension;
+        mean[ index ] += derivative[ i ];
+      }
+      mean /= static_cast< double >( lastDimGridSize );
 
-        /** Update derivative for every control point per dimension. */
-        for( unsigned int i = starti; i < starti + numParametersPerDimension; ++i )
-        {
-          const unsigned int index = i % numControlPointsPerDimension;
-          derivative[ i ] -= mean[ index ];
-        }
+      /** Update derivative for every control point per dimension. */
+      for( unsigned int i = starti; i < starti + numParametersPerDimension; ++i )
+      {
+        const unsigned int index = i % numControlPointsPerDimension;
+        derivative[ i ] -= mean[ index ];
       }
     }
-    else
+  }
+  else
+  {
+    /** Update derivative per dimension.
+    * Parameters are ordered x0x0x0y0y0y0z0z0z0x1x1x1y1y1y1z1z1z1 with
+    * the number the time point index.
+    */
+    const unsigned int numParametersPerLastDimension = this->GetNumberOfParameters() / lastDimSize;
+    DerivativeType     mean( numParametersPerLastDimension );
+    mean.Fill( 0.0 );
+
+    /** Compute mean per control point. */
+    for( unsigned int t = 0; t < lastDimSize; ++t )
     {
-      /** Update derivative per dimension.
-      * Parameters are ordered x0x0x0y0y0y0z0z0z0x1x1x1y1y1y1z1z1z1 with
-      * the number the time point index.
-      */
-      const unsigned int numParametersPerLastDimension = this->GetNumberOfParameters() / lastDimSize;
-      DerivativeType     mean( numParametersPerLastDimension );
-      mean.Fill( 0.0 );
+      const unsigned int startc = numParametersPerLastDimension * t;
+      for( unsigned int c = startc; c < startc + numParametersPerLastDimension; ++c )
+      {
+        const unsigned int index = c % numParametersPerLastDimension;
+        mean[ index ] += derivative[ c ];
+      }
+    }
+    mean /= static_cast< double >( lastDimSize );
 
-      /** Compute mean per control point. */
-      for( unsigned int t = 0; t < lastDimSize; ++t )
+    /** Update derivative per control point. */
+    for( unsigned int t = 0; t < lastDimSize; ++t )
+    {
+      const unsigned int startc = numParametersPerLastDimension * t;
+      for( unsigned int c = startc; c < startc + numParametersPerLastDimension; ++c )
       {
-        const unsigned int startc = numParametersPerLastDimension * t;
-        for( unsigned int c = startc; c < startc + numParametersPerLastDimension; ++c )
-        {
-          const unsigned int index = c % numParametersPerLastDimension;
-          mean[ index ] += derivative[ c ];
-        }
+        const unsigned int index = c % numParametersPerLastDimension;
+        derivative[ c ] -= mean[ index ];
+      }
+    }
+  }
+
+} // end SubtractMeanFromDerivative()
+
+
+/**
+ * ******************* GetValueAndDerivative *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
+::GetValueAndDerivative( const TransformParametersType & parameters,
+  MeasureType & value, DerivativeType & derivative ) const
+{
+  /** Option for now to still use the single threaded code. */
+  if( !this->m_UseMultiThread )
+  {
+    return this->GetValueAndDerivativeSingleThreaded(
+      parameters, value, derivative );
+  }
+
+  /** Call non-thread-safe stuff, such as:
+   *   this->SetTransformParameters( parameters );
+   *   this->GetImageSampler()->Update();
+   * Because of these calls GetValueAndDerivative itself is not thread-safe,
+   * so cannot be called multiple times simultaneously.
+   */
+  this->BeforeThreadedGetValueAndDerivative( parameters );
+
+  /** Draw the random last dimension positions of all samples up front,
+   * in sample order, so that the threads do not share the random generator
+   * and the result equals the single-threaded one.
+   */
+  if( this->m_SampleLastDimensionRandomly )
+  {
+    const unsigned int lastDim = this->GetFixedImage()->GetImageDimension() - 1;
+    const unsigned int lastDimSize
+      = this->GetFixedImage()->GetLargestPossibleRegion().GetSize( lastDim );
+    const unsigned long numberOfSamples = this->GetImageSampler()->GetOutput()->Size();
+
+    std::vector< int > lastDimPositions;
+    this->m_RandomLastDimPositions.clear();
+    this->m_RandomLastDimPositions.reserve(
+      numberOfSamples * ( this->m_NumSamplesLastDimension + this->m_NumAdditionalSamplesFixed ) );
+    for( unsigned long i = 0; i < numberOfSamples; ++i )
+    {
+      this->SampleRandom( this->m_NumSamplesLastDimension, lastDimSize, lastDimPositions );
+      this->m_RandomLastDimPositions.insert( this->m_RandomLastDimPositions.end(),
+        lastDimPositions.begin(), lastDimPositions.end() );
+    }
+  }
+
+  /** Launch multi-threading metric */
+  this->LaunchGetValueAndDerivativeThreaderCallback();
+
+  /** Gather the metric values and derivatives from all threads. */
+  this->AfterThreadedGetValueAndDerivative( value, derivative );
+
+} // end GetValueAndDerivative()
+
+
+/**
+ * ******************* ThreadedGetValueAndDerivative *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
+::ThreadedGetValueAndDerivative( ThreadIdType threadId )
+{
+  /** Get a handle to the pre-allocated derivative for the current thread.
+   * The initialization is performed at the beginning of each resolution in
+   * InitializeThreadingParameters(), and at the end of each iteration in
+   * AccumulateDerivativesThreaderCallback().
+   */
+  DerivativeType & derivative = this->m_GetValueAndDerivativePerThreadVariables[ threadId ].st_Derivative;
+
+  /** Get a handle to the sample container. */
+  ImageSampleContainerPointer sampleContainer     = this->GetImageSampler()->GetOutput();
+  const unsigned long         sampleContainerSize = sampleContainer->Size();
+
+  /** Get the samples for this thread. */
+  const unsigned long nrOfSamplesPerThreads
+    = static_cast< unsigned long >( vcl_ceil( static_cast< double >( sampleContainerSize )
+    / static_cast< double >( this->m_NumberOfThreads ) ) );
+
+  unsigned long pos_begin = nrOfSamplesPerThreads * threadId;
+  unsigned long pos_end   = nrOfSamplesPerThreads * ( threadId + 1 );
+  pos_begin = ( pos_begin > sampleContainerSize ) ? sampleContainerSize : pos_begin;
+  pos_end   = ( pos_end > sampleContainerSize ) ? sampleContainerSize : pos_end;
+
+  /** Create iterator over the sample container. */
+  typename ImageSampleContainerType::ConstIterator threader_fiter;
+  typename ImageSampleContainerType::ConstIterator threader_fbegin = sampleContainer->Begin();
+  typename ImageSampleContainerType::ConstIterator threader_fend   = sampleContainer->Begin();
+
+  threader_fbegin += (int)pos_begin;
+  threader_fend   += (int)pos_end;
+
+  /** Retrieve slowest varying dimension and its size. */
+  const unsigned int lastDim = this->GetFixedImage()->GetImageDimension() - 1;
+  const unsigned int lastDimSize
+    = this->GetFixedImage()->GetLargestPossibleRegion().GetSize( lastDim );
+
+  /** Get real last dim samples. */
+  const unsigned int realNumLastDimPositions
+    = this->m_SampleLastDimensionRandomly
+    ? this->m_NumSamplesLastDimension + this->m_NumAdditionalSamplesFixed
+    : lastDimSize;
+
+  /** Vector containing last dimension positions to use:
+   * initialize on all positions when random sampling turned off.
+   */
+  std::vector< int > lastDimPositions( realNumLastDimPositions );
+  if( !this->m_SampleLastDimensionRandomly )
+  {
+    for( unsigned int i = 0; i < lastDimSize; ++i )
+    {
+      lastDimPositions[ i ] = i;
+    }
+  }
+
+  /** Create variables to store intermediate results in. */
+  TransformJacobianType jacobian;
+  DerivativeType        imageJacobian( this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices() );
+
+  std::vector< NonZeroJacobianIndicesType > nzjis( realNumLastDimPositions, NonZeroJacobianIndicesType() );
+  std::vector< RealType >                   MT( realNumLastDimPositions );
+  std::vector< DerivativeType >             dMTdmu( realNumLastDimPositions );
+
+  /** Create variables to store intermediate results. circumvent false sharing */
+  unsigned long numberOfPixelsCounted = 0;
+  MeasureType   measure               = NumericTraits< MeasureType >::Zero;
+
+  /** Loop over the fixed image samples to calculate the variance over time for every sample position. */
+  unsigned long sampleNr = pos_begin;
+  for( threader_fiter = threader_fbegin; threader_fiter != threader_fend; ++threader_fiter, ++sampleNr )
+  {
+    /** Read fixed coordinates. */
+    FixedImagePointType fixedPoint = ( *threader_fiter ).Value().m_ImageCoordinates;
+
+    /** Get the random last dimension positions of this sample, if needed. */
+    if( this->m_SampleLastDimensionRandomly )
+    {
+      std::vector< int >::const_iterator positionsBegin
+        = this->m_RandomLastDimPositions.begin() + sampleNr * realNumLastDimPositions;
+      std::copy( positionsBegin, positionsBegin + realNumLastDimPositions, lastDimPositions.begin() );
+    }
+
+    /** Initialize MT vector. */
+    std::fill( MT.begin(), MT.end(), itk::NumericTraits< RealType >::ZeroValue() );
+
+    /** Transform sampled point to voxel coordinates. */
+    FixedImageContinuousIndexType voxelCoord;
+    this->ComputeFixedImageContinuousIndex( ( *threader_fiter ).Index(), fixedPoint, voxelCoord );
+
+    /** Loop over the slowest varying dimension. */
+    float        sumValues        = 0.0;
+    float        sumValuesSquared = 0.0;
+    unsigned int numSamplesOk     = 0;
+
+    /** First loop over t: compute M(T(x,t)), dM(T(x,t))/dmu, nzji and store. */
+    for( unsigned int d = 0; d < realNumLastDimPositions; ++d )
+    {
+      /** Initialize some variables. */
+      RealType                  movingImageValue;
+      MovingImagePointType      mappedPoint;
+      MovingImageDerivativeType movingImageDerivative;
+
+      /** Set fixed point's last dimension to lastDimPosition. */
+      voxelCoord[ lastDim ] = lastDimPositions[ d ];
+      /** Transform sampled point back to world coordinates. */
+      this->GetFixedImage()->TransformContinuousIndexToPhysicalPoint( voxelCoord, fixedPoint );
+      /** Transform point and check if it is inside the B-spline support region. */
+      bool sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
+
+      /** Check if point is inside mask. */
+      if( sampleOk )
+      {
+        sampleOk = this->IsInsideMovingMask( mappedPoint );
+      }
+
+      /** Compute the moving image value and check if the point is
+       * inside the moving image buffer. */
+      if( sampleOk )
+      {
+        sampleOk = this->EvaluateMovingImageValueAndDerivative(
+          mappedPoint, movingImageValue, &movingImageDerivative );
       }
-      mean /= static_cast< double >( lastDimSize );
 
-      /** Update derivative per control point. */
-      for( unsigned int t = 0; t < lastDimSize; ++t )
+      if( sampleOk )
       {
-        const unsigned int startc = numParametersPerLastDimension * t;
-        for( unsigned int c = startc; c < startc + numParametersPerLastDimension; ++c )
+        /** Update value terms **/
+        numSamplesOk++;
+        sumValues        += movingImageValue;
+        sumValuesSquared += movingImageValue * movingImageValue;
+
+        /** Get the TransformJacobian dT/dmu. */
+        this->EvaluateTransformJacobian( fixedPoint, jacobian, nzjis[ d ] );
+
+        /** Compute the innerproduct (dM/dx)^T (dT/dmu). */
+        this->EvaluateTransformJacobianInnerProduct(
+          jacobian, movingImageDerivative, imageJacobian );
+
+        /** Store values. */
+        MT[ d ]     = movingImageValue;
+        dMTdmu[ d ] = imageJacobian;
+      }
+      else
+      {
+        /** Invalid positions do not contribute to the derivative. */
+        nzjis[ d ].clear();
+      } // end if sampleOk
+    }
+
+    if( numSamplesOk > 0 )
+    {
+      numberOfPixelsCounted++;
+
+      /** Compute average intensity value. */
+      const float expectedValue = sumValues / static_cast< float >( numSamplesOk );
+      /** Add this variance to the variance sum. */
+      const float expectedSquaredValue = sumValuesSquared / static_cast< float >( numSamplesOk );
+      measure += expectedSquaredValue - expectedValue * expectedValue;
+
+      /** Second loop over t: update derivative. */
+      for( unsigned int d = 0; d < realNumLastDimPositions; ++d )
+      {
+        for( unsigned int j = 0; j < nzjis[ d ].size(); ++j )
         {
-          const unsigned int index = c % numParametersPerLastDimension;
-          derivative[ c ] -= mean[ index ];
+          derivative[ nzjis[ d ][ j ] ] += ( 2.0 * ( MT[ d ] - expectedValue ) * dMTdmu[ d ][ j ] )
+            / static_cast< float >( numSamplesOk );
         }
       }
     }
+  } // end for loop over the image sample container
+
+  /** Only update these variables at the end to prevent unnecessary "false sharing". */
+  this->m_GetValueAndDerivativePerThreadVariables[ threadId ].st_NumberOfPixelsCounted = numberOfPixelsCounted;
+  this->m_GetValueAndDerivativePerThreadVariables[ threadId ].st_Value                 = measure;
+
+} // end ThreadedGetValueAndDerivative()
+
+
+/**
+ * ******************* AfterThreadedGetValueAndDerivative *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
+::AfterThreadedGetValueAndDerivative(
+  MeasureType & value, DerivativeType & derivative ) const
+{
+  /** Accumulate the number of pixels. */
+  this->m_NumberOfPixelsCounted = this->m_GetValueAndDerivativePerThreadVariables[ 0 ].st_NumberOfPixelsCounted;
+  for( ThreadIdType i = 1; i < this->m_NumberOfThreads; ++i )
+  {
+    this->m_NumberOfPixelsCounted += this->m_GetValueAndDerivativePerThreadVariables[ i ].st_NumberOfPixelsCounted;
+
+    /** Reset this variable for the next iteration. */
+    this->m_GetValueAndDerivativePerThreadVariables[ i ].st_NumberOfPixelsCounted = 0;
   }
 
-  /** Return the measure value. */
-  value = measure;
+  /** Check if enough samples were valid. */
+  ImageSampleContainerPointer sampleContainer = this->GetImageSampler()->GetOutput();
+  this->CheckNumberOfSamples(
+    sampleContainer->Size(), this->m_NumberOfPixelsCounted );
 
-} // end GetValueAndDerivative()
+  /** Compute average over variances and normalize with initial variance. */
+  const float normalization = static_cast< float >( this->m_NumberOfPixelsCounted * this->m_InitialVariance );
+
+  /** Accumulate values. */
+  value = NumericTraits< MeasureType >::Zero;
+  for( ThreadIdType i = 0; i < this->m_NumberOfThreads; ++i )
+  {
+    value += this->m_GetValueAndDerivativePerThreadVariables[ i ].st_Value;
+
+    /** Reset this variable for the next iteration. */
+    this->m_GetValueAndDerivativePerThreadVariables[ i ].st_Value = NumericTraits< MeasureType >::Zero;
+  }
+  value /= normalization;
+
+  /** Accumulate derivatives. */
+  derivative = DerivativeType( this->GetNumberOfParameters() );
+  this->m_ThreaderMetricParameters.st_DerivativePointer   = derivative.begin();
+  this->m_ThreaderMetricParameters.st_NormalizationFactor = normalization;
+
+  /** Launch the threads of the persistent thread pool. */
+  PersistentThreadPool::SingleMethodExecute( this->AccumulateDerivativesThreaderCallback,
+    const_cast< void * >( static_cast< const void * >( &this->m_ThreaderMetricParameters ) ),
+    this->m_Threader->GetNumberOfThreads() );
+
+  /** Subtract mean from derivative elements. */
+  this->SubtractMeanFromDerivative( derivative );
+
+} // end AfterThreadedGetValueAndDerivative()
 
 
 } // end namespace itk
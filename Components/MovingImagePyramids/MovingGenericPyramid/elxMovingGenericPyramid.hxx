@@ -153,6 +153,11 @@ MovingGenericPyramid< TElastix >
     "ComputePyramidImagesPerResolution", 0, false );
   this->SetComputeOnlyForCurrentLevel( computeThisResolution );
 
+  /** Start at the first level, so that only that level is computed when the
+   * registration prepares the pyramids, also when the pyramid is reused.
+   */
+  this->SetCurrentLevel( 0 );
+
 } // end SetMovingSchedule()
 
 
@@ -25,7 +25,7 @@
 #include "itkComputeDisplacementDistribution.h" // For FASGD step size
 #include "elxProgressCommand.h"
 #include "itkAdvancedTransform.h"
-#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkRandomVariateGeneratorInstance.h"
 
 
 namespace elastix
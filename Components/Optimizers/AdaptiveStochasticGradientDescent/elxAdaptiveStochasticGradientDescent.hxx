@@ -54,7 +54,7 @@ AdaptiveStochasticGradientDescent< TElastix >
   this->m_NumberOfSamplesForExactGradient = 100000;
   this->m_SigmoidScaleFactor              = 0.1;
 
-  this->m_RandomGenerator   = RandomGeneratorType::GetInstance();
+  this->m_RandomGenerator   = itk::RandomVariateGeneratorInstance::Get();
   this->m_AdvancedTransform = 0;
 
   this->m_UseNoiseCompensation        = true;
@@ -579,6 +579,7 @@ AdaptiveStochasticGradientDescent< TElastix >
     this->m_NumberOfBandStructureSamples );
   computeJacobianTerms->SetNumberOfJacobianMeasurements(
     this->m_NumberOfJacobianMeasurements );
+  computeJacobianTerms->SetNumberOfThreads( testPtr->GetNumberOfThreads() );
 
   /** Check if use scales. */
   bool useScales = this->GetUseScales();
@@ -729,6 +730,7 @@ AdaptiveStochasticGradientDescent< TElastix >
   computeDisplacementDistribution->SetCostFunction( this->m_CostFunction );
   computeDisplacementDistribution->SetNumberOfJacobianMeasurements(
     this->m_NumberOfJacobianMeasurements );
+  computeDisplacementDistribution->SetNumberOfThreads( testPtr->GetNumberOfThreads() );
 
   /** Check if use scales. */
   if( this->GetUseScales() )
@@ -38,7 +38,7 @@ CMAEvolutionStrategyOptimizer::CMAEvolutionStrategyOptimizer()
 {
   itkDebugMacro( "Constructor" );
 
-  this->m_RandomGenerator = RandomGeneratorType::GetInstance();
+  this->m_RandomGenerator = RandomVariateGeneratorInstance::Get();
 
   this->m_CurrentValue     = NumericTraits< MeasureType >::Zero;
   this->m_CurrentIteration = 0;
@@ -500,39 +500,51 @@ CMAEvolutionStrategyOptimizer::GenerateOffspring( void )
 {
   itkDebugMacro( "GenerateOffspring" );
 
-  /** Get the number of parameters from the cost function */
-  const unsigned int numberOfParameters
-    = this->GetScaledCostFunction()->GetNumberOfParameters();
-
   /** Some casts/aliases: */
-  const unsigned int N      = numberOfParameters;
   const unsigned int lambda = this->m_PopulationSize;
 
   /** Clear the old values */
   this->m_CostFunctionValues.clear();
 
-  /** Fill the m_NormalizedSearchDirs and SearchDirs */
+  /** Fill the m_NormalizedSearchDirs and SearchDirs, and x_lam = m + d_lam */
+  this->m_OffspringPositions.resize( lambda );
+  for( unsigned int lam = 0; lam < lambda; ++lam )
+  {
+    this->DrawSearchDirection( lam );
+    this->m_OffspringPositions[ lam ]  = this->GetScaledCurrentPosition();
+    this->m_OffspringPositions[ lam ] += this->m_SearchDirs[ lam ];
+  }
+
+  /** Compute the cost function values of all offspring at once */
+  bool batchFailed = false;
+  try
+  {
+    this->GetScaledValues( this->m_OffspringPositions, this->m_OffspringValues );
+  }
+  catch( ExceptionObject & )
+  {
+    batchFailed = true;
+  }
+  if( !batchFailed )
+  {
+    for( unsigned int lam = 0; lam < lambda; ++lam )
+    {
+      this->m_CostFunctionValues.push_back(
+        MeasureIndexPairType( this->m_OffspringValues[ lam ], lam ) );
+    }
+    return;
+  }
+
+  /** Some evaluation failed: evaluate the offspring one by one, and draw
+   * a new search direction for every failed evaluation */
   unsigned int lam       = 0;
   unsigned int nrOfFails = 0;
   while( lam < lambda )
   {
-    /** draw from distribution N(0,I) */
-    for( unsigned int par = 0; par < N; ++par )
-    {
-      this->m_NormalizedSearchDirs[ lam ][ par ]
-        = this->m_RandomGenerator->GetNormalVariate();
-    }
-    /** Make like it was drawn from N(0,C) */
-    if( this->GetUseCovarianceMatrixAdaptation() )
-    {
-      this->m_SearchDirs[ lam ] = this->m_B * ( this->m_D * this->m_NormalizedSearchDirs[ lam ] );
-    }
-    else
+    if( nrOfFails > 0 )
     {
-      this->m_SearchDirs[ lam ] = this->m_NormalizedSearchDirs[ lam ];
+      this->DrawSearchDirection( lam );
     }
-    /** Make like it was drawn from N( 0, sigma^2 C ) */
-    this->m_SearchDirs[ lam ] *= this->m_CurrentSigma;
 
     /** Compute the cost function */
     MeasureType costFunctionValue = 0.0;
@@ -572,6 +584,36 @@ CMAEvolutionStrategyOptimizer::GenerateOffspring( void )
 } // end GenerateOffspring
 
 
+/**
+ * ****************** DrawSearchDirection *********************
+ */
+
+void
+CMAEvolutionStrategyOptimizer::DrawSearchDirection( unsigned int lam )
+{
+  const unsigned int N = this->GetScaledCostFunction()->GetNumberOfParameters();
+
+  /** draw from distribution N(0,I) */
+  for( unsigned int par = 0; par < N; ++par )
+  {
+    this->m_NormalizedSearchDirs[ lam ][ par ]
+      = this->m_RandomGenerator->GetNormalVariate();
+  }
+  /** Make like it was drawn from N(0,C) */
+  if( this->GetUseCovarianceMatrixAdaptation() )
+  {
+    this->m_SearchDirs[ lam ] = this->m_B * ( this->m_D * this->m_NormalizedSearchDirs[ lam ] );
+  }
+  else
+  {
+    this->m_SearchDirs[ lam ] = this->m_NormalizedSearchDirs[ lam ];
+  }
+  /** Make like it was drawn from N( 0, sigma^2 C ) */
+  this->m_SearchDirs[ lam ] *= this->m_CurrentSigma;
+
+} // end DrawSearchDirection
+
+
 /**
  * ****************** SortCostFunctionValues *********************
  */
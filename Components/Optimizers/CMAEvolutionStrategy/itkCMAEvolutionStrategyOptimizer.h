@@ -26,7 +26,7 @@
 
 #include "itkArray.h"
 #include "itkArray2D.h"
-#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkRandomVariateGeneratorInstance.h"
 #include "vnl/vnl_diag_matrix.h"
 
 namespace itk
@@ -293,6 +293,10 @@ protected:
   ParameterContainerType m_NormalizedSearchDirs;
   /** cost function values for each \f$x_i = m + d_i\f$ */
   MeasureContainerType m_CostFunctionValues;
+  /** The offspring \f$x_i = m + d_i\f$, evaluated in one batch */
+  ParameterContainerType m_OffspringPositions;
+  /** The cost function values of m_OffspringPositions, in the same order */
+  Superclass::MeasureContainerType m_OffspringValues;
   /** \f$m(g+1) - m(g)\f$ */
   ParametersType m_CurrentScaledStep;
   /** \f$1/\sigma * D^{-1} * B' * m_CurrentScaledStep, needed for p_{\sigma}\f$ */
@@ -355,9 +359,15 @@ protected:
   virtual void InitializeBCD( void );
 
   /** GenerateOffspring: Fill m_SearchDirs, m_NormalizedSearchDirs,
-   * and m_CostFunctionValues */
+   * and m_CostFunctionValues. The offspring are evaluated in one call
+   * to GetScaledValues(), so the cost function may evaluate them
+   * concurrently. If that fails, they are evaluated one by one, and
+   * a new search direction is drawn for each failed evaluation. */
   virtual void GenerateOffspring( void );
 
+  /** Draw m_NormalizedSearchDirs[ lam ] and m_SearchDirs[ lam ] */
+  virtual void DrawSearchDirection( unsigned int lam );
+
   /** Sort the m_CostFunctionValues vector and update m_MeasureHistory */
   virtual void SortCostFunctionValues( void );
 
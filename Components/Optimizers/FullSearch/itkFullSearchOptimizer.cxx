@@ -25,6 +25,8 @@
 #include "itkExceptionObject.h"
 #include "itkNumericTraits.h"
 
+#include <algorithm>
+
 namespace itk
 {
 
@@ -101,48 +103,79 @@ FullSearchOptimizer
   while( !m_Stop )
   {
 
-    try
+    /** Evaluate the rest of the current line in one batch, if possible.
+     * Otherwise, or if that fails, evaluate one position at a time.
+     */
+    this->ComputeLinePositions();
+    const BatchedCostFunctionInterface * batchedCostFunction
+      = dynamic_cast< const BatchedCostFunctionInterface * >( m_CostFunction.GetPointer() );
+    bool lineEvaluated = false;
+    if( batchedCostFunction && m_LinePositions.size() > 1 )
     {
-      m_Value = m_CostFunction->GetValue( this->GetCurrentPosition() );
+      try
+      {
+        batchedCostFunction->GetValues( m_LinePositions, m_LineValues );
+        lineEvaluated = true;
+      }
+      catch( ExceptionObject & )
+      {
+        lineEvaluated = false;
+      }
     }
-    catch( ExceptionObject & err )
+
+    for( std::size_t j = 0; j < m_LinePositions.size(); ++j )
     {
-      // An exception has occurred.
-      // Terminate immediately.
-      m_StopCondition = MetricError;
-      StopOptimization();
+      if( lineEvaluated )
+      {
+        m_Value = m_LineValues[ j ];
+      }
+      else
+      {
+        try
+        {
+          m_Value = m_CostFunction->GetValue( this->GetCurrentPosition() );
+        }
+        catch( ExceptionObject & err )
+        {
+          // An exception has occurred.
+          // Terminate immediately.
+          m_StopCondition = MetricError;
+          StopOptimization();
+
+          // Pass exception to caller
+          throw err;
+        }
+      }
 
-      // Pass exception to caller
-      throw err;
-    }
+      if( m_Stop )
+      {
+        break;
+      }
 
-    if( m_Stop )
-    {
-      break;
-    }
+      /** Check if the value is a minimum or maximum */
+      if( ( m_Value < m_BestValue )  ^  m_Maximize )         // ^ = xor, yields true if only one of the expressions is true
+      {
+        m_BestValue              = m_Value;
+        m_BestPointInSearchSpace = m_CurrentPointInSearchSpace;
+        m_BestIndexInSearchSpace = m_CurrentIndexInSearchSpace;
+      }
 
-    /** Check if the value is a minimum or maximum */
-    if( ( m_Value < m_BestValue )  ^  m_Maximize )         // ^ = xor, yields true if only one of the expressions is true
-    {
-      m_BestValue              = m_Value;
-      m_BestPointInSearchSpace = m_CurrentPointInSearchSpace;
-      m_BestIndexInSearchSpace = m_CurrentIndexInSearchSpace;
-    }
+      this->InvokeEvent( IterationEvent() );
 
-    this->InvokeEvent( IterationEvent() );
+      /** Prepare for next step */
+      m_CurrentIteration++;
 
-    /** Prepare for next step */
-    m_CurrentIteration++;
+      if( m_CurrentIteration >= this->GetNumberOfIterations() )
+      {
+        m_StopCondition = FullRangeSearched;
+        StopOptimization();
+        break;
+      }
 
-    if( m_CurrentIteration >= this->GetNumberOfIterations() )
-    {
-      m_StopCondition = FullRangeSearched;
-      StopOptimization();
-      break;
-    }
+      /** Set the next position in search space. */
+      this->UpdateCurrentPosition();
 
-    /** Set the next position in search space. */
-    this->UpdateCurrentPosition();
+    } // end for over the line
 
   } // end while
 
@@ -249,6 +282,42 @@ FullSearchOptimizer
 } // end UpdateCurrentPosition
 
 
+/**
+ * ********************* ComputeLinePositions ********************
+ */
+
+void
+FullSearchOptimizer
+::ComputeLinePositions( void )
+{
+  /** The number of positions left on the current line. */
+  std::size_t numberOfPositions = 1;
+  if( this->GetNumberOfSearchSpaceDimensions() > 0 )
+  {
+    numberOfPositions = this->GetSearchSpaceSize()[ 0 ] - m_CurrentIndexInSearchSpace[ 0 ];
+  }
+  const unsigned long iterationsLeft = this->GetNumberOfIterations() - m_CurrentIteration;
+  numberOfPositions = std::min< std::size_t >( numberOfPositions, iterationsLeft );
+  numberOfPositions = std::max< std::size_t >( numberOfPositions, 1 );
+
+  /** Only the parameter of the first search space dimension changes along
+   * the line; point = min + step*index, as in UpdateCurrentPosition. */
+  m_LinePositions.resize( numberOfPositions );
+  for( std::size_t j = 0; j < numberOfPositions; ++j )
+  {
+    m_LinePositions[ j ] = this->GetCurrentPosition();
+    if( j > 0 )
+    {
+      SearchSpaceIteratorType it( m_SearchSpace->Begin() );
+      RangeType               range = it.Value();
+      m_LinePositions[ j ][ it.Index() ] = range[ 0 ]
+        + static_cast< double >( range[ 2 ] * ( m_CurrentIndexInSearchSpace[ 0 ] + j ) );
+    }
+  }
+
+} // end ComputeLinePositions
+
+
 /**
  * ********************* ProcessSearchSpaceChanges **************
  */
@@ -20,6 +20,7 @@
 #define __itkFullSearchOptimizer_h
 
 #include "itkSingleValuedNonLinearOptimizer.h"
+#include "itkBatchedCostFunctionInterface.h"
 #include "itkMapContainer.h"
 #include "itkImage.h"
 #include "itkArray.h"
@@ -35,6 +36,10 @@ namespace itk
  * Optimizer that scans a subspace of the parameter space
  * and searches for the best parameters.
  *
+ * The points along the first search space dimension are evaluated
+ * in one batch, when the cost function implements the
+ * BatchedCostFunctionInterface, so that it may evaluate them concurrently.
+ *
  * \todo This optimizer has similar functionality as the recently added
  * itkExhaustiveOptimizer. See if we can replace it by that optimizer,
  * or inherit from it.
@@ -215,6 +220,15 @@ protected:
   unsigned long m_LastSearchSpaceChanges;
   virtual void ProcessSearchSpaceChanges( void );
 
+  /** Fill m_LinePositions with the current position and the next
+   * positions along the first search space dimension, up to the end of
+   * that dimension or the last iteration. */
+  virtual void ComputeLinePositions( void );
+
+  /** The positions along the current line and their values. */
+  BatchedCostFunctionInterface::ParametersContainerType m_LinePositions;
+  BatchedCostFunctionInterface::MeasureContainerType    m_LineValues;
+
 private:
 
   FullSearchOptimizer( const Self & ); // purposely not implemented
@@ -21,6 +21,7 @@
 #include "itkCommand.h"
 #include "itkEventObject.h"
 #include "itkExceptionObject.h"
+#include "itkComponentProfiler.h"
 
 #ifdef ELASTIX_USE_OPENMP
 #include <omp.h>
@@ -207,6 +208,10 @@ GradientDescentOptimizer2
   /** Get a reference to the previously allocated newPosition. */
   ParametersType & newPosition = this->m_ScaledCurrentPosition;
 
+  /** Time the update of the position, when profiling is enabled. */
+  const bool   profile   = ComponentProfiler::GetEnabled();
+  const double startTime = profile ? ComponentProfiler::GetTimeInSeconds() : 0.0;
+
   /** Advance one step. */
 #if 1 // force single-threaded since it is fastest most of the times
 //#ifndef ELASTIX_USE_OPENMP // If no OpenMP detected then use single-threaded code
@@ -232,6 +237,12 @@ GradientDescentOptimizer2
   }
 #endif
 
+  if( profile )
+  {
+    ComponentProfiler::AddMeasurement( ComponentProfiler::OptimizerStep,
+      ComponentProfiler::GetTimeInSeconds() - startTime );
+  }
+
   this->InvokeEvent( IterationEvent() );
 
 } // end AdvanceOneStep()
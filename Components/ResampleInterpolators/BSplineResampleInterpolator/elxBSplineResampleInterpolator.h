@@ -19,7 +19,7 @@
 #define __elxBSplineResampleInterpolator_h
 
 #include "elxIncludes.h" // include first to avoid MSVS warning
-#include "itkBSplineInterpolateImageFunction.h"
+#include "itkMultiThreadedBSplineInterpolateImageFunction.h"
 
 namespace elastix
 {
@@ -53,7 +53,7 @@ namespace elastix
 template< class TElastix >
 class BSplineResampleInterpolator :
   public
-  itk::BSplineInterpolateImageFunction<
+  itk::MultiThreadedBSplineInterpolateImageFunction<
   typename ResampleInterpolatorBase< TElastix >::InputImageType,
   typename ResampleInterpolatorBase< TElastix >::CoordRepType,
   double >,   //CoefficientType
@@ -63,7 +63,7 @@ public:
 
   /** Standard ITK-stuff. */
   typedef BSplineResampleInterpolator Self;
-  typedef itk::BSplineInterpolateImageFunction<
+  typedef itk::MultiThreadedBSplineInterpolateImageFunction<
     typename ResampleInterpolatorBase< TElastix >::InputImageType,
     typename ResampleInterpolatorBase< TElastix >::CoordRepType,
     double >                                    Superclass1;
@@ -20,6 +20,8 @@
 
 #include "elxIncludes.h" // include first to avoid MSVS warning
 #include "itkResampleImageFilter.h"
+#include "itkAdvancedTransform.h"
+#include "itkAdvancedRayCastInterpolateImageFunction.h"
 
 namespace elastix
 {
@@ -28,6 +30,17 @@ namespace elastix
  * \class MyStandardResampler
  * \brief A resampler based on the itk::ResampleImageFilter.
  *
+ * For advanced transforms, the output image is resampled line by line: all
+ * voxels of a line are transformed with a single call to
+ * AdvancedTransform::TransformPointsOnLine(), which is much faster than
+ * transforming them one by one for B-spline transforms. Other transforms are
+ * handled by the itk::ResampleImageFilter.
+ *
+ * With the RayCastResampleInterpolator, the output image is a digitally
+ * reconstructed radiograph (DRR), and it is computed line by line as well:
+ * the rays of all voxels of a line are cast with a single call to
+ * AdvancedRayCastInterpolateImageFunction::EvaluateRays().
+ *
  * The parameters used in this class are:
  * \parameter Resampler: Select this resampler as follows:\n
  *    <tt>(Resampler "DefaultResampler")</tt>
@@ -87,8 +100,21 @@ public:
   typedef typename Superclass2::RegistrationType     RegistrationType;
   typedef typename Superclass2::RegistrationPointer  RegistrationPointer;
   typedef typename Superclass2::ITKBaseType          ITKBaseType;
-
-  /* Nothing to add. In the baseclass already everything is done what should be done. */
+  typedef typename Superclass2::CoordRepType         CoordRepType;
+
+  /** Typedef's for the line-wise resampling. */
+  typedef itk::AdvancedTransform< CoordRepType,
+    Superclass2::ImageDimension,
+    Superclass2::ImageDimension >                    AdvancedTransformType;
+  typedef typename AdvancedTransformType::InputPointType  TransformInputPointType;
+  typedef typename AdvancedTransformType::InputVectorType TransformInputVectorType;
+  typedef typename AdvancedTransformType::OutputPointType TransformOutputPointType;
+  typedef typename InterpolatorType::ContinuousIndexType  ContinuousIndexType;
+
+  /** Typedef's for the line-wise ray casting. */
+  typedef itk::AdvancedRayCastInterpolateImageFunction<
+    InputImageType, CoordRepType >                       RayCastInterpolatorType;
+  typedef typename RayCastInterpolatorType::OutputType   RayCastOutputType;
 
 protected:
 
@@ -97,6 +123,30 @@ protected:
   /** The destructor. */
   virtual ~MyStandardResampler() {}
 
+  /** Resample the output region of a thread line by line, using
+   * TransformPointsOnLine(). Falls back to the implementation of the
+   * itk::ResampleImageFilter if the transform is not an AdvancedTransform.
+   */
+  virtual void NonlinearThreadedGenerateData(
+    const OutputImageRegionType & outputRegionForThread,
+    itk::ThreadIdType threadId );
+
+  /** Cast the rays of the output region of a thread line by line if the
+   * interpolator is a ray cast interpolator. Otherwise the implementation
+   * of the itk::ResampleImageFilter is used.
+   */
+  virtual void ThreadedGenerateData(
+    const OutputImageRegionType & outputRegionForThread,
+    itk::ThreadIdType threadId );
+
+  /** Cast the rays of the output region of a thread line by line, with
+   * EvaluateRays().
+   */
+  void RayCastThreadedGenerateData(
+    const RayCastInterpolatorType * rayCaster,
+    const OutputImageRegionType & outputRegionForThread,
+    itk::ThreadIdType threadId );
+
 private:
 
   /** The private constructor. */
@@ -21,6 +21,205 @@
 
 #include "elxMyStandardResampler.h"
 
-//nothing
+#include "itkImageLinearIteratorWithIndex.h"
+#include "itkProgressReporter.h"
 
-#endif
+#include <vector>
+
+namespace elastix
+{
+
+/**
+ * ******************* ThreadedGenerateData ***********************
+ */
+
+template< class TElastix >
+void
+MyStandardResampler< TElastix >
+::ThreadedGenerateData(
+  const OutputImageRegionType & outputRegionForThread,
+  itk::ThreadIdType threadId )
+{
+  const RayCastInterpolatorType * rayCaster
+    = dynamic_cast< const RayCastInterpolatorType * >( this->GetInterpolator() );
+  if( rayCaster == 0 || outputRegionForThread.GetSize( 0 ) == 0 )
+  {
+    this->Superclass1::ThreadedGenerateData( outputRegionForThread, threadId );
+    return;
+  }
+  this->RayCastThreadedGenerateData( rayCaster, outputRegionForThread, threadId );
+
+} // end ThreadedGenerateData()
+
+
+/**
+ * ******************* RayCastThreadedGenerateData ***********************
+ */
+
+template< class TElastix >
+void
+MyStandardResampler< TElastix >
+::RayCastThreadedGenerateData(
+  const RayCastInterpolatorType * rayCaster,
+  const OutputImageRegionType & outputRegionForThread,
+  itk::ThreadIdType threadId )
+{
+  /** Get the output and the transform. The transform of the resampler is
+   * the transform of the ray caster, see ResamplerBase::WriteResultImage().
+   */
+  OutputImageType *     outputPtr  = this->GetOutput();
+  const TransformType * transform  = this->GetTransform();
+  const itk::SizeValueType lineLength = outputRegionForThread.GetSize( 0 );
+
+  /** Create an iterator that will walk the output region for this thread. */
+  typedef itk::ImageLinearIteratorWithIndex< OutputImageType > OutputIteratorType;
+  OutputIteratorType it( outputPtr, outputRegionForThread );
+  it.SetDirection( 0 );
+  it.GoToBegin();
+
+  /** The range of the output pixel type. */
+  const RayCastOutputType minValue
+    = static_cast< RayCastOutputType >( itk::NumericTraits< PixelType >::NonpositiveMin() );
+  const RayCastOutputType maxValue
+    = static_cast< RayCastOutputType >( itk::NumericTraits< PixelType >::max() );
+
+  /** The ray end points and the integrals of one line. */
+  std::vector< PointType >         points( lineLength );
+  std::vector< RayCastOutputType > values( lineLength );
+
+  /** Support for progress methods/callbacks. */
+  itk::ProgressReporter progress( this, threadId,
+    outputRegionForThread.GetNumberOfPixels() / lineLength );
+
+  /** Walk the output region. */
+  IndexType index;
+  PointType point;
+  while( !it.IsAtEnd() )
+  {
+    /** Cast the rays of all voxels on this line at once. */
+    index = it.GetIndex();
+    for( itk::SizeValueType k = 0; k < lineLength; ++k )
+    {
+      outputPtr->TransformIndexToPhysicalPoint( index, point );
+      points[ k ] = transform->TransformPoint( point );
+      ++index[ 0 ];
+    }
+    rayCaster->EvaluateRays( &points[ 0 ], &values[ 0 ], lineLength );
+
+    for( itk::SizeValueType k = 0; k < lineLength; ++k )
+    {
+      const RayCastOutputType value = values[ k ];
+      it.Set( static_cast< PixelType >(
+        value < minValue ? minValue : ( value > maxValue ? maxValue : value ) ) );
+      ++it;
+    }
+
+    /** Update progress and iterator. */
+    progress.CompletedPixel();
+    it.NextLine();
+  }
+
+} // end RayCastThreadedGenerateData()
+
+
+/**
+ * ******************* NonlinearThreadedGenerateData ***********************
+ */
+
+template< class TElastix >
+void
+MyStandardResampler< TElastix >
+::NonlinearThreadedGenerateData(
+  const OutputImageRegionType & outputRegionForThread,
+  itk::ThreadIdType threadId )
+{
+  /** The line-wise resampling needs an advanced transform. */
+  const AdvancedTransformType * transform
+    = dynamic_cast< const AdvancedTransformType * >( this->GetTransform() );
+  const itk::SizeValueType lineLength = outputRegionForThread.GetSize( 0 );
+  if( transform == 0 || lineLength == 0 )
+  {
+    this->Superclass1::NonlinearThreadedGenerateData( outputRegionForThread, threadId );
+    return;
+  }
+
+  /** Get the input, output and interpolator. */
+  OutputImageType *        outputPtr    = this->GetOutput();
+  const InputImageType *   inputPtr     = this->GetInput();
+  const InterpolatorType * interpolator = this->GetInterpolator();
+
+  /** Create an iterator that will walk the output region for this thread. */
+  typedef itk::ImageLinearIteratorWithIndex< OutputImageType > OutputIteratorType;
+  OutputIteratorType it( outputPtr, outputRegionForThread );
+  it.SetDirection( 0 );
+  it.GoToBegin();
+
+  /** The step between two voxels of a line, in physical coordinates. */
+  IndexType index = outputRegionForThread.GetIndex();
+  PointType point0, point1;
+  outputPtr->TransformIndexToPhysicalPoint( index, point0 );
+  ++index[ 0 ];
+  outputPtr->TransformIndexToPhysicalPoint( index, point1 );
+  TransformInputVectorType step;
+  for( unsigned int i = 0; i < Superclass2::ImageDimension; ++i )
+  {
+    step[ i ] = static_cast< CoordRepType >( point1[ i ] - point0[ i ] );
+  }
+
+  /** The range of the output pixel type. */
+  typedef typename InterpolatorType::OutputType InterpolatorOutputType;
+  const InterpolatorOutputType minValue
+    = static_cast< InterpolatorOutputType >( itk::NumericTraits< PixelType >::NonpositiveMin() );
+  const InterpolatorOutputType maxValue
+    = static_cast< InterpolatorOutputType >( itk::NumericTraits< PixelType >::max() );
+  const PixelType defaultValue = this->GetDefaultPixelValue();
+
+  /** The transformed points of one line. */
+  std::vector< TransformOutputPointType > outputPoints( lineLength );
+
+  /** Support for progress methods/callbacks. */
+  itk::ProgressReporter progress( this, threadId,
+    outputRegionForThread.GetNumberOfPixels() / lineLength );
+
+  /** Walk the output region. */
+  PointType               point;
+  TransformInputPointType start;
+  ContinuousIndexType     cindex;
+  while( !it.IsAtEnd() )
+  {
+    /** Transform all voxels on this line. */
+    outputPtr->TransformIndexToPhysicalPoint( it.GetIndex(), point );
+    for( unsigned int i = 0; i < Superclass2::ImageDimension; ++i )
+    {
+      start[ i ] = static_cast< CoordRepType >( point[ i ] );
+    }
+    transform->TransformPointsOnLine( start, step, &outputPoints[ 0 ], lineLength );
+
+    /** Interpolate the input image at the transformed points. */
+    for( itk::SizeValueType k = 0; k < lineLength; ++k )
+    {
+      inputPtr->TransformPhysicalPointToContinuousIndex( outputPoints[ k ], cindex );
+      if( interpolator->IsInsideBuffer( cindex ) )
+      {
+        InterpolatorOutputType value = interpolator->EvaluateAtContinuousIndex( cindex );
+        value = value < minValue ? minValue : ( value > maxValue ? maxValue : value );
+        it.Set( static_cast< PixelType >( value ) );
+      }
+      else
+      {
+        it.Set( defaultValue );
+      }
+      ++it;
+    }
+
+    /** Update progress and iterator. */
+    progress.CompletedPixel();
+    it.NextLine();
+  }
+
+} // end NonlinearThreadedGenerateData()
+
+
+} // end namespace elastix
+
+#endif // end #ifndef __elxMyStandardResampler_hxx
@@ -112,6 +112,25 @@ public:
   /** Method to transform a point. */
   virtual OutputPointType TransformPoint( const InputPointType & inputPoint ) const;
 
+  /** Method to transform a block of points. The block is passed on to the
+   * TransformPoints() of TAnyITKTransform, after which the intermediary
+   * deformation field is added, as in TransformPoint().
+   */
+  virtual void TransformPoints(
+    const InputPointType * inputPoints,
+    OutputPointType * outputPoints,
+    const SizeValueType numberOfPoints ) const;
+
+  /** Method to transform the points on a line. The line is passed on to the
+   * TransformPointsOnLine() of TAnyITKTransform, after which the
+   * intermediary deformation field is added.
+   */
+  virtual void TransformPointsOnLine(
+    const InputPointType & start,
+    const InputVectorType & step,
+    OutputPointType * outputPoints,
+    const SizeValueType numberOfPoints ) const;
+
 protected:
 
   /** The constructor. */
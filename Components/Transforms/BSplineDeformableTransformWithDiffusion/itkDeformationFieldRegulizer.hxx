@@ -21,6 +21,8 @@
 
 #include "itkDeformationFieldRegulizer.h"
 
+#include <algorithm>
+
 namespace itk
 {
 
@@ -117,6 +119,83 @@ DeformationFieldRegulizer< TAnyITKTransform >
 } // end TransformPoint()
 
 
+/**
+ * *********************** TransformPoints ***********************
+ */
+
+template< class TAnyITKTransform >
+void
+DeformationFieldRegulizer< TAnyITKTransform >
+::TransformPoints(
+  const InputPointType * inputPoints,
+  OutputPointType * outputPoints,
+  const SizeValueType numberOfPoints ) const
+{
+  /** The output may overwrite the input, so the input points are copied in
+   * chunks, which are needed for the intermediary deformation field.
+   */
+  const SizeValueType chunkSize = 64;
+  InputPointType      inputChunk[ chunkSize ];
+  for( SizeValueType first = 0; first < numberOfPoints; first += chunkSize )
+  {
+    const SizeValueType numberOfChunkPoints
+      = std::min( chunkSize, numberOfPoints - first );
+    std::copy( inputPoints + first, inputPoints + first + numberOfChunkPoints, inputChunk );
+
+    /** Get the outputpoints of any ITK Transform. */
+    this->Superclass::TransformPoints( inputChunk, outputPoints + first, numberOfChunkPoints );
+
+    /** Add the deformation field: don't forget to subtract ipp. */
+    for( SizeValueType k = 0; k < numberOfChunkPoints; ++k )
+    {
+      const OutputPointType oppDF
+        = this->m_IntermediaryDeformationFieldTransform->TransformPoint( inputChunk[ k ] );
+      OutputPointType & opp = outputPoints[ first + k ];
+      for( unsigned int i = 0; i < OutputSpaceDimension; i++ )
+      {
+        opp[ i ] += oppDF[ i ] - inputChunk[ k ][ i ];
+      }
+    }
+  }
+
+} // end TransformPoints()
+
+
+/**
+ * ******************** TransformPointsOnLine ********************
+ */
+
+template< class TAnyITKTransform >
+void
+DeformationFieldRegulizer< TAnyITKTransform >
+::TransformPointsOnLine(
+  const InputPointType & start,
+  const InputVectorType & step,
+  OutputPointType * outputPoints,
+  const SizeValueType numberOfPoints ) const
+{
+  /** Get the outputpoints of any ITK Transform. */
+  this->Superclass::TransformPointsOnLine( start, step, outputPoints, numberOfPoints );
+
+  /** Add the deformation field: don't forget to subtract ipp. */
+  InputPointType ipp;
+  for( SizeValueType k = 0; k < numberOfPoints; ++k )
+  {
+    for( unsigned int i = 0; i < InputSpaceDimension; i++ )
+    {
+      ipp[ i ] = start[ i ] + static_cast< ScalarType >( k ) * step[ i ];
+    }
+    const OutputPointType oppDF
+      = this->m_IntermediaryDeformationFieldTransform->TransformPoint( ipp );
+    for( unsigned int i = 0; i < OutputSpaceDimension; i++ )
+    {
+      outputPoints[ k ][ i ] += oppDF[ i ] - ipp[ i ];
+    }
+  }
+
+} // end TransformPointsOnLine()
+
+
 /**
  * ******** UpdateIntermediaryDeformationFieldTransform *********
  */
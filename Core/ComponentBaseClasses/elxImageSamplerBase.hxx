@@ -64,6 +64,15 @@ ImageSamplerBase< TElastix >
   }
   else { this->GetAsITKBaseType()->SetUseMultiThread( false ); }
 
+  /** Use the number of threads of the -threads argument, like the metric,
+   * instead of the global default of the MultiThreader.
+   */
+  std::string numberOfThreads = this->m_Configuration->GetCommandLineArgument( "-threads" );
+  if( numberOfThreads != "" )
+  {
+    this->GetAsITKBaseType()->SetNumberOfThreads( atoi( numberOfThreads.c_str() ) );
+  }
+
 } // end BeforeEachResolutionBase()
 
 
@@ -63,6 +63,15 @@ namespace elastix
  *    CheckNumberOfSamples. \n
  *    example: <tt>(RequiredRatioOfValidSamples 0.1)</tt> \n
  *    The default is 0.25.
+ * \parameter UseStructureOfArraysSamples: Whether the image sampler also stores
+ *    the samples as a structure of arrays, with their continuous indices in the
+ *    fixed image precomputed. The multi-threaded metrics then read the fixed
+ *    coordinates and values from these contiguous arrays, and metrics that need
+ *    the continuous index save a conversion per sample per iteration. This
+ *    costs some memory.
+ *    Can be given for each resolution or for all resolutions at once. \n
+ *    example: <tt>(UseStructureOfArraysSamples "true")</tt> \n
+ *    The default is false.
  *
  * \ingroup Metrics
  * \ingroup ComponentBaseClasses
@@ -180,6 +180,12 @@ MetricBase< TElastix >
       }
     }
 
+    /** Should the image sampler also provide the samples as a structure of arrays? */
+    bool useStructureOfArraysSamples = false;
+    this->GetModifiableConfiguration()->ReadParameter( useStructureOfArraysSamples,
+      "UseStructureOfArraysSamples", this->GetComponentLabel(), level, 0 );
+    thisAsAdvanced->SetUseStructureOfArraysSamples( useStructureOfArraysSamples );
+
   } // end advanced metric
 
 } // end BeforeEachResolutionBase()
@@ -64,6 +64,14 @@ namespace elastix
  *    of the written image is desired.\n
  *    example: <tt>(CompressResultImage "true")</tt> \n
  *    The default is "false".
+ * \parameter ResultImageMemoryBudget: the maximum amount of memory, in megabytes,
+ *    that the resampled image may occupy. Larger images are resampled, cast and
+ *    written in slabs, if the file format supports streamed writing, such as
+ *    uncompressed mhd. Otherwise a warning is printed and the image is written
+ *    as a whole. When the result image is only kept in memory, only its cast version is
+ *    stored as a whole.\n
+ *    example: <tt>(ResultImageMemoryBudget 2048)</tt> \n
+ *    The default is 0, which means that the whole image is resampled at once.
  *
  * \ingroup Resamplers
  * \ingroup ComponentBaseClasses
@@ -174,9 +182,14 @@ public:
   /** Function to perform resample and write the result output image to a file. */
   virtual void ResampleAndWriteResultImage( const char * filename, const bool & showProgress = true );
 
-  /** Function to write the result output image to a file. */
+  /** Function to write the result output image to a file. If the number of
+   * stream divisions is larger than one, the image is requested and written
+   * in that number of pieces, provided that the ImageIO of the file can
+   * stream. Otherwise it is written as a whole.
+   */
   virtual void WriteResultImage( OutputImageType * imageimage,
-    const char * filename, const bool & showProgress = true );
+    const char * filename, const bool & showProgress = true,
+    const unsigned int numberOfStreamDivisions = 1 );
 
   /** Function to create the result image in the format of an itk::Image. */
   virtual void CreateItkResultImage( void );
@@ -191,6 +204,19 @@ protected:
   /** Method that sets the transform, the interpolator and the inputImage. */
   virtual void SetComponents( void );
 
+  /** Get the number of pieces in which the result image should be resampled,
+   * according to the ResultImageMemoryBudget parameter.
+   */
+  unsigned int GetNumberOfStreamDivisions( void ) const;
+
+  /** Check if the ImageIO for \a filename can write the result image in
+   * pieces, given the CompressResultImage parameter.
+   */
+  bool CanStreamWrite( const char * filename ) const;
+
+  /** Read the CompressResultImage parameter. */
+  bool ReadCompressResultImage( void ) const;
+
   /** Variable that defines to print the progress or not. */
   bool m_ShowProgress;
 
@@ -204,6 +230,13 @@ private:
   /** Release memory. */
   void ReleaseMemory( void );
 
+  /** Cast the result image with a filter of type TCastFilter, in the given
+   * number of pieces. Used by CreateItkResultImage().
+   */
+  template< class TCastFilter >
+  itk::DataObject::Pointer CastResultImage( OutputImageType * image,
+    const unsigned int numberOfStreamDivisions ) const;
+
 };
 
 } // end namespace elastix
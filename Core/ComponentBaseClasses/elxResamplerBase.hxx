@@ -21,9 +21,12 @@
 #include "elxResamplerBase.h"
 
 #include "itkImageFileCastWriter.h"
+#include "itkImageIOFactory.h"
 #include "itkChangeInformationImageFilter.h"
+#include "itkStreamingImageFilter.h"
 #include "itkAdvancedRayCastInterpolateImageFunction.h"
 #include "itkTimeProbe.h"
+#include "vnl/vnl_math.h"
 
 namespace elastix
 {
@@ -326,10 +329,32 @@ ResamplerBase< TElastix >
   /** Make sure the resampler is updated. */
   this->GetAsITKBaseType()->Modified();
 
-  /** Add a progress observer to the resampler. */
+  /** Large images are resampled by the writer, slab by slab, if the image
+   * format supports it.
+   */
+  const unsigned int numberOfStreamDivisions = this->GetNumberOfStreamDivisions();
+  const bool         streamWrite
+    = numberOfStreamDivisions > 1 && this->CanStreamWrite( filename );
+  if( streamWrite )
+  {
+    elxout << "  The result image is resampled in " << numberOfStreamDivisions
+           << " slabs, to stay within the ResultImageMemoryBudget." << std::endl;
+  }
+  else if( numberOfStreamDivisions > 1 )
+  {
+    xl::xout[ "warning" ] << "WARNING: The image format of \"" << filename
+                          << "\" does not support writing in pieces"
+                          << ( this->ReadCompressResultImage() ? " with compression" : "" )
+                          << ".\n  The result image is resampled and written as a whole,"
+                          << " which exceeds the ResultImageMemoryBudget." << std::endl;
+  }
+
+  /** Add a progress observer to the resampler. When streaming, the writer
+   * reports the progress instead.
+   */
 #ifndef _ELASTIX_BUILD_LIBRARY
   typename ProgressCommandType::Pointer progressObserver = ProgressCommandType::New();
-  if( showProgress )
+  if( showProgress && !streamWrite )
   {
     progressObserver->ConnectObserver( this->GetAsITKBaseType() );
     progressObserver->SetStartString( "  Progress: " );
@@ -337,9 +362,17 @@ ResamplerBase< TElastix >
   }
 #endif
 
-  /** Do the resampling. */
+  /** Do the resampling. When streaming, the writer drives the resampler,
+   * so the resampling errors come from writing.
+   */
   try
   {
+    if( streamWrite )
+    {
+      this->WriteResultImage( this->GetAsITKBaseType()->GetOutput(), filename,
+        showProgress, numberOfStreamDivisions );
+      return;
+    }
     this->GetAsITKBaseType()->Update();
   }
   catch( itk::ExceptionObject & excp )
@@ -376,7 +409,8 @@ template< class TElastix >
 void
 ResamplerBase< TElastix >
 ::WriteResultImage( OutputImageType * image,
-  const char * filename, const bool & showProgress )
+  const char * filename, const bool & showProgress,
+  const unsigned int numberOfStreamDivisions )
 {
   /** Check if ResampleInterpolator is the RayCastResampleInterpolator  */
   typedef itk::AdvancedRayCastInterpolateImageFunction<  InputImageType,
@@ -403,9 +437,14 @@ ResamplerBase< TElastix >
   if( pos != npos ) { resultImagePixelType.replace( pos, 1, "_" ); }
 
   /** Read from the parameter file if compression is desired. */
-  bool doCompression = false;
-  this->m_Configuration->ReadParameter(
-    doCompression, "CompressResultImage", 0, false );
+  const bool doCompression = this->ReadCompressResultImage();
+
+  /** The writer requests the whole image at once if the image format does
+   * not support writing in pieces.
+   */
+  const unsigned int numberOfPieces
+    = ( numberOfStreamDivisions > 1 && this->CanStreamWrite( filename ) )
+    ? numberOfStreamDivisions : 1;
 
   /** Typedef's for writing the output image. */
   typedef itk::ImageFileCastWriter< OutputImageType > WriterType;
@@ -432,12 +471,32 @@ ResamplerBase< TElastix >
   writer->SetFileName( filename );
   writer->SetOutputComponentType( resultImagePixelType.c_str() );
   writer->SetUseCompression( doCompression );
+  writer->SetNumberOfStreamDivisions( numberOfPieces );
+
+  /** When streaming, the progress of the writer includes the resampling. */
+#ifndef _ELASTIX_BUILD_LIBRARY
+  typename ProgressCommandType::Pointer progressObserver = ProgressCommandType::New();
+  if( showProgress && numberOfPieces > 1 )
+  {
+    progressObserver->ConnectObserver( writer );
+    progressObserver->SetStartString( "  Progress: " );
+    progressObserver->SetEndString( "%" );
+  }
+#endif
 
   /** Do the writing. */
   if( showProgress )
   {
     xl::xout[ "coutonly" ] << std::flush;
-    xl::xout[ "coutonly" ] << "\n  Writing image ..." << std::endl;
+    if( numberOfPieces > 1 )
+    {
+      xl::xout[ "coutonly" ] << "\n  Resampling and writing image in "
+                             << numberOfPieces << " slabs ..." << std::endl;
+    }
+    else
+    {
+      xl::xout[ "coutonly" ] << "\n  Writing image ..." << std::endl;
+    }
   }
   try
   {
@@ -472,6 +531,14 @@ ResamplerBase< TElastix >
   /** Make sure the resampler is updated. */
   this->GetAsITKBaseType()->Modified();
 
+  /** Large images are resampled slab by slab while casting them. */
+  const unsigned int numberOfStreamDivisions = this->GetNumberOfStreamDivisions();
+  if( numberOfStreamDivisions > 1 )
+  {
+    elxout << "  The result image is resampled in " << numberOfStreamDivisions
+           << " slabs, to stay within the ResultImageMemoryBudget." << std::endl;
+  }
+
 #ifndef _ELASTIX_BUILD_LIBRARY
   /** Add a progress observer to the resampler. */
   typename ProgressCommandType::Pointer progressObserver = ProgressCommandType::New();
@@ -483,7 +550,10 @@ ResamplerBase< TElastix >
   /** Do the resampling. */
   try
   {
-    this->GetAsITKBaseType()->Update();
+    if( numberOfStreamDivisions == 1 )
+    {
+      this->GetAsITKBaseType()->Update();
+    }
   }
   catch( itk::ExceptionObject & excp )
   {
@@ -554,76 +624,72 @@ ResamplerBase< TElastix >
   typedef itk::CastImageFilter< InputImageType,
     itk::Image< double, InputImageType::ImageDimension > >          CastFilterDouble;
 
-  /** cast the image to the correct output image Type */
-  if( resultImagePixelType.compare( "char" ) == 0 )
-  {
-    typename CastFilterChar::Pointer castFilter = CastFilterChar::New();
-    castFilter->SetInput( infoChanger->GetOutput() );
-    castFilter->Update();
-    resultImage = castFilter->GetOutput();
-  }
-  if( resultImagePixelType.compare( "unsigned char" ) == 0 )
-  {
-    typename CastFilterUChar::Pointer castFilter = CastFilterUChar::New();
-    castFilter->SetInput( infoChanger->GetOutput() );
-    castFilter->Update();
-    resultImage = castFilter->GetOutput();
-  }
-  else if( resultImagePixelType.compare( "short" ) == 0 )
-  {
-    typename CastFilterShort::Pointer castFilter = CastFilterShort::New();
-    castFilter->SetInput( infoChanger->GetOutput() );
-    castFilter->Update();
-    resultImage = castFilter->GetOutput();
-  }
-  else if( resultImagePixelType.compare( "ushort" ) == 0 || resultImagePixelType.compare( "unsigned short" ) == 0 ) // <-- ushort for backwards compatibility
-  {
-    typename CastFilterUShort::Pointer castFilter = CastFilterUShort::New();
-    castFilter->SetInput( infoChanger->GetOutput() );
-    castFilter->Update();
-    resultImage = castFilter->GetOutput();
-  }
-  else if( resultImagePixelType.compare( "int" ) == 0 )
-  {
-    typename CastFilterInt::Pointer castFilter = CastFilterInt::New();
-    castFilter->SetInput( infoChanger->GetOutput() );
-    castFilter->Update();
-    resultImage = castFilter->GetOutput();
-  }
-  else if( resultImagePixelType.compare( "unsigned int" ) == 0 )
-  {
-    typename CastFilterUInt::Pointer castFilter = CastFilterUInt::New();
-    castFilter->SetInput( infoChanger->GetOutput() );
-    castFilter->Update();
-    resultImage = castFilter->GetOutput();
-  }
-  else if( resultImagePixelType.compare( "long" ) == 0 )
-  {
-    typename CastFilterLong::Pointer castFilter = CastFilterLong::New();
-    castFilter->SetInput( infoChanger->GetOutput() );
-    castFilter->Update();
-    resultImage = castFilter->GetOutput();
-  }
-  else if( resultImagePixelType.compare( "unsigned long" ) == 0 )
-  {
-    typename CastFilterULong::Pointer castFilter = CastFilterULong::New();
-    castFilter->SetInput( infoChanger->GetOutput() );
-    castFilter->Update();
-    resultImage = castFilter->GetOutput();
-  }
-  else if( resultImagePixelType.compare( "float" ) == 0 )
+  /** Cast the image to the correct output image type. When streaming, the
+   * resampling happens while casting.
+   */
+  try
   {
-    typename CastFilterFloat::Pointer castFilter = CastFilterFloat::New();
-    castFilter->SetInput( infoChanger->GetOutput() );
-    castFilter->Update();
-    resultImage = castFilter->GetOutput();
+    if( resultImagePixelType.compare( "char" ) == 0 )
+    {
+      resultImage = this->template CastResultImage< CastFilterChar >(
+        infoChanger->GetOutput(), numberOfStreamDivisions );
+    }
+    if( resultImagePixelType.compare( "unsigned char" ) == 0 )
+    {
+      resultImage = this->template CastResultImage< CastFilterUChar >(
+        infoChanger->GetOutput(), numberOfStreamDivisions );
+    }
+    else if( resultImagePixelType.compare( "short" ) == 0 )
+    {
+      resultImage = this->template CastResultImage< CastFilterShort >(
+        infoChanger->GetOutput(), numberOfStreamDivisions );
+    }
+    else if( resultImagePixelType.compare( "ushort" ) == 0 || resultImagePixelType.compare( "unsigned short" ) == 0 ) // <-- ushort for backwards compatibility
+    {
+      resultImage = this->template CastResultImage< CastFilterUShort >(
+        infoChanger->GetOutput(), numberOfStreamDivisions );
+    }
+    else if( resultImagePixelType.compare( "int" ) == 0 )
+    {
+      resultImage = this->template CastResultImage< CastFilterInt >(
+        infoChanger->GetOutput(), numberOfStreamDivisions );
+    }
+    else if( resultImagePixelType.compare( "unsigned int" ) == 0 )
+    {
+      resultImage = this->template CastResultImage< CastFilterUInt >(
+        infoChanger->GetOutput(), numberOfStreamDivisions );
+    }
+    else if( resultImagePixelType.compare( "long" ) == 0 )
+    {
+      resultImage = this->template CastResultImage< CastFilterLong >(
+        infoChanger->GetOutput(), numberOfStreamDivisions );
+    }
+    else if( resultImagePixelType.compare( "unsigned long" ) == 0 )
+    {
+      resultImage = this->template CastResultImage< CastFilterULong >(
+        infoChanger->GetOutput(), numberOfStreamDivisions );
+    }
+    else if( resultImagePixelType.compare( "float" ) == 0 )
+    {
+      resultImage = this->template CastResultImage< CastFilterFloat >(
+        infoChanger->GetOutput(), numberOfStreamDivisions );
+    }
+    else if( resultImagePixelType.compare( "double" ) == 0 )
+    {
+      resultImage = this->template CastResultImage< CastFilterDouble >(
+        infoChanger->GetOutput(), numberOfStreamDivisions );
+    }
   }
-  else if( resultImagePixelType.compare( "double" ) == 0 )
+  catch( itk::ExceptionObject & excp )
   {
-    typename CastFilterDouble::Pointer castFilter = CastFilterDouble::New();
-    castFilter->SetInput( infoChanger->GetOutput() );
-    castFilter->Update();
-    resultImage = castFilter->GetOutput();
+    /** Add information to the exception. */
+    excp.SetLocation( "ResamplerBase - CreateItkResultImage()" );
+    std::string err_str = excp.GetDescription();
+    err_str += "\nError occurred while resampling the image.\n";
+    excp.SetDescription( err_str );
+
+    /** Pass the exception to an higher level. */
+    throw excp;
   }
 
   if( resultImage.IsNull() )
@@ -644,6 +710,115 @@ ResamplerBase< TElastix >
 } // end CreateItkResultImage()
 
 
+/*
+ * ******************* CastResultImage ********************
+ */
+
+template< class TElastix >
+template< class TCastFilter >
+itk::DataObject::Pointer
+ResamplerBase< TElastix >
+::CastResultImage( OutputImageType * image,
+  const unsigned int numberOfStreamDivisions ) const
+{
+  typedef typename TCastFilter::OutputImageType CastImageType;
+  typedef itk::StreamingImageFilter<
+    CastImageType, CastImageType >              StreamerType;
+
+  typename TCastFilter::Pointer castFilter = TCastFilter::New();
+  castFilter->SetInput( image );
+  if( numberOfStreamDivisions == 1 )
+  {
+    castFilter->Update();
+    return castFilter->GetOutput();
+  }
+
+  /** Only the cast image is stored as a whole; the resampler only holds
+   * the slab that is being cast.
+   */
+  typename StreamerType::Pointer streamer = StreamerType::New();
+  streamer->SetInput( castFilter->GetOutput() );
+  streamer->SetNumberOfStreamDivisions( numberOfStreamDivisions );
+  streamer->Update();
+  return streamer->GetOutput();
+
+} // end CastResultImage()
+
+
+/*
+ * ******************* ReadCompressResultImage ********************
+ */
+
+template< class TElastix >
+bool
+ResamplerBase< TElastix >
+::ReadCompressResultImage( void ) const
+{
+  bool doCompression = false;
+  this->m_Configuration->ReadParameter(
+    doCompression, "CompressResultImage", 0, false );
+  return doCompression;
+
+} // end ReadCompressResultImage()
+
+
+/*
+ * ******************* CanStreamWrite ********************
+ */
+
+template< class TElastix >
+bool
+ResamplerBase< TElastix >
+::CanStreamWrite( const char * filename ) const
+{
+  /** Ask the ImageIO that the writer will choose for this file name. Some
+   * formats, such as MetaImage, cannot stream when compressing.
+   */
+  itk::ImageIOBase::Pointer imageIO = itk::ImageIOFactory::CreateImageIO(
+    filename, itk::ImageIOFactory::WriteMode );
+  if( imageIO.IsNull() )
+  {
+    return false;
+  }
+  imageIO->SetUseCompression( this->ReadCompressResultImage() );
+  return imageIO->CanStreamWrite();
+
+} // end CanStreamWrite()
+
+
+/*
+ * ******************* GetNumberOfStreamDivisions ********************
+ */
+
+template< class TElastix >
+unsigned int
+ResamplerBase< TElastix >
+::GetNumberOfStreamDivisions( void ) const
+{
+  /** The size of the resampled image. */
+  const SizeType & size          = this->GetAsITKBaseType()->GetSize();
+  double           numberOfBytes = static_cast< double >( sizeof( OutputPixelType ) );
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    numberOfBytes *= static_cast< double >( size[ i ] );
+  }
+
+  const unsigned int numberOfDivisions
+    = this->GetNumberOfPiecesForMemoryBudget( numberOfBytes / 1048576.0 );
+  if( numberOfDivisions == 1 )
+  {
+    return 1;
+  }
+
+  /** The image is split along its last dimension, so there cannot be
+   * more pieces than slices.
+   */
+  return vnl_math_min( numberOfDivisions,
+    static_cast< unsigned int >( size[ ImageDimension - 1 ] ) );
+
+} // end GetNumberOfStreamDivisions()
+
+
 /*
  * ************************* ReadFromFile ***********************
  */
@@ -26,6 +26,7 @@
 #include "itkAdvancedCombinationTransform.h"
 #include "elxComponentDatabase.h"
 #include "elxProgressCommand.h"
+#include "itkMultiThreader.h"
 
 #include <fstream>
 #include <iomanip>
@@ -107,6 +108,12 @@ namespace elastix
  * The location is relative to the path from where elastix/transformix is started!\n
  * Default: "NoInitialTransform", which (obviously) means that there is no initial transform
  * to be loaded.
+ * \transformparameter ResultImageMemoryBudget: The maximum amount of memory, in megabytes,
+ * that the (determinant of the) spatial Jacobian image may occupy while it is written. Larger
+ * images are computed and written in pieces, if the file format supports streamed writing,
+ * such as mhd.\n
+ * example <tt>(ResultImageMemoryBudget 2048)</tt>\n
+ * Default: 0, which means that the whole image is computed at once.
  *
  * The command line arguments used by this class are:
  * \commandlinearg -t0: optional argument for elastix for specifying an initial transform
@@ -298,6 +305,22 @@ public:
   /** Function to transform coordinates from fixed to moving image, given as VTK file. */
   virtual void TransformPointsSomePointsVTK( const std::string filename ) const;
 
+  /** Function to transform coordinates from fixed to moving image, given as
+   * binary point file. See itk::BinaryPointFile for the format.
+   */
+  virtual void TransformPointsSomePointsBinary( const std::string filename ) const;
+
+  /** Function to transform coordinates from fixed to moving image, given
+   * as point set in memory. The result is stored as point set in memory too.
+   */
+  virtual void TransformPointsInMemory( void ) const;
+
+  /** Function to transform a number of points from fixed to moving image,
+   * multi-threaded.
+   */
+  virtual void TransformPointsMultiThreaded( const InputPointType * inputPoints,
+    OutputPointType * outputPoints, const std::size_t numberOfPoints ) const;
+
   /** Deprecation note: The plan is to split all Compute* and TransformPoints* functions
    *  into Generate* and Write* functions, since that would facilitate a proper library
    *  interface. To keep everything functional during the transition period we need to
@@ -348,6 +371,28 @@ protected:
   void AutomaticScalesEstimationStackTransform(
     const unsigned int & numSubTransforms, ScalesType & scales ) const;
 
+  /** Create an image without buffer, with the geometry of the resampler output,
+   * which can be used to convert between points and indices.
+   */
+  typename FixedImageType::Pointer CreateReferenceImage( void ) const;
+
+  /** Get the number of pieces in which an image of the given size should be
+   * computed and written, according to the ResultImageMemoryBudget parameter.
+   */
+  unsigned int GetNumberOfStreamDivisions( const double numberOfMegaBytes ) const;
+
+  /** The data shared by the threads of TransformPointsMultiThreaded(). */
+  struct TransformPointsThreaderParameterType
+  {
+    const ITKBaseType *    st_Transform;
+    const InputPointType * st_InputPoints;
+    OutputPointType *      st_OutputPoints;
+    std::size_t            st_NumberOfPoints;
+  };
+
+  /** Callback for TransformPointsMultiThreaded(). */
+  static ITK_THREAD_RETURN_TYPE TransformPointsThreaderCallback( void * arg );
+
   /** Member variables. */
   ParametersType * m_TransformParametersPointer;
   std::string      m_TransformParametersFileName;
@@ -23,10 +23,12 @@
 #include "itkPointSet.h"
 #include "itkDefaultStaticMeshTraits.h"
 #include "itkTransformixInputPointFileReader.h"
+#include "itkBinaryPointFile.h"
 #include "vnl/vnl_math.h"
 #include <itksys/SystemTools.hxx>
+#include <algorithm>
 #include "itkVector.h"
-#include "itkTransformToDisplacementFieldFilter.h"
+#include "itkTransformToDisplacementFieldSource.h"
 #include "itkTransformToDeterminantOfSpatialJacobianSource.h"
 #include "itkTransformToSpatialJacobianSource.h"
 #include "itkImageFileWriter.h"
@@ -420,7 +422,6 @@ TransformBase< TElastix >
 
     /** Read the TransformParameters. */
     std::size_t numberOfParametersFound = 0;
-    std::vector< ValueType > vecPar;
     if( useBinaryFormatForTransformationParameters )
     {
       std::string dataFileName = "";
@@ -432,11 +433,10 @@ TransformBase< TElastix >
     }
     else
     {
-      vecPar.resize( numberOfParameters, itk::NumericTraits< ValueType >::ZeroValue() );
-      this->m_Configuration->ReadParameter( vecPar, "TransformParameters",
-        0, numberOfParameters - 1, true );
-
-      /** Do not rely on vecPar.size(), since it is unchanged by ReadParameter(). */
+      /** Read directly into the transform parameters, without an
+       * intermediate vector. The entries are only read if their number
+       * is correct, which is checked below.
+       */
       numberOfParametersFound = this->m_Configuration->CountNumberOfParameterEntries( "TransformParameters" );
     }
 
@@ -457,15 +457,12 @@ TransformBase< TElastix >
       itkExceptionMacro( << makeMessage.str().c_str() );
     }
 
-    /** Copy to m_TransformParametersPointer. */
-    if( !useBinaryFormatForTransformationParameters )
+    /** Read the text parameters into m_TransformParametersPointer. */
+    if( !useBinaryFormatForTransformationParameters && numberOfParameters > 0 )
     {
-      // NOTE: we could avoid this by directly reading into the transform parameters,
-      // e.g. by overloading ReadParameter(), or use swap (?).
-      for( unsigned int i = 0; i < numberOfParameters; i++ )
-      {
-        ( *( this->m_TransformParametersPointer ) )[ i ] = vecPar[ i ];
-      }
+      this->m_Configuration->ReadParameter(
+        this->m_TransformParametersPointer->data_block(), "TransformParameters",
+        0, numberOfParameters - 1, true );
     }
 
     /** Set the parameters into this transform. */
@@ -1090,6 +1087,17 @@ TransformBase< TElastix >
     def = ipp;
   }
 
+  /** Are the input points given in memory? These are transformed
+   * in addition to the points specified by "-def".
+   */
+  const bool pointsInMemory = this->m_Elastix->GetNumberOfFixedPointSets() > 0;
+  if( pointsInMemory )
+  {
+    elxout << "  The transform is evaluated on some points, "
+           << "specified in memory." << std::endl;
+    this->TransformPointsInMemory();
+  }
+
   /** If there is an input point-file? */
   if( def != "" && def != "all" )
   {
@@ -1100,6 +1108,12 @@ TransformBase< TElastix >
              << "specified in a VTK input point file." << std::endl;
       this->TransformPointsSomePointsVTK( def );
     }
+    else if( itk::BinaryPointFile::IsBinaryPointFileName( def ) )
+    {
+      elxout << "  The transform is evaluated on some points, "
+             << "specified in a binary input point file." << std::endl;
+      this->TransformPointsSomePointsBinary( def );
+    }
     else
     {
       elxout << "  The transform is evaluated on some points, "
@@ -1113,7 +1127,7 @@ TransformBase< TElastix >
            << "The result is a deformation field." << std::endl;
     this->TransformPointsAllPoints();
   }
-  else
+  else if( !pointsInMemory )
   {
     // just a message
     elxout << "  The command-line option \"-def\" is not used, "
@@ -1142,9 +1156,6 @@ TransformBase< TElastix >
 ::TransformPointsSomePoints( const std::string filename ) const
 {
   /** Typedef's. */
-  typedef typename FixedImageType::RegionType           FixedImageRegionType;
-  typedef typename FixedImageType::PointType            FixedImageOriginType;
-  typedef typename FixedImageType::SpacingType          FixedImageSpacingType;
   typedef typename FixedImageType::IndexType            FixedImageIndexType;
   typedef typename FixedImageIndexType::IndexValueType  FixedImageIndexValueType;
   typedef typename MovingImageType::IndexType           MovingImageIndexType;
@@ -1153,7 +1164,6 @@ TransformBase< TElastix >
     itk::ContinuousIndex< double, FixedImageDimension >   FixedImageContinuousIndexType;
   typedef
     itk::ContinuousIndex< double, MovingImageDimension >  MovingImageContinuousIndexType;
-  typedef typename FixedImageType::DirectionType FixedImageDirectionType;
 
   typedef bool DummyIPPPixelType;
   typedef itk::DefaultStaticMeshTraits<
@@ -1206,25 +1216,8 @@ TransformBase< TElastix >
 
   /** Make a temporary image with the right region info,
    * which we can use to convert between points and indices.
-   * By taking the image from the resampler output, the UseDirectionCosines
-   * parameter is automatically taken into account. */
-  FixedImageRegionType region;
-  FixedImageOriginType origin
-    = this->m_Elastix->GetElxResamplerBase()->GetAsITKBaseType()->GetOutputOrigin();
-  FixedImageSpacingType spacing
-    = this->m_Elastix->GetElxResamplerBase()->GetAsITKBaseType()->GetOutputSpacing();
-  FixedImageDirectionType direction
-    = this->m_Elastix->GetElxResamplerBase()->GetAsITKBaseType()->GetOutputDirection();
-  region.SetIndex(
-    this->m_Elastix->GetElxResamplerBase()->GetAsITKBaseType()->GetOutputStartIndex() );
-  region.SetSize(
-    this->m_Elastix->GetElxResamplerBase()->GetAsITKBaseType()->GetSize() );
-
-  typename FixedImageType::Pointer dummyImage = FixedImageType::New();
-  dummyImage->SetRegions( region );
-  dummyImage->SetOrigin( origin );
-  dummyImage->SetSpacing( spacing );
-  dummyImage->SetDirection( direction );
+   */
+  typename FixedImageType::Pointer dummyImage = this->CreateReferenceImage();
 
   /** Temp vars */
   FixedImageContinuousIndexType  fixedcindex;
@@ -1278,11 +1271,13 @@ TransformBase< TElastix >
 
   /** Apply the transform. */
   elxout << "  The input points are transformed." << std::endl;
-  for( unsigned int j = 0; j < nrofpoints; j++ )
+  if( nrofpoints > 0 )
   {
-    /** Call TransformPoint. */
-    outputpointvec[ j ] = this->GetAsITKBaseType()->TransformPoint( inputpointvec[ j ] );
+    this->TransformPointsMultiThreaded( &inputpointvec[ 0 ], &outputpointvec[ 0 ], nrofpoints );
+  }
 
+  for( unsigned int j = 0; j < nrofpoints; j++ )
+  {
     /** Transform back to index in fixed image domain. */
     dummyImage->TransformPhysicalPointToContinuousIndex(
       outputpointvec[ j ], fixedcindex );
@@ -1365,7 +1360,8 @@ TransformBase< TElastix >
       }
     }
 
-    outputPointsFile << "]" << std::endl;
+    /** Do not flush after every point, which is slow for large point sets. */
+    outputPointsFile << "]\n";
   } // end for nrofpoints
 
 } // end TransformPointsSomePoints()
@@ -1457,6 +1453,289 @@ TransformBase< TElastix >
 } // end TransformPointsSomePointsVTK()
 
 
+/**
+ * ************** TransformPointsSomePointsBinary *********************
+ *
+ * This function reads points from a binary point file and transforms
+ * these fixed-image coordinates to moving-image coordinates.
+ *
+ * The points are read, transformed and written in chunks, so the memory
+ * use does not depend on the number of points. The transformed points are
+ * saved in world coordinates as outputpoints.bin. Input points that are
+ * specified as indices may be continuous indices.
+ */
+
+template< class TElastix >
+void
+TransformBase< TElastix >
+::TransformPointsSomePointsBinary( const std::string filename ) const
+{
+  /** Typedef's. */
+  typedef itk::BinaryPointFile BinaryPointFileType;
+  typedef
+    itk::ContinuousIndex< double, FixedImageDimension >   FixedImageContinuousIndexType;
+
+  /** The number of points that is read, transformed and written at once. */
+  const itk::SizeValueType chunkSize = 65536;
+
+  /** Open the input point file and read the header. */
+  elxout << "  Reading input point file: " << filename << std::endl;
+  std::ifstream                   inputPointsFile( filename.c_str(), std::ios::in | std::ios::binary );
+  BinaryPointFileType::HeaderType header;
+  if( !inputPointsFile.is_open() || !BinaryPointFileType::ReadHeader( inputPointsFile, header ) )
+  {
+    xl::xout[ "error" ] << "  Error while opening input point file." << std::endl;
+    return;
+  }
+  if( header.Dimension != FixedImageDimension )
+  {
+    xl::xout[ "error" ] << "  Error: the input points have dimension " << header.Dimension
+                        << ", while the fixed image has dimension " << FixedImageDimension
+                        << "." << std::endl;
+    return;
+  }
+
+  /** Some user-feedback. */
+  if( header.PointsAreIndices )
+  {
+    elxout << "  Input points are specified as image indices." << std::endl;
+  }
+  else
+  {
+    elxout << "  Input points are specified in world coordinates." << std::endl;
+  }
+  elxout << "  Number of specified input points: " << header.NumberOfPoints << std::endl;
+
+  /** Make a temporary image with the right region info,
+   * which we can use to convert indices to points.
+   */
+  typename FixedImageType::Pointer dummyImage = this->CreateReferenceImage();
+
+  /** Create the output file and write the header. */
+  std::string outputPointsFileName = this->m_Configuration
+    ->GetCommandLineArgument( "-out" );
+  outputPointsFileName += "outputpoints";
+  outputPointsFileName += BinaryPointFileType::GetFileNameExtension();
+  std::ofstream outputPointsFile( outputPointsFileName.c_str(), std::ios::out | std::ios::binary );
+  if( !outputPointsFile.is_open() )
+  {
+    xl::xout[ "error" ] << "  Error while opening output point file: "
+                        << outputPointsFileName << std::endl;
+    return;
+  }
+  elxout << "  The transformed points are saved in: "
+         <<  outputPointsFileName << std::endl;
+
+  BinaryPointFileType::HeaderType outputHeader;
+  outputHeader.Dimension      = MovingImageDimension;
+  outputHeader.NumberOfPoints = header.NumberOfPoints;
+  BinaryPointFileType::WriteHeader( outputPointsFile, outputHeader );
+
+  /** Read, transform and write the points chunk by chunk. */
+  elxout << "  The input points are transformed." << std::endl;
+  std::vector< double >          inputCoordinates( chunkSize * FixedImageDimension );
+  std::vector< double >          outputCoordinates( chunkSize * MovingImageDimension );
+  std::vector< InputPointType >  inputPoints( chunkSize );
+  std::vector< OutputPointType > outputPoints( chunkSize );
+  FixedImageContinuousIndexType  fixedcindex;
+
+  for( itk::uint64_t first = 0; first < header.NumberOfPoints; first += chunkSize )
+  {
+    const itk::SizeValueType numberOfPoints = static_cast< itk::SizeValueType >(
+      std::min< itk::uint64_t >( chunkSize, header.NumberOfPoints - first ) );
+
+    if( BinaryPointFileType::ReadPoints( inputPointsFile, FixedImageDimension,
+      numberOfPoints, &inputCoordinates[ 0 ] ) != numberOfPoints )
+    {
+      xl::xout[ "error" ] << "  Error while reading input point file: "
+                          << "the file contains less points than specified." << std::endl;
+      return;
+    }
+
+    /** Get the input points, in world coordinates. */
+    const double * coordinate = &inputCoordinates[ 0 ];
+    for( itk::SizeValueType j = 0; j < numberOfPoints; ++j )
+    {
+      if( header.PointsAreIndices )
+      {
+        for( unsigned int i = 0; i < FixedImageDimension; ++i )
+        {
+          fixedcindex[ i ] = *coordinate++;
+        }
+        dummyImage->TransformContinuousIndexToPhysicalPoint( fixedcindex, inputPoints[ j ] );
+      }
+      else
+      {
+        for( unsigned int i = 0; i < FixedImageDimension; ++i )
+        {
+          inputPoints[ j ][ i ] = *coordinate++;
+        }
+      }
+    }
+
+    this->TransformPointsMultiThreaded( &inputPoints[ 0 ], &outputPoints[ 0 ], numberOfPoints );
+
+    /** Write the output points. */
+    double * outputCoordinate = &outputCoordinates[ 0 ];
+    for( itk::SizeValueType j = 0; j < numberOfPoints; ++j )
+    {
+      for( unsigned int i = 0; i < MovingImageDimension; ++i )
+      {
+        *outputCoordinate++ = outputPoints[ j ][ i ];
+      }
+    }
+    BinaryPointFileType::WritePoints( outputPointsFile, MovingImageDimension,
+      numberOfPoints, &outputCoordinates[ 0 ] );
+  }
+
+  if( !outputPointsFile )
+  {
+    xl::xout[ "error" ] << "  Error while saving points." << std::endl;
+  }
+
+} // end TransformPointsSomePointsBinary()
+
+
+/**
+ * ************** TransformPointsInMemory *********************
+ *
+ * The points of the fixed point set are transformed directly into
+ * the points container of the result point set, so no intermediate
+ * copies are made.
+ */
+
+template< class TElastix >
+void
+TransformBase< TElastix >
+::TransformPointsInMemory( void ) const
+{
+  /** Typedef's. */
+  typedef typename ElastixType::FixedPointSetType  FixedPointSetType;
+  typedef typename ElastixType::ResultPointSetType ResultPointSetType;
+  typedef typename ResultPointSetType::PointsContainer ResultPointsContainerType;
+
+  /** Get the input points. */
+  const FixedPointSetType * inputPointSet = this->m_Elastix->GetFixedPointSet();
+  if( inputPointSet == 0 )
+  {
+    itkExceptionMacro( << "ERROR: the input point set does not have the "
+                       << "dimension of the transform, or is not of type "
+                       << "itk::PointSet< double, Dimension >." );
+  }
+  const std::size_t nrofpoints = inputPointSet->GetNumberOfPoints();
+  elxout << "  Number of specified input points: " << nrofpoints << std::endl;
+
+  /** Create the output points. */
+  typename ResultPointsContainerType::Pointer outputPoints = ResultPointsContainerType::New();
+  outputPoints->Reserve( nrofpoints );
+
+  /** Transform the points, multi-threaded. */
+  if( nrofpoints > 0 )
+  {
+    this->TransformPointsMultiThreaded(
+      &inputPointSet->GetPoints()->CastToSTLConstContainer()[ 0 ],
+      &outputPoints->CastToSTLContainer()[ 0 ], nrofpoints );
+  }
+
+  /** Put the result point set in the container. */
+  typename ResultPointSetType::Pointer outputPointSet = ResultPointSetType::New();
+  outputPointSet->SetPoints( outputPoints );
+  this->m_Elastix->SetResultPointSet( outputPointSet.GetPointer() );
+
+} // end TransformPointsInMemory()
+
+
+/**
+ * ************** TransformPointsMultiThreaded *********************
+ */
+
+template< class TElastix >
+void
+TransformBase< TElastix >
+::TransformPointsMultiThreaded( const InputPointType * inputPoints,
+  OutputPointType * outputPoints, const std::size_t numberOfPoints ) const
+{
+  /** Setup the threader. TransformPoint() is thread-safe, since the
+   * transforms are also evaluated multi-threaded by the metrics.
+   */
+  TransformPointsThreaderParameterType userData;
+  userData.st_Transform      = this->GetAsITKBaseType();
+  userData.st_InputPoints    = inputPoints;
+  userData.st_OutputPoints   = outputPoints;
+  userData.st_NumberOfPoints = numberOfPoints;
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetSingleMethod( TransformPointsThreaderCallback, &userData );
+  threader->SingleMethodExecute();
+
+} // end TransformPointsMultiThreaded()
+
+
+/**
+ * ************** TransformPointsThreaderCallback *********************
+ */
+
+template< class TElastix >
+ITK_THREAD_RETURN_TYPE
+TransformBase< TElastix >
+::TransformPointsThreaderCallback( void * arg )
+{
+  typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+  ThreadInfoType *  infoStruct  = static_cast< ThreadInfoType * >( arg );
+  const std::size_t  threadId    = infoStruct->ThreadID;
+  const std::size_t  nrOfThreads = infoStruct->NumberOfThreads;
+
+  TransformPointsThreaderParameterType * temp
+    = static_cast< TransformPointsThreaderParameterType * >( infoStruct->UserData );
+
+  /** Each thread transforms a contiguous range of points. */
+  const std::size_t numberOfPoints = temp->st_NumberOfPoints;
+  const std::size_t chunkSize      = ( numberOfPoints + nrOfThreads - 1 ) / nrOfThreads;
+  const std::size_t begin          = std::min( threadId * chunkSize, numberOfPoints );
+  const std::size_t end            = std::min( begin + chunkSize, numberOfPoints );
+
+  for( std::size_t j = begin; j < end; ++j )
+  {
+    temp->st_OutputPoints[ j ] = temp->st_Transform->TransformPoint( temp->st_InputPoints[ j ] );
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end TransformPointsThreaderCallback()
+
+
+/**
+ * ************** CreateReferenceImage *********************
+ */
+
+template< class TElastix >
+typename TransformBase< TElastix >::FixedImageType::Pointer
+TransformBase< TElastix >
+::CreateReferenceImage( void ) const
+{
+  /** By taking the geometry from the resampler output, the UseDirectionCosines
+   * parameter is automatically taken into account.
+   */
+  typedef typename FixedImageType::RegionType RegionType;
+
+  const typename ElastixType::ResamplerBaseType::ITKBaseType * resampler
+    = this->m_Elastix->GetElxResamplerBase()->GetAsITKBaseType();
+
+  RegionType region;
+  region.SetIndex( resampler->GetOutputStartIndex() );
+  region.SetSize( resampler->GetSize() );
+
+  typename FixedImageType::Pointer referenceImage = FixedImageType::New();
+  referenceImage->SetRegions( region );
+  referenceImage->SetOrigin( resampler->GetOutputOrigin() );
+  referenceImage->SetSpacing( resampler->GetOutputSpacing() );
+  referenceImage->SetDirection( resampler->GetOutputDirection() );
+
+  return referenceImage;
+
+} // end CreateReferenceImage()
+
+
 /**
  * ************** TransformPointsAllPoints **********************
  *
@@ -1486,7 +1765,8 @@ TransformBase< TElastix >
  *
  * This function transforms all indexes to a physical point.
  * The difference vector (= the deformation at that index) is
- * stored in an image of vectors (of floats).
+ * stored in an image of vectors (of floats). The voxels are
+ * transformed line by line, see TransformToDisplacementFieldSource.
  */
 
 template< class TElastix >
@@ -1496,7 +1776,7 @@ TransformBase< TElastix >
 {
   /** Typedef's. */
   typedef typename FixedImageType::DirectionType FixedImageDirectionType;
-  typedef itk::TransformToDisplacementFieldFilter<
+  typedef itk::TransformToDisplacementFieldSource<
     DeformationFieldImageType, CoordRepType >         DeformationFieldGeneratorType;
   typedef itk::ChangeInformationImageFilter<
     DeformationFieldImageType >                       ChangeInfoFilterType;
@@ -1504,13 +1784,13 @@ TransformBase< TElastix >
   /** Create an setup deformation field generator. */
   typename DeformationFieldGeneratorType::Pointer defGenerator
     = DeformationFieldGeneratorType::New();
-  defGenerator->SetSize(
+  defGenerator->SetOutputSize(
     this->m_Elastix->GetElxResamplerBase()->GetAsITKBaseType()->GetSize() );
   defGenerator->SetOutputSpacing(
     this->m_Elastix->GetElxResamplerBase()->GetAsITKBaseType()->GetOutputSpacing() );
   defGenerator->SetOutputOrigin(
     this->m_Elastix->GetElxResamplerBase()->GetAsITKBaseType()->GetOutputOrigin() );
-  defGenerator->SetOutputStartIndex(
+  defGenerator->SetOutputIndex(
     this->m_Elastix->GetElxResamplerBase()->GetAsITKBaseType()->GetOutputStartIndex() );
   defGenerator->SetOutputDirection(
     this->m_Elastix->GetElxResamplerBase()->GetAsITKBaseType()->GetOutputDirection() );
@@ -1677,10 +1957,13 @@ TransformBase< TElastix >
   makeFileName << this->m_Configuration->GetCommandLineArgument( "-out" )
                << "spatialJacobian." << resultImageFormat;
 
-  /** Write outputImage to disk. */
+  /** Write outputImage to disk. Large images are computed and written in pieces. */
   typename JacobianWriterType::Pointer jacWriter = JacobianWriterType::New();
   jacWriter->SetInput( infoChanger->GetOutput() );
   jacWriter->SetFileName( makeFileName.str().c_str() );
+  const double numberOfMegaBytes = static_cast< double >( sizeof( float ) )
+    * jacGenerator->GetOutputRegion().GetNumberOfPixels() / 1048576.0;
+  jacWriter->SetNumberOfStreamDivisions( this->GetNumberOfStreamDivisions( numberOfMegaBytes ) );
 
   /** Do the writing. */
   elxout << "  Computing and writing the spatial Jacobian determinant..." << std::endl;
@@ -1784,6 +2067,9 @@ TransformBase< TElastix >
   typename JacobianWriterType::Pointer jacWriter = JacobianWriterType::New();
   jacWriter->SetInput( infoChanger->GetOutput() );
   jacWriter->SetFileName( makeFileName.str().c_str() );
+  const double numberOfMegaBytes = static_cast< double >( sizeof( OutputSpatialJacobianType ) )
+    * jacGenerator->GetOutputRegion().GetNumberOfPixels() / 1048576.0;
+  jacWriter->SetNumberOfStreamDivisions( this->GetNumberOfStreamDivisions( numberOfMegaBytes ) );
   /** Hack to change the pixel type to vector. Not necessary for mhd. */
   typename PixelTypeChangeCommandType::Pointer jacStartWriteCommand
     = PixelTypeChangeCommandType::New();
@@ -1813,6 +2099,28 @@ TransformBase< TElastix >
 } // end ComputeSpatialJacobian()
 
 
+/**
+ * ************** GetNumberOfStreamDivisions **********************
+ */
+
+template< class TElastix >
+unsigned int
+TransformBase< TElastix >
+::GetNumberOfStreamDivisions( const double numberOfMegaBytes ) const
+{
+  const unsigned int numberOfDivisions
+    = this->GetNumberOfPiecesForMemoryBudget( numberOfMegaBytes );
+  if( numberOfDivisions > 1 )
+  {
+    elxout << "  The image is computed and written in " << numberOfDivisions
+           << " pieces, to stay within the ResultImageMemoryBudget." << std::endl;
+  }
+
+  return numberOfDivisions;
+
+} // end GetNumberOfStreamDivisions()
+
+
 /**
  * ************** SetTransformParametersFileName ****************
  */
@@ -236,6 +236,29 @@ public:
   }
 
 
+  /** Read a range of parameters from the parameter file, directly into
+   * a buffer of at least entry_nr_end - entry_nr_start + 1 elements.
+   */
+  template< class T >
+  bool ReadParameter( T * parameterValues,
+    const std::string & parameterName,
+    const unsigned int entry_nr_start,
+    const unsigned int entry_nr_end,
+    const bool printThisErrorMessage ) const
+  {
+    std::string errorMessage = "";
+    bool        found        = this->m_ParameterMapInterface->ReadParameter(
+      parameterValues, parameterName, entry_nr_start, entry_nr_end,
+      printThisErrorMessage, errorMessage );
+    if( errorMessage != "" )
+    {
+      xl::xout[ "error" ] << errorMessage;
+    }
+
+    return found;
+  }
+
+
 protected:
 
   Configuration();
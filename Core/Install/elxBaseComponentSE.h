@@ -109,6 +109,12 @@ public:
   }
 
 
+  /** Get the number of pieces in which an image of \a numberOfMegaBytes
+   * should be computed, according to the ResultImageMemoryBudget parameter.
+   * Returns 1 if no budget is given or if the image fits in it.
+   */
+  unsigned int GetNumberOfPiecesForMemoryBudget( const double numberOfMegaBytes ) const;
+
 protected:
 
   BaseComponentSE();
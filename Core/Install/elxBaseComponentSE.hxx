@@ -20,6 +20,7 @@
 #define __elxBaseComponentSE_hxx
 
 #include "elxBaseComponentSE.h"
+#include <cmath>
 
 namespace elastix
 {
@@ -93,6 +94,28 @@ BaseComponentSE< TElastix >::SetConfiguration( ConfigurationType * _arg )
 } // end SetConfiguration
 
 
+/**
+ * *************** GetNumberOfPiecesForMemoryBudget *******************
+ */
+
+template< class TElastix >
+unsigned int
+BaseComponentSE< TElastix >::GetNumberOfPiecesForMemoryBudget(
+  const double numberOfMegaBytes ) const
+{
+  /** Read the memory budget; zero means no limit. */
+  double memoryBudget = 0.0;
+  this->m_Configuration->ReadParameter( memoryBudget, "ResultImageMemoryBudget", 0, false );
+  if( memoryBudget <= 0.0 || numberOfMegaBytes <= memoryBudget )
+  {
+    return 1;
+  }
+
+  return static_cast< unsigned int >( std::ceil( numberOfMegaBytes / memoryBudget ) );
+
+} // end GetNumberOfPiecesForMemoryBudget()
+
+
 } // end namespace elastix
 
 #endif // end #ifndef __elxBaseComponentSE_hxx
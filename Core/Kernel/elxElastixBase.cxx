@@ -17,7 +17,7 @@
  *=========================================================================*/
 #include "elxElastixBase.h"
 #include <sstream>
-#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkRandomVariateGeneratorInstance.h"
 
 namespace elastix
 {
@@ -61,6 +61,10 @@ ElastixBase::ElastixBase()
 
   this->m_ResultImageContainer = DataObjectContainerType::New();
 
+  this->m_FixedPointSetContainer  = 0;
+  this->m_MovingPointSetContainer = 0;
+  this->m_ResultPointSetContainer = 0;
+
   /** Initialize initialTransform and final transform. */
   this->m_InitialTransform = 0;
   this->m_FinalTransform   = 0;
@@ -242,7 +246,7 @@ ElastixBase::BeforeAllBase( void )
   typedef RandomGeneratorType::IntegerType                       SeedType;
   unsigned int randomSeed = 121212;
   this->GetConfiguration()->ReadParameter( randomSeed, "RandomSeed", 0, false );
-  RandomGeneratorType::Pointer randomGenerator = RandomGeneratorType::GetInstance();
+  RandomGeneratorType::Pointer randomGenerator = itk::RandomVariateGeneratorInstance::Get();
   randomGenerator->SetSeed( static_cast< SeedType >( randomSeed ) );
 
   /** Return a value. */
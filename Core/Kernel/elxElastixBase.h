@@ -256,6 +256,18 @@ public:
   elxGetObjectMacro( ResultDeformationFieldContainer, DataObjectContainerType );
   elxSetObjectMacro( ResultDeformationFieldContainer, DataObjectContainerType );
 
+  /** Set/Get the fixed/moving point set containers. These are filled when
+   * the point sets are given in memory instead of by the -fp/-mp/-def files.
+   */
+  elxGetObjectMacro( FixedPointSetContainer, DataObjectContainerType );
+  elxGetObjectMacro( MovingPointSetContainer, DataObjectContainerType );
+  elxSetObjectMacro( FixedPointSetContainer, DataObjectContainerType );
+  elxSetObjectMacro( MovingPointSetContainer, DataObjectContainerType );
+
+  /** Set/Get the result point set container. */
+  elxGetObjectMacro( ResultPointSetContainer, DataObjectContainerType );
+  elxSetObjectMacro( ResultPointSetContainer, DataObjectContainerType );
+
   /** Set/Get The Image FileName containers.
    * Normally, these are filled in the BeforeAllBase function.
    */
@@ -293,6 +305,9 @@ public:
   elxGetNumberOfMacro( MovingMaskFileName );
   elxGetNumberOfMacro( ResultImage );
   elxGetNumberOfMacro( ResultDeformationField );
+  elxGetNumberOfMacro( FixedPointSet );
+  elxGetNumberOfMacro( MovingPointSet );
+  elxGetNumberOfMacro( ResultPointSet );
 
   /** Set/Get the initial transform
    * The type is ObjectType, but the pointer should actually point
@@ -533,6 +548,11 @@ private:
   /** The result deformation field container. These are stored as pointers to itk::DataObject. */
   DataObjectContainerPointer m_ResultDeformationFieldContainer;
 
+  /** The point set containers. These are stored as pointers to itk::DataObject. */
+  DataObjectContainerPointer m_FixedPointSetContainer;
+  DataObjectContainerPointer m_MovingPointSetContainer;
+  DataObjectContainerPointer m_ResultPointSetContainer;
+
   /** The image and mask FileNameContainers. */
   FileNameContainerPointer m_FixedImageFileNameContainer;
   FileNameContainerPointer m_MovingImageFileNameContainer;
@@ -28,6 +28,7 @@
 
 #include "elxMacro.h"
 #include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
 
 #ifdef ELASTIX_USE_OPENCL
 #include "itkOpenCLSetup.h"
@@ -56,27 +57,30 @@ xoutsimple_type g_CoutOnlyXout;
 xoutsimple_type g_LogOnlyXout;
 std::ofstream   g_LogFileStream;
 
+/** Guards the loading of the components in the ComponentDatabase. */
+itk::SimpleFastMutexLock g_LoadComponentsMutex;
+
 /**
- * ********************* xoutSetup ******************************
+ * ********************* xoutSetupTargets ******************************
  *
- * NB: this function is a global function, not part of the ElastixMain
- * class!!
+ * Connects the outputs and the target cells of an xout. Used by
+ * xoutSetup() and xoutSetupThread().
  */
 
-int
-xoutSetup( const char * logfilename, bool setupLogging, bool setupCout )
+static int
+xoutSetupTargets( xoutbase_type & mainXout,
+  xoutsimple_type & warningXout, xoutsimple_type & errorXout,
+  xoutsimple_type & standardXout, xoutsimple_type & coutOnlyXout,
+  xoutsimple_type & logOnlyXout, std::ofstream & logFileStream,
+  const char * logfilename, bool setupLogging, bool setupCout )
 {
-  /** The namespace of xout. */
-  using namespace xl;
-
   int returndummy = 0;
-  set_xout( &g_xout );
 
   if( setupLogging )
   {
     /** Open the logfile for writing. */
-    g_LogFileStream.open( logfilename );
-    if( !g_LogFileStream.is_open() )
+    logFileStream.open( logfilename );
+    if( !logFileStream.is_open() )
     {
       std::cerr << "ERROR: LogFile cannot be opened!" << std::endl;
       return 1;
@@ -86,43 +90,89 @@ xoutSetup( const char * logfilename, bool setupLogging, bool setupCout )
   /** Set std::cout and the logfile as outputs of xout. */
   if( setupLogging )
   {
-    returndummy |= xout.AddOutput( "log", &g_LogFileStream );
+    returndummy |= mainXout.AddOutput( "log", &logFileStream );
   }
   if( setupCout )
   {
-    returndummy |= xout.AddOutput( "cout", &std::cout );
+    returndummy |= mainXout.AddOutput( "cout", &std::cout );
   }
 
   /** Set outputs of LogOnly and CoutOnly. */
-  returndummy |= g_LogOnlyXout.AddOutput( "log", &g_LogFileStream );
-  returndummy |= g_CoutOnlyXout.AddOutput( "cout", &std::cout );
+  returndummy |= logOnlyXout.AddOutput( "log", &logFileStream );
+  returndummy |= coutOnlyXout.AddOutput( "cout", &std::cout );
 
   /** Copy the outputs to the warning-, error- and standard-xouts. */
-  g_WarningXout.SetOutputs( xout.GetCOutputs() );
-  g_ErrorXout.SetOutputs( xout.GetCOutputs() );
-  g_StandardXout.SetOutputs( xout.GetCOutputs() );
+  warningXout.SetOutputs( mainXout.GetCOutputs() );
+  errorXout.SetOutputs( mainXout.GetCOutputs() );
+  standardXout.SetOutputs( mainXout.GetCOutputs() );
 
-  g_WarningXout.SetOutputs( xout.GetXOutputs() );
-  g_ErrorXout.SetOutputs( xout.GetXOutputs() );
-  g_StandardXout.SetOutputs( xout.GetXOutputs() );
+  warningXout.SetOutputs( mainXout.GetXOutputs() );
+  errorXout.SetOutputs( mainXout.GetXOutputs() );
+  standardXout.SetOutputs( mainXout.GetXOutputs() );
 
   /** Link the warning-, error- and standard-xouts to xout. */
-  returndummy |= xout.AddTargetCell( "warning", &g_WarningXout );
-  returndummy |= xout.AddTargetCell( "error", &g_ErrorXout );
-  returndummy |= xout.AddTargetCell( "standard", &g_StandardXout );
-  returndummy |= xout.AddTargetCell( "logonly", &g_LogOnlyXout );
-  returndummy |= xout.AddTargetCell( "coutonly", &g_CoutOnlyXout );
+  returndummy |= mainXout.AddTargetCell( "warning", &warningXout );
+  returndummy |= mainXout.AddTargetCell( "error", &errorXout );
+  returndummy |= mainXout.AddTargetCell( "standard", &standardXout );
+  returndummy |= mainXout.AddTargetCell( "logonly", &logOnlyXout );
+  returndummy |= mainXout.AddTargetCell( "coutonly", &coutOnlyXout );
 
   /** Format the output. */
-  xout[ "standard" ] << std::fixed;
-  xout[ "standard" ] << std::showpoint;
+  mainXout[ "standard" ] << std::fixed;
+  mainXout[ "standard" ] << std::showpoint;
 
   /** Return a value. */
   return returndummy;
 
+} // end xoutSetupTargets()
+
+
+/**
+ * ********************* xoutSetup ******************************
+ *
+ * NB: this function is a global function, not part of the ElastixMain
+ * class!!
+ */
+
+int
+xoutSetup( const char * logfilename, bool setupLogging, bool setupCout )
+{
+  /** The namespace of xout. */
+  using namespace xl;
+
+  set_xout( &g_xout );
+
+  return xoutSetupTargets( g_xout,
+    g_WarningXout, g_ErrorXout, g_StandardXout, g_CoutOnlyXout, g_LogOnlyXout,
+    g_LogFileStream, logfilename, setupLogging, setupCout );
+
 } // end xoutSetup()
 
 
+/**
+ * ********************* xoutSetupThread ******************************
+ *
+ * NB: this function is a global function, not part of the ElastixMain
+ * class!!
+ */
+
+int
+xoutSetupThread( const char * logfilename, bool setupLogging, bool setupCout,
+  ThreadXoutType & threadXout )
+{
+  /** The namespace of xout. */
+  using namespace xl;
+
+  set_thread_xout( &threadXout.m_Xout );
+
+  return xoutSetupTargets( threadXout.m_Xout,
+    threadXout.m_WarningXout, threadXout.m_ErrorXout, threadXout.m_StandardXout,
+    threadXout.m_CoutOnlyXout, threadXout.m_LogOnlyXout,
+    threadXout.m_LogFileStream, logfilename, setupLogging, setupCout );
+
+} // end xoutSetupThread()
+
+
 /**
  * ********************* Constructor ****************************
  */
@@ -150,6 +200,10 @@ ElastixMain::ElastixMain()
 
   this->m_ResultImageContainer = 0;
 
+  this->m_FixedPointSetContainer  = 0;
+  this->m_MovingPointSetContainer = 0;
+  this->m_ResultPointSetContainer = 0;
+
   this->m_FinalTransform   = 0;
   this->m_InitialTransform = 0;
   this->m_TransformParametersMap.clear();
@@ -370,6 +424,45 @@ ElastixMain::Run( void )
     return 1;
   }
 
+  /** Run elastix with the created components. */
+  return this->RunWithCurrentComponents();
+
+} // end Run()
+
+
+/**
+ * **************************** Rerun *****************************
+ *
+ * Runs the registration again with the components that were created
+ * by a previous call to Run(), using the images, masks and initial
+ * transform that are currently set.
+ */
+
+int
+ElastixMain::Rerun( void )
+{
+  /** Nothing to reuse yet, so do a normal run. */
+  if( this->m_Elastix.IsNull() )
+  {
+    return this->Run();
+  }
+
+  this->SetMaximumNumberOfThreads();
+
+  return this->RunWithCurrentComponents();
+
+} // end Rerun()
+
+
+/**
+ * ******************* RunWithCurrentComponents ********************
+ */
+
+int
+ElastixMain::RunWithCurrentComponents( void )
+{
+  int errorCode = 0;
+
   /** Set the images and masks. If not set by the user, it is not a problem.
    * ElastixTemplate will try to load them from disk.
    */
@@ -378,6 +471,8 @@ ElastixMain::Run( void )
   this->GetElastixBase()->SetFixedMaskContainer( this->GetModifiableFixedMaskContainer() );
   this->GetElastixBase()->SetMovingMaskContainer( this->GetModifiableMovingMaskContainer() );
   this->GetElastixBase()->SetResultImageContainer( this->GetModifiableResultImageContainer() );
+  this->GetElastixBase()->SetFixedPointSetContainer( this->GetModifiableFixedPointSetContainer() );
+  this->GetElastixBase()->SetMovingPointSetContainer( this->GetModifiableMovingPointSetContainer() );
 
   /** Set the initial transform, if it happens to be there. */
   this->GetElastixBase()->SetInitialTransform( this->GetModifiableInitialTransform() );
@@ -434,7 +529,7 @@ ElastixMain::Run( void )
   /** Return a value. */
   return errorCode;
 
-} // end Run()
+} // end RunWithCurrentComponents()
 
 
 /**
@@ -634,15 +729,20 @@ ElastixMain::InitDBIndex( void )
       }
     }
 
-    /** Load the components. */
+    /** Load the components. The lock makes sure they are loaded only once
+     * when several registrations are started concurrently.
+     */
+    int loadReturnCode = 0;
+    g_LoadComponentsMutex.Lock();
     if( this->s_CDB.IsNull() )
     {
-      int loadReturnCode = this->LoadComponents();
-      if( loadReturnCode != 0 )
-      {
-        xout[ "error" ] << "Loading components failed" << std::endl;
-        return loadReturnCode;
-      }
+      loadReturnCode = this->LoadComponents();
+    }
+    g_LoadComponentsMutex.Unlock();
+    if( loadReturnCode != 0 )
+    {
+      xout[ "error" ] << "Loading components failed" << std::endl;
+      return loadReturnCode;
     }
 
     if( this->s_CDB.IsNotNull() )
@@ -971,6 +1071,15 @@ ElastixMain::SetProcessPriority( void ) const
 void
 ElastixMain::SetMaximumNumberOfThreads( void ) const
 {
+  /** A job of a concurrent batch leaves the global setting alone: other jobs
+   * may read or write it at the same time. Its components take the number of
+   * threads from the -threads argument themselves.
+   */
+  if( this->m_Configuration->GetCommandLineArgument( "-batchjob" ) == "true" )
+  {
+    return;
+  }
+
   /** Get the number of threads from the command line. */
   std::string maximumNumberOfThreadsString
     = this->m_Configuration->GetCommandLineArgument( "-threads" );
@@ -54,6 +54,26 @@ namespace elastix
  */
 extern int xoutSetup( const char * logfilename, bool setupLogging, bool setupCout );
 
+/** The xout and its target cells and log file, for a thread that runs a
+ * registration concurrently with registrations in other threads.
+ */
+struct ThreadXoutType
+{
+  xl::xoutbase_type   m_Xout;
+  xl::xoutsimple_type m_WarningXout;
+  xl::xoutsimple_type m_ErrorXout;
+  xl::xoutsimple_type m_StandardXout;
+  xl::xoutsimple_type m_CoutOnlyXout;
+  xl::xoutsimple_type m_LogOnlyXout;
+  std::ofstream       m_LogFileStream;
+};
+
+/** Like xoutSetup(), but sets up threadXout as the xout of the calling
+ * thread only. Call xl::set_thread_xout( 0 ) before threadXout is destroyed.
+ */
+extern int xoutSetupThread( const char * logfilename, bool setupLogging, bool setupCout,
+  ThreadXoutType & threadXout );
+
 /**
  * \class ElastixMain
  * \brief A class with all functionality to configure elastix.
@@ -186,6 +206,21 @@ public:
   itkSetObjectMacro( ResultDeformationFieldContainer, DataObjectContainerType );
   itkGetModifiableObjectMacro( ResultDeformationFieldContainer, DataObjectContainerType );
 
+  /** Set/Get functions for the fixed and moving point sets
+   * (if these are not used, elastix tries to read them from disk,
+   * according to the command line parameters).
+   */
+  itkSetObjectMacro( FixedPointSetContainer, DataObjectContainerType );
+  itkSetObjectMacro( MovingPointSetContainer, DataObjectContainerType );
+  itkGetModifiableObjectMacro( FixedPointSetContainer, DataObjectContainerType );
+  itkGetModifiableObjectMacro( MovingPointSetContainer, DataObjectContainerType );
+
+  /** Set/Get functions for the result point sets, which are created
+   * instead of an outputpoints file when the input points are given in memory.
+   */
+  itkSetObjectMacro( ResultPointSetContainer, DataObjectContainerType );
+  itkGetModifiableObjectMacro( ResultPointSetContainer, DataObjectContainerType );
+
   /** Set/Get the configuration object. */
   itkSetObjectMacro( Configuration, ConfigurationType );
   itkGetModifiableObjectMacro( Configuration, ConfigurationType );
@@ -263,6 +298,15 @@ public:
 
   virtual int Run( ArgumentMapType & argmap, ParameterMapType & inputMap );
 
+  /** Run the registration again, reusing the configuration and the
+   * components that were created by a previous call to Run(). Only the
+   * images, masks, result image and initial transform that are currently
+   * set are passed to the components again, which avoids the cost of
+   * creating and configuring the components for every image pair.
+   * Falls back to Run() when Run() has not been called before.
+   */
+  virtual int Rerun( void );
+
   /** Set process priority, which is read from the command line arguments.
    * Syntax:
    * -priority \<high, belownormal\>
@@ -327,6 +371,9 @@ protected:
   DataObjectContainerPointer m_MovingMaskContainer;
   DataObjectContainerPointer m_ResultImageContainer;
   DataObjectContainerPointer m_ResultDeformationFieldContainer;
+  DataObjectContainerPointer m_FixedPointSetContainer;
+  DataObjectContainerPointer m_MovingPointSetContainer;
+  DataObjectContainerPointer m_ResultPointSetContainer;
 
   /** A transform that is the result of registration. */
   ObjectPointer m_FinalTransform;
@@ -376,6 +423,11 @@ protected:
     int & errorcode,
     bool mandatoryComponent = true );
 
+  /** Pass the images, masks and initial transform to the components that
+   * were created by Run(), run the registration, and store the results.
+   */
+  virtual int RunWithCurrentComponents( void );
+
   /** Helper function to obtain information from images on disk. */
   void GetImageInformationFromFile( const std::string & filename,
     ImageDimensionType & imageDimension ) const;
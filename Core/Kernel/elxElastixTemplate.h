@@ -24,6 +24,7 @@
 #include "itkObjectFactory.h"
 #include "itkCommand.h"
 #include "itkImage.h"
+#include "itkPointSet.h"
 #include "itkImageFileReader.h"
 #include "itkImageToImageMetric.h"
 
@@ -39,6 +40,8 @@
 #include "elxTransformBase.h"
 
 #include "itkTimeProbe.h"
+#include "itkComponentProfiler.h"
+#include "itkProcessMemoryUsage.h"
 
 #include <sstream>
 #include <fstream>
@@ -94,6 +97,28 @@ namespace elastix
  *    example: <tt>(WriteTransformParametersEachResolution "true")</tt>\n
  *    This parameter can not be specified for each resolution separately.
  *    Default value: "false".
+ * \parameter WriteCostBreakdown: Controls whether to profile the time spent in
+ *    the registration components (metric value and derivative, image sampler,
+ *    transform point and Jacobian, interpolator, derivative accumulation and
+ *    optimizer step). For each resolution a file
+ *    CostBreakdown.<ElastixLevel>.R<Resolution>.csv is written, with per iteration
+ *    the time in ms and the number of calls per component, and a summary is
+ *    printed to the log at the end of each resolution. Times of components that
+ *    run multi-threaded are summed over the threads. The profiler is shared by
+ *    the whole process, so this option is ignored, with a warning, for the jobs
+ *    of elastix::ELASTIX::RegisterImagesBatch().\n
+ *    example: <tt>(WriteCostBreakdown "true")</tt>\n
+ *    This parameter can not be specified for each resolution separately.
+ *    Default value: "false".
+ * \parameter ComputePyramidImagesPerResolution: Controls whether the fixed and
+ *    moving pyramid images of a resolution are released at the end of that
+ *    resolution. Together with the per-level computation of the generic pyramids
+ *    (see FixedGenericImagePyramid), only one level of each pyramid is in memory
+ *    at any time. The current and the peak memory usage are printed to the log
+ *    at the end of each resolution.\n
+ *    example: <tt>(ComputePyramidImagesPerResolution "true")</tt>\n
+ *    This parameter can not be specified for each resolution separately.
+ *    Default value: "false".
  * \parameter UseDirectionCosines: Controls whether to use or ignore the
  * direction cosines (world matrix, transform matrix) set in the images.
  * Voxel spacing and image origin are always taken into account, regardless
@@ -172,6 +197,17 @@ public:
   /** Type for representation of the transform coordinates. */
   typedef itk::CostFunction::ParametersValueType CoordRepType;   // double
 
+  /** Types for the point sets that may be given in memory, instead of by
+   * the -fp, -mp and -def files. These equal the point set types of the metrics.
+   */
+  typedef itk::PointSet< CoordRepType, FixedDimension,
+    itk::DefaultStaticMeshTraits< CoordRepType, FixedDimension, FixedDimension,
+    CoordRepType, CoordRepType, CoordRepType > >        FixedPointSetType;
+  typedef itk::PointSet< CoordRepType, MovingDimension,
+    itk::DefaultStaticMeshTraits< CoordRepType, MovingDimension, MovingDimension,
+    CoordRepType, CoordRepType, CoordRepType > >        MovingPointSetType;
+  typedef MovingPointSetType ResultPointSetType;
+
   /** BaseComponent. */
   typedef BaseComponent BaseComponentType;
 
@@ -288,6 +324,19 @@ public:
 
   virtual int SetResultDeformationField( DataObjectPointer result_deformationfield );
 
+  /** Get pointers to the point sets. They are obtained from the
+   * {Fixed,Moving}PointSetContainer and casted to the appropriate type.
+   * When no point set was given in memory, 0 is returned.
+   */
+  virtual FixedPointSetType * GetFixedPointSet( void ) const;
+
+  virtual MovingPointSetType * GetMovingPointSet( void ) const;
+
+  /** Get/Set the result point set, i.e. the transformed fixed point set. */
+  virtual ResultPointSetType * GetResultPointSet( void ) const;
+
+  virtual int SetResultPointSet( DataObjectPointer result_pointset );
+
   /** Main functions:
    * Run() for registration, and ApplyTransform() for just
    * applying a transform to an image.
@@ -383,6 +432,27 @@ protected:
 
   std::ofstream m_IterationInfoFile;
 
+  /** Open the CostBreakdownFile, where the time spent per component is written to. */
+  virtual void OpenCostBreakdownFile( void );
+
+  /** Write the time spent per component in this iteration to the CostBreakdownFile. */
+  virtual void WriteCostBreakdown( void );
+
+  typedef itk::ComponentProfiler ComponentProfilerType;
+
+  std::ofstream                             m_CostBreakdownFile;
+  ComponentProfilerType::TimeContainerType  m_CostBreakdownTimes;
+  ComponentProfilerType::CountContainerType m_CostBreakdownCounts;
+  ComponentProfilerType::TimeContainerType  m_CostBreakdownTotalTimes;
+
+  /** Release the fixed and moving pyramid images of a resolution level. */
+  virtual void ReleasePyramidImages( const unsigned int level );
+
+  /** Print the current and the peak memory usage of the process. */
+  virtual void PrintMemoryUsage( const std::string & when ) const;
+
+  typedef itk::ProcessMemoryUsage ProcessMemoryUsageType;
+
   /** Used by the callback functions, BeforeEachResolution() etc.).
    * This method calls a function in each component, in the following order:
    * \li Registration
@@ -210,6 +210,83 @@ ElastixTemplate< TFixedImage, TMovingImage >
   return 0;
 } // end SetResultDeformationField()
 
+
+/**
+ * ********************** GetFixedPointSet *************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+typename ElastixTemplate< TFixedImage, TMovingImage >::FixedPointSetType
+* ElastixTemplate< TFixedImage, TMovingImage >
+::GetFixedPointSet( void ) const
+{
+  if( this->GetNumberOfFixedPointSets() > 0 )
+  {
+    return dynamic_cast< FixedPointSetType * >(
+      this->GetFixedPointSetContainer()->ElementAt( 0 ).GetPointer() );
+  }
+
+  return 0;
+
+} // end GetFixedPointSet()
+
+
+/**
+ * ********************** GetMovingPointSet *************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+typename ElastixTemplate< TFixedImage, TMovingImage >::MovingPointSetType
+* ElastixTemplate< TFixedImage, TMovingImage >
+::GetMovingPointSet( void ) const
+{
+  if( this->GetNumberOfMovingPointSets() > 0 )
+  {
+    return dynamic_cast< MovingPointSetType * >(
+      this->GetMovingPointSetContainer()->ElementAt( 0 ).GetPointer() );
+  }
+
+  return 0;
+
+} // end GetMovingPointSet()
+
+
+/**
+ * ********************** GetResultPointSet *************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+typename ElastixTemplate< TFixedImage, TMovingImage >::ResultPointSetType
+* ElastixTemplate< TFixedImage, TMovingImage >
+::GetResultPointSet( void ) const
+{
+  if( this->GetNumberOfResultPointSets() > 0 )
+  {
+    return dynamic_cast< ResultPointSetType * >(
+      this->GetResultPointSetContainer()->ElementAt( 0 ).GetPointer() );
+  }
+
+  return 0;
+
+} // end GetResultPointSet()
+
+
+/**
+ * ********************** SetResultPointSet *************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+int
+ElastixTemplate< TFixedImage, TMovingImage >
+::SetResultPointSet( DataObjectPointer result_pointset )
+{
+  DataObjectContainerPointer container = DataObjectContainerType::New();
+  container->CreateElementAt( 0 ) = result_pointset;
+  this->SetResultPointSetContainer( container );
+  return 0;
+
+} // end SetResultPointSet()
+
 /**
  * **************************** Run *****************************
  */
@@ -234,21 +311,27 @@ ElastixTemplate< TFixedImage, TMovingImage >
    * NB: it is not yet clear what should happen when multiple registration
    * or optimizer components are used simultaneously. We won't use this
    * in the near future anyway, probably.
+   *
+   * When Run() is called again on the same components (see ElastixMain::Rerun()),
+   * the callbacks are already in place and should not be added twice.
    */
-  this->m_BeforeEachResolutionCommand = BeforeEachResolutionCommandType::New();
-  this->m_AfterEachResolutionCommand  = AfterEachResolutionCommandType::New();
-  this->m_AfterEachIterationCommand   = AfterEachIterationCommandType::New();
+  if( this->m_BeforeEachResolutionCommand.IsNull() )
+  {
+    this->m_BeforeEachResolutionCommand = BeforeEachResolutionCommandType::New();
+    this->m_AfterEachResolutionCommand  = AfterEachResolutionCommandType::New();
+    this->m_AfterEachIterationCommand   = AfterEachIterationCommandType::New();
 
-  this->m_BeforeEachResolutionCommand->SetCallbackFunction( this, &Self::BeforeEachResolution );
-  this->m_AfterEachResolutionCommand->SetCallbackFunction( this, &Self::AfterEachResolution );
-  this->m_AfterEachIterationCommand->SetCallbackFunction( this, &Self::AfterEachIteration );
+    this->m_BeforeEachResolutionCommand->SetCallbackFunction( this, &Self::BeforeEachResolution );
+    this->m_AfterEachResolutionCommand->SetCallbackFunction( this, &Self::AfterEachResolution );
+    this->m_AfterEachIterationCommand->SetCallbackFunction( this, &Self::AfterEachIteration );
 
-  this->GetElxRegistrationBase()->GetAsITKBaseType()->AddObserver(
-    itk::IterationEvent(), this->m_BeforeEachResolutionCommand );
-  this->GetElxOptimizerBase()->GetAsITKBaseType()->AddObserver(
-    itk::IterationEvent(), this->m_AfterEachIterationCommand );
-  this->GetElxOptimizerBase()->GetAsITKBaseType()->AddObserver(
-    itk::EndEvent(), this->m_AfterEachResolutionCommand );
+    this->GetElxRegistrationBase()->GetAsITKBaseType()->AddObserver(
+      itk::IterationEvent(), this->m_BeforeEachResolutionCommand );
+    this->GetElxOptimizerBase()->GetAsITKBaseType()->AddObserver(
+      itk::IterationEvent(), this->m_AfterEachIterationCommand );
+    this->GetElxOptimizerBase()->GetAsITKBaseType()->AddObserver(
+      itk::EndEvent(), this->m_AfterEachResolutionCommand );
+  }
 
   /** Start the timer for reading images. */
   this->m_Timer0.Start();
@@ -437,6 +520,13 @@ ElastixTemplate< TFixedImage, TMovingImage >
   }
   catch( itk::ExceptionObject & excp )
   {
+    /** The points given in memory are an output that the caller of the
+     * library asked for, so their errors are passed on.
+     */
+    if( this->GetNumberOfFixedPointSets() > 0 )
+    {
+      throw;
+    }
     xout[ "error" ] << excp << std::endl;
     xout[ "error" ] << "However, transformix continues anyway." << std::endl;
   }
@@ -662,6 +752,26 @@ ElastixTemplate< TFixedImage, TMovingImage >
     this->OpenIterationInfoFile();
   }
 
+  /** Open a file for the cost breakdown of the current resolution. */
+  bool writeCostBreakdown = false;
+  this->GetModifiableConfiguration()->ReadParameter( writeCostBreakdown,
+    "WriteCostBreakdown", 0, false );
+  if( writeCostBreakdown
+    && this->GetModifiableConfiguration()->GetCommandLineArgument( "-batchjob" ) == "true" )
+  {
+    /** The profiler sums the measurements of all threads in the process,
+     * so the jobs of a batch would be mixed up.
+     */
+    xl::xout[ "warning" ] << "WARNING: WriteCostBreakdown is not supported for "
+                          << "registrations that run concurrently in a batch.\n"
+                          << "  No cost breakdown is written." << std::endl;
+    writeCostBreakdown = false;
+  }
+  if( writeCostBreakdown )
+  {
+    this->OpenCostBreakdownFile();
+  }
+
   /** Call all the BeforeEachResolution() functions. */
   this->BeforeEachResolutionBase();
   CallInEachComponent( &BaseComponentType::BeforeEachResolutionBase );
@@ -682,6 +792,15 @@ ElastixTemplate< TFixedImage, TMovingImage >
   this->m_IterationTimer.Reset();
   this->m_IterationTimer.Start();
 
+  /** Start profiling the components, discarding what was measured
+   * during the initialization.
+   */
+  if( this->m_CostBreakdownFile.is_open() )
+  {
+    ComponentProfilerType::Reset();
+    ComponentProfilerType::SetEnabled( true );
+  }
+
 } // end BeforeEachResolution()
 
 
@@ -709,11 +828,50 @@ ElastixTemplate< TFixedImage, TMovingImage >
     << " s.\n";
   elxout << std::setprecision( this->GetDefaultOutputPrecision() );
 
+  /** Stop profiling and print the time spent per component in this resolution. */
+  if( this->m_CostBreakdownFile.is_open() )
+  {
+    ComponentProfilerType::SetEnabled( false );
+    ComponentProfilerType::Reset();
+    this->m_CostBreakdownFile.close();
+
+    const double resolutionTime = this->m_ResolutionTimer.GetMean() * 1000.0;
+    elxout << "Time spent per component in resolution " << level << ":\n";
+    elxout << std::setprecision( 3 );
+    for( unsigned int i = 0; i < ComponentProfilerType::NumberOfCategories; ++i )
+    {
+      const double time = this->m_CostBreakdownTotalTimes[ i ] * 1000.0;
+      elxout << "  " << ComponentProfilerType::GetCategoryName(
+        static_cast< ComponentProfilerType::CategoryType >( i ) )
+             << ": " << time << " ms";
+      if( resolutionTime > 0.0 )
+      {
+        elxout << " (" << 100.0 * time / resolutionTime << "%)";
+      }
+      elxout << "\n";
+    }
+    elxout << std::setprecision( this->GetDefaultOutputPrecision() );
+  }
+
   /** Call all the AfterEachResolution() functions. */
   this->AfterEachResolutionBase();
   CallInEachComponent( &BaseComponentType::AfterEachResolutionBase );
   CallInEachComponent( &BaseComponentType::AfterEachResolution );
 
+  /** Release the pyramid images of this resolution, if they are computed per resolution. */
+  bool computePyramidImagesPerResolution = false;
+  this->GetModifiableConfiguration()->ReadParameter( computePyramidImagesPerResolution,
+    "ComputePyramidImagesPerResolution", 0, false );
+  if( computePyramidImagesPerResolution )
+  {
+    this->ReleasePyramidImages( level );
+  }
+
+  /** Print the memory usage, to be able to estimate the memory needed. */
+  std::ostringstream when( "" );
+  when << "at the end of resolution " << level;
+  this->PrintMemoryUsage( when.str() );
+
   /** Create a TransformParameter-file for the current resolution. */
   bool writeTransformParameterEachResolution = false;
   this->GetModifiableConfiguration()->ReadParameter( writeTransformParameterEachResolution,
@@ -770,6 +928,12 @@ ElastixTemplate< TFixedImage, TMovingImage >
   this->m_IterationTimer.Stop();
   xout[ "iteration" ][ "Time[ms]" ] << this->m_IterationTimer.GetMean() * 1000.0;
 
+  /** Write the time spent per component in this iteration. */
+  if( this->m_CostBreakdownFile.is_open() )
+  {
+    this->WriteCostBreakdown();
+  }
+
   /** Write the iteration info of this iteration. */
   xout[ "iteration" ].WriteBufferedData();
 
@@ -871,6 +1035,9 @@ ElastixTemplate< TFixedImage, TMovingImage >
   CallInEachComponent( &BaseComponentType::AfterRegistrationBase );
   CallInEachComponent( &BaseComponentType::AfterRegistration );
 
+  /** Print the memory usage. */
+  this->PrintMemoryUsage( "after the registration" );
+
   /** Print the time spent on things after the registration. */
   this->m_Timer0.Stop();
   elxout << "Time spent on saving the results, applying the final transform etc.: "
@@ -1220,6 +1387,137 @@ ElastixTemplate< TFixedImage, TMovingImage >
 } // end OpenIterationInfoFile()
 
 
+/**
+ * ************** OpenCostBreakdownFile ****************
+ *
+ * Open a file called CostBreakdown.<ElastixLevel>.R<Resolution>.csv,
+ * which will contain the time spent per component in each iteration.
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+ElastixTemplate< TFixedImage, TMovingImage >
+::OpenCostBreakdownFile( void )
+{
+  if( this->m_CostBreakdownFile.is_open() )
+  {
+    this->m_CostBreakdownFile.close();
+  }
+
+  /** Create the CostBreakdown filename for this resolution. */
+  std::ostringstream makeFileName( "" );
+  makeFileName << this->m_Configuration->GetCommandLineArgument( "-out" )
+               << "CostBreakdown."
+               << this->m_Configuration->GetElastixLevel()
+               << ".R" << this->GetElxRegistrationBase()->GetAsITKBaseType()->GetCurrentLevel()
+               << ".csv";
+  std::string fileName = makeFileName.str();
+
+  /** Open the CostBreakdownFile. */
+  this->m_CostBreakdownFile.open( fileName.c_str() );
+  if( !( this->m_CostBreakdownFile.is_open() ) )
+  {
+    xout[ "error" ] << "ERROR: File \"" << fileName << "\" could not be opened!" << std::endl;
+    return;
+  }
+
+  /** Write the header: the time and the number of calls per component. */
+  this->m_CostBreakdownFile << "ItNr,Time[ms]";
+  for( unsigned int i = 0; i < ComponentProfilerType::NumberOfCategories; ++i )
+  {
+    const char * name = ComponentProfilerType::GetCategoryName(
+      static_cast< ComponentProfilerType::CategoryType >( i ) );
+    this->m_CostBreakdownFile << "," << name << "[ms]," << name << "[#]";
+  }
+  this->m_CostBreakdownFile << std::endl;
+
+  this->m_CostBreakdownTotalTimes.assign( ComponentProfilerType::NumberOfCategories, 0.0 );
+
+} // end OpenCostBreakdownFile()
+
+
+/**
+ * ************** WriteCostBreakdown ****************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+ElastixTemplate< TFixedImage, TMovingImage >
+::WriteCostBreakdown( void )
+{
+  /** Get, and reset, what was measured in this iteration. */
+  ComponentProfilerType::Collect( this->m_CostBreakdownTimes, this->m_CostBreakdownCounts );
+
+  this->m_CostBreakdownFile << this->m_IterationCounter
+                            << "," << this->m_IterationTimer.GetMean() * 1000.0;
+  for( unsigned int i = 0; i < ComponentProfilerType::NumberOfCategories; ++i )
+  {
+    this->m_CostBreakdownFile << "," << this->m_CostBreakdownTimes[ i ] * 1000.0
+                              << "," << this->m_CostBreakdownCounts[ i ];
+    this->m_CostBreakdownTotalTimes[ i ] += this->m_CostBreakdownTimes[ i ];
+  }
+  this->m_CostBreakdownFile << "\n";
+
+} // end WriteCostBreakdown()
+
+
+/**
+ * ************** ReleasePyramidImages ******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+ElastixTemplate< TFixedImage, TMovingImage >
+::ReleasePyramidImages( const unsigned int level )
+{
+  /** The next level is computed in the next BeforeEachResolution(), or was already
+   * computed at the start of the registration, depending on the pyramid type.
+   */
+  for( unsigned int i = 0; i < this->GetNumberOfFixedImagePyramids(); ++i )
+  {
+    typename FixedImagePyramidBaseType::ITKBaseType * pyramid
+      = this->GetElxFixedImagePyramidBase( i )->GetAsITKBaseType();
+    if( level < pyramid->GetNumberOfOutputs() )
+    {
+      pyramid->GetOutput( level )->ReleaseData();
+    }
+  }
+  for( unsigned int i = 0; i < this->GetNumberOfMovingImagePyramids(); ++i )
+  {
+    typename MovingImagePyramidBaseType::ITKBaseType * pyramid
+      = this->GetElxMovingImagePyramidBase( i )->GetAsITKBaseType();
+    if( level < pyramid->GetNumberOfOutputs() )
+    {
+      pyramid->GetOutput( level )->ReleaseData();
+    }
+  }
+
+} // end ReleasePyramidImages()
+
+
+/**
+ * ************** PrintMemoryUsage ******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+ElastixTemplate< TFixedImage, TMovingImage >
+::PrintMemoryUsage( const std::string & when ) const
+{
+  const itk::SizeValueType currentMemory = ProcessMemoryUsageType::GetCurrentMemoryUsage();
+  const itk::SizeValueType peakMemory    = ProcessMemoryUsageType::GetPeakMemoryUsage();
+  if( peakMemory == 0 )
+  {
+    return;
+  }
+
+  elxout << "Memory usage " << when << ": "
+         << currentMemory / 1024 << " MB (peak: "
+         << peakMemory / 1024 << " MB).\n";
+
+} // end PrintMemoryUsage()
+
+
 /**
  * ************** GetOriginalFixedImageDirection *********************
  * Determine the original fixed image direction (it might have been
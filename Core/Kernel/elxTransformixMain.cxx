@@ -132,6 +132,13 @@ TransformixMain::Run( void )
   this->GetElastixBase()->SetMovingImageContainer(
     this->GetModifiableMovingImageContainer() );
 
+  /** Set the input points. If not set by the user, transformix will
+   * read them from the -def file, if given.
+   */
+  this->GetElastixBase()->SetFixedPointSetContainer(
+    this->GetModifiableFixedPointSetContainer() );
+  this->GetElastixBase()->SetResultPointSetContainer( 0 );
+
   /** Set the initial transform, if it happens to be there
   * \todo: Does this make sense for transformix?
   */
@@ -150,6 +157,12 @@ TransformixMain::Run( void )
                         << std::endl << excp
                         << "-----------------------------------------" << std::endl;
     errorCode = 1;
+
+    /** A library user that passed points in memory gets the exception. */
+    if( this->GetModifiableFixedPointSetContainer() != 0 )
+    {
+      throw;
+    }
   }
 
   /** Save the image container. */
@@ -159,6 +172,8 @@ TransformixMain::Run( void )
     this->GetElastixBase()->GetResultImageContainer() );
   this->SetResultDeformationFieldContainer(
     this->GetElastixBase()->GetResultDeformationFieldContainer() );
+  this->SetResultPointSetContainer(
+    this->GetElastixBase()->GetResultPointSetContainer() );
 
   return errorCode;
 
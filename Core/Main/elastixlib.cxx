@@ -27,6 +27,9 @@
 #endif
 
 #include "elxElastixMain.h"
+#include "itkPersistentThreadPool.h"
+#include "itkRandomVariateGeneratorInstance.h"
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -42,6 +45,44 @@
 namespace elastix
 {
 
+namespace
+{
+
+/** Adapters for PersistentThreadPool::RegisterThreadContext(), which let the
+ * workers that execute the calls of a batch job use the xout and the random
+ * number generator of that job.
+ */
+void *
+GetThreadXout( void )
+{
+  return xl::get_thread_xout();
+}
+
+
+void
+SetThreadXout( void * arg )
+{
+  xl::set_thread_xout( static_cast< xl::xoutbase_type * >( arg ) );
+}
+
+
+void *
+GetThreadRandomGenerator( void )
+{
+  return itk::RandomVariateGeneratorInstance::GetThreadInstance();
+}
+
+
+void
+SetThreadRandomGenerator( void * arg )
+{
+  itk::RandomVariateGeneratorInstance::SetThreadInstance(
+    static_cast< itk::RandomVariateGeneratorInstance::GeneratorType * >( arg ) );
+}
+
+
+} // end namespace
+
 /**
  * ******************* Constructor ***********************
  */
@@ -140,43 +181,21 @@ ELASTIX::RegisterImages(
   ObjectPointer transform)
 {
   /** Some typedef's. */
-  typedef elx::ElastixMain                            ElastixMainType;
-  typedef ElastixMainType::Pointer                    ElastixMainPointer;
-  typedef std::vector< ElastixMainPointer >           ElastixMainVectorType;
-  typedef ElastixMainType::ObjectPointer              ObjectPointer;
-  typedef ElastixMainType::DataObjectContainerType    DataObjectContainerType;
-  typedef ElastixMainType::DataObjectContainerPointer DataObjectContainerPointer;
-  typedef ElastixMainType::FlatDirectionCosinesType   FlatDirectionCosinesType;
-
-  typedef ElastixMainType::ArgumentMapType ArgumentMapType;
+  typedef elx::ElastixMain                 ElastixMainType;
   typedef ArgumentMapType::value_type      ArgumentMapEntryType;
 
   typedef std::pair< std::string, std::string > ArgPairType;
   typedef std::queue< ArgPairType >             ParameterFileListType;
   typedef ParameterFileListType::value_type     ParameterFileListEntryType;
 
-  // Clear output transform parameters
-  this->m_TransformParametersList.clear();
-
   /** Some declarations and initialisations. */
-  ElastixMainVectorType elastices;
-
-  //ObjectPointer              transform = 0;
-  DataObjectContainerPointer fixedImageContainer  = 0;
-  DataObjectContainerPointer movingImageContainer = 0;
-  DataObjectContainerPointer fixedMaskContainer   = 0;
-  DataObjectContainerPointer movingMaskContainer  = 0;
-  DataObjectContainerPointer resultImageContainer = 0;
-  FlatDirectionCosinesType   fixedImageOriginalDirection;
-  int                        returndummy = 0;
-  ArgumentMapType            argMap;
-  ParameterFileListType      parameterFileList;
-  std::string                outFolder   = "";
-  std::string                logFileName = "";
-  unsigned short             i;
-  std::string                key;
-  std::string                value;
-  unsigned long              nrOfParameterFiles = parameterMaps.size();
+  int                   returndummy = 0;
+  ArgumentMapType       argMap;
+  ParameterFileListType parameterFileList;
+  std::string           outFolder   = "";
+  std::string           logFileName = "";
+  std::string           key;
+  std::string           value;
 
   /** Setup the argumentMap for output path. */
   if( !outputPath.empty() )
@@ -258,6 +277,69 @@ ELASTIX::RegisterImages(
   totaltimer.Start();
   elxout << "elastix is started at " << GetCurrentDateAndTime() << ".\n" << std::endl;
 
+  /** Do the (possibly multiple) registration(s). */
+  returndummy = this->RunRegistrations( fixedImage, movingImage, parameterMaps, argMap,
+    fixedMask, movingMask, transform );
+  if( returndummy != 0 )
+  {
+    return returndummy;
+  }
+
+  elxout << "-------------------------------------------------------------------------"
+         << "\n" << std::endl;
+
+  /** Stop totaltimer and print it. */
+  totaltimer.Stop();
+  elxout << "Total time elapsed: "
+         << ConvertSecondsToDHMS( totaltimer.GetMean(), 1 ) << ".\n" << std::endl;
+
+  /** Close the modules. */
+  ElastixMainType::UnloadComponents();
+
+  /** Exit and return the error code. */
+  return 0;
+
+} // end RegisterImages()
+
+
+/**
+ * ******************* RunRegistrations ***********************
+ */
+
+int
+ELASTIX::RunRegistrations(
+  ImagePointer fixedImage,
+  ImagePointer movingImage,
+  std::vector< ParameterMapType > & parameterMaps,
+  ArgumentMapType & argMap,
+  ImagePointer fixedMask,
+  ImagePointer movingMask,
+  ObjectPointer transform )
+{
+  /** Some typedef's. */
+  typedef elx::ElastixMain                            ElastixMainType;
+  typedef ElastixMainType::Pointer                    ElastixMainPointer;
+  typedef std::vector< ElastixMainPointer >           ElastixMainVectorType;
+  typedef ElastixMainType::DataObjectContainerType    DataObjectContainerType;
+  typedef ElastixMainType::DataObjectContainerPointer DataObjectContainerPointer;
+  typedef ElastixMainType::FlatDirectionCosinesType   FlatDirectionCosinesType;
+
+  // Clear output transform parameters
+  this->m_TransformParametersList.clear();
+
+  /** Some declarations and initialisations. */
+  ElastixMainVectorType elastices;
+
+  DataObjectContainerPointer fixedImageContainer  = 0;
+  DataObjectContainerPointer movingImageContainer = 0;
+  DataObjectContainerPointer fixedMaskContainer   = 0;
+  DataObjectContainerPointer movingMaskContainer  = 0;
+  DataObjectContainerPointer resultImageContainer = 0;
+  FlatDirectionCosinesType   fixedImageOriginalDirection;
+  int                        returndummy = 0;
+  unsigned short             i;
+  unsigned long              nrOfParameterFiles = parameterMaps.size();
+
   /************************************************************************
    *                                              *
    *  Generate containers with input images       *
@@ -369,14 +451,6 @@ ELASTIX::RegisterImages(
 
   } // end loop over registrations
 
-  elxout << "-------------------------------------------------------------------------"
-         << "\n" << std::endl;
-
-  /** Stop totaltimer and print it. */
-  totaltimer.Stop();
-  elxout << "Total time elapsed: "
-         << ConvertSecondsToDHMS( totaltimer.GetMean(), 1 ) << ".\n" << std::endl;
-
   /************************************************************************
    *                                *
    *  Cleanup everything            *
@@ -405,13 +479,193 @@ ELASTIX::RegisterImages(
   movingMaskContainer  = 0;
   resultImageContainer = 0;
 
+  /** Return a value. */
+  return 0;
+
+} // end RunRegistrations()
+
+
+/**
+ * ******************* RegisterImagesBatch ***********************
+ */
+
+int
+ELASTIX::RegisterImagesBatch(
+  BatchJobContainerType & jobs,
+  unsigned int numberOfConcurrentJobs,
+  bool performLogging )
+{
+  if( jobs.empty() )
+  {
+    return 0;
+  }
+
+  /** Split the available threads between the jobs, and the threads within each job. */
+  const unsigned int numberOfThreads = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+  if( numberOfConcurrentJobs == 0 )
+  {
+    numberOfConcurrentJobs = numberOfThreads;
+  }
+  numberOfConcurrentJobs = std::min( numberOfConcurrentJobs, static_cast< unsigned int >( jobs.size() ) );
+  const unsigned int threadsPerJob = std::max( numberOfThreads / numberOfConcurrentJobs, 1u );
+
+  /** The jobs do not change the global number of threads of the MultiThreader,
+   * since they would write it concurrently. Instead, the global default is
+   * limited once, here, for the ITK filters that the jobs create, and the
+   * metric and image sampler of each job get threadsPerJob through the
+   * -threads argument. The previous default is restored afterwards.
+   */
+  const itk::ThreadIdType globalDefaultNumberOfThreads = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+  itk::MultiThreader::SetGlobalDefaultNumberOfThreads( threadsPerJob );
+
+  /** The calls that a job executes on the persistent thread pool log to the
+   * xout of the job, and draw from its random number generator. The worker
+   * threads of ITK filters do not get this context; elastix code that runs
+   * in them must neither log nor create a random number generator.
+   */
+  itk::PersistentThreadPool::RegisterThreadContext( GetThreadXout, SetThreadXout );
+  itk::PersistentThreadPool::RegisterThreadContext( GetThreadRandomGenerator, SetThreadRandomGenerator );
+
+  /** Run the jobs. Each thread takes the next job that was not started yet,
+   * which balances the load when the jobs take different times.
+   */
+  BatchThreaderParameterType userData;
+  userData.st_Jobs           = &jobs;
+  userData.st_NextJob        = 0;
+  userData.st_ThreadsPerJob  = threadsPerJob;
+  userData.st_PerformLogging = performLogging;
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads( numberOfConcurrentJobs );
+  threader->SetSingleMethod( RegisterImagesBatchThreaderCallback, &userData );
+  threader->SingleMethodExecute();
+
+  itk::MultiThreader::SetGlobalDefaultNumberOfThreads( globalDefaultNumberOfThreads );
+
   /** Close the modules. */
-  ElastixMainType::UnloadComponents();
+  elx::ElastixMain::UnloadComponents();
 
-  /** Exit and return the error code. */
+  /** Return 0 only if all jobs succeeded. */
+  for( std::size_t j = 0; j < jobs.size(); ++j )
+  {
+    if( jobs[ j ].ErrorCode != 0 )
+    {
+      return 1;
+    }
+  }
   return 0;
 
-} // end RegisterImages()
+} // end RegisterImagesBatch()
+
+
+/**
+ * ******************* RegisterImagesBatchThreaderCallback ***********************
+ */
+
+ITK_THREAD_RETURN_TYPE
+ELASTIX::RegisterImagesBatchThreaderCallback( void * arg )
+{
+  typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+  ThreadInfoType * infoStruct = static_cast< ThreadInfoType * >( arg );
+
+  BatchThreaderParameterType * temp
+    = static_cast< BatchThreaderParameterType * >( infoStruct->UserData );
+
+  while( true )
+  {
+    /** Take the next job. */
+    temp->st_Mutex.Lock();
+    const std::size_t job = temp->st_NextJob++;
+    temp->st_Mutex.Unlock();
+
+    if( job >= temp->st_Jobs->size() )
+    {
+      break;
+    }
+
+    RunBatchJob( ( *temp->st_Jobs )[ job ], temp->st_ThreadsPerJob, temp->st_PerformLogging );
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end RegisterImagesBatchThreaderCallback()
+
+
+/**
+ * ******************* RunBatchJob ***********************
+ */
+
+void
+ELASTIX::RunBatchJob( BatchJob & job, const unsigned int numberOfThreads, const bool performLogging )
+{
+  typedef ArgumentMapType::value_type                    ArgumentMapEntryType;
+  typedef itk::RandomVariateGeneratorInstance::GeneratorType RandomGeneratorType;
+
+  job.ErrorCode = 0;
+
+  /** Setup the argument map. */
+  std::string outFolder = job.OutputPath;
+  if( outFolder.empty() )
+  {
+    //there must be an "-out", this is checked later in code!!
+    outFolder = "output_path_not_set";
+  }
+  else if( outFolder.find_last_of( "/" ) != outFolder.size() - 1 )
+  {
+    outFolder.append( "/" );
+  }
+
+  std::stringstream threads;
+  threads << numberOfThreads;
+
+  ArgumentMapType argMap;
+  argMap.insert( ArgumentMapEntryType( "-out", outFolder ) );
+  argMap.insert( ArgumentMapEntryType( "-argv0", "elastix" ) );
+  argMap.insert( ArgumentMapEntryType( "-threads", threads.str() ) );
+  argMap.insert( ArgumentMapEntryType( "-batchjob", "true" ) );
+
+  /** Check if the output directory exists. */
+  const bool logging = performLogging && !job.OutputPath.empty();
+  if( logging && !itksys::SystemTools::FileIsDirectory( outFolder.c_str() ) )
+  {
+    job.ErrorCode = -2;
+    return;
+  }
+
+  /** Give this thread its own xout and random number generator, so that the
+   * job does not share state with the jobs in other threads.
+   */
+  elx::ThreadXoutType threadXout;
+  const std::string   logFileName = outFolder + "elastix.log";
+  if( elx::xoutSetupThread( logFileName.c_str(), logging, false, threadXout ) )
+  {
+    xl::set_thread_xout( 0 );
+    job.ErrorCode = 1;
+    return;
+  }
+
+  RandomGeneratorType::Pointer randomGenerator = RandomGeneratorType::New();
+  itk::RandomVariateGeneratorInstance::SetThreadInstance( randomGenerator );
+
+  /** Run the registration(s) of this job. */
+  try
+  {
+    ELASTIX elastix;
+    job.ErrorCode = elastix.RunRegistrations( job.FixedImage, job.MovingImage,
+      job.ParameterMaps, argMap, job.FixedMask, job.MovingMask, 0 );
+
+    job.ResultImage               = elastix.GetResultImage();
+    job.TransformParameterMapList = elastix.GetTransformParameterMapList();
+  }
+  catch( ... )
+  {
+    job.ErrorCode = 1;
+  }
+
+  itk::RandomVariateGeneratorInstance::SetThreadInstance( 0 );
+  xl::set_thread_xout( 0 );
+
+} // end RunBatchJob()
 
 
 /** ConvertSecondsToDHMS
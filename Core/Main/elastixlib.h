@@ -25,6 +25,8 @@
 #include "itkParameterFileParser.h"
 #include "elxMacro.h"
 #include "elxElastixMain.h"
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
 
 
 /********************************************************************************
@@ -52,6 +54,32 @@ public:
   //typedefs for ObjectPointer
   typedef elastix::ElastixMain::ObjectPointer              ObjectPointer;
 
+  //typedefs for the command line arguments
+  typedef elastix::ElastixMain::ArgumentMapType ArgumentMapType;
+
+  /** A registration job for RegisterImagesBatch(). The inputs are the same as
+   * for RegisterImages(); the outputs are filled in after the job has run.
+   */
+  struct BatchJob
+  {
+    /** Inputs. */
+    ImagePointer         FixedImage;
+    ImagePointer         MovingImage;
+    ImagePointer         FixedMask;
+    ImagePointer         MovingMask;
+    ParameterMapListType ParameterMaps;
+    std::string          OutputPath;
+
+    /** Outputs. */
+    ImagePointer         ResultImage;
+    ParameterMapListType TransformParameterMapList;
+    int                  ErrorCode;
+
+    BatchJob() : ErrorCode( 0 ) {}
+  };
+
+  typedef std::vector< BatchJob > BatchJobContainerType;
+
   /**
    *  Constructor and destructor
    */
@@ -102,6 +130,33 @@ public:
     ImagePointer movingMask = 0,
     ObjectPointer transform = 0);
 
+  /**
+   *  Run a batch of independent registrations concurrently, e.g. the
+   *  registration of many subjects to one atlas.
+   *  Params:
+   *    jobs  the registrations; see BatchJob. The outputs of each job are
+   *      stored in the job itself.
+   *    numberOfConcurrentJobs  the number of registrations that run at the
+   *      same time. The default (0) runs one job per available thread. The
+   *      available threads are divided over the concurrent jobs, i.e. each
+   *      job is run with the -threads option set to
+   *      max( 1, GlobalDefaultNumberOfThreads / numberOfConcurrentJobs ).
+   *    performLogging  write an elastix.log in the OutputPath of each job.
+   *  The global default number of threads of the MultiThreader is set to
+   *  this share while the jobs run; the jobs themselves never change it.
+   *  Every job has its own log and its own random number generator, also in
+   *  the calls that it executes on the PersistentThreadPool, so the
+   *  result of a job does not depend on the other jobs. Output to the command
+   *  window is not possible in batch mode. The ErrorCode of each job has the
+   *  same meaning as the return value of RegisterImages(). The
+   *  WriteCostBreakdown parameter is ignored in batch mode, since the
+   *  profiler cannot tell the jobs apart.
+   *  return value: 0 if all jobs succeeded, 1 otherwise.
+   */
+  int RegisterImagesBatch( BatchJobContainerType & jobs,
+    unsigned int numberOfConcurrentJobs = 0,
+    bool performLogging = true );
+
   /** Getter for result image. */
   ImagePointer GetResultImage( void );
 
@@ -117,6 +172,32 @@ public:
 
 private:
 
+  /** Run the registrations for the given arguments, once xout has been set up. */
+  int RunRegistrations( ImagePointer fixedImage,
+    ImagePointer movingImage,
+    std::vector< ParameterMapType > & parameterMaps,
+    ArgumentMapType & argMap,
+    ImagePointer fixedMask,
+    ImagePointer movingMask,
+    ObjectPointer transform );
+
+  /** The shared data of the threads of RegisterImagesBatch(). */
+  struct BatchThreaderParameterType
+  {
+    BatchJobContainerType *  st_Jobs;
+    std::size_t              st_NextJob;
+    itk::SimpleFastMutexLock st_Mutex;
+    unsigned int             st_ThreadsPerJob;
+    bool                     st_PerformLogging;
+  };
+
+  /** Callback for RegisterImagesBatch(): runs jobs until none is left. */
+  static ITK_THREAD_RETURN_TYPE RegisterImagesBatchThreaderCallback( void * arg );
+
+  /** Run a single job of RegisterImagesBatch() in the calling thread. */
+  static void RunBatchJob( BatchJob & job, const unsigned int numberOfThreads,
+    const bool performLogging );
+
   /* the result images */
   ImagePointer m_ResultImage;
 
@@ -19,6 +19,7 @@
 #define elxElastixFilter_h
 
 #include "itkImageSource.h"
+#include "itkPointSet.h"
 
 #include "elxElastixMain.h"
 #include "elxParameterObject.h"
@@ -87,6 +88,19 @@ public:
   typedef typename MovingMaskType::Pointer                  MovingMaskPointer;
   typedef typename MovingMaskType::Pointer                  MovingMaskConstPointer;
 
+  /** The types of the fixed and moving point sets, in world coordinates.
+   * The points container of a point set stores the points contiguously,
+   * so it can be filled as a buffer of coordinates.
+   */
+  typedef itk::PointSet< double, FixedImageDimension,
+    itk::DefaultStaticMeshTraits< double, FixedImageDimension, FixedImageDimension,
+    double, double, double > >                              FixedPointSetType;
+  typedef itk::PointSet< double, MovingImageDimension,
+    itk::DefaultStaticMeshTraits< double, MovingImageDimension, MovingImageDimension,
+    double, double, double > >                              MovingPointSetType;
+  typedef typename FixedPointSetType::ConstPointer          FixedPointSetConstPointer;
+  typedef typename MovingPointSetType::ConstPointer         MovingPointSetConstPointer;
+
   /** Set/Add/Get/NumberOf fixed images. */
   virtual void SetFixedImage( TFixedImage * fixedImage );
   virtual void AddFixedImage( TFixedImage * fixedImage );
@@ -141,6 +155,19 @@ public:
   itkGetMacro( MovingPointSetFileName, std::string );
   void RemoveMovingPointSetFileName( void ) { this->SetMovingPointSetFileName( "" ); }
 
+  /** Set/Get/Remove the fixed and moving point sets in memory. These are used
+   * by the CorrespondingPointsEuclideanDistanceMetric instead of the point set
+   * files, so no files are written or read. Can not be combined with
+   * Set{Fixed,Moving}PointSetFileName().
+   */
+  virtual void SetFixedPointSet( FixedPointSetType * fixedPointSet );
+  FixedPointSetConstPointer GetFixedPointSet( void ) const;
+  virtual void RemoveFixedPointSet( void );
+
+  virtual void SetMovingPointSet( MovingPointSetType * movingPointSet );
+  MovingPointSetConstPointer GetMovingPointSet( void ) const;
+  virtual void RemoveMovingPointSet( void );
+
   /** Set/Get/Remove output directory. */
   itkSetMacro( OutputDirectory, std::string );
   itkGetMacro( OutputDirectory, std::string );
@@ -165,6 +192,21 @@ public:
   itkSetMacro( NumberOfThreads, int );
   itkGetMacro( NumberOfThreads, int );
 
+  /** Keep the elastix components alive between calls to Update(). If the
+   * parameter maps and the other settings did not change since the previous
+   * Update(), the registration of the new fixed and moving images is done by
+   * the components that were created and configured before, which avoids the
+   * setup cost for every image pair. The component instances keep their
+   * buffers and threaders, which are reused when the images have the same size.
+   * Default: off. Switching it off releases the components.
+   */
+  itkSetMacro( ReuseComponents, bool );
+  itkGetConstReferenceMacro( ReuseComponents, bool );
+  itkBooleanMacro( ReuseComponents );
+
+  /** Release the components that are kept alive for reuse. */
+  void ReleaseComponents( void );
+
 protected:
 
   ElastixFilter( void );
@@ -205,6 +247,14 @@ private:
 
   unsigned int m_InputUID;
 
+  /** The ElastixMain instances (one per parameter map) that are kept alive
+   * for reuse, together with the settings they were created with.
+   */
+  bool                   m_ReuseComponents;
+  ElastixMainVectorType  m_ElastixMainVector;
+  ParameterMapVectorType m_ElastixMainParameterMapVector;
+  ArgumentMapType        m_ElastixMainArgumentMap;
+
 };
 
 } // namespace elx
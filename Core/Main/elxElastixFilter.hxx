@@ -48,6 +48,8 @@ ElastixFilter< TFixedImage, TMovingImage >
 
   this->m_NumberOfThreads = 0;
 
+  this->m_ReuseComponents = false;
+
   ParameterObjectPointer defaultParameterObject = ParameterObject::New();
   defaultParameterObject->AddParameterMap( ParameterObject::GetDefaultParameterMap( "translation" ) );
   defaultParameterObject->AddParameterMap( ParameterObject::GetDefaultParameterMap( "affine" ) );
@@ -78,6 +80,8 @@ ElastixFilter< TFixedImage, TMovingImage >
   DataObjectContainerPointer movingImageContainer = DataObjectContainerType::New();
   DataObjectContainerPointer fixedMaskContainer   = 0;
   DataObjectContainerPointer movingMaskContainer  = 0;
+  DataObjectContainerPointer fixedPointSetContainer  = 0;
+  DataObjectContainerPointer movingPointSetContainer = 0;
   DataObjectContainerPointer resultImageContainer = 0;
   ElastixMainObjectPointer   transform            = 0;
   ParameterMapVectorType     transformParameterMapVector;
@@ -99,6 +103,20 @@ ElastixFilter< TFixedImage, TMovingImage >
       continue;
     }
 
+    if( this->IsInputOfType( "FixedPointSet", inputNames[ i ] ) )
+    {
+      fixedPointSetContainer = DataObjectContainerType::New();
+      fixedPointSetContainer->CreateElementAt( 0 ) = this->GetInput( inputNames[ i ] );
+      continue;
+    }
+
+    if( this->IsInputOfType( "MovingPointSet", inputNames[ i ] ) )
+    {
+      movingPointSetContainer = DataObjectContainerType::New();
+      movingPointSetContainer->CreateElementAt( 0 ) = this->GetInput( inputNames[ i ] );
+      continue;
+    }
+
     if( this->IsInputOfType( "FixedMask", inputNames[ i ] ) )
     {
       if( fixedMaskContainer.IsNull() )
@@ -121,6 +139,12 @@ ElastixFilter< TFixedImage, TMovingImage >
     }
   }
 
+  if( ( fixedPointSetContainer.IsNotNull() && !this->m_FixedPointSetFileName.empty() )
+    || ( movingPointSetContainer.IsNotNull() && !this->m_MovingPointSetFileName.empty() ) )
+  {
+    itkExceptionMacro( "A point set can be given either in memory or as file name, not both." );
+  }
+
   // Set ParameterMap
   ParameterObjectPointer parameterObject    = itkDynamicCastInDebugMode< ParameterObject * >( this->GetInput( "ParameterObject" ) );
   ParameterMapVectorType parameterMapVector = parameterObject->GetParameterMap();
@@ -204,7 +228,7 @@ ElastixFilter< TFixedImage, TMovingImage >
     itkExceptionMacro( "Error while setting up xout" );
   }
 
-  // Run the (possibly multiple) registration(s)
+  // Complete the parameter maps
   for( unsigned int i = 0; i < parameterMapVector.size(); ++i )
   {
     // Set image dimension from input images (overrides user settings)
@@ -220,9 +244,24 @@ ElastixFilter< TFixedImage, TMovingImage >
     {
       parameterMapVector[ i ][ "InitialTransformParametersFileName" ] = ParameterValueVectorType( 1, "NoInitialTransform" );
     }
+  }
+
+  // The components of a previous run can only be reused when they were configured identically
+  const bool reuseComponents = this->m_ReuseComponents
+    && this->m_ElastixMainVector.size() == parameterMapVector.size()
+    && this->m_ElastixMainParameterMapVector == parameterMapVector
+    && this->m_ElastixMainArgumentMap == argumentMap;
+
+  if( !reuseComponents )
+  {
+    this->ReleaseComponents();
+  }
 
-    // Create new instance of ElastixMain
-    ElastixMainPointer elastix = ElastixMainType::New();
+  // Run the (possibly multiple) registration(s)
+  for( unsigned int i = 0; i < parameterMapVector.size(); ++i )
+  {
+    // Create new instance of ElastixMain, or take the one of the previous run
+    ElastixMainPointer elastix = reuseComponents ? this->m_ElastixMainVector[ i ] : ElastixMainType::New();
 
     // Set elastix levels
     elastix->SetElastixLevel( i );
@@ -234,6 +273,8 @@ ElastixFilter< TFixedImage, TMovingImage >
     elastix->SetMovingImageContainer( movingImageContainer );
     elastix->SetFixedMaskContainer( fixedMaskContainer );
     elastix->SetMovingMaskContainer( movingMaskContainer );
+    elastix->SetFixedPointSetContainer( fixedPointSetContainer );
+    elastix->SetMovingPointSetContainer( movingPointSetContainer );
     elastix->SetResultImageContainer( resultImageContainer );
     elastix->SetOriginalFixedImageDirectionFlat( fixedImageOriginalDirection );
 
@@ -241,18 +282,33 @@ ElastixFilter< TFixedImage, TMovingImage >
     unsigned int isError = 0;
     try
     {
-      isError = elastix->Run( argumentMap, parameterMapVector[ i ] );
+      if( reuseComponents )
+      {
+        isError = elastix->Rerun();
+      }
+      else
+      {
+        isError = elastix->Run( argumentMap, parameterMapVector[ i ] );
+      }
     }
     catch( itk::ExceptionObject & e )
     {
+      this->ReleaseComponents();
       itkExceptionMacro( << "Errors occurred during registration: " << e.what() );
     }
 
     if( isError != 0 )
     {
+      this->ReleaseComponents();
       itkExceptionMacro( << "Internal elastix error: See elastix log (use LogToConsoleOn() or LogToFileOn())." );
     }
 
+    // Keep the components alive for the next run
+    if( this->m_ReuseComponents && !reuseComponents )
+    {
+      this->m_ElastixMainVector.push_back( elastix );
+    }
+
     // Get stuff in order to put it in the next registration
     transform                   = elastix->GetFinalTransform();
     fixedImageContainer         = elastix->GetFixedImageContainer();
@@ -274,6 +330,12 @@ ElastixFilter< TFixedImage, TMovingImage >
       = parameterMapVector[ i ][ "DefaultPixelValue" ];
   } // End loop over registrations
 
+  if( this->m_ReuseComponents )
+  {
+    this->m_ElastixMainParameterMapVector = parameterMapVector;
+    this->m_ElastixMainArgumentMap        = argumentMap;
+  }
+
   // Save result image
   if( resultImageContainer.IsNotNull() && resultImageContainer->Size() > 0 )
   {
@@ -291,6 +353,21 @@ ElastixFilter< TFixedImage, TMovingImage >
 }
 
 
+/**
+ * ********************* ReleaseComponents *********************
+ */
+
+template< typename TFixedImage, typename TMovingImage >
+void
+ElastixFilter< TFixedImage, TMovingImage >
+::ReleaseComponents( void )
+{
+  this->m_ElastixMainVector.clear();
+  this->m_ElastixMainParameterMapVector.clear();
+  this->m_ElastixMainArgumentMap.clear();
+}
+
+
 /**
  * ********************* SetParameterObject *********************
  */
@@ -745,6 +822,84 @@ ElastixFilter< TFixedImage, TMovingImage >
 }
 
 
+/**
+ * ********************* SetFixedPointSet *********************
+ */
+
+template< typename TFixedImage, typename TMovingImage >
+void
+ElastixFilter< TFixedImage, TMovingImage >
+::SetFixedPointSet( FixedPointSetType * fixedPointSet )
+{
+  this->SetInput( "FixedPointSet", fixedPointSet );
+} // end SetFixedPointSet()
+
+
+/**
+ * ********************* GetFixedPointSet *********************
+ */
+
+template< typename TFixedImage, typename TMovingImage >
+typename ElastixFilter< TFixedImage, TMovingImage >::FixedPointSetConstPointer
+ElastixFilter< TFixedImage, TMovingImage >
+::GetFixedPointSet( void ) const
+{
+  return itkDynamicCastInDebugMode< const FixedPointSetType * >( this->GetInput( "FixedPointSet" ) );
+} // end GetFixedPointSet()
+
+
+/**
+ * ********************* RemoveFixedPointSet *********************
+ */
+
+template< typename TFixedImage, typename TMovingImage >
+void
+ElastixFilter< TFixedImage, TMovingImage >
+::RemoveFixedPointSet( void )
+{
+  this->RemoveInputsOfType( "FixedPointSet" );
+} // end RemoveFixedPointSet()
+
+
+/**
+ * ********************* SetMovingPointSet *********************
+ */
+
+template< typename TFixedImage, typename TMovingImage >
+void
+ElastixFilter< TFixedImage, TMovingImage >
+::SetMovingPointSet( MovingPointSetType * movingPointSet )
+{
+  this->SetInput( "MovingPointSet", movingPointSet );
+} // end SetMovingPointSet()
+
+
+/**
+ * ********************* GetMovingPointSet *********************
+ */
+
+template< typename TFixedImage, typename TMovingImage >
+typename ElastixFilter< TFixedImage, TMovingImage >::MovingPointSetConstPointer
+ElastixFilter< TFixedImage, TMovingImage >
+::GetMovingPointSet( void ) const
+{
+  return itkDynamicCastInDebugMode< const MovingPointSetType * >( this->GetInput( "MovingPointSet" ) );
+} // end GetMovingPointSet()
+
+
+/**
+ * ********************* RemoveMovingPointSet *********************
+ */
+
+template< typename TFixedImage, typename TMovingImage >
+void
+ElastixFilter< TFixedImage, TMovingImage >
+::RemoveMovingPointSet( void )
+{
+  this->RemoveInputsOfType( "MovingPointSet" );
+} // end RemoveMovingPointSet()
+
+
 /**
  * ********************* SetLogFileName ****************************
  */
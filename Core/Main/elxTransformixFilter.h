@@ -19,6 +19,7 @@
 #define elxTransformixFilter_h
 
 #include "itkImageSource.h"
+#include "itkPointSet.h"
 
 #include "elxTransformixMain.h"
 #include "elxParameterObject.h"
@@ -76,6 +77,21 @@ public:
 
   itkStaticConstMacro( MovingImageDimension, unsigned int, TMovingImage::ImageDimension );
 
+  /** The type of the input and output point sets. The points container of a
+   * point set stores the points contiguously, so it can be used as a buffer
+   * of MovingImageDimension coordinates per point:
+   * \code
+   *   PointSetType::PointsContainerPointer points = PointSetType::PointsContainer::New();
+   *   points->Reserve( numberOfPoints );
+   *   double * coordinates = points->CastToSTLContainer()[ 0 ].GetDataPointer();
+   * \endcode
+   */
+  typedef itk::PointSet< double, MovingImageDimension,
+    itk::DefaultStaticMeshTraits< double, MovingImageDimension, MovingImageDimension,
+    double, double, double > >                          PointSetType;
+  typedef typename PointSetType::Pointer      PointSetPointer;
+  typedef typename PointSetType::ConstPointer PointSetConstPointer;
+
   /** Set/Get/Add moving image. */
   virtual void SetMovingImage( TMovingImage * inputImage );
   InputImageConstPointer GetMovingImage( void );
@@ -86,6 +102,22 @@ public:
   itkGetMacro( FixedPointSetFileName, std::string );
   virtual void RemoveFixedPointSetFileName() { this->SetFixedPointSetFileName( "" ); }
 
+  /** Set/Get/Remove the input point set in memory, in world coordinates.
+   * The points are transformed to the output point set, without writing
+   * or reading any file. Can not be combined with SetFixedPointSetFileName().
+   */
+  virtual void SetInputPointSet( PointSetType * inputPointSet );
+  const PointSetType * GetInputPointSet( void ) const;
+  virtual void RemoveInputPointSet( void );
+
+  /** Get the transformed input point set. The points have the same order
+   * as the points of the input point set. The output object is created in
+   * the constructor and grafted in every Update(), so a pointer to it stays
+   * valid.
+   */
+  PointSetType * GetOutputPointSet( void );
+  const PointSetType * GetOutputPointSet( void ) const;
+
   /** Compute spatial Jacobian On/Off. */
   itkSetMacro( ComputeSpatialJacobian, bool );
   itkGetConstMacro( ComputeSpatialJacobian, bool );
@@ -32,6 +32,7 @@ TransformixFilter< TMovingImage >
   this->SetPrimaryInputName( "TransformParameterObject" );
   this->SetPrimaryOutputName( "ResultImage" );
   this->SetOutput( "ResultDeformationField", this->MakeOutput( "ResultDeformationField" ) );
+  this->SetOutput( "ResultPointSet", this->MakeOutput( "ResultPointSet" ) );
 
   //this->AddRequiredInputName( "InputImage" );
 
@@ -66,12 +67,14 @@ TransformixFilter< TMovingImage >
 
   if( this->IsEmpty( itkDynamicCastInDebugMode< TMovingImage* >( this->GetInput( "InputImage" ) ) ) &&
       this->GetFixedPointSetFileName().empty() &&
+      this->GetInputPointSet() == 0 &&
       !this->GetComputeSpatialJacobian() &&
       !this->GetComputeDeterminantOfSpatialJacobian() &&
       !this->GetComputeDeformationField() )
   {
     itkExceptionMacro( "Expected at least one of SeTMovingImage(), "
-                    << "SetFixedPointSetFileName() "
+                    << "SetFixedPointSetFileName(), "
+                    << "SetInputPointSet(), "
                     << "ComputeSpatialJacobianOn(), "
                     << "ComputeDeterminantOfSpatialJacobianOn() or "
                     << "ComputeDeformationFieldOn(), "
@@ -86,6 +89,12 @@ TransformixFilter< TMovingImage >
                        << "or SetFixedPointSetFileName() can be active at any one time." )
   }
 
+  if( this->GetInputPointSet() != 0 && !this->GetFixedPointSetFileName().empty() )
+  {
+    itkExceptionMacro( << "Only one of SetInputPointSet() or SetFixedPointSetFileName() "
+                       << "can be active at any one time." )
+  }
+
   // Setup argument map which transformix uses internally ito figure out what needs to be done
   ArgumentMapType argumentMap;
 
@@ -173,6 +182,15 @@ TransformixFilter< TMovingImage >
     transformix->SetInputImageContainer( inputImageContainer );
   }
 
+  // Setup transformix for transforming the input point set if given
+  DataObjectContainerPointer inputPointSetContainer = 0;
+  if( this->GetInputPointSet() != 0 )
+  {
+    inputPointSetContainer = DataObjectContainerType::New();
+    inputPointSetContainer->CreateElementAt( 0 ) = this->GetInput( "InputPointSet" );
+    transformix->SetFixedPointSetContainer( inputPointSetContainer );
+  }
+
   // Get ParameterMap
   ParameterObjectPointer transformParameterObject = itkDynamicCastInDebugMode< ParameterObject * >( this->GetInput( "TransformParameterObject" ) );
   ParameterMapVectorType transformParameterMapVector = transformParameterObject->GetParameterMap();
@@ -228,6 +246,12 @@ TransformixFilter< TMovingImage >
   {
     this->GraftOutput( "ResultDeformationField", resultDeformationFieldContainer->ElementAt( 0 ) );
   }
+  // Optionally, save result point set
+  DataObjectContainerPointer resultPointSetContainer = transformix->GetResultPointSetContainer();
+  if( resultPointSetContainer.IsNotNull() && resultPointSetContainer->Size() > 0 )
+  {
+    this->GraftOutput( "ResultPointSet", resultPointSetContainer->ElementAt( 0 ) );
+  }
 } // end GenerateData()
 
 
@@ -248,6 +272,10 @@ TransformixFilter< TMovingImage >
   {
     return OutputDeformationFieldType::New().GetPointer();
   }
+  else if( key == "ResultPointSet" )
+  {
+    return PointSetType::New().GetPointer();
+  }
   else
   {
     // Primary and all other outputs default to ResultImage.
@@ -463,6 +491,73 @@ TransformixFilter< TMovingImage >
 } // end GetOutputDeformationField
 
 
+/**
+ * ********************* SetInputPointSet *********************
+ */
+
+template< typename TMovingImage >
+void
+TransformixFilter< TMovingImage >
+::SetInputPointSet( PointSetType * inputPointSet )
+{
+  this->SetInput( "InputPointSet", inputPointSet );
+} // end SetInputPointSet()
+
+
+/**
+ * ********************* GetInputPointSet *********************
+ */
+
+template< typename TMovingImage >
+const typename TransformixFilter< TMovingImage >::PointSetType *
+TransformixFilter< TMovingImage >
+::GetInputPointSet( void ) const
+{
+  return itkDynamicCastInDebugMode< const PointSetType * >( this->GetInput( "InputPointSet" ) );
+} // end GetInputPointSet()
+
+
+/**
+ * ********************* RemoveInputPointSet *********************
+ */
+
+template< typename TMovingImage >
+void
+TransformixFilter< TMovingImage >
+::RemoveInputPointSet( void )
+{
+  this->RemoveInput( "InputPointSet" );
+} // end RemoveInputPointSet()
+
+
+/**
+ * ********************* GetOutputPointSet *********************
+ */
+
+template< typename TMovingImage >
+typename TransformixFilter< TMovingImage >::PointSetType *
+TransformixFilter< TMovingImage >
+::GetOutputPointSet( void )
+{
+  return itkDynamicCastInDebugMode< PointSetType * >(
+    this->itk::ProcessObject::GetOutput( "ResultPointSet" ) );
+} // end GetOutputPointSet()
+
+
+/**
+ * ********************* GetOutputPointSet *********************
+ */
+
+template< typename TMovingImage >
+const typename TransformixFilter< TMovingImage >::PointSetType *
+TransformixFilter< TMovingImage >
+::GetOutputPointSet( void ) const
+{
+  return itkDynamicCastInDebugMode< const PointSetType * >(
+    this->itk::ProcessObject::GetOutput( "ResultPointSet" ) );
+} // end GetOutputPointSet()
+
+
 /**
 * ********************* IsEmpty ****************************
 */
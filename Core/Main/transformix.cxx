@@ -262,6 +262,8 @@ PrintHelp( void )
             << "            according to the specified transform-parameter file\n";
   std::cout << "            use \"-def all\" to transform all points from the input-image, which\n"
             << "            effectively generates a deformation field.\n";
+  std::cout << "            points in a binary point file (*.bin) are transformed in chunks, and\n"
+            << "            saved as outputpoints.bin, which is faster for large point sets.\n";
   std::cout << "  -jac      use \"-jac all\" to generate an image with the determinant of the\n"
             << "            spatial Jacobian\n";
   std::cout << "  -jacmat   use \"-jacmat all\" to generate an image with the spatial Jacobian\n"
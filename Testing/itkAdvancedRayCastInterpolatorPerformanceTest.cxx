@@ -0,0 +1,205 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+/** \file
+ \brief Compare the ray casting of the AdvancedRayCastInterpolateImageFunction
+ with the original serial integration along each ray.
+
+ The reference casts each ray on its own with RayCastHelper::IntegrateAboveThreshold(),
+ which steps along the ray one voxel plane at a time. Evaluate() and EvaluateRays()
+ use the packet integration instead. EvaluateRays() is called once for all rays,
+ and once per detector line, as the resampler does when it computes a DRR.
+ The timings of the three are reported.
+ */
+
+#include "itkAdvancedRayCastInterpolateImageFunction.h"
+#include "itkEuler3DTransform.h"
+#include "itkImage.h"
+#include "itkImageRegionIterator.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkTimeProbe.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+//-------------------------------------------------------------------------------------
+
+int
+main( void )
+{
+  const unsigned int Dimension = 3;
+  typedef short                                   PixelType;
+  typedef double                                  CoordRepType;
+  typedef itk::Image< PixelType, Dimension >      ImageType;
+  typedef itk::AdvancedRayCastInterpolateImageFunction<
+    ImageType, CoordRepType >                     RayCasterType;
+  typedef RayCastHelper< ImageType, CoordRepType > RayCastHelperType;
+  typedef RayCasterType::PointType                PointType;
+  typedef RayCasterType::OutputType               OutputType;
+  typedef itk::Euler3DTransform< CoordRepType >   TransformType;
+  typedef itk::ImageRegionIterator< ImageType >   IteratorType;
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator GeneratorType;
+
+  /** Create a random volume. */
+  ImageType::SizeType size;
+  size.Fill( 128 );
+  ImageType::SpacingType spacing;
+  spacing[ 0 ] = 1.0; spacing[ 1 ] = 1.2; spacing[ 2 ] = 0.8;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( size );
+  image->SetSpacing( spacing );
+  image->Allocate();
+
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->Initialize( 12345 );
+  IteratorType it( image, image->GetLargestPossibleRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+  {
+    it.Set( static_cast< PixelType >( generator->GetUniformVariate( -100.0, 1000.0 ) ) );
+  }
+
+  /** A small rigid motion of the focal point. */
+  TransformType::Pointer transform = TransformType::New();
+  transform->SetRotation( 0.05, -0.03, 0.1 );
+  TransformType::OutputVectorType translation;
+  translation[ 0 ] = 3.0; translation[ 1 ] = -2.0; translation[ 2 ] = 1.5;
+  transform->SetTranslation( translation );
+
+  RayCasterType::InputPointType focalPoint;
+  focalPoint[ 0 ] = 5.0; focalPoint[ 1 ] = -4.0; focalPoint[ 2 ] = 1000.0;
+
+  RayCasterType::Pointer rayCaster = RayCasterType::New();
+  rayCaster->SetInputImage( image );
+  rayCaster->SetTransform( transform );
+  rayCaster->SetFocalPoint( focalPoint );
+  const double threshold = 50.0;
+  rayCaster->SetThreshold( threshold );
+
+  /** The points of a detector behind the volume. Some rays miss the volume. */
+  const unsigned int       detectorSize = 256;
+  std::vector< PointType > points( detectorSize * detectorSize );
+  for( unsigned int y = 0; y < detectorSize; ++y )
+  {
+    for( unsigned int x = 0; x < detectorSize; ++x )
+    {
+      PointType & point = points[ y * detectorSize + x ];
+      point[ 0 ] = ( static_cast< double >( x ) - 0.5 * detectorSize ) * 0.9;
+      point[ 1 ] = ( static_cast< double >( y ) - 0.5 * detectorSize ) * 0.9;
+      point[ 2 ] = -300.0;
+    }
+  }
+
+  /** Cast the rays with the original serial integration. The helper is
+   * defined in itkAdvancedRayCastInterpolateImageFunction.hxx.
+   */
+  const std::size_t         numberOfRays = points.size();
+  std::vector< double >     referenceValues( numberOfRays );
+  std::vector< OutputType > singleValues( numberOfRays );
+  std::vector< OutputType > batchValues( numberOfRays );
+  std::vector< OutputType > lineValues( numberOfRays );
+  itk::TimeProbe            referenceProbe, singleProbe, batchProbe, lineProbe;
+
+  const PointType transformedFocalPoint = transform->TransformPoint( focalPoint );
+  referenceProbe.Start();
+  for( std::size_t i = 0; i < numberOfRays; ++i )
+  {
+    RayCastHelperType ray;
+    ray.SetImage( image );
+    ray.ZeroState();
+    ray.Initialise();
+    double integral = 0.0;
+    ray.SetRay( points[ i ], transformedFocalPoint - points[ i ] );
+    ray.IntegrateAboveThreshold( integral, threshold );
+    referenceValues[ i ] = integral;
+  }
+  referenceProbe.Stop();
+
+  /** Cast the rays one by one, as a single batch, and line by line. */
+  singleProbe.Start();
+  for( std::size_t i = 0; i < numberOfRays; ++i )
+  {
+    singleValues[ i ] = rayCaster->Evaluate( points[ i ] );
+  }
+  singleProbe.Stop();
+
+  batchProbe.Start();
+  rayCaster->EvaluateRays( &points[ 0 ], &batchValues[ 0 ], numberOfRays );
+  batchProbe.Stop();
+
+  lineProbe.Start();
+  for( unsigned int y = 0; y < detectorSize; ++y )
+  {
+    rayCaster->EvaluateRays( &points[ y * detectorSize ],
+      &lineValues[ y * detectorSize ], detectorSize );
+  }
+  lineProbe.Stop();
+
+  /** Compare with the reference. The packet integration accumulates in the
+   * same order, so only rounding differences are allowed.
+   */
+  const double  tolerance = 1e-12;
+  std::size_t   numberOfHits = 0;
+  for( std::size_t i = 0; i < numberOfRays; ++i )
+  {
+    const double reference = referenceValues[ i ];
+    const double allowed   = tolerance * std::max( 1.0, std::fabs( reference ) );
+    const double values[ 3 ] = { singleValues[ i ], batchValues[ i ], lineValues[ i ] };
+    const char * names[ 3 ]  = { "Evaluate", "EvaluateRays", "EvaluateRays per line" };
+    for( unsigned int k = 0; k < 3; ++k )
+    {
+      if( std::fabs( values[ k ] - reference ) > allowed )
+      {
+        std::cerr << "ERROR: ray " << i << " gives " << values[ k ] << " with "
+                  << names[ k ] << ", but " << reference
+                  << " with the serial integration." << std::endl;
+        return 1;
+      }
+    }
+    if( reference != 0.0 )
+    {
+      ++numberOfHits;
+    }
+  }
+
+  /** Both rays that hit and rays that miss the volume should be tested. */
+  if( numberOfHits == 0 || numberOfHits == numberOfRays )
+  {
+    std::cerr << "ERROR: " << numberOfHits << " of the " << numberOfRays
+              << " rays hit the volume." << std::endl;
+    return 1;
+  }
+
+  /** Report timings. */
+  std::cerr << "Number of rays: " << numberOfRays << ", of which "
+            << numberOfHits << " hit the volume" << std::endl;
+  std::cerr << "Time serial integration: " << referenceProbe.GetMean() << " "
+            << referenceProbe.GetUnit() << std::endl;
+  std::cerr << "Time Evaluate:           " << singleProbe.GetMean() << " "
+            << singleProbe.GetUnit() << std::endl;
+  std::cerr << "Time EvaluateRays:       " << batchProbe.GetMean() << " "
+            << batchProbe.GetUnit() << std::endl;
+  std::cerr << "Time EvaluateRays/line:  " << lineProbe.GetMean() << " "
+            << lineProbe.GetUnit() << std::endl;
+  std::cerr << "Speedup EvaluateRays/line: "
+            << referenceProbe.GetMean() / lineProbe.GetMean() << std::endl;
+
+  /** Return a value. */
+  return 0;
+
+} // end main
@@ -18,6 +18,7 @@
 #include "itkBSplineDeformableTransform.h"         // original ITK
 #include "itkAdvancedBSplineDeformableTransform.h" // original elastix
 #include "itkRecursiveBSplineTransform.h"          // recursive version
+#include "itkRecursiveBSplineTransformImplementationSIMD.h"
 //#include "itkBSplineTransform.h"                   // new ITK4
 
 #include "itkGridScheduleComputer.h"
@@ -27,6 +28,110 @@
 #include "itkMersenneTwisterRandomVariateGenerator.h"
 #include <fstream>
 #include <iomanip>
+#include <algorithm>
+#include <cmath>
+
+//-------------------------------------------------------------------------------------
+
+/** Compare the vectorised cubic B-spline kernels with the scalar recursive
+ * implementation, on a random coefficient grid of size 8^Dimension.
+ * Returns the maximum absolute difference over all tested quantities.
+ */
+
+template< unsigned int Dimension >
+double
+CompareSIMDWithRecursiveImplementation( itk::Statistics::MersenneTwisterRandomVariateGenerator * generator )
+{
+  typedef itk::RecursiveBSplineTransformImplementation< Dimension, Dimension, 3, double >     ScalarImplementationType;
+  typedef itk::RecursiveBSplineTransformImplementationSIMD< Dimension, Dimension, 3, double > SIMDImplementationType;
+
+  const unsigned int gridSize        = 8;
+  const unsigned int numberOfIndices = ScalarImplementationType::BSplineNumberOfIndices;
+
+  /** Create random coefficient grids and weights. */
+  itk::OffsetValueType gridOffsetTable[ Dimension ];
+  unsigned long        numberOfCoefficients = 1;
+  for( unsigned int d = 0; d < Dimension; ++d )
+  {
+    gridOffsetTable[ d ]  = numberOfCoefficients;
+    numberOfCoefficients *= gridSize;
+  }
+  std::vector< double > coefficients( Dimension * numberOfCoefficients );
+  for( unsigned int i = 0; i < coefficients.size(); ++i )
+  {
+    coefficients[ i ] = generator->GetUniformVariate( -10.0, 10.0 );
+  }
+  double weights1D[ Dimension * 4 ];
+  for( unsigned int i = 0; i < Dimension * 4; ++i )
+  {
+    weights1D[ i ] = generator->GetUniformVariate( 0.0, 1.0 );
+  }
+  double movingImageGradient[ Dimension ];
+  for( unsigned int j = 0; j < Dimension; ++j )
+  {
+    movingImageGradient[ j ] = generator->GetUniformVariate( -1.0, 1.0 );
+  }
+
+  /** Start the support region at (2,2,..). */
+  double * mu[ Dimension ];
+  for( unsigned int j = 0; j < Dimension; ++j )
+  {
+    mu[ j ] = &coefficients[ j * numberOfCoefficients ];
+    for( unsigned int d = 0; d < Dimension; ++d )
+    {
+      mu[ j ] += 2 * gridOffsetTable[ d ];
+    }
+  }
+
+  double maxDifference = 0.0;
+
+  /** TransformPoint. */
+  double opp1[ Dimension ], opp2[ Dimension ];
+  ScalarImplementationType::TransformPoint( opp1, mu, gridOffsetTable, weights1D );
+  SIMDImplementationType::TransformPoint( opp2, mu, gridOffsetTable, weights1D );
+  for( unsigned int j = 0; j < Dimension; ++j )
+  {
+    maxDifference = std::max( maxDifference, std::abs( opp1[ j ] - opp2[ j ] ) );
+  }
+
+  /** GetJacobian. */
+  std::vector< double > jacobian1( Dimension * Dimension * numberOfIndices, 0.0 );
+  std::vector< double > jacobian2( Dimension * Dimension * numberOfIndices, 0.0 );
+  double *              jacobianPointer1 = &jacobian1[ 0 ];
+  double *              jacobianPointer2 = &jacobian2[ 0 ];
+  ScalarImplementationType::GetJacobian( jacobianPointer1, weights1D, 1.0 );
+  SIMDImplementationType::GetJacobian( jacobianPointer2, weights1D, 1.0 );
+  if( jacobianPointer1 - &jacobian1[ 0 ] != jacobianPointer2 - &jacobian2[ 0 ] )
+  {
+    return itk::NumericTraits< double >::max();
+  }
+  for( unsigned int i = 0; i < jacobian1.size(); ++i )
+  {
+    maxDifference = std::max( maxDifference, std::abs( jacobian1[ i ] - jacobian2[ i ] ) );
+  }
+
+  /** EvaluateJacobianWithImageGradientProduct. */
+  std::vector< double > imageJacobian1( Dimension * numberOfIndices, 0.0 );
+  std::vector< double > imageJacobian2( Dimension * numberOfIndices, 0.0 );
+  double *              imageJacobianPointer1 = &imageJacobian1[ 0 ];
+  double *              imageJacobianPointer2 = &imageJacobian2[ 0 ];
+  ScalarImplementationType::EvaluateJacobianWithImageGradientProduct(
+    imageJacobianPointer1, movingImageGradient, weights1D, 1.0 );
+  SIMDImplementationType::EvaluateJacobianWithImageGradientProduct(
+    imageJacobianPointer2, movingImageGradient, weights1D, 1.0 );
+  if( imageJacobianPointer1 - &imageJacobian1[ 0 ] != imageJacobianPointer2 - &imageJacobian2[ 0 ] )
+  {
+    return itk::NumericTraits< double >::max();
+  }
+  for( unsigned int i = 0; i < imageJacobian1.size(); ++i )
+  {
+    maxDifference = std::max( maxDifference, std::abs( imageJacobian1[ i ] - imageJacobian2[ i ] ) );
+  }
+
+  return maxDifference;
+
+} // end CompareSIMDWithRecursiveImplementation()
+
 
 //-------------------------------------------------------------------------------------
 
@@ -77,6 +182,7 @@ main( int argc, char * argv[] )
   typedef TransformType::NonZeroJacobianIndicesType    NonZeroJacobianIndicesType;
   typedef TransformType::NumberOfParametersType        NumberOfParametersType;
   typedef TransformType::InputPointType                InputPointType;
+  typedef TransformType::InputVectorType               InputVectorType;
   typedef TransformType::OutputPointType               OutputPointType;
   typedef TransformType::ParametersType                ParametersType;
   typedef TransformType::ImagePointer                  CoefficientImagePointer;
@@ -261,6 +367,7 @@ main( int argc, char * argv[] )
   std::vector< InputPointType >  pointList( N );
   std::vector< OutputPointType > transformedPointList1( N );
   std::vector< OutputPointType > transformedPointList2( N );
+  std::vector< OutputPointType > transformedPointList3( N );
 
   IndexType               dummyIndex;
   CoefficientImagePointer coefficientImage = transform->GetCoefficientImages()[ 0 ];
@@ -288,6 +395,10 @@ main( int argc, char * argv[] )
   }
   timeCollector.Stop(  "TransformPoint recursive         " );
 
+  timeCollector.Start( "TransformPoints recursive        " );
+  recursiveTransform->TransformPoints( &pointList[ 0 ], &transformedPointList3[ 0 ], N );
+  timeCollector.Stop(  "TransformPoints recursive        " );
+
   /** Time the implementation of the Jacobian. */
   timeCollector.Start( "Jacobian elastix                 " );
   for( unsigned int i = 0; i < N; ++i )
@@ -405,6 +516,72 @@ main( int argc, char * argv[] )
     return EXIT_FAILURE;
   }
 
+  /** TransformPoints. */
+  double differenceNorm2 = 0.0;
+  for( unsigned int i = 0; i < N; ++i )
+  {
+    for( unsigned int j = 0; j < Dimension; ++j )
+    {
+      const double diff = transformedPointList2[ i ][ j ] - transformedPointList3[ i ][ j ];
+      differenceNorm2 += diff * diff;
+    }
+  }
+  differenceNorm2 = vcl_sqrt( differenceNorm2 ) / N;
+  std::cerr << "Recursive B-spline TransformPoints() MSD with TransformPoint(): " << differenceNorm2 << std::endl;
+
+  if( differenceNorm2 > 1e-10 )
+  {
+    std::cerr << "ERROR: Recursive B-spline TransformPoints() returning incorrect result." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  /** TransformPointsOnLine, along each axis and along a diagonal, for which the
+   * point-wise fall back is used. The lines partly leave the B-spline grid.
+   */
+  const unsigned int             numberOfLinePoints = 2000;
+  std::vector< OutputPointType > lineOutputPoints( numberOfLinePoints );
+  for( unsigned int d = 0; d <= Dimension; ++d )
+  {
+    InputVectorType step;
+    step.Fill( d == Dimension ? 0.005 : 0.0 );
+    if( d < Dimension )
+    {
+      step[ d ] = 0.01;
+    }
+    recursiveTransform->TransformPointsOnLine( inputPoint, step, &lineOutputPoints[ 0 ], numberOfLinePoints );
+
+    double lineDifference = 0.0;
+    for( unsigned int i = 0; i < numberOfLinePoints; ++i )
+    {
+      const OutputPointType opp = recursiveTransform->TransformPoint( inputPoint + step * static_cast< double >( i ) );
+      for( unsigned int j = 0; j < Dimension; ++j )
+      {
+        lineDifference = vnl_math_max( lineDifference, std::abs( opp[ j ] - lineOutputPoints[ i ][ j ] ) );
+      }
+    }
+    std::cerr << "Recursive B-spline TransformPointsOnLine() difference with TransformPoint(), direction "
+              << d << ": " << lineDifference << std::endl;
+    if( lineDifference > 1e-10 )
+    {
+      std::cerr << "ERROR: Recursive B-spline TransformPointsOnLine() returning incorrect result." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  /** The vectorised kernels, in 2D and 3D. */
+  for( unsigned int i = 0; i < 10; ++i )
+  {
+    const double simdDifference2D = CompareSIMDWithRecursiveImplementation< 2 >( mersenneTwister );
+    const double simdDifference3D = CompareSIMDWithRecursiveImplementation< 3 >( mersenneTwister );
+    if( simdDifference2D > 1e-10 || simdDifference3D > 1e-10 )
+    {
+      std::cerr << "ERROR: Vectorised recursive B-spline kernels returning incorrect result. "
+                << "Difference 2D: " << simdDifference2D << ", 3D: " << simdDifference3D << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  std::cerr << "The vectorised recursive B-spline kernels match the scalar implementation." << std::endl;
+
   /** Jacobian. */
   JacobianType jacobianElastix; jacobianElastix.SetSize( Dimension, nzji.size() ); jacobianElastix.Fill( 0.0 );
   transform->GetJacobian( inputPoint, jacobianElastix, nzjiElastix );
@@ -448,6 +625,31 @@ main( int argc, char * argv[] )
     return EXIT_FAILURE;
   }
 
+  /** Spatial Jacobians along a line, as computed for a spatial Jacobian image. */
+  const unsigned int                 lineLength = 1000;
+  std::vector< InputPointType >      linePoints( lineLength );
+  std::vector< SpatialJacobianType > lineSpatialJacobians( lineLength );
+  for( unsigned int i = 0; i < lineLength; ++i )
+  {
+    linePoints[ i ]       = inputPoint;
+    linePoints[ i ][ 0 ] += 0.01 * i;
+  }
+  recursiveTransform->GetSpatialJacobians( &linePoints[ 0 ], &lineSpatialJacobians[ 0 ], lineLength );
+
+  double sjsDifference = 0.0;
+  for( unsigned int i = 0; i < lineLength; ++i )
+  {
+    recursiveTransform->GetSpatialJacobian( linePoints[ i ], sjRecursive );
+    sjDifferenceMatrix = lineSpatialJacobians[ i ] - sjRecursive;
+    sjsDifference      = vnl_math_max( sjsDifference, sjDifferenceMatrix.GetVnlMatrix().frobenius_norm() );
+  }
+  std::cerr << "The Recursive B-spline GetSpatialJacobians() difference is " << sjsDifference << std::endl;
+  if( sjsDifference > 1e-10 )
+  {
+    std::cerr << "ERROR: Recursive B-spline GetSpatialJacobians() returning incorrect result." << std::endl;
+    return EXIT_FAILURE;
+  }
+
   /** Spatial Hessian. */
   transform->GetSpatialHessian( inputPoint, sh );
   recursiveTransform->GetSpatialHessian( inputPoint, shRecursive );
@@ -0,0 +1,256 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+/** \file
+ \brief Count the calls to the global operator new in the iterations of a
+ stochastic gradient descent registration with a multi-threaded random
+ sampler, the advanced mean squares metric, a B-spline transform and a scaled
+ cost function. After the first iterations have sized all buffers, an
+ iteration should not call operator new.
+
+ Note that vnl takes buffers of at most 256 bytes from its vnl_alloc pool,
+ which is not observed here. The grid is therefore chosen such that the
+ parameter vectors and the Jacobians of a sample are larger than that; a
+ check at the start verifies that such a vector is counted.
+ */
+
+#include "elxMacro.h"
+#include "xoutmain.h"
+
+#include "AdvancedMeanSquares/itkAdvancedMeanSquaresImageToImageMetric.h"
+#include "itkAdvancedBSplineDeformableTransform.h"
+#include "itkAdvancedLinearInterpolateImageFunction.h"
+#include "itkImageRandomSampler.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkScaledSingleValuedCostFunction.h"
+#include "itkSimpleFastMutexLock.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+//-------------------------------------------------------------------------------------
+
+#if __cplusplus >= 201103L
+#define ELX_NEW_THROW_SPEC
+#define ELX_DELETE_THROW_SPEC noexcept
+#else
+#define ELX_NEW_THROW_SPEC    throw ( std::bad_alloc )
+#define ELX_DELETE_THROW_SPEC throw ( )
+#endif
+
+namespace
+{
+
+/** Allocations are only counted while this flag is set. The mutex is
+ * needed, since the threads of the metric and the sampler may allocate.
+ */
+volatile bool            countAllocations    = false;
+unsigned long            numberOfAllocations = 0;
+itk::SimpleFastMutexLock allocationMutex;
+
+void *
+CountedAllocate( std::size_t size )
+{
+  if( countAllocations )
+  {
+    allocationMutex.Lock();
+    ++numberOfAllocations;
+    allocationMutex.Unlock();
+  }
+  void * p = std::malloc( size == 0 ? 1 : size );
+  if( p == 0 )
+  {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+
+} // end namespace
+
+/** Replace the global operators new and delete, to count the allocations. */
+void * operator new( std::size_t size ) ELX_NEW_THROW_SPEC
+{
+  return CountedAllocate( size );
+}
+
+
+void * operator new[]( std::size_t size ) ELX_NEW_THROW_SPEC
+{
+  return CountedAllocate( size );
+}
+
+
+void operator delete( void * p ) ELX_DELETE_THROW_SPEC
+{
+  std::free( p );
+}
+
+
+void operator delete[]( void * p ) ELX_DELETE_THROW_SPEC
+{
+  std::free( p );
+}
+
+
+//-------------------------------------------------------------------------------------
+
+int
+main( void )
+{
+  const unsigned int Dimension   = 3;
+  const unsigned int SplineOrder = 3;
+  typedef float                                   PixelType;
+  typedef double                                  CoordinateRepresentationType;
+  typedef itk::Image< PixelType, Dimension >      ImageType;
+  typedef itk::AdvancedBSplineDeformableTransform<
+    CoordinateRepresentationType, Dimension, SplineOrder > TransformType;
+  typedef itk::AdvancedLinearInterpolateImageFunction<
+    ImageType, CoordinateRepresentationType >             InterpolatorType;
+  typedef itk::ImageRandomSampler< ImageType >            SamplerType;
+  typedef itk::AdvancedMeanSquaresImageToImageMetric<
+    ImageType, ImageType >                                MetricType;
+  typedef itk::ScaledSingleValuedCostFunction             CostFunctionType;
+  typedef CostFunctionType::ParametersType                ParametersType;
+  typedef CostFunctionType::DerivativeType                DerivativeType;
+  typedef CostFunctionType::ScalesType                    ScalesType;
+
+  /** Create a fixed and a moving image with a Gaussian blob, shifted by 2 voxels. */
+  ImageType::SizeType imageSize;
+  imageSize.Fill( 48 );
+  ImageType::Pointer images[ 2 ];
+  for( unsigned int i = 0; i < 2; ++i )
+  {
+    images[ i ] = ImageType::New();
+    images[ i ]->SetRegions( imageSize );
+    images[ i ]->Allocate();
+    itk::ImageRegionIteratorWithIndex< ImageType > it( images[ i ], images[ i ]->GetBufferedRegion() );
+    for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+      double r2 = 0.0;
+      for( unsigned int d = 0; d < Dimension; ++d )
+      {
+        const double x = it.GetIndex()[ d ] - 24.0 - 2.0 * i;
+        r2 += x * x;
+      }
+      it.Set( static_cast< PixelType >( 100.0 * std::exp( -r2 / 128.0 ) ) );
+    }
+  }
+
+  /** A B-spline transform with 10 control points per dimension covering the
+   * image. A sample then has a Jacobian of 3 x 192 doubles, and there are
+   * 3000 parameters, both well above the vnl_alloc limit.
+   */
+  TransformType::SizeType    gridSize;
+  TransformType::SpacingType gridSpacing;
+  TransformType::OriginType  gridOrigin;
+  gridSize.Fill( 10 );
+  gridSpacing.Fill( 48.0 / ( 10 - SplineOrder ) );
+  gridOrigin.Fill( -1.5 * gridSpacing[ 0 ] );
+  TransformType::RegionType gridRegion;
+  gridRegion.SetSize( gridSize );
+  TransformType::Pointer transform = TransformType::New();
+  transform->SetGridOrigin( gridOrigin );
+  transform->SetGridSpacing( gridSpacing );
+  transform->SetGridRegion( gridRegion );
+  ParametersType zeroParameters( transform->GetNumberOfParameters() );
+  zeroParameters.Fill( 0.0 );
+  transform->SetParametersByValue( zeroParameters );
+
+  /** Check that a vector of the size of the parameters is counted. */
+  countAllocations = true;
+  {
+    DerivativeType check( transform->GetNumberOfParameters() );
+    check.Fill( 0.0 );
+  }
+  countAllocations = false;
+  if( numberOfAllocations == 0 )
+  {
+    std::cerr << "ERROR: the allocation of a vector of "
+              << transform->GetNumberOfParameters() << " doubles is not counted." << std::endl;
+    return 1;
+  }
+  numberOfAllocations = 0;
+
+  /** Setup the multi-threaded random sampler, the metric and the scaled cost function. */
+  SamplerType::Pointer sampler = SamplerType::New();
+  sampler->SetNumberOfSamples( 4000 );
+  sampler->SetUseMultiThread( true );
+
+  InterpolatorType::Pointer interpolator = InterpolatorType::New();
+
+  MetricType::Pointer metric = MetricType::New();
+  metric->SetFixedImage( images[ 0 ] );
+  metric->SetMovingImage( images[ 1 ] );
+  metric->SetFixedImageRegion( images[ 0 ]->GetBufferedRegion() );
+  metric->SetTransform( transform );
+  metric->SetInterpolator( interpolator );
+  metric->SetImageSampler( sampler );
+  metric->SetUseMultiThread( true );
+  metric->Initialize();
+
+  ScalesType scales( transform->GetNumberOfParameters() );
+  scales.Fill( 2.0 );
+  CostFunctionType::Pointer costFunction = CostFunctionType::New();
+  costFunction->SetUnscaledCostFunction( metric );
+  costFunction->SetScales( scales );
+  costFunction->SetUseScales( true );
+
+  /** Run the iterations of a gradient descent optimizer, selecting new
+   * samples in every iteration. Only the iterations after the warm-up
+   * are counted; the first ones may still size the buffers.
+   */
+  const unsigned int numberOfWarmUpIterations = 3;
+  const unsigned int numberOfIterations       = 20;
+  ParametersType     position( transform->GetNumberOfParameters() );
+  DerivativeType     derivative( transform->GetNumberOfParameters() );
+  CostFunctionType::MeasureType value = 0.0;
+  position.Fill( 0.0 );
+  costFunction->ConvertUnscaledToScaledParameters( position );
+
+  for( unsigned int iter = 0; iter < numberOfIterations; ++iter )
+  {
+    countAllocations = ( iter >= numberOfWarmUpIterations );
+
+    sampler->SelectNewSamplesOnUpdate();
+    costFunction->GetValueAndDerivative( position, value, derivative );
+    for( unsigned int j = 0; j < position.GetSize(); ++j )
+    {
+      position[ j ] -= 0.5 * derivative[ j ];
+    }
+
+    countAllocations = false;
+  }
+
+  /** Report. */
+  std::cerr << "Number of threads: " << metric->GetNumberOfThreads() << std::endl;
+  std::cerr << "Final value: " << value << std::endl;
+  std::cerr << "Calls to operator new in " << numberOfIterations - numberOfWarmUpIterations
+            << " steady-state iterations: " << numberOfAllocations << std::endl;
+
+  if( numberOfAllocations != 0 )
+  {
+    std::cerr << "ERROR: the steady-state iterations call operator new." << std::endl;
+    return 1;
+  }
+
+  /** Return a value. */
+  return 0;
+
+} // end main
@@ -0,0 +1,225 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+/** \file
+ \brief Compare the batched evaluation of a population of rigid parameter
+ vectors with the mutual information metric, through the scaled cost
+ function, with evaluating them one by one, and compare the timings.
+
+ The reference values are computed with GetValue() of a second metric, with
+ its own transform and sampler, that never evaluates a batch. Both metrics
+ use a grid sampler, so that they use the same samples.
+ */
+
+#include "elxMacro.h"
+#include "xoutmain.h"
+
+#include "AdvancedMattesMutualInformation/itkParzenWindowMutualInformationImageToImageMetric.h"
+#include "itkAdvancedCombinationTransform.h"
+#include "itkAdvancedEuler3DTransform.h"
+#include "itkAdvancedLinearInterpolateImageFunction.h"
+#include "itkHardLimiterFunction.h"
+#include "itkImageGridSampler.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkScaledSingleValuedCostFunction.h"
+#include "itkTimeProbe.h"
+
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+
+const unsigned int Dimension = 3;
+typedef float                                          PixelType;
+typedef double                                         CoordinateRepresentationType;
+typedef itk::Image< PixelType, Dimension >             ImageType;
+typedef itk::AdvancedCombinationTransform<
+  CoordinateRepresentationType, Dimension >            CombinationTransformType;
+typedef itk::AdvancedEuler3DTransform<
+  CoordinateRepresentationType >                       EulerTransformType;
+typedef itk::AdvancedLinearInterpolateImageFunction<
+  ImageType, CoordinateRepresentationType >            InterpolatorType;
+typedef itk::ImageGridSampler< ImageType >             SamplerType;
+typedef itk::ParzenWindowMutualInformationImageToImageMetric<
+  ImageType, ImageType >                               MetricType;
+typedef itk::HardLimiterFunction< MetricType::RealType, Dimension > LimiterType;
+
+/** Create a multi-threaded metric with its own rigid transform and grid
+ * sampler.
+ */
+MetricType::Pointer
+CreateMetric( ImageType * fixedImage, ImageType * movingImage )
+{
+  EulerTransformType::Pointer        euler = EulerTransformType::New();
+  EulerTransformType::InputPointType center;
+  center.Fill( 32.0 );
+  euler->SetCenter( center );
+  CombinationTransformType::Pointer transform = CombinationTransformType::New();
+  transform->SetCurrentTransform( euler );
+
+  SamplerType::Pointer               sampler = SamplerType::New();
+  SamplerType::SampleGridSpacingType gridSpacing;
+  gridSpacing.Fill( 3 );
+  sampler->SetSampleGridSpacing( gridSpacing );
+
+  MetricType::Pointer metric = MetricType::New();
+  metric->SetFixedImage( fixedImage );
+  metric->SetMovingImage( movingImage );
+  metric->SetFixedImageRegion( fixedImage->GetBufferedRegion() );
+  metric->SetTransform( transform );
+  metric->SetInterpolator( InterpolatorType::New() );
+  metric->SetImageSampler( sampler );
+  metric->SetFixedImageLimiter( LimiterType::New() );
+  metric->SetMovingImageLimiter( LimiterType::New() );
+  metric->SetUseMultiThread( true );
+  metric->Initialize();
+
+  return metric;
+
+} // end CreateMetric()
+
+
+} // end namespace
+
+//-------------------------------------------------------------------------------------
+
+int
+main( void )
+{
+  typedef itk::ScaledSingleValuedCostFunction            CostFunctionType;
+  typedef CostFunctionType::ParametersType               ParametersType;
+  typedef CostFunctionType::ParametersContainerType      ParametersContainerType;
+  typedef CostFunctionType::MeasureContainerType         MeasureContainerType;
+  typedef CostFunctionType::ScalesType                   ScalesType;
+
+  /** Create a fixed and a moving image with an anisotropic Gaussian blob,
+   * shifted by 3 voxels.
+   */
+  ImageType::SizeType imageSize;
+  imageSize.Fill( 64 );
+  ImageType::Pointer images[ 2 ];
+  for( unsigned int i = 0; i < 2; ++i )
+  {
+    images[ i ] = ImageType::New();
+    images[ i ]->SetRegions( imageSize );
+    images[ i ]->Allocate();
+    itk::ImageRegionIteratorWithIndex< ImageType > it( images[ i ], images[ i ]->GetBufferedRegion() );
+    for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+      double r2 = 0.0;
+      for( unsigned int d = 0; d < Dimension; ++d )
+      {
+        const double x = ( it.GetIndex()[ d ] - 32.0 - 3.0 * i ) / ( d + 1.0 );
+        r2 += x * x;
+      }
+      it.Set( static_cast< PixelType >( 100.0 * std::exp( -r2 / 64.0 ) ) );
+    }
+  }
+
+  /** Setup the metric and the scaled cost function, and a reference metric. */
+  MetricType::Pointer metric          = CreateMetric( images[ 0 ], images[ 1 ] );
+  MetricType::Pointer referenceMetric = CreateMetric( images[ 0 ], images[ 1 ] );
+
+  const unsigned int numberOfParameters = metric->GetNumberOfParameters();
+  ScalesType         scales( numberOfParameters );
+  scales.Fill( 1.0 );
+  for( unsigned int p = 0; p < 3; ++p )
+  {
+    scales[ p ] = 1000.0;
+  }
+  CostFunctionType::Pointer costFunction = CostFunctionType::New();
+  costFunction->SetUnscaledCostFunction( metric );
+  costFunction->SetScales( scales );
+  costFunction->SetUseScales( true );
+
+  /** A population of scaled parameter vectors around the identity. */
+  const unsigned int      populationSize = 32;
+  ParametersContainerType population( populationSize, ParametersType( numberOfParameters ) );
+  for( unsigned int k = 0; k < populationSize; ++k )
+  {
+    for( unsigned int p = 0; p < numberOfParameters; ++p )
+    {
+      population[ k ][ p ] = 2.0 * std::sin( 1.0 + 7.0 * k + 3.0 * p );
+    }
+  }
+
+  /** The reference values, one vector at a time, with unscaled parameters. */
+  MeasureContainerType referenceValues( populationSize );
+  for( unsigned int k = 0; k < populationSize; ++k )
+  {
+    ParametersType unscaledParameters( population[ k ] );
+    for( unsigned int p = 0; p < numberOfParameters; ++p )
+    {
+      unscaledParameters[ p ] /= scales[ p ];
+    }
+    referenceValues[ k ] = referenceMetric->GetValue( unscaledParameters );
+  }
+
+  /** Evaluate one by one, and in one batch. */
+  MeasureContainerType serialValues( populationSize );
+  MeasureContainerType batchValues;
+  itk::TimeProbe       serialProbe, batchProbe;
+  const unsigned int   numberOfRepetitions = 5;
+
+  for( unsigned int r = 0; r < numberOfRepetitions; ++r )
+  {
+    serialProbe.Start();
+    for( unsigned int k = 0; k < populationSize; ++k )
+    {
+      serialValues[ k ] = costFunction->GetValue( population[ k ] );
+    }
+    serialProbe.Stop();
+
+    batchProbe.Start();
+    costFunction->GetValues( population, batchValues );
+    batchProbe.Stop();
+  }
+
+  /** Both should give the reference values, up to the order of the summation. */
+  if( batchValues.size() != populationSize )
+  {
+    std::cerr << "ERROR: the batch gives " << batchValues.size() << " values instead of "
+              << populationSize << "." << std::endl;
+    return 1;
+  }
+  for( unsigned int k = 0; k < populationSize; ++k )
+  {
+    const double tolerance = 1e-8 * ( 1.0 + std::abs( referenceValues[ k ] ) );
+    if( std::abs( batchValues[ k ] - referenceValues[ k ] ) > tolerance
+      || std::abs( serialValues[ k ] - referenceValues[ k ] ) > tolerance )
+    {
+      std::cerr << "ERROR: value " << k << " is " << batchValues[ k ] << " in the batch and "
+                << serialValues[ k ] << " one by one, instead of " << referenceValues[ k ]
+                << "." << std::endl;
+      return 1;
+    }
+  }
+
+  /** Report timings. */
+  std::cerr << "Number of threads: " << metric->GetNumberOfThreads() << std::endl;
+  std::cerr << "Population size: " << populationSize << std::endl;
+  std::cerr << "Time one by one: " << serialProbe.GetMean() << " "
+            << serialProbe.GetUnit() << std::endl;
+  std::cerr << "Time batched:    " << batchProbe.GetMean() << " "
+            << batchProbe.GetUnit() << std::endl;
+  std::cerr << "Speedup: " << serialProbe.GetMean() / batchProbe.GetMean() << std::endl;
+
+  /** Return a value. */
+  return 0;
+
+} // end main
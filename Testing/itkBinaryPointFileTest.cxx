@@ -0,0 +1,125 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkBinaryPointFile.h"
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+//-------------------------------------------------------------------------------------
+
+int
+main( int argc, char * argv[] )
+{
+  typedef itk::BinaryPointFile BinaryPointFileType;
+
+  /** Check the recognition of file names. */
+  if( !BinaryPointFileType::IsBinaryPointFileName( "points.bin" )
+    || !BinaryPointFileType::IsBinaryPointFileName( "POINTS.BIN" )
+    || BinaryPointFileType::IsBinaryPointFileName( "points.txt" )
+    || BinaryPointFileType::IsBinaryPointFileName( "in" ) )
+  {
+    std::cerr << "ERROR: binary point file names are not recognised correctly." << std::endl;
+    return 1;
+  }
+
+  /** Write a header and some points. */
+  const unsigned int    dimension      = 3;
+  const unsigned long   numberOfPoints = 1000;
+  std::vector< double > points( numberOfPoints * dimension );
+  for( unsigned long i = 0; i < points.size(); ++i )
+  {
+    points[ i ] = 0.25 * i - 100.0;
+  }
+
+  BinaryPointFileType::HeaderType header;
+  header.Dimension        = dimension;
+  header.PointsAreIndices = true;
+  header.NumberOfPoints   = numberOfPoints;
+
+  std::stringstream stream( std::ios::in | std::ios::out | std::ios::binary );
+  BinaryPointFileType::WriteHeader( stream, header );
+  BinaryPointFileType::WritePoints( stream, dimension, numberOfPoints, &points[ 0 ] );
+
+  if( stream.str().size() != 32 + numberOfPoints * dimension * sizeof( double ) )
+  {
+    std::cerr << "ERROR: the binary point file has the wrong size." << std::endl;
+    return 1;
+  }
+
+  /** Read them back, in two chunks. */
+  BinaryPointFileType::HeaderType readHeader;
+  if( !BinaryPointFileType::ReadHeader( stream, readHeader )
+    || readHeader.Dimension != dimension
+    || !readHeader.PointsAreIndices
+    || readHeader.NumberOfPoints != numberOfPoints )
+  {
+    std::cerr << "ERROR: the header is not read back correctly." << std::endl;
+    return 1;
+  }
+
+  std::vector< double > readPoints( numberOfPoints * dimension );
+  const unsigned long   firstChunk = 600;
+  if( BinaryPointFileType::ReadPoints( stream, dimension, firstChunk, &readPoints[ 0 ] ) != firstChunk
+    || BinaryPointFileType::ReadPoints( stream, dimension, numberOfPoints - firstChunk,
+    &readPoints[ firstChunk * dimension ] ) != numberOfPoints - firstChunk )
+  {
+    std::cerr << "ERROR: the number of points read back is wrong." << std::endl;
+    return 1;
+  }
+  if( readPoints != points )
+  {
+    std::cerr << "ERROR: the points are not read back correctly." << std::endl;
+    return 1;
+  }
+
+  /** A file that is cut off halfway a point should give a short read, of the
+   * complete points only.
+   */
+  const unsigned long completePoints = 10;
+  std::stringstream   shortStream( std::ios::in | std::ios::out | std::ios::binary );
+  BinaryPointFileType::WriteHeader( shortStream, header );
+  shortStream.write( stream.str().data() + 32,
+    ( completePoints * dimension + 1 ) * sizeof( double ) );
+  if( !BinaryPointFileType::ReadHeader( shortStream, readHeader )
+    || BinaryPointFileType::ReadPoints( shortStream, dimension, 20, &readPoints[ 0 ] ) != completePoints )
+  {
+    std::cerr << "ERROR: a short read does not return the number of complete points." << std::endl;
+    return 1;
+  }
+  for( unsigned long i = 0; i < completePoints * dimension; ++i )
+  {
+    if( readPoints[ i ] != points[ i ] )
+    {
+      std::cerr << "ERROR: the points of a short read are not read back correctly." << std::endl;
+      return 1;
+    }
+  }
+
+  /** A stream that is not a binary point file should be rejected. */
+  std::stringstream textStream( "Point\t0\t; InputIndex = [ 1 2 3 ]\n" );
+  if( BinaryPointFileType::ReadHeader( textStream, readHeader ) )
+  {
+    std::cerr << "ERROR: a text file is accepted as binary point file." << std::endl;
+    return 1;
+  }
+
+  std::cerr << "Test passed." << std::endl;
+  return 0;
+
+} // end main
@@ -0,0 +1,177 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+/** \file
+ \brief Compare the multi-threaded 95percentile method of the
+ ComputeDisplacementDistribution with the single-threaded implementation.
+
+ The multi-threaded Compute() stores the displacement of each sample and
+ selects the percentile with std::nth_element, while ComputeSingleThreaded()
+ sorts all displacements. Both should give the same jacg and maxJJ, for any
+ number of threads, with and without scales.
+ */
+
+#include "elxMacro.h"
+#include "xoutmain.h"
+
+#include "AdvancedMeanSquares/itkAdvancedMeanSquaresImageToImageMetric.h"
+#include "itkAdvancedBSplineDeformableTransform.h"
+#include "itkAdvancedLinearInterpolateImageFunction.h"
+#include "itkComputeDisplacementDistribution.h"
+#include "itkImageFullSampler.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include <cmath>
+#include <iostream>
+
+//-------------------------------------------------------------------------------------
+
+int
+main( void )
+{
+  const unsigned int Dimension   = 3;
+  const unsigned int SplineOrder = 3;
+  typedef float                                   PixelType;
+  typedef double                                  CoordinateRepresentationType;
+  typedef itk::Image< PixelType, Dimension >      ImageType;
+  typedef itk::AdvancedBSplineDeformableTransform<
+    CoordinateRepresentationType, Dimension, SplineOrder > TransformType;
+  typedef itk::AdvancedLinearInterpolateImageFunction<
+    ImageType, CoordinateRepresentationType >             InterpolatorType;
+  typedef itk::ImageFullSampler< ImageType >              SamplerType;
+  typedef itk::AdvancedMeanSquaresImageToImageMetric<
+    ImageType, ImageType >                                MetricType;
+  typedef itk::ComputeDisplacementDistribution<
+    ImageType, TransformType >                            ComputeDisplacementDistributionType;
+  typedef ComputeDisplacementDistributionType::ParametersType ParametersType;
+  typedef ComputeDisplacementDistributionType::ScalesType     ScalesType;
+
+  /** A fixed and a moving image with a Gaussian blob, shifted by 2 voxels. */
+  ImageType::SizeType imageSize;
+  imageSize.Fill( 32 );
+  ImageType::Pointer images[ 2 ];
+  for( unsigned int i = 0; i < 2; ++i )
+  {
+    images[ i ] = ImageType::New();
+    images[ i ]->SetRegions( imageSize );
+    images[ i ]->Allocate();
+    itk::ImageRegionIteratorWithIndex< ImageType > it( images[ i ], images[ i ]->GetBufferedRegion() );
+    for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+      double r2 = 0.0;
+      for( unsigned int d = 0; d < Dimension; ++d )
+      {
+        const double x = it.GetIndex()[ d ] - 16.0 - 2.0 * i;
+        r2 += x * x;
+      }
+      it.Set( static_cast< PixelType >( 100.0 * std::exp( -r2 / 64.0 ) ) );
+    }
+  }
+
+  /** A B-spline transform with 8 control points per dimension covering the image. */
+  TransformType::SizeType    gridSize;
+  TransformType::SpacingType gridSpacing;
+  TransformType::OriginType  gridOrigin;
+  gridSize.Fill( 8 );
+  gridSpacing.Fill( 32.0 / ( 8 - SplineOrder ) );
+  gridOrigin.Fill( -1.5 * gridSpacing[ 0 ] );
+  TransformType::RegionType gridRegion;
+  gridRegion.SetSize( gridSize );
+  TransformType::Pointer transform = TransformType::New();
+  transform->SetGridOrigin( gridOrigin );
+  transform->SetGridSpacing( gridSpacing );
+  transform->SetGridRegion( gridRegion );
+  const unsigned int P = transform->GetNumberOfParameters();
+  ParametersType     mu( P );
+  for( unsigned int p = 0; p < P; ++p )
+  {
+    mu[ p ] = 0.3 * std::sin( 0.7 * p );
+  }
+  transform->SetParametersByValue( mu );
+
+  /** The metric, whose derivative is the exact gradient. */
+  MetricType::Pointer metric = MetricType::New();
+  metric->SetFixedImage( images[ 0 ] );
+  metric->SetMovingImage( images[ 1 ] );
+  metric->SetFixedImageRegion( images[ 0 ]->GetBufferedRegion() );
+  metric->SetTransform( transform );
+  metric->SetInterpolator( InterpolatorType::New() );
+  metric->SetImageSampler( SamplerType::New() );
+  metric->Initialize();
+
+  ScalesType scales( P );
+  for( unsigned int p = 0; p < P; ++p )
+  {
+    scales[ p ] = 1.0 + 0.5 * std::cos( 0.4 * p );
+  }
+
+  const itk::ThreadIdType numbersOfThreads[] = { 1, 3, 4 };
+  for( unsigned int useScales = 0; useScales < 2; ++useScales )
+  {
+    /** The single-threaded reference. */
+    double referenceJacg = 0.0, referenceMaxJJ = 0.0;
+    {
+      ComputeDisplacementDistributionType::Pointer computeDisplacementDistribution
+        = ComputeDisplacementDistributionType::New();
+      computeDisplacementDistribution->SetFixedImage( images[ 0 ] );
+      computeDisplacementDistribution->SetFixedImageRegion( images[ 0 ]->GetBufferedRegion() );
+      computeDisplacementDistribution->SetTransform( transform );
+      computeDisplacementDistribution->SetCostFunction( metric );
+      computeDisplacementDistribution->SetNumberOfJacobianMeasurements( 5000 );
+      computeDisplacementDistribution->SetUseScales( useScales != 0 );
+      computeDisplacementDistribution->SetScales( scales );
+      computeDisplacementDistribution->ComputeSingleThreaded(
+        mu, referenceJacg, referenceMaxJJ, "95percentile" );
+    }
+    if( !( referenceJacg > 0.0 ) )
+    {
+      std::cerr << "ERROR: the reference jacg is " << referenceJacg << "." << std::endl;
+      return 1;
+    }
+
+    for( unsigned int t = 0; t < 3; ++t )
+    {
+      ComputeDisplacementDistributionType::Pointer computeDisplacementDistribution
+        = ComputeDisplacementDistributionType::New();
+      computeDisplacementDistribution->SetFixedImage( images[ 0 ] );
+      computeDisplacementDistribution->SetFixedImageRegion( images[ 0 ]->GetBufferedRegion() );
+      computeDisplacementDistribution->SetTransform( transform );
+      computeDisplacementDistribution->SetCostFunction( metric );
+      computeDisplacementDistribution->SetNumberOfJacobianMeasurements( 5000 );
+      computeDisplacementDistribution->SetUseScales( useScales != 0 );
+      computeDisplacementDistribution->SetScales( scales );
+      computeDisplacementDistribution->SetNumberOfThreads( numbersOfThreads[ t ] );
+
+      double jacg = 0.0, maxJJ = 0.0;
+      computeDisplacementDistribution->Compute( mu, jacg, maxJJ, "95percentile" );
+
+      std::cerr << numbersOfThreads[ t ] << " threads, scales " << useScales
+                << ": jacg = " << jacg << ", maxJJ = " << maxJJ << std::endl;
+      if( std::abs( jacg - referenceJacg ) > 1e-10 * referenceJacg
+        || std::abs( maxJJ - referenceMaxJJ ) > 1e-10 * referenceMaxJJ )
+      {
+        std::cerr << "ERROR: the single-threaded implementation gives jacg = "
+                  << referenceJacg << " and maxJJ = " << referenceMaxJJ << "." << std::endl;
+        return 1;
+      }
+    }
+  }
+
+  /** Return a value. */
+  return 0;
+
+} // end main
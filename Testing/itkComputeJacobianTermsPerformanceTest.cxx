@@ -0,0 +1,350 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+/** \file
+ \brief Compare the Jacobian terms of the ASGD parameter estimation with a
+ dense reference, and time them against the B-spline grid size.
+
+ The reference accumulates the covariance matrix C = 1/n \sum_j J_j^T J_j as a
+ dense matrix, over the same grid samples, and computes TrC, TrCC, maxJJ and
+ maxJCJ directly from it. This is done for different numbers of threads, with
+ and without scales, and with a band matrix that is too small to hold all
+ elements of C, so that the sparse part of C is used as well.
+ */
+
+#include "itkComputeJacobianTerms.h"
+#include "itkAdvancedBSplineDeformableTransform.h"
+#include "itkImageGridSampler.h"
+#include "itkMultiThreader.h"
+#include "itkTimeProbe.h"
+
+#include "vnl/vnl_matrix.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+
+/** Create a B-spline transform with \a gridSize control points in every
+ * dimension, whose grid covers an image of \a imageSize voxels with unit
+ * spacing and zero origin.
+ */
+template< class TTransform >
+typename TTransform::Pointer
+CreateTransform( const typename TTransform::SizeType & imageSize, const unsigned int gridSize )
+{
+  typename TTransform::SizeType    gridSizes;
+  typename TTransform::SpacingType gridSpacing;
+  typename TTransform::OriginType  gridOrigin;
+  gridSizes.Fill( gridSize );
+  for( unsigned int d = 0; d < TTransform::SpaceDimension; ++d )
+  {
+    gridSpacing[ d ] = static_cast< double >( imageSize[ d ] )
+      / static_cast< double >( gridSize - TTransform::SplineOrder );
+    gridOrigin[ d ] = -1.5 * gridSpacing[ d ];
+  }
+  typename TTransform::RegionType gridRegion;
+  gridRegion.SetSize( gridSizes );
+
+  typename TTransform::Pointer transform = TTransform::New();
+  transform->SetGridOrigin( gridOrigin );
+  transform->SetGridSpacing( gridSpacing );
+  transform->SetGridRegion( gridRegion );
+  typename TTransform::ParametersType parameters( transform->GetNumberOfParameters() );
+  parameters.Fill( 0.0 );
+  transform->SetParametersByValue( parameters );
+  return transform;
+
+} // end CreateTransform()
+
+
+/** Compute TrC, TrCC, maxJJ and maxJCJ with a dense covariance matrix. */
+template< class TImage, class TTransform >
+void
+ComputeDenseReference( const TImage * image, const TTransform * transform,
+  const unsigned long numberOfSamples, const bool useScales,
+  const itk::Array< double > & scales, double terms[ 4 ] )
+{
+  typedef itk::ImageGridSampler< TImage >                     SamplerType;
+  typedef typename SamplerType::ImageSampleContainerType      SampleContainerType;
+  typedef typename TTransform::JacobianType                   JacobianType;
+  typedef typename TTransform::NonZeroJacobianIndicesType     NonZeroJacobianIndicesType;
+
+  /** The same samples as ComputeJacobianTerms. */
+  typename SamplerType::Pointer sampler = SamplerType::New();
+  sampler->SetInput( image );
+  sampler->SetInputImageRegion( image->GetBufferedRegion() );
+  sampler->SetNumberOfSamples( numberOfSamples );
+  sampler->Update();
+  const SampleContainerType * samples = sampler->GetOutput();
+  const double                n       = static_cast< double >( samples->Size() );
+
+  const unsigned int P          = transform->GetNumberOfParameters();
+  const unsigned int outdim     = transform->GetOutputSpaceDimension();
+  const unsigned int sizejacind = transform->GetNumberOfNonZeroJacobianIndices();
+  JacobianType               jacj( outdim, sizejacind );
+  NonZeroJacobianIndicesType jacind( sizejacind );
+
+  /** The Jacobians of all samples, with the scales applied. */
+  std::vector< JacobianType >               jacobians( samples->Size() );
+  std::vector< NonZeroJacobianIndicesType > indices( samples->Size() );
+  for( unsigned long j = 0; j < samples->Size(); ++j )
+  {
+    transform->GetJacobian( samples->GetElement( j ).m_ImageCoordinates, jacj, jacind );
+    for( unsigned int pi = 0; pi < sizejacind; ++pi )
+    {
+      for( unsigned int d = 0; d < outdim; ++d )
+      {
+        jacj( d, pi ) /= useScales ? scales[ jacind[ pi ] ] : 1.0;
+      }
+    }
+    jacobians[ j ] = jacj;
+    indices[ j ]   = jacind;
+  }
+
+  /** C = 1/n \sum_j J_j^T J_j. */
+  vnl_matrix< double > C( P, P, 0.0 );
+  for( unsigned long j = 0; j < samples->Size(); ++j )
+  {
+    for( unsigned int pi = 0; pi < sizejacind; ++pi )
+    {
+      for( unsigned int qi = 0; qi < sizejacind; ++qi )
+      {
+        double sum = 0.0;
+        for( unsigned int d = 0; d < outdim; ++d )
+        {
+          sum += jacobians[ j ]( d, pi ) * jacobians[ j ]( d, qi );
+        }
+        C( indices[ j ][ pi ], indices[ j ][ qi ] ) += sum / n;
+      }
+    }
+  }
+
+  /** TrC = trace( C ), TrCC = ||C||_F^2. */
+  terms[ 0 ] = terms[ 1 ] = terms[ 2 ] = terms[ 3 ] = 0.0;
+  for( unsigned int p = 0; p < P; ++p )
+  {
+    terms[ 0 ] += C( p, p );
+    for( unsigned int q = 0; q < P; ++q )
+    {
+      terms[ 1 ] += C( p, q ) * C( p, q );
+    }
+  }
+
+  /** maxJJ = max_j [ ||J_j||_F^2 + 2\sqrt{2} ||J_j J_j^T||_F ], and
+   * maxJCJ = max_j [ Tr( J_j C J_j^T ) + 2\sqrt{2} ||J_j C J_j^T||_F ].
+   */
+  const double sqrt2 = std::sqrt( 2.0 );
+  for( unsigned long j = 0; j < samples->Size(); ++j )
+  {
+    vnl_matrix< double > J( outdim, sizejacind );
+    vnl_matrix< double > Csub( sizejacind, sizejacind );
+    for( unsigned int pi = 0; pi < sizejacind; ++pi )
+    {
+      for( unsigned int d = 0; d < outdim; ++d )
+      {
+        J( d, pi ) = jacobians[ j ]( d, pi );
+      }
+      for( unsigned int qi = 0; qi < sizejacind; ++qi )
+      {
+        Csub( pi, qi ) = C( indices[ j ][ pi ], indices[ j ][ qi ] );
+      }
+    }
+    const vnl_matrix< double > JJ  = J * J.transpose();
+    const vnl_matrix< double > JCJ = J * Csub * J.transpose();
+    double                     trJCJ = 0.0;
+    for( unsigned int d = 0; d < outdim; ++d )
+    {
+      trJCJ += JCJ( d, d );
+    }
+    const double normJ = J.frobenius_norm();
+    terms[ 2 ] = std::max( terms[ 2 ], normJ * normJ + 2.0 * sqrt2 * JJ.frobenius_norm() );
+    terms[ 3 ] = std::max( terms[ 3 ], trJCJ + 2.0 * sqrt2 * JCJ.frobenius_norm() );
+  }
+
+} // end ComputeDenseReference()
+
+
+/** Compare ComputeJacobianTerms with the dense reference. Returns 1 on failure. */
+template< unsigned int VDimension >
+int
+CompareWithDenseReference( const unsigned int imageSizeValue, const unsigned int gridSize )
+{
+  typedef itk::Image< short, VDimension >                 ImageType;
+  typedef itk::AdvancedBSplineDeformableTransform<
+    double, VDimension, 3 >                               TransformType;
+  typedef itk::ComputeJacobianTerms< ImageType, TransformType > ComputeJacobianTermsType;
+  typedef typename ComputeJacobianTermsType::ScalesType   ScalesType;
+
+  /** The fixed image. Only its geometry is used. */
+  typename ImageType::SizeType imageSize;
+  imageSize.Fill( imageSizeValue );
+  typename ImageType::Pointer image = ImageType::New();
+  image->SetRegions( imageSize );
+  image->Allocate();
+
+  typename TransformType::Pointer transform = CreateTransform< TransformType >( imageSize, gridSize );
+  const unsigned int              P         = transform->GetNumberOfParameters();
+  ScalesType                      scales( P );
+  for( unsigned int p = 0; p < P; ++p )
+  {
+    scales[ p ] = 1.0 + 0.5 * std::sin( 0.3 * p );
+  }
+
+  const unsigned long numberOfSamples = 3000;
+  for( unsigned int useScales = 0; useScales < 2; ++useScales )
+  {
+    double reference[ 4 ];
+    ComputeDenseReference( image.GetPointer(), transform.GetPointer(),
+      numberOfSamples, useScales != 0, scales, reference );
+
+    const unsigned int      maxBandCovSizes[]  = { 4, 192 };
+    const itk::ThreadIdType numbersOfThreads[] = { 1, 3, 4 };
+    for( unsigned int b = 0; b < 2; ++b )
+    {
+      for( unsigned int t = 0; t < 3; ++t )
+      {
+        typename ComputeJacobianTermsType::Pointer computeJacobianTerms = ComputeJacobianTermsType::New();
+        computeJacobianTerms->SetFixedImage( image );
+        computeJacobianTerms->SetFixedImageRegion( image->GetBufferedRegion() );
+        computeJacobianTerms->SetTransform( transform );
+        computeJacobianTerms->SetMaxBandCovSize( maxBandCovSizes[ b ] );
+        computeJacobianTerms->SetNumberOfBandStructureSamples( 10 );
+        computeJacobianTerms->SetNumberOfJacobianMeasurements( numberOfSamples );
+        computeJacobianTerms->SetScales( scales );
+        computeJacobianTerms->SetUseScales( useScales != 0 );
+        computeJacobianTerms->SetNumberOfThreads( numbersOfThreads[ t ] );
+
+        double terms[ 4 ];
+        computeJacobianTerms->Compute( terms[ 0 ], terms[ 1 ], terms[ 2 ], terms[ 3 ] );
+
+        const char * names[ 4 ] = { "TrC", "TrCC", "maxJJ", "maxJCJ" };
+        for( unsigned int k = 0; k < 4; ++k )
+        {
+          if( std::abs( terms[ k ] - reference[ k ] ) > 1e-9 * std::abs( reference[ k ] ) )
+          {
+            std::cerr << "ERROR: " << names[ k ] << " is " << terms[ k ] << " instead of "
+                      << reference[ k ] << " (dimension " << VDimension << ", grid size "
+                      << gridSize << ", scales " << useScales << ", band size "
+                      << maxBandCovSizes[ b ] << ", " << numbersOfThreads[ t ]
+                      << " threads)." << std::endl;
+            return 1;
+          }
+        }
+      }
+    }
+  }
+  return 0;
+
+} // end CompareWithDenseReference()
+
+
+} // end namespace
+
+//-------------------------------------------------------------------------------------
+
+int
+main( void )
+{
+  /** Compare with the dense reference. */
+  if( CompareWithDenseReference< 2 >( 64, 6 )
+    || CompareWithDenseReference< 2 >( 64, 10 )
+    || CompareWithDenseReference< 3 >( 24, 6 ) )
+  {
+    return 1;
+  }
+
+  const unsigned int Dimension   = 3;
+  const unsigned int SplineOrder = 3;
+  typedef short                                   PixelType;
+  typedef double                                  CoordinateRepresentationType;
+  typedef itk::Image< PixelType, Dimension >      ImageType;
+  typedef itk::AdvancedBSplineDeformableTransform<
+    CoordinateRepresentationType, Dimension, SplineOrder > TransformType;
+  typedef itk::ComputeJacobianTerms< ImageType, TransformType > ComputeJacobianTermsType;
+
+  /** The fixed image. Only its geometry is used. */
+  ImageType::SizeType imageSize;
+  imageSize.Fill( 64 );
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( imageSize );
+  image->Allocate();
+
+  const itk::ThreadIdType numberOfThreads
+    = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+  std::cerr << "Number of threads: " << numberOfThreads << std::endl;
+
+  /** Compute the Jacobian terms for increasingly finer B-spline grids. */
+  const unsigned int gridSizes[] = { 8, 12, 16, 24 };
+  for( unsigned int g = 0; g < sizeof( gridSizes ) / sizeof( gridSizes[ 0 ] ); ++g )
+  {
+    /** Setup a B-spline grid covering the image. */
+    TransformType::Pointer transform = CreateTransform< TransformType >( imageSize, gridSizes[ g ] );
+
+    /** Compute the terms single-threaded and multi-threaded. */
+    double         terms[ 2 ][ 4 ];
+    itk::TimeProbe probes[ 2 ];
+    for( unsigned int i = 0; i < 2; ++i )
+    {
+      ComputeJacobianTermsType::Pointer computeJacobianTerms = ComputeJacobianTermsType::New();
+      computeJacobianTerms->SetFixedImage( image );
+      computeJacobianTerms->SetFixedImageRegion( image->GetBufferedRegion() );
+      computeJacobianTerms->SetTransform( transform );
+      computeJacobianTerms->SetMaxBandCovSize( 192 );
+      computeJacobianTerms->SetNumberOfBandStructureSamples( 10 );
+      computeJacobianTerms->SetNumberOfJacobianMeasurements( 20000 );
+      computeJacobianTerms->SetUseScales( false );
+      computeJacobianTerms->SetNumberOfThreads( i == 0 ? 1 : numberOfThreads );
+
+      probes[ i ].Start();
+      computeJacobianTerms->Compute( terms[ i ][ 0 ], terms[ i ][ 1 ],
+        terms[ i ][ 2 ], terms[ i ][ 3 ] );
+      probes[ i ].Stop();
+    }
+
+    /** The results should be the same, up to the order of summation. */
+    for( unsigned int k = 0; k < 4; ++k )
+    {
+      const double difference = std::abs( terms[ 0 ][ k ] - terms[ 1 ][ k ] );
+      if( difference > 1e-8 * std::abs( terms[ 0 ][ k ] ) )
+      {
+        std::cerr << "ERROR: term " << k << " for grid size " << gridSizes[ g ]
+                  << " is " << terms[ 1 ][ k ] << " multi-threaded, but "
+                  << terms[ 0 ][ k ] << " single-threaded." << std::endl;
+        return 1;
+      }
+    }
+
+    /** Report timings. */
+    std::cerr << "Grid size " << gridSizes[ g ] << " ("
+              << transform->GetNumberOfParameters() << " parameters):"
+              << " TrC = " << terms[ 1 ][ 0 ] << ", TrCC = " << terms[ 1 ][ 1 ]
+              << ", maxJJ = " << terms[ 1 ][ 2 ] << ", maxJCJ = " << terms[ 1 ][ 3 ]
+              << std::endl;
+    std::cerr << "  Time 1 thread:   " << probes[ 0 ].GetMean() << " "
+              << probes[ 0 ].GetUnit() << std::endl;
+    std::cerr << "  Time " << numberOfThreads << " threads: " << probes[ 1 ].GetMean()
+              << " " << probes[ 1 ].GetUnit() << std::endl;
+  }
+
+  /** Return a value. */
+  return 0;
+
+} // end main
@@ -0,0 +1,268 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+/** \file
+ \brief Check that the batched point transformation of the transform behind
+ the BSplineTransformWithDiffusion, a DeformationFieldRegulizer around an
+ AdvancedCombinationTransform, adds the intermediary deformation field, as
+ its TransformPoint() does. This is checked for the transform on its own, and
+ as the initial transform of another combination transform, for blocks of
+ points, for the points on a line, and for the deformation field that
+ transformix generates line by line.
+ */
+
+#include "BSplineDeformableTransformWithDiffusion/itkDeformationFieldRegulizer.h"
+#include "itkAdvancedCombinationTransform.h"
+#include "itkAdvancedBSplineDeformableTransform.h"
+#include "itkAdvancedTranslationTransform.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTransformToDisplacementFieldSource.h"
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+//-------------------------------------------------------------------------------------
+
+int
+main( void )
+{
+  const unsigned int Dimension   = 2;
+  const unsigned int SplineOrder = 3;
+  typedef double ScalarType;
+
+  typedef itk::AdvancedCombinationTransform< ScalarType, Dimension > CombinationTransformType;
+  typedef itk::DeformationFieldRegulizer< CombinationTransformType > TransformType;
+  typedef itk::AdvancedBSplineDeformableTransform<
+    ScalarType, Dimension, SplineOrder >                             BSplineTransformType;
+  typedef itk::AdvancedTranslationTransform< ScalarType, Dimension > TranslationTransformType;
+  typedef TransformType::VectorImageType                             VectorImageType;
+  typedef TransformType::InputPointType                              InputPointType;
+  typedef TransformType::OutputPointType                             OutputPointType;
+  typedef TransformType::InputVectorType                             InputVectorType;
+  typedef itk::Image< itk::Vector< float, Dimension >, Dimension >  DeformationFieldType;
+  typedef itk::TransformToDisplacementFieldSource<
+    DeformationFieldType, ScalarType >                               DeformationFieldSourceType;
+
+  /** A B-spline transform with smoothly varying coefficients, on a grid
+   * that covers the square [0,64]^2.
+   */
+  BSplineTransformType::Pointer bsplineTransform = BSplineTransformType::New();
+  BSplineTransformType::RegionType gridRegion;
+  BSplineTransformType::SizeType   gridSize;
+  gridSize.Fill( 11 );
+  gridRegion.SetSize( gridSize );
+  BSplineTransformType::SpacingType gridSpacing;
+  gridSpacing.Fill( 8.0 );
+  BSplineTransformType::OriginType gridOrigin;
+  gridOrigin.Fill( -12.0 );
+  bsplineTransform->SetGridOrigin( gridOrigin );
+  bsplineTransform->SetGridSpacing( gridSpacing );
+  bsplineTransform->SetGridRegion( gridRegion );
+
+  BSplineTransformType::ParametersType parameters( bsplineTransform->GetNumberOfParameters() );
+  for( unsigned int i = 0; i < parameters.GetSize(); ++i )
+  {
+    parameters[ i ] = 2.0 * std::sin( 0.37 * i );
+  }
+  bsplineTransform->SetParametersByValue( parameters );
+
+  /** The initial transform, composed with the B-spline transform. */
+  TranslationTransformType::Pointer initialTransform = TranslationTransformType::New();
+  TranslationTransformType::ParametersType translation( Dimension );
+  translation[ 0 ] = 1.5;
+  translation[ 1 ] = -0.75;
+  initialTransform->SetParameters( translation );
+
+  TransformType::Pointer transform = TransformType::New();
+  transform->SetCurrentTransform( bsplineTransform );
+  transform->SetInitialTransform( initialTransform );
+  transform->SetUseComposition( true );
+
+  /** Set a smooth intermediary deformation field on [0,64]^2. */
+  VectorImageType::RegionType fieldRegion;
+  VectorImageType::SizeType   fieldSize;
+  fieldSize.Fill( 33 );
+  fieldRegion.SetSize( fieldSize );
+  VectorImageType::SpacingType fieldSpacing;
+  fieldSpacing.Fill( 2.0 );
+  VectorImageType::PointType fieldOrigin;
+  fieldOrigin.Fill( 0.0 );
+  transform->SetDeformationFieldRegion( fieldRegion );
+  transform->SetDeformationFieldSpacing( fieldSpacing );
+  transform->SetDeformationFieldOrigin( fieldOrigin );
+  transform->InitializeDeformationFields();
+
+  VectorImageType::Pointer field = VectorImageType::New();
+  field->SetRegions( fieldRegion );
+  field->SetSpacing( fieldSpacing );
+  field->SetOrigin( fieldOrigin );
+  field->Allocate();
+  itk::ImageRegionIteratorWithIndex< VectorImageType > fit( field, fieldRegion );
+  for( fit.GoToBegin(); !fit.IsAtEnd(); ++fit )
+  {
+    VectorImageType::PixelType vector;
+    vector[ 0 ] = 3.0 * std::cos( 0.2 * fit.GetIndex()[ 1 ] );
+    vector[ 1 ] = 2.0 * std::sin( 0.3 * fit.GetIndex()[ 0 ] );
+    fit.Set( vector );
+  }
+  transform->UpdateIntermediaryDeformationFieldTransform( field );
+
+  /** A combination transform with the regulizer as initial transform. */
+  TranslationTransformType::Pointer outerCurrentTransform = TranslationTransformType::New();
+  translation[ 0 ] = -0.5;
+  translation[ 1 ] = 1.25;
+  outerCurrentTransform->SetParameters( translation );
+  CombinationTransformType::Pointer outerTransform = CombinationTransformType::New();
+  outerTransform->SetCurrentTransform( outerCurrentTransform );
+  outerTransform->SetInitialTransform( transform );
+  outerTransform->SetUseComposition( true );
+
+  /** Points in the domain of the field. The number of points is not a
+   * multiple of the chunks in which the regulizer transforms its points.
+   */
+  const unsigned int            N = 1001;
+  std::vector< InputPointType > points( N );
+  for( unsigned int i = 0; i < N; ++i )
+  {
+    points[ i ][ 0 ] = 4.0 + 56.0 * std::fabs( std::sin( 1.3 * i ) );
+    points[ i ][ 1 ] = 4.0 + 56.0 * std::fabs( std::cos( 0.7 * i ) );
+  }
+
+  /** The reference: TransformPoint() of both transforms. Check that the
+   * field is actually taken into account.
+   */
+  std::vector< OutputPointType > referencePoints( N );
+  std::vector< OutputPointType > outerReferencePoints( N );
+  double                         fieldNorm = 0.0;
+  for( unsigned int i = 0; i < N; ++i )
+  {
+    referencePoints[ i ]      = transform->TransformPoint( points[ i ] );
+    outerReferencePoints[ i ] = outerTransform->TransformPoint( points[ i ] );
+    const OutputPointType withoutField = transform->CombinationTransformType::TransformPoint( points[ i ] );
+    fieldNorm += referencePoints[ i ].SquaredEuclideanDistanceTo( withoutField );
+  }
+  if( fieldNorm == 0.0 )
+  {
+    std::cerr << "ERROR: the intermediary deformation field has no effect." << std::endl;
+    return 1;
+  }
+
+  /** The batched transformation, also in-place. */
+  std::vector< OutputPointType > batchPoints( N );
+  std::vector< OutputPointType > outerBatchPoints( N );
+  std::vector< OutputPointType > inPlacePoints( points );
+  transform->TransformPoints( &points[ 0 ], &batchPoints[ 0 ], N );
+  outerTransform->TransformPoints( &points[ 0 ], &outerBatchPoints[ 0 ], N );
+  transform->TransformPoints( &inPlacePoints[ 0 ], &inPlacePoints[ 0 ], N );
+
+  for( unsigned int i = 0; i < N; ++i )
+  {
+    if( batchPoints[ i ].EuclideanDistanceTo( referencePoints[ i ] ) > 1e-10
+      || inPlacePoints[ i ].EuclideanDistanceTo( referencePoints[ i ] ) > 1e-10 )
+    {
+      std::cerr << "ERROR: TransformPoints() maps " << points[ i ] << " to "
+                << batchPoints[ i ] << " (in-place: " << inPlacePoints[ i ]
+                << "), while TransformPoint() gives " << referencePoints[ i ] << "." << std::endl;
+      return 1;
+    }
+    if( outerBatchPoints[ i ].EuclideanDistanceTo( outerReferencePoints[ i ] ) > 1e-10 )
+    {
+      std::cerr << "ERROR: as initial transform, TransformPoints() maps " << points[ i ]
+                << " to " << outerBatchPoints[ i ] << ", while TransformPoint() gives "
+                << outerReferencePoints[ i ] << "." << std::endl;
+      return 1;
+    }
+  }
+
+  /** The points on a line that is not aligned with the grid. */
+  InputPointType start;
+  start[ 0 ] = 3.25;
+  start[ 1 ] = 5.5;
+  InputVectorType step;
+  step[ 0 ] = 0.0577;
+  step[ 1 ] = 0.0311;
+  std::vector< OutputPointType > linePoints( N );
+  std::vector< OutputPointType > outerLinePoints( N );
+  transform->TransformPointsOnLine( start, step, &linePoints[ 0 ], N );
+  outerTransform->TransformPointsOnLine( start, step, &outerLinePoints[ 0 ], N );
+  for( unsigned int k = 0; k < N; ++k )
+  {
+    InputPointType point;
+    for( unsigned int i = 0; i < Dimension; ++i )
+    {
+      point[ i ] = start[ i ] + k * step[ i ];
+    }
+    const OutputPointType reference      = transform->TransformPoint( point );
+    const OutputPointType outerReference = outerTransform->TransformPoint( point );
+    if( linePoints[ k ].EuclideanDistanceTo( reference ) > 1e-10
+      || outerLinePoints[ k ].EuclideanDistanceTo( outerReference ) > 1e-10 )
+    {
+      std::cerr << "ERROR: TransformPointsOnLine() maps " << point << " to "
+                << linePoints[ k ] << " (as initial transform: " << outerLinePoints[ k ]
+                << "), while TransformPoint() gives " << reference << " ("
+                << outerReference << ")." << std::endl;
+      return 1;
+    }
+  }
+
+  /** The deformation field as generated by transformix, on a grid that is
+   * aligned with the grid of the B-spline transform, for both transforms.
+   */
+  DeformationFieldSourceType::SizeType outputSize;
+  outputSize[ 0 ] = 61;
+  outputSize[ 1 ] = 57;
+  DeformationFieldSourceType::SpacingType outputSpacing;
+  outputSpacing.Fill( 1.0 );
+  DeformationFieldSourceType::OriginType outputOrigin;
+  outputOrigin[ 0 ] = 1.5;
+  outputOrigin[ 1 ] = 2.0;
+  const CombinationTransformType * transforms[ 2 ] = { transform, outerTransform };
+  for( unsigned int t = 0; t < 2; ++t )
+  {
+    DeformationFieldSourceType::Pointer fieldSource = DeformationFieldSourceType::New();
+    fieldSource->SetTransform( transforms[ t ] );
+    fieldSource->SetOutputSize( outputSize );
+    fieldSource->SetOutputSpacing( outputSpacing );
+    fieldSource->SetOutputOrigin( outputOrigin );
+    fieldSource->Update();
+
+    DeformationFieldType * deformationField = fieldSource->GetOutput();
+    itk::ImageRegionIteratorWithIndex< DeformationFieldType > dit(
+      deformationField, deformationField->GetLargestPossibleRegion() );
+    for( dit.GoToBegin(); !dit.IsAtEnd(); ++dit )
+    {
+      DeformationFieldType::PointType point;
+      deformationField->TransformIndexToPhysicalPoint( dit.GetIndex(), point );
+      const OutputPointType reference = transforms[ t ]->TransformPoint( point );
+      for( unsigned int i = 0; i < Dimension; ++i )
+      {
+        if( std::fabs( dit.Get()[ i ] - ( reference[ i ] - point[ i ] ) ) > 1e-4 )
+        {
+          std::cerr << "ERROR: the deformation field of transform " << t << " at " << point
+                    << " is " << dit.Get() << ", while TransformPoint() gives "
+                    << reference << "." << std::endl;
+          return 1;
+        }
+      }
+    }
+  }
+
+  /** Return a value. */
+  return 0;
+
+} // end main
@@ -0,0 +1,184 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+/** \file
+ \brief Register corresponding points that are given in memory with the
+ ElastixFilter, with the CorrespondingPointsEuclideanDistanceMetric as the
+ only metric with a nonzero weight. The moving points are the fixed points
+ shifted by a known translation, which should be recovered. The result should
+ also be the same as when the points are given in point files.
+ */
+
+#include "elxElastixFilter.h"
+#include "elxParameterObject.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itksys/SystemTools.hxx"
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+//-------------------------------------------------------------------------------------
+
+int
+main( int argc, char * argv[] )
+{
+  /** Check. */
+  if( argc != 2 )
+  {
+    std::cerr << "ERROR: You should specify the output directory." << std::endl;
+    return 1;
+  }
+  const std::string outputDirectory = std::string( argv[ 1 ] ) + "/ElastixFilterPointSetTest/";
+  itksys::SystemTools::MakeDirectory( outputDirectory.c_str() );
+
+  const unsigned int Dimension = 2;
+  typedef itk::Image< float, Dimension >                    ImageType;
+  typedef elastix::ElastixFilter< ImageType, ImageType >    FilterType;
+  typedef FilterType::FixedPointSetType                     FixedPointSetType;
+  typedef FilterType::MovingPointSetType                    MovingPointSetType;
+  typedef elastix::ParameterObject                          ParameterObjectType;
+  typedef ParameterObjectType::ParameterMapType             ParameterMapType;
+  typedef ParameterObjectType::ParameterValueVectorType     ParameterValueVectorType;
+
+  /** The images are only needed to define the domain; they are a Gaussian blob. */
+  ImageType::Pointer image = ImageType::New();
+  ImageType::SizeType size;
+  size.Fill( 48 );
+  image->SetRegions( size );
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetBufferedRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+  {
+    const double x = it.GetIndex()[ 0 ] - 24.0;
+    const double y = it.GetIndex()[ 1 ] - 24.0;
+    it.Set( 100.0 * std::exp( -( x * x + y * y ) / 64.0 ) );
+  }
+
+  /** The moving points are the fixed points plus a translation. */
+  const double       translation[ Dimension ] = { 2.5, -1.75 };
+  const unsigned int numberOfPoints = 12;
+  FixedPointSetType::Pointer  fixedPointSet  = FixedPointSetType::New();
+  MovingPointSetType::Pointer movingPointSet = MovingPointSetType::New();
+  std::ofstream fixedPointFile( ( outputDirectory + "fixedpoints.txt" ).c_str() );
+  std::ofstream movingPointFile( ( outputDirectory + "movingpoints.txt" ).c_str() );
+  fixedPointFile << "point\n" << numberOfPoints << "\n" << std::setprecision( 17 );
+  movingPointFile << "point\n" << numberOfPoints << "\n" << std::setprecision( 17 );
+  for( unsigned int j = 0; j < numberOfPoints; ++j )
+  {
+    FixedPointSetType::PointType  fixedPoint;
+    MovingPointSetType::PointType movingPoint;
+    fixedPoint[ 0 ] = 8.0 + 30.0 * std::fabs( std::sin( 1.1 * j ) );
+    fixedPoint[ 1 ] = 8.0 + 30.0 * std::fabs( std::cos( 0.6 * j ) );
+    for( unsigned int i = 0; i < Dimension; ++i )
+    {
+      movingPoint[ i ] = fixedPoint[ i ] + translation[ i ];
+    }
+    fixedPointSet->SetPoint( j, fixedPoint );
+    movingPointSet->SetPoint( j, movingPoint );
+    fixedPointFile << fixedPoint[ 0 ] << " " << fixedPoint[ 1 ] << "\n";
+    movingPointFile << movingPoint[ 0 ] << " " << movingPoint[ 1 ] << "\n";
+  }
+  fixedPointFile.close();
+  movingPointFile.close();
+
+  /** A translation registration driven by the points only. */
+  ParameterMapType parameterMap = ParameterObjectType::GetDefaultParameterMap( "translation", 1 );
+  parameterMap[ "Registration" ] = ParameterValueVectorType( 1, "MultiMetricMultiResolutionRegistration" );
+  parameterMap[ "Metric" ].clear();
+  parameterMap[ "Metric" ].push_back( "AdvancedMeanSquares" );
+  parameterMap[ "Metric" ].push_back( "CorrespondingPointsEuclideanDistanceMetric" );
+  parameterMap[ "Metric0Weight" ]                    = ParameterValueVectorType( 1, "0.0" );
+  parameterMap[ "Metric1Weight" ]                    = ParameterValueVectorType( 1, "1.0" );
+  parameterMap[ "ImageSampler" ]                     = ParameterValueVectorType( 1, "Full" );
+  parameterMap[ "NewSamplesEveryIteration" ]         = ParameterValueVectorType( 1, "false" );
+  parameterMap[ "AutomaticTransformInitialization" ] = ParameterValueVectorType( 1, "false" );
+  parameterMap[ "Optimizer" ]                        = ParameterValueVectorType( 1, "RegularStepGradientDescent" );
+  parameterMap[ "MaximumStepLength" ]                = ParameterValueVectorType( 1, "1.0" );
+  parameterMap[ "MinimumStepLength" ]                = ParameterValueVectorType( 1, "0.0001" );
+  parameterMap[ "MaximumNumberOfIterations" ]        = ParameterValueVectorType( 1, "200" );
+  ParameterObjectType::Pointer parameterObject = ParameterObjectType::New();
+  parameterObject->SetParameterMap( parameterMap );
+
+  /** Register with the points in memory, and with the points in files. */
+  ParameterMapType transformParameterMaps[ 2 ];
+  for( unsigned int run = 0; run < 2; ++run )
+  {
+    FilterType::Pointer filter = FilterType::New();
+    filter->SetFixedImage( image );
+    filter->SetMovingImage( image );
+    filter->SetParameterObject( parameterObject );
+    filter->SetOutputDirectory( outputDirectory );
+    filter->LogToConsoleOff();
+    if( run == 0 )
+    {
+      filter->SetFixedPointSet( fixedPointSet );
+      filter->SetMovingPointSet( movingPointSet );
+    }
+    else
+    {
+      filter->SetFixedPointSetFileName( outputDirectory + "fixedpoints.txt" );
+      filter->SetMovingPointSetFileName( outputDirectory + "movingpoints.txt" );
+    }
+    try
+    {
+      filter->Update();
+    }
+    catch( itk::ExceptionObject & excp )
+    {
+      std::cerr << "ERROR: the registration of run " << run << " failed:\n" << excp << std::endl;
+      return 1;
+    }
+    transformParameterMaps[ run ] = filter->GetTransformParameterObject()->GetParameterMap( 0 );
+  }
+
+  /** Check the recovered translation. */
+  const ParameterValueVectorType & memoryParameters = transformParameterMaps[ 0 ][ "TransformParameters" ];
+  const ParameterValueVectorType & fileParameters   = transformParameterMaps[ 1 ][ "TransformParameters" ];
+  if( memoryParameters.size() != Dimension || fileParameters.size() != Dimension )
+  {
+    std::cerr << "ERROR: the transform parameter maps hold " << memoryParameters.size()
+              << " and " << fileParameters.size() << " transform parameters." << std::endl;
+    return 1;
+  }
+  for( unsigned int i = 0; i < Dimension; ++i )
+  {
+    const double memoryParameter = std::atof( memoryParameters[ i ].c_str() );
+    const double fileParameter   = std::atof( fileParameters[ i ].c_str() );
+    std::cerr << "Translation " << i << ": " << memoryParameter << " with points in memory, "
+              << fileParameter << " with point files, expected " << translation[ i ] << std::endl;
+    if( std::fabs( memoryParameter - translation[ i ] ) > 1e-2 )
+    {
+      std::cerr << "ERROR: the points in memory give a translation of " << memoryParameter
+                << " instead of " << translation[ i ] << "." << std::endl;
+      return 1;
+    }
+    if( std::fabs( memoryParameter - fileParameter ) > 1e-6 )
+    {
+      std::cerr << "ERROR: the points in memory give a translation of " << memoryParameter
+                << ", while the point files give " << fileParameter << "." << std::endl;
+      return 1;
+    }
+  }
+
+  /** Return a value. */
+  return 0;
+
+} // end main
@@ -0,0 +1,282 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+/** \file
+ \brief Register two different image pairs with one ElastixFilter that has
+ ReuseComponents switched on, and check that the second registration gives the
+ same result image and transform parameter map as a fresh ElastixFilter. The
+ number of lines in the iteration info file of the first resolution is
+ compared as well, to check that the iteration observers are not added twice.
+
+ This is done for a deterministic translation registration, and for a
+ B-spline registration with the RandomCoordinate sampler and the adaptive
+ stochastic gradient descent optimizer, on image pairs of different sizes.
+ The latter depends on the seed of the sampler, on the automatic parameter
+ estimation of the optimizer, and on the B-spline grid of each resolution,
+ which should all be set up again for the second pair.
+ */
+
+#include "elxElastixFilter.h"
+#include "elxParameterObject.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itksys/SystemTools.hxx"
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace
+{
+
+const unsigned int Dimension = 2;
+typedef float                                               PixelType;
+typedef itk::Image< PixelType, Dimension >                  ImageType;
+typedef elastix::ElastixFilter< ImageType, ImageType >      FilterType;
+typedef elastix::ParameterObject                            ParameterObjectType;
+typedef ParameterObjectType::ParameterMapType               ParameterMapType;
+typedef ParameterObjectType::ParameterValueVectorType       ParameterValueVectorType;
+
+/** Create an image of \a sizeX by \a sizeY voxels with an elongated
+ * Gaussian blob of value 100, centered at ( \a centerX, \a centerY ).
+ */
+ImageType::Pointer
+CreateImage( const unsigned int sizeX, const unsigned int sizeY,
+  const double centerX, const double centerY, const double width )
+{
+  ImageType::SizeType size;
+  size[ 0 ] = sizeX;
+  size[ 1 ] = sizeY;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( size );
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetBufferedRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+  {
+    const double x = it.GetIndex()[ 0 ] - centerX;
+    const double y = it.GetIndex()[ 1 ] - centerY;
+    it.Set( 100.0 * std::exp( -( x * x + 0.5 * y * y ) / width ) );
+  }
+  return image;
+
+} // end CreateImage()
+
+
+/** The result of a registration. */
+struct RegistrationResult
+{
+  ImageType::Pointer m_ResultImage;
+  ParameterMapType   m_TransformParameterMap;
+  unsigned int       m_NumberOfIterationInfoLines;
+};
+
+/** Register an image pair with \a filter, and collect the results. Returns 1
+ * on failure.
+ */
+int
+Register( FilterType * filter, ImageType * fixedImage, ImageType * movingImage,
+  const std::string & outputDirectory, RegistrationResult & result )
+{
+  filter->SetFixedImage( fixedImage );
+  filter->SetMovingImage( movingImage );
+  try
+  {
+    filter->Update();
+  }
+  catch( itk::ExceptionObject & excp )
+  {
+    std::cerr << "ERROR: the registration failed:\n" << excp << std::endl;
+    return 1;
+  }
+
+  result.m_ResultImage = filter->GetOutput();
+  result.m_ResultImage->DisconnectPipeline();
+  result.m_TransformParameterMap = filter->GetTransformParameterObject()->GetParameterMap( 0 );
+
+  /** The iteration info file of the first resolution is closed when the
+   * second resolution starts, so it is complete.
+   */
+  std::ifstream iterationInfoFile( ( outputDirectory + "IterationInfo.0.R0.txt" ).c_str() );
+  std::string   line;
+  result.m_NumberOfIterationInfoLines = 0;
+  while( std::getline( iterationInfoFile, line ) )
+  {
+    if( !line.empty() )
+    {
+      ++result.m_NumberOfIterationInfoLines;
+    }
+  }
+  return 0;
+
+} // end Register()
+
+
+/** Register both image pairs with one filter that reuses its components,
+ * and the second pair with a fresh filter, and compare. Returns 1 on failure.
+ */
+int
+CompareReusedWithFresh( const char * name, const ParameterMapType & parameterMap,
+  ImageType::Pointer fixedImages[ 2 ], ImageType::Pointer movingImages[ 2 ],
+  const std::string & outputDirectory )
+{
+  std::cerr << "Registration: " << name << std::endl;
+  ParameterObjectType::Pointer parameterObject = ParameterObjectType::New();
+  parameterObject->SetParameterMap( parameterMap );
+
+  /** Register both pairs with components that are reused. */
+  FilterType::Pointer reusingFilter = FilterType::New();
+  reusingFilter->SetParameterObject( parameterObject );
+  reusingFilter->SetOutputDirectory( outputDirectory );
+  reusingFilter->LogToConsoleOff();
+  reusingFilter->ReuseComponentsOn();
+
+  RegistrationResult reusedResults[ 2 ];
+  for( unsigned int i = 0; i < 2; ++i )
+  {
+    if( Register( reusingFilter, fixedImages[ i ], movingImages[ i ], outputDirectory, reusedResults[ i ] ) )
+    {
+      return 1;
+    }
+  }
+
+  /** Register the second pair with a fresh filter. */
+  FilterType::Pointer freshFilter = FilterType::New();
+  freshFilter->SetParameterObject( parameterObject );
+  freshFilter->SetOutputDirectory( outputDirectory );
+  freshFilter->LogToConsoleOff();
+
+  RegistrationResult freshResult;
+  if( Register( freshFilter, fixedImages[ 1 ], movingImages[ 1 ], outputDirectory, freshResult ) )
+  {
+    return 1;
+  }
+
+  /** The reused components should not carry over parameters from the first run. */
+  if( reusedResults[ 1 ].m_TransformParameterMap != freshResult.m_TransformParameterMap )
+  {
+    std::cerr << "ERROR: the transform parameter map of the second run differs from a fresh run:" << std::endl;
+    ParameterMapType::const_iterator it;
+    for( it = freshResult.m_TransformParameterMap.begin(); it != freshResult.m_TransformParameterMap.end(); ++it )
+    {
+      ParameterMapType::const_iterator reusedIt = reusedResults[ 1 ].m_TransformParameterMap.find( it->first );
+      if( reusedIt == reusedResults[ 1 ].m_TransformParameterMap.end() || reusedIt->second != it->second )
+      {
+        std::cerr << "  " << it->first << std::endl;
+      }
+    }
+    return 1;
+  }
+  if( reusedResults[ 1 ].m_TransformParameterMap[ "TransformParameters" ]
+    == reusedResults[ 0 ].m_TransformParameterMap[ "TransformParameters" ] )
+  {
+    std::cerr << "ERROR: both image pairs give the same transform parameters." << std::endl;
+    return 1;
+  }
+
+  /** The result images should be identical. */
+  typedef itk::ImageRegionConstIterator< ImageType > IteratorType;
+  IteratorType rit( reusedResults[ 1 ].m_ResultImage, reusedResults[ 1 ].m_ResultImage->GetBufferedRegion() );
+  IteratorType fit( freshResult.m_ResultImage, freshResult.m_ResultImage->GetBufferedRegion() );
+  for( rit.GoToBegin(), fit.GoToBegin(); !rit.IsAtEnd(); ++rit, ++fit )
+  {
+    if( rit.Get() != fit.Get() )
+    {
+      std::cerr << "ERROR: the result image of the second run is " << rit.Get()
+                << " at " << rit.GetIndex() << " instead of " << fit.Get() << "." << std::endl;
+      return 1;
+    }
+  }
+
+  /** Duplicated iteration observers would write every iteration twice. */
+  if( reusedResults[ 1 ].m_NumberOfIterationInfoLines != freshResult.m_NumberOfIterationInfoLines )
+  {
+    std::cerr << "ERROR: the iteration info of the second run has "
+              << reusedResults[ 1 ].m_NumberOfIterationInfoLines << " lines instead of "
+              << freshResult.m_NumberOfIterationInfoLines << "." << std::endl;
+    return 1;
+  }
+  return 0;
+
+} // end CompareReusedWithFresh()
+
+
+} // end namespace
+
+//-------------------------------------------------------------------------------------
+
+int
+main( int argc, char * argv[] )
+{
+  /** Check. */
+  if( argc != 2 )
+  {
+    std::cerr << "ERROR: You should specify the output directory." << std::endl;
+    return 1;
+  }
+  const std::string outputDirectory = std::string( argv[ 1 ] ) + "/ElastixFilterReuseComponentsTest/";
+  itksys::SystemTools::MakeDirectory( outputDirectory.c_str() );
+
+  /** A deterministic translation registration in two resolutions, of two
+   * image pairs of the same size with a blob, shifted differently.
+   */
+  ImageType::Pointer fixedImages[ 2 ];
+  ImageType::Pointer movingImages[ 2 ];
+  fixedImages[ 0 ]  = CreateImage( 48, 48, 24.0, 24.0, 64.0 );
+  movingImages[ 0 ] = CreateImage( 48, 48, 27.0, 27.0, 64.0 );
+  fixedImages[ 1 ]  = CreateImage( 48, 48, 22.0, 22.0, 48.0 );
+  movingImages[ 1 ] = CreateImage( 48, 48, 25.5, 25.5, 48.0 );
+
+  ParameterMapType translationMap = ParameterObjectType::GetDefaultParameterMap( "translation", 2 );
+  translationMap[ "Metric" ]                    = ParameterValueVectorType( 1, "AdvancedMeanSquares" );
+  translationMap[ "ImageSampler" ]              = ParameterValueVectorType( 1, "Full" );
+  translationMap[ "NewSamplesEveryIteration" ]  = ParameterValueVectorType( 1, "false" );
+  translationMap[ "Optimizer" ]                 = ParameterValueVectorType( 1, "RegularStepGradientDescent" );
+  translationMap[ "MaximumNumberOfIterations" ] = ParameterValueVectorType( 1, "40" );
+  translationMap[ "WriteIterationInfo" ]        = ParameterValueVectorType( 1, "true" );
+  if( CompareReusedWithFresh( "translation", translationMap, fixedImages, movingImages, outputDirectory ) )
+  {
+    return 1;
+  }
+
+  /** A stochastic B-spline registration in two resolutions, of two image
+   * pairs of different sizes, so that the pyramids and the B-spline grids
+   * differ between the runs.
+   */
+  fixedImages[ 0 ]  = CreateImage( 48, 48, 24.0, 24.0, 64.0 );
+  movingImages[ 0 ] = CreateImage( 48, 48, 26.0, 23.0, 80.0 );
+  fixedImages[ 1 ]  = CreateImage( 40, 56, 20.0, 28.0, 48.0 );
+  movingImages[ 1 ] = CreateImage( 40, 56, 21.5, 30.0, 56.0 );
+
+  ParameterMapType bsplineMap = ParameterObjectType::GetDefaultParameterMap( "bspline", 2, 8.0 );
+  bsplineMap[ "ImageSampler" ]                 = ParameterValueVectorType( 1, "RandomCoordinate" );
+  bsplineMap[ "NewSamplesEveryIteration" ]     = ParameterValueVectorType( 1, "true" );
+  bsplineMap[ "NumberOfSpatialSamples" ]       = ParameterValueVectorType( 1, "500" );
+  bsplineMap[ "Optimizer" ]                    = ParameterValueVectorType( 1, "AdaptiveStochasticGradientDescent" );
+  bsplineMap[ "AutomaticParameterEstimation" ] = ParameterValueVectorType( 1, "true" );
+  bsplineMap[ "MaximumNumberOfIterations" ]    = ParameterValueVectorType( 1, "50" );
+  bsplineMap[ "WriteIterationInfo" ]           = ParameterValueVectorType( 1, "true" );
+  if( CompareReusedWithFresh( "B-spline", bsplineMap, fixedImages, movingImages, outputDirectory ) )
+  {
+    return 1;
+  }
+
+  /** Return a value. */
+  return 0;
+
+} // end main
@@ -0,0 +1,252 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+/** \file
+ \brief Check the multi-threaded groupwise metrics VarianceOverLastDimension,
+ PCAMetric2 and SumOfPairwiseCorrelationCoefficients on a small 3D+t image.
+ Their value is compared with the original single-threaded GetValue(), and
+ their derivative with central finite differences of that value. A cubic
+ interpolator makes the value smooth enough for the finite differences.
+ VarianceOverLastDimension is tested with and without
+ SampleLastDimensionRandomly.
+ */
+
+#include "elxMacro.h"
+#include "xoutmain.h"
+
+#include "VarianceOverLastDimension/itkVarianceOverLastDimensionImageMetric.h"
+#include "PCAMetric2/itkPCAMetric2.h"
+#include "SumOfPairwiseCorrelationsMetric/itkSumOfPairwiseCorrelationCoefficientsMetric.h"
+#include "itkAdvancedBSplineDeformableTransform.h"
+#include "itkReducedDimensionBSplineInterpolateImageFunction.h"
+#include "itkImageGridSampler.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkRandomVariateGeneratorInstance.h"
+
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+
+const unsigned int Dimension   = 4;
+const unsigned int SplineOrder = 3;
+typedef float                                          PixelType;
+typedef double                                         CoordinateRepresentationType;
+typedef itk::Image< PixelType, Dimension >             ImageType;
+typedef itk::AdvancedBSplineDeformableTransform<
+  CoordinateRepresentationType, Dimension, SplineOrder > TransformType;
+typedef itk::ReducedDimensionBSplineInterpolateImageFunction<
+  ImageType, CoordinateRepresentationType, double >      InterpolatorType;
+typedef itk::ImageGridSampler< ImageType >              SamplerType;
+typedef TransformType::ParametersType                   ParametersType;
+
+typedef itk::VarianceOverLastDimensionImageMetric<
+  ImageType, ImageType >                                VarianceMetricType;
+typedef itk::PCAMetric2< ImageType, ImageType >         PCAMetricType;
+typedef itk::SumOfPairwiseCorrelationCoefficientsMetric<
+  ImageType, ImageType >                                CorrelationMetricType;
+
+/** Only VarianceOverLastDimension can sample the last dimension randomly. */
+template< class TMetric >
+void
+SetSampleLastDimensionRandomly( TMetric *, const bool )
+{}
+
+void
+SetSampleLastDimensionRandomly( VarianceMetricType * metric, const bool random )
+{
+  metric->SetSampleLastDimensionRandomly( random );
+  metric->SetNumSamplesLastDimension( 3 );
+  metric->SetNumAdditionalSamplesFixed( 0 );
+  metric->SetReducedDimensionIndex( 0 );
+}
+
+
+/** Compute the value and derivative of a metric of type TMetric with
+ * multi-threading, and compare them with the value of the single-threaded
+ * metric and its finite differences. The random generator is reset before
+ * each evaluation, so that a random sampling of the last dimension gives the
+ * same positions. Returns 1 on failure.
+ */
+template< class TMetric >
+int
+CheckThreadedMetric( const char * name,
+  ImageType * image, TransformType * transform,
+  const ParametersType & parameters, const bool sampleLastDimensionRandomly )
+{
+  typedef typename TMetric::MeasureType    MeasureType;
+  typedef typename TMetric::DerivativeType DerivativeType;
+
+  /** Sample the first time point only; the metrics loop over the last dimension. */
+  SamplerType::SampleGridSpacingType gridSpacing;
+  gridSpacing.Fill( 2 );
+  gridSpacing[ Dimension - 1 ] = static_cast< SamplerType::SampleGridSpacingValueType >(
+    image->GetLargestPossibleRegion().GetSize( Dimension - 1 ) );
+
+  InterpolatorType::Pointer interpolator = InterpolatorType::New();
+  interpolator->SetSplineOrder( 3 );
+
+  typename TMetric::Pointer metrics[ 2 ];
+  MeasureType               values[ 2 ];
+  DerivativeType            derivative;
+  for( unsigned int m = 0; m < 2; ++m )
+  {
+    SamplerType::Pointer sampler = SamplerType::New();
+    sampler->SetSampleGridSpacing( gridSpacing );
+
+    typename TMetric::Pointer metric = TMetric::New();
+    metrics[ m ] = metric;
+    metric->SetFixedImage( image );
+    metric->SetMovingImage( image );
+    metric->SetFixedImageRegion( image->GetBufferedRegion() );
+    metric->SetTransform( transform );
+    metric->SetInterpolator( interpolator );
+    metric->SetImageSampler( sampler );
+    metric->SetUseMultiThread( m == 1 );
+    metric->SetNumberOfThreads( 3 );
+    SetSampleLastDimensionRandomly( metric.GetPointer(), sampleLastDimensionRandomly );
+    metric->Initialize();
+  }
+
+  /** The value of the original single-threaded code, and the value and
+   * derivative of the multi-threaded code.
+   */
+  itk::RandomVariateGeneratorInstance::Get()->Initialize( 121212 );
+  values[ 0 ] = metrics[ 0 ]->GetValue( parameters );
+  itk::RandomVariateGeneratorInstance::Get()->Initialize( 121212 );
+  derivative.SetSize( transform->GetNumberOfParameters() );
+  metrics[ 1 ]->GetValueAndDerivative( parameters, values[ 1 ], derivative );
+
+  std::cerr << name << ( sampleLastDimensionRandomly ? " (random last dimension)" : "" )
+            << ": value " << values[ 0 ] << ", |derivative| "
+            << derivative.magnitude() << std::endl;
+  if( std::abs( values[ 0 ] - values[ 1 ] ) > 1e-6 * ( 1.0 + std::abs( values[ 0 ] ) ) )
+  {
+    std::cerr << "ERROR: the multi-threaded value is " << values[ 1 ]
+              << " instead of " << values[ 0 ] << "." << std::endl;
+    return 1;
+  }
+
+  /** Central differences for every fifth parameter. The values are summed
+   * in single precision by some of the metrics, hence the tolerance.
+   */
+  const double maxDerivative = derivative.inf_norm();
+  if( maxDerivative == 0.0 )
+  {
+    std::cerr << "ERROR: the multi-threaded derivative is zero." << std::endl;
+    return 1;
+  }
+  const double   delta = 1e-3;
+  ParametersType perturbedParameters( parameters );
+  for( unsigned int j = 0; j < parameters.GetSize(); j += 5 )
+  {
+    perturbedParameters[ j ] = parameters[ j ] + delta;
+    itk::RandomVariateGeneratorInstance::Get()->Initialize( 121212 );
+    const double valuePlus = metrics[ 0 ]->GetValue( perturbedParameters );
+    perturbedParameters[ j ] = parameters[ j ] - delta;
+    itk::RandomVariateGeneratorInstance::Get()->Initialize( 121212 );
+    const double valueMinus = metrics[ 0 ]->GetValue( perturbedParameters );
+    perturbedParameters[ j ] = parameters[ j ];
+
+    const double finiteDifference = ( valuePlus - valueMinus ) / ( 2.0 * delta );
+    if( std::abs( derivative[ j ] - finiteDifference ) > 1e-2 * maxDerivative )
+    {
+      std::cerr << "ERROR: derivative " << j << " is " << derivative[ j ]
+                << ", while the finite difference is " << finiteDifference
+                << " and the largest element is " << maxDerivative << "." << std::endl;
+      transform->SetParameters( parameters );
+      return 1;
+    }
+  }
+
+  /** The transform refers to the parameters of the last call. */
+  transform->SetParameters( parameters );
+  return 0;
+
+} // end CheckThreadedMetric()
+
+
+} // end namespace
+
+//-------------------------------------------------------------------------------------
+
+int
+main( void )
+{
+  /** A small 3D+t image with a blob, and a B-spline transform that deforms
+   * it differently over time.
+   */
+  ImageType::SizeType imageSize;
+  imageSize.Fill( 12 );
+  imageSize[ Dimension - 1 ] = 5;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( imageSize );
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetBufferedRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+  {
+    double r2 = 0.0;
+    for( unsigned int d = 0; d < Dimension; ++d )
+    {
+      const double x = ( it.GetIndex()[ d ] - 0.5 * imageSize[ d ] - 1.0 ) / ( d + 1.0 );
+      r2 += x * x;
+    }
+    it.Set( 100.0 * std::exp( -r2 / 16.0 ) );
+  }
+
+  /** The B-spline grid has 5 control points per dimension, and covers the
+   * image with one control point outside at either side.
+   */
+  TransformType::Pointer    transform = TransformType::New();
+  TransformType::RegionType gridRegion;
+  TransformType::SizeType   gridSize;
+  gridSize.Fill( 5 );
+  gridRegion.SetSize( gridSize );
+  TransformType::SpacingType gridSpacing;
+  TransformType::OriginType  gridOrigin;
+  for( unsigned int d = 0; d < Dimension; ++d )
+  {
+    gridSpacing[ d ] = imageSize[ d ] / 2.0;
+    gridOrigin[ d ]  = -1.5 * gridSpacing[ d ];
+  }
+  transform->SetGridOrigin( gridOrigin );
+  transform->SetGridSpacing( gridSpacing );
+  transform->SetGridRegion( gridRegion );
+  const unsigned int numberOfParameters = transform->GetNumberOfParameters();
+  ParametersType     parameters( numberOfParameters );
+  for( unsigned int j = 0; j < numberOfParameters; ++j )
+  {
+    parameters[ j ] = 0.3 * std::sin( 0.7 * j );
+  }
+  transform->SetParameters( parameters );
+
+  /** Check all metrics. */
+  int result = 0;
+  result |= CheckThreadedMetric< VarianceMetricType >(
+    "VarianceOverLastDimension", image, transform, parameters, false );
+  result |= CheckThreadedMetric< VarianceMetricType >(
+    "VarianceOverLastDimension", image, transform, parameters, true );
+  result |= CheckThreadedMetric< PCAMetricType >(
+    "PCAMetric2", image, transform, parameters, false );
+  result |= CheckThreadedMetric< CorrelationMetricType >(
+    "SumOfPairwiseCorrelationCoefficients", image, transform, parameters, false );
+
+  /** Return a value. */
+  return result;
+
+} // end main
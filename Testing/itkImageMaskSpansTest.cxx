@@ -0,0 +1,353 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+/** \file
+ \brief Check that ImageMaskSpans enumerates exactly the voxels of a region
+ that are inside a mask, in scanline order, for several numbers of threads.
+ Also check that the multi-threaded random samplers give the same samples
+ within a mask for one and for several threads, when started from the same
+ seed. The samples of the multi-threaded path and of the serial path, which
+ rejects the candidates outside the mask, should all be inside the mask, have
+ the requested number, and hold the interpolated image value. Since the two
+ paths draw different random numbers, their samples are compared by the mean
+ and the variance of the coordinates and the values.
+ */
+
+#include "itkImageMaskSpans.h"
+#include "itkImageRandomSampler.h"
+#include "itkImageRandomCoordinateSampler.h"
+#include "itkImageMaskSpatialObject.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkBSplineInterpolateImageFunction.h"
+#include "itkRandomVariateGeneratorInstance.h"
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+
+const unsigned int Dimension = 3;
+typedef float                                     PixelType;
+typedef unsigned char                             MaskPixelType;
+typedef itk::Image< PixelType, Dimension >        ImageType;
+typedef itk::Image< MaskPixelType, Dimension >    MaskImageType;
+typedef itk::ImageMaskSpatialObject< Dimension >  MaskType;
+typedef itk::ImageMaskSpans< ImageType >          MaskSpansType;
+typedef ImageType::RegionType                     RegionType;
+typedef ImageType::IndexType                      IndexType;
+typedef itk::BSplineInterpolateImageFunction<
+  ImageType, double, double >                     ReferenceInterpolatorType;
+
+/** Draw \a numberOfSamples samples with a sampler of type TSampler within
+ * the mask, starting from a fixed seed. The serial path is used when
+ * \a numberOfThreads is zero.
+ */
+template< class TSampler >
+typename TSampler::ImageSampleContainerPointer
+DrawSamples( ImageType * image, MaskType * mask, const itk::ThreadIdType numberOfThreads,
+  const unsigned long numberOfSamples = 1000 )
+{
+  typename TSampler::Pointer sampler = TSampler::New();
+  sampler->SetInput( image );
+  sampler->SetMask( mask );
+  sampler->SetNumberOfSamples( numberOfSamples );
+  sampler->SetUseMultiThread( numberOfThreads > 0 );
+  if( numberOfThreads > 0 )
+  {
+    sampler->SetNumberOfThreads( numberOfThreads );
+  }
+
+  itk::RandomVariateGeneratorInstance::Get()->Initialize( 343434 );
+  sampler->Update();
+
+  return sampler->GetOutput();
+
+} // end DrawSamples()
+
+
+/** Compare the samples drawn with one and with several threads, and check
+ * that they are inside the mask. Returns 1 on failure.
+ */
+template< class TSampler >
+int
+CompareSamplers( const char * name, ImageType * image, MaskType * mask )
+{
+  typedef typename TSampler::ImageSampleContainerPointer ImageSampleContainerPointer;
+
+  ImageSampleContainerPointer samples[ 2 ];
+  samples[ 0 ] = DrawSamples< TSampler >( image, mask, 1 );
+  samples[ 1 ] = DrawSamples< TSampler >( image, mask, 4 );
+
+  if( samples[ 0 ]->Size() != 1000 || samples[ 1 ]->Size() != 1000 )
+  {
+    std::cerr << "ERROR: the " << name << " drew " << samples[ 0 ]->Size() << " and "
+              << samples[ 1 ]->Size() << " samples instead of 1000." << std::endl;
+    return 1;
+  }
+  for( unsigned long i = 0; i < samples[ 0 ]->Size(); ++i )
+  {
+    const typename TSampler::ImageSampleType & sample0 = samples[ 0 ]->ElementAt( i );
+    const typename TSampler::ImageSampleType & sample1 = samples[ 1 ]->ElementAt( i );
+    if( sample0.m_ImageCoordinates != sample1.m_ImageCoordinates
+      || sample0.m_ImageValue != sample1.m_ImageValue )
+    {
+      std::cerr << "ERROR: sample " << i << " of the " << name << " is "
+                << sample1.m_ImageCoordinates << " with 4 threads, and "
+                << sample0.m_ImageCoordinates << " with 1 thread." << std::endl;
+      return 1;
+    }
+    if( !mask->IsInside( sample0.m_ImageCoordinates ) )
+    {
+      std::cerr << "ERROR: sample " << i << " of the " << name << " at "
+                << sample0.m_ImageCoordinates << " is outside the mask." << std::endl;
+      return 1;
+    }
+  }
+  return 0;
+
+} // end CompareSamplers()
+
+
+/** Check that the samples are inside the mask, have the requested number,
+ * and hold the value of the B-spline interpolator, which reproduces the
+ * voxel values. The mean and variance of the coordinates and of the values
+ * are returned in \a moments, in the order x, y, z, value. Returns 1 on
+ * failure.
+ */
+template< class TSampler >
+int
+CheckSamples( const char * name, const typename TSampler::ImageSampleContainerType * samples,
+  const unsigned long numberOfSamples, MaskType * mask,
+  const ReferenceInterpolatorType * interpolator, double moments[ 2 ][ Dimension + 1 ] )
+{
+  if( samples->Size() != numberOfSamples )
+  {
+    std::cerr << "ERROR: the " << name << " drew " << samples->Size()
+              << " samples instead of " << numberOfSamples << "." << std::endl;
+    return 1;
+  }
+
+  for( unsigned int d = 0; d <= Dimension; ++d )
+  {
+    moments[ 0 ][ d ] = 0.0;
+    moments[ 1 ][ d ] = 0.0;
+  }
+  for( unsigned long i = 0; i < samples->Size(); ++i )
+  {
+    const typename TSampler::ImageSampleType & sample = samples->ElementAt( i );
+    if( !mask->IsInside( sample.m_ImageCoordinates ) )
+    {
+      std::cerr << "ERROR: sample " << i << " of the " << name << " at "
+                << sample.m_ImageCoordinates << " is outside the mask." << std::endl;
+      return 1;
+    }
+    const double value = interpolator->Evaluate( sample.m_ImageCoordinates );
+    if( std::fabs( sample.m_ImageValue - value ) > 1e-3 )
+    {
+      std::cerr << "ERROR: sample " << i << " of the " << name << " at "
+                << sample.m_ImageCoordinates << " has value " << sample.m_ImageValue
+                << " instead of " << value << "." << std::endl;
+      return 1;
+    }
+    for( unsigned int d = 0; d <= Dimension; ++d )
+    {
+      const double x = d < Dimension ? sample.m_ImageCoordinates[ d ] : sample.m_ImageValue;
+      moments[ 0 ][ d ] += x;
+      moments[ 1 ][ d ] += x * x;
+    }
+  }
+  for( unsigned int d = 0; d <= Dimension; ++d )
+  {
+    moments[ 0 ][ d ] /= numberOfSamples;
+    moments[ 1 ][ d ]  = moments[ 1 ][ d ] / numberOfSamples - moments[ 0 ][ d ] * moments[ 0 ][ d ];
+  }
+  return 0;
+
+} // end CheckSamples()
+
+
+/** Compare the samples of the multi-threaded path with those of the serial
+ * path. The means should agree within five standard errors, and the
+ * variances within 10 percent. Returns 1 on failure.
+ */
+template< class TSampler >
+int
+CompareWithSerialSampler( const char * name, ImageType * image, MaskType * mask )
+{
+  const unsigned long numberOfSamples = 20000;
+
+  ReferenceInterpolatorType::Pointer interpolator = ReferenceInterpolatorType::New();
+  interpolator->SetSplineOrder( 3 );
+  interpolator->SetInputImage( image );
+
+  double moments[ 2 ][ 2 ][ Dimension + 1 ];
+  if( CheckSamples< TSampler >( name, DrawSamples< TSampler >( image, mask, 0, numberOfSamples ),
+    numberOfSamples, mask, interpolator, moments[ 0 ] )
+    || CheckSamples< TSampler >( name, DrawSamples< TSampler >( image, mask, 4, numberOfSamples ),
+    numberOfSamples, mask, interpolator, moments[ 1 ] ) )
+  {
+    return 1;
+  }
+
+  for( unsigned int d = 0; d <= Dimension; ++d )
+  {
+    const double standardError = std::sqrt(
+      ( moments[ 0 ][ 1 ][ d ] + moments[ 1 ][ 1 ][ d ] ) / numberOfSamples );
+    if( std::fabs( moments[ 1 ][ 0 ][ d ] - moments[ 0 ][ 0 ][ d ] ) > 5.0 * standardError
+      || std::fabs( moments[ 1 ][ 1 ][ d ] - moments[ 0 ][ 1 ][ d ] ) > 0.1 * moments[ 0 ][ 1 ][ d ] )
+    {
+      std::cerr << "ERROR: the " << name << " gives mean " << moments[ 1 ][ 0 ][ d ]
+                << " and variance " << moments[ 1 ][ 1 ][ d ] << " for component " << d
+                << " with 4 threads, and mean " << moments[ 0 ][ 0 ][ d ] << " and variance "
+                << moments[ 0 ][ 1 ][ d ] << " in the serial path." << std::endl;
+      return 1;
+    }
+  }
+  return 0;
+
+} // end CompareWithSerialSampler()
+
+
+} // end namespace
+
+//-------------------------------------------------------------------------------------
+
+int
+main( void )
+{
+  /** Create an image with a non-trivial spacing and origin, and a mask on
+   * the same grid: a ball with a regular pattern of holes, so that the
+   * scanlines consist of many spans.
+   */
+  ImageType::SizeType imageSize;
+  imageSize[ 0 ] = 24;
+  imageSize[ 1 ] = 20;
+  imageSize[ 2 ] = 16;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( imageSize );
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > iit( image, image->GetBufferedRegion() );
+  for( iit.GoToBegin(); !iit.IsAtEnd(); ++iit )
+  {
+    double r2 = 0.0;
+    for( unsigned int d = 0; d < Dimension; ++d )
+    {
+      const double x = iit.GetIndex()[ d ] - 0.5 * imageSize[ d ];
+      r2 += x * x;
+    }
+    iit.Set( static_cast< PixelType >( 100.0 * std::exp( -r2 / 32.0 ) ) );
+  }
+  ImageType::SpacingType spacing;
+  ImageType::PointType   origin;
+  for( unsigned int d = 0; d < Dimension; ++d )
+  {
+    spacing[ d ] = 0.5 + 0.25 * d;
+    origin[ d ]  = 10.0 - 2.0 * d;
+  }
+  image->SetSpacing( spacing );
+  image->SetOrigin( origin );
+
+  MaskImageType::Pointer maskImage = MaskImageType::New();
+  maskImage->CopyInformation( image );
+  maskImage->SetRegions( image->GetLargestPossibleRegion() );
+  maskImage->Allocate();
+  itk::ImageRegionIteratorWithIndex< MaskImageType > mit( maskImage, maskImage->GetBufferedRegion() );
+  for( mit.GoToBegin(); !mit.IsAtEnd(); ++mit )
+  {
+    const IndexType & index = mit.GetIndex();
+    double            r2    = 0.0;
+    for( unsigned int d = 0; d < Dimension; ++d )
+    {
+      const double x = ( index[ d ] - 0.5 * imageSize[ d ] ) / imageSize[ d ];
+      r2 += x * x;
+    }
+    const bool hole = ( index[ 0 ] + 2 * index[ 1 ] + 3 * index[ 2 ] ) % 7 == 0;
+    mit.Set( r2 < 0.16 && !hole ? 1 : 0 );
+  }
+  MaskType::Pointer mask = MaskType::New();
+  mask->SetImage( maskImage );
+
+  /** A region that cuts through the mask. */
+  RegionType region;
+  region.SetIndex( 0, 3 );
+  region.SetIndex( 1, 2 );
+  region.SetIndex( 2, 1 );
+  region.SetSize( 0, 17 );
+  region.SetSize( 1, 15 );
+  region.SetSize( 2, 13 );
+
+  /** The inside voxels of the region, in scanline order. */
+  std::vector< IndexType >                          insideVoxels;
+  itk::ImageRegionConstIteratorWithIndex< ImageType > it( image, region );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+  {
+    ImageType::PointType point;
+    image->TransformIndexToPhysicalPoint( it.GetIndex(), point );
+    if( mask->IsInside( point ) )
+    {
+      insideVoxels.push_back( it.GetIndex() );
+    }
+  }
+
+  /** Compare the spans with the inside voxels, for several numbers of threads. */
+  const itk::ThreadIdType numbersOfThreads[ 3 ] = { 1, 3, 8 };
+  for( unsigned int t = 0; t < 3; ++t )
+  {
+    MaskSpansType::Pointer spans = MaskSpansType::New();
+    spans->Compute( mask, image, region, numbersOfThreads[ t ] );
+    if( spans->GetNumberOfInsideVoxels() != insideVoxels.size() )
+    {
+      std::cerr << "ERROR: with " << numbersOfThreads[ t ] << " threads, the spans hold "
+                << spans->GetNumberOfInsideVoxels() << " voxels instead of "
+                << insideVoxels.size() << "." << std::endl;
+      return 1;
+    }
+    for( itk::SizeValueType k = 0; k < insideVoxels.size(); ++k )
+    {
+      IndexType index;
+      spans->GetInsideVoxel( k, index );
+      if( index != insideVoxels[ k ] )
+      {
+        std::cerr << "ERROR: with " << numbersOfThreads[ t ] << " threads, inside voxel "
+                  << k << " is " << index << " instead of " << insideVoxels[ k ]
+                  << "." << std::endl;
+        return 1;
+      }
+    }
+  }
+  std::cerr << "Number of inside voxels: " << insideVoxels.size() << std::endl;
+
+  /** Compare the samples of the masked samplers for one and several threads. */
+  int result = 0;
+  result |= CompareSamplers< itk::ImageRandomSampler< ImageType > >(
+    "ImageRandomSampler", image, mask );
+  result |= CompareSamplers< itk::ImageRandomCoordinateSampler< ImageType > >(
+    "ImageRandomCoordinateSampler", image, mask );
+
+  /** Compare the multi-threaded samplers with their serial path. */
+  result |= CompareWithSerialSampler< itk::ImageRandomSampler< ImageType > >(
+    "ImageRandomSampler", image, mask );
+  result |= CompareWithSerialSampler< itk::ImageRandomCoordinateSampler< ImageType > >(
+    "ImageRandomCoordinateSampler", image, mask );
+
+  /** Return a value. */
+  return result;
+
+} // end main
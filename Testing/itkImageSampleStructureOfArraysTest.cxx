@@ -0,0 +1,295 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+/** \file
+ \brief Check that the structure of arrays output of an image sampler holds
+ the same coordinates and values as its sample container, with the continuous
+ indices of the samples and aligned arrays. Also check that the advanced mean
+ squares metric with UseStructureOfArraysSamples gives the value of a brute
+ force computation over the samples, and the derivative of the metric that
+ reads the sample container, also after the samples were changed in place.
+ */
+
+#include "elxMacro.h"
+#include "xoutmain.h"
+
+#include "AdvancedMeanSquares/itkAdvancedMeanSquaresImageToImageMetric.h"
+#include "itkAdvancedBSplineDeformableTransform.h"
+#include "itkAdvancedLinearInterpolateImageFunction.h"
+#include "itkImageGridSampler.h"
+#include "itkImageRandomSampler.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkLinearInterpolateImageFunction.h"
+
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+
+namespace
+{
+
+const unsigned int Dimension = 3;
+typedef float                                          PixelType;
+typedef double                                         CoordinateRepresentationType;
+typedef itk::Image< PixelType, Dimension >             ImageType;
+typedef itk::AdvancedBSplineDeformableTransform<
+  CoordinateRepresentationType, Dimension, 3 >         TransformType;
+typedef itk::ImageSample< ImageType >                  ImageSampleType;
+typedef itk::VectorDataContainer<
+  unsigned long, ImageSampleType >                     ImageSampleContainerType;
+
+/** The mean squared difference over the samples that map inside the moving
+ * image, computed point by point with the ITK linear interpolator.
+ */
+double
+ComputeMeanSquares( const ImageSampleContainerType * samples,
+  const ImageType * movingImage, const TransformType * transform )
+{
+  typedef itk::LinearInterpolateImageFunction<
+    ImageType, CoordinateRepresentationType > ReferenceInterpolatorType;
+  ReferenceInterpolatorType::Pointer interpolator = ReferenceInterpolatorType::New();
+  interpolator->SetInputImage( movingImage );
+
+  double        sum   = 0.0;
+  unsigned long count = 0;
+  for( unsigned long i = 0; i < samples->Size(); ++i )
+  {
+    const TransformType::OutputPointType mappedPoint
+      = transform->TransformPoint( samples->ElementAt( i ).m_ImageCoordinates );
+    if( interpolator->IsInsideBuffer( mappedPoint ) )
+    {
+      const double difference = interpolator->Evaluate( mappedPoint )
+        - samples->ElementAt( i ).m_ImageValue;
+      sum += difference * difference;
+      ++count;
+    }
+  }
+  return sum / count;
+
+} // end ComputeMeanSquares()
+
+
+} // end namespace
+
+//-------------------------------------------------------------------------------------
+
+int
+main( void )
+{
+  typedef itk::AdvancedLinearInterpolateImageFunction<
+    ImageType, CoordinateRepresentationType >             InterpolatorType;
+  typedef itk::ImageRandomSampler< ImageType >            SamplerType;
+  typedef itk::ImageGridSampler< ImageType >              GridSamplerType;
+  typedef SamplerType::ImageSampleStructureOfArraysType   StructureOfArraysType;
+  typedef StructureOfArraysType::ContinuousIndexType      ContinuousIndexType;
+  typedef itk::AdvancedMeanSquaresImageToImageMetric<
+    ImageType, ImageType >                                MetricType;
+  typedef MetricType::TransformParametersType             ParametersType;
+  typedef MetricType::DerivativeType                      DerivativeType;
+
+  /** Create a fixed and a moving image with a shifted Gaussian blob. A
+   * non-trivial origin and spacing make the continuous indices differ from
+   * the physical coordinates.
+   */
+  ImageType::SizeType imageSize;
+  imageSize.Fill( 32 );
+  ImageType::Pointer images[ 2 ];
+  for( unsigned int i = 0; i < 2; ++i )
+  {
+    images[ i ] = ImageType::New();
+    images[ i ]->SetRegions( imageSize );
+    images[ i ]->Allocate();
+    itk::ImageRegionIteratorWithIndex< ImageType > it( images[ i ], images[ i ]->GetBufferedRegion() );
+    for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+      double r2 = 0.0;
+      for( unsigned int d = 0; d < Dimension; ++d )
+      {
+        const double x = it.GetIndex()[ d ] - 16.0 - 2.0 * i;
+        r2 += x * x;
+      }
+      it.Set( 100.0 * std::exp( -r2 / 64.0 ) );
+    }
+  }
+  ImageType::SpacingType spacing;
+  ImageType::PointType   origin;
+  for( unsigned int d = 0; d < Dimension; ++d )
+  {
+    spacing[ d ] = 1.0 + 0.25 * d;
+    origin[ d ]  = -3.0 + d;
+  }
+  images[ 0 ]->SetSpacing( spacing );
+  images[ 0 ]->SetOrigin( origin );
+
+  /** Draw samples, with the structure of arrays output enabled. */
+  SamplerType::Pointer sampler = SamplerType::New();
+  sampler->SetInput( images[ 0 ] );
+  sampler->SetNumberOfSamples( 1000 );
+  sampler->SetUseStructureOfArrays( true );
+  sampler->Update();
+
+  const ImageSampleContainerType * samples = sampler->GetOutput();
+  const StructureOfArraysType *    arrays  = sampler->GetStructureOfArraysOutput();
+  if( arrays->Size() != samples->Size() )
+  {
+    std::cerr << "ERROR: the structure of arrays holds " << arrays->Size()
+              << " samples instead of " << samples->Size() << "." << std::endl;
+    return 1;
+  }
+
+  /** All arrays should be aligned. */
+  for( unsigned int d = 0; d < Dimension; ++d )
+  {
+    if( reinterpret_cast< std::size_t >( arrays->GetCoordinates( d ) ) % StructureOfArraysType::Alignment != 0
+      || reinterpret_cast< std::size_t >( arrays->GetContinuousIndices( d ) ) % StructureOfArraysType::Alignment != 0 )
+    {
+      std::cerr << "ERROR: the arrays of dimension " << d << " are not aligned." << std::endl;
+      return 1;
+    }
+  }
+  if( reinterpret_cast< std::size_t >( arrays->GetValues() ) % StructureOfArraysType::Alignment != 0 )
+  {
+    std::cerr << "ERROR: the value array is not aligned." << std::endl;
+    return 1;
+  }
+
+  /** Compare every sample with the sample container. */
+  for( unsigned long i = 0; i < samples->Size(); ++i )
+  {
+    const SamplerType::ImageSampleType & sample = samples->ElementAt( i );
+    ContinuousIndexType                  cindex;
+    images[ 0 ]->TransformPhysicalPointToContinuousIndex( sample.m_ImageCoordinates, cindex );
+    for( unsigned int d = 0; d < Dimension; ++d )
+    {
+      if( arrays->GetCoordinates( d )[ i ] != sample.m_ImageCoordinates[ d ] )
+      {
+        std::cerr << "ERROR: coordinate " << d << " of sample " << i << " is "
+                  << arrays->GetCoordinates( d )[ i ] << " instead of "
+                  << sample.m_ImageCoordinates[ d ] << "." << std::endl;
+        return 1;
+      }
+      if( std::abs( arrays->GetContinuousIndices( d )[ i ] - cindex[ d ] ) > 1e-10 )
+      {
+        std::cerr << "ERROR: continuous index " << d << " of sample " << i << " is "
+                  << arrays->GetContinuousIndices( d )[ i ] << " instead of "
+                  << cindex[ d ] << "." << std::endl;
+        return 1;
+      }
+    }
+    if( arrays->GetValues()[ i ] != sample.m_ImageValue )
+    {
+      std::cerr << "ERROR: the value of sample " << i << " is " << arrays->GetValues()[ i ]
+                << " instead of " << sample.m_ImageValue << "." << std::endl;
+      return 1;
+    }
+  }
+
+  /** Setup a multi-threaded metric that reads the samples from the container,
+   * and one that reads them from the structure of arrays. A grid sampler is
+   * used, so that both metrics get the same samples. The B-spline grid of
+   * 8 control points per dimension covers the fixed image.
+   */
+  TransformType::Pointer    transform = TransformType::New();
+  TransformType::RegionType gridRegion;
+  TransformType::SizeType   gridSize;
+  gridSize.Fill( 8 );
+  gridRegion.SetSize( gridSize );
+  TransformType::SpacingType gridSpacing;
+  TransformType::OriginType  gridOrigin;
+  for( unsigned int d = 0; d < Dimension; ++d )
+  {
+    gridSpacing[ d ] = 9.0 * spacing[ d ];
+    gridOrigin[ d ]  = origin[ d ] - 1.5 * gridSpacing[ d ];
+  }
+  transform->SetGridOrigin( gridOrigin );
+  transform->SetGridSpacing( gridSpacing );
+  transform->SetGridRegion( gridRegion );
+  const unsigned int numberOfParameters = transform->GetNumberOfParameters();
+  ParametersType     parameters( numberOfParameters );
+  for( unsigned int j = 0; j < numberOfParameters; ++j )
+  {
+    parameters[ j ] = 0.5 * std::sin( 0.1 * j );
+  }
+  transform->SetParametersByValue( parameters );
+
+  GridSamplerType::SampleGridSpacingType sampleGridSpacing;
+  sampleGridSpacing.Fill( 2 );
+  GridSamplerType::Pointer gridSamplers[ 2 ];
+  MetricType::Pointer      metrics[ 2 ];
+  DerivativeType           derivatives[ 2 ];
+  MetricType::MeasureType  values[ 2 ];
+  for( unsigned int m = 0; m < 2; ++m )
+  {
+    gridSamplers[ m ] = GridSamplerType::New();
+    gridSamplers[ m ]->SetSampleGridSpacing( sampleGridSpacing );
+
+    metrics[ m ] = MetricType::New();
+    metrics[ m ]->SetFixedImage( images[ 0 ] );
+    metrics[ m ]->SetMovingImage( images[ 1 ] );
+    metrics[ m ]->SetFixedImageRegion( images[ 0 ]->GetBufferedRegion() );
+    metrics[ m ]->SetTransform( transform );
+    metrics[ m ]->SetInterpolator( InterpolatorType::New() );
+    metrics[ m ]->SetImageSampler( gridSamplers[ m ] );
+    metrics[ m ]->SetUseMultiThread( true );
+    metrics[ m ]->SetUseStructureOfArraysSamples( m == 1 );
+    metrics[ m ]->Initialize();
+
+    derivatives[ m ].SetSize( numberOfParameters );
+    metrics[ m ]->GetValueAndDerivative( parameters, values[ m ], derivatives[ m ] );
+  }
+
+  /** The value should be the brute force value, and the derivative should
+   * be the derivative of the metric that reads the sample container.
+   */
+  const double referenceValue = ComputeMeanSquares( gridSamplers[ 1 ]->GetOutput(), images[ 1 ], transform );
+  if( std::abs( values[ 1 ] - referenceValue ) > 1e-9 * ( 1.0 + referenceValue ) )
+  {
+    std::cerr << "ERROR: the value with the structure of arrays is " << values[ 1 ]
+              << " instead of " << referenceValue << "." << std::endl;
+    return 1;
+  }
+  const double difference = ( derivatives[ 0 ] - derivatives[ 1 ] ).inf_norm();
+  if( difference > 1e-12 * ( 1.0 + derivatives[ 0 ].inf_norm() ) )
+  {
+    std::cerr << "ERROR: the derivative with the structure of arrays differs by "
+              << difference << "." << std::endl;
+    return 1;
+  }
+
+  /** Change the fixed values of the samples in place, without changing
+   * their number. The metric should notice the modified container, and not
+   * read the old values from the structure of arrays.
+   */
+  ImageSampleContainerType * changedSamples = gridSamplers[ 1 ]->GetOutput();
+  for( unsigned long i = 0; i < changedSamples->Size(); ++i )
+  {
+    changedSamples->ElementAt( i ).m_ImageValue += 10.0;
+  }
+  changedSamples->Modified();
+  metrics[ 1 ]->GetValueAndDerivative( parameters, values[ 1 ], derivatives[ 1 ] );
+  const double changedReferenceValue = ComputeMeanSquares( changedSamples, images[ 1 ], transform );
+  if( std::abs( values[ 1 ] - changedReferenceValue ) > 1e-9 * ( 1.0 + changedReferenceValue ) )
+  {
+    std::cerr << "ERROR: after changing the samples, the value with the structure of arrays is "
+              << values[ 1 ] << " instead of " << changedReferenceValue << "." << std::endl;
+    return 1;
+  }
+
+  /** Return a value. */
+  return 0;
+
+} // end main
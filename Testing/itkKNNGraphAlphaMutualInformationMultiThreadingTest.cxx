@@ -0,0 +1,271 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+/** \file
+ \brief Check the value of the kNN graph alpha mutual information metric
+ against a brute force computation, which finds the nearest neighbours of
+ every sample by comparing it with all other samples. The derivative of the
+ multi-threaded metric, with the three kNN trees built one after the other
+ and built concurrently (UseParallelTreeBuild), is compared with the
+ derivative of the original single-threaded implementation.
+ */
+
+#include "elxMacro.h"
+#include "xoutmain.h"
+
+#include "KNNGraphAlphaMutualInformation/itkKNNGraphAlphaMutualInformationImageToImageMetric.h"
+#include "itkAdvancedBSplineDeformableTransform.h"
+#include "itkBSplineInterpolateImageFunction.h"
+#include "itkImageGridSampler.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkLinearInterpolateImageFunction.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+
+const unsigned int Dimension = 3;
+typedef float                                          PixelType;
+typedef double                                         CoordinateRepresentationType;
+typedef itk::Image< PixelType, Dimension >             ImageType;
+typedef itk::AdvancedBSplineDeformableTransform<
+  CoordinateRepresentationType, Dimension, 3 >         TransformType;
+typedef itk::ImageGridSampler< ImageType >             SamplerType;
+
+/** The negative alpha mutual information of the kNN graphs, with the
+ * neighbours found by brute force. The samples that map outside the moving
+ * image are skipped. As in ANN, neighbours at distance zero are skipped,
+ * unless ANN is configured to allow self matches.
+ */
+double
+ComputeBruteForceValue( const SamplerType::ImageSampleContainerType * samples,
+  const ImageType * movingImage, const TransformType * transform,
+  const unsigned int k, const double alpha, const double avoidDivisionBy )
+{
+  typedef itk::LinearInterpolateImageFunction<
+    ImageType, CoordinateRepresentationType > ReferenceInterpolatorType;
+  ReferenceInterpolatorType::Pointer interpolator = ReferenceInterpolatorType::New();
+  interpolator->SetInputImage( movingImage );
+
+  /** The fixed and moving feature of the valid samples. */
+  std::vector< double > fixedValues;
+  std::vector< double > movingValues;
+  for( unsigned long i = 0; i < samples->Size(); ++i )
+  {
+    const TransformType::OutputPointType mappedPoint
+      = transform->TransformPoint( samples->ElementAt( i ).m_ImageCoordinates );
+    if( interpolator->IsInsideBuffer( mappedPoint ) )
+    {
+      fixedValues.push_back( samples->ElementAt( i ).m_ImageValue );
+      movingValues.push_back( interpolator->Evaluate( mappedPoint ) );
+    }
+  }
+
+  /** The sum of the distances to the k nearest neighbours in the fixed,
+   * moving and joint feature space, for every query point.
+   */
+  const std::size_t n = fixedValues.size();
+  const double      twoGamma = 2.0 * ( 1.0 - alpha );
+  double            sumG = 0.0;
+  std::vector< double > distancesF, distancesM, distancesJ;
+  for( std::size_t i = 0; i < n; ++i )
+  {
+    distancesF.clear();
+    distancesM.clear();
+    distancesJ.clear();
+    for( std::size_t j = 0; j < n; ++j )
+    {
+      const double dF = ( fixedValues[ i ] - fixedValues[ j ] ) * ( fixedValues[ i ] - fixedValues[ j ] );
+      const double dM = ( movingValues[ i ] - movingValues[ j ] ) * ( movingValues[ i ] - movingValues[ j ] );
+      if( ANN_ALLOW_SELF_MATCH || dF != 0.0 ) { distancesF.push_back( dF ); }
+      if( ANN_ALLOW_SELF_MATCH || dM != 0.0 ) { distancesM.push_back( dM ); }
+      if( ANN_ALLOW_SELF_MATCH || dF + dM != 0.0 ) { distancesJ.push_back( dF + dM ); }
+    }
+    std::partial_sort( distancesF.begin(), distancesF.begin() + k, distancesF.end() );
+    std::partial_sort( distancesM.begin(), distancesM.begin() + k, distancesM.end() );
+    std::partial_sort( distancesJ.begin(), distancesJ.begin() + k, distancesJ.end() );
+
+    double gammaF = 0.0, gammaM = 0.0, gammaJ = 0.0;
+    for( unsigned int p = 0; p < k; ++p )
+    {
+      gammaF += std::sqrt( distancesF[ p ] );
+      gammaM += std::sqrt( distancesM[ p ] );
+      gammaJ += std::sqrt( distancesJ[ p ] );
+    }
+    const double H = std::sqrt( gammaF * gammaM );
+    if( H > avoidDivisionBy )
+    {
+      sumG += std::pow( gammaJ / H, twoGamma );
+    }
+  }
+
+  return -std::log( sumG / std::pow( static_cast< double >( n ), alpha ) ) / ( alpha - 1.0 );
+
+} // end ComputeBruteForceValue()
+
+
+} // end namespace
+
+//-------------------------------------------------------------------------------------
+
+int
+main( void )
+{
+  typedef itk::BSplineInterpolateImageFunction<
+    ImageType, CoordinateRepresentationType, double >     InterpolatorType;
+  typedef itk::KNNGraphAlphaMutualInformationImageToImageMetric<
+    ImageType, ImageType >                                MetricType;
+  typedef MetricType::TransformParametersType             ParametersType;
+  typedef MetricType::DerivativeType                      DerivativeType;
+
+  /** Create a fixed and a moving image with an anisotropic Gaussian blob,
+   * shifted by 1.5 voxel in every dimension.
+   */
+  ImageType::SizeType imageSize;
+  imageSize.Fill( 16 );
+  ImageType::Pointer images[ 2 ];
+  for( unsigned int i = 0; i < 2; ++i )
+  {
+    images[ i ] = ImageType::New();
+    images[ i ]->SetRegions( imageSize );
+    images[ i ]->Allocate();
+    itk::ImageRegionIteratorWithIndex< ImageType > it( images[ i ], images[ i ]->GetBufferedRegion() );
+    for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+      double r2 = 0.0;
+      for( unsigned int d = 0; d < Dimension; ++d )
+      {
+        const double x = ( it.GetIndex()[ d ] - 8.0 - 1.5 * i ) / ( d + 1.0 );
+        r2 += x * x;
+      }
+      it.Set( 100.0 * std::exp( -r2 / 24.0 ) );
+    }
+  }
+
+  /** A B-spline transform with 6 control points per dimension, whose grid
+   * covers the image.
+   */
+  TransformType::Pointer    transform = TransformType::New();
+  TransformType::RegionType gridRegion;
+  TransformType::SizeType   gridSize;
+  gridSize.Fill( 6 );
+  gridRegion.SetSize( gridSize );
+  TransformType::SpacingType gridSpacing;
+  gridSpacing.Fill( 16.0 / 3.0 );
+  TransformType::OriginType gridOrigin;
+  gridOrigin.Fill( -8.0 );
+  transform->SetGridOrigin( gridOrigin );
+  transform->SetGridSpacing( gridSpacing );
+  transform->SetGridRegion( gridRegion );
+  const unsigned int numberOfParameters = transform->GetNumberOfParameters();
+  ParametersType     parameters( numberOfParameters );
+  for( unsigned int j = 0; j < numberOfParameters; ++j )
+  {
+    parameters[ j ] = 0.4 * std::sin( 0.3 * j );
+  }
+  transform->SetParametersByValue( parameters );
+
+  /** Setup a single-threaded metric, a multi-threaded metric that builds the
+   * trees serially, and one that builds them concurrently. The grid sampler
+   * gives all metrics the same samples.
+   */
+  const char * names[ 3 ] = {
+    "single-threaded", "multi-threaded", "multi-threaded with parallel tree build"
+  };
+
+  SamplerType::SampleGridSpacingType sampleGridSpacing;
+  sampleGridSpacing.Fill( 2 );
+  const unsigned int k = 20;
+  const double       alpha = 0.5;
+  const double       avoidDivisionBy = 1e-5;
+
+  SamplerType::Pointer    sampler;
+  MetricType::MeasureType values[ 3 ];
+  MetricType::MeasureType valuesOnly[ 3 ];
+  DerivativeType          derivatives[ 3 ];
+  for( unsigned int m = 0; m < 3; ++m )
+  {
+    sampler = SamplerType::New();
+    sampler->SetSampleGridSpacing( sampleGridSpacing );
+
+    InterpolatorType::Pointer interpolator = InterpolatorType::New();
+    interpolator->SetSplineOrder( 1 );
+
+    MetricType::Pointer metric = MetricType::New();
+    metric->SetFixedImage( images[ 0 ] );
+    metric->SetMovingImage( images[ 1 ] );
+    metric->SetFixedImageRegion( images[ 0 ]->GetBufferedRegion() );
+    metric->SetTransform( transform );
+    metric->SetInterpolator( interpolator );
+    metric->SetImageSampler( sampler );
+    metric->SetANNkDTree( 50, "ANN_KD_SL_MIDPT" );
+    metric->SetANNStandardTreeSearch( k, 0.0 );
+    metric->SetAlpha( alpha );
+    metric->SetAvoidDivisionBy( avoidDivisionBy );
+    metric->SetUseMultiThread( m > 0 );
+    metric->SetUseParallelTreeBuild( m == 2 );
+    metric->SetNumberOfThreads( 3 );
+    metric->Initialize();
+
+    derivatives[ m ].SetSize( numberOfParameters );
+    metric->GetValueAndDerivative( parameters, values[ m ], derivatives[ m ] );
+    valuesOnly[ m ] = metric->GetValue( parameters );
+  }
+
+  /** The exact search finds the same neighbour distances as brute force. */
+  const double referenceValue = ComputeBruteForceValue(
+    sampler->GetOutput(), images[ 1 ], transform, k, alpha, avoidDivisionBy );
+  std::cerr << "Value: " << values[ 0 ] << ", brute force value: " << referenceValue
+            << ", |derivative|: " << derivatives[ 0 ].magnitude() << std::endl;
+  const double maxDerivative = derivatives[ 0 ].inf_norm();
+  if( maxDerivative == 0.0 )
+  {
+    std::cerr << "ERROR: the single-threaded derivative is zero." << std::endl;
+    return 1;
+  }
+  for( unsigned int m = 0; m < 3; ++m )
+  {
+    const double tolerance = 1e-8 * ( 1.0 + std::abs( referenceValue ) );
+    if( std::abs( values[ m ] - referenceValue ) > tolerance
+      || std::abs( valuesOnly[ m ] - referenceValue ) > tolerance )
+    {
+      std::cerr << "ERROR: the " << names[ m ] << " value is " << values[ m ]
+                << " (GetValue(): " << valuesOnly[ m ] << ") instead of "
+                << referenceValue << "." << std::endl;
+      return 1;
+    }
+    if( m == 0 )
+    {
+      continue;
+    }
+    const double difference = ( derivatives[ 0 ] - derivatives[ m ] ).inf_norm();
+    if( difference > 1e-10 * ( 1.0 + maxDerivative ) )
+    {
+      std::cerr << "ERROR: the " << names[ m ] << " derivative differs by " << difference
+                << ", while the largest element is " << maxDerivative << "." << std::endl;
+      return 1;
+    }
+  }
+
+  /** Return a value. */
+  return 0;
+
+} // end main
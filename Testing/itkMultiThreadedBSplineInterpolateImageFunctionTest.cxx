@@ -0,0 +1,212 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+/** \file
+ \brief Compare the multi-threaded B-spline prefiltering with the serial ITK
+ implementation.
+
+ The coefficients of the MultiOrderBSplineDecompositionImageFilter are compared
+ with those of the itk::BSplineDecompositionImageFilter, and the values and
+ derivatives of the MultiThreadedBSplineInterpolateImageFunction with those of
+ the itk::BSplineInterpolateImageFunction. This is done for spline orders 0 to
+ 5, for float and double images, in 2D and 3D, for images with an odd size and
+ with a dimension of length 1. One interpolator is reused for all orders, to
+ check that SetInputImage() recomputes the coefficients.
+ */
+
+#include "itkBSplineDecompositionImageFilter.h"
+#include "itkBSplineInterpolateImageFunction.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkMultiOrderBSplineDecompositionImageFilter.h"
+#include "itkMultiThreadedBSplineInterpolateImageFunction.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+
+/** Compare the coefficients and the interpolation for one image size. The
+ * tolerance is relative to the largest absolute value. Returns 1 on failure.
+ */
+template< class TPixel, unsigned int VDimension >
+int
+CompareWithITK( const typename itk::Image< TPixel, VDimension >::SizeType & size,
+  const double tolerance )
+{
+  typedef itk::Image< TPixel, VDimension >                  ImageType;
+  typedef itk::Image< TPixel, VDimension >                  CoefficientImageType;
+  typedef itk::BSplineDecompositionImageFilter<
+    ImageType, CoefficientImageType >                       ITKDecompositionType;
+  typedef itk::MultiOrderBSplineDecompositionImageFilter<
+    ImageType, CoefficientImageType >                       DecompositionType;
+  typedef itk::BSplineInterpolateImageFunction<
+    ImageType, double, TPixel >                             ITKInterpolatorType;
+  typedef itk::MultiThreadedBSplineInterpolateImageFunction<
+    ImageType, double, TPixel >                             InterpolatorType;
+  typedef typename InterpolatorType::ContinuousIndexType    ContinuousIndexType;
+  typedef typename InterpolatorType::CovariantVectorType    CovariantVectorType;
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator RandomGeneratorType;
+
+  std::cerr << "Dimension " << VDimension << ", size " << size
+            << ", " << ( sizeof( TPixel ) == sizeof( float ) ? "float" : "double" ) << std::endl;
+
+  /** An image with random values. */
+  RandomGeneratorType::Pointer randomGenerator = RandomGeneratorType::New();
+  randomGenerator->SetSeed( 1234 );
+  typename ImageType::Pointer image = ImageType::New();
+  image->SetRegions( size );
+  image->Allocate();
+  itk::ImageRegionIterator< ImageType > it( image, image->GetBufferedRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+  {
+    it.Set( static_cast< TPixel >( randomGenerator->GetUniformVariate( -100.0, 100.0 ) ) );
+  }
+
+  /** Some continuous indices inside the image. */
+  const unsigned int                numberOfPoints = 100;
+  std::vector< ContinuousIndexType > cindices( numberOfPoints );
+  for( unsigned int j = 0; j < numberOfPoints; ++j )
+  {
+    for( unsigned int d = 0; d < VDimension; ++d )
+    {
+      cindices[ j ][ d ] = randomGenerator->GetUniformVariate( 0.0, size[ d ] - 1.0 );
+    }
+  }
+
+  typename InterpolatorType::Pointer interpolator = InterpolatorType::New();
+  for( unsigned int order = 0; order <= 5; ++order )
+  {
+    /** The coefficients, with an odd number of threads. */
+    typename ITKDecompositionType::Pointer itkDecomposition = ITKDecompositionType::New();
+    itkDecomposition->SetSplineOrder( order );
+    itkDecomposition->SetInput( image );
+    itkDecomposition->Update();
+
+    typename DecompositionType::Pointer decomposition = DecompositionType::New();
+    decomposition->SetSplineOrder( order );
+    decomposition->SetNumberOfThreads( 3 );
+    decomposition->SetInput( image );
+    decomposition->Update();
+
+    typedef itk::ImageRegionConstIterator< CoefficientImageType > CoefficientIteratorType;
+    CoefficientIteratorType itkIt( itkDecomposition->GetOutput(), image->GetBufferedRegion() );
+    CoefficientIteratorType cit( decomposition->GetOutput(), image->GetBufferedRegion() );
+    double maxAbsCoefficient = 0.0;
+    double maxDifference     = 0.0;
+    for( itkIt.GoToBegin(), cit.GoToBegin(); !itkIt.IsAtEnd(); ++itkIt, ++cit )
+    {
+      maxAbsCoefficient = std::max( maxAbsCoefficient, std::fabs( static_cast< double >( itkIt.Get() ) ) );
+      maxDifference     = std::max( maxDifference,
+        std::fabs( static_cast< double >( itkIt.Get() ) - static_cast< double >( cit.Get() ) ) );
+    }
+    if( maxDifference > tolerance * maxAbsCoefficient )
+    {
+      std::cerr << "ERROR: the coefficients of order " << order << " differ up to "
+                << maxDifference << " from the ITK coefficients." << std::endl;
+      return 1;
+    }
+
+    /** The interpolated values and derivatives. */
+    typename ITKInterpolatorType::Pointer itkInterpolator = ITKInterpolatorType::New();
+    itkInterpolator->SetSplineOrder( order );
+    itkInterpolator->SetInputImage( image );
+    interpolator->SetSplineOrder( order );
+    interpolator->SetInputImage( image );
+
+    for( unsigned int j = 0; j < numberOfPoints; ++j )
+    {
+      const double itkValue = itkInterpolator->EvaluateAtContinuousIndex( cindices[ j ] );
+      const double value    = interpolator->EvaluateAtContinuousIndex( cindices[ j ] );
+      if( std::fabs( value - itkValue ) > tolerance * maxAbsCoefficient )
+      {
+        std::cerr << "ERROR: the interpolator of order " << order << " gives " << value
+                  << " at " << cindices[ j ] << " instead of " << itkValue << "." << std::endl;
+        return 1;
+      }
+
+      if( order == 0 )
+      {
+        continue;
+      }
+      const CovariantVectorType itkDerivative = itkInterpolator->EvaluateDerivativeAtContinuousIndex( cindices[ j ] );
+      const CovariantVectorType derivative    = interpolator->EvaluateDerivativeAtContinuousIndex( cindices[ j ] );
+      for( unsigned int d = 0; d < VDimension; ++d )
+      {
+        if( std::fabs( derivative[ d ] - itkDerivative[ d ] ) > tolerance * maxAbsCoefficient )
+        {
+          std::cerr << "ERROR: the interpolator of order " << order << " gives derivative "
+                    << derivative << " at " << cindices[ j ] << " instead of "
+                    << itkDerivative << "." << std::endl;
+          return 1;
+        }
+      }
+    }
+  }
+
+  return 0;
+
+} // end CompareWithITK()
+
+
+/** Run the comparison for float and double images. */
+template< unsigned int VDimension >
+int
+CompareFloatAndDoubleWithITK( const unsigned int sizeArray[ VDimension ] )
+{
+  itk::Size< VDimension > size;
+  for( unsigned int d = 0; d < VDimension; ++d )
+  {
+    size[ d ] = sizeArray[ d ];
+  }
+  if( CompareWithITK< float, VDimension >( size, 1e-5 ) )
+  {
+    return 1;
+  }
+  return CompareWithITK< double, VDimension >( size, 1e-10 );
+
+} // end CompareFloatAndDoubleWithITK()
+
+
+} // end namespace
+
+//-------------------------------------------------------------------------------------
+
+int
+main( int argc, char * argv[] )
+{
+  /** The interpolator uses the default number of threads. */
+  itk::MultiThreader::SetGlobalDefaultNumberOfThreads( 4 );
+
+  const unsigned int size2D[][ 2 ] = { { 17, 10 }, { 1, 13 }, { 9, 1 } };
+  const unsigned int size3D[][ 3 ] = { { 9, 8, 7 }, { 6, 1, 5 }, { 1, 7, 4 } };
+  for( unsigned int i = 0; i < 3; ++i )
+  {
+    if( CompareFloatAndDoubleWithITK< 2 >( size2D[ i ] ) || CompareFloatAndDoubleWithITK< 3 >( size3D[ i ] ) )
+    {
+      return 1;
+    }
+  }
+
+  /** Return a value. */
+  return 0;
+
+} // end main
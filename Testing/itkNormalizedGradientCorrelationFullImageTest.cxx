@@ -0,0 +1,267 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+/** \file
+ \brief Check that the normalized gradient correlation metric without an
+ image sampler gives the value of the former full image implementation: the
+ moving image is projected onto the whole fixed image grid with a
+ ResampleImageFilter, the gradients of both images are computed with Sobel
+ filters, and the correlation is computed over all voxels of the fixed image
+ region.
+ */
+
+#include "elxMacro.h"
+#include "xoutmain.h"
+
+#include "NormalizedGradientCorrelation/itkNormalizedGradientCorrelationImageToImageMetric.h"
+#include "itkAdvancedEuler3DTransform.h"
+#include "itkAdvancedRayCastInterpolateImageFunction.h"
+#include "itkCastImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkNeighborhoodOperatorImageFilter.h"
+#include "itkResampleImageFilter.h"
+#include "itkSobelOperator.h"
+#include "itkZeroFluxNeumannBoundaryCondition.h"
+
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+
+const unsigned int Dimension = 3;
+typedef float                                       PixelType;
+typedef double                                      CoordinateRepresentationType;
+typedef itk::Image< PixelType, Dimension >          ImageType;
+typedef itk::Image< double, Dimension >             GradientImageType;
+typedef itk::AdvancedEuler3DTransform<
+  CoordinateRepresentationType >                    TransformType;
+typedef itk::AdvancedRayCastInterpolateImageFunction<
+  ImageType, CoordinateRepresentationType >         RayCasterType;
+typedef itk::NormalizedGradientCorrelationImageToImageMetric<
+  ImageType, ImageType >                            MetricType;
+typedef TransformType::ParametersType               ParametersType;
+
+/** Compute the Sobel gradient of an image in direction d, with a zero flux
+ * Neumann boundary condition.
+ */
+GradientImageType::Pointer
+ComputeSobelGradient( const ImageType * image, const unsigned int d )
+{
+  typedef itk::CastImageFilter< ImageType, GradientImageType > CastFilterType;
+  typedef itk::NeighborhoodOperatorImageFilter<
+    GradientImageType, GradientImageType >                     SobelFilterType;
+
+  itk::SobelOperator< double, Dimension > sobelOperator;
+  sobelOperator.SetDirection( d );
+  sobelOperator.CreateDirectional();
+  itk::ZeroFluxNeumannBoundaryCondition< GradientImageType > boundaryCondition;
+
+  CastFilterType::Pointer caster = CastFilterType::New();
+  caster->SetInput( image );
+  SobelFilterType::Pointer sobel = SobelFilterType::New();
+  sobel->OverrideBoundaryCondition( &boundaryCondition );
+  sobel->SetOperator( sobelOperator );
+  sobel->SetInput( caster->GetOutput() );
+  sobel->Update();
+
+  return sobel->GetOutput();
+
+} // end ComputeSobelGradient()
+
+
+/** The normalized gradient correlation as formerly computed over the
+ * whole fixed image, in the x and y direction of the projection.
+ */
+double
+ComputeFullImageValue( ImageType * fixedImage, ImageType * movingImage,
+  TransformType * transform, RayCasterType * rayCaster )
+{
+  typedef itk::ResampleImageFilter< ImageType, ImageType >      ResampleFilterType;
+  typedef itk::ImageRegionConstIterator< GradientImageType >    IteratorType;
+
+  ResampleFilterType::Pointer resampler = ResampleFilterType::New();
+  resampler->SetTransform( transform );
+  resampler->SetInterpolator( rayCaster );
+  resampler->SetInput( movingImage );
+  resampler->SetDefaultPixelValue( 0 );
+  resampler->SetSize( fixedImage->GetLargestPossibleRegion().GetSize() );
+  resampler->SetOutputOrigin( fixedImage->GetOrigin() );
+  resampler->SetOutputSpacing( fixedImage->GetSpacing() );
+  resampler->SetOutputDirection( fixedImage->GetDirection() );
+  resampler->Update();
+
+  const unsigned int         numberOfDirections = 2;
+  GradientImageType::Pointer fixedGradients[ numberOfDirections ];
+  GradientImageType::Pointer movedGradients[ numberOfDirections ];
+  double                     meanFixed[ numberOfDirections ];
+  double                     meanMoved[ numberOfDirections ];
+  const double               numberOfPixels = fixedImage->GetBufferedRegion().GetNumberOfPixels();
+  for( unsigned int d = 0; d < numberOfDirections; ++d )
+  {
+    fixedGradients[ d ] = ComputeSobelGradient( fixedImage, d );
+    movedGradients[ d ] = ComputeSobelGradient( resampler->GetOutput(), d );
+
+    meanFixed[ d ] = 0.0;
+    meanMoved[ d ] = 0.0;
+    IteratorType fit( fixedGradients[ d ], fixedGradients[ d ]->GetBufferedRegion() );
+    IteratorType mit( movedGradients[ d ], movedGradients[ d ]->GetBufferedRegion() );
+    for( fit.GoToBegin(), mit.GoToBegin(); !fit.IsAtEnd(); ++fit, ++mit )
+    {
+      meanFixed[ d ] += fit.Get();
+      meanMoved[ d ] += mit.Get();
+    }
+    meanFixed[ d ] /= numberOfPixels;
+    meanMoved[ d ] /= numberOfPixels;
+  }
+
+  double crossCorrelation = 0.0, autoCorrelationFixed = 0.0, autoCorrelationMoving = 0.0;
+  for( unsigned int d = 0; d < numberOfDirections; ++d )
+  {
+    IteratorType fit( fixedGradients[ d ], fixedGradients[ d ]->GetBufferedRegion() );
+    IteratorType mit( movedGradients[ d ], movedGradients[ d ]->GetBufferedRegion() );
+    for( fit.GoToBegin(), mit.GoToBegin(); !fit.IsAtEnd(); ++fit, ++mit )
+    {
+      const double fixedGradient = fit.Get() - meanFixed[ d ];
+      const double movedGradient = mit.Get() - meanMoved[ d ];
+      crossCorrelation      += fixedGradient * movedGradient;
+      autoCorrelationFixed  += fixedGradient * fixedGradient;
+      autoCorrelationMoving += movedGradient * movedGradient;
+    }
+  }
+
+  return -crossCorrelation / ( std::sqrt( autoCorrelationFixed ) * std::sqrt( autoCorrelationMoving ) );
+
+} // end ComputeFullImageValue()
+
+
+} // end namespace
+
+//-------------------------------------------------------------------------------------
+
+int
+main( void )
+{
+  /** A moving volume with an anisotropic blob around the origin, and a
+   * fixed projection image of one slice, on the other side of the volume
+   * than the focal point. The fixed image is the projection of the volume
+   * shifted by a few voxels.
+   */
+  ImageType::SizeType movingSize;
+  movingSize.Fill( 32 );
+  ImageType::Pointer movingImage = ImageType::New();
+  movingImage->SetRegions( movingSize );
+  movingImage->Allocate();
+  ImageType::PointType movingOrigin;
+  movingOrigin.Fill( -16.0 );
+  movingImage->SetOrigin( movingOrigin );
+
+  itk::ImageRegionIteratorWithIndex< ImageType > it( movingImage, movingImage->GetBufferedRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+  {
+    double r2 = 0.0;
+    for( unsigned int d = 0; d < Dimension; ++d )
+    {
+      const double x = ( it.GetIndex()[ d ] - 16.0 ) / ( d + 1.0 );
+      r2 += x * x;
+    }
+    it.Set( 100.0 * std::exp( -r2 / 24.0 ) );
+  }
+
+  ImageType::SizeType fixedSize;
+  fixedSize[ 0 ] = 40;
+  fixedSize[ 1 ] = 36;
+  fixedSize[ 2 ] = 1;
+  ImageType::SpacingType fixedSpacing;
+  fixedSpacing[ 0 ] = 1.5;
+  fixedSpacing[ 1 ] = 1.5;
+  fixedSpacing[ 2 ] = 1.0;
+  ImageType::PointType fixedOrigin;
+  fixedOrigin[ 0 ] = -30.0;
+  fixedOrigin[ 1 ] = -27.0;
+  fixedOrigin[ 2 ] = -100.0;
+
+  TransformType::Pointer transform = TransformType::New();
+  RayCasterType::Pointer rayCaster = RayCasterType::New();
+  RayCasterType::InputPointType focalPoint;
+  focalPoint[ 0 ] = 2.0;
+  focalPoint[ 1 ] = -1.0;
+  focalPoint[ 2 ] = 400.0;
+  rayCaster->SetInputImage( movingImage );
+  rayCaster->SetTransform( transform );
+  rayCaster->SetFocalPoint( focalPoint );
+  rayCaster->SetThreshold( 0.0 );
+
+  ParametersType parameters( transform->GetNumberOfParameters() );
+  parameters.Fill( 0.0 );
+  parameters[ 3 ] = 3.0;
+  parameters[ 4 ] = -2.0;
+  transform->SetParameters( parameters );
+
+  ImageType::Pointer fixedImage;
+  {
+    typedef itk::ResampleImageFilter< ImageType, ImageType > ResampleFilterType;
+    ResampleFilterType::Pointer projector = ResampleFilterType::New();
+    projector->SetTransform( transform );
+    projector->SetInterpolator( rayCaster );
+    projector->SetInput( movingImage );
+    projector->SetSize( fixedSize );
+    projector->SetOutputOrigin( fixedOrigin );
+    projector->SetOutputSpacing( fixedSpacing );
+    projector->Update();
+    fixedImage = projector->GetOutput();
+    fixedImage->DisconnectPipeline();
+  }
+
+  /** The metric without an image sampler. */
+  MetricType::Pointer metric = MetricType::New();
+  metric->SetFixedImage( fixedImage );
+  metric->SetMovingImage( movingImage );
+  metric->SetFixedImageRegion( fixedImage->GetBufferedRegion() );
+  metric->SetTransform( transform );
+  metric->SetInterpolator( rayCaster );
+  metric->Initialize();
+
+  /** Compare the values at a few rigid transformations. */
+  const unsigned int numberOfTests = 4;
+  for( unsigned int t = 0; t < numberOfTests; ++t )
+  {
+    for( unsigned int p = 0; p < parameters.GetSize(); ++p )
+    {
+      const double scale = p < 3 ? 0.02 : 2.0;
+      parameters[ p ] = t * scale * std::sin( 1.0 + 3.0 * p + 5.0 * t );
+    }
+
+    const double value = metric->GetValue( parameters );
+    transform->SetParameters( parameters );
+    const double fullImageValue = ComputeFullImageValue( fixedImage, movingImage, transform, rayCaster );
+
+    std::cerr << "Test " << t << ": value " << value << ", full image value "
+              << fullImageValue << std::endl;
+    if( std::abs( value - fullImageValue ) > 1e-6 )
+    {
+      std::cerr << "ERROR: the value without an image sampler is " << value
+                << " instead of " << fullImageValue << "." << std::endl;
+      return 1;
+    }
+  }
+
+  /** Return a value. */
+  return 0;
+
+} // end main
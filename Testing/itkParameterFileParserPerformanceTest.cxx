@@ -0,0 +1,421 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkParameterFileParser.h"
+#include "itkParameterMapInterface.h"
+#include "itkArray.h"
+#include "itkIntTypes.h"
+
+// Report timings
+#include "itkTimeProbe.h"
+
+#include <itksys/RegularExpression.hxx>
+#include <itksys/SystemTools.hxx>
+
+#include <clocale>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+//-------------------------------------------------------------------------------------
+// This test mimics the startup of transformix for a B-spline transform with
+// many coefficients in text form. It reads a large parameter file, and compares
+// the parsing of the lines and the conversion of the TransformParameters with
+// the regular expression parsing and string stream conversion that were used
+// before.
+
+namespace
+{
+
+typedef itk::ParameterFileParser::ParameterMapType ParameterMapType;
+
+/** Parse a parameter file the way the ParameterFileParser did before, with
+ * regular expressions that are constructed for every line, and insert the
+ * parameters in \a parameterMap. Returns false if a line is invalid.
+ */
+bool
+ReadParameterFileWithRegularExpressions( const std::string & fileName,
+  ParameterMapType & parameterMap )
+{
+  std::ifstream file( fileName.c_str() );
+  std::string   lineIn, lineOut;
+  parameterMap.clear();
+  while( file.good() )
+  {
+    itksys::SystemTools::GetLineFromStream( file, lineIn );
+
+    /** Replace tabs, remove comments and leading and trailing spaces. */
+    lineOut = lineIn;
+    itksys::SystemTools::ReplaceString( lineOut, "\t", " " );
+    itksys::RegularExpression commentPart( "//" );
+    if( commentPart.find( lineOut ) )
+    {
+      lineOut = lineOut.substr( 0, commentPart.start() );
+    }
+    itksys::RegularExpression leadingSpaces( "^[ ]*(.*)" );
+    leadingSpaces.find( lineOut );
+    lineOut = leadingSpaces.match( 1 );
+    itksys::RegularExpression trailingSpaces( "[ \t]+$" );
+    if( trailingSpaces.find( lineOut ) )
+    {
+      lineOut = lineOut.substr( 0, trailingSpaces.start() );
+    }
+
+    /** Skip empty lines and comments, and check the brackets. */
+    itksys::RegularExpression reNonEmptyLine( "[^ ]+" );
+    itksys::RegularExpression reComment( "^//" );
+    if( !reNonEmptyLine.find( lineOut ) || reComment.find( lineOut ) )
+    {
+      continue;
+    }
+    if( !itksys::SystemTools::StringStartsWith( lineOut.c_str(), "(" )
+      || !itksys::SystemTools::StringEndsWith( lineOut.c_str(), ")" ) )
+    {
+      return false;
+    }
+    lineOut = lineOut.substr( 1, lineOut.size() - 2 );
+    itksys::RegularExpression reTwoWords( "([ ]+)([^ ]+)" );
+    if( !reTwoWords.find( lineOut ) )
+    {
+      return false;
+    }
+
+    /** Split the line at spaces outside quotes, and at quotes. */
+    std::vector< std::string > splittedLine( 1 );
+    std::size_t                numQuotes = 0;
+    for( std::string::const_iterator it = lineOut.begin(); it < lineOut.end(); ++it )
+    {
+      if( *it == '"' )
+      {
+        splittedLine.push_back( "" );
+        ++numQuotes;
+      }
+      else if( *it == ' ' && numQuotes % 2 == 0 )
+      {
+        splittedLine.push_back( "" );
+      }
+      else
+      {
+        splittedLine.back().push_back( *it );
+      }
+    }
+    if( numQuotes % 2 == 1 )
+    {
+      return false;
+    }
+
+    /** Check the name and the values. */
+    std::string parameterName = splittedLine[ 0 ];
+    itksys::SystemTools::ReplaceString( parameterName, " ", "" );
+    std::vector< std::string > parameterValues;
+    for( std::size_t i = 1; i < splittedLine.size(); ++i )
+    {
+      if( splittedLine[ i ] != "" )
+      {
+        parameterValues.push_back( splittedLine[ i ] );
+      }
+    }
+    itksys::RegularExpression reInvalidCharacters1( "[.,:;!@#$%^&-+|<>?]" );
+    itksys::RegularExpression reInvalidCharacters2( "[,;!@#$%&|<>?]" );
+    if( reInvalidCharacters1.find( parameterName ) || parameterMap.count( parameterName ) )
+    {
+      return false;
+    }
+    for( std::size_t i = 0; i < parameterValues.size(); ++i )
+    {
+      if( reInvalidCharacters2.find( parameterValues[ i ] ) )
+      {
+        return false;
+      }
+    }
+    parameterMap.insert( make_pair( parameterName, parameterValues ) );
+  }
+  return true;
+
+} // end ReadParameterFileWithRegularExpressions()
+
+
+} // end namespace
+
+int
+main( int argc, char * argv[] )
+{
+  /** Check. */
+  if( argc != 2 )
+  {
+    std::cerr << "ERROR: You should specify the output directory." << std::endl;
+    return 1;
+  }
+
+  typedef itk::ParameterFileParser   ParserType;
+  typedef itk::ParameterMapInterface InterfaceType;
+  typedef itk::Array< double >       ParametersType;
+
+  /** Write a parameter file, with comments, tabs and quoted strings. */
+  const unsigned int numberOfParameters = 1000000;
+  const std::string  fileName           = std::string( argv[ 1 ] )
+    + "/parameters_ParameterFileParserPerformanceTest.txt";
+  std::ofstream      file( fileName.c_str() );
+  file << "// A parameter file for the ParameterFileParserPerformanceTest\n\n"
+       << "(Transform \"BSplineTransform\")\n"
+       << "\t(NumberOfParameters " << numberOfParameters << ")   // comment\n"
+       << "(InitialTransformParametersFileName \"No Initial Transform\")\n"
+       << "(GridSize 100 100 50)\n"
+       << "(TransformParameters";
+  file << std::setprecision( 10 );
+  for( unsigned int i = 0; i < numberOfParameters; ++i )
+  {
+    file << " " << 1.0e-3 * ( static_cast< double >( i % 9973 ) - 4986.5 );
+  }
+  file << ")\n";
+  file.close();
+
+  /** Time the parsing of the file. */
+  itk::TimeProbe parseProbe, oldParseProbe, newProbe, oldProbe;
+  ParserType::Pointer parser = ParserType::New();
+  parser->SetParameterFileName( fileName );
+  parseProbe.Start();
+  try
+  {
+    parser->ReadParameterFile();
+  }
+  catch( itk::ExceptionObject & excp )
+  {
+    std::cerr << "ERROR: reading the parameter file failed.\n" << excp << std::endl;
+    return 1;
+  }
+  parseProbe.Stop();
+
+  /** Time the parsing with regular expressions, as was done before. Both
+   * should give the same parameter map.
+   */
+  ParameterMapType oldParameterMap;
+  oldParseProbe.Start();
+  const bool oldParseSucceeded = ReadParameterFileWithRegularExpressions( fileName, oldParameterMap );
+  oldParseProbe.Stop();
+  if( !oldParseSucceeded || oldParameterMap != parser->GetParameterMap() )
+  {
+    std::cerr << "ERROR: the parameter map differs from the one parsed "
+              << "with regular expressions." << std::endl;
+    return 1;
+  }
+
+  InterfaceType::Pointer parameterMapInterface = InterfaceType::New();
+  parameterMapInterface->SetParameterMap( parser->GetParameterMap() );
+
+  /** Check the small parameters. */
+  std::string  transformName, initialName, errorMessage;
+  unsigned int numberOfParametersRead = 0;
+  unsigned int gridSize               = 0;
+  parameterMapInterface->ReadParameter( transformName, "Transform", 0, errorMessage );
+  parameterMapInterface->ReadParameter( initialName, "InitialTransformParametersFileName", 0, errorMessage );
+  parameterMapInterface->ReadParameter( numberOfParametersRead, "NumberOfParameters", 0, errorMessage );
+  parameterMapInterface->ReadParameter( gridSize, "GridSize", 2, errorMessage );
+  if( transformName != "BSplineTransform"
+    || initialName != "No Initial Transform"
+    || numberOfParametersRead != numberOfParameters
+    || gridSize != 50
+    || parameterMapInterface->CountNumberOfParameterEntries( "TransformParameters" ) != numberOfParameters )
+  {
+    std::cerr << "ERROR: the parameter file is not parsed correctly." << std::endl;
+    return 1;
+  }
+
+  /** Convert the TransformParameters directly into the parameters buffer. */
+  ParametersType parameters( numberOfParameters );
+  newProbe.Start();
+  parameterMapInterface->ReadParameter( parameters.data_block(), "TransformParameters",
+    0, numberOfParameters - 1, true, errorMessage );
+  newProbe.Stop();
+
+  /** Convert them with a string stream, as was done before. */
+  const InterfaceType::ParameterValuesType & values
+    = parser->GetParameterMap().find( "TransformParameters" )->second;
+  ParametersType parametersOld( numberOfParameters );
+  oldProbe.Start();
+  for( unsigned int i = 0; i < numberOfParameters; ++i )
+  {
+    std::stringstream ss( values[ i ] );
+    ss >> parametersOld[ i ];
+  }
+  oldProbe.Stop();
+
+  /** Both conversions should give exactly the same values. */
+  for( unsigned int i = 0; i < numberOfParameters; ++i )
+  {
+    if( parameters[ i ] != parametersOld[ i ] )
+    {
+      std::cerr << "ERROR: entry " << i << " is converted to "
+                << parameters[ i ] << " instead of " << parametersOld[ i ]
+                << std::endl;
+      return 1;
+    }
+  }
+
+  /** Report timings. */
+  std::cerr << "Number of parameters: " << numberOfParameters << std::endl;
+  std::cerr << "Time parsing the file:           "
+            << parseProbe.GetMean() << " " << parseProbe.GetUnit() << std::endl;
+  std::cerr << "Time parsing (regular expr.):    "
+            << oldParseProbe.GetMean() << " " << oldParseProbe.GetUnit() << std::endl;
+  std::cerr << "Speedup parsing: "
+            << oldParseProbe.GetMean() / parseProbe.GetMean() << std::endl;
+  std::cerr << "Time converting (direct):        "
+            << newProbe.GetMean() << " " << newProbe.GetUnit() << std::endl;
+  std::cerr << "Time converting (string stream): "
+            << oldProbe.GetMean() << " " << oldProbe.GetUnit() << std::endl;
+  std::cerr << "Speedup conversion: "
+            << oldProbe.GetMean() / newProbe.GetMean() << std::endl;
+
+  /** Invalid values should still be detected. */
+  std::ofstream invalidFile( fileName.c_str() );
+  invalidFile << "(TransformParameters 1.0 abc 2.0)\n";
+  invalidFile.close();
+  parser->ReadParameterFile();
+  parameterMapInterface->SetParameterMap( parser->GetParameterMap() );
+  bool exceptionThrown = false;
+  try
+  {
+    parameterMapInterface->ReadParameter( parameters.data_block(), "TransformParameters",
+      0, 2, true, errorMessage );
+  }
+  catch( itk::ExceptionObject & )
+  {
+    exceptionThrown = true;
+  }
+  if( !exceptionThrown )
+  {
+    std::cerr << "ERROR: an invalid value is not detected." << std::endl;
+    return 1;
+  }
+
+  /** Values out of the range of the requested type should be rejected,
+   * while 64 bit integers should be read on all platforms.
+   */
+  std::ofstream rangeFile( fileName.c_str() );
+  rangeFile << "(Large 1e400 5000000000 -5000000000 1.5)\n";
+  rangeFile.close();
+  parser->ReadParameterFile();
+  parameterMapInterface->SetParameterMap( parser->GetParameterMap() );
+  double             doubleValue  = 0.0;
+  unsigned int       uintValue    = 0;
+  itk::int64_t       int64Value   = 0;
+  const unsigned int entries[ 3 ] = { 0, 1, 2 };
+  for( unsigned int e = 0; e < 3; ++e )
+  {
+    exceptionThrown = false;
+    try
+    {
+      if( e == 0 )
+      {
+        parameterMapInterface->ReadParameter( doubleValue, "Large", entries[ e ], errorMessage );
+      }
+      else
+      {
+        parameterMapInterface->ReadParameter( uintValue, "Large", entries[ e ], errorMessage );
+      }
+    }
+    catch( itk::ExceptionObject & )
+    {
+      exceptionThrown = true;
+    }
+    if( !exceptionThrown )
+    {
+      std::cerr << "ERROR: the out of range entry " << entries[ e ] << " is not detected." << std::endl;
+      return 1;
+    }
+  }
+  parameterMapInterface->ReadParameter( int64Value, "Large", 2, errorMessage );
+  if( int64Value != -static_cast< itk::int64_t >( 5000000 ) * 1000 )
+  {
+    std::cerr << "ERROR: -5000000000 is read as " << int64Value << "." << std::endl;
+    return 1;
+  }
+
+  /** NaN, infinity and hexadecimal floating point numbers are not accepted
+   * by a string stream, and should be rejected. The leading number of a
+   * value is still used, as before.
+   */
+  std::ofstream specialFile( fileName.c_str() );
+  specialFile << "(Special nan -inf infinity 0x1p3 NAN 2.5e1abc -.5 +3.)\n";
+  specialFile.close();
+  parser->ReadParameterFile();
+  parameterMapInterface->SetParameterMap( parser->GetParameterMap() );
+  for( unsigned int e = 0; e < 5; ++e )
+  {
+    float floatValue = 0.0f;
+    exceptionThrown = false;
+    try
+    {
+      parameterMapInterface->ReadParameter( doubleValue, "Special", e, errorMessage );
+    }
+    catch( itk::ExceptionObject & )
+    {
+      exceptionThrown = true;
+    }
+    bool floatExceptionThrown = false;
+    try
+    {
+      parameterMapInterface->ReadParameter( floatValue, "Special", e, errorMessage );
+    }
+    catch( itk::ExceptionObject & )
+    {
+      floatExceptionThrown = true;
+    }
+    if( !exceptionThrown || !floatExceptionThrown )
+    {
+      std::cerr << "ERROR: the special entry " << e << " is not rejected." << std::endl;
+      return 1;
+    }
+  }
+  const double expectedSpecial[ 3 ] = { 25.0, -0.5, 3.0 };
+  for( unsigned int e = 0; e < 3; ++e )
+  {
+    parameterMapInterface->ReadParameter( doubleValue, "Special", 5 + e, errorMessage );
+    if( doubleValue != expectedSpecial[ e ] )
+    {
+      std::cerr << "ERROR: the special entry " << 5 + e << " is read as " << doubleValue
+                << " instead of " << expectedSpecial[ e ] << "." << std::endl;
+      return 1;
+    }
+  }
+
+  /** The decimal point should not depend on the global locale. Skip this
+   * check when no locale with a decimal comma is installed.
+   */
+  const char * commaLocales[ 3 ] = { "de_DE.UTF-8", "de_DE", "German" };
+  for( unsigned int l = 0; l < 3; ++l )
+  {
+    if( std::setlocale( LC_NUMERIC, commaLocales[ l ] ) != 0 )
+    {
+      parameterMapInterface->ReadParameter( doubleValue, "Large", 3, errorMessage );
+      std::setlocale( LC_NUMERIC, "C" );
+      if( doubleValue != 1.5 )
+      {
+        std::cerr << "ERROR: 1.5 is read as " << doubleValue << " in the "
+                  << commaLocales[ l ] << " locale." << std::endl;
+        return 1;
+      }
+      break;
+    }
+  }
+
+  /** Return a value. */
+  return 0;
+
+} // end main
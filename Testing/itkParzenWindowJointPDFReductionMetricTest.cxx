@@ -0,0 +1,223 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+/** \file
+ \brief Check the value and derivative of the multi-threaded mutual
+ information metric, with and without UseParallelJointPDFReduction, against
+ the original single-threaded implementation. New samples are drawn and the
+ parameters are updated in every iteration, so that the threads touch other
+ histogram rows each time. This checks the fixed bin range of each thread,
+ and that the per-thread joint histograms are cleared after the parallel
+ reduction. In the first iteration, the derivative of the single-threaded
+ metric is also checked with central finite differences of its value.
+ */
+
+#include "elxMacro.h"
+#include "xoutmain.h"
+
+#include "AdvancedMattesMutualInformation/itkParzenWindowMutualInformationImageToImageMetric.h"
+#include "itkAdvancedBSplineDeformableTransform.h"
+#include "itkBSplineInterpolateImageFunction.h"
+#include "itkHardLimiterFunction.h"
+#include "itkImageRandomSampler.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include <cmath>
+#include <iostream>
+
+//-------------------------------------------------------------------------------------
+
+int
+main( void )
+{
+  const unsigned int Dimension   = 3;
+  const unsigned int SplineOrder = 3;
+  typedef float                                          PixelType;
+  typedef double                                         CoordinateRepresentationType;
+  typedef itk::Image< PixelType, Dimension >             ImageType;
+  typedef itk::AdvancedBSplineDeformableTransform<
+    CoordinateRepresentationType, Dimension, SplineOrder > TransformType;
+  typedef itk::BSplineInterpolateImageFunction<
+    ImageType, CoordinateRepresentationType, double >     InterpolatorType;
+  typedef itk::ImageRandomSampler< ImageType >            SamplerType;
+  typedef itk::ParzenWindowMutualInformationImageToImageMetric<
+    ImageType, ImageType >                                MetricType;
+  typedef itk::HardLimiterFunction< MetricType::RealType, Dimension > LimiterType;
+  typedef MetricType::TransformParametersType             ParametersType;
+  typedef MetricType::DerivativeType                      DerivativeType;
+
+  /** Create a fixed and a moving image with an anisotropic blob, shifted
+   * by two voxels in every dimension.
+   */
+  ImageType::SizeType imageSize;
+  imageSize.Fill( 32 );
+  ImageType::Pointer images[ 2 ];
+  for( unsigned int i = 0; i < 2; ++i )
+  {
+    images[ i ] = ImageType::New();
+    images[ i ]->SetRegions( imageSize );
+    images[ i ]->Allocate();
+    itk::ImageRegionIteratorWithIndex< ImageType > it( images[ i ], images[ i ]->GetBufferedRegion() );
+    for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+      double r2 = 0.0;
+      for( unsigned int d = 0; d < Dimension; ++d )
+      {
+        const double x = ( it.GetIndex()[ d ] - 16.0 - 2.0 * i ) / ( d + 1.0 );
+        r2 += x * x;
+      }
+      it.Set( 100.0 * std::exp( -r2 / 48.0 ) );
+    }
+  }
+
+  /** A B-spline transform with 8 control points per dimension, whose grid
+   * covers the image.
+   */
+  TransformType::Pointer    transform = TransformType::New();
+  TransformType::RegionType gridRegion;
+  TransformType::SizeType   gridSize;
+  gridSize.Fill( 8 );
+  gridRegion.SetSize( gridSize );
+  TransformType::SpacingType gridSpacing;
+  gridSpacing.Fill( 32.0 / 5.0 );
+  TransformType::OriginType gridOrigin;
+  gridOrigin.Fill( -1.5 * 32.0 / 5.0 );
+  transform->SetGridOrigin( gridOrigin );
+  transform->SetGridSpacing( gridSpacing );
+  transform->SetGridRegion( gridRegion );
+  const unsigned int numberOfParameters = transform->GetNumberOfParameters();
+  ParametersType     parameters( numberOfParameters );
+  parameters.Fill( 0.0 );
+  transform->SetParameters( parameters );
+
+  /** Setup a single-threaded metric, and multi-threaded metrics without and
+   * with the parallel joint histogram reduction, sharing the samples.
+   */
+  SamplerType::Pointer sampler = SamplerType::New();
+  sampler->SetNumberOfSamples( 3000 );
+
+  const char * names[ 3 ] = {
+    "single-threaded", "multi-threaded", "multi-threaded with parallel reduction"
+  };
+  MetricType::Pointer metrics[ 3 ];
+  for( unsigned int m = 0; m < 3; ++m )
+  {
+    metrics[ m ] = MetricType::New();
+    metrics[ m ]->SetFixedImage( images[ 0 ] );
+    metrics[ m ]->SetMovingImage( images[ 1 ] );
+    metrics[ m ]->SetFixedImageRegion( images[ 0 ]->GetBufferedRegion() );
+    metrics[ m ]->SetTransform( transform );
+    InterpolatorType::Pointer interpolator = InterpolatorType::New();
+    interpolator->SetSplineOrder( 3 );
+    metrics[ m ]->SetInterpolator( interpolator );
+    metrics[ m ]->SetImageSampler( sampler );
+    metrics[ m ]->SetFixedImageLimiter( LimiterType::New() );
+    metrics[ m ]->SetMovingImageLimiter( LimiterType::New() );
+    metrics[ m ]->SetNumberOfFixedHistogramBins( 32 );
+    metrics[ m ]->SetNumberOfMovingHistogramBins( 32 );
+    metrics[ m ]->SetUseExplicitPDFDerivatives( false );
+    metrics[ m ]->SetUseMultiThread( m > 0 );
+    metrics[ m ]->SetUseParallelJointPDFReduction( m == 2 );
+    metrics[ m ]->SetNumberOfThreads( 3 );
+    metrics[ m ]->Initialize();
+  }
+
+  /** Compare the metrics in a few iterations of a gradient descent. */
+  const unsigned int      numberOfIterations = 5;
+  MetricType::MeasureType values[ 3 ];
+  MetricType::MeasureType valuesOnly[ 3 ];
+  DerivativeType          derivatives[ 3 ];
+  for( unsigned int iter = 0; iter < numberOfIterations; ++iter )
+  {
+    /** Draw new samples, shared by all metrics. */
+    sampler->Modified();
+    sampler->Update();
+
+    for( unsigned int m = 0; m < 3; ++m )
+    {
+      derivatives[ m ].SetSize( numberOfParameters );
+      metrics[ m ]->GetValueAndDerivative( parameters, values[ m ], derivatives[ m ] );
+      valuesOnly[ m ] = metrics[ m ]->GetValue( parameters );
+    }
+
+    /** The derivative of the single-threaded metric should match its
+     * finite differences, here for every 37th parameter.
+     */
+    const double maxDerivative = derivatives[ 0 ].inf_norm();
+    if( maxDerivative == 0.0 )
+    {
+      std::cerr << "ERROR: the derivative in iteration " << iter << " is zero." << std::endl;
+      return 1;
+    }
+    if( iter == 0 )
+    {
+      const double   delta = 1e-3;
+      ParametersType perturbedParameters( parameters );
+      for( unsigned int j = 0; j < numberOfParameters; j += 37 )
+      {
+        perturbedParameters[ j ] = parameters[ j ] + delta;
+        const double valuePlus = metrics[ 0 ]->GetValue( perturbedParameters );
+        perturbedParameters[ j ] = parameters[ j ] - delta;
+        const double valueMinus = metrics[ 0 ]->GetValue( perturbedParameters );
+        perturbedParameters[ j ] = parameters[ j ];
+
+        const double finiteDifference = ( valuePlus - valueMinus ) / ( 2.0 * delta );
+        if( std::abs( derivatives[ 0 ][ j ] - finiteDifference ) > 1e-2 * maxDerivative )
+        {
+          std::cerr << "ERROR: derivative " << j << " is " << derivatives[ 0 ][ j ]
+                    << ", while the finite difference is " << finiteDifference
+                    << " and the largest element is " << maxDerivative << "." << std::endl;
+          return 1;
+        }
+      }
+      transform->SetParameters( parameters );
+    }
+
+    /** The threaded results should be those of the original single-threaded
+     * code, up to the order of the summation.
+     */
+    for( unsigned int m = 0; m < 3; ++m )
+    {
+      if( std::abs( values[ m ] - values[ 0 ] ) > 1e-10 * ( 1.0 + std::abs( values[ 0 ] ) )
+        || std::abs( valuesOnly[ m ] - values[ 0 ] ) > 1e-10 * ( 1.0 + std::abs( values[ 0 ] ) ) )
+      {
+        std::cerr << "ERROR: the " << names[ m ] << " value in iteration " << iter << " is "
+                  << values[ m ] << " (GetValue: " << valuesOnly[ m ] << ") instead of "
+                  << values[ 0 ] << "." << std::endl;
+        return 1;
+      }
+      const double difference = ( derivatives[ 0 ] - derivatives[ m ] ).inf_norm();
+      if( difference > 1e-10 * ( 1.0 + maxDerivative ) )
+      {
+        std::cerr << "ERROR: the " << names[ m ] << " derivative in iteration " << iter
+                  << " differs by " << difference << "." << std::endl;
+        return 1;
+      }
+    }
+    std::cerr << "Iteration " << iter << ": value " << values[ 0 ] << std::endl;
+
+    /** Take a step of at most one voxel. */
+    for( unsigned int j = 0; j < numberOfParameters; ++j )
+    {
+      parameters[ j ] -= derivatives[ 0 ][ j ] / maxDerivative;
+    }
+  }
+
+  /** Return a value. */
+  return 0;
+
+} // end main
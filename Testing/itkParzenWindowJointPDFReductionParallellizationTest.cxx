@@ -0,0 +1,306 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkSmartPointer.h"
+#include "itkObject.h"
+#include <vector>
+#include <algorithm>
+#include <iomanip>
+#include "itkNumericTraits.h"
+
+// Report timings
+#include "itkTimeProbe.h"
+#include "itkTimeProbesCollectorBase.h"
+
+// Multi-threading using ITK threads
+#include "itkMultiThreader.h"
+
+/**
+ * This test mimics the computation of the joint histogram in the
+ * ParzenWindowHistogramImageToImageMetric with multiple threads.
+ * Every thread fills its own joint histogram with a part of the samples,
+ * after which the histograms are summed. This is done in two ways:
+ * - serial: every thread clears its complete histogram before use, and
+ *   the histograms are summed by a single thread afterwards;
+ * - parallel: every thread sums a block of histogram rows over all threads,
+ *   visiting only the rows that were touched by a thread, and clears them.
+ * The results are compared and the timings are reported for 1 to 64 threads.
+ */
+
+typedef double       PDFValueType;
+typedef unsigned int ThreadIdType;
+
+class JointPDFTEMP : public itk::Object
+{
+public:
+
+  /** Standard class typedefs. */
+  typedef JointPDFTEMP              Self;
+  typedef itk::SmartPointer< Self > Pointer;
+  itkNewMacro( Self );
+
+  typedef std::vector< PDFValueType >    JointPDFType;
+  typedef itk::MultiThreader             ThreaderType;
+  typedef ThreaderType::ThreadInfoStruct ThreadInfoType;
+
+  /** Histogram sizes; the moving bins are stored contiguously per fixed bin. */
+  long          m_NumberOfFixedBins;
+  long          m_NumberOfMovingBins;
+  unsigned long m_NumberOfSamples;
+  bool          m_UseParallelReduction;
+
+  /** Per-thread data. */
+  std::vector< JointPDFType > m_ThreaderJointPDFs;
+  std::vector< long >         m_FixedBinBegin;
+  std::vector< long >         m_FixedBinEnd;
+  JointPDFType                m_JointPDF;
+
+  ThreaderType::Pointer m_Threader;
+  ThreadIdType          m_NumberOfThreads;
+
+  // Constructor
+  JointPDFTEMP()
+  {
+    this->m_NumberOfFixedBins    = 0;
+    this->m_NumberOfMovingBins   = 0;
+    this->m_NumberOfSamples      = 0;
+    this->m_UseParallelReduction = false;
+    this->m_Threader             = ThreaderType::New();
+    this->m_NumberOfThreads      = this->m_Threader->GetNumberOfThreads();
+  }
+
+
+  /** Allocate and clear all histograms. */
+  void Initialize( void )
+  {
+    this->m_NumberOfThreads = this->m_Threader->GetNumberOfThreads();
+    const std::size_t size = this->m_NumberOfFixedBins * this->m_NumberOfMovingBins;
+    this->m_JointPDF.assign( size, 0.0 );
+    this->m_ThreaderJointPDFs.assign( this->m_NumberOfThreads, JointPDFType( size, 0.0 ) );
+    this->m_FixedBinBegin.assign( this->m_NumberOfThreads, 0 );
+    this->m_FixedBinEnd.assign( this->m_NumberOfThreads, 0 );
+  }
+
+
+  /** Compute the joint histogram. */
+  void ComputePDFs( void )
+  {
+    this->m_Threader->SetSingleMethod( this->ComputePDFsThreaderCallback, this );
+    this->m_Threader->SingleMethodExecute();
+
+    if( this->m_UseParallelReduction )
+    {
+      this->m_Threader->SetSingleMethod( this->ReduceJointPDFsThreaderCallback, this );
+      this->m_Threader->SingleMethodExecute();
+    }
+    else
+    {
+      std::fill( this->m_JointPDF.begin(), this->m_JointPDF.end(), 0.0 );
+      for( ThreadIdType i = 0; i < this->m_NumberOfThreads; ++i )
+      {
+        for( std::size_t j = 0; j < this->m_JointPDF.size(); ++j )
+        {
+          this->m_JointPDF[ j ] += this->m_ThreaderJointPDFs[ i ][ j ];
+        }
+      }
+    }
+  } // end ComputePDFs()
+
+
+  /** Fill the histogram of this thread with a Parzen window per sample,
+   * of one fixed bin and four moving bins, like the default Mattes setting.
+   */
+  void ThreadedComputePDFs( ThreadIdType threadID )
+  {
+    JointPDFType & jointPDF = this->m_ThreaderJointPDFs[ threadID ];
+    if( !this->m_UseParallelReduction )
+    {
+      std::fill( jointPDF.begin(), jointPDF.end(), 0.0 );
+    }
+
+    const unsigned long nrOfSamplesPerThreads = static_cast< unsigned long >( vcl_ceil(
+      static_cast< double >( this->m_NumberOfSamples ) / static_cast< double >( this->m_NumberOfThreads ) ) );
+    unsigned long pos_begin = nrOfSamplesPerThreads * threadID;
+    unsigned long pos_end   = nrOfSamplesPerThreads * ( threadID + 1 );
+    pos_begin = ( pos_begin > this->m_NumberOfSamples ) ? this->m_NumberOfSamples : pos_begin;
+    pos_end   = ( pos_end > this->m_NumberOfSamples ) ? this->m_NumberOfSamples : pos_end;
+
+    long fixedBinBegin = this->m_NumberOfFixedBins;
+    long fixedBinEnd   = 0;
+    for( unsigned long s = pos_begin; s < pos_end; ++s )
+    {
+      /** Deterministic pseudo-random sample values, independent of the number of threads. */
+      const unsigned long hash = ( s * 2654435761UL ) % 1000003UL;
+      const long          f    = 2 + static_cast< long >( hash % ( this->m_NumberOfFixedBins - 4 ) );
+      const long          m    = static_cast< long >( ( hash / 7 ) % ( this->m_NumberOfMovingBins - 4 ) );
+      const double        t    = static_cast< double >( hash % 1000 ) / 1000.0;
+
+      /** Cubic B-spline weights. */
+      const double w[ 4 ] = {
+        ( 1.0 - t ) * ( 1.0 - t ) * ( 1.0 - t ) / 6.0,
+        ( 3.0 * t * t * t - 6.0 * t * t + 4.0 ) / 6.0,
+        ( -3.0 * t * t * t + 3.0 * t * t + 3.0 * t + 1.0 ) / 6.0,
+        t * t * t / 6.0
+      };
+      PDFValueType * it = &jointPDF[ f * this->m_NumberOfMovingBins + m ];
+      for( unsigned int k = 0; k < 4; ++k )
+      {
+        it[ k ] += w[ k ];
+      }
+
+      fixedBinBegin = std::min( fixedBinBegin, f );
+      fixedBinEnd   = std::max( fixedBinEnd, f + 1 );
+    }
+
+    this->m_FixedBinBegin[ threadID ] = fixedBinBegin;
+    this->m_FixedBinEnd[ threadID ]   = fixedBinEnd;
+
+  } // end ThreadedComputePDFs()
+
+
+  /** Sum a block of rows over all threads, and clear them. */
+  void ThreadedReduceJointPDFs( ThreadIdType threadID )
+  {
+    const long nrOfRowsPerThread = static_cast< long >( vcl_ceil(
+      static_cast< double >( this->m_NumberOfFixedBins ) / static_cast< double >( this->m_NumberOfThreads ) ) );
+    long row_begin = nrOfRowsPerThread * threadID;
+    long row_end   = nrOfRowsPerThread * ( threadID + 1 );
+    row_begin = ( row_begin > this->m_NumberOfFixedBins ) ? this->m_NumberOfFixedBins : row_begin;
+    row_end   = ( row_end > this->m_NumberOfFixedBins ) ? this->m_NumberOfFixedBins : row_end;
+    if( row_begin == row_end ) { return; }
+
+    PDFValueType * jointPDF = &this->m_JointPDF[ 0 ];
+    std::fill( jointPDF + row_begin * this->m_NumberOfMovingBins,
+      jointPDF + row_end * this->m_NumberOfMovingBins, 0.0 );
+
+    for( ThreadIdType i = 0; i < this->m_NumberOfThreads; ++i )
+    {
+      const long begin = std::max( row_begin, this->m_FixedBinBegin[ i ] );
+      const long end   = std::min( row_end, this->m_FixedBinEnd[ i ] );
+      if( begin >= end ) { continue; }
+
+      PDFValueType *       threadIt  = &this->m_ThreaderJointPDFs[ i ][ 0 ] + begin * this->m_NumberOfMovingBins;
+      PDFValueType * const threadEnd = &this->m_ThreaderJointPDFs[ i ][ 0 ] + end * this->m_NumberOfMovingBins;
+      PDFValueType *       it        = jointPDF + begin * this->m_NumberOfMovingBins;
+      for(; threadIt != threadEnd; ++threadIt, ++it )
+      {
+        *it      += *threadIt;
+        *threadIt = 0.0;
+      }
+    }
+
+  } // end ThreadedReduceJointPDFs()
+
+
+  static ITK_THREAD_RETURN_TYPE ComputePDFsThreaderCallback( void * arg )
+  {
+    ThreadInfoType * infoStruct = static_cast< ThreadInfoType * >( arg );
+    static_cast< Self * >( infoStruct->UserData )->ThreadedComputePDFs( infoStruct->ThreadID );
+    return ITK_THREAD_RETURN_VALUE;
+  }
+
+
+  static ITK_THREAD_RETURN_TYPE ReduceJointPDFsThreaderCallback( void * arg )
+  {
+    ThreadInfoType * infoStruct = static_cast< ThreadInfoType * >( arg );
+    static_cast< Self * >( infoStruct->UserData )->ThreadedReduceJointPDFs( infoStruct->ThreadID );
+    return ITK_THREAD_RETURN_VALUE;
+  }
+
+
+};
+
+// end class JointPDFTEMP
+
+//-------------------------------------------------------------------------------------
+
+int
+main( int argc, char * argv[] )
+{
+  std::cout << std::fixed << std::showpoint << std::setprecision( 8 );
+
+  JointPDFTEMP::Pointer metric = JointPDFTEMP::New();
+
+  // test parameters
+  std::vector< long > histogramSizes;
+  histogramSizes.push_back( 32 ); histogramSizes.push_back( 64 );
+  histogramSizes.push_back( 128 ); histogramSizes.push_back( 256 );
+  std::vector< unsigned long > numberOfSamples;
+  numberOfSamples.push_back( 2000 ); numberOfSamples.push_back( 20000 );
+  std::vector< ThreadIdType > numberOfThreads;
+  numberOfThreads.push_back( 1 ); numberOfThreads.push_back( 2 ); numberOfThreads.push_back( 4 );
+  numberOfThreads.push_back( 8 ); numberOfThreads.push_back( 16 ); numberOfThreads.push_back( 32 );
+  numberOfThreads.push_back( 64 );
+  unsigned int repetitions = 10; // increase for more accurate timings
+
+  for( unsigned int h = 0; h < histogramSizes.size(); ++h )
+  {
+    for( unsigned int n = 0; n < numberOfSamples.size(); ++n )
+    {
+      std::cout << "Histogram size = " << histogramSizes[ h ] << "x" << histogramSizes[ h ]
+                << ", number of samples = " << numberOfSamples[ n ] << std::endl;
+
+      metric->m_NumberOfFixedBins  = histogramSizes[ h ];
+      metric->m_NumberOfMovingBins = histogramSizes[ h ];
+      metric->m_NumberOfSamples    = numberOfSamples[ n ];
+
+      for( unsigned int t = 0; t < numberOfThreads.size(); ++t )
+      {
+        metric->m_Threader->SetNumberOfThreads( numberOfThreads[ t ] );
+        itk::TimeProbe serialTimer;
+        itk::TimeProbe parallelTimer;
+
+        /** Time the serial reduction. */
+        metric->m_UseParallelReduction = false;
+        metric->Initialize();
+        for( unsigned int i = 0; i < repetitions; ++i )
+        {
+          serialTimer.Start();
+          metric->ComputePDFs();
+          serialTimer.Stop();
+        }
+        const JointPDFTEMP::JointPDFType serialJointPDF = metric->m_JointPDF;
+
+        /** Time the parallel reduction. */
+        metric->m_UseParallelReduction = true;
+        metric->Initialize();
+        for( unsigned int i = 0; i < repetitions; ++i )
+        {
+          parallelTimer.Start();
+          metric->ComputePDFs();
+          parallelTimer.Stop();
+        }
+
+        /** The summation order per bin is the same, so the results should be identical. */
+        if( serialJointPDF != metric->m_JointPDF )
+        {
+          std::cerr << "ERROR: the serial and parallel joint histograms differ for "
+                    << metric->m_NumberOfThreads << " threads." << std::endl;
+          return EXIT_FAILURE;
+        }
+
+        std::cout << "  threads: " << std::setw( 2 ) << metric->m_NumberOfThreads
+                  << "  serial: " << serialTimer.GetMean()
+                  << "  parallel: " << parallelTimer.GetMean() << std::endl;
+      }
+      std::cout << std::endl;
+    }
+  }
+
+  return EXIT_SUCCESS;
+
+} // end main
@@ -0,0 +1,211 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+/** \file
+ \brief Test the PersistentThreadPool: every thread id is executed once, nested
+ and concurrent jobs do not hang, exceptions are passed on, and compare the
+ time of many small jobs with the MultiThreader.
+ */
+
+#include "itkPersistentThreadPool.h"
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
+#include "itkTimeProbe.h"
+
+#include <iostream>
+#include <vector>
+
+//-------------------------------------------------------------------------------------
+
+namespace
+{
+
+typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+
+/** Counts the calls per thread id. */
+struct CountData
+{
+  std::vector< unsigned int > m_Counts;
+  itk::SimpleFastMutexLock    m_Mutex;
+};
+
+ITK_THREAD_RETURN_TYPE
+CountCallback( void * arg )
+{
+  ThreadInfoType * info = static_cast< ThreadInfoType * >( arg );
+  CountData *      data = static_cast< CountData * >( info->UserData );
+  data->m_Mutex.Lock();
+  ++data->m_Counts[ info->ThreadID ];
+  data->m_Mutex.Unlock();
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+/** Starts a nested job from within each thread. */
+ITK_THREAD_RETURN_TYPE
+NestedCallback( void * arg )
+{
+  ThreadInfoType * info = static_cast< ThreadInfoType * >( arg );
+  itk::PersistentThreadPool::SingleMethodExecute( CountCallback,
+    info->UserData, info->NumberOfThreads );
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+ITK_THREAD_RETURN_TYPE
+ThrowingCallback( void * arg )
+{
+  ThreadInfoType * info = static_cast< ThreadInfoType * >( arg );
+  if( info->ThreadID == info->NumberOfThreads - 1 )
+  {
+    itkGenericExceptionMacro( << "Exception in the last thread." );
+  }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+/** Some work, so that a job takes a bit of time. */
+ITK_THREAD_RETURN_TYPE
+WorkCallback( void * arg )
+{
+  ThreadInfoType * info   = static_cast< ThreadInfoType * >( arg );
+  double *         result = static_cast< double * >( info->UserData );
+  double           sum    = 0.0;
+  for( unsigned int i = 0; i < 1000; ++i )
+  {
+    sum += 1.0 / ( 1.0 + i + info->ThreadID );
+  }
+  result[ info->ThreadID ] = sum;
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+} // end namespace
+
+int
+main( void )
+{
+  const itk::ThreadIdType numberOfThreads
+    = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+  std::cerr << "Number of worker threads: "
+            << itk::PersistentThreadPool::GetNumberOfWorkerThreads() << std::endl;
+
+  /** Every thread id is executed exactly once, also when more threads are
+   * requested than there are workers.
+   */
+  const itk::ThreadIdType threadCounts[] = { 1, 2, numberOfThreads, 3 * numberOfThreads + 1 };
+  for( unsigned int t = 0; t < 4; ++t )
+  {
+    CountData data;
+    data.m_Counts.assign( threadCounts[ t ], 0 );
+    for( unsigned int r = 0; r < 100; ++r )
+    {
+      itk::PersistentThreadPool::SingleMethodExecute( CountCallback, &data, threadCounts[ t ] );
+    }
+    for( itk::ThreadIdType i = 0; i < threadCounts[ t ]; ++i )
+    {
+      if( data.m_Counts[ i ] != 100 )
+      {
+        std::cerr << "ERROR: thread " << i << " of " << threadCounts[ t ]
+                  << " is executed " << data.m_Counts[ i ] << " times instead of 100."
+                  << std::endl;
+        return 1;
+      }
+    }
+  }
+
+  /** Nested jobs should not hang. */
+  CountData nestedData;
+  nestedData.m_Counts.assign( numberOfThreads, 0 );
+  itk::PersistentThreadPool::SingleMethodExecute( NestedCallback, &nestedData, numberOfThreads );
+  for( itk::ThreadIdType i = 0; i < numberOfThreads; ++i )
+  {
+    if( nestedData.m_Counts[ i ] != numberOfThreads )
+    {
+      std::cerr << "ERROR: nested thread " << i << " is executed "
+                << nestedData.m_Counts[ i ] << " times instead of "
+                << numberOfThreads << "." << std::endl;
+      return 1;
+    }
+  }
+
+  /** Concurrent jobs, started by the threads of a MultiThreader, should not hang. */
+  CountData concurrentData;
+  concurrentData.m_Counts.assign( numberOfThreads, 0 );
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads( numberOfThreads );
+  threader->SetSingleMethod( NestedCallback, &concurrentData );
+  threader->SingleMethodExecute();
+  for( itk::ThreadIdType i = 0; i < numberOfThreads; ++i )
+  {
+    if( concurrentData.m_Counts[ i ] != numberOfThreads )
+    {
+      std::cerr << "ERROR: concurrent thread " << i << " is executed "
+                << concurrentData.m_Counts[ i ] << " times instead of "
+                << numberOfThreads << "." << std::endl;
+      return 1;
+    }
+  }
+
+  /** An exception in a thread should be passed on to the caller. */
+  bool exceptionThrown = false;
+  try
+  {
+    itk::PersistentThreadPool::SingleMethodExecute( ThrowingCallback, 0, numberOfThreads + 1 );
+  }
+  catch( itk::ExceptionObject & )
+  {
+    exceptionThrown = true;
+  }
+  if( !exceptionThrown )
+  {
+    std::cerr << "ERROR: an exception in a thread is not passed on." << std::endl;
+    return 1;
+  }
+
+  /** Compare the time of many small jobs with the MultiThreader. */
+  const unsigned int    numberOfJobs = 10000;
+  std::vector< double > results( numberOfThreads );
+  itk::TimeProbe        poolProbe, threaderProbe;
+
+  poolProbe.Start();
+  for( unsigned int j = 0; j < numberOfJobs; ++j )
+  {
+    itk::PersistentThreadPool::SingleMethodExecute( WorkCallback, &results[ 0 ], numberOfThreads );
+  }
+  poolProbe.Stop();
+
+  threader->SetSingleMethod( WorkCallback, &results[ 0 ] );
+  threaderProbe.Start();
+  for( unsigned int j = 0; j < numberOfJobs; ++j )
+  {
+    threader->SingleMethodExecute();
+  }
+  threaderProbe.Stop();
+
+  /** Report timings. */
+  std::cerr << "Number of jobs: " << numberOfJobs << std::endl;
+  std::cerr << "Time PersistentThreadPool: " << poolProbe.GetMean() << " "
+            << poolProbe.GetUnit() << std::endl;
+  std::cerr << "Time MultiThreader:        " << threaderProbe.GetMean() << " "
+            << threaderProbe.GetUnit() << std::endl;
+  std::cerr << "Speedup: " << threaderProbe.GetMean() / poolProbe.GetMean() << std::endl;
+
+  /** Return a value. */
+  return 0;
+
+} // end main
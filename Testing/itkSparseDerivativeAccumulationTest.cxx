@@ -0,0 +1,246 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+/** \file
+ \brief Compare the derivative of the advanced mean squares metric with a
+ B-spline transform, multi-threaded, which only accumulates the derivative
+ blocks touched by the threads, and single-threaded, with a dense reference.
+ The reference adds the full-length contribution of every sample to the
+ derivative, using the Jacobian of the transform. Several iterations are
+ compared, to check that the per-thread derivatives are reset.
+ */
+
+#include "elxMacro.h"
+#include "xoutmain.h"
+
+#include "AdvancedMeanSquares/itkAdvancedMeanSquaresImageToImageMetric.h"
+#include "itkAdvancedBSplineDeformableTransform.h"
+#include "itkAdvancedLinearInterpolateImageFunction.h"
+#include "itkImageRandomSampler.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTimeProbe.h"
+
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+
+const unsigned int Dimension   = 3;
+const unsigned int SplineOrder = 3;
+typedef float                                          PixelType;
+typedef double                                         CoordinateRepresentationType;
+typedef itk::Image< PixelType, Dimension >             ImageType;
+typedef itk::AdvancedBSplineDeformableTransform<
+  CoordinateRepresentationType, Dimension, SplineOrder > TransformType;
+typedef itk::AdvancedLinearInterpolateImageFunction<
+  ImageType, CoordinateRepresentationType >             InterpolatorType;
+typedef itk::ImageRandomSampler< ImageType >            SamplerType;
+typedef itk::AdvancedMeanSquaresImageToImageMetric<
+  ImageType, ImageType >                                MetricType;
+typedef MetricType::TransformParametersType             ParametersType;
+typedef MetricType::DerivativeType                      DerivativeType;
+
+/** Compute the mean squares value and derivative over the samples, with a
+ * dense derivative vector for every sample.
+ */
+void
+ComputeDenseReference( const TransformType * transform, ImageType * movingImage,
+  const SamplerType::ImageSampleContainerType * samples,
+  double & value, DerivativeType & derivative )
+{
+  const unsigned int numberOfParameters = transform->GetNumberOfParameters();
+
+  InterpolatorType::Pointer interpolator = InterpolatorType::New();
+  interpolator->SetInputImage( movingImage );
+
+  TransformType::JacobianType               jacobian;
+  TransformType::NonZeroJacobianIndicesType nzji;
+  DerivativeType                            sampleDerivative( numberOfParameters );
+  derivative.SetSize( numberOfParameters );
+  derivative.Fill( 0.0 );
+  value = 0.0;
+  unsigned long numberOfPixelsCounted = 0;
+
+  for( unsigned long i = 0; i < samples->Size(); ++i )
+  {
+    const ImageType::PointType & fixedPoint  = samples->ElementAt( i ).m_ImageCoordinates;
+    const ImageType::PointType   mappedPoint = transform->TransformPoint( fixedPoint );
+    InterpolatorType::ContinuousIndexType cindex;
+    interpolator->ConvertPointToContinuousIndex( mappedPoint, cindex );
+    if( !interpolator->IsInsideBuffer( cindex ) )
+    {
+      continue;
+    }
+    ++numberOfPixelsCounted;
+
+    InterpolatorType::OutputType          movingValue;
+    InterpolatorType::CovariantVectorType movingGradient;
+    interpolator->EvaluateValueAndDerivativeAtContinuousIndex( cindex, movingValue, movingGradient );
+    const double diff = movingValue - samples->ElementAt( i ).m_ImageValue;
+    value += diff * diff;
+
+    /** The full-length contribution of this sample. */
+    transform->GetJacobian( fixedPoint, jacobian, nzji );
+    sampleDerivative.Fill( 0.0 );
+    for( unsigned int j = 0; j < nzji.size(); ++j )
+    {
+      double inner = 0.0;
+      for( unsigned int d = 0; d < Dimension; ++d )
+      {
+        inner += movingGradient[ d ] * jacobian( d, j );
+      }
+      sampleDerivative[ nzji[ j ] ] = 2.0 * diff * inner;
+    }
+    derivative += sampleDerivative;
+  }
+
+  value      /= numberOfPixelsCounted;
+  derivative /= numberOfPixelsCounted;
+
+} // end ComputeDenseReference()
+
+
+} // end namespace
+
+//-------------------------------------------------------------------------------------
+
+int
+main( void )
+{
+  /** Create a fixed and a moving image with a Gaussian blob, shifted by 2 voxels. */
+  ImageType::SizeType imageSize;
+  imageSize.Fill( 64 );
+  ImageType::Pointer images[ 2 ];
+  for( unsigned int i = 0; i < 2; ++i )
+  {
+    images[ i ] = ImageType::New();
+    images[ i ]->SetRegions( imageSize );
+    images[ i ]->Allocate();
+    itk::ImageRegionIteratorWithIndex< ImageType > it( images[ i ], images[ i ]->GetBufferedRegion() );
+    for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+      double r2 = 0.0;
+      for( unsigned int d = 0; d < Dimension; ++d )
+      {
+        const double x = it.GetIndex()[ d ] - 32.0 - 2.0 * i;
+        r2 += x * x;
+      }
+      it.Set( static_cast< PixelType >( 100.0 * std::exp( -r2 / 128.0 ) ) );
+    }
+  }
+
+  /** A fine B-spline grid of 24 control points per dimension covering the
+   * image, so that the samples of a thread only touch a part of the
+   * parameters.
+   */
+  TransformType::SizeType    gridSize;
+  TransformType::SpacingType gridSpacing;
+  TransformType::OriginType  gridOrigin;
+  gridSize.Fill( 24 );
+  gridSpacing.Fill( 64.0 / ( 24 - SplineOrder ) );
+  gridOrigin.Fill( -1.5 * gridSpacing[ 0 ] );
+  TransformType::RegionType gridRegion;
+  gridRegion.SetSize( gridSize );
+  TransformType::Pointer transform = TransformType::New();
+  transform->SetGridOrigin( gridOrigin );
+  transform->SetGridSpacing( gridSpacing );
+  transform->SetGridRegion( gridRegion );
+  const unsigned int numberOfParameters = transform->GetNumberOfParameters();
+  ParametersType     parameters( numberOfParameters );
+  parameters.Fill( 0.0 );
+  transform->SetParametersByValue( parameters );
+
+  /** Setup a single-threaded and a multi-threaded metric, sharing the samples. */
+  SamplerType::Pointer sampler = SamplerType::New();
+  sampler->SetNumberOfSamples( 2000 );
+
+  MetricType::Pointer metrics[ 2 ];
+  for( unsigned int m = 0; m < 2; ++m )
+  {
+    metrics[ m ] = MetricType::New();
+    metrics[ m ]->SetFixedImage( images[ 0 ] );
+    metrics[ m ]->SetMovingImage( images[ 1 ] );
+    metrics[ m ]->SetFixedImageRegion( images[ 0 ]->GetBufferedRegion() );
+    metrics[ m ]->SetTransform( transform );
+    metrics[ m ]->SetInterpolator( InterpolatorType::New() );
+    metrics[ m ]->SetImageSampler( sampler );
+    metrics[ m ]->SetUseMultiThread( m == 1 );
+    metrics[ m ]->Initialize();
+  }
+
+  /** Compare the value and derivative of both metrics with the dense
+   * reference in a few iterations of a gradient descent.
+   */
+  const unsigned int      numberOfIterations = 5;
+  DerivativeType          derivatives[ 2 ];
+  DerivativeType          referenceDerivative;
+  MetricType::MeasureType values[ 2 ];
+  double                  referenceValue = 0.0;
+  itk::TimeProbe          probes[ 2 ];
+  const char *            names[ 2 ] = { "single-threaded", "multi-threaded" };
+  for( unsigned int iter = 0; iter < numberOfIterations; ++iter )
+  {
+    for( unsigned int m = 0; m < 2; ++m )
+    {
+      derivatives[ m ].SetSize( numberOfParameters );
+      probes[ m ].Start();
+      metrics[ m ]->GetValueAndDerivative( parameters, values[ m ], derivatives[ m ] );
+      probes[ m ].Stop();
+    }
+
+    /** The metrics have set the parameters and selected the samples. */
+    ComputeDenseReference( transform, images[ 1 ], sampler->GetOutput(),
+      referenceValue, referenceDerivative );
+
+    /** The results should be the same, up to the order of the summation. */
+    const double maxDerivative = referenceDerivative.inf_norm();
+    for( unsigned int m = 0; m < 2; ++m )
+    {
+      if( std::abs( values[ m ] - referenceValue ) > 1e-8 * ( 1.0 + std::abs( referenceValue ) ) )
+      {
+        std::cerr << "ERROR: the " << names[ m ] << " value in iteration " << iter << " is "
+                  << values[ m ] << " instead of " << referenceValue << "." << std::endl;
+        return 1;
+      }
+      const double difference = ( derivatives[ m ] - referenceDerivative ).inf_norm();
+      if( difference > 1e-8 * ( 1.0 + maxDerivative ) )
+      {
+        std::cerr << "ERROR: the " << names[ m ] << " derivative in iteration " << iter
+                  << " differs by " << difference << " from the dense reference." << std::endl;
+        return 1;
+      }
+    }
+
+    for( unsigned int j = 0; j < numberOfParameters; ++j )
+    {
+      parameters[ j ] -= 0.1 * referenceDerivative[ j ];
+    }
+  }
+
+  /** Report timings. */
+  std::cerr << "Number of threads: " << metrics[ 1 ]->GetNumberOfThreads() << std::endl;
+  std::cerr << "Number of parameters: " << numberOfParameters << std::endl;
+  std::cerr << "Time single-threaded: " << probes[ 0 ].GetMean() << " "
+            << probes[ 0 ].GetUnit() << std::endl;
+  std::cerr << "Time multi-threaded:  " << probes[ 1 ].GetMean() << " "
+            << probes[ 1 ].GetUnit() << std::endl;
+
+  /** Return a value. */
+  return 0;
+
+} // end main
@@ -0,0 +1,249 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+/** \file
+ \brief Transform points given in a binary point file with transformix, and
+ compare the points in outputpoints.bin with the analytic affine
+ transformation, and with the output points that transformix writes for the
+ same points given in a text point file. Enough points are used to read the
+ binary file in more than one chunk. This is done for points in world
+ coordinates and for points given as image indices.
+ */
+
+#include "elxTransformixFilter.h"
+#include "elxParameterObject.h"
+#include "itkBinaryPointFile.h"
+#include "itksys/SystemTools.hxx"
+
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//-------------------------------------------------------------------------------------
+
+int
+main( int argc, char * argv[] )
+{
+  /** Check. */
+  if( argc != 2 )
+  {
+    std::cerr << "ERROR: You should specify the output directory." << std::endl;
+    return 1;
+  }
+  const std::string outputDirectory = std::string( argv[ 1 ] ) + "/TransformixBinaryPointFileTest/";
+  itksys::SystemTools::MakeDirectory( outputDirectory.c_str() );
+
+  const unsigned int Dimension = 2;
+  typedef itk::Image< float, Dimension >                    ImageType;
+  typedef elastix::TransformixFilter< ImageType >           FilterType;
+  typedef elastix::ParameterObject                          ParameterObjectType;
+  typedef ParameterObjectType::ParameterMapType             ParameterMapType;
+  typedef ParameterObjectType::ParameterValueVectorType     ParameterValueVectorType;
+  typedef itk::BinaryPointFile                              BinaryPointFileType;
+
+  /** An affine transform x -> A ( x - c ) + c + t, with A = [ 1.1 0.2; -0.1 0.9 ],
+   * c = ( 10, 20 ) and t = ( 3, -4 ), on an image with origin ( -3, 7 ) and
+   * spacing ( 0.5, 1.5 ).
+   */
+  const double A[ Dimension ][ Dimension ] = { { 1.1, 0.2 }, { -0.1, 0.9 } };
+  const double c[ Dimension ]              = { 10.0, 20.0 };
+  const double t[ Dimension ]              = { 3.0, -4.0 };
+  const double origin[ Dimension ]         = { -3.0, 7.0 };
+  const double spacing[ Dimension ]        = { 0.5, 1.5 };
+
+  ParameterMapType parameterMap;
+  parameterMap[ "Transform" ]                          = ParameterValueVectorType( 1, "AffineTransform" );
+  parameterMap[ "NumberOfParameters" ]                 = ParameterValueVectorType( 1, "6" );
+  parameterMap[ "TransformParameters" ].push_back( "1.1" );
+  parameterMap[ "TransformParameters" ].push_back( "0.2" );
+  parameterMap[ "TransformParameters" ].push_back( "-0.1" );
+  parameterMap[ "TransformParameters" ].push_back( "0.9" );
+  parameterMap[ "TransformParameters" ].push_back( "3.0" );
+  parameterMap[ "TransformParameters" ].push_back( "-4.0" );
+  parameterMap[ "CenterOfRotationPoint" ].push_back( "10.0" );
+  parameterMap[ "CenterOfRotationPoint" ].push_back( "20.0" );
+  parameterMap[ "InitialTransformParametersFileName" ] = ParameterValueVectorType( 1, "NoInitialTransform" );
+  parameterMap[ "HowToCombineTransforms" ]             = ParameterValueVectorType( 1, "Compose" );
+  parameterMap[ "FixedImageDimension" ]                = ParameterValueVectorType( 1, "2" );
+  parameterMap[ "MovingImageDimension" ]               = ParameterValueVectorType( 1, "2" );
+  parameterMap[ "FixedInternalImagePixelType" ]        = ParameterValueVectorType( 1, "float" );
+  parameterMap[ "MovingInternalImagePixelType" ]       = ParameterValueVectorType( 1, "float" );
+  parameterMap[ "Size" ]                               = ParameterValueVectorType( 2, "64" );
+  parameterMap[ "Index" ]                              = ParameterValueVectorType( 2, "0" );
+  parameterMap[ "Spacing" ].push_back( "0.5" );
+  parameterMap[ "Spacing" ].push_back( "1.5" );
+  parameterMap[ "Origin" ].push_back( "-3.0" );
+  parameterMap[ "Origin" ].push_back( "7.0" );
+  parameterMap[ "Direction" ].push_back( "1.0" );
+  parameterMap[ "Direction" ].push_back( "0.0" );
+  parameterMap[ "Direction" ].push_back( "0.0" );
+  parameterMap[ "Direction" ].push_back( "1.0" );
+  parameterMap[ "UseDirectionCosines" ]                = ParameterValueVectorType( 1, "true" );
+  parameterMap[ "ResampleInterpolator" ]               = ParameterValueVectorType( 1, "FinalBSplineInterpolator" );
+  parameterMap[ "FinalBSplineInterpolationOrder" ]     = ParameterValueVectorType( 1, "3" );
+  parameterMap[ "Resampler" ]                          = ParameterValueVectorType( 1, "DefaultResampler" );
+  parameterMap[ "DefaultPixelValue" ]                  = ParameterValueVectorType( 1, "0" );
+  parameterMap[ "ResultImageFormat" ]                  = ParameterValueVectorType( 1, "mhd" );
+  parameterMap[ "ResultImagePixelType" ]               = ParameterValueVectorType( 1, "float" );
+  ParameterObjectType::Pointer parameterObject = ParameterObjectType::New();
+  parameterObject->SetParameterMap( parameterMap );
+
+  /** More points than are read at once from a binary point file. The
+   * coordinates are integers, since transformix rounds indices in a text
+   * point file.
+   */
+  const unsigned long    numberOfPoints = 70000;
+  std::vector< double > inputCoordinates( numberOfPoints * Dimension );
+  for( unsigned long j = 0; j < numberOfPoints; ++j )
+  {
+    inputCoordinates[ j * Dimension ]     = static_cast< double >( j % 83 ) - 10.0;
+    inputCoordinates[ j * Dimension + 1 ] = static_cast< double >( ( 7 * j ) % 71 ) - 5.0;
+  }
+
+  for( unsigned int pointsAreIndices = 0; pointsAreIndices < 2; ++pointsAreIndices )
+  {
+    /** Write the points in a text and in a binary point file. */
+    const std::string textFileName   = outputDirectory + "inputpoints.txt";
+    const std::string binaryFileName = outputDirectory + "inputpoints.bin";
+    std::ofstream     textFile( textFileName.c_str() );
+    textFile << ( pointsAreIndices ? "index" : "point" ) << "\n" << numberOfPoints << "\n";
+    for( unsigned long j = 0; j < numberOfPoints; ++j )
+    {
+      textFile << inputCoordinates[ j * Dimension ] << " " << inputCoordinates[ j * Dimension + 1 ] << "\n";
+    }
+    textFile.close();
+
+    BinaryPointFileType::HeaderType header;
+    header.Dimension        = Dimension;
+    header.PointsAreIndices = pointsAreIndices != 0;
+    header.NumberOfPoints   = numberOfPoints;
+    std::ofstream binaryFile( binaryFileName.c_str(), std::ios::out | std::ios::binary );
+    BinaryPointFileType::WriteHeader( binaryFile, header );
+    BinaryPointFileType::WritePoints( binaryFile, Dimension, numberOfPoints, &inputCoordinates[ 0 ] );
+    binaryFile.close();
+
+    /** Transform both point files. */
+    for( unsigned int binary = 0; binary < 2; ++binary )
+    {
+      FilterType::Pointer filter = FilterType::New();
+      filter->SetTransformParameterObject( parameterObject );
+      filter->SetFixedPointSetFileName( binary ? binaryFileName : textFileName );
+      filter->SetOutputDirectory( outputDirectory );
+      filter->LogToConsoleOff();
+      try
+      {
+        filter->Update();
+      }
+      catch( itk::ExceptionObject & excp )
+      {
+        std::cerr << "ERROR: transforming the point file failed:\n" << excp << std::endl;
+        return 1;
+      }
+    }
+
+    /** Read the output points of the text point file. */
+    std::vector< double > textCoordinates;
+    std::ifstream         textOutputFile( ( outputDirectory + "outputpoints.txt" ).c_str() );
+    std::string           line;
+    while( std::getline( textOutputFile, line ) )
+    {
+      const std::string::size_type pos = line.find( "OutputPoint = [" );
+      if( pos != std::string::npos )
+      {
+        std::istringstream stream( line.substr( pos + 15 ) );
+        double             x, y;
+        stream >> x >> y;
+        textCoordinates.push_back( x );
+        textCoordinates.push_back( y );
+      }
+    }
+    if( textCoordinates.size() != numberOfPoints * Dimension )
+    {
+      std::cerr << "ERROR: outputpoints.txt holds " << textCoordinates.size() / Dimension
+                << " points instead of " << numberOfPoints << "." << std::endl;
+      return 1;
+    }
+
+    /** Read the output points of the binary point file. */
+    std::ifstream                   binaryOutputFile( ( outputDirectory + "outputpoints.bin" ).c_str(),
+      std::ios::in | std::ios::binary );
+    BinaryPointFileType::HeaderType outputHeader;
+    if( !BinaryPointFileType::ReadHeader( binaryOutputFile, outputHeader )
+      || outputHeader.Dimension != Dimension
+      || outputHeader.PointsAreIndices
+      || outputHeader.NumberOfPoints != numberOfPoints )
+    {
+      std::cerr << "ERROR: outputpoints.bin has an unexpected header." << std::endl;
+      return 1;
+    }
+    std::vector< double > binaryCoordinates( numberOfPoints * Dimension );
+    if( BinaryPointFileType::ReadPoints( binaryOutputFile, Dimension, numberOfPoints,
+      &binaryCoordinates[ 0 ] ) != numberOfPoints )
+    {
+      std::cerr << "ERROR: outputpoints.bin holds less than " << numberOfPoints << " points." << std::endl;
+      return 1;
+    }
+
+    /** Compare with the analytic transformation, and with the text output,
+     * which holds six decimals.
+     */
+    for( unsigned long j = 0; j < numberOfPoints; ++j )
+    {
+      double inputPoint[ Dimension ];
+      for( unsigned int i = 0; i < Dimension; ++i )
+      {
+        inputPoint[ i ] = inputCoordinates[ j * Dimension + i ];
+        if( pointsAreIndices )
+        {
+          inputPoint[ i ] = origin[ i ] + spacing[ i ] * inputPoint[ i ];
+        }
+      }
+      for( unsigned int i = 0; i < Dimension; ++i )
+      {
+        double expected = c[ i ] + t[ i ];
+        for( unsigned int k = 0; k < Dimension; ++k )
+        {
+          expected += A[ i ][ k ] * ( inputPoint[ k ] - c[ k ] );
+        }
+        const double binaryCoordinate = binaryCoordinates[ j * Dimension + i ];
+        const double textCoordinate   = textCoordinates[ j * Dimension + i ];
+        if( std::fabs( binaryCoordinate - expected ) > 1e-10 )
+        {
+          std::cerr << "ERROR: coordinate " << i << " of point " << j << " is "
+                    << binaryCoordinate << " in outputpoints.bin instead of "
+                    << expected << " (indices: " << pointsAreIndices << ")." << std::endl;
+          return 1;
+        }
+        if( std::fabs( binaryCoordinate - textCoordinate ) > 1e-5 )
+        {
+          std::cerr << "ERROR: coordinate " << i << " of point " << j << " is "
+                    << binaryCoordinate << " in outputpoints.bin and " << textCoordinate
+                    << " in outputpoints.txt (indices: " << pointsAreIndices << ")." << std::endl;
+          return 1;
+        }
+      }
+    }
+  }
+
+  /** Return a value. */
+  return 0;
+
+} // end main
@@ -0,0 +1,236 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+/** \file
+ \brief Transform a point set in memory with the TransformixFilter, and
+ compare the output point set with the analytic affine transformation, and
+ with the output points that transformix writes for the same points given
+ as a point file with "-def". The output point set is requested before the
+ first Update(), and should hold the points of every later Update().
+ */
+
+#include "elxTransformixFilter.h"
+#include "elxParameterObject.h"
+#include "itksys/SystemTools.hxx"
+
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//-------------------------------------------------------------------------------------
+
+int
+main( int argc, char * argv[] )
+{
+  /** Check. */
+  if( argc != 2 )
+  {
+    std::cerr << "ERROR: You should specify the output directory." << std::endl;
+    return 1;
+  }
+  const std::string outputDirectory = std::string( argv[ 1 ] ) + "/TransformixFilterPointSetTest/";
+  itksys::SystemTools::MakeDirectory( outputDirectory.c_str() );
+
+  const unsigned int Dimension = 2;
+  typedef itk::Image< float, Dimension >                    ImageType;
+  typedef elastix::TransformixFilter< ImageType >           FilterType;
+  typedef FilterType::PointSetType                          PointSetType;
+  typedef PointSetType::PointType                           PointType;
+  typedef elastix::ParameterObject                          ParameterObjectType;
+  typedef ParameterObjectType::ParameterMapType             ParameterMapType;
+  typedef ParameterObjectType::ParameterValueVectorType     ParameterValueVectorType;
+
+  /** An affine transform x -> A ( x - c ) + c + t, with A = [ 1.1 0.2; -0.1 0.9 ],
+   * c = ( 10, 20 ) and t = ( 3, -4 ).
+   */
+  const double A[ Dimension ][ Dimension ] = { { 1.1, 0.2 }, { -0.1, 0.9 } };
+  const double c[ Dimension ]              = { 10.0, 20.0 };
+  const double t[ Dimension ]              = { 3.0, -4.0 };
+
+  ParameterMapType parameterMap;
+  parameterMap[ "Transform" ]                          = ParameterValueVectorType( 1, "AffineTransform" );
+  parameterMap[ "NumberOfParameters" ]                 = ParameterValueVectorType( 1, "6" );
+  parameterMap[ "TransformParameters" ].push_back( "1.1" );
+  parameterMap[ "TransformParameters" ].push_back( "0.2" );
+  parameterMap[ "TransformParameters" ].push_back( "-0.1" );
+  parameterMap[ "TransformParameters" ].push_back( "0.9" );
+  parameterMap[ "TransformParameters" ].push_back( "3.0" );
+  parameterMap[ "TransformParameters" ].push_back( "-4.0" );
+  parameterMap[ "CenterOfRotationPoint" ].push_back( "10.0" );
+  parameterMap[ "CenterOfRotationPoint" ].push_back( "20.0" );
+  parameterMap[ "InitialTransformParametersFileName" ] = ParameterValueVectorType( 1, "NoInitialTransform" );
+  parameterMap[ "HowToCombineTransforms" ]             = ParameterValueVectorType( 1, "Compose" );
+  parameterMap[ "FixedImageDimension" ]                = ParameterValueVectorType( 1, "2" );
+  parameterMap[ "MovingImageDimension" ]               = ParameterValueVectorType( 1, "2" );
+  parameterMap[ "FixedInternalImagePixelType" ]        = ParameterValueVectorType( 1, "float" );
+  parameterMap[ "MovingInternalImagePixelType" ]       = ParameterValueVectorType( 1, "float" );
+  parameterMap[ "Size" ]                               = ParameterValueVectorType( 2, "64" );
+  parameterMap[ "Index" ]                              = ParameterValueVectorType( 2, "0" );
+  parameterMap[ "Spacing" ]                            = ParameterValueVectorType( 2, "1.0" );
+  parameterMap[ "Origin" ]                             = ParameterValueVectorType( 2, "0.0" );
+  parameterMap[ "Direction" ].push_back( "1.0" );
+  parameterMap[ "Direction" ].push_back( "0.0" );
+  parameterMap[ "Direction" ].push_back( "0.0" );
+  parameterMap[ "Direction" ].push_back( "1.0" );
+  parameterMap[ "UseDirectionCosines" ]                = ParameterValueVectorType( 1, "true" );
+  parameterMap[ "ResampleInterpolator" ]               = ParameterValueVectorType( 1, "FinalBSplineInterpolator" );
+  parameterMap[ "FinalBSplineInterpolationOrder" ]     = ParameterValueVectorType( 1, "3" );
+  parameterMap[ "Resampler" ]                          = ParameterValueVectorType( 1, "DefaultResampler" );
+  parameterMap[ "DefaultPixelValue" ]                  = ParameterValueVectorType( 1, "0" );
+  parameterMap[ "ResultImageFormat" ]                  = ParameterValueVectorType( 1, "mhd" );
+  parameterMap[ "ResultImagePixelType" ]               = ParameterValueVectorType( 1, "float" );
+  ParameterObjectType::Pointer parameterObject = ParameterObjectType::New();
+  parameterObject->SetParameterMap( parameterMap );
+
+  /** Some points in and outside the image domain. */
+  const unsigned int      numberOfPoints = 250;
+  std::vector< PointType > points( numberOfPoints );
+  for( unsigned int j = 0; j < numberOfPoints; ++j )
+  {
+    points[ j ][ 0 ] = -10.0 + 80.0 * std::fabs( std::sin( 0.9 * j ) );
+    points[ j ][ 1 ] = -10.0 + 80.0 * std::fabs( std::cos( 1.7 * j ) );
+  }
+
+  /** The same points in a point file. */
+  const std::string inputPointFileName = outputDirectory + "inputpoints.txt";
+  std::ofstream     inputPointFile( inputPointFileName.c_str() );
+  inputPointFile << "point\n" << numberOfPoints << "\n" << std::setprecision( 17 );
+  for( unsigned int j = 0; j < numberOfPoints; ++j )
+  {
+    inputPointFile << points[ j ][ 0 ] << " " << points[ j ][ 1 ] << "\n";
+  }
+  inputPointFile.close();
+
+  /** Transform the points with "-def". */
+  FilterType::Pointer fileFilter = FilterType::New();
+  fileFilter->SetTransformParameterObject( parameterObject );
+  fileFilter->SetFixedPointSetFileName( inputPointFileName );
+  fileFilter->SetOutputDirectory( outputDirectory );
+  fileFilter->LogToConsoleOff();
+  try
+  {
+    fileFilter->Update();
+  }
+  catch( itk::ExceptionObject & excp )
+  {
+    std::cerr << "ERROR: transforming the point file failed:\n" << excp << std::endl;
+    return 1;
+  }
+
+  std::vector< PointType > filePoints;
+  std::ifstream            outputPointFile( ( outputDirectory + "outputpoints.txt" ).c_str() );
+  std::string              line;
+  while( std::getline( outputPointFile, line ) )
+  {
+    const std::string::size_type pos = line.find( "OutputPoint = [" );
+    if( pos != std::string::npos )
+    {
+      std::istringstream stream( line.substr( pos + 15 ) );
+      PointType          point;
+      stream >> point[ 0 ] >> point[ 1 ];
+      filePoints.push_back( point );
+    }
+  }
+  if( filePoints.size() != numberOfPoints )
+  {
+    std::cerr << "ERROR: the output point file holds " << filePoints.size()
+              << " points instead of " << numberOfPoints << "." << std::endl;
+    return 1;
+  }
+
+  /** Transform the points in memory. The output is requested before the
+   * update, and the filter is run twice, with other points the second time.
+   */
+  FilterType::Pointer memoryFilter = FilterType::New();
+  memoryFilter->SetTransformParameterObject( parameterObject );
+  memoryFilter->LogToConsoleOff();
+  PointSetType * outputPointSet = memoryFilter->GetOutputPointSet();
+
+  for( unsigned int run = 0; run < 2; ++run )
+  {
+    const double             shift = run;
+    PointSetType::Pointer    inputPointSet = PointSetType::New();
+    PointSetType::PointsContainerPointer inputPoints = PointSetType::PointsContainer::New();
+    inputPoints->Reserve( numberOfPoints );
+    for( unsigned int j = 0; j < numberOfPoints; ++j )
+    {
+      inputPoints->ElementAt( j ) = points[ j ];
+      inputPoints->ElementAt( j )[ 0 ] += shift;
+    }
+    inputPointSet->SetPoints( inputPoints );
+    memoryFilter->SetInputPointSet( inputPointSet );
+    try
+    {
+      memoryFilter->Update();
+    }
+    catch( itk::ExceptionObject & excp )
+    {
+      std::cerr << "ERROR: transforming the point set in memory failed:\n" << excp << std::endl;
+      return 1;
+    }
+
+    if( memoryFilter->GetOutputPointSet() != outputPointSet )
+    {
+      std::cerr << "ERROR: the output point set object was replaced in run " << run << "." << std::endl;
+      return 1;
+    }
+    if( outputPointSet->GetNumberOfPoints() != numberOfPoints )
+    {
+      std::cerr << "ERROR: the output point set of run " << run << " holds "
+                << outputPointSet->GetNumberOfPoints() << " points instead of "
+                << numberOfPoints << "." << std::endl;
+      return 1;
+    }
+
+    for( unsigned int j = 0; j < numberOfPoints; ++j )
+    {
+      const PointType & inputPoint  = inputPoints->ElementAt( j );
+      const PointType & outputPoint = outputPointSet->GetPoints()->ElementAt( j );
+      for( unsigned int i = 0; i < Dimension; ++i )
+      {
+        double expected = c[ i ] + t[ i ];
+        for( unsigned int k = 0; k < Dimension; ++k )
+        {
+          expected += A[ i ][ k ] * ( inputPoint[ k ] - c[ k ] );
+        }
+        if( std::fabs( outputPoint[ i ] - expected ) > 1e-10 )
+        {
+          std::cerr << "ERROR: run " << run << " maps point " << j << " " << inputPoint
+                    << " to " << outputPoint << " instead of coordinate " << i
+                    << " = " << expected << "." << std::endl;
+          return 1;
+        }
+      }
+
+      /** The point file holds six decimals. */
+      if( run == 0 && outputPoint.EuclideanDistanceTo( filePoints[ j ] ) > 1e-5 )
+      {
+        std::cerr << "ERROR: point " << j << " is mapped to " << outputPoint
+                  << " in memory, and to " << filePoints[ j ] << " with -def." << std::endl;
+        return 1;
+      }
+    }
+  }
+
+  /** Return a value. */
+  return 0;
+
+} // end main